@@ -7,6 +7,7 @@
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QStandardPaths>
+#include <QStringList>
 #include <QTextStream>
 
 DatabaseManager &DatabaseManager::instance() {
@@ -89,7 +90,10 @@ bool DatabaseManager::initialize(const QString &dbPath) {
                             "filesize INTEGER DEFAULT 0,"
                             "created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
                             "upload_status TEXT DEFAULT 'NONE',"
-                            "workspace_id INTEGER DEFAULT 0"
+                            "workspace_id INTEGER DEFAULT 0,"
+                            "frame_count INTEGER DEFAULT 0,"
+                            "session_id INTEGER DEFAULT 0,"
+                            "segment_index INTEGER DEFAULT 0"
                             ")");
 
   if (!success) {
@@ -98,15 +102,58 @@ bool DatabaseManager::initialize(const QString &dbPath) {
     return false;
   }
 
+  if (!migrateSchema()) {
+    emit databaseError("Failed to migrate tables");
+    return false;
+  }
+  return true;
+}
+
+bool DatabaseManager::migrateSchema() {
+  QStringList columns;
+  QSqlQuery info("PRAGMA table_info(videos)");
+  while (info.next()) {
+    columns << info.value("name").toString();
+  }
+  // 按加入的先后排列：{列名, 类型}
+  const char *const added[][2] = {
+      {"frame_count", "INTEGER DEFAULT 0"},
+      {"session_id", "INTEGER DEFAULT 0"},
+      {"segment_index", "INTEGER DEFAULT 0"},
+  };
+  for (const auto &column : added) {
+    if (columns.contains(column[0]))
+      continue;
+    QSqlQuery alter;
+    if (!alter.exec(QString("ALTER TABLE videos ADD COLUMN %1 %2")
+                        .arg(column[0], column[1]))) {
+      qCritical() << "升级数据表失败:" << alter.lastError().text();
+      return false;
+    }
+    qDebug().noquote() << QString("数据表已升级: videos.%1").arg(column[0]);
+  }
+
+  QSqlQuery sessions;
+  if (!sessions.exec("CREATE TABLE IF NOT EXISTS recording_sessions ("
+                     "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                     "name TEXT NOT NULL,"
+                     "base_path TEXT NOT NULL,"
+                     "created_at DATETIME DEFAULT CURRENT_TIMESTAMP"
+                     ")")) {
+    qCritical() << "创建录制会话表失败:" << sessions.lastError().text();
+    return false;
+  }
   return true;
 }
 
 int DatabaseManager::insertVideo(const VideoInfo &video) {
   QSqlQuery query;
   query.prepare("INSERT INTO videos (filename, filepath, duration, filesize, "
-                "created_at, upload_status) "
+                "created_at, upload_status, frame_count, session_id, "
+                "segment_index) "
                 "VALUES (:filename, :filepath, :duration, :filesize, "
-                ":created_at, :upload_status)");
+                ":created_at, :upload_status, :frame_count, :session_id, "
+                ":segment_index)");
 
   query.bindValue(":filename", video.filename);
   query.bindValue(":filepath", video.filepath);
@@ -116,6 +163,9 @@ int DatabaseManager::insertVideo(const VideoInfo &video) {
                                      ? video.createdAt
                                      : QDateTime::currentDateTime());
   query.bindValue(":upload_status", video.uploadStatus);
+  query.bindValue(":frame_count", video.frameCount);
+  query.bindValue(":session_id", video.sessionId);
+  query.bindValue(":segment_index", video.segmentIndex);
 
   if (!query.exec()) {
     // Phase 2 修复：区分 UNIQUE 冲突 vs 真错误
@@ -138,9 +188,14 @@ bool DatabaseManager::upsertVideo(const VideoInfo &video) {
     return true;
   }
   if (id == -1) {
-    // 已存在：用 path 更新 duration + filesize
-    return updateVideoMetadataByPath(video.filepath, video.duration,
-                                     video.filesize);
+    // 已存在：用 path 更新 duration + filesize + 帧数。视频库扫目录可能先于
+    // 录制结束把分段文件入了库，这时补上会话归属
+    if (!updateVideoMetadataByPath(video.filepath, video.duration,
+                                   video.filesize, video.frameCount))
+      return false;
+    return video.sessionId <= 0 ||
+           updateVideoSessionByPath(video.filepath, video.sessionId,
+                                    video.segmentIndex);
   }
   return false; // 真错误
 }
@@ -226,16 +281,80 @@ bool DatabaseManager::updateVideoDurationByPath(const QString &filepath,
 
 bool DatabaseManager::updateVideoMetadataByPath(const QString &filepath,
                                                 qint64 duration,
-                                                qint64 filesize) {
+                                                qint64 filesize,
+                                                qint64 frameCount) {
   QSqlQuery query;
-  query.prepare("UPDATE videos SET duration = :duration, filesize = :filesize "
-                "WHERE filepath = :filepath");
+  if (frameCount < 0) {
+    query.prepare(
+        "UPDATE videos SET duration = :duration, filesize = :filesize "
+        "WHERE filepath = :filepath");
+  } else {
+    query.prepare(
+        "UPDATE videos SET duration = :duration, filesize = :filesize, "
+        "frame_count = :frame_count WHERE filepath = :filepath");
+    query.bindValue(":frame_count", frameCount);
+  }
   query.bindValue(":duration", duration);
   query.bindValue(":filesize", filesize);
   query.bindValue(":filepath", filepath);
   return query.exec();
 }
 
+int DatabaseManager::insertRecordingSession(const RecordingSession &session) {
+  QSqlQuery query;
+  query.prepare("INSERT INTO recording_sessions (name, base_path, created_at) "
+                "VALUES (:name, :base_path, :created_at)");
+  query.bindValue(":name", session.name);
+  query.bindValue(":base_path", session.basePath);
+  query.bindValue(":created_at", session.createdAt.isValid()
+                                     ? session.createdAt
+                                     : QDateTime::currentDateTime());
+  if (!query.exec()) {
+    qWarning() << "插入录制会话失败:" << query.lastError().text();
+    return -2;
+  }
+  return query.lastInsertId().toInt();
+}
+
+RecordingSession DatabaseManager::getRecordingSession(int id) {
+  RecordingSession session;
+  QSqlQuery query;
+  query.prepare("SELECT * FROM recording_sessions WHERE id = :id");
+  query.bindValue(":id", id);
+  if (query.exec() && query.next()) {
+    session.id = query.value("id").toInt();
+    session.name = query.value("name").toString();
+    session.basePath = query.value("base_path").toString();
+    session.createdAt = query.value("created_at").toDateTime();
+  }
+  return session;
+}
+
+QVector<VideoInfo> DatabaseManager::getVideosInSession(int sessionId) {
+  QVector<VideoInfo> list;
+  QSqlQuery query;
+  query.prepare("SELECT * FROM videos WHERE session_id = :session_id "
+                "ORDER BY segment_index ASC");
+  query.bindValue(":session_id", sessionId);
+  if (query.exec()) {
+    while (query.next())
+      list.append(recordToVideoInfo(query));
+  }
+  return list;
+}
+
+bool DatabaseManager::updateVideoSessionByPath(const QString &filepath,
+                                               int sessionId,
+                                               int segmentIndex) {
+  QSqlQuery query;
+  query.prepare("UPDATE videos SET session_id = :session_id, "
+                "segment_index = :segment_index WHERE filepath = :filepath");
+  query.bindValue(":session_id", sessionId);
+  query.bindValue(":segment_index", segmentIndex);
+  query.bindValue(":filepath", filepath);
+  return query.exec();
+}
+
 VideoInfo DatabaseManager::recordToVideoInfo(const QSqlQuery &query) {
   VideoInfo info;
   info.id = query.value("id").toInt();
@@ -246,5 +365,8 @@ VideoInfo DatabaseManager::recordToVideoInfo(const QSqlQuery &query) {
   info.createdAt = query.value("created_at").toDateTime();
   info.uploadStatus = query.value("upload_status").toString();
   info.workspaceId = query.value("workspace_id").toInt();
+  info.frameCount = query.value("frame_count").toLongLong();
+  info.sessionId = query.value("session_id").toInt();
+  info.segmentIndex = query.value("segment_index").toInt();
   return info;
 }
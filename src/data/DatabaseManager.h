@@ -12,9 +12,22 @@ struct VideoInfo {
   QString filepath;
   qint64 duration = 0; // seconds
   qint64 filesize = 0; // bytes
+  qint64 frameCount = 0; // 文件头里的帧数，读不出为 0
   QDateTime createdAt;
   QString uploadStatus = "NONE";
   int workspaceId = 0;
+  // 分段录制：所属录制会话（recording_sessions.id，0 = 单文件录制）和
+  // 段号（从 1 开始）
+  int sessionId = 0;
+  int segmentIndex = 0;
+};
+
+// 一次分段录制：各段文件在 videos 表里按 session_id 归到同一会话下
+struct RecordingSession {
+  int id = -1;
+  QString name;     // 默认取录制文件名（不含段号和扩展名）
+  QString basePath; // startRecording 的路径，各段文件名由它派生
+  QDateTime createdAt;
 };
 
 class DatabaseManager : public QObject {
@@ -45,8 +58,18 @@ public:
   bool updateVideoFilename(int id, const QString &newFilename);
   bool updateVideoDuration(int id, qint64 duration);
   bool updateVideoDurationByPath(const QString &filepath, qint64 duration);
+  // frameCount < 0 时保留原值
   bool updateVideoMetadataByPath(const QString &filepath, qint64 duration,
-                                 qint64 filesize);
+                                 qint64 filesize, qint64 frameCount = -1);
+
+  // Recording sessions
+  // 返回新会话的 id，失败返回 -2
+  int insertRecordingSession(const RecordingSession &session);
+  RecordingSession getRecordingSession(int id);
+  // 会话下的各段，按段号升序
+  QVector<VideoInfo> getVideosInSession(int sessionId);
+  bool updateVideoSessionByPath(const QString &filepath, int sessionId,
+                                int segmentIndex);
 
 signals:
   void databaseError(const QString &error);
@@ -60,6 +83,8 @@ private:
   DatabaseManager &operator=(const DatabaseManager &) = delete;
 
   VideoInfo recordToVideoInfo(const class QSqlQuery &query);
+  // 旧版本建的表缺列时补上（ALTER TABLE ADD COLUMN），缺的表补建
+  bool migrateSchema();
 
   QSqlDatabase m_db;
 };
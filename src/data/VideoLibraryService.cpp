@@ -6,7 +6,8 @@
 
 namespace VideoLibraryService {
 
-bool addRecording(const QString &filePath, DatabaseManager &db) {
+bool addRecording(const QString &filePath, DatabaseManager &db,
+                  int sessionId, int segmentIndex) {
   const QFileInfo fi(filePath);
   if (!fi.exists() || fi.size() == 0) {
     qWarning() << "addRecording: 跳过无效文件" << filePath
@@ -19,11 +20,29 @@ bool addRecording(const QString &filePath, DatabaseManager &db) {
   info.filepath = fi.absoluteFilePath();
   info.filesize = fi.size();
   info.createdAt = fi.birthTime();
-  info.duration = static_cast<qint64>(
-      VideoUtils::parseVideoDurationFromFile(info.filepath));
+  const VideoUtils::VideoProbe probe =
+      VideoUtils::probeVideoFile(info.filepath);
+  info.duration = static_cast<qint64>(probe.durationSeconds);
+  info.frameCount = probe.frameCount;
+  info.sessionId = sessionId;
+  info.segmentIndex = segmentIndex;
   return db.upsertVideo(info);
 }
 
+int beginRecordingSession(const QString &basePath, DatabaseManager &db) {
+  RecordingSession session;
+  const QFileInfo fi(basePath);
+  session.name = fi.completeBaseName();
+  session.basePath = fi.absoluteFilePath();
+  session.createdAt = QDateTime::currentDateTime();
+  const int id = db.insertRecordingSession(session);
+  if (id <= 0) {
+    qWarning() << "beginRecordingSession: 建会话失败" << basePath;
+    return 0;
+  }
+  return id;
+}
+
 int pruneOrphans(DatabaseManager &db) {
   const auto all = db.getAllVideos();
   int pruned = 0;
@@ -18,14 +18,30 @@ namespace VideoLibraryService {
  * @brief 录制完成后把文件元数据写入 DB。
  *
  * - 通过 `QFileInfo` 读取 filesize / birthTime
- * - 通过 `VideoUtils::parseVideoDurationFromFile` 解析时长
+ * - 通过 `VideoUtils::probeVideoFile` 解析时长和帧数
  * - 文件不存在或 0 字节时**不入库**（返回 false）—— 避免脏数据
  *
+ * - 分段录制的一段带上会话 id 和段号；文件已被扫目录入库时补上归属
+ *
  * @param filePath 录制文件绝对路径
  * @param db DatabaseManager 引用
+ * @param sessionId beginRecordingSession 返回的会话 id，0 = 单文件录制
+ * @param segmentIndex 段号（从 1 开始）
  * @return 成功入库返回 true
  */
-bool addRecording(const QString &filePath, DatabaseManager &db);
+bool addRecording(const QString &filePath, DatabaseManager &db,
+                  int sessionId = 0, int segmentIndex = 0);
+
+/**
+ * @brief 分段录制开始时建一条录制会话，各段入库时按它归组。
+ *
+ * 会话名取 basePath 的文件名（不含扩展名），即各段共同的前缀。
+ *
+ * @param basePath startRecording 的路径（分段文件名由它派生）
+ * @param db DatabaseManager 引用
+ * @return 会话 id，失败返回 0（各段照常入库，只是不归组）
+ */
+int beginRecordingSession(const QString &basePath, DatabaseManager &db);
 
 /**
  * @brief 清理 DB 中的脏记录。
@@ -0,0 +1,286 @@
+#include "AcquisitionPipeline.h"
+
+// ============================================================================
+// Stage：队列 + 工作线程 + 计数器
+// ============================================================================
+
+struct AcquisitionPipeline::Stage {
+  Stage(const std::string &n, std::size_t capacity, DropPolicy p, Consumer c,
+        bool drain)
+      : name(n), policy(p), consumer(std::move(c)), drainOnStop(drain),
+        queue(capacity), limit(queue.capacity()) {}
+
+  const std::string name;
+  const DropPolicy policy;
+  const Consumer consumer;
+  const bool drainOnStop;
+  SpscRing<FrameRef> queue;
+  std::atomic<std::size_t> limit;
+  std::thread worker;
+
+  std::atomic<bool> enabled{true};
+  std::atomic<bool> stopping{false};
+
+  // 生产者只在消费者声明"要睡了"时才碰 mutex，平时 submit 完全无锁
+  std::atomic<bool> sleeping{false};
+  std::mutex wakeMutex;
+  std::condition_variable wakeCond;
+
+  // 计数器单调递增：submitted 仅生产者写，processed/consumed 仅消费者写，
+  // dropped 两边都可能写。resetCounters 只移动 base*，不改计数本身，
+  // 这样 waitStageIdle 的 submitted/consumed 对比永远成立
+  std::atomic<uint64_t> submitted{0};
+  std::atomic<uint64_t> processed{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<uint64_t> consumed{0}; // 出队的帧（处理 + 跳过）
+  std::atomic<std::size_t> highWater{0};
+  std::atomic<uint64_t> baseSubmitted{0};
+  std::atomic<uint64_t> baseProcessed{0};
+  std::atomic<uint64_t> baseDropped{0};
+
+  // 消费函数耗时：直方图只有消费者写、统计时读，用互斥保护（每帧一次无竞争加锁）
+  mutable std::mutex serviceMutex;
+  LatencyHistogram serviceUs;
+  std::atomic<uint64_t> servicePeakUs{0};
+
+  // waitStageIdle 用：消费者每处理/跳过一帧都通知一次
+  std::mutex idleMutex;
+  std::condition_variable idleCond;
+};
+
+AcquisitionPipeline::AcquisitionPipeline() = default;
+
+AcquisitionPipeline::~AcquisitionPipeline() { stop(); }
+
+int AcquisitionPipeline::addStage(const std::string &name,
+                                  std::size_t capacity, DropPolicy policy,
+                                  Consumer consumer, bool drainOnStop) {
+  if (isRunning())
+    return -1;
+  m_stages.push_back(std::make_unique<Stage>(name, capacity, policy,
+                                             std::move(consumer), drainOnStop));
+  return static_cast<int>(m_stages.size()) - 1;
+}
+
+void AcquisitionPipeline::start() {
+  if (isRunning())
+    return;
+  for (std::size_t i = 0; i < m_stages.size(); ++i) {
+    Stage *stage = m_stages[i].get();
+    stage->stopping.store(false);
+    stage->worker = std::thread([this, stage, i] {
+      if (m_threadInit)
+        m_threadInit(static_cast<int>(i), stage->name);
+      runStage(stage);
+    });
+  }
+  m_running.store(true, std::memory_order_release);
+}
+
+void AcquisitionPipeline::stop() {
+  if (!isRunning())
+    return;
+  m_running.store(false, std::memory_order_release);
+  for (auto &stage : m_stages) {
+    stage->stopping.store(true);
+    {
+      std::lock_guard<std::mutex> lock(stage->wakeMutex);
+      stage->wakeCond.notify_one();
+    }
+  }
+  for (auto &stage : m_stages) {
+    if (stage->worker.joinable())
+      stage->worker.join();
+    // 不需要 drain 的阶段：剩余帧直接丢弃并计数，释放帧引用
+    FrameRef leftover;
+    while (stage->queue.tryPop(leftover)) {
+      stage->dropped.fetch_add(1, std::memory_order_relaxed);
+      leftover.reset();
+    }
+  }
+}
+
+// ============================================================================
+// 生产者侧
+// ============================================================================
+
+int AcquisitionPipeline::submit(const FrameRef &frame) {
+  if (!frame || !isRunning())
+    return 0;
+
+  int accepted = 0;
+  for (auto &stagePtr : m_stages) {
+    Stage *stage = stagePtr.get();
+    if (!stage->enabled.load(std::memory_order_relaxed))
+      continue;
+
+    if (stage->queue.size() >= stage->limit.load(std::memory_order_relaxed) ||
+        !stage->queue.tryPush(frame)) {
+      stage->dropped.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    stage->submitted.fetch_add(1, std::memory_order_relaxed);
+    ++accepted;
+
+    const std::size_t depth = stage->queue.size();
+    if (depth > stage->highWater.load(std::memory_order_relaxed))
+      stage->highWater.store(depth, std::memory_order_relaxed);
+
+    // 与 runStage 中 "sleeping=true → 再检查队列" 配对（均为 seq_cst），
+    // 保证不会出现消费者刚要睡、生产者刚入队却没人唤醒的情况
+    if (stage->sleeping.load()) {
+      std::lock_guard<std::mutex> lock(stage->wakeMutex);
+      stage->wakeCond.notify_one();
+    }
+  }
+  return accepted;
+}
+
+void AcquisitionPipeline::setStageEnabled(int stage, bool enabled) {
+  if (stage < 0 || stage >= stageCount())
+    return;
+  m_stages[stage]->enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AcquisitionPipeline::isStageEnabled(int stage) const {
+  if (stage < 0 || stage >= stageCount())
+    return false;
+  return m_stages[stage]->enabled.load(std::memory_order_relaxed);
+}
+
+void AcquisitionPipeline::setStageLimit(int stage, std::size_t limit) {
+  if (stage < 0 || stage >= stageCount())
+    return;
+  Stage *s = m_stages[stage].get();
+  const std::size_t capacity = s->queue.capacity();
+  s->limit.store(limit == 0 || limit > capacity ? capacity : limit,
+                 std::memory_order_relaxed);
+}
+
+uint64_t AcquisitionPipeline::takeServicePeakUs(int stage) {
+  if (stage < 0 || stage >= stageCount())
+    return 0;
+  return m_stages[stage]->servicePeakUs.exchange(0, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// 消费者侧
+// ============================================================================
+
+void AcquisitionPipeline::runStage(Stage *stage) {
+  FrameRef frame;
+  for (;;) {
+    if (stage->queue.tryPop(frame)) {
+      if (stage->policy == DropPolicy::KeepLatest) {
+        // 跳到最新一帧，中间的旧帧算作丢弃
+        FrameRef newer;
+        while (stage->queue.tryPop(newer)) {
+          stage->dropped.fetch_add(1, std::memory_order_relaxed);
+          stage->consumed.fetch_add(1, std::memory_order_relaxed);
+          frame = std::move(newer);
+        }
+      }
+      if (!stage->stopping.load(std::memory_order_relaxed) ||
+          stage->drainOnStop) {
+        const auto t0 = std::chrono::steady_clock::now();
+        stage->consumer(frame);
+        const auto us = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - t0)
+                .count());
+        {
+          std::lock_guard<std::mutex> lock(stage->serviceMutex);
+          stage->serviceUs.record(us);
+        }
+        if (us > stage->servicePeakUs.load(std::memory_order_relaxed))
+          stage->servicePeakUs.store(us, std::memory_order_relaxed);
+        stage->processed.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        stage->dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+      frame.reset();
+      stage->consumed.fetch_add(1, std::memory_order_release);
+      {
+        std::lock_guard<std::mutex> lock(stage->idleMutex);
+        stage->idleCond.notify_all();
+      }
+      continue;
+    }
+
+    if (stage->stopping.load())
+      break;
+
+    std::unique_lock<std::mutex> lock(stage->wakeMutex);
+    stage->sleeping.store(true);
+    if (stage->queue.empty() && !stage->stopping.load()) {
+      // 超时只是兜底，正常由 submit 唤醒
+      stage->wakeCond.wait_for(lock, std::chrono::milliseconds(50));
+    }
+    stage->sleeping.store(false);
+  }
+}
+
+bool AcquisitionPipeline::waitStageIdle(int stage,
+                                        std::chrono::milliseconds timeout) {
+  if (stage < 0 || stage >= stageCount())
+    return false;
+  Stage *s = m_stages[stage].get();
+  // 目标：调用时刻已入队的帧都已出队并处理完（或被 KeepLatest 跳过）
+  const uint64_t target = s->submitted.load();
+  std::unique_lock<std::mutex> lock(s->idleMutex);
+  return s->idleCond.wait_for(lock, timeout, [s, target]() {
+    return s->consumed.load(std::memory_order_acquire) >= target;
+  });
+}
+
+// ============================================================================
+// 统计
+// ============================================================================
+
+AcquisitionPipeline::StageStats
+AcquisitionPipeline::stageStats(int stage) const {
+  StageStats st;
+  if (stage < 0 || stage >= stageCount())
+    return st;
+  const Stage *s = m_stages[stage].get();
+  st.name = s->name;
+  st.policy = s->policy;
+  st.enabled = s->enabled.load(std::memory_order_relaxed);
+  st.submitted = s->submitted.load(std::memory_order_relaxed) -
+                 s->baseSubmitted.load(std::memory_order_relaxed);
+  st.processed = s->processed.load(std::memory_order_relaxed) -
+                 s->baseProcessed.load(std::memory_order_relaxed);
+  st.dropped = s->dropped.load(std::memory_order_relaxed) -
+               s->baseDropped.load(std::memory_order_relaxed);
+  st.depth = s->queue.size();
+  st.highWater = s->highWater.load(std::memory_order_relaxed);
+  st.capacity = s->queue.capacity();
+  st.limit = s->limit.load(std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(s->serviceMutex);
+    st.serviceP50Us = s->serviceUs.percentile(50.0);
+    st.serviceP99Us = s->serviceUs.percentile(99.0);
+    st.serviceMaxUs = s->serviceUs.max();
+  }
+  return st;
+}
+
+std::vector<AcquisitionPipeline::StageStats>
+AcquisitionPipeline::stats() const {
+  std::vector<StageStats> all;
+  all.reserve(m_stages.size());
+  for (int i = 0; i < stageCount(); ++i)
+    all.push_back(stageStats(i));
+  return all;
+}
+
+void AcquisitionPipeline::resetCounters() {
+  for (auto &stage : m_stages) {
+    stage->baseSubmitted.store(stage->submitted.load());
+    stage->baseProcessed.store(stage->processed.load());
+    stage->baseDropped.store(stage->dropped.load());
+    stage->highWater.store(stage->queue.size());
+    std::lock_guard<std::mutex> lock(stage->serviceMutex);
+    stage->serviceUs.clear();
+  }
+}
@@ -0,0 +1,124 @@
+#ifndef ACQUISITIONPIPELINE_H
+#define ACQUISITIONPIPELINE_H
+
+#include "utils/FrameQueue.h"
+#include "utils/FrameRef.h"
+#include "utils/FrameTelemetry.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 多阶段采集流水线（无 Qt/SDK 依赖，可在 Linux 上单测）
+ *
+ * grab 线程只负责取帧并调用 submit()，每个消费阶段（显示 / 录制 / 抓拍 …）
+ * 有自己的有界 SPSC 队列和工作线程。某个阶段卡住（编码器、磁盘抖动）时只会
+ * 让该阶段按自己的丢帧策略丢帧并计数，不会反压 grab 线程，也就不会让 SDK
+ * 缓存节点被占满后静默丢帧。
+ *
+ * 用法：addStage() → start() → 每帧 submit() → stop()。
+ * addStage 必须在 start 之前调用；submit 只能由单一生产者线程调用。
+ */
+class AcquisitionPipeline {
+public:
+  enum class DropPolicy {
+    // 队列满时丢弃新到的帧，保持已排队帧的顺序（录制：不能乱序/跳回）
+    DropNewest,
+    // 队列满时同样丢新帧；消费者每次只处理队列里最新的一帧，
+    // 跳过的旧帧计入 dropped（显示 / 抓拍：只关心最新画面）
+    KeepLatest
+  };
+
+  struct StageStats {
+    std::string name;
+    DropPolicy policy = DropPolicy::DropNewest;
+    bool enabled = true;
+    uint64_t submitted = 0; // 成功入队
+    uint64_t processed = 0; // 消费者已处理
+    uint64_t dropped = 0;   // 队列满被拒 + KeepLatest 跳过
+    std::size_t depth = 0;
+    std::size_t highWater = 0;
+    std::size_t capacity = 0;
+    std::size_t limit = 0;  // 当前生效的队列上限（<= capacity）
+    // 消费函数单帧耗时（µs），自上次 resetCounters 起
+    uint64_t serviceP50Us = 0;
+    uint64_t serviceP99Us = 0;
+    uint64_t serviceMaxUs = 0;
+  };
+
+  using Consumer = std::function<void(const FrameRef &frame)>;
+  // 每个阶段工作线程启动后、处理第一帧之前在该线程里调用（绑核 / 调优先级）
+  using ThreadInit = std::function<void(int stage, const std::string &name)>;
+
+  AcquisitionPipeline();
+  ~AcquisitionPipeline();
+
+  AcquisitionPipeline(const AcquisitionPipeline &) = delete;
+  AcquisitionPipeline &operator=(const AcquisitionPipeline &) = delete;
+
+  /**
+   * @brief 注册一个消费阶段
+   * @param capacity 队列容量（向上取整到 2 的幂）
+   * @param drainOnStop stop() 时是否把已排队的帧处理完再退出（录制阶段需要）
+   * @return 阶段索引；流水线运行中调用返回 -1
+   */
+  int addStage(const std::string &name, std::size_t capacity,
+               DropPolicy policy, Consumer consumer, bool drainOnStop = false);
+
+  // 在 start 之前设置，下次 start 生效
+  void setThreadInit(ThreadInit init) { m_threadInit = std::move(init); }
+
+  void start();
+  void stop();
+  bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+  /**
+   * @brief 把一帧分发给所有已启用阶段（grab 线程调用，不阻塞）
+   * @return 成功入队的阶段个数
+   */
+  int submit(const FrameRef &frame);
+
+  // 禁用的阶段不再接收新帧（例如未录制时的录制阶段），可在运行中切换
+  void setStageEnabled(int stage, bool enabled);
+  bool isStageEnabled(int stage) const;
+
+  /**
+   * @brief 运行中调整队列上限：队列按 addStage 的容量分配，
+   * 排队帧数达到 limit 即按丢帧策略处理（0 或超过容量时取容量）
+   */
+  void setStageLimit(int stage, std::size_t limit);
+
+  /**
+   * @brief 取出自上次调用以来该阶段单帧耗时的最大值（µs）并清零
+   * 用于按窗口观察消费者停顿（磁盘 / 编码器卡顿）
+   */
+  uint64_t takeServicePeakUs(int stage);
+
+  /**
+   * @brief 等到某阶段处理完调用时刻之前已入队的所有帧
+   * @return 超时返回 false
+   */
+  bool waitStageIdle(int stage, std::chrono::milliseconds timeout);
+
+  StageStats stageStats(int stage) const;
+  std::vector<StageStats> stats() const;
+  void resetCounters();
+  int stageCount() const { return static_cast<int>(m_stages.size()); }
+
+private:
+  struct Stage;
+  void runStage(Stage *stage);
+
+  std::vector<std::unique_ptr<Stage>> m_stages;
+  ThreadInit m_threadInit;
+  std::atomic<bool> m_running{false};
+};
+
+#endif // ACQUISITIONPIPELINE_H
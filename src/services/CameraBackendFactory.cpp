@@ -0,0 +1,31 @@
+#include "CameraBackendFactory.h"
+#include "HikCameraBackend.h"
+#include "ReplayCameraBackend.h"
+#include "SyntheticCameraBackend.h"
+#include <QDebug>
+#include <QtGlobal>
+
+std::unique_ptr<ICameraBackend> createCameraBackend(const QString &spec) {
+  const QString trimmed = spec.trimmed();
+  const int colon = trimmed.indexOf(':');
+  const QString kind = (colon < 0 ? trimmed : trimmed.left(colon)).toLower();
+  const QString options = colon < 0 ? QString() : trimmed.mid(colon + 1);
+
+  if (kind == "synthetic") {
+    return std::make_unique<SyntheticCameraBackend>(
+        SyntheticCameraBackend::parseOptions(options));
+  }
+  if (kind == "replay") {
+    return std::make_unique<ReplayCameraBackend>(
+        ReplayCameraBackend::parseOptions(options));
+  }
+  if (!kind.isEmpty() && kind != "hik") {
+    qWarning() << "未知的相机后端:" << spec << "，使用海康后端";
+  }
+  return std::make_unique<HikCameraBackend>();
+}
+
+std::unique_ptr<ICameraBackend> createDefaultCameraBackend() {
+  return createCameraBackend(
+      qEnvironmentVariable("WORMVISION_CAMERA_BACKEND"));
+}
@@ -0,0 +1,25 @@
+#ifndef CAMERABACKENDFACTORY_H
+#define CAMERABACKENDFACTORY_H
+
+#include "ICameraBackend.h"
+#include <QString>
+#include <memory>
+
+/**
+ * @brief 按描述串创建相机后端
+ *
+ * - "" / "hik"                          海康 MVS SDK（默认）
+ * - "synthetic" / "synthetic:width=2448&height=2048&fps=60&format=BayerRG8"
+ * - "replay:D:/data/run1.avi?fps=30&loop=0"
+ *
+ * 无法识别的描述串回退到海康后端并打警告。
+ */
+std::unique_ptr<ICameraBackend> createCameraBackend(const QString &spec);
+
+/**
+ * @brief 按环境变量 WORMVISION_CAMERA_BACKEND 创建后端
+ * 没有硬件的 Linux 构建机 / CI 上设为 synthetic 即可跑通采集链路
+ */
+std::unique_ptr<ICameraBackend> createDefaultCameraBackend();
+
+#endif // CAMERABACKENDFACTORY_H
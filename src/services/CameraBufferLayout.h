@@ -0,0 +1,47 @@
+#ifndef CAMERABUFFERLAYOUT_H
+#define CAMERABUFFERLAYOUT_H
+
+#include "utils/BufferSizing.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CameraController 流水线的队列容量和帧缓冲池固定占用（无 SDK 依赖）
+ *
+ * CameraController 和多相机基准都从这里取，缓冲配置只有一份。
+ */
+namespace CameraBufferLayout {
+
+// 流水线队列容量：显示只关心最新帧；录制队列的槽位只存句柄，物理容量给足，
+// 实际上限由 BufferSizingPolicy 按停顿和内存预算决定
+constexpr std::size_t kDisplayQueueCapacity = 2;
+constexpr std::size_t kRecordQueueMaxCapacity = 256;
+// 连拍阶段只做一次 memcpy，短队列足够
+constexpr std::size_t kBurstQueueCapacity = 4;
+// 抓拍信箱最多同时持有的帧数（middle + front），外加 saveSnapshot 持有的 1 帧
+constexpr std::size_t kSnapshotFrames = 3;
+// 录制队列以外的池缓冲：显示 / 连拍队列 + 每阶段正在处理的 1 帧 + 抓拍 +
+// grab 线程手里 1 帧
+constexpr std::size_t kFixedPoolBuffers =
+    kDisplayQueueCapacity + kBurstQueueCapacity + 3 + kSnapshotFrames + 1;
+constexpr std::size_t kDefaultBufferBudgetBytes = std::size_t(512) << 20;
+// 还没观测到录制停顿时按 250 ms 准备（机械盘 / 杀毒扫描的典型卡顿约 200 ms）
+constexpr uint64_t kDefaultStallUs = 250000;
+
+// startGrabbing 时交给 BufferSizingPolicy 的输入
+inline BufferSizingInput sizingInput(std::size_t frameBytes, double fps,
+                                     std::size_t memoryBudgetBytes,
+                                     uint64_t stallUs) {
+  BufferSizingInput input;
+  input.frameBytes = frameBytes;
+  input.fps = fps;
+  input.memoryBudgetBytes = memoryBudgetBytes;
+  input.stallUs = stallUs;
+  input.fixedBuffers = kFixedPoolBuffers;
+  input.maxQueueFrames = kRecordQueueMaxCapacity;
+  return input;
+}
+
+} // namespace CameraBufferLayout
+
+#endif // CAMERABUFFERLAYOUT_H
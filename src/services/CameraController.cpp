@@ -1,185 +1,196 @@
 #include "CameraController.h"
+#include "CameraBackendFactory.h"
+#include "CameraBufferLayout.h"
+#include "../utils/AviWriter.h"
+#include "../utils/BayerDemosaic.h"
+#include "../utils/PixelFormats.h"
+#include "../utils/PixelUnpack.h"
+#include "../utils/PreviewScaler.h"
 #include "../utils/RecordingDiagnostics.h"
+#include "../utils/WvrWriter.h"
 #include <MvCameraControl.h>
 #include <QDebug>
+#include <QFile>
 #include <QFileInfo>
+#include <QImage>
 #include <QTimer>
+#include <algorithm>
 #include <chrono>
 
 // ============================================================================
 // 构造与析构
 // ============================================================================
 
-CameraController::CameraController(QObject *parent) : QObject(parent) {}
+namespace {
+using CameraBufferLayout::kBurstQueueCapacity;
+using CameraBufferLayout::kDefaultBufferBudgetBytes;
+using CameraBufferLayout::kDefaultStallUs;
+using CameraBufferLayout::kDisplayQueueCapacity;
+using CameraBufferLayout::kFixedPoolBuffers;
+using CameraBufferLayout::kRecordQueueMaxCapacity;
+// 开始录制后每来一帧最多补写几帧预触发历史：补写速度是帧率的 3 倍，
+// 2 秒历史约 1 秒写完；编码跟不上时录制阶段的单帧耗时会被缓冲配置观测到
+constexpr int kPreTriggerCatchUpFrames = 3;
+// 录制阶段同一时刻只转换一帧，多留一块给以后的分析消费者
+constexpr std::size_t kConvertPoolBuffers = 2;
+// 并行转换的工作线程上限：再多就受内存带宽限制，只会和采集线程抢核
+constexpr int kMaxConvertWorkers = 7;
+// 每个条带至少这么多行，条带太细时调度开销大于收益
+constexpr int kConvertMinTileRows = 64;
+// 遥测刷新 / 丢帧日志周期
+constexpr int kTelemetryIntervalMs = 1000;
+
+// 16 位灰度 PNG：有效位左移到 16 位满量程（12 位的 4095 存成 65520），
+// 普通看图软件也按正常亮度显示；分析时右移 16 - sampleBits 位还原
+bool saveGray16Png(const FrameRef &frame, int sampleBits,
+                   const QString &filePath) {
+  const FrameInfo &info = frame.info();
+  const int w = static_cast<int>(info.extendWidth);
+  const int h = static_cast<int>(info.extendHeight);
+  std::vector<uint16_t> samples(std::size_t(w) * h);
+  if (!PixelUnpack::toU16(frame.data(), info.frameLen, info.pixelType, w, h,
+                          samples.data()))
+    return false;
+  QImage image(w, h, QImage::Format_Grayscale16);
+  if (image.isNull())
+    return false;
+  const int shift = 16 - sampleBits;
+  for (int y = 0; y < h; ++y) {
+    const uint16_t *src = samples.data() + std::size_t(y) * w;
+    auto *dst = reinterpret_cast<uint16_t *>(image.scanLine(y));
+    for (int x = 0; x < w; ++x)
+      dst[x] = static_cast<uint16_t>(src[x] << shift);
+  }
+  return image.save(filePath, "PNG");
+}
+
+QString errorCodeText(int ret) {
+  // 海康错误码按 0x8000xxxx 显示，其他后端的 kErr* 是负的小整数
+  if (ret < 0 && ret > -0x10000)
+    return QString::number(ret);
+  return QString("0x%1").arg(static_cast<unsigned int>(ret), 8, 16, QChar('0'));
+}
+} // namespace
+
+CameraController::CameraController(QObject *parent)
+    : CameraController(createDefaultCameraBackend(), parent) {}
+
+CameraController::CameraController(std::unique_ptr<ICameraBackend> backend,
+                                   QObject *parent)
+    : QObject(parent), m_backend(std::move(backend)) {
+  qDebug() << "相机后端:" << m_backend->backendName();
+  // WORMVISION_ACQUISITION_MODE=callback 切到回调取帧，默认轮询
+  if (qEnvironmentVariable("WORMVISION_ACQUISITION_MODE")
+          .compare("callback", Qt::CaseInsensitive) == 0)
+    m_acquisitionMode = AcquisitionMode::Callback;
+  m_bufferBudgetBytes = kDefaultBufferBudgetBytes;
+  bool budgetOk = false;
+  const qulonglong budgetMb =
+      qEnvironmentVariable("WORMVISION_BUFFER_BUDGET_MB").toULongLong(&budgetOk);
+  if (budgetOk && budgetMb > 0)
+    m_bufferBudgetBytes = static_cast<std::size_t>(budgetMb) << 20;
+  m_observedStallUs = kDefaultStallUs;
+  setupPipeline();
+  m_telemetryTimer = new QTimer(this);
+  m_telemetryTimer->setInterval(kTelemetryIntervalMs);
+  connect(m_telemetryTimer, &QTimer::timeout, this,
+          &CameraController::emitTelemetry);
+}
 
 CameraController::~CameraController() { close(); }
 
+void CameraController::setupPipeline() {
+  m_displayStage = m_pipeline.addStage(
+      "display", kDisplayQueueCapacity,
+      AcquisitionPipeline::DropPolicy::KeepLatest,
+      [this](const FrameRef &frame) { displayFrame(frame); });
+  // 录制阶段：不能乱序，停止时把已排队的帧写完
+  m_recordStage = m_pipeline.addStage(
+      "record", kRecordQueueMaxCapacity,
+      AcquisitionPipeline::DropPolicy::DropNewest,
+      [this](const FrameRef &frame) { recordFrame(frame); }, true);
+  m_pipeline.setStageEnabled(m_recordStage, false);
+  // 连拍阶段：拷进预分配内存，停止采集时把已排队的帧收完
+  m_burstStage = m_pipeline.addStage(
+      "burst", kBurstQueueCapacity,
+      AcquisitionPipeline::DropPolicy::DropNewest,
+      [this](const FrameRef &frame) { burstFrame(frame); }, true);
+  m_pipeline.setStageEnabled(m_burstStage, false);
+
+  // 写盘阶段和其余阶段各用一套绑核 / 优先级
+  m_pipeline.setThreadInit([this](int stage, const std::string &name) {
+    const bool writer = stage == m_recordStage || stage == m_burstStage;
+    applyThreadSetting(name, writer ? m_activeThreadTuning.record
+                                    : m_activeThreadTuning.workers);
+  });
+}
+
 // ============================================================================
 // 设备管理
 // ============================================================================
 
 QList<CameraController::DeviceInfo> CameraController::enumerateDevices() {
-  QList<DeviceInfo> devices;
-  MV_CC_DEVICE_INFO_LIST deviceList;
-  memset(&deviceList, 0, sizeof(MV_CC_DEVICE_INFO_LIST));
-
-  int ret = MV_CC_EnumDevices(MV_GIGE_DEVICE | MV_USB_DEVICE, &deviceList);
-  if (ret != MV_OK) {
-    qWarning() << "设备枚举失败:" << Qt::hex << ret;
-    return devices;
-  }
-
-  for (unsigned int i = 0; i < deviceList.nDeviceNum; i++) {
-    MV_CC_DEVICE_INFO *pDev = deviceList.pDeviceInfo[i];
-    if (!pDev)
-      continue;
-
-    DeviceInfo info;
-    info.index = static_cast<int>(i);
-    info.deviceType = pDev->nTLayerType;
-
-    // Phase 3 修复 #5：原代码用 fromLatin1，设备名/序列号含中文（用户自定义名）会乱码。
-    // 海康 SDK 在 Windows 上字段是本地编码（GBK），用 fromLocal8Bit 解码。
-    if (pDev->nTLayerType == MV_GIGE_DEVICE) {
-      info.name = QString::fromLocal8Bit(reinterpret_cast<const char *>(
-          pDev->SpecialInfo.stGigEInfo.chModelName));
-      info.serialNumber = QString::fromLocal8Bit(reinterpret_cast<const char *>(
-          pDev->SpecialInfo.stGigEInfo.chSerialNumber));
-    } else if (pDev->nTLayerType == MV_USB_DEVICE) {
-      info.name = QString::fromLocal8Bit(reinterpret_cast<const char *>(
-          pDev->SpecialInfo.stUsb3VInfo.chModelName));
-      info.serialNumber = QString::fromLocal8Bit(reinterpret_cast<const char *>(
-          pDev->SpecialInfo.stUsb3VInfo.chSerialNumber));
-    }
-    devices.append(info);
-  }
-
-  qDebug() << "已枚举" << devices.size() << "个相机";
-  return devices;
+  return m_backend->enumerateDevices();
 }
 
 bool CameraController::open(int deviceIndex) {
   if (m_isOpen)
     return true;
 
-  // 枚举设备
-  MV_CC_DEVICE_INFO_LIST deviceList;
-  memset(&deviceList, 0, sizeof(MV_CC_DEVICE_INFO_LIST));
-  int ret = MV_CC_EnumDevices(MV_GIGE_DEVICE | MV_USB_DEVICE, &deviceList);
-  if (ret != MV_OK || deviceIndex >= static_cast<int>(deviceList.nDeviceNum)) {
+  // 后端负责创建句柄、GigE 包大小、关闭触发模式
+  int ret = m_backend->open(deviceIndex);
+  if (ret == ICameraBackend::kErrInvalidParam) {
     emit error("设备枚举失败或设备索引无效");
     return false;
   }
-
-  MV_CC_DEVICE_INFO *pDevInfo = deviceList.pDeviceInfo[deviceIndex];
-
-  // 创建句柄
-  ret = MV_CC_CreateHandle(&m_cameraHandle, pDevInfo);
-  if (ret != MV_OK) {
-    emit error(QString("创建句柄失败: 0x%1").arg(ret, 8, 16, QChar('0')));
-    return false;
-  }
-
-  // 打开设备
-  ret = MV_CC_OpenDevice(m_cameraHandle);
-  if (ret != MV_OK) {
-    MV_CC_DestroyHandle(m_cameraHandle);
-    m_cameraHandle = nullptr;
-    emit error(QString("打开设备失败: 0x%1").arg(ret, 8, 16, QChar('0')));
+  if (ret != ICameraBackend::kOk) {
+    emit error(QString("打开设备失败: %1").arg(errorCodeText(ret)));
     return false;
   }
 
-  // GigE 优化包大小
-  if (pDevInfo->nTLayerType == MV_GIGE_DEVICE) {
-    int packetSize = MV_CC_GetOptimalPacketSize(m_cameraHandle);
-    if (packetSize > 0) {
-      MV_CC_SetIntValue(m_cameraHandle, "GevSCPSPacketSize", packetSize);
-      qDebug() << "GigE 包大小设置为:" << packetSize;
-    }
-  }
-
   m_isOpen = true;
 
-  // 确保触发模式关闭 (连续采集模式)
-  int nRet =
-      MV_CC_SetEnumValue(m_cameraHandle, "TriggerMode", MV_TRIGGER_MODE_OFF);
-  if (MV_OK != nRet) {
-    qWarning() << "设置触发模式关闭失败:" << Qt::hex << nRet;
-  }
-
-  // ========== MVS 方案：从 SDK 获取参数范围 ==========
-  MVCC_FLOATVALUE floatVal;
+  // ========== MVS 方案：从后端获取参数范围 ==========
+  ICameraBackend::FloatValue floatVal;
 
   // 曝光范围
-  if (MV_OK == MV_CC_GetFloatValue(m_cameraHandle, "ExposureTime", &floatVal)) {
-    emit exposureRangeReady(floatVal.fMin, floatVal.fMax, floatVal.fCurValue);
-    qDebug() << "曝光范围:" << floatVal.fMin << "-" << floatVal.fMax
-             << ", 当前:" << floatVal.fCurValue;
+  if (m_backend->getFloat("ExposureTime", floatVal) == ICameraBackend::kOk) {
+    emit exposureRangeReady(floatVal.min, floatVal.max, floatVal.current);
+    qDebug() << "曝光范围:" << floatVal.min << "-" << floatVal.max
+             << ", 当前:" << floatVal.current;
   }
 
   // 增益范围
-  if (MV_OK == MV_CC_GetFloatValue(m_cameraHandle, "Gain", &floatVal)) {
-    emit gainRangeReady(floatVal.fMin, floatVal.fMax, floatVal.fCurValue);
-    qDebug() << "增益范围:" << floatVal.fMin << "-" << floatVal.fMax
-             << ", 当前:" << floatVal.fCurValue;
+  if (m_backend->getFloat("Gain", floatVal) == ICameraBackend::kOk) {
+    emit gainRangeReady(floatVal.min, floatVal.max, floatVal.current);
+    qDebug() << "增益范围:" << floatVal.min << "-" << floatVal.max
+             << ", 当前:" << floatVal.current;
   }
 
   // 帧率范围
-  if (MV_OK ==
-      MV_CC_GetFloatValue(m_cameraHandle, "AcquisitionFrameRate", &floatVal)) {
+  if (m_backend->getFloat("AcquisitionFrameRate", floatVal) ==
+      ICameraBackend::kOk) {
     // 限制 UI 显示的最大帧率，避免出现 10000+ 的无效范围
     // 如果硬件返回的最大值超过 120，且当前值小于 120，则将 UI 上限限制为
     // 120
-    float uiMax = floatVal.fMax;
-    if (uiMax > 120.0f && floatVal.fCurValue <= 120.0f) {
+    float uiMax = floatVal.max;
+    if (uiMax > 120.0f && floatVal.current <= 120.0f) {
       uiMax = 120.0f;
     }
-    emit frameRateRangeReady(floatVal.fMin, uiMax, floatVal.fCurValue);
-    qDebug() << "帧率范围:" << floatVal.fMin << "-" << floatVal.fMax
-             << ", 当前:" << floatVal.fCurValue;
-  }
-
-  // 分辨率 (宽/高/最大值)
-  MVCC_INTVALUE intVal;
-  int w = 0, h = 0;
-  int wMax = 0, hMax = 0;
-  int wInc = 8, hInc = 8;
-
-  if (MV_OK == MV_CC_GetIntValue(m_cameraHandle, "Width", &intVal)) {
-    w = intVal.nCurValue;
-    wMax = intVal.nMax;
-    wInc = intVal.nInc > 0 ? intVal.nInc : 8;
-    m_widthInc = wInc; // 保存步长
-  }
-  if (MV_OK == MV_CC_GetIntValue(m_cameraHandle, "Height", &intVal)) {
-    h = intVal.nCurValue;
-    hMax = intVal.nMax;
-    hInc = intVal.nInc > 0 ? intVal.nInc : 8;
-    m_heightInc = hInc; // 保存步长
-  }
-
-  if (w > 0 && h > 0) {
-    emit resolutionReady(w, h, wInc, hInc);
-    qDebug() << "分辨率:" << w << "x" << h << " 步长:" << wInc << "x" << hInc;
-  }
-  if (wMax > 0 && hMax > 0) {
-    emit resolutionMaxReady(wMax, hMax);
-    qDebug() << "最大分辨率:" << wMax << "x" << hMax;
+    emit frameRateRangeReady(floatVal.min, uiMax, floatVal.current);
+    qDebug() << "帧率范围:" << floatVal.min << "-" << floatVal.max
+             << ", 当前:" << floatVal.current;
   }
 
-  // 偏移量 (OffsetX/OffsetY)
-  int offX = 0, offY = 0;
-  if (MV_OK == MV_CC_GetIntValue(m_cameraHandle, "OffsetX", &intVal))
-    offX = intVal.nCurValue;
-  if (MV_OK == MV_CC_GetIntValue(m_cameraHandle, "OffsetY", &intVal))
-    offY = intVal.nCurValue;
-  emit offsetReady(offX, offY);
+  emitResolutionInfo();
+  emit samplingOptionsReady(samplingOptions(), samplingMode());
+  negotiatePixelFormat();
 
   // 结果帧率 (ResultingFrameRate)
-  if (MV_OK ==
-      MV_CC_GetFloatValue(m_cameraHandle, "ResultingFrameRate", &floatVal)) {
-    emit resultingFrameRateReady(floatVal.fCurValue);
-    qDebug() << "结果帧率:" << floatVal.fCurValue;
+  if (m_backend->getFloat("ResultingFrameRate", floatVal) ==
+      ICameraBackend::kOk) {
+    emit resultingFrameRateReady(floatVal.current);
+    qDebug() << "结果帧率:" << floatVal.current;
   }
 
   emit cameraOpened();
@@ -196,9 +207,13 @@ void CameraController::close() {
   if (m_isRecording)
     stopRecording();
 
-  MV_CC_CloseDevice(m_cameraHandle);
-  MV_CC_DestroyHandle(m_cameraHandle);
-  m_cameraHandle = nullptr;
+  // 连拍落盘要用 SDK 句柄，写完再关
+  if (m_burstFlushThread.joinable())
+    m_burstFlushThread.join();
+  m_burst.release();
+  m_burstState = BurstState::Idle;
+
+  m_backend->close();
   m_isOpen = false;
 
   emit cameraClosed();
@@ -211,25 +226,135 @@ void CameraController::close() {
 
 void CameraController::setDisplayHandle(void *hwnd) { m_displayHandle = hwnd; }
 
+void CameraController::setDisplayViewport(const QRect &visible,
+                                          const QSize &displaySize) {
+  std::lock_guard<std::mutex> lock(m_displayViewportMutex);
+  m_displayVisible = {visible.x(), visible.y(), visible.width(),
+                      visible.height()};
+  m_displayWidth = displaySize.width();
+  m_displayHeight = displaySize.height();
+}
+
+bool CameraController::prepareGrabbing() {
+  if (!m_isOpen || m_isGrabbing)
+    return false;
+  m_grabPrepared = false;
+
+  // 上一次采集留下的抓拍帧也占着池缓冲，重分配前先放掉
+  {
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    m_snapshotFrame.reset();
+  }
+  const std::size_t frameBytes = queryFrameBytes();
+  if (frameBytes == 0) {
+    emit error("开始采集失败: 无法分配帧缓冲池");
+    return false;
+  }
+
+  // 按帧率 × 已知最长停顿定录制队列，预算剩余部分留给采集中 grow
+  m_sizingInput = CameraBufferLayout::sizingInput(
+      frameBytes, currentResultingFps(), m_bufferBudgetBytes,
+      m_observedStallUs);
+  m_bufferSizing = BufferSizingPolicy::compute(m_sizingInput);
+  const std::size_t budgetFrames = m_bufferBudgetBytes / frameBytes;
+  const std::size_t maxPoolBuffers = std::min(
+      kFixedPoolBuffers + kRecordQueueMaxCapacity,
+      std::max(m_bufferSizing.poolBuffers,
+               budgetFrames > m_bufferSizing.sdkNodes
+                   ? budgetFrames - m_bufferSizing.sdkNodes
+                   : 0));
+  if (!m_framePool.configure(m_bufferSizing.poolBuffers, frameBytes,
+                             maxPoolBuffers)) {
+    emit error("开始采集失败: 无法分配帧缓冲池");
+    return false;
+  }
+  m_pipeline.setStageLimit(m_recordStage, m_bufferSizing.recordQueueLimit);
+  const int nodeRet = m_backend->setBufferNodeCount(
+      static_cast<unsigned int>(m_bufferSizing.sdkNodes));
+  if (nodeRet != ICameraBackend::kOk &&
+      nodeRet != ICameraBackend::kErrNotSupported)
+    qWarning() << "设置 SDK 缓存节点数失败:" << errorCodeText(nodeRet);
+  qInfo() << "缓冲配置: SDK 节点" << m_bufferSizing.sdkNodes << "帧缓冲池"
+          << m_bufferSizing.poolBuffers << "/" << maxPoolBuffers << "×"
+          << frameBytes << "字节 录制队列" << m_bufferSizing.recordQueueLimit
+          << "可吸收停顿" << m_bufferSizing.absorbableStallMs << "ms";
+  if (m_bufferSizing.budgetLimited)
+    qWarning() << "缓冲内存预算" << (m_bufferBudgetBytes >> 20)
+               << "MiB 不足以吸收" << m_observedStallUs / 1000 << "ms 的录制停顿";
+  armPreTrigger(frameBytes);
+
+  // 回调模式：后端取流线程直接把帧推进流水线，不起 grab 线程
+  m_callbackActive = false;
+  if (m_acquisitionMode == AcquisitionMode::Callback) {
+    if (!m_backend->supportsFrameCallback()) {
+      qWarning() << m_backend->backendName() << "后端不支持回调取帧，改用轮询";
+    } else {
+      const int ret = m_backend->setFrameCallback(
+          &m_framePool, [this](ICameraBackend::GrabResult result,
+                               FrameRef &frame) {
+            handleGrabResult(result, frame);
+          });
+      if (ret == ICameraBackend::kOk)
+        m_callbackActive = true;
+      else
+        qWarning() << "注册取帧回调失败:" << errorCodeText(ret) << "，改用轮询";
+    }
+  }
+  m_grabPrepared = true;
+  return true;
+}
+
 bool CameraController::startGrabbing() {
   if (!m_isOpen || m_isGrabbing)
     return false;
+  if (!m_grabPrepared && !prepareGrabbing())
+    return false;
+  m_grabPrepared = false;
 
-  int ret = MV_CC_StartGrabbing(m_cameraHandle);
-  if (ret != MV_OK) {
-    emit error(QString("开始采集失败: 0x%1").arg(ret, 8, 16, QChar('0')));
+  // 回调在 startGrabbing 返回前就可能进来：计数先清零
+  m_stopGrabbing = false;
+  m_acqStats.reset();
+  m_oversizeFrames = 0;
+  m_endOfStreamLogged = false;
+  m_telemetry.reset(queryTimestampTickHz());
+  m_reportedLostFrames = 0;
+  m_activeThreadTuning = m_threadTuning;
+  {
+    std::lock_guard<std::mutex> lock(m_threadReportMutex);
+    m_threadReport.clear();
+  }
+  m_pipeline.resetCounters();
+  m_pipeline.start();
+
+  int ret = m_backend->startGrabbing();
+  if (ret != ICameraBackend::kOk) {
+    m_pipeline.stop();
+    if (m_callbackActive) {
+      m_backend->setFrameCallback(nullptr, nullptr);
+      m_callbackActive = false;
+    }
+    emit error(QString("开始采集失败: %1").arg(errorCodeText(ret)));
     return false;
   }
 
   m_isGrabbing = true;
-  m_stopGrabbing = false;
-  m_frameCount = 0;
-  m_grabThread = std::thread(&CameraController::grabLoop, this);
+  if (!m_callbackActive)
+    m_grabThread = std::thread(&CameraController::grabLoop, this);
+  m_telemetryTimer->start();
 
-  qDebug() << "开始采集";
+  if (m_callbackActive && !m_threadTuning.grab.isDefault())
+    qWarning() << "回调取帧由后端线程出帧，grab 线程绑核 / 优先级不生效";
+  qDebug() << "开始采集，取帧方式:" << (m_callbackActive ? "回调" : "轮询");
   return true;
 }
 
+void CameraController::setAcquisitionMode(AcquisitionMode mode) {
+  if (m_isGrabbing) {
+    qWarning() << "采集中不能切换取帧方式，下次开始采集时生效";
+  }
+  m_acquisitionMode = mode;
+}
+
 void CameraController::stopGrabbing() {
   if (!m_isGrabbing)
     return;
@@ -237,124 +362,688 @@ void CameraController::stopGrabbing() {
   m_stopGrabbing = true;
   if (m_grabThread.joinable())
     m_grabThread.join();
+  // 回调模式：后端停止取流后不会再进回调
+  if (m_callbackActive) {
+    m_backend->stopGrabbing();
+    m_backend->setFrameCallback(nullptr, nullptr);
+  }
+  m_telemetryTimer->stop();
+
+  // 连拍没抓满时把已抓到的帧落盘
+  if (m_burstState == BurstState::Capturing)
+    finishBurstCapture();
 
-  MV_CC_StopGrabbing(m_cameraHandle);
+  // 录制阶段写完已排队的帧，其余阶段放掉手里的池缓冲
+  m_pipeline.stop();
+  // 预触发历史属于这一轮采集；录制中的由 stopRecording 写完
+  {
+    std::lock_guard<std::mutex> lock(m_recordMutex);
+    if (!m_isRecording)
+      m_preTrigger.clear();
+  }
+
+  // 抓拍信箱里的最新帧留给 m_snapshotFrame，停止后仍可抓拍
+  {
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    refreshSnapshotFrame();
+    m_snapshotMailbox.clear();
+  }
+
+  if (!m_callbackActive)
+    m_backend->stopGrabbing();
+  m_callbackActive = false;
   m_isGrabbing = false;
+  // 重配置后还没等到第一帧就停了：不再计入下次采集
+  m_reconfigureGapStartNs.store(0, std::memory_order_relaxed);
+
+  const FramePool::Stats pool = m_framePool.stats();
+  qDebug() << "停止采集，总帧数:" << m_acqStats.frames()
+           << "缓冲池耗尽丢帧:" << pool.exhausted
+           << "超尺寸丢帧:" << m_oversizeFrames.load()
+           << "缓冲池峰值占用:" << pool.highWater << "/" << pool.bufferCount;
+  for (const auto &st : m_pipeline.stats()) {
+    qInfo() << "流水线阶段" << QString::fromStdString(st.name)
+            << "处理=" << st.processed << "丢弃=" << st.dropped
+            << "队列峰值=" << st.highWater << "/" << st.limit
+            << "单帧耗时 p99/max=" << st.serviceP99Us << "/" << st.serviceMaxUs
+            << "us";
+  }
+  // 最后一个窗口的停顿留给下次采集定录制队列
+  m_observedStallUs =
+      std::max(m_observedStallUs, m_pipeline.takeServicePeakUs(m_recordStage));
+  const FrameTelemetry::Summary t = m_telemetry.summary();
+  qInfo() << "采集遥测: 丢帧" << t.lostFrames << "(" << t.gapEvents << "次)"
+          << "帧号回退" << t.counterResets << "延迟 p50/p95/p99 ="
+          << t.latencyUs.p50 << "/" << t.latencyUs.p95 << "/"
+          << t.latencyUs.p99 << "us 抖动 p99 =" << t.jitterUs.p99 << "us";
+  emit telemetryUpdated(t);
+}
 
-  qDebug() << "停止采集，总帧数:" << m_frameCount.load();
+void CameraController::setBufferMemoryBudget(std::size_t bytes) {
+  if (m_isGrabbing)
+    qWarning() << "采集中修改缓冲内存预算，下次开始采集时生效";
+  m_bufferBudgetBytes = bytes > 0 ? bytes : kDefaultBufferBudgetBytes;
 }
 
-void CameraController::grabLoop() {
-  MV_FRAME_OUT frameOut;
-  memset(&frameOut, 0, sizeof(MV_FRAME_OUT));
+void CameraController::adaptBuffers() {
+  const uint64_t peakUs = m_pipeline.takeServicePeakUs(m_recordStage);
+  if (peakUs <= m_observedStallUs)
+    return;
+  m_observedStallUs = peakUs;
+  m_sizingInput.stallUs = peakUs;
+  const BufferSizing wanted = BufferSizingPolicy::compute(m_sizingInput);
+
+  // 池子只增不减；上限在 startGrabbing 时按预算定好，grow 自己截断
+  const std::size_t have = m_framePool.bufferCount();
+  if (wanted.poolBuffers > have)
+    m_framePool.grow(wanted.poolBuffers - have);
+  const std::size_t pool = m_framePool.bufferCount();
+  const std::size_t queue = std::max(
+      m_bufferSizing.recordQueueLimit,
+      std::min(wanted.recordQueueLimit, pool - kFixedPoolBuffers));
+  const double fps = m_sizingInput.fps > 0.0 ? m_sizingInput.fps
+                                              : BufferSizingPolicy::kFallbackFps;
+  m_pipeline.setStageLimit(m_recordStage, queue);
+  m_bufferSizing.poolBuffers = pool;
+  m_bufferSizing.recordQueueLimit = queue;
+  m_bufferSizing.absorbableStallMs = double(queue) / fps * 1000.0;
+  m_bufferSizing.budgetLimited = queue < wanted.recordQueueLimit;
+  qInfo() << "录制阶段停顿" << peakUs / 1000 << "ms，缓冲调整: 帧缓冲池" << pool
+          << "录制队列" << queue << "可吸收停顿"
+          << m_bufferSizing.absorbableStallMs << "ms";
+  if (m_bufferSizing.budgetLimited)
+    qWarning() << "缓冲内存预算不足，录制停顿超过"
+               << m_bufferSizing.absorbableStallMs << "ms 时会丢帧";
+}
+
+void CameraController::emitTelemetry() {
+  adaptBuffers();
+  const FrameTelemetry::Summary t = m_telemetry.summary();
+  if (t.lostFrames > m_reportedLostFrames) {
+    qWarning() << "检测到丢帧:" << (t.lostFrames - m_reportedLostFrames)
+               << "累计" << t.lostFrames << "最大空洞" << t.largestGap;
+    m_reportedLostFrames = t.lostFrames;
+  }
+  emit telemetryUpdated(t);
+}
+
+void CameraController::setGrabThreadCore(int core) {
+  if (m_isGrabbing)
+    qWarning() << "采集中修改 grab 线程绑核，下次开始采集时生效";
+  m_threadTuning.grab.core = core;
+}
+
+void CameraController::setThreadTuning(const ThreadAffinity::Tuning &tuning) {
+  if (m_isGrabbing)
+    qWarning() << "采集中修改线程调度设置，下次开始采集时生效";
+  m_threadTuning = tuning;
+}
+
+std::vector<ThreadAffinity::Applied>
+CameraController::appliedThreadTuning() const {
+  std::lock_guard<std::mutex> lock(m_threadReportMutex);
+  return m_threadReport;
+}
 
+void CameraController::applyThreadSetting(
+    const std::string &thread, const ThreadAffinity::ThreadSetting &setting) {
+  const ThreadAffinity::Applied applied =
+      ThreadAffinity::applyToCurrentThread(thread, setting);
+  if (setting.core >= 0 && !applied.pinned)
+    qWarning() << QString::fromStdString(thread) << "线程绑核失败，核:"
+               << setting.core;
+  if (setting.priority != ThreadAffinity::Priority::Normal &&
+      !applied.prioritized)
+    qWarning() << QString::fromStdString(thread) << "线程设置优先级"
+               << ThreadAffinity::priorityName(setting.priority)
+               << "失败（权限不足？），按默认优先级运行";
+  std::lock_guard<std::mutex> lock(m_threadReportMutex);
+  m_threadReport.push_back(applied);
+}
+
+void CameraController::grabLoop() {
+  applyThreadSetting("grab", m_activeThreadTuning.grab);
   while (!m_stopGrabbing) {
-    int ret = MV_CC_GetImageBuffer(m_cameraHandle, &frameOut, 1000);
-    if (ret == MV_OK) {
-      // 更新分辨率和像素类型
-      int w = frameOut.stFrameInfo.nWidth;
-      int h = frameOut.stFrameInfo.nHeight;
-      int extendW = frameOut.stFrameInfo.nExtendWidth;
-      int extendH = frameOut.stFrameInfo.nExtendHeight;
-      int pixelType = frameOut.stFrameInfo.enPixelType;
-
-      if (w != m_width || h != m_height) {
-        m_width = w;
-        m_height = h;
-        emit resolutionChanged(w, h);
-      }
-      m_extendWidth = extendW;
-      m_extendHeight = extendH;
-      m_pixelType = pixelType;
-
-      // SDK 直接渲染到窗口
-      if (m_displayHandle) {
-        MV_CC_IMAGE stImage = {0};
-        stImage.enPixelType = frameOut.stFrameInfo.enPixelType;
-        stImage.nWidth = extendW;
-        stImage.nHeight = extendH;
-        stImage.nImageLen = frameOut.stFrameInfo.nFrameLenEx;
-        stImage.pImageBuf = frameOut.pBufAddr;
-
-        MV_CC_DisplayOneFrameEx2(m_cameraHandle, m_displayHandle, &stImage, 0);
-      }
+    // 唯一一次拷贝由后端完成：像素直接进池缓冲，下游阶段再慢也不会
+    // 占住 SDK 节点。池子用完（下游全部积压）时丢帧，池子自己计数
+    FrameRef frame;
+    const ICameraBackend::GrabResult result =
+        m_backend->grabFrame(m_framePool, frame, 1000);
+    if (!handleGrabResult(result, frame))
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+}
 
-      // 录制时输入帧（Phase 5：原始 Bayer 等格式需要先转 BGR8）
-      // 加锁防止 stopRecording 在 InputOneFrame 中间执行 StopRecord，
-      // 否则会出现 MV_E_CALLORDER (0x80000003) 把 AVI 索引写坏导致 0 字节
-      std::unique_lock<std::mutex> recLock(m_recordMutex, std::defer_lock);
-      if (m_isRecording) {
-        recLock.lock();
-      }
-      // double-check：拿到锁后 stopRecording 可能已经把 isRecording 置 false
-      if (m_isRecording) {
-        MV_CC_INPUT_FRAME_INFO inputInfo;
-        memset(&inputInfo, 0, sizeof(MV_CC_INPUT_FRAME_INFO));
-
-        if (!m_recordingNeedsConvert) {
-          inputInfo.pData = frameOut.pBufAddr;
-          inputInfo.nDataLen = frameOut.stFrameInfo.nFrameLenEx;
-        } else {
-          // 转 BGR8：dstSize = w * h * 3
-          const unsigned int dstSize =
-              static_cast<unsigned int>(extendW) * extendH * 3;
-          if (m_convertBuffer.size() < dstSize) {
-            m_convertBuffer.resize(dstSize);
-          }
-          MV_CC_PIXEL_CONVERT_PARAM_EX cvt;
-          memset(&cvt, 0, sizeof(cvt));
-          cvt.nWidth = static_cast<unsigned short>(extendW);
-          cvt.nHeight = static_cast<unsigned short>(extendH);
-          cvt.pSrcData = frameOut.pBufAddr;
-          cvt.nSrcDataLen = frameOut.stFrameInfo.nFrameLenEx;
-          cvt.enSrcPixelType =
-              static_cast<MvGvspPixelType>(frameOut.stFrameInfo.enPixelType);
-          cvt.enDstPixelType = PixelType_Gvsp_BGR8_Packed;
-          cvt.pDstBuffer = m_convertBuffer.data();
-          cvt.nDstBufferSize = dstSize;
-          int cret = MV_CC_ConvertPixelTypeEx(m_cameraHandle, &cvt);
-          if (cret != MV_OK) {
-            m_recordConvertFail.fetch_add(1);
-            m_lastInputErrorCode.store(static_cast<quint32>(cret));
-            qWarning() << "ConvertPixelTypeEx 失败:" << Qt::hex << cret;
-            MV_CC_FreeImageBuffer(m_cameraHandle, &frameOut);
-            continue;
-          }
-          inputInfo.pData = m_convertBuffer.data();
-          inputInfo.nDataLen = cvt.nDstLen;
-        }
+bool CameraController::handleGrabResult(ICameraBackend::GrabResult result,
+                                        FrameRef &frame) {
+  switch (result) {
+  case ICameraBackend::GrabResult::Ok:
+    break;
+  case ICameraBackend::GrabResult::Timeout:
+  case ICameraBackend::GrabResult::PoolExhausted:
+    return true;
+  case ICameraBackend::GrabResult::Oversize:
+    if (m_oversizeFrames.fetch_add(1) == 0) {
+      qWarning() << "帧大小超过缓冲池容量" << m_framePool.stats().bufferBytes
+                 << "，请重新开始采集";
+    }
+    return true;
+  case ICameraBackend::GrabResult::EndOfStream:
+    if (!m_endOfStreamLogged.exchange(true))
+      qInfo() << "回放结束，总帧数:" << m_acqStats.frames();
+    return false;
+  case ICameraBackend::GrabResult::Error:
+    return false;
+  }
 
-        int nRet = MV_CC_InputOneFrame(m_cameraHandle, &inputInfo);
-        if (nRet != MV_OK) {
-          m_recordInputFail.fetch_add(1);
-          m_lastInputErrorCode.store(static_cast<quint32>(nRet));
-          // 写到日志文件，方便后续诊断（qInstallMessageHandler 已接管 qWarning）
-          if (m_recordInputFail.load() <= 5) {
-            qWarning() << "InputOneFrame 失败 #"
-                       << m_recordInputFail.load()
-                       << " errCode=" << Qt::hex << nRet
-                       << " nDataLen=" << inputInfo.nDataLen;
-          }
-        } else {
-          m_recordInputOk.fetch_add(1);
-        }
-      }
+  // 更新分辨率和像素类型
+  const FrameInfo &info = frame.info();
+  const int w = static_cast<int>(info.width);
+  const int h = static_cast<int>(info.height);
+  if (w != m_width || h != m_height) {
+    m_width = w;
+    m_height = h;
+    emit resolutionChanged(w, h);
+  }
+  m_extendWidth = static_cast<int>(info.extendWidth);
+  m_extendHeight = static_cast<int>(info.extendHeight);
+  m_pixelType = static_cast<int>(info.pixelType);
+
+  m_telemetry.record(info);
+  if (m_isRecording && m_recordSync.admits(info.grabTimeNs))
+    m_recordTelemetry.record(info);
+  // 不逐帧发信号：UI 定时读 acquisitionStats()
+  m_acqStats.recordFrame(info.grabTimeNs, info.frameNum);
+  if (m_reconfigureGapStartNs.load(std::memory_order_relaxed) != 0) {
+    const int64_t gapStartNs = m_reconfigureGapStartNs.exchange(0);
+    if (gapStartNs != 0)
+      emit reconfigureGapMeasured(double(info.grabTimeNs - gapStartNs) / 1e6);
+  }
+
+  m_pipeline.submit(frame);
+  // 抓拍只需要"最新一帧"：发布句柄即可
+  m_snapshotMailbox.publish(std::move(frame));
+  return true;
+}
+
+// ============================================================================
+// 流水线阶段
+// ============================================================================
+
+void CameraController::displayFrame(const FrameRef &frame) {
+  void *hwnd = m_displayHandle.load();
+  void *sdkHandle = m_backend->sdkHandle();
+  if (!hwnd || !sdkHandle)
+    return;
+
+  PreviewScaler::Rect visible;
+  int displayWidth = 0;
+  int displayHeight = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_displayViewportMutex);
+    visible = m_displayVisible;
+    displayWidth = m_displayWidth;
+    displayHeight = m_displayHeight;
+  }
+
+  const FrameInfo &info = frame.info();
+  const int w = static_cast<int>(info.extendWidth);
+  const int h = static_cast<int>(info.extendHeight);
+  // 缩小只认 8 位 Mono / RGB / Bayer：高位深先取高 8 位，其它格式（YUV 等）
+  // 先让 SDK 转 BGR8。不用裁剪也不用缩小时原帧直接交给 SDK，不做这些转换
+  uint32_t scaleType = info.pixelType;
+  if (!PreviewScaler::canScale(scaleType)) {
+    scaleType = PixelFormats::eightBitType(info.pixelType);
+    if (scaleType == 0)
+      scaleType = PixelType_Gvsp_BGR8_Packed;
+  }
+  const PreviewScaler::Plan plan = PreviewScaler::plan(
+      scaleType, w, h, visible, displayWidth, displayHeight);
+
+  MV_CC_IMAGE stImage = {0};
+  if (plan.passthrough) {
+    // 整帧、不缩小：SDK 直接渲染原帧
+    stImage.enPixelType = static_cast<MvGvspPixelType>(info.pixelType);
+    stImage.nWidth = info.extendWidth;
+    stImage.nHeight = info.extendHeight;
+    stImage.nImageLen = static_cast<unsigned int>(info.frameLen);
+    stImage.pImageBuf = const_cast<unsigned char *>(frame.data());
+    MV_CC_DisplayOneFrameEx2(sdkHandle, hwnd, &stImage, 0);
+    return;
+  }
+
+  const uint8_t *src = frame.data();
+  std::size_t srcBytes = info.frameLen;
+  if (scaleType != info.pixelType) {
+    const std::size_t pixels = std::size_t(w) * h;
+    const bool bgr = scaleType == PixelType_Gvsp_BGR8_Packed;
+    if (m_previewSourceBuffer.size() < pixels * (bgr ? 3 : 1))
+      m_previewSourceBuffer.resize(pixels * (bgr ? 3 : 1));
+    if (!bgr) {
+      if (!PixelUnpack::toU8(frame.data(), info.frameLen, info.pixelType, w,
+                             h, m_previewSourceBuffer.data()))
+        return;
+    } else {
+      MV_CC_PIXEL_CONVERT_PARAM_EX cvt;
+      memset(&cvt, 0, sizeof(cvt));
+      cvt.nWidth = info.extendWidth;
+      cvt.nHeight = info.extendHeight;
+      cvt.pSrcData = const_cast<unsigned char *>(frame.data());
+      cvt.nSrcDataLen = static_cast<unsigned int>(info.frameLen);
+      cvt.enSrcPixelType = static_cast<MvGvspPixelType>(info.pixelType);
+      cvt.enDstPixelType = PixelType_Gvsp_BGR8_Packed;
+      cvt.pDstBuffer = m_previewSourceBuffer.data();
+      cvt.nDstBufferSize = static_cast<unsigned int>(pixels * 3);
+      if (MV_CC_ConvertPixelTypeEx(sdkHandle, &cvt) != MV_OK)
+        return;
+    }
+    src = m_previewSourceBuffer.data();
+    srcBytes = m_previewSourceBuffer.size();
+  }
+
+  // 裁出可见区域并面积平均到接近窗口大小
+  const std::size_t outBytes = PreviewScaler::outputBytes(plan);
+  if (m_previewBuffer.size() < outBytes)
+    m_previewBuffer.resize(outBytes);
+  if (!PreviewScaler::scale(src, srcBytes, scaleType, w, h, plan,
+                            m_previewBuffer.data()))
+    return;
+  stImage.enPixelType = static_cast<MvGvspPixelType>(plan.outPixelType);
+  stImage.nWidth = static_cast<unsigned int>(plan.outWidth);
+  stImage.nHeight = static_cast<unsigned int>(plan.outHeight);
+  stImage.nImageLen = static_cast<unsigned int>(outBytes);
+  stImage.pImageBuf = m_previewBuffer.data();
+  MV_CC_DisplayOneFrameEx2(sdkHandle, hwnd, &stImage, 0);
+}
+
+void CameraController::recordFrame(const FrameRef &frame) {
+  // 录制时输入帧（Phase 5：原始 Bayer 等格式需要先转 BGR8）
+  // 加锁防止 stopRecording 在写帧中间关闭文件
+  std::lock_guard<std::mutex> recLock(m_recordMutex);
+  const FrameInfo &info = frame.info();
+  // 没在录制（拿到锁后 stopRecording 可能已经把 isRecording 置 false），
+  // 或多相机同步录制还没到共同起点：只进预触发环，满了覆盖最旧一帧
+  if (!m_isRecording || !m_recordSync.admits(info.grabTimeNs)) {
+    if (m_preTrigger.capacity() > 0)
+      m_preTrigger.push(frame);
+    return;
+  }
+  if (m_preTrigger.empty()) {
+    writeRecordFrame(frame);
+    return;
+  }
 
-      // 缓存帧用于抓拍
-      {
-        std::lock_guard<std::mutex> lock(m_frameMutex);
-        m_frameLen = frameOut.stFrameInfo.nFrameLenEx; // 使用 Ex
-        m_frameBuffer.assign(frameOut.pBufAddr, frameOut.pBufAddr + m_frameLen);
+  // 先补写预触发历史，新帧排到环尾：写空之前顺序不变、不缺帧
+  if (m_recordPreTriggerFrames == 0) {
+    m_recordPreTriggerFrames = static_cast<qint64>(m_preTrigger.size());
+    m_recordPreTriggerSpanMs = m_preTrigger.spanNs() / 1000000;
+  }
+  for (int i = 0; i < kPreTriggerCatchUpFrames && !m_preTrigger.empty(); ++i)
+    writeRecordFrame(m_preTrigger.pop());
+  if (!m_preTrigger.append(frame))
+    ++m_recordPreTriggerLost;
+}
+
+void CameraController::writeRecordFrame(const FrameRef &frame) {
+  const FrameInfo &info = frame.info();
+  if (m_recordFirstGrabNs == 0) {
+    m_recordFirstGrabNs = info.grabTimeNs;
+    m_recordFirstDevTimestamp = info.devTimestamp;
+  }
+  // 分段只在帧与帧之间换文件：这帧整帧写进新段，不缺帧也不重帧。
+  // 下一段快到上限前就在后台打开，换段时只交接
+  const uint64_t segmentBytes = m_recordWriter->fileBytes();
+  if (m_recordSegmenter.shouldPrepare(info.grabTimeNs, segmentBytes))
+    requestNextSegment();
+  if (m_recordSegmenter.shouldRollOver(info.grabTimeNs, segmentBytes,
+                                       m_recordFrameBytes))
+    rollOverSegment(info.grabTimeNs);
+  if (m_recordSegmenter.policy().enabled())
+    m_segmentTelemetry.record(info);
+  if (inputRecordFrame(frame))
+    m_recordSegmenter.frameWritten(info.frameNum, info.grabTimeNs);
+}
+
+void CameraController::requestNextSegment() {
+  const int index = m_recordSegmenter.current().index + 1;
+  if (m_segmentRequested == index)
+    return;
+  m_segmentRequested = index;
+  {
+    std::lock_guard<std::mutex> lock(m_segmentMutex);
+    m_segmentOpenIndex = index;
+    m_segmentOpenDone = false;
+    m_segmentOpenError.clear();
+  }
+  m_segmentCv.notify_one();
+}
+
+void CameraController::rollOverSegment(int64_t grabTimeNs) {
+  // 一帧就超过剩余字节、采集中断后时长直接越过上限时，换段前没请求过
+  requestNextSegment();
+  std::unique_ptr<IRecordWriter> next;
+  QString nextPath;
+  QString openError;
+  bool opening = false;
+  {
+    std::lock_guard<std::mutex> lock(m_segmentMutex);
+    if (m_segmentNextWriter) {
+      next = std::move(m_segmentNextWriter);
+      nextPath = m_segmentNextPath;
+    } else if (m_segmentOpenDone) {
+      openError = m_segmentOpenError;
+      m_segmentOpenIndex = 0;
+    } else {
+      opening = true;
+    }
+  }
+  // 下一段没准备好就接着写当前段，满一个周期再换，一帧也不丢：打开失败的
+  // 下次快到上限时重新请求，还在打开的打开好了留到下次换
+  if (!next) {
+    if (opening) {
+      qWarning() << "录制换段: 下一段还没打开好，继续写当前段";
+    } else {
+      qWarning() << "录制换段失败，继续写当前段:" << openError;
+      m_segmentRequested = 0;
+    }
+    m_recordSegmenter.deferRollOver(grabTimeNs, m_recordWriter->fileBytes());
+    return;
+  }
+
+  const RecordSegmenter::Segment done = m_recordSegmenter.rollOver();
+  std::unique_ptr<IRecordWriter> previous = std::move(m_recordWriter);
+  m_recordWriter = std::move(next);
+  const QString previousPath = m_recordingPathQt;
+  m_recordingPathQt = nextPath;
+  qInfo() << "录制换段:" << previousPath << done.frames << "帧 (帧号"
+          << done.firstFrameNum << "-" << done.lastFrameNum << ") →"
+          << nextPath;
+
+  RecordingDiagnostics::RecordingReport report;
+  takeSegmentReport(done, &report);
+  if (done.index == 1)
+    fillRecordingStartReport(m_recordSync.startNs(), &report);
+  // 关闭要等写盘线程排空再写索引：排给 m_segmentThread，这里不等
+  {
+    std::lock_guard<std::mutex> lock(m_segmentMutex);
+    m_segmentCloses.push_back({std::move(previous), previousPath, report});
+  }
+  m_segmentCv.notify_one();
+}
+
+void CameraController::segmentWorker() {
+  std::unique_lock<std::mutex> lock(m_segmentMutex);
+  for (;;) {
+    m_segmentCv.wait(lock, [this] {
+      return m_segmentStop || !m_segmentCloses.empty() ||
+             (m_segmentOpenIndex > 0 && !m_segmentOpenDone);
+    });
+    // 先打开：换段有截止时间，关闭没有
+    if (!m_segmentStop && m_segmentOpenIndex > 0 && !m_segmentOpenDone) {
+      const int index = m_segmentOpenIndex;
+      const QString path = QString::fromStdString(RecordSegmenter::segmentPath(
+          m_recordBasePath.toStdString(), index));
+      lock.unlock();
+      QString errorMessage;
+      std::unique_ptr<IRecordWriter> writer =
+          createRecordWriter(path, &errorMessage);
+      lock.lock();
+      m_segmentOpenDone = true;
+      if (writer) {
+        m_segmentNextWriter = std::move(writer);
+        m_segmentNextPath = path;
+      } else {
+        m_segmentOpenError = errorMessage;
       }
+      continue;
+    }
+    if (!m_segmentCloses.empty()) {
+      SegmentClose job = std::move(m_segmentCloses.front());
+      m_segmentCloses.pop_front();
+      lock.unlock();
+      closeSegment(std::move(job.writer), job.path, job.report);
+      lock.lock();
+      continue;
+    }
+    if (m_segmentStop)
+      break;
+  }
+
+  // 提前打开了但录制已经停了：空文件不留
+  std::unique_ptr<IRecordWriter> unused = std::move(m_segmentNextWriter);
+  const QString unusedPath = m_segmentNextPath;
+  lock.unlock();
+  if (unused) {
+    unused->close();
+    unused.reset();
+    QFile::remove(unusedPath);
+    qDebug() << "删除提前打开、没用上的分段:" << unusedPath;
+  }
+}
+
+void CameraController::takeSegmentReport(
+    const RecordSegmenter::Segment &segment,
+    RecordingDiagnostics::RecordingReport *report) {
+  const qint64 inputOk = m_recordInputOk.load();
+  const qint64 inputFail = m_recordInputFail.load();
+  const qint64 convertFail = m_recordConvertFail.load();
+  const uint64_t dropped = m_pipeline.stageStats(m_recordStage).dropped;
+  report->inputOk = inputOk - m_segmentInputOkBase;
+  report->inputFail = inputFail - m_segmentInputFailBase;
+  report->convertFail = convertFail - m_segmentConvertFailBase;
+  // 队列满丢帧发生在入队时，算进丢帧那一刻正在写的段
+  report->queueDrop = static_cast<qint64>(dropped - m_segmentDropBase);
+  report->totalFrames = report->inputOk + report->inputFail +
+                        report->convertFail + report->queueDrop;
+  report->lastErrCode = m_lastInputErrorCode.load();
+  report->pixelType = m_recordingActualPixelType;
+  report->telemetry = m_segmentTelemetry.summary();
+  report->threads = appliedThreadTuning();
+  report->segmentIndex = segment.index;
+  report->segmentFrames = static_cast<qint64>(segment.frames);
+  report->segmentFirstFrameNum = segment.firstFrameNum;
+  report->segmentLastFrameNum = segment.lastFrameNum;
+  report->segmentFirstGrabNs = segment.firstGrabNs;
+  report->segmentLastGrabNs = segment.lastGrabNs;
+
+  m_segmentInputOkBase = inputOk;
+  m_segmentInputFailBase = inputFail;
+  m_segmentConvertFailBase = convertFail;
+  m_segmentDropBase = dropped;
+  m_segmentTelemetry.reset(m_recordTickHz);
+}
+
+void CameraController::fillRecordingStartReport(
+    int64_t syncStartNs, RecordingDiagnostics::RecordingReport *report) const {
+  if (RecordingSyncGate::isCommonStart(syncStartNs)) {
+    report->syncStartNs = syncStartNs;
+    report->syncGroup = m_recordSyncGroup;
+    report->firstFrameGrabNs = m_recordFirstGrabNs;
+    report->firstFrameDevTimestamp = m_recordFirstDevTimestamp;
+  }
+  report->preTriggerFrames = m_recordPreTriggerFrames;
+  report->preTriggerSpanMs = m_recordPreTriggerSpanMs;
+  report->preTriggerLost = m_recordPreTriggerLost;
+}
 
-      m_frameCount++;
-      emit frameRendered(m_frameCount);
+void CameraController::closeSegment(
+    std::unique_ptr<IRecordWriter> writer, QString path,
+    RecordingDiagnostics::RecordingReport report) {
+  const bool ok = closeRecordWriter(*writer, &report);
+  {
+    std::lock_guard<std::mutex> lock(m_segmentMutex);
+    m_segmentClosedBytes += report.fileBytes;
+  }
+  if (report.fileBytes > 0 &&
+      !RecordingDiagnostics::writeRecordingReport(path, report))
+    qWarning() << "写录制统计失败:"
+               << RecordingDiagnostics::statsSidecarPath(path);
+  const int index = report.segmentIndex;
+  const qint64 bytes = report.fileBytes;
+  const QString writerError = report.writerError;
+  QMetaObject::invokeMethod(
+      this,
+      [this, ok, path, index, bytes, writerError]() {
+        if (!ok)
+          emit recordingError(
+              QString("录制分段写入失败: %1 (%2)").arg(writerError, path));
+        emit recordingSegmentSaved(path, index, bytes);
+      },
+      Qt::QueuedConnection);
+}
 
-      MV_CC_FreeImageBuffer(m_cameraHandle, &frameOut);
+bool CameraController::inputRecordFrame(const FrameRef &frame) {
+  // 调用方持有 m_recordMutex 且 m_recordWriter 已打开
+  const FrameInfo &info = frame.info();
+  FrameRef converted;
+  const uint8_t *data = frame.data();
+  std::size_t dataLen = info.frameLen;
+
+  if (m_recordingNeedsConvert) {
+    // 转 Mono8 / BGR8：dstSize = w * h * 1 / 3，输出缓冲来自 m_convertPool
+    const MvGvspPixelType dstPixelType =
+        static_cast<MvGvspPixelType>(m_recordingActualPixelType);
+    const unsigned int dstSize =
+        static_cast<unsigned int>(info.extendWidth) * info.extendHeight *
+        (dstPixelType == PixelType_Gvsp_Mono8 ? 1 : 3);
+    converted = m_convertPool.acquire();
+    if (!converted || converted.capacity() < dstSize) {
+      m_recordConvertFail.fetch_add(1);
+      qWarning() << "转换缓冲池不可用，丢弃一帧";
+      return false;
+    }
+    unsigned int dstLen = dstSize;
+    BayerDemosaic::Pattern pattern;
+    const PixelFormats::Descriptor *srcFormat =
+        PixelFormats::find(info.pixelType);
+    if (dstPixelType == PixelType_Gvsp_Mono8 && srcFormat &&
+        srcFormat->family == PixelFormats::Family::Mono &&
+        PixelUnpack::canUnpack(info.pixelType)) {
+      // 10/12/16 位黑白（含打包格式）：自己拆包取高 8 位，不经 SDK
+      if (!PixelUnpack::toU8(frame.data(), info.frameLen, info.pixelType,
+                             static_cast<int>(info.extendWidth),
+                             static_cast<int>(info.extendHeight),
+                             converted.writableData())) {
+        m_recordConvertFail.fetch_add(1);
+        qWarning() << "高位深拆包失败，丢弃一帧:"
+                   << RecordingDiagnostics::pixelTypeName(info.pixelType)
+                   << info.frameLen << "字节";
+        return false;
+      }
+    } else if (BayerDemosaic::patternFor(info.pixelType, &pattern) &&
+        info.frameLen >= std::size_t(info.extendWidth) * info.extendHeight) {
+      // 8 位 Bayer：自己的 SIMD 双线性插值，按水平条带分给 m_convertTiles，
+      // 全部条带完成才往下走，写入顺序不变
+      const int w = static_cast<int>(info.extendWidth);
+      const int h = static_cast<int>(info.extendHeight);
+      const bool mono = dstPixelType == PixelType_Gvsp_Mono8;
+      uint8_t *dst = converted.writableData();
+      std::atomic<bool> ok{true};
+      m_convertTiles->run(h, kConvertMinTileRows, [&](int y0, int y1) {
+        const bool tileOk =
+            mono ? BayerDemosaic::toMono8Rows(frame.data(), w, h, w, pattern,
+                                              dst, w, m_recordingMonoMethod,
+                                              y0, y1)
+                 : BayerDemosaic::toBgr8Rows(frame.data(), w, h, w, pattern,
+                                             dst, w * 3, y0, y1);
+        if (!tileOk)
+          ok.store(false, std::memory_order_relaxed);
+      });
+      if (!ok.load(std::memory_order_relaxed)) {
+        m_recordConvertFail.fetch_add(1);
+        qWarning() << "Bayer 插值失败，丢弃一帧:" << w << "x" << h;
+        return false;
+      }
     } else {
-      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      MV_CC_PIXEL_CONVERT_PARAM_EX cvt;
+      memset(&cvt, 0, sizeof(cvt));
+      cvt.nWidth = static_cast<unsigned short>(info.extendWidth);
+      cvt.nHeight = static_cast<unsigned short>(info.extendHeight);
+      cvt.pSrcData = const_cast<unsigned char *>(frame.data());
+      cvt.nSrcDataLen = static_cast<unsigned int>(info.frameLen);
+      cvt.enSrcPixelType = static_cast<MvGvspPixelType>(info.pixelType);
+      cvt.enDstPixelType = dstPixelType;
+      cvt.pDstBuffer = converted.writableData();
+      cvt.nDstBufferSize = dstSize;
+      int cret = MV_CC_ConvertPixelTypeEx(m_backend->sdkHandle(), &cvt);
+      if (cret != MV_OK) {
+        m_recordConvertFail.fetch_add(1);
+        m_lastInputErrorCode.store(static_cast<quint32>(cret));
+        qWarning() << "ConvertPixelTypeEx 失败:" << Qt::hex << cret;
+        return false;
+      }
+      dstLen = cvt.nDstLen;
     }
+    converted.writableInfo() = info;
+    converted.writableInfo().pixelType = dstPixelType;
+    converted.writableInfo().frameLen = dstLen;
+    data = converted.writableData();
+    dataLen = dstLen;
+  }
+
+  // 帧尾可能带填充，只写录制尺寸对应的字节数；不够一帧的交给 writeFrame 报错
+  IRecordWriter::FrameMeta meta;
+  meta.frameNum = info.frameNum;
+  meta.devTimestamp = info.devTimestamp;
+  meta.grabTimeNs = info.grabTimeNs;
+  const bool ok = m_recordWriter->writeFrame(
+      data, dataLen >= m_recordFrameBytes ? m_recordFrameBytes : dataLen, meta);
+  if (!ok) {
+    m_recordInputFail.fetch_add(1);
+    // 写到日志文件，方便后续诊断（qInstallMessageHandler 已接管 qWarning）
+    if (m_recordInputFail.load() <= 5) {
+      qWarning() << "写入录制帧失败 #" << m_recordInputFail.load()
+                 << QString::fromStdString(m_recordWriter->error())
+                 << "dataLen=" << dataLen;
+    }
+  } else {
+    m_recordInputOk.fetch_add(1);
+  }
+  return ok;
+}
+
+void CameraController::refreshSnapshotFrame() {
+  // 调用方持有 m_frameMutex。有新帧时换成新帧的引用，没有就沿用上一帧；
+  // 信箱 front 槽立即放掉，只由 m_snapshotFrame 持有
+  FrameRef frame;
+  if (m_snapshotMailbox.acquire(frame) && frame) {
+    m_snapshotFrame = std::move(frame);
+  }
+  frame.reset();
+  m_snapshotMailbox.releaseReader();
+}
+
+std::size_t CameraController::queryFrameBytes() const {
+  ICameraBackend::IntValue payload;
+  if (m_backend->getInt("PayloadSize", payload) == ICameraBackend::kOk &&
+      payload.current > 0) {
+    return static_cast<std::size_t>(payload.current);
+  }
+
+  ICameraBackend::IntValue w, h;
+  uint32_t fmt = 0;
+  if (m_backend->getInt("Width", w) != ICameraBackend::kOk ||
+      m_backend->getInt("Height", h) != ICameraBackend::kOk ||
+      m_backend->getEnum("PixelFormat", fmt) != ICameraBackend::kOk) {
+    qWarning() << "无法获取 PayloadSize / 宽高 / 像素格式";
+    return 0;
   }
+  return FramePool::frameBytesFor(static_cast<uint32_t>(w.current),
+                                  static_cast<uint32_t>(h.current), fmt);
+}
+
+std::vector<AcquisitionPipeline::StageStats>
+CameraController::pipelineStats() const {
+  return m_pipeline.stats();
+}
+
+double CameraController::queryTimestampTickHz() const {
+  ICameraBackend::IntValue v;
+  if (m_backend->getInt("GevTimestampTickFrequency", v) ==
+          ICameraBackend::kOk &&
+      v.current > 0)
+    return static_cast<double>(v.current);
+  return 1e9;
 }
 
 // ============================================================================
@@ -364,8 +1053,8 @@ void CameraController::grabLoop() {
 void CameraController::setExposure(float microseconds) {
   if (!m_isOpen)
     return;
-  int ret = MV_CC_SetFloatValue(m_cameraHandle, "ExposureTime", microseconds);
-  if (ret != MV_OK) {
+  int ret = m_backend->setFloat("ExposureTime", microseconds);
+  if (ret != ICameraBackend::kOk) {
     qWarning() << "设置曝光失败:" << Qt::hex << ret;
   }
 }
@@ -373,8 +1062,8 @@ void CameraController::setExposure(float microseconds) {
 void CameraController::setGain(float db) {
   if (!m_isOpen)
     return;
-  int ret = MV_CC_SetFloatValue(m_cameraHandle, "Gain", db);
-  if (ret != MV_OK) {
+  int ret = m_backend->setFloat("Gain", db);
+  if (ret != ICameraBackend::kOk) {
     qWarning() << "设置增益失败:" << Qt::hex << ret;
   }
 }
@@ -383,8 +1072,9 @@ void CameraController::setFrameRate(float fps) {
   if (!m_isOpen)
     return;
   // MVS 方案：只有在用户启用帧率限制时才设置
-  int ret = MV_CC_SetFloatValue(m_cameraHandle, "AcquisitionFrameRate", fps);
-  if (ret != MV_OK) {
+  m_frameRateLimitFps = fps;
+  int ret = m_backend->setFloat("AcquisitionFrameRate", fps);
+  if (ret != ICameraBackend::kOk) {
     qWarning() << "设置帧率失败:" << Qt::hex << ret;
   }
 }
@@ -392,59 +1082,417 @@ void CameraController::setFrameRate(float fps) {
 void CameraController::setFrameRateEnable(bool enable) {
   if (!m_isOpen)
     return;
-  int ret =
-      MV_CC_SetBoolValue(m_cameraHandle, "AcquisitionFrameRateEnable", enable);
-  if (ret != MV_OK) {
+  m_frameRateLimitEnabled = enable;
+  int ret = m_backend->setBool("AcquisitionFrameRateEnable", enable);
+  if (ret != ICameraBackend::kOk) {
     qWarning() << "设置帧率启用失败:" << Qt::hex << ret;
   }
 }
 
+void CameraController::emitResolutionInfo() {
+  // 分辨率 (宽/高/最大值)
+  ICameraBackend::IntValue intVal;
+  int w = 0, h = 0;
+  int wMax = 0, hMax = 0;
+  int wInc = 8, hInc = 8;
+
+  if (m_backend->getInt("Width", intVal) == ICameraBackend::kOk) {
+    w = static_cast<int>(intVal.current);
+    wMax = static_cast<int>(intVal.max);
+    wInc = intVal.inc > 0 ? static_cast<int>(intVal.inc) : 8;
+    m_widthInc = wInc; // 保存步长
+  }
+  if (m_backend->getInt("Height", intVal) == ICameraBackend::kOk) {
+    h = static_cast<int>(intVal.current);
+    hMax = static_cast<int>(intVal.max);
+    hInc = intVal.inc > 0 ? static_cast<int>(intVal.inc) : 8;
+    m_heightInc = hInc; // 保存步长
+  }
+
+  if (w > 0 && h > 0) {
+    emit resolutionReady(w, h, wInc, hInc);
+    qDebug() << "分辨率:" << w << "x" << h << " 步长:" << wInc << "x" << hInc;
+  }
+  if (wMax > 0 && hMax > 0) {
+    emit resolutionMaxReady(wMax, hMax);
+    qDebug() << "最大分辨率:" << wMax << "x" << hMax;
+  }
+
+  // 偏移量 (OffsetX/OffsetY)
+  int offX = 0, offY = 0;
+  if (m_backend->getInt("OffsetX", intVal) == ICameraBackend::kOk)
+    offX = static_cast<int>(intVal.current);
+  if (m_backend->getInt("OffsetY", intVal) == ICameraBackend::kOk)
+    offY = static_cast<int>(intVal.current);
+  emit offsetReady(offX, offY);
+}
+
 void CameraController::setOffsetX(int offset) {
-  if (!m_isOpen)
+  Roi r = roi();
+  if (r.isEmpty())
     return;
-  int ret = MV_CC_SetIntValue(m_cameraHandle, "OffsetX", offset);
-  if (ret != MV_OK)
-    qWarning() << "设置OffsetX失败:" << Qt::hex << ret;
+  r.x = offset;
+  setRoi(r);
 }
 
 void CameraController::setOffsetY(int offset) {
-  if (!m_isOpen)
+  Roi r = roi();
+  if (r.isEmpty())
     return;
-  int ret = MV_CC_SetIntValue(m_cameraHandle, "OffsetY", offset);
-  if (ret != MV_OK)
-    qWarning() << "设置OffsetY失败:" << Qt::hex << ret;
+  r.y = offset;
+  setRoi(r);
 }
 
 void CameraController::setWidth(int width) {
-  if (!m_isOpen)
+  Roi r = roi();
+  if (r.isEmpty())
     return;
+  r.width = width;
+  setRoi(r);
+}
+
+void CameraController::setHeight(int height) {
+  Roi r = roi();
+  if (r.isEmpty())
+    return;
+  r.height = height;
+  setRoi(r);
+}
+
+Roi CameraController::roi() {
+  Roi r;
+  RoiLimits limits;
+  if (!m_isOpen || !queryRoi(r, limits))
+    return Roi();
+  return r;
+}
+
+bool CameraController::queryRoi(Roi &roi, RoiLimits &limits) {
+  ICameraBackend::IntValue width, height, offX, offY;
+  if (m_backend->getInt("Width", width) != ICameraBackend::kOk ||
+      m_backend->getInt("Height", height) != ICameraBackend::kOk)
+    return false;
+  // 没有偏移节点的相机只能改尺寸
+  if (m_backend->getInt("OffsetX", offX) != ICameraBackend::kOk)
+    offX = {0, 0, 0, 1};
+  if (m_backend->getInt("OffsetY", offY) != ICameraBackend::kOk)
+    offY = {0, 0, 0, 1};
+  roi = {static_cast<int>(offX.current), static_cast<int>(offY.current),
+         static_cast<int>(width.current), static_cast<int>(height.current)};
+
+  // Width 的 max 随当前 OffsetX 变，传感器尺寸要看 WidthMax
+  ICameraBackend::IntValue v;
+  limits.widthMax =
+      m_backend->getInt("WidthMax", v) == ICameraBackend::kOk
+          ? static_cast<int>(v.current)
+          : static_cast<int>(width.max + offX.current);
+  limits.heightMax =
+      m_backend->getInt("HeightMax", v) == ICameraBackend::kOk
+          ? static_cast<int>(v.current)
+          : static_cast<int>(height.max + offY.current);
+  limits.widthMin = static_cast<int>(std::max<int64_t>(1, width.min));
+  limits.heightMin = static_cast<int>(std::max<int64_t>(1, height.min));
+  limits.widthInc = width.inc > 0 ? static_cast<int>(width.inc) : m_widthInc;
+  limits.heightInc =
+      height.inc > 0 ? static_cast<int>(height.inc) : m_heightInc;
+  limits.offsetXInc = offX.inc > 0 ? static_cast<int>(offX.inc) : 1;
+  limits.offsetYInc = offY.inc > 0 ? static_cast<int>(offY.inc) : 1;
+  return true;
+}
+
+int CameraController::applyRoiSteps(const std::vector<RoiStep> &steps) {
+  for (const RoiStep &step : steps) {
+    const int ret = m_backend->setInt(step.key, step.value);
+    if (ret != ICameraBackend::kOk) {
+      qWarning() << "设置" << step.key << "=" << step.value
+                 << "失败:" << errorCodeText(ret);
+      return ret;
+    }
+  }
+  return ICameraBackend::kOk;
+}
 
-  // 自动对齐到步长
-  if (m_widthInc > 1) {
-    width = (width / m_widthInc) * m_widthInc;
-    if (width < m_widthInc)
-      width = m_widthInc;
+bool CameraController::canReconfigure(const QString &what) {
+  if (!m_isOpen)
+    return false;
+  if (m_isRecording) {
+    emit error(QString("录制中不能修改%1").arg(what));
+    return false;
+  }
+  if (m_burstState != BurstState::Idle) {
+    emit error(QString("连拍进行中不能修改%1").arg(what));
+    return false;
   }
+  return true;
+}
 
-  int ret = MV_CC_SetIntValue(m_cameraHandle, "Width", width);
-  if (ret != MV_OK)
-    qWarning() << "设置Width失败:" << Qt::hex << ret;
+bool CameraController::reconfigure(const std::function<void()> &apply,
+                                   double *reconfigureMs) {
+  const auto t0 = std::chrono::steady_clock::now();
+  const bool wasGrabbing = m_isGrabbing;
+  int64_t lastFrameNs = 0;
+  if (wasGrabbing) {
+    stopGrabbing();
+    // 停止后计数不再变化，重新开始采集时才清零
+    lastFrameNs = m_acqStats.snapshot().lastGrabNs;
+  }
+  apply();
+  if (wasGrabbing) {
+    m_reconfigureGapStartNs.store(lastFrameNs, std::memory_order_relaxed);
+    if (!startGrabbing()) {
+      m_reconfigureGapStartNs.store(0, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  *reconfigureMs = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - t0)
+                       .count();
+  return true;
 }
 
-void CameraController::setHeight(int height) {
+bool CameraController::setRoi(const Roi &requested) {
+  if (!canReconfigure(" ROI"))
+    return false;
+  Roi current;
+  RoiLimits limits;
+  if (!queryRoi(current, limits)) {
+    emit error("修改 ROI 失败: 无法读取当前 ROI");
+    return false;
+  }
+  const Roi target = RoiPlanner::align(requested, limits);
+  if (target == current)
+    return true;
+
+  Roi applied = target;
+  int ret = ICameraBackend::kOk;
+  double reconfigureMs = 0.0;
+  const bool restarted = reconfigure(
+      [&] {
+        ret = applyRoiSteps(RoiPlanner::plan(current, target));
+        if (ret != ICameraBackend::kOk) {
+          // 从实际停下的位置规划回原 ROI
+          Roi partial;
+          RoiLimits unused;
+          if (queryRoi(partial, unused))
+            applyRoiSteps(RoiPlanner::plan(partial, current));
+          if (!queryRoi(applied, unused))
+            applied = current;
+          emit error(QString("修改 ROI 失败: %1").arg(errorCodeText(ret)));
+        }
+        m_widthInc = limits.widthInc;
+        m_heightInc = limits.heightInc;
+        emit resolutionReady(applied.width, applied.height, m_widthInc,
+                             m_heightInc);
+        emit offsetReady(applied.x, applied.y);
+      },
+      &reconfigureMs);
+  if (!restarted)
+    return false;
+  qInfo() << "ROI:" << applied.x << applied.y << applied.width << "x"
+          << applied.height << "重配置耗时" << reconfigureMs << "ms";
+  emit roiReconfigured(applied.x, applied.y, applied.width, applied.height,
+                       reconfigureMs);
+  return ret == ICameraBackend::kOk;
+}
+
+// ============================================================================
+// Binning / 抽样
+// ============================================================================
+
+namespace {
+// 链路标称速率扣掉协议开销后的有效带宽（GigE 1000 Mbps 约 118 MB/s 可用）
+constexpr double kLinkEfficiency = 0.94;
+
+const char *const kSamplingKeys[] = {"BinningHorizontal", "BinningVertical",
+                                     "DecimationHorizontal",
+                                     "DecimationVertical"};
+
+int *samplingField(SamplingMode &mode, int index) {
+  int *fields[] = {&mode.binningH, &mode.binningV, &mode.decimationH,
+                   &mode.decimationV};
+  return fields[index];
+}
+
+int samplingValue(SamplingMode mode, int index) {
+  return *samplingField(mode, index);
+}
+} // namespace
+
+double CameraController::queryLinkBytesPerSec() const {
+  // DeviceLinkSpeed 单位 Mbps
+  ICameraBackend::IntValue link;
+  if (m_backend->getInt("DeviceLinkSpeed", link) == ICameraBackend::kOk &&
+      link.current > 0)
+    return double(link.current) * 1e6 / 8.0 * kLinkEfficiency;
+  return 0.0;
+}
+
+SamplingOptions CameraController::samplingOptions() {
+  SamplingOptions options;
   if (!m_isOpen)
-    return;
+    return options;
+  std::vector<int> *lists[] = {&options.binningH, &options.binningV,
+                               &options.decimationH, &options.decimationV};
+  for (int i = 0; i < 4; ++i) {
+    std::vector<uint32_t> entries;
+    if (m_backend->getEnumEntries(kSamplingKeys[i], entries) !=
+        ICameraBackend::kOk)
+      continue;
+    for (uint32_t v : entries)
+      if (v >= 1)
+        lists[i]->push_back(static_cast<int>(v));
+  }
+  return options;
+}
 
-  // 自动对齐到步长
-  if (m_heightInc > 1) {
-    height = (height / m_heightInc) * m_heightInc;
-    if (height < m_heightInc)
-      height = m_heightInc;
+SamplingMode CameraController::samplingMode() {
+  SamplingMode mode;
+  if (!m_isOpen)
+    return mode;
+  for (int i = 0; i < 4; ++i) {
+    uint32_t v = 0;
+    if (m_backend->getEnum(kSamplingKeys[i], v) == ICameraBackend::kOk &&
+        v >= 1)
+      *samplingField(mode, i) = static_cast<int>(v);
   }
+  return mode;
+}
+
+FrameRateEstimate
+CameraController::estimateSamplingMode(const SamplingMode &target) {
+  FrameRateModelInput input;
+  input.mode = samplingMode();
+  ICameraBackend::IntValue w, h, payload;
+  if (!m_isOpen || m_backend->getInt("Width", w) != ICameraBackend::kOk ||
+      m_backend->getInt("Height", h) != ICameraBackend::kOk)
+    return FrameRateEstimate();
+  input.width = static_cast<int>(w.current);
+  input.height = static_cast<int>(h.current);
+  if (m_backend->getInt("PayloadSize", payload) == ICameraBackend::kOk &&
+      w.current > 0 && h.current > 0)
+    input.bytesPerPixel = double(payload.current) / (w.current * h.current);
+  input.resultingFps = currentResultingFps();
+  ICameraBackend::FloatValue exposure;
+  if (m_backend->getFloat("ExposureTime", exposure) == ICameraBackend::kOk)
+    input.exposureUs = exposure.current;
+  input.frameRateLimit = m_frameRateLimitEnabled ? m_frameRateLimitFps : 0.0;
+  input.linkBytesPerSec = queryLinkBytesPerSec();
+  return FrameRateEstimator::estimate(input, target);
+}
+
+bool CameraController::setSamplingMode(const SamplingMode &mode) {
+  if (!canReconfigure(" binning / 抽样"))
+    return false;
+  const SamplingMode current = samplingMode();
+  if (mode == current)
+    return true;
+  const FrameRateEstimate predicted = estimateSamplingMode(mode);
+
+  int ret = ICameraBackend::kOk;
+  double reconfigureMs = 0.0;
+  const bool restarted = reconfigure(
+      [&] {
+        for (int i = 0; i < 4 && ret == ICameraBackend::kOk; ++i) {
+          const int value = samplingValue(mode, i);
+          if (value == samplingValue(current, i))
+            continue;
+          ret = m_backend->setEnum(kSamplingKeys[i],
+                                   static_cast<uint32_t>(value));
+          if (ret != ICameraBackend::kOk)
+            qWarning() << "设置" << kSamplingKeys[i] << "=" << value
+                       << "失败:" << errorCodeText(ret);
+        }
+        if (ret != ICameraBackend::kOk) {
+          for (int i = 0; i < 4; ++i)
+            m_backend->setEnum(kSamplingKeys[i],
+                               static_cast<uint32_t>(samplingValue(current, i)));
+          emit error(QString("修改 binning / 抽样失败: %1")
+                         .arg(errorCodeText(ret)));
+        }
+        // 相机按新的倍数重算了 Width / Height / Offset 及其最大值
+        emitResolutionInfo();
+      },
+      &reconfigureMs);
+  if (!restarted)
+    return false;
 
-  int ret = MV_CC_SetIntValue(m_cameraHandle, "Height", height);
-  if (ret != MV_OK)
-    qWarning() << "设置Height失败:" << Qt::hex << ret;
+  const SamplingMode applied = samplingMode();
+  const float resultingFps = static_cast<float>(currentResultingFps());
+  emit resultingFrameRateReady(resultingFps);
+  qInfo() << "binning" << applied.binningH << "x" << applied.binningV
+          << "抽样" << applied.decimationH << "x" << applied.decimationV
+          << "预估最高" << predicted.maxFps << "fps，相机报告" << resultingFps
+          << "fps，重配置耗时" << reconfigureMs << "ms";
+  emit samplingModeChanged(applied, predicted, resultingFps);
+  return ret == ICameraBackend::kOk;
+}
+
+// ============================================================================
+// 像素格式协商
+// ============================================================================
+
+bool CameraController::setPixelWorkflow(PixelFormatNegotiator::Workflow workflow) {
+  if (workflow == m_pixelWorkflow)
+    return true;
+  if (!m_isOpen) {
+    // 下次 open 时按新用途协商
+    m_pixelWorkflow = workflow;
+    return true;
+  }
+  if (!canReconfigure("像素格式"))
+    return false;
+  m_pixelWorkflow = workflow;
+  double reconfigureMs = 0.0;
+  return reconfigure([this] { negotiatePixelFormat(); }, &reconfigureMs);
+}
+
+void CameraController::setBayerMonoMethod(BayerDemosaic::MonoMethod method) {
+  // 录制线程只读 m_recordingMonoMethod（openRecorder 时拷贝），这里随时可改
+  m_bayerMonoMethod = method;
+}
+
+void CameraController::negotiatePixelFormat() {
+  // 调用方保证没在采集（PixelFormat 采集中不可写）
+  PixelFormatNegotiator::Input input;
+  input.workflow = m_pixelWorkflow;
+  m_backend->getEnumEntries("PixelFormat", input.supported);
+  if (m_backend->getEnum("PixelFormat", input.current) != ICameraBackend::kOk) {
+    qWarning() << "读取 PixelFormat 失败，跳过像素格式协商";
+    return;
+  }
+  ICameraBackend::IntValue w, h;
+  if (m_backend->getInt("Width", w) != ICameraBackend::kOk ||
+      m_backend->getInt("Height", h) != ICameraBackend::kOk)
+    return;
+  input.width = static_cast<int>(w.current);
+  input.height = static_cast<int>(h.current);
+  input.linkBytesPerSec = queryLinkBytesPerSec();
+
+  PixelFormatNegotiator::Choice choice = PixelFormatNegotiator::negotiate(input);
+  if (!choice.valid()) {
+    qWarning() << "PixelFormat 可选值里没有认识的格式，保持"
+               << RecordingDiagnostics::pixelTypeName(input.current);
+    return;
+  }
+  if (choice.pixelType != input.current) {
+    const int ret = m_backend->setEnum("PixelFormat", choice.pixelType);
+    if (ret != ICameraBackend::kOk) {
+      qWarning() << "设置 PixelFormat 失败:" << errorCodeText(ret);
+      choice = PixelFormatNegotiator::evaluate(
+          input.current, m_pixelWorkflow, input.width, input.height,
+          input.linkBytesPerSec);
+      if (!choice.valid())
+        return;
+    }
+  }
+  // 帧到达前录制 / 抓拍也按新格式判断
+  m_pixelType = static_cast<int>(choice.pixelType);
+  qInfo() << "像素格式协商:" << PixelFormatNegotiator::workflowName(m_pixelWorkflow)
+          << RecordingDiagnostics::pixelTypeName(choice.pixelType) << "→"
+          << RecordingDiagnostics::pixelTypeName(choice.recordPixelType)
+          << "转换" << choice.convertUsPerFrame << "us/帧，传输"
+          << choice.transferUsPerFrame << "us/帧";
+  emit pixelFormatNegotiated(choice, m_pixelWorkflow);
 }
 
 // ============================================================================
@@ -455,9 +1503,78 @@ bool CameraController::startRecording(const QString &filePath, float fps,
                                       int bitRateKbps) {
   if (!m_isOpen || m_isRecording)
     return false;
+  if (m_burstState != BurstState::Idle) {
+    emit recordingError("无法开始录制: 连拍进行中");
+    return false;
+  }
+
+  // 分段录制时第一个文件就是 _001，之后每段按序号往后排
+  const bool segmented = m_recordSegmentPolicy.enabled();
+  const QString firstPath =
+      segmented ? QString::fromStdString(RecordSegmenter::segmentPath(
+                      filePath.toStdString(), 1))
+                : filePath;
+  QString errorMessage;
+  bool opened = false;
+  {
+    std::lock_guard<std::mutex> lock(m_recordMutex);
+    opened = openRecorder(firstPath, fps, bitRateKbps, m_recordFileOptions,
+                          m_recordLossless, &errorMessage);
+  }
+  if (!opened) {
+    emit recordingError(errorMessage);
+    return false;
+  }
 
+  m_recordStageDropBase = m_pipeline.stageStats(m_recordStage).dropped;
+  const double tickHz = queryTimestampTickHz();
+  m_recordTelemetry.reset(tickHz);
+  {
+    std::lock_guard<std::mutex> lock(m_recordMutex);
+    m_recordFirstGrabNs = 0;
+    m_recordFirstDevTimestamp = 0;
+    m_recordPreTriggerFrames = 0;
+    m_recordPreTriggerSpanMs = 0;
+    m_recordPreTriggerLost = 0;
+    m_recordBasePath = filePath;
+    m_recordSegmenter.start(m_recordSegmentPolicy);
+    m_segmentRequested = 0;
+    m_recordTickHz = tickHz;
+    m_segmentTelemetry.reset(tickHz);
+    m_segmentInputOkBase = 0;
+    m_segmentInputFailBase = 0;
+    m_segmentConvertFailBase = 0;
+    m_segmentDropBase = m_recordStageDropBase;
+  }
+  if (segmented) {
+    qInfo() << "分段录制: 每段"
+            << m_recordSegmentPolicy.maxDurationNs / 60000000000LL << "分钟 /"
+            << (m_recordSegmentPolicy.maxBytes >> 20) << "MB（0 = 不限）";
+    {
+      std::lock_guard<std::mutex> lock(m_segmentMutex);
+      m_segmentStop = false;
+      m_segmentOpenIndex = 0;
+      m_segmentOpenDone = false;
+      m_segmentOpenError.clear();
+      m_segmentClosedBytes = 0;
+    }
+    m_segmentThread = std::thread(&CameraController::segmentWorker, this);
+  }
+
+  m_isRecording = true;
+  m_pipeline.setStageEnabled(m_recordStage, true);
+  emit recordingStarted(firstPath);
+  return true;
+}
+
+bool CameraController::openRecorder(const QString &filePath, float fps,
+                                    int bitRateKbps,
+                                    const RecordFile::Options &file,
+                                    bool lossless, QString *errorMessage) {
+  // 写的是未压缩 AVI / 原始容器，没有码率可调
+  Q_UNUSED(bitRateKbps);
   if (m_width == 0 || m_height == 0 || m_pixelType == 0) {
-    emit recordingError("无法开始录制: 尚未获取有效帧数据");
+    *errorMessage = "无法开始录制: 尚未获取有效帧数据";
     return false;
   }
 
@@ -471,14 +1588,20 @@ bool CameraController::startRecording(const QString &filePath, float fps,
     qDebug() << "录制 fps 自动取自相机:" << fps;
   }
 
-  // Phase 5 核心修复：判定相机当前像素类型是否被 SDK AVI 录制直接支持。
-  // 不支持（如 Bayer 系列、10/12-bit）时强制走 BGR8 + 转换路径，
-  // 否则 MV_CC_InputOneFrame 会静默失败，导致录出 0 字节文件。
-  m_recordingNeedsConvert = !RecordingDiagnostics::isPixelTypeDirectlyRecordable(
-      static_cast<quint32>(m_pixelType));
+  // Phase 5 核心修复：AVI 只收 Mono8 / BGR8 / RGB8 / YUV422，其余像素类型
+  // （如 Bayer 系列、10/12-bit）必须先转换。
+  // 转成什么由用途决定：黑白录制转 Mono8，彩色录制 / 仅预览转 BGR8。
+  // .wvr 原始容器不转换：认识的像素格式原样落盘（可选按帧无损压缩）
+  const bool rawContainer =
+      filePath.endsWith(".wvr", Qt::CaseInsensitive) &&
+      WvrWriter::supports(static_cast<uint32_t>(m_pixelType));
   const MvGvspPixelType recordPixelType =
-      m_recordingNeedsConvert ? PixelType_Gvsp_BGR8_Packed
-                              : static_cast<MvGvspPixelType>(m_pixelType);
+      rawContainer
+          ? static_cast<MvGvspPixelType>(m_pixelType)
+          : static_cast<MvGvspPixelType>(PixelFormatNegotiator::recordPixelType(
+                static_cast<uint32_t>(m_pixelType), m_pixelWorkflow));
+  m_recordingNeedsConvert =
+      static_cast<int>(recordPixelType) != m_pixelType;
   qDebug() << "录制像素类型:"
            << RecordingDiagnostics::pixelTypeName(
                   static_cast<quint32>(m_pixelType))
@@ -486,34 +1609,76 @@ bool CameraController::startRecording(const QString &filePath, float fps,
            << RecordingDiagnostics::pixelTypeName(
                   static_cast<quint32>(recordPixelType))
            << (m_recordingNeedsConvert ? "(需要转换)" : "(直接录制)");
+  BayerDemosaic::Pattern bayerPattern;
+  const bool bayer8 = BayerDemosaic::patternFor(
+      static_cast<uint32_t>(m_pixelType), &bayerPattern);
+  if (recordPixelType == PixelType_Gvsp_Mono8 && bayer8)
+    qDebug() << "Bayer → Mono8 取法:"
+             << BayerDemosaic::monoMethodName(m_bayerMonoMethod);
+
+  // 8 位 Bayer 插值、高位深黑白拆包自己做，其余转换还要走 SDK
+  const PixelFormats::Descriptor *srcFormat =
+      PixelFormats::find(static_cast<uint32_t>(m_pixelType));
+  const bool convertInHouse =
+      bayer8 || (recordPixelType == PixelType_Gvsp_Mono8 && srcFormat &&
+                 srcFormat->family == PixelFormats::Family::Mono &&
+                 PixelUnpack::canUnpack(static_cast<uint32_t>(m_pixelType)));
+  if (m_recordingNeedsConvert && !convertInHouse && !m_backend->sdkHandle()) {
+    *errorMessage = QString("无法开始录制: %1 后端不支持 %2 的像素转换")
+                        .arg(m_backend->backendName(),
+                             RecordingDiagnostics::pixelTypeName(
+                                 static_cast<quint32>(m_pixelType)));
+    return false;
+  }
+
+  // 转换输出缓冲一次分配好，录制过程中不再 resize
+  if (m_recordingNeedsConvert) {
+    const std::size_t convertBytes =
+        static_cast<std::size_t>(std::max(m_extendWidth, m_width)) *
+        std::max(m_extendHeight, m_height) *
+        (recordPixelType == PixelType_Gvsp_Mono8 ? 1 : 3);
+    if (!m_convertPool.configure(kConvertPoolBuffers, convertBytes)) {
+      *errorMessage = "无法开始录制: 转换缓冲仍被占用";
+      return false;
+    }
+    if (!m_convertTiles)
+      m_convertTiles = std::make_unique<TilePool>(
+          std::min(ThreadAffinity::coreCount() - 1, kMaxConvertWorkers));
+  }
 
-  MV_CC_RECORD_PARAM recordParam;
-  memset(&recordParam, 0, sizeof(MV_CC_RECORD_PARAM));
-  recordParam.enRecordFmtType = MV_FormatType_AVI;
-  recordParam.nWidth = static_cast<unsigned short>(m_width);
-  recordParam.nHeight = static_cast<unsigned short>(m_height);
-  recordParam.fFrameRate = fps;
-  recordParam.nBitRate = bitRateKbps;
-  recordParam.enPixelType = recordPixelType;
-
-  // SDK 在 Windows 下需要本地编码 (GBK) 路径，用 toLocal8Bit()
-  // 同时保留 QString 版本，因为 QFileInfo 等 Qt 工具需要 Unicode 路径，
-  // 否则 fromStdString(GBK bytes) = fromUtf8(GBK) 会乱码，导致 stat 失败永远返回 size=0
-  m_recordingPath = filePath.toLocal8Bit().constData();
+  // 转换输出和直接录制的帧都是 extendWidth × extendHeight
+  IRecordWriter::Format options;
+  options.width = m_extendWidth > 0 ? m_extendWidth : m_width;
+  options.height = m_extendHeight > 0 ? m_extendHeight : m_height;
+  options.pixelType = static_cast<uint32_t>(recordPixelType);
+  options.fps = fps;
   m_recordingPathQt = filePath;
-  recordParam.strFilePath = const_cast<char *>(m_recordingPath.c_str());
 
   qDebug() << "开始录制:" << filePath;
-  qDebug() << "  尺寸:" << m_width << "x" << m_height;
+  qDebug() << "  尺寸:" << options.width << "x" << options.height;
   qDebug() << "  像素类型:" << m_pixelType;
-  qDebug() << "  FPS:" << fps << ", 码率:" << bitRateKbps << "kbps";
-
-  int ret = MV_CC_StartRecord(m_cameraHandle, &recordParam);
-  if (ret != MV_OK) {
-    emit recordingError(
-        QString("录制启动失败: 0x%1").arg(ret, 8, 16, QChar('0')));
+  qDebug() << "  FPS:" << fps;
+
+  qDebug() << "  写盘缓冲:" << file.bufferCount << "×"
+           << file.bufferBytes / (1 << 20) << "MB, 直接 I/O:" << file.directIo
+           << ", 预分配:" << file.preallocateBytes / (1 << 20) << "MB";
+  m_recordFormat = options;
+  m_recordWriterFile = file;
+  m_recordRawContainer = rawContainer;
+  m_recordWriterLossless = lossless;
+  m_recordWriter = createRecordWriter(filePath, errorMessage);
+  if (!m_recordWriter)
     return false;
-  }
+  qDebug() << "  容器:" << m_recordWriter->containerName();
+  if (lossless && !rawContainer)
+    qDebug() << "  无损压缩只用于 WVR，AVI 不压缩";
+  else if (lossless &&
+           static_cast<WvrWriter *>(m_recordWriter.get())->codec() ==
+               WvrFormat::kCodecNone)
+    qWarning() << "  无损压缩不支持该像素格式，原样录制";
+  else if (lossless)
+    qDebug() << "  无损压缩: 开";
+  m_recordFrameBytes = m_recordWriter->frameBytes();
 
   // Phase 5：重置统计计数 + 记录实际像素类型
   m_recordInputOk = 0;
@@ -521,18 +1686,233 @@ bool CameraController::startRecording(const QString &filePath, float fps,
   m_recordConvertFail = 0;
   m_lastInputErrorCode = 0;
   m_recordingActualPixelType = static_cast<quint32>(recordPixelType);
+  m_recordingMonoMethod = m_bayerMonoMethod;
+  return true;
+}
 
-  m_isRecording = true;
-  emit recordingStarted(filePath);
+std::unique_ptr<IRecordWriter>
+CameraController::createRecordWriter(const QString &filePath,
+                                     QString *errorMessage) {
+  // .wvr 之外都写 AVI（含原生格式不认识、退回转换的情况，扩展名照旧）
+  std::unique_ptr<IRecordWriter> writer;
+  if (m_recordRawContainer)
+    writer = std::make_unique<WvrWriter>();
+  else
+    writer = std::make_unique<AviWriter>();
+
+  // 路径按 UTF-8 交给写入器，Windows 下它自己转宽字符打开
+  const std::string path = filePath.toUtf8().toStdString();
+  bool opened = false;
+  if (m_recordRawContainer) {
+    WvrWriter::Options wvrOptions;
+    static_cast<IRecordWriter::Format &>(wvrOptions) = m_recordFormat;
+    wvrOptions.file = m_recordWriterFile;
+    wvrOptions.codec = m_recordWriterLossless ? WvrFormat::kCodecLossless
+                                              : WvrFormat::kCodecNone;
+    opened = static_cast<WvrWriter *>(writer.get())->open(path, wvrOptions);
+  } else {
+    opened = writer->open(path, m_recordFormat, m_recordWriterFile);
+  }
+  if (!opened) {
+    *errorMessage = QString("录制启动失败: %1")
+                        .arg(QString::fromStdString(writer->error()));
+    return nullptr;
+  }
+  return writer;
+}
+
+// ============================================================================
+// 连拍
+// ============================================================================
+
+bool CameraController::startBurst(const QString &filePath, int frameCount,
+                                  std::size_t memoryBudgetBytes,
+                                  int bitRateKbps) {
+  if (!m_isGrabbing || m_burstState != BurstState::Idle)
+    return false;
+  if (m_isRecording) {
+    emit burstError("无法开始连拍: 正在录制");
+    return false;
+  }
+  const std::size_t frameBytes = m_framePool.bufferBytes();
+  const std::size_t slotCount = BurstCapture::slotsFor(
+      frameCount > 0 ? static_cast<std::size_t>(frameCount) : 0,
+      memoryBudgetBytes, frameBytes);
+  if (slotCount == 0) {
+    emit burstError("无法开始连拍: 内存预算不足一帧");
+    return false;
+  }
+  // 预分配并逐页写一遍，之后连拍阶段只做 memcpy
+  if (!m_burst.configure(slotCount, frameBytes)) {
+    emit burstError("无法开始连拍: 上一次连拍的帧仍被占用");
+    return false;
+  }
+
+  m_burstPath = filePath;
+  m_burstBitRateKbps = bitRateKbps;
+  m_burstFileOptions = m_recordFileOptions;
+  m_burstLossless = m_recordLossless;
+  m_burstCancel = false;
+  m_burstState = BurstState::Capturing;
+  m_pipeline.setStageEnabled(m_burstStage, true);
+  qInfo() << "开始连拍:" << slotCount << "帧 ×" << frameBytes << "字节 →" << filePath;
+  emit burstStarted(filePath, static_cast<int>(slotCount));
   return true;
 }
 
+void CameraController::cancelBurst() {
+  if (m_burstState == BurstState::Capturing) {
+    m_pipeline.setStageEnabled(m_burstStage, false);
+    m_pipeline.waitStageIdle(m_burstStage, std::chrono::seconds(1));
+    m_burst.release();
+    m_burstState = BurstState::Idle;
+    qInfo() << "连拍已取消";
+  } else if (m_burstState == BurstState::Flushing) {
+    m_burstCancel = true;
+  }
+}
+
+void CameraController::burstFrame(const FrameRef &frame) {
+  switch (m_burst.store(frame)) {
+  case BurstCapture::StoreResult::Complete:
+    // 不再收帧；落盘在 UI 线程发起
+    m_pipeline.setStageEnabled(m_burstStage, false);
+    QMetaObject::invokeMethod(this, &CameraController::finishBurstCapture,
+                              Qt::QueuedConnection);
+    break;
+  case BurstCapture::StoreResult::Oversize:
+    qWarning() << "连拍: 帧大小超过预分配缓冲，丢弃";
+    break;
+  case BurstCapture::StoreResult::Stored:
+  case BurstCapture::StoreResult::Full:
+    break;
+  }
+}
+
+void CameraController::finishBurstCapture() {
+  if (m_burstState != BurstState::Capturing)
+    return;
+  m_pipeline.setStageEnabled(m_burstStage, false);
+  // 连拍阶段线程不再碰 m_burst 之后才交给落盘线程
+  m_pipeline.waitStageIdle(m_burstStage, std::chrono::seconds(1));
+
+  const BurstCapture::Stats st = m_burst.stats();
+  qInfo() << "连拍完成: 抓到" << st.captured << "/" << st.target << "帧"
+          << "丢帧" << st.dropped << "实际帧率" << st.achievedFps << "fps"
+          << "时长" << st.durationMs << "ms";
+  emit burstCaptured(st);
+  if (st.captured == 0) {
+    m_burst.release();
+    m_burstState = BurstState::Idle;
+    emit burstError("连拍没有抓到帧");
+    return;
+  }
+
+  m_burstState = BurstState::Flushing;
+  if (m_burstFlushThread.joinable())
+    m_burstFlushThread.join();
+  m_burstFlushThread = std::thread(&CameraController::flushBurst, this);
+}
+
+void CameraController::flushBurst() {
+  const BurstCapture::Stats st = m_burst.stats();
+  QString errorMessage;
+  bool ok = false;
+  std::size_t written = 0;
+  RecordingDiagnostics::RecordingReport report;
+  {
+    std::lock_guard<std::mutex> lock(m_recordMutex);
+    // 按实际连拍帧率写文件，播放时长与真实时长一致
+    ok = openRecorder(m_burstPath,
+                      st.achievedFps > 0.0 ? float(st.achievedFps) : -1.0f,
+                      m_burstBitRateKbps, m_burstFileOptions, m_burstLossless,
+                      &errorMessage);
+    if (ok) {
+      for (; written < m_burst.size() && !m_burstCancel; ++written)
+        inputRecordFrame(m_burst.frame(written));
+      if (!closeRecorder(&report))
+        errorMessage = QString("连拍写入失败: %1").arg(report.writerError);
+    }
+  }
+
+  report.inputOk = m_recordInputOk.load();
+  report.inputFail = m_recordInputFail.load();
+  report.convertFail = m_recordConvertFail.load();
+  report.totalFrames = static_cast<qint64>(st.captured);
+  report.lastErrCode = m_lastInputErrorCode.load();
+  report.pixelType = m_recordingActualPixelType;
+  report.telemetry.frames = st.captured;
+  report.telemetry.lostFrames = st.dropped;
+  report.telemetry.durationSec = st.durationMs / 1000.0;
+  report.telemetry.meanFps = st.achievedFps;
+  report.threads = appliedThreadTuning();
+  if (written < st.captured)
+    qWarning() << "连拍落盘提前结束，已写" << written << "/" << st.captured;
+
+  QMetaObject::invokeMethod(
+      this,
+      [this, ok, errorMessage, report]() {
+        if (m_burstFlushThread.joinable())
+          m_burstFlushThread.join();
+        m_burst.release();
+        m_burstState = BurstState::Idle;
+        if (!errorMessage.isEmpty())
+          emit burstError(errorMessage);
+        if (ok)
+          emitRecordingStats(m_burstPath, report, true);
+      },
+      Qt::QueuedConnection);
+}
+
+void CameraController::setRecordingSync(int64_t startNs, const QString &group) {
+  m_recordSyncGroup = group;
+  m_recordSync.set(startNs);
+}
+
+void CameraController::setPreTrigger(double seconds,
+                                     std::size_t memoryBudgetBytes) {
+  m_preTriggerSeconds = seconds > 0.0 ? seconds : 0.0;
+  m_preTriggerBudgetBytes = memoryBudgetBytes;
+  if (m_isGrabbing && !m_isRecording)
+    armPreTrigger(m_framePool.bufferBytes());
+}
+
+void CameraController::armPreTrigger(std::size_t frameBytes) {
+  std::lock_guard<std::mutex> lock(m_recordMutex);
+  // 录制中（可能还在补写历史）不动环，停止录制后再按新设置分配
+  if (m_isRecording)
+    return;
+  const float fps = currentResultingFps();
+  const std::size_t slotCount = PreTriggerRing::slotsFor(
+      m_preTriggerSeconds,
+      fps > 0.0f ? double(fps) : BufferSizingPolicy::kFallbackFps,
+      m_preTriggerBudgetBytes, frameBytes);
+  if (slotCount == 0) {
+    m_preTrigger.release();
+  } else if (slotCount != m_preTrigger.capacity() ||
+             frameBytes != m_preTrigger.slotBytes()) {
+    // 一次分配并写页，之后录制阶段每帧只做一次 memcpy
+    if (m_preTrigger.configure(slotCount, frameBytes)) {
+      qInfo() << "预触发缓冲:" << slotCount << "帧 ×" << frameBytes << "字节 ≈"
+              << m_preTriggerSeconds << "秒";
+      if (double(slotCount) < m_preTriggerSeconds * fps)
+        qWarning() << "预触发内存预算" << (m_preTriggerBudgetBytes >> 20)
+                   << "MiB 只够" << slotCount << "帧";
+    } else {
+      qWarning() << "预触发缓冲仍被占用，保持原配置";
+    }
+  } else {
+    m_preTrigger.clear();
+  }
+  m_pipeline.setStageEnabled(m_recordStage, m_preTrigger.capacity() > 0);
+}
+
 float CameraController::currentResultingFps() const {
   if (!m_isOpen)
     return 0.0f;
-  MVCC_FLOATVALUE v;
-  if (MV_OK == MV_CC_GetFloatValue(m_cameraHandle, "ResultingFrameRate", &v)) {
-    return v.fCurValue;
+  ICameraBackend::FloatValue v;
+  if (m_backend->getFloat("ResultingFrameRate", v) == ICameraBackend::kOk) {
+    return v.current;
   }
   return 0.0f;
 }
@@ -541,50 +1921,218 @@ void CameraController::stopRecording() {
   if (!m_isRecording)
     return;
 
-  // 关键修复：拿锁 → 置 false → StopRecord，保证 grabLoop 不会和 StopRecord 交错
+  // 不再接收新帧，并把录制队列里已排队的帧写完，避免丢掉结尾
+  m_pipeline.setStageEnabled(m_recordStage, false);
+  if (!m_pipeline.waitStageIdle(m_recordStage, std::chrono::seconds(2))) {
+    qWarning() << "录制队列 2 秒内未排空，剩余帧将被丢弃";
+  }
+  const qint64 queueDrop = static_cast<qint64>(
+      m_pipeline.stageStats(m_recordStage).dropped - m_recordStageDropBase);
+
+  // 拿锁 → 置 false → 关闭文件，保证录制阶段不会和关闭交错
+  RecordingDiagnostics::RecordingReport report;
+  bool closed = false;
+  bool segmented = false;
   {
     std::lock_guard<std::mutex> lock(m_recordMutex);
     m_isRecording = false;
-    MV_CC_StopRecord(m_cameraHandle);
+    // 预触发历史还没补写完：剩下的帧（含排在环尾的实时帧）写完再停
+    if (!m_preTrigger.empty())
+      qInfo() << "停止录制前补写预触发缓冲剩余" << m_preTrigger.size() << "帧";
+    while (!m_preTrigger.empty())
+      writeRecordFrame(m_preTrigger.pop());
+    closed = closeRecorder(&report);
+    // 分段：最后一段的旁注也只算本段，整次合计另放 session
+    segmented = m_recordSegmenter.policy().enabled();
+    if (segmented)
+      takeSegmentReport(m_recordSegmenter.current(), &report);
   }
+  // 前面的分段都关完再报告整次录制（UI 线程等，录制阶段已经停了）
+  joinSegmentThread();
+  // 预触发开着时录制阶段继续往环里收帧
+  if (m_isGrabbing)
+    armPreTrigger(m_framePool.bufferBytes());
 
   const QString path = m_recordingPathQt;
   // 立即给 UI 反馈（清"录制中"label 等）
   emit recordingStopped(path);
-  qDebug() << "录制已停止，轮询 SDK flush AVI 索引:" << path;
-
-  // 关键修复：MV_CC_StopRecord 返回后 SDK 仍在异步 flush AVI 头/索引/尾。
-  // 用轮询而不是固定延迟：每 300ms 查一次文件大小，size>0 立即 emit；
-  // 最多等 20 * 300ms = 6 秒兜底。
-  const qint64 ok = m_recordInputOk.load();
-  const qint64 fail = m_recordInputFail.load();
-  const qint64 convFail = m_recordConvertFail.load();
-  const quint32 lastErr = m_lastInputErrorCode.load();
-  const quint32 actualPixel = m_recordingActualPixelType;
-  pollFlushAndEmitStats(path, ok, fail, convFail, lastErr, actualPixel, 20);
-}
-
-void CameraController::pollFlushAndEmitStats(const QString &path, qint64 ok,
-                                             qint64 fail, qint64 convFail,
-                                             quint32 lastErr,
-                                             quint32 actualPixel,
-                                             int retriesLeft) {
-  const qint64 size = QFileInfo(path).size();
-  if (size > 0 || retriesLeft <= 0) {
-    qInfo() << RecordingDiagnostics::formatRecordingStats(
-                   ok + fail + convFail, ok, fail + convFail, size)
-            << "convFail=" << convFail << "lastErr=0x"
-            << QString::number(lastErr, 16) << "polled" << (20 - retriesLeft)
-            << "times";
-    emit recordingStats(ok + fail + convFail, ok, fail, size, lastErr,
-                        actualPixel, convFail);
+  qDebug() << "录制已停止:" << path;
+  if (!closed)
+    emit recordingError(QString("录制文件写入失败: %1").arg(report.writerError));
+
+  RecordingDiagnostics::RecordingReport::SessionTotals totals;
+  totals.inputOk = m_recordInputOk.load();
+  totals.inputFail = m_recordInputFail.load();
+  totals.convertFail = m_recordConvertFail.load();
+  totals.queueDrop = queueDrop;
+  totals.preTriggerLost = m_recordPreTriggerLost;
+  totals.totalFrames = totals.inputOk + totals.inputFail + totals.convertFail +
+                       totals.queueDrop + totals.preTriggerLost;
+  totals.telemetry = m_recordTelemetry.summary();
+  totals.fileBytes = report.fileBytes;
+  if (segmented) {
+    {
+      std::lock_guard<std::mutex> lock(m_segmentMutex);
+      totals.fileBytes += m_segmentClosedBytes;
+    }
+    totals.segments = report.segmentIndex;
+    report.session = totals;
+  } else {
+    report.inputOk = totals.inputOk;
+    report.inputFail = totals.inputFail;
+    report.convertFail = totals.convertFail;
+    report.queueDrop = totals.queueDrop;
+    report.totalFrames = totals.totalFrames;
+    report.lastErrCode = m_lastInputErrorCode.load();
+    report.pixelType = m_recordingActualPixelType;
+    report.telemetry = totals.telemetry;
+    report.threads = appliedThreadTuning();
+  }
+  const int64_t syncStartNs = m_recordSync.take();
+  if (!segmented || report.segmentIndex == 1)
+    fillRecordingStartReport(syncStartNs, &report);
+  m_recordSyncGroup.clear();
+  if (m_recordPreTriggerFrames > 0)
+    qInfo() << "录制开头补写了预触发历史" << m_recordPreTriggerFrames << "帧 ("
+            << m_recordPreTriggerSpanMs << "ms)";
+  if (m_recordPreTriggerLost > 0)
+    qWarning() << "补写预触发历史期间丢帧:" << m_recordPreTriggerLost;
+  if (queueDrop > 0) {
+    qWarning() << "录制队列满丢帧:" << queueDrop;
+  }
+  emitRecordingStats(path, report);
+  if (report.segmentIndex > 0) {
+    // 和前面各段走同一条排队路径：它们在 m_segmentThread 里已经排进事件
+    // 队列（上面 join 过），最后一段排在它们后面，入库按段号顺序
+    const int index = report.segmentIndex;
+    const qint64 bytes = report.fileBytes;
+    QMetaObject::invokeMethod(
+        this,
+        [this, path, index, bytes]() {
+          emit recordingSegmentSaved(path, index, bytes);
+        },
+        Qt::QueuedConnection);
+  }
+}
+
+void CameraController::abortRecording() {
+  if (!m_isRecording)
     return;
+
+  m_pipeline.setStageEnabled(m_recordStage, false);
+  m_pipeline.waitStageIdle(m_recordStage, std::chrono::seconds(2));
+  bool written = false;
+  {
+    std::lock_guard<std::mutex> lock(m_recordMutex);
+    written = m_recordFirstGrabNs != 0;
+    if (!written) {
+      m_isRecording = false;
+      RecordingDiagnostics::RecordingReport report;
+      closeRecorder(&report);
+    }
   }
-  QTimer::singleShot(300, this, [this, path, ok, fail, convFail, lastErr,
-                                 actualPixel, retriesLeft]() {
-    pollFlushAndEmitStats(path, ok, fail, convFail, lastErr, actualPixel,
-                          retriesLeft - 1);
-  });
+  if (written) {
+    qWarning() << "录制已经写过帧，不作废，正常停止:" << m_recordingPathQt;
+    stopRecording();
+    return;
+  }
+  // hold 中不会换段；后台线程退出时删掉预先打开的下一段
+  joinSegmentThread();
+  m_recordSync.take();
+  m_recordSyncGroup.clear();
+  if (m_isGrabbing)
+    armPreTrigger(m_framePool.bufferBytes());
+
+  const QString path = m_recordingPathQt;
+  if (!RecordingDiagnostics::discardRecording(path))
+    qWarning() << "删除作废的录制文件失败:" << path;
+  emit recordingStopped(path);
+  qInfo() << "录制已作废（未写帧）:" << path;
+}
+
+void CameraController::joinSegmentThread() {
+  if (!m_segmentThread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_segmentMutex);
+    m_segmentStop = true;
+  }
+  m_segmentCv.notify_one();
+  m_segmentThread.join();
+}
+
+bool CameraController::closeRecorder(
+    RecordingDiagnostics::RecordingReport *report) {
+  if (!m_recordWriter)
+    return true;
+  return closeRecordWriter(*m_recordWriter, report);
+}
+
+bool CameraController::closeRecordWriter(
+    IRecordWriter &writer, RecordingDiagnostics::RecordingReport *report) {
+  // 同步关闭：索引和头部都写完才返回，之后文件大小就是最终大小
+  const bool ok = writer.close();
+  report->fileBytes = static_cast<qint64>(writer.fileBytes());
+  report->disk = writer.fileStats();
+  if (!ok) {
+    report->writerError = QString::fromStdString(writer.error());
+    qWarning() << "关闭录制文件失败:" << report->writerError;
+  }
+  qDebug() << writer.containerName() << "已关闭:"
+           << QString::fromStdString(writer.summary());
+  const RecordFile::Stats &disk = report->disk;
+  qDebug() << "  写盘:" << disk.mbPerSec() << "MB/s（磁盘忙时"
+           << disk.diskMbPerSec() << "MB/s）, 单次最长" << disk.maxWriteUs / 1e3
+           << "ms, 排队峰值" << disk.highWaterBytes / 1e6 << "/"
+           << disk.queueCapacityBytes / 1e6 << "MB, 缓冲用尽等待"
+           << disk.producerWaits << "次, 直接 I/O:" << disk.directIo
+           << ", 预分配:" << disk.preallocated;
+  // 排队接近上限说明磁盘跟不上，再久一点录制阶段就会等写盘
+  if (disk.producerWaits > 0)
+    qWarning() << "写盘缓冲曾用尽" << disk.producerWaits << "次，最长等待"
+               << disk.maxProducerWaitUs / 1e3 << "ms：磁盘跟不上录制速度";
+  return ok;
+}
+
+void CameraController::emitRecordingStats(
+    const QString &path, const RecordingDiagnostics::RecordingReport &report,
+    bool burst) {
+  // 分段录制（最后一段的旁注带 session）报告整次录制的合计
+  RecordingDiagnostics::RecordingReport::SessionTotals total = report.session;
+  if (total.segments == 0) {
+    total.totalFrames = report.totalFrames;
+    total.inputOk = report.inputOk;
+    total.inputFail = report.inputFail;
+    total.convertFail = report.convertFail;
+    total.queueDrop = report.queueDrop;
+    total.fileBytes = report.fileBytes;
+    total.telemetry = report.telemetry;
+  } else {
+    qInfo() << "分段录制:" << total.segments << "段，合计"
+            << total.fileBytes / 1e6 << "MB";
+  }
+  const qint64 size = total.fileBytes;
+  const FrameTelemetry::Summary &t = total.telemetry;
+  qInfo() << RecordingDiagnostics::formatRecordingStats(
+                 total.totalFrames, total.inputOk,
+                 total.inputFail + total.convertFail + total.queueDrop, size)
+          << "convFail=" << total.convertFail
+          << "queueDrop=" << total.queueDrop << "lastErr=0x"
+          << QString::number(report.lastErrCode, 16);
+  qInfo() << "录制遥测: 丢帧" << t.lostFrames << "延迟 p50/p95/p99 ="
+          << t.latencyUs.p50 << "/" << t.latencyUs.p95 << "/"
+          << t.latencyUs.p99 << "us 抖动 p99 =" << t.jitterUs.p99 << "us";
+  if (report.fileBytes > 0 &&
+      !RecordingDiagnostics::writeRecordingReport(path, report)) {
+    qWarning() << "写录制统计失败:"
+               << RecordingDiagnostics::statsSidecarPath(path);
+  }
+  if (burst)
+    emit burstSaved(path, size);
+  else
+    emit recordingStats(total.totalFrames, total.inputOk, total.inputFail,
+                        size, report.lastErrCode, report.pixelType,
+                        total.convertFail, total.queueDrop);
 }
 
 // ============================================================================
@@ -594,18 +2142,45 @@ void CameraController::pollFlushAndEmitStats(const QString &path, qint64 ok,
 bool CameraController::saveSnapshot(const QString &filePath,
                                     SnapshotFormat format, int quality) {
   std::lock_guard<std::mutex> lock(m_frameMutex);
+  refreshSnapshotFrame();
 
-  if (m_frameBuffer.empty() || m_extendWidth == 0 || m_extendHeight == 0) {
+  if (!m_snapshotFrame || m_snapshotFrame.info().extendWidth == 0 ||
+      m_snapshotFrame.info().extendHeight == 0) {
     emit snapshotError("无法抓拍: 没有可用的帧数据");
     return false;
   }
 
+  const FrameInfo &info = m_snapshotFrame.info();
+  const PixelFormats::Descriptor *srcFormat =
+      PixelFormats::find(info.pixelType);
+  if (format == FORMAT_PNG && srcFormat &&
+      srcFormat->family == PixelFormats::Family::Mono &&
+      PixelUnpack::canUnpack(info.pixelType)) {
+    // 10/12/16 位黑白：SDK 存图会截成 8 位，自己拆包存 16 位 PNG
+    if (!saveGray16Png(m_snapshotFrame, srcFormat->sampleBits, filePath)) {
+      emit snapshotError(QString("保存 16 位 PNG 失败: %1").arg(filePath));
+      return false;
+    }
+    emit snapshotSaved(filePath);
+    qDebug() << "截图已保存 (16 位):" << filePath;
+    return true;
+  }
+
+  // 其余格式用海康 SDK 接口存图，需要 SDK 句柄
+  void *sdkHandle = m_backend->sdkHandle();
+  if (!sdkHandle) {
+    emit snapshotError(QString("无法抓拍: %1 后端不支持保存图片")
+                           .arg(m_backend->backendName()));
+    return false;
+  }
+
   MV_CC_IMAGE stImg = {0};
-  stImg.enPixelType = static_cast<MvGvspPixelType>(m_pixelType);
-  stImg.nWidth = m_extendWidth;   // 使用 ExtendWidth 对齐
-  stImg.nHeight = m_extendHeight; // 使用 ExtendHeight 对齐
-  stImg.nImageLen = m_frameLen;
-  stImg.pImageBuf = m_frameBuffer.data();
+  stImg.enPixelType = static_cast<MvGvspPixelType>(info.pixelType);
+  stImg.nWidth = info.extendWidth;   // 使用 ExtendWidth 对齐
+  stImg.nHeight = info.extendHeight; // 使用 ExtendHeight 对齐
+  // 使用 Ex 长度
+  stImg.nImageLen = static_cast<unsigned int>(m_snapshotFrame.size());
+  stImg.pImageBuf = m_snapshotFrame.writableData();
 
   MV_CC_SAVE_IMAGE_PARAM stSaveParams;
   memset(&stSaveParams, 0, sizeof(MV_CC_SAVE_IMAGE_PARAM));
@@ -629,7 +2204,7 @@ bool CameraController::saveSnapshot(const QString &filePath,
   std::string path = filePath.toLocal8Bit().constData();
 
   // 使用 Ex2 接口 (参考官方 ImageSave.cpp 示例)
-  int ret = MV_CC_SaveImageToFileEx2(m_cameraHandle, &stImg, &stSaveParams,
+  int ret = MV_CC_SaveImageToFileEx2(sdkHandle, &stImg, &stSaveParams,
                                      const_cast<char *>(path.c_str()));
   if (ret != MV_OK) {
     emit snapshotError(QString("保存失败: 0x%1").arg(ret, 8, 16, QChar('0')));
@@ -1,80 +1,275 @@
 #ifndef CAMERACONTROLLER_H
 #define CAMERACONTROLLER_H
 
+#include "AcquisitionPipeline.h"
+#include "ICameraBackend.h"
+#include "utils/AcquisitionStats.h"
+#include "utils/IRecordWriter.h"
+#include "utils/BayerDemosaic.h"
+#include "utils/BufferSizing.h"
+#include "utils/BurstCapture.h"
+#include "utils/PreTriggerRing.h"
+#include "utils/RecordSegmenter.h"
+#include "utils/RecordingSync.h"
+#include "utils/RoiPlanner.h"
+#include "utils/ThreadAffinity.h"
+#include "utils/TilePool.h"
+#include "utils/FramePool.h"
+#include "utils/FrameRateEstimator.h"
+#include "utils/FrameTelemetry.h"
+#include "utils/LatestFrameMailbox.h"
+#include "utils/PixelFormatNegotiator.h"
+#include "utils/PreviewScaler.h"
+#include "utils/RecordingDiagnostics.h"
 #include <QList>
 #include <QObject>
+#include <QRect>
+#include <QSize>
 #include <QString>
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 
+class QTimer;
+
 /**
- * @brief 相机控制器 - 封装海康威视 SDK
+ * @brief 相机控制器 - 通过 ICameraBackend 访问相机
+ *
+ * 默认使用海康后端；环境变量 WORMVISION_CAMERA_BACKEND 可切换到
+ * synthetic / replay 后端（见 CameraBackendFactory），在没有相机的机器上
+ * 跑通采集链路。显示 / 录制 / 抓拍仍依赖海康 SDK 的图像接口，
+ * 后端没有 SDK 句柄时跳过显示、拒绝录制和抓拍（16 位 PNG 抓拍不经 SDK）。
  *
  * 功能：
  * - 设备枚举与连接
  * - 图像采集 (SDK 直接渲染到 HWND)
  * - 参数控制 (曝光/增益/帧率)
- * - 视频录制 (SDK 内置 AVI 编码)
+ * - 视频录制（未压缩 AVI / .wvr 原始容器）
  * - 单帧抓拍
+ *
+ * 线程模型：grab 线程只做 GetImageBuffer + 分发，显示 / 录制
+ * 分别在 AcquisitionPipeline 的独立阶段线程里处理，互不阻塞；
+ * 抓拍只从 LatestFrameMailbox 取最新帧。
+ * 回调取帧模式下没有 grab 线程，由后端取流线程（SDK 回调）直接分发。
  */
 class CameraController : public QObject {
   Q_OBJECT
 
 public:
+  // 后端由 createDefaultCameraBackend() 决定
   explicit CameraController(QObject *parent = nullptr);
+  // 测试 / 基准直接注入后端
+  explicit CameraController(std::unique_ptr<ICameraBackend> backend,
+                            QObject *parent = nullptr);
   ~CameraController();
 
   // ========== 设备信息 ==========
-  struct DeviceInfo {
-    QString name;
-    QString serialNumber;
-    int index;
-    int deviceType; // MV_GIGE_DEVICE or MV_USB_DEVICE
-  };
+  using DeviceInfo = ICameraBackend::DeviceInfo;
 
   // ========== 设备管理 ==========
-  static QList<DeviceInfo> enumerateDevices();
+  QList<DeviceInfo> enumerateDevices();
+  QString backendName() const { return m_backend->backendName(); }
   bool open(int deviceIndex = 0);
   void close();
   bool isOpen() const { return m_isOpen; }
 
   // ========== 图像采集 ==========
+  // Polling：grab 线程循环 grabFrame；Callback：后端取流线程回调推帧。
+  // 默认轮询，环境变量 WORMVISION_ACQUISITION_MODE=callback 切换；
+  // 后端不支持回调时自动退回轮询
+  enum class AcquisitionMode { Polling, Callback };
+  void setAcquisitionMode(AcquisitionMode mode); // 下次 startGrabbing 生效
+  AcquisitionMode acquisitionMode() const { return m_acquisitionMode; }
+
   void setDisplayHandle(void *hwnd);
+  /**
+   * @brief 预览的可见区域（UI 线程调用，下一帧显示生效）
+   * @param visible 窗口里看得见的源图像区域（图像像素坐标），空矩形表示整帧
+   * @param displaySize 这块区域在屏幕上的像素尺寸，空表示不缩小
+   *
+   * 显示阶段按它裁剪并面积平均（见 PreviewScaler），交给 SDK 的像素数
+   * 只和窗口大小有关。显示窗口句柄必须恰好覆盖这块区域。
+   */
+  void setDisplayViewport(const QRect &visible, const QSize &displaySize);
+  // 分配帧缓冲池、设置 SDK 节点、注册回调；多相机时先全部准备好再依次
+  // startGrabbing，缩短各相机开始出帧的时间差。单相机可以直接 startGrabbing
+  bool prepareGrabbing();
   bool startGrabbing();
   void stopGrabbing();
   bool isGrabbing() const { return m_isGrabbing; }
+  // grab 线程绑到指定逻辑核（-1 不绑），下次 startGrabbing 生效；回调取帧时无效
+  void setGrabThreadCore(int core);
+  int grabThreadCore() const { return m_threadTuning.grab.core; }
+  // grab / 流水线线程的绑核和优先级，下次 startGrabbing 生效
+  void setThreadTuning(const ThreadAffinity::Tuning &tuning);
+  ThreadAffinity::Tuning threadTuning() const { return m_threadTuning; }
+  // 本次采集各线程实际生效的设置（任意线程可调用）
+  std::vector<ThreadAffinity::Applied> appliedThreadTuning() const;
 
   // ========== 参数控制 ==========
   void setExposure(float microseconds);
   void setGain(float db);
   void setFrameRate(float fps);
   void setFrameRateEnable(bool enable);
+  // 单个 ROI 节点：按当前 ROI 改一项后走 setRoi
   void setOffsetX(int offset);
   void setOffsetY(int offset);
   void setWidth(int width);
   void setHeight(int height);
+  /**
+   * @brief 事务式修改 ROI：采集中可调用
+   *
+   * 采集中 Width / Height 节点被相机锁住，这里先停采集，按 RoiPlanner 的顺序
+   * 写偏移 / 尺寸（任一步失败回滚到原 ROI），再重新开始采集：
+   * prepareGrabbing 按新的 PayloadSize 重配帧缓冲池和预触发环。
+   * 请求值自动对齐到步长并夹到传感器范围内。录制 / 连拍中拒绝。
+   * 完成后发 roiReconfigured（停 → 写 → 重启耗时），重启后第一帧到达时
+   * 发 reconfigureGapMeasured（旧 ROI 最后一帧到新 ROI 第一帧的采集间隔）。
+   */
+  bool setRoi(const Roi &roi);
+  // 相机当前 ROI；未打开或读取失败时为空
+  Roi roi();
+
+  // ========== Binning / 抽样 ==========
+  // 各节点可选的倍数；相机没有该节点时对应列表为空
+  SamplingOptions samplingOptions();
+  SamplingMode samplingMode();
+  /**
+   * @brief 应用之前预估 target 的输出尺寸、最高帧率和带宽
+   * 以当前 ResultingFrameRate / 曝光 / 帧率限制 / DeviceLinkSpeed 为基准，
+   * 见 FrameRateEstimator
+   */
+  FrameRateEstimate estimateSamplingMode(const SamplingMode &target);
+  /**
+   * @brief 修改 binning / 抽样，与 setRoi 一样采集中停采集重配
+   * 任一节点写失败时恢复原设置；完成后发 samplingModeChanged，
+   * 并重新发 resolutionReady / resolutionMaxReady / offsetReady
+   */
+  bool setSamplingMode(const SamplingMode &mode);
+
+  // ========== 像素格式协商 ==========
+  /**
+   * @brief 设置用途：open 时按用途从 PixelFormat 可选值里挑转换 + 传输代价
+   * 最小的格式（见 PixelFormatNegotiator），录制按用途转 Mono8 或 BGR8。
+   * 已打开时立即重新协商，采集中与 setRoi 一样停采集重配；录制 / 连拍中拒绝
+   */
+  bool setPixelWorkflow(PixelFormatNegotiator::Workflow workflow);
+  PixelFormatNegotiator::Workflow pixelWorkflow() const {
+    return m_pixelWorkflow;
+  }
+  // Bayer 相机录 Mono8 时的取法：加权亮度或只取绿通道（更快），
+  // 下次开始录制生效
+  void setBayerMonoMethod(BayerDemosaic::MonoMethod method);
+  BayerDemosaic::MonoMethod bayerMonoMethod() const {
+    return m_bayerMonoMethod;
+  }
+  // 录制文件的写盘缓冲 / 直接 I/O / 预分配（见 RecordFile），下次开始录制
+  // 或连拍时生效
+  void setRecordFileOptions(const RecordFile::Options &options) {
+    m_recordFileOptions = options;
+  }
+  RecordFile::Options recordFileOptions() const { return m_recordFileOptions; }
+  // .wvr 录制 / 连拍按帧无损压缩（LosslessCodec，条带分给全部核）；
+  // AVI 不受影响。下次开始录制或连拍时生效
+  void setRecordLossless(bool enabled) { m_recordLossless = enabled; }
+  bool recordLossless() const { return m_recordLossless; }
+  // 长时间录制分段：每满 maxDurationNs / maxBytes 在帧与帧之间换新文件
+  // （RecordSegmenter），不启用时整次录制一个文件。下次开始录制时生效，
+  // 连拍不分段
+  void setRecordSegmentPolicy(const RecordSegmenter::Policy &policy) {
+    m_recordSegmentPolicy = policy;
+  }
+  RecordSegmenter::Policy recordSegmentPolicy() const {
+    return m_recordSegmentPolicy;
+  }
 
   // ========== 录制功能 ==========
   // fps <= 0 时自动用相机当前的 ResultingFrameRate（修复 Phase 3 #4：原本写死 23fps）
+  // 按扩展名选容器：.wvr 写原始容器（WvrWriter，原生像素格式不转换），
+  // 其余写未压缩 AVI（AviWriter）。bitRateKbps 不起作用，保留给调用方兼容。
+  // 启用分段时 filePath 只是命名基准，实际文件为 RecordSegmenter::segmentPath
+  // 的 _001、_002 ...，recordingStarted 发出第一段的路径
   bool startRecording(const QString &filePath, float fps = -1.0f,
                       int bitRateKbps = 4000);
   void stopRecording();
+  // 作废还没写过帧的录制（多相机同步开录回滚：其他相机开录失败时 hold 中的
+  // 各路）：关闭并删除文件，不写 .stats.json、不发 recordingStats。
+  // 已经写过帧时按 stopRecording 正常停止，不丢数据
+  void abortRecording();
   bool isRecording() const { return m_isRecording; }
+  // 多相机同步录制：采集时刻（steady_clock 纳秒）不早于 startNs 的帧照常写；
+  // 更早的帧（kRecordHoldNs = 还没放行时的所有帧）只在预触发环开着时进环，
+  // 作为历史补写在文件开头，没开环就不写。各路环里的历史长短可能不同，文件
+  // 开头不一定对齐：见 .stats.json 的 preTrigger（补写帧数 / 跨度）和
+  // sync.firstFrameOffsetUs（有历史时为负）。stopRecording 时把同步信息写进
+  // .stats.json 并清除。可以在录制中调用
+  static constexpr int64_t kRecordHoldNs = RecordingSyncGate::kHoldNs;
+  void setRecordingSync(int64_t startNs, const QString &group);
+  // 预触发录制：没在录制时在内存里保留最近 seconds 秒的帧（受
+  // memoryBudgetBytes 截断），startRecording 后先写这段历史再接实时帧，
+  // 中间不缺帧。seconds <= 0 关闭；采集中且没在录制时立即生效，否则下次生效
+  static constexpr std::size_t kDefaultPreTriggerBudgetBytes = std::size_t(1)
+                                                               << 30;
+  void setPreTrigger(double seconds,
+                     std::size_t memoryBudgetBytes = kDefaultPreTriggerBudgetBytes);
+  double preTriggerSeconds() const { return m_preTriggerSeconds; }
 
   // 查询相机当前结果帧率（来自 SDK ResultingFrameRate）
   float currentResultingFps() const;
 
+  // 各流水线阶段的队列深度 / 丢帧计数（任意线程可调用）
+  std::vector<AcquisitionPipeline::StageStats> pipelineStats() const;
+  // 帧缓冲池占用 / 耗尽计数（任意线程可调用）
+  FramePool::Stats framePoolStats() const { return m_framePool.stats(); }
+  FramePool::Stats convertPoolStats() const { return m_convertPool.stats(); }
+  // 累计帧数 + 最后一帧采集时间戳，UI 定时采样算帧率（任意线程可调用）
+  AcquisitionStatsBlock::Snapshot acquisitionStats() const {
+    return m_acqStats.snapshot();
+  }
+  // 本次采集的丢帧 / 延迟 / 抖动统计（任意线程可调用）
+  FrameTelemetry::Summary telemetry() const { return m_telemetry.summary(); }
+
+  // ========== 缓冲配置 ==========
+  // SDK 节点 + 帧缓冲池的内存上限，默认 512 MiB，环境变量
+  // WORMVISION_BUFFER_BUDGET_MB 可覆盖；下次 startGrabbing 生效
+  void setBufferMemoryBudget(std::size_t bytes);
+  std::size_t bufferMemoryBudget() const { return m_bufferBudgetBytes; }
+  // 当前 SDK 节点 / 池缓冲 / 录制队列配置和可吸收的最长停顿（UI 线程）
+  BufferSizing bufferSizing() const { return m_bufferSizing; }
+
+  // ========== 连拍 ==========
+  // 连续抓 frameCount 帧到预分配内存（受 memoryBudgetBytes 截断，frameCount <= 0
+  // 时用满预算），期间不编码、不写盘；抓满后在后台线程写成 AVI。
+  // 需要正在采集且没在录制；帧率由相机当前设置决定（要最高帧率先关掉帧率限制）
+  enum class BurstState { Idle, Capturing, Flushing };
+  static constexpr std::size_t kDefaultBurstBudgetBytes = std::size_t(2) << 30;
+  bool startBurst(const QString &filePath, int frameCount,
+                  std::size_t memoryBudgetBytes = kDefaultBurstBudgetBytes,
+                  int bitRateKbps = 4000);
+  // 放弃正在进行的连拍（正在落盘时提前结束，文件只含已写入的帧）
+  void cancelBurst();
+  BurstState burstState() const { return m_burstState; }
+  // 连拍进度（任意线程可调用）
+  std::size_t burstCapturedFrames() const { return m_burst.size(); }
+
 private:
-  // SDK flush 是异步的，轮询文件大小直到 > 0 或超时再 emit stats
-  void pollFlushAndEmitStats(const QString &path, qint64 ok, qint64 fail,
-                             qint64 convFail, quint32 lastErr,
-                             quint32 actualPixel, int retriesLeft);
+  // 录制写入器 close 返回时文件已完整：直接 emit stats，同时把完整统计写到
+  // 视频旁的 .stats.json；burst 为 true 时发 burstSaved
+  void emitRecordingStats(const QString &path,
+                          const RecordingDiagnostics::RecordingReport &report,
+                          bool burst = false);
 public:
 
   // ========== 抓拍功能 ==========
+  // FORMAT_PNG 遇到 10/12/16 位黑白帧时存 16 位灰度 PNG（不需要 SDK 句柄），
+  // 其余情况走 SDK 存图（8 位）
   enum SnapshotFormat { FORMAT_BMP = 0, FORMAT_JPEG = 1, FORMAT_PNG = 2 };
   bool saveSnapshot(const QString &filePath,
                     SnapshotFormat format = FORMAT_JPEG, int quality = 90);
@@ -85,9 +280,26 @@ signals:
   void cameraClosed();
   void error(const QString &message);
 
-  // 帧信号
-  void frameRendered(int frameIndex);
+  // 帧信号（帧数 / 帧率不逐帧通知，见 acquisitionStats()）
   void resolutionChanged(int width, int height);
+  // setRoi 完成（UI 线程）；reconfigureMs 为停采集到重新开始采集的耗时
+  void roiReconfigured(int x, int y, int width, int height,
+                       double reconfigureMs);
+  // setRoi / setSamplingMode 重启采集后第一帧到达（采集线程发出）：
+  // 旧设置最后一帧到新设置第一帧的采集间隔
+  void reconfigureGapMeasured(double gapMs);
+  // open 后发出：可选倍数和当前设置
+  void samplingOptionsReady(const SamplingOptions &options,
+                            const SamplingMode &current);
+  // setSamplingMode 完成：应用前的预估和相机报告的 ResultingFrameRate
+  void samplingModeChanged(const SamplingMode &mode,
+                           const FrameRateEstimate &predicted,
+                           float resultingFps);
+  // 像素格式协商完成（open / setPixelWorkflow）：选中的格式和每帧代价预估
+  void pixelFormatNegotiated(const PixelFormatNegotiator::Choice &choice,
+                             PixelFormatNegotiator::Workflow workflow);
+  // 采集期间每 kTelemetryIntervalMs 发一次（UI 线程）
+  void telemetryUpdated(const FrameTelemetry::Summary &summary);
 
   // 参数范围信号 (在 open 成功后发出，UI 用此初始化控件)
   void exposureRangeReady(float min, float max, float current);
@@ -102,13 +314,26 @@ signals:
   void recordingStarted(const QString &filePath);
   void recordingStopped(const QString &filePath);
   void recordingError(const QString &message);
+  // 分段录制：一段文件关闭完整后发出（UI 线程，各段都经事件队列、按段号
+  // 顺序），最后一段在 recordingStats 之后发出。segmentIndex 从 1 开始
+  void recordingSegmentSaved(const QString &filePath, int segmentIndex,
+                             qint64 fileBytes);
   // Phase 5：录制结束时发出帧统计（成功 vs 失败），便于诊断 0 字节录制
-  // lastErrCode 最后一次 InputOneFrame 的 SDK 错误码（0 表示无失败）
+  // lastErrCode 最后一次 SDK 像素转换的错误码（0 表示无失败；写盘失败走 recordingError）
   // pixelType 录制实际使用的像素类型枚举值（转换后或原始）
   // convertFail 仅记 ConvertPixelType 失败次数（与 inputFail 互斥）
+  // queueDrop 录制队列满、没轮到写入就丢掉的帧数（计入 totalFrames）
+  // 分段录制时各数是整次录制的合计，fileBytes 为各段文件大小之和
   void recordingStats(qint64 totalFrames, qint64 inputOk, qint64 inputFail,
                       qint64 fileBytes, quint32 lastErrCode, quint32 pixelType,
-                      qint64 convertFail);
+                      qint64 convertFail, qint64 queueDrop);
+
+  // 连拍信号：burstCaptured 在全部帧进内存后发出（开始落盘），
+  // burstSaved 在 AVI 写完、文件大小稳定后发出
+  void burstStarted(const QString &filePath, int frames);
+  void burstCaptured(const BurstCapture::Stats &stats);
+  void burstSaved(const QString &filePath, qint64 fileBytes);
+  void burstError(const QString &message);
 
   // 抓拍信号
   void snapshotSaved(const QString &filePath);
@@ -116,32 +341,233 @@ signals:
 
 private:
   void grabLoop();
+  // grab 线程 / 后端回调线程共用的单帧处理；返回 false 表示应稍等再取
+  bool handleGrabResult(ICameraBackend::GrabResult result, FrameRef &frame);
+
+  // 流水线各阶段的消费函数（在阶段线程中运行）
+  void setupPipeline();
+  void displayFrame(const FrameRef &frame);
+  void recordFrame(const FrameRef &frame);
+  // 记下第一帧信息后 inputRecordFrame；调用方持有 m_recordMutex
+  void writeRecordFrame(const FrameRef &frame);
+  // 转换（需要时）+ 写入文件；调用方持有 m_recordMutex 且 m_recordWriter 已打开
+  // 写进文件返回 true
+  bool inputRecordFrame(const FrameRef &frame);
+  // 分段：当前段快到上限时让 m_segmentThread 打开下一段（每段只请求一次）。
+  // 调用方持有 m_recordMutex
+  void requestNextSegment();
+  // 分段：换入 m_segmentThread 已打开的下一段，旧段排给它关闭，不等待；
+  // 下一段还没打开好或打不开时继续写当前段，满一个周期再换。
+  // 调用方持有 m_recordMutex
+  void rollOverSegment(int64_t grabTimeNs);
+  // m_segmentThread：按请求打开下一段，按换段顺序关闭旧段；停止时关掉
+  // 提前打开、没用上的那一段并删除文件
+  void segmentWorker();
+  // 让 m_segmentThread 关完排队的旧段后退出并等它（UI 线程，录制阶段已停）
+  void joinSegmentThread();
+  // 分段：本段的写入计数 / 丢帧 / 遥测 / 帧范围填进 report，并从这里开始
+  // 计下一段。调用方持有 m_recordMutex
+  void takeSegmentReport(const RecordSegmenter::Segment &segment,
+                         RecordingDiagnostics::RecordingReport *report);
+  // 只属于录制开头的信息（同步起点、预触发补写）填进 report：
+  // 不分段时填进唯一的文件，分段时填进第 1 段
+  void fillRecordingStartReport(
+      int64_t syncStartNs, RecordingDiagnostics::RecordingReport *report) const;
+  // m_segmentThread：关闭一段、写它的 .stats.json，回 UI 线程发信号
+  void closeSegment(std::unique_ptr<IRecordWriter> writer, QString path,
+                    RecordingDiagnostics::RecordingReport report);
+  // 按当前帧率 / 帧大小（重新）分配预触发环并决定录制阶段是否常开
+  void armPreTrigger(std::size_t frameBytes);
+  // 在调用线程上应用绑核 / 优先级并记进 m_threadReport
+  void applyThreadSetting(const std::string &thread,
+                          const ThreadAffinity::ThreadSetting &setting);
+  // 按扩展名创建 m_recordWriter，按当前分辨率 / 像素格式打开并清零写入计数；
+  // lossless 只对 .wvr 起作用
+  bool openRecorder(const QString &filePath, float fps, int bitRateKbps,
+                    const RecordFile::Options &file, bool lossless,
+                    QString *errorMessage);
+  // 按 openRecorder 记下的格式 / 容器 / 写盘选项新建并打开一个写入器
+  // （分段换文件也用）；失败返回 nullptr
+  std::unique_ptr<IRecordWriter> createRecordWriter(const QString &filePath,
+                                                    QString *errorMessage);
+  // 关闭 m_recordWriter，把文件大小 / 写入错误 / 写盘统计填进 report；
+  // 调用方持有 m_recordMutex。失败返回 false
+  bool closeRecorder(RecordingDiagnostics::RecordingReport *report);
+  static bool closeRecordWriter(IRecordWriter &writer,
+                                RecordingDiagnostics::RecordingReport *report);
+  void burstFrame(const FrameRef &frame);
+  void finishBurstCapture(); // UI 线程：连拍抓满（或停止采集）后开始落盘
+  void flushBurst();         // 落盘线程
+  void refreshSnapshotFrame();
+  // 按 PayloadSize（取不到时按宽 × 高 × 像素位深）估算一帧字节数
+  std::size_t queryFrameBytes() const;
+  // 设备时间戳频率（GevTimestampTickFrequency），取不到按 1 GHz
+  double queryTimestampTickHz() const;
+  void emitTelemetry();
+  // 读 Width / Height / Offset 及其范围，发 resolutionReady 等信号
+  void emitResolutionInfo();
+  // DeviceLinkSpeed 扣掉协议开销后的有效带宽（字节/秒），取不到时为 0
+  double queryLinkBytesPerSec() const;
+  // 按 m_pixelWorkflow 协商并写 PixelFormat（须在采集停止时调用）
+  void negotiatePixelFormat();
+  // 录制 / 连拍中返回 false 并发 error
+  bool canReconfigure(const QString &what);
+  // 采集中：停采集 → apply → 重新开始采集（重配帧缓冲池），并准备测量采集中断；
+  // 没在采集时直接 apply。重启失败返回 false
+  bool reconfigure(const std::function<void()> &apply, double *reconfigureMs);
+  // 读当前 ROI 和节点约束（WidthMax / HeightMax 与偏移无关）
+  bool queryRoi(Roi &roi, RoiLimits &limits);
+  // 依次写入，返回第一个失败的错误码
+  int applyRoiSteps(const std::vector<RoiStep> &steps);
+  // 录制阶段出现比已知更长的停顿时加大帧缓冲池和录制队列（UI 线程定时调用）
+  void adaptBuffers();
+
+  // 相机后端（海康 / 合成 / 回放）
+  std::unique_ptr<ICameraBackend> m_backend;
+  // 显示阶段线程读取，UI 线程写入
+  std::atomic<void *> m_displayHandle{nullptr};
+  // 预览可见区域：UI 线程写、显示阶段线程每帧拷一份
+  std::mutex m_displayViewportMutex;
+  PreviewScaler::Rect m_displayVisible;
+  int m_displayWidth = 0;
+  int m_displayHeight = 0;
+  // 显示阶段线程私有：缩小后的预览帧、高位深取高 8 位 / SDK 转 BGR8 的中间帧，
+  // 只在尺寸变大时重新分配
+  std::vector<uint8_t> m_previewBuffer;
+  std::vector<uint8_t> m_previewSourceBuffer;
+
+  // 帧缓冲池：startGrabbing 时按帧大小预分配，后端 grabFrame 直接把像素
+  // 写进池缓冲（海康后端拷完立即 FreeImageBuffer），之后显示 / 录制 / 抓拍共享同一份。
+  // 必须声明在流水线和抓拍信箱之前，保证析构时池子最后释放
+  FramePool m_framePool;
+  // 录制转 Mono8 / BGR8 用的输出缓冲池（startRecording 时按需分配）
+  FramePool m_convertPool;
+  // 8 位 Bayer 转换按水平条带并行（第一次需要转换的录制时创建，之后复用）
+  std::unique_ptr<TilePool> m_convertTiles;
+  // 帧比池缓冲还大（采集中改了 ROI / 像素格式）时只能丢帧
+  std::atomic<qint64> m_oversizeFrames{0};
+  // 重配置重启采集前记下最后一帧的 grabTimeNs，重启后第一帧取走（0 = 无）
+  std::atomic<int64_t> m_reconfigureGapStartNs{0};
+
+  // 采集流水线：display / record 两个阶段；抓拍走 m_snapshotMailbox
+  AcquisitionPipeline m_pipeline;
+  int m_displayStage = -1;
+  int m_recordStage = -1;
+  uint64_t m_recordStageDropBase = 0;
+  int m_burstStage = -1;
 
-  // SDK 句柄
-  void *m_cameraHandle = nullptr;
-  void *m_displayHandle = nullptr;
+  // 连拍：m_burst 只由连拍阶段线程写，抓满后交给落盘线程读
+  BurstCapture m_burst;
+  BurstState m_burstState = BurstState::Idle;
+  QString m_burstPath;
+  int m_burstBitRateKbps = 4000;
+  RecordFile::Options m_burstFileOptions; // startBurst 时拷贝，落盘线程读
+  bool m_burstLossless = false;           // 同上
+  std::atomic<bool> m_burstCancel{false};
+  std::thread m_burstFlushThread;
+
+  // 缓冲配置：startGrabbing 时按内存预算和已观测的最长录制停顿计算，
+  // 采集中停顿变长时只增不减；SDK 节点数下次开始采集才生效
+  std::size_t m_bufferBudgetBytes = 0;
+  uint64_t m_observedStallUs = 0; // 跨采集保留的最长录制阶段单帧耗时
+  BufferSizingInput m_sizingInput;
+  BufferSizing m_bufferSizing;
 
   // 线程控制
+  AcquisitionMode m_acquisitionMode = AcquisitionMode::Polling;
+  bool m_callbackActive = false; // 本次采集实际使用回调取帧
+  std::atomic<bool> m_endOfStreamLogged{false};
   std::thread m_grabThread;
+  ThreadAffinity::Tuning m_threadTuning;
+  // startGrabbing 时从 m_threadTuning 拷一份给新起的线程读，采集中不变
+  ThreadAffinity::Tuning m_activeThreadTuning;
+  mutable std::mutex m_threadReportMutex;
+  std::vector<ThreadAffinity::Applied> m_threadReport;
+  bool m_grabPrepared = false;
   std::atomic<bool> m_isOpen{false};
   std::atomic<bool> m_isGrabbing{false};
   std::atomic<bool> m_stopGrabbing{false};
-  std::atomic<int> m_frameCount{0};
+  // grab 线程逐帧更新，UI 定时采样
+  AcquisitionStatsBlock m_acqStats;
+
+  // 逐帧遥测：m_telemetry 覆盖整个采集过程，m_recordTelemetry 只在录制期间记录
+  FrameTelemetry m_telemetry;
+  FrameTelemetry m_recordTelemetry;
+  QTimer *m_telemetryTimer = nullptr;
+  uint64_t m_reportedLostFrames = 0;
 
   // 录制状态
   std::atomic<bool> m_isRecording{false};
-  std::string m_recordingPath;     // GBK bytes，给海康 SDK 的 C API 用
   QString m_recordingPathQt;       // UTF-16，给 Qt（QFileInfo / emit signal）用
-  // 互斥保护 InputOneFrame ↔ StopRecord 不能交错（避免 MV_E_CALLORDER）
+  // 互斥保护写帧 ↔ 关闭文件不能交错；m_recordWriter 只在持锁时访问
   std::mutex m_recordMutex;
+  std::unique_ptr<IRecordWriter> m_recordWriter; // openRecorder 按扩展名创建
+  std::size_t m_recordFrameBytes = 0; // 写入一帧的字节数（录制像素类型）
+  RecordFile::Options m_recordFileOptions; // UI 线程设置
+  bool m_recordLossless = false;           // UI 线程设置
+  RecordSegmenter::Policy m_recordSegmentPolicy; // UI 线程设置
+  // openRecorder 记下，createRecordWriter 按它们打开（持锁访问）
+  IRecordWriter::Format m_recordFormat;
+  RecordFile::Options m_recordWriterFile;
+  bool m_recordRawContainer = false;
+  bool m_recordWriterLossless = false;
+  // 分段：m_recordSegmenter、m_segmentRequested 持锁访问；m_recordBasePath
+  // 是 startRecording 的路径，各段文件名由它派生（录制期间不变）
+  RecordSegmenter m_recordSegmenter;
+  QString m_recordBasePath;
+  int m_segmentRequested = 0; // 已请求提前打开的段号
+  // 本段开始时的累计写入计数 / 录制队列丢帧数，换段时相减得本段的；
+  // 本段遥测由录制阶段逐帧记（都持锁访问）
+  FrameTelemetry m_segmentTelemetry;
+  double m_recordTickHz = 1e9;
+  qint64 m_segmentInputOkBase = 0;
+  qint64 m_segmentInputFailBase = 0;
+  qint64 m_segmentConvertFailBase = 0;
+  uint64_t m_segmentDropBase = 0;
+  // 分段后台线程：打开文件（写盘缓冲分配、预分配、起写盘线程）和关闭文件
+  // （排空缓冲、写索引）都在这里做，录制阶段换段只交接写入器。
+  // 以下状态由 m_segmentMutex 保护
+  struct SegmentClose {
+    std::unique_ptr<IRecordWriter> writer;
+    QString path;
+    RecordingDiagnostics::RecordingReport report;
+  };
+  std::thread m_segmentThread; // 分段录制期间运行，stopRecording 时 join
+  std::mutex m_segmentMutex;
+  std::condition_variable m_segmentCv;
+  bool m_segmentStop = false;
+  int m_segmentOpenIndex = 0;     // 要打开的段号（0 = 没有请求）
+  bool m_segmentOpenDone = false; // 这个段号已经打开过（成功或失败）
+  std::unique_ptr<IRecordWriter> m_segmentNextWriter; // 已打开、待换入
+  QString m_segmentNextPath;
+  QString m_segmentOpenError; // 非空 = 打开失败
+  std::deque<SegmentClose> m_segmentCloses; // 待关闭的旧段，按换段顺序
+  qint64 m_segmentClosedBytes = 0;          // 已关闭各段的文件大小之和
   // Phase 5：录制统计 + 像素转换缓冲区
   std::atomic<qint64> m_recordInputOk{0};
   std::atomic<qint64> m_recordInputFail{0};
   std::atomic<qint64> m_recordConvertFail{0};
   std::atomic<quint32> m_lastInputErrorCode{0};
-  bool m_recordingNeedsConvert = false; // 是否需要先 ConvertPixelType
+  bool m_recordingNeedsConvert = false; // 是否需要先转成录制像素类型
   quint32 m_recordingActualPixelType = 0; // 实际录制用的像素类型
-  std::vector<unsigned char> m_convertBuffer;
+  // Bayer → Mono8 的取法：UI 线程设置，openRecorder 时拷给录制线程用
+  BayerDemosaic::MonoMethod m_bayerMonoMethod =
+      BayerDemosaic::MonoMethod::Luma;
+  BayerDemosaic::MonoMethod m_recordingMonoMethod =
+      BayerDemosaic::MonoMethod::Luma;
+  // 同步录制：共同起点由 UI 线程设置、阶段线程读取；第一帧信息只在录制阶段写
+  RecordingSyncGate m_recordSync;
+  QString m_recordSyncGroup;
+  int64_t m_recordFirstGrabNs = 0;
+  uint64_t m_recordFirstDevTimestamp = 0;
+
+  // 预触发：环只在录制阶段线程和持 m_recordMutex 的 UI 线程里访问
+  double m_preTriggerSeconds = 0.0;
+  std::size_t m_preTriggerBudgetBytes = kDefaultPreTriggerBudgetBytes;
+  PreTriggerRing m_preTrigger;
+  qint64 m_recordPreTriggerFrames = 0; // 本次录制开头补写的历史帧数
+  qint64 m_recordPreTriggerSpanMs = 0;
+  qint64 m_recordPreTriggerLost = 0;   // 补写期间新帧进不了环尾的帧数
 
   // 当前分辨率与像素格式
   int m_width = 0;
@@ -151,11 +577,17 @@ private:
   int m_extendWidth = 0;
   int m_extendHeight = 0;
   int m_pixelType = 0;
+  PixelFormatNegotiator::Workflow m_pixelWorkflow =
+      PixelFormatNegotiator::Workflow::MonoRecording;
+  // 帧率限制（setFrameRate / setFrameRateEnable 下发的值），给帧率预估用
+  bool m_frameRateLimitEnabled = false;
+  float m_frameRateLimitFps = 0.0f;
 
-  // 帧缓存 (用于抓拍)
+  // 帧缓存 (用于抓拍)：grab 线程只往信箱发布句柄，
+  // saveSnapshot 时从信箱取最新帧的引用，像素留在池缓冲里不再拷贝
+  LatestFrameMailbox<FrameRef> m_snapshotMailbox;
   std::mutex m_frameMutex;
-  std::vector<unsigned char> m_frameBuffer;
-  unsigned int m_frameLen = 0;
+  FrameRef m_snapshotFrame;
 };
 
 #endif // CAMERACONTROLLER_H
@@ -0,0 +1,224 @@
+#include "CameraManager.h"
+#include "CameraBackendFactory.h"
+#include "../utils/RecordingSync.h"
+#include "../utils/ThreadAffinity.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <chrono>
+
+namespace {
+
+int64_t steadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+CameraManager::CameraManager(QObject *parent)
+    : CameraManager([] { return createDefaultCameraBackend(); }, parent) {}
+
+CameraManager::CameraManager(BackendFactory factory, QObject *parent)
+    : QObject(parent), m_factory(std::move(factory)) {}
+
+CameraManager::~CameraManager() { closeAll(); }
+
+// ============================================================================
+// 设备管理
+// ============================================================================
+
+QList<CameraManager::DeviceInfo> CameraManager::enumerateDevices() {
+  m_devices = m_factory()->enumerateDevices();
+  return m_devices;
+}
+
+int CameraManager::openDevices(const QList<int> &deviceIndices) {
+  if (m_devices.isEmpty())
+    enumerateDevices();
+
+  QList<int> indices = deviceIndices;
+  if (indices.isEmpty()) {
+    for (const DeviceInfo &device : m_devices)
+      indices.append(device.index);
+  }
+
+  for (int index : indices) {
+    auto controller = std::make_unique<CameraController>(m_factory());
+    const int number = cameraCount() + 1;
+    connect(controller.get(), &CameraController::error, this,
+            [this, number](const QString &message) {
+              emit error(QString("相机 %1: %2").arg(number).arg(message));
+            });
+    connect(controller.get(), &CameraController::recordingSegmentSaved, this,
+            [this, number](const QString &path, int segmentIndex,
+                           qint64 bytes) {
+              emit recordingSegmentSaved(number - 1, path, segmentIndex,
+                                         bytes);
+            });
+    if (!controller->open(index)) {
+      qWarning() << "多相机: 打开设备" << index << "失败";
+      continue;
+    }
+    DeviceInfo device;
+    device.index = index;
+    for (const DeviceInfo &d : m_devices) {
+      if (d.index == index)
+        device = d;
+    }
+    m_cameras.push_back(std::move(controller));
+    m_cameraDevices.append(device);
+  }
+  applyGrabThreadCores();
+  qInfo() << "多相机: 已打开" << cameraCount() << "/" << indices.size() << "台";
+  return cameraCount();
+}
+
+void CameraManager::closeAll() {
+  stopRecordingAll();
+  stopGrabbingAll();
+  for (auto &camera : m_cameras)
+    camera->close();
+  m_cameras.clear();
+  m_cameraDevices.clear();
+}
+
+CameraController *CameraManager::camera(int i) const {
+  if (i < 0 || i >= cameraCount())
+    return nullptr;
+  return m_cameras[static_cast<std::size_t>(i)].get();
+}
+
+void CameraManager::setPinGrabThreads(bool pin) {
+  m_pinGrabThreads = pin;
+  applyGrabThreadCores();
+}
+
+void CameraManager::applyGrabThreadCores() {
+  const int cores = ThreadAffinity::coreCount();
+  for (int i = 0; i < cameraCount(); ++i) {
+    // 核数不比相机多时绑核只会让 grab 线程互相抢，不绑
+    const bool pin = m_pinGrabThreads && cores > cameraCount();
+    m_cameras[static_cast<std::size_t>(i)]->setGrabThreadCore(
+        pin ? (i + 1) % cores : -1);
+  }
+}
+
+// ============================================================================
+// 采集
+// ============================================================================
+
+bool CameraManager::startGrabbingAll() {
+  if (m_cameras.empty() || isGrabbing())
+    return false;
+
+  // 慢操作（缓冲池分配 / SDK 节点 / 回调注册）先全部做完
+  for (auto &camera : m_cameras) {
+    if (!camera->prepareGrabbing())
+      return false;
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (auto &camera : m_cameras) {
+    if (!camera->startGrabbing()) {
+      stopGrabbingAll();
+      return false;
+    }
+  }
+  m_lastStartSkewUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - t0)
+                          .count();
+  qInfo() << "多相机: " << cameraCount() << "台开始采集，启动时间差"
+          << m_lastStartSkewUs << "us";
+  return true;
+}
+
+void CameraManager::stopGrabbingAll() {
+  for (auto &camera : m_cameras) {
+    if (camera->isRecording())
+      camera->stopRecording();
+    camera->stopGrabbing();
+  }
+}
+
+bool CameraManager::isGrabbing() const {
+  for (const auto &camera : m_cameras) {
+    if (camera->isGrabbing())
+      return true;
+  }
+  return false;
+}
+
+// ============================================================================
+// 录制
+// ============================================================================
+
+QStringList CameraManager::startRecordingAll(const QString &directory,
+                                             const QString &stem, float fps,
+                                             int bitRateKbps,
+                                             const QString &extension) {
+  if (m_cameras.empty() || isRecording())
+    return {};
+
+  const QString group =
+      QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz");
+  QStringList paths;
+  SyncedStart start;
+  // 文件先开好但不写帧，等所有相机都就绪再定共同起点
+  start.startHeld = [&](int i) {
+    CameraController *cam = m_cameras[static_cast<std::size_t>(i)].get();
+    const QString serial = m_cameraDevices[i].serialNumber;
+    const QString filename =
+        serial.isEmpty()
+            ? QString("%1_cam%2.%3").arg(stem).arg(i + 1).arg(extension)
+            : QString("%1_cam%2_%3.%4")
+                  .arg(stem)
+                  .arg(i + 1)
+                  .arg(serial, extension);
+    const QString path = QDir(directory).absoluteFilePath(filename);
+    cam->setRecordingSync(CameraController::kRecordHoldNs, group);
+    if (!cam->startRecording(path, fps, bitRateKbps)) {
+      cam->setRecordingSync(0, QString());
+      return false;
+    }
+    // 分段录制时实际文件是 _001，后续各段由 recordingSegmentSaved 报出
+    paths.append(cam->recordSegmentPolicy().enabled()
+                     ? QString::fromStdString(RecordSegmenter::segmentPath(
+                           path.toStdString(), 1))
+                     : path);
+    return true;
+  };
+  // 前面几路还在 hold、一帧没写：作废，不留空文件和旁注
+  start.abortHeld = [this](int i) {
+    m_cameras[static_cast<std::size_t>(i)]->abortRecording();
+  };
+  start.release = [this, &group](int i, int64_t startNs) {
+    m_cameras[static_cast<std::size_t>(i)]->setRecordingSync(startNs, group);
+  };
+  start.nowNs = steadyNowNs;
+
+  int failed = -1;
+  if (start.run(cameraCount(), &failed) == 0) {
+    emit error(
+        QString("相机 %1 无法开始录制，已取消全部录制").arg(failed + 1));
+    return {};
+  }
+  qInfo() << "多相机: 同步录制开始，组" << group << "共" << paths.size() << "路";
+  return paths;
+}
+
+void CameraManager::stopRecordingAll() {
+  for (auto &camera : m_cameras) {
+    if (camera->isRecording())
+      camera->stopRecording();
+  }
+}
+
+bool CameraManager::isRecording() const {
+  for (const auto &camera : m_cameras) {
+    if (camera->isRecording())
+      return true;
+  }
+  return false;
+}
@@ -0,0 +1,92 @@
+#ifndef CAMERAMANAGER_H
+#define CAMERAMANAGER_H
+
+#include "CameraController.h"
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 多相机管理：一次枚举、打开 N 台、同时开始采集 / 录制
+ *
+ * 每台相机一个 CameraController（各自的后端实例、帧缓冲池、流水线和
+ * grab 线程），相机之间不共享队列和锁，一台的录制卡顿不会拖慢其他相机。
+ *
+ * 同时开始：先对所有相机 prepareGrabbing（分配缓冲池这类慢操作），
+ * 再背靠背调用各自的 startGrabbing，相机开始出帧的时间差只剩 SDK 启动开销。
+ * 主机端软件同步做不到曝光级对齐；需要逐帧同步时应使用硬件触发。
+ *
+ * 同时录制：所有相机先开好文件但暂不写帧，全部成功后取同一个 steady_clock
+ * 时刻作为共同起点，各路只写采集时刻不早于起点的帧。起点、同组编号和每路
+ * 第一帧的采集时刻 / 设备时间戳写进各自的 .stats.json，离线据此对齐。
+ */
+class CameraManager : public QObject {
+  Q_OBJECT
+
+public:
+  using BackendFactory = std::function<std::unique_ptr<ICameraBackend>()>;
+  using DeviceInfo = CameraController::DeviceInfo;
+
+  // 后端由 createDefaultCameraBackend() 创建，每台相机一个实例
+  explicit CameraManager(QObject *parent = nullptr);
+  explicit CameraManager(BackendFactory factory, QObject *parent = nullptr);
+  ~CameraManager();
+
+  // ========== 设备管理 ==========
+  // 枚举一次并缓存；openDevices 按这份列表的索引打开
+  QList<DeviceInfo> enumerateDevices();
+  QList<DeviceInfo> devices() const { return m_devices; }
+  // 打开指定索引的设备（空表示全部已枚举设备），返回成功打开的台数
+  int openDevices(const QList<int> &deviceIndices = {});
+  void closeAll();
+  int cameraCount() const { return static_cast<int>(m_cameras.size()); }
+  CameraController *camera(int i) const;
+
+  // 第 i 台相机的 grab 线程绑到逻辑核 (i + 1) % 核数，核 0 留给 UI；
+  // 下次 startGrabbingAll 生效
+  void setPinGrabThreads(bool pin);
+
+  // ========== 采集 ==========
+  // 任一台失败时已启动的全部停止
+  bool startGrabbingAll();
+  void stopGrabbingAll();
+  bool isGrabbing() const;
+  // 上次 startGrabbingAll 第一台到最后一台启动完成的时间差
+  qint64 lastStartSkewUs() const { return m_lastStartSkewUs; }
+
+  // ========== 录制 ==========
+  /**
+   * @brief 所有相机同时开始录制，文件名 <stem>_cam<N>_<序列号>.<extension>
+   * extension 决定容器（avi / wvr），见 CameraController::startRecording
+   * 启用分段的相机返回第一段（_001）的路径，后续各段见 recordingSegmentSaved
+   * @return 各路视频路径；任一台失败时作废已开好的各路（删文件、不写
+   * .stats.json）并返回空列表
+   */
+  QStringList startRecordingAll(const QString &directory, const QString &stem,
+                                float fps = -1.0f, int bitRateKbps = 4000,
+                                const QString &extension = "avi");
+  void stopRecordingAll();
+  bool isRecording() const;
+
+signals:
+  void error(const QString &message);
+  // 转发各相机的 CameraController::recordingSegmentSaved，cameraIndex 从 0 开始
+  void recordingSegmentSaved(int cameraIndex, const QString &filePath,
+                             int segmentIndex, qint64 bytes);
+
+private:
+  void applyGrabThreadCores();
+
+  BackendFactory m_factory;
+  QList<DeviceInfo> m_devices;
+  std::vector<std::unique_ptr<CameraController>> m_cameras;
+  QList<DeviceInfo> m_cameraDevices; // 与 m_cameras 一一对应
+  bool m_pinGrabThreads = false;
+  qint64 m_lastStartSkewUs = 0;
+};
+
+#endif // CAMERAMANAGER_H
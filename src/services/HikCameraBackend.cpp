@@ -0,0 +1,353 @@
+#include "HikCameraBackend.h"
+#include <MvCameraControl.h>
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// 进程内最近一次枚举到的设备：多相机时 CameraManager 只枚举一次，
+// 各后端实例 open 时从同一份列表取设备，不会因为重新枚举而索引错位
+std::mutex g_deviceListMutex;
+std::vector<MV_CC_DEVICE_INFO> g_deviceList;
+
+int enumerateDeviceList() {
+  MV_CC_DEVICE_INFO_LIST deviceList;
+  memset(&deviceList, 0, sizeof(MV_CC_DEVICE_INFO_LIST));
+  const int ret =
+      MV_CC_EnumDevices(MV_GIGE_DEVICE | MV_USB_DEVICE, &deviceList);
+  g_deviceList.clear();
+  if (ret != MV_OK)
+    return ret;
+  for (unsigned int i = 0; i < deviceList.nDeviceNum; i++) {
+    // 列表里的指针归 SDK 所有，下次枚举就失效：拷一份结构体
+    MV_CC_DEVICE_INFO info;
+    memset(&info, 0, sizeof(info));
+    if (deviceList.pDeviceInfo[i])
+      info = *deviceList.pDeviceInfo[i];
+    g_deviceList.push_back(info);
+  }
+  return MV_OK;
+}
+
+FrameInfo toFrameInfo(const MV_FRAME_OUT_INFO_EX &src) {
+  FrameInfo info;
+  info.width = src.nWidth;
+  info.height = src.nHeight;
+  info.extendWidth = src.nExtendWidth;
+  info.extendHeight = src.nExtendHeight;
+  info.pixelType = static_cast<uint32_t>(src.enPixelType);
+  info.frameLen = src.nFrameLenEx;
+  info.frameNum = src.nFrameNum;
+  info.devTimestamp = (static_cast<uint64_t>(src.nDevTimeStampHigh) << 32) |
+                      src.nDevTimeStampLow;
+  info.hostTimestamp = src.nHostTimeStamp;
+  info.grabTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+  return info;
+}
+
+} // namespace
+
+HikCameraBackend::~HikCameraBackend() { close(); }
+
+// ============================================================================
+// 设备管理
+// ============================================================================
+
+QList<ICameraBackend::DeviceInfo> HikCameraBackend::enumerateDevices() {
+  QList<DeviceInfo> devices;
+  std::lock_guard<std::mutex> lock(g_deviceListMutex);
+  int ret = enumerateDeviceList();
+  if (ret != MV_OK) {
+    qWarning() << "设备枚举失败:" << Qt::hex << ret;
+    return devices;
+  }
+
+  for (std::size_t i = 0; i < g_deviceList.size(); i++) {
+    const MV_CC_DEVICE_INFO *pDev = &g_deviceList[i];
+
+    DeviceInfo info;
+    info.index = static_cast<int>(i);
+    info.deviceType = pDev->nTLayerType;
+
+    // Phase 3 修复 #5：原代码用 fromLatin1，设备名/序列号含中文（用户自定义名）会乱码。
+    // 海康 SDK 在 Windows 上字段是本地编码（GBK），用 fromLocal8Bit 解码。
+    if (pDev->nTLayerType == MV_GIGE_DEVICE) {
+      info.name = QString::fromLocal8Bit(reinterpret_cast<const char *>(
+          pDev->SpecialInfo.stGigEInfo.chModelName));
+      info.serialNumber = QString::fromLocal8Bit(reinterpret_cast<const char *>(
+          pDev->SpecialInfo.stGigEInfo.chSerialNumber));
+    } else if (pDev->nTLayerType == MV_USB_DEVICE) {
+      info.name = QString::fromLocal8Bit(reinterpret_cast<const char *>(
+          pDev->SpecialInfo.stUsb3VInfo.chModelName));
+      info.serialNumber = QString::fromLocal8Bit(reinterpret_cast<const char *>(
+          pDev->SpecialInfo.stUsb3VInfo.chSerialNumber));
+    }
+    devices.append(info);
+  }
+
+  qDebug() << "已枚举" << devices.size() << "个相机";
+  return devices;
+}
+
+int HikCameraBackend::open(int deviceIndex) {
+  if (m_handle)
+    return MV_OK;
+
+  // 索引对应最近一次 enumerateDevices 的结果；还没枚举过（或索引越界）才重新枚举
+  MV_CC_DEVICE_INFO devInfo;
+  {
+    std::lock_guard<std::mutex> lock(g_deviceListMutex);
+    if (deviceIndex < 0 ||
+        deviceIndex >= static_cast<int>(g_deviceList.size())) {
+      const int ret = enumerateDeviceList();
+      if (ret != MV_OK)
+        return ret;
+    }
+    if (deviceIndex < 0 ||
+        deviceIndex >= static_cast<int>(g_deviceList.size())) {
+      return kErrInvalidParam;
+    }
+    devInfo = g_deviceList[deviceIndex];
+  }
+  MV_CC_DEVICE_INFO *pDevInfo = &devInfo;
+
+  // 创建句柄
+  int ret = MV_CC_CreateHandle(&m_handle, pDevInfo);
+  if (ret != MV_OK) {
+    qWarning() << "创建句柄失败:" << Qt::hex << ret;
+    m_handle = nullptr;
+    return ret;
+  }
+
+  // 打开设备
+  ret = MV_CC_OpenDevice(m_handle);
+  if (ret != MV_OK) {
+    qWarning() << "打开设备失败:" << Qt::hex << ret;
+    MV_CC_DestroyHandle(m_handle);
+    m_handle = nullptr;
+    return ret;
+  }
+
+  // GigE 优化包大小
+  if (pDevInfo->nTLayerType == MV_GIGE_DEVICE) {
+    int packetSize = MV_CC_GetOptimalPacketSize(m_handle);
+    if (packetSize > 0) {
+      MV_CC_SetIntValue(m_handle, "GevSCPSPacketSize", packetSize);
+      qDebug() << "GigE 包大小设置为:" << packetSize;
+    }
+  }
+
+  // 确保触发模式关闭 (连续采集模式)
+  int nRet = MV_CC_SetEnumValue(m_handle, "TriggerMode", MV_TRIGGER_MODE_OFF);
+  if (MV_OK != nRet) {
+    qWarning() << "设置触发模式关闭失败:" << Qt::hex << nRet;
+  }
+  return MV_OK;
+}
+
+void HikCameraBackend::close() {
+  if (!m_handle)
+    return;
+  MV_CC_CloseDevice(m_handle);
+  MV_CC_DestroyHandle(m_handle);
+  m_handle = nullptr;
+  m_grabbing = false;
+  m_callbackPool = nullptr;
+  m_callback = nullptr;
+}
+
+// ============================================================================
+// 图像采集
+// ============================================================================
+
+int HikCameraBackend::startGrabbing() {
+  if (!m_handle)
+    return kErrNotOpen;
+  const int ret = MV_CC_StartGrabbing(m_handle);
+  m_grabbing = ret == MV_OK;
+  return ret;
+}
+
+void HikCameraBackend::stopGrabbing() {
+  // StopGrabbing 返回时 SDK 取流线程已退出，不会再进回调
+  if (m_handle)
+    MV_CC_StopGrabbing(m_handle);
+  m_grabbing = false;
+}
+
+struct HikImageCallback {
+  static void __stdcall invoke(unsigned char *data,
+                               MV_FRAME_OUT_INFO_EX *frameInfo, void *user) {
+    static_cast<HikCameraBackend *>(user)->onImage(data, frameInfo);
+  }
+};
+
+int HikCameraBackend::setFrameCallback(FramePool *pool,
+                                       FrameCallback callback) {
+  if (!m_handle)
+    return kErrNotOpen;
+  if (m_grabbing)
+    return kErrBusy;
+  if (callback && !pool)
+    return kErrInvalidParam;
+
+  // 注册 NULL 取消回调，之后才能再用 MV_CC_GetImageBuffer
+  const int ret =
+      callback ? MV_CC_RegisterImageCallBackEx(m_handle,
+                                               &HikImageCallback::invoke, this)
+               : MV_CC_RegisterImageCallBackEx(m_handle, nullptr, nullptr);
+  if (ret != MV_OK)
+    return ret;
+  m_callbackPool = callback ? pool : nullptr;
+  m_callback = std::move(callback);
+  return MV_OK;
+}
+
+int HikCameraBackend::setBufferNodeCount(unsigned int count) {
+  if (!m_handle)
+    return kErrNotOpen;
+  if (m_grabbing)
+    return kErrBusy;
+  if (count == 0)
+    return kErrInvalidParam;
+  return MV_CC_SetImageNodeNum(m_handle, count);
+}
+
+void HikCameraBackend::onImage(const unsigned char *data,
+                               const void *frameInfo) {
+  if (!m_callback)
+    return;
+  const auto &src = *static_cast<const MV_FRAME_OUT_INFO_EX *>(frameInfo);
+  // 回调返回后 SDK 会复用 data 所在节点：和 grabFrame 一样先拷进池缓冲
+  const std::size_t len = static_cast<std::size_t>(src.nFrameLenEx);
+  GrabResult result = GrabResult::Ok;
+  FrameRef frame = m_callbackPool->acquire();
+  if (!frame) {
+    result = GrabResult::PoolExhausted;
+  } else if (!data || len > frame.capacity()) {
+    result = data ? GrabResult::Oversize : GrabResult::Error;
+    frame.reset();
+  } else {
+    memcpy(frame.writableData(), data, len);
+    frame.writableInfo() = toFrameInfo(src);
+  }
+  m_callback(result, frame);
+}
+
+ICameraBackend::GrabResult HikCameraBackend::grabFrame(FramePool &pool,
+                                                       FrameRef &out,
+                                                       unsigned int timeoutMs) {
+  MV_FRAME_OUT frameOut;
+  memset(&frameOut, 0, sizeof(MV_FRAME_OUT));
+  int ret = MV_CC_GetImageBuffer(m_handle, &frameOut, timeoutMs);
+  if (ret != MV_OK)
+    return static_cast<unsigned int>(ret) == MV_E_NODATA ? GrabResult::Timeout
+                                                         : GrabResult::Error;
+
+  // 唯一一次拷贝：SDK 节点 → 池缓冲，随后立即把节点还给 SDK
+  const std::size_t len =
+      static_cast<std::size_t>(frameOut.stFrameInfo.nFrameLenEx);
+  GrabResult result = GrabResult::Ok;
+  FrameRef frame = pool.acquire();
+  if (!frame) {
+    result = GrabResult::PoolExhausted;
+  } else if (len > frame.capacity()) {
+    result = GrabResult::Oversize;
+    frame.reset();
+  } else {
+    memcpy(frame.writableData(), frameOut.pBufAddr, len);
+    frame.writableInfo() = toFrameInfo(frameOut.stFrameInfo);
+  }
+  MV_CC_FreeImageBuffer(m_handle, &frameOut);
+
+  out = std::move(frame);
+  return result;
+}
+
+// ============================================================================
+// 参数读写
+// ============================================================================
+
+int HikCameraBackend::getFloat(const char *key, FloatValue &out) {
+  if (!m_handle)
+    return kErrNotOpen;
+  MVCC_FLOATVALUE v;
+  memset(&v, 0, sizeof(v));
+  int ret = MV_CC_GetFloatValue(m_handle, key, &v);
+  if (ret == MV_OK) {
+    out.min = v.fMin;
+    out.max = v.fMax;
+    out.current = v.fCurValue;
+  }
+  return ret;
+}
+
+int HikCameraBackend::setFloat(const char *key, float value) {
+  if (!m_handle)
+    return kErrNotOpen;
+  return MV_CC_SetFloatValue(m_handle, key, value);
+}
+
+int HikCameraBackend::getInt(const char *key, IntValue &out) {
+  if (!m_handle)
+    return kErrNotOpen;
+  MVCC_INTVALUE_EX v;
+  memset(&v, 0, sizeof(v));
+  int ret = MV_CC_GetIntValueEx(m_handle, key, &v);
+  if (ret == MV_OK) {
+    out.min = v.nMin;
+    out.max = v.nMax;
+    out.current = v.nCurValue;
+    out.inc = v.nInc;
+  }
+  return ret;
+}
+
+int HikCameraBackend::setInt(const char *key, int64_t value) {
+  if (!m_handle)
+    return kErrNotOpen;
+  return MV_CC_SetIntValueEx(m_handle, key, value);
+}
+
+int HikCameraBackend::getEnum(const char *key, uint32_t &out) {
+  if (!m_handle)
+    return kErrNotOpen;
+  MVCC_ENUMVALUE v;
+  memset(&v, 0, sizeof(v));
+  int ret = MV_CC_GetEnumValue(m_handle, key, &v);
+  if (ret == MV_OK)
+    out = v.nCurValue;
+  return ret;
+}
+
+int HikCameraBackend::setEnum(const char *key, uint32_t value) {
+  if (!m_handle)
+    return kErrNotOpen;
+  return MV_CC_SetEnumValue(m_handle, key, value);
+}
+
+int HikCameraBackend::getEnumEntries(const char *key,
+                                     std::vector<uint32_t> &out) {
+  if (!m_handle)
+    return kErrNotOpen;
+  MVCC_ENUMVALUE v;
+  memset(&v, 0, sizeof(v));
+  int ret = MV_CC_GetEnumValue(m_handle, key, &v);
+  if (ret == MV_OK)
+    out.assign(v.nSupportValue,
+               v.nSupportValue + std::min<unsigned int>(v.nSupportedNum,
+                                                        MV_MAX_XML_SYMBOLIC_NUM));
+  return ret;
+}
+
+int HikCameraBackend::setBool(const char *key, bool value) {
+  if (!m_handle)
+    return kErrNotOpen;
+  return MV_CC_SetBoolValue(m_handle, key, value);
+}
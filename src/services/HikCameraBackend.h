@@ -0,0 +1,63 @@
+#ifndef HIKCAMERABACKEND_H
+#define HIKCAMERABACKEND_H
+
+#include "ICameraBackend.h"
+#include <atomic>
+
+/**
+ * @brief 海康威视 MVS SDK 后端
+ *
+ * grabFrame 用 MV_CC_GetImageBuffer 取节点，拷进池缓冲后立即
+ * MV_CC_FreeImageBuffer，SDK 节点不会被下游慢阶段占住。
+ * 回调模式用 MV_CC_RegisterImageCallBackEx：SDK 取流线程在帧到达时
+ * 直接调用，同样拷进池缓冲后回调返回，节点随即还给 SDK。
+ */
+class HikCameraBackend : public ICameraBackend {
+public:
+  HikCameraBackend() = default;
+  ~HikCameraBackend() override;
+
+  HikCameraBackend(const HikCameraBackend &) = delete;
+  HikCameraBackend &operator=(const HikCameraBackend &) = delete;
+
+  QString backendName() const override { return QStringLiteral("hikvision"); }
+
+  QList<DeviceInfo> enumerateDevices() override;
+  int open(int deviceIndex) override;
+  void close() override;
+  bool isOpen() const override { return m_handle != nullptr; }
+
+  int startGrabbing() override;
+  void stopGrabbing() override;
+  GrabResult grabFrame(FramePool &pool, FrameRef &out,
+                       unsigned int timeoutMs) override;
+
+  bool supportsFrameCallback() const override { return true; }
+  int setFrameCallback(FramePool *pool, FrameCallback callback) override;
+  int setBufferNodeCount(unsigned int count) override;
+
+  int getFloat(const char *key, FloatValue &out) override;
+  int setFloat(const char *key, float value) override;
+  int getInt(const char *key, IntValue &out) override;
+  int setInt(const char *key, int64_t value) override;
+  int getEnum(const char *key, uint32_t &out) override;
+  int setEnum(const char *key, uint32_t value) override;
+  int getEnumEntries(const char *key, std::vector<uint32_t> &out) override;
+  int setBool(const char *key, bool value) override;
+
+  void *sdkHandle() const override { return m_handle; }
+
+private:
+  // SDK 取流线程调用（签名与 MvImageCallbackEx 一致，不 include SDK 头文件）
+  void onImage(const unsigned char *data, const void *frameInfo);
+
+  void *m_handle = nullptr;
+  std::atomic<bool> m_grabbing{false};
+  // 回调模式：只在停止采集时修改，SDK 线程只读
+  FramePool *m_callbackPool = nullptr;
+  FrameCallback m_callback;
+
+  friend struct HikImageCallback;
+};
+
+#endif // HIKCAMERABACKEND_H
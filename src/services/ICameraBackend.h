@@ -0,0 +1,138 @@
+#ifndef ICAMERABACKEND_H
+#define ICAMERABACKEND_H
+
+#include "utils/FramePool.h"
+#include "utils/FrameRef.h"
+#include <QList>
+#include <QString>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief 相机后端接口：枚举 / 打开 / 取帧 / GenICam 风格参数读写
+ *
+ * CameraController 只通过这个接口访问相机，具体实现：
+ * - HikCameraBackend：海康威视 MVS SDK（生产环境）
+ * - SyntheticCameraBackend：生成会动的线虫图像，无需硬件（Linux CI 基准测试）
+ * - ReplayCameraBackend：按原帧率回放录好的视频文件
+ *
+ * 参数 key 沿用 GenICam 节点名（ExposureTime / Width / PixelFormat …），
+ * 返回值 0 表示成功；海康后端直接透传 SDK 错误码，其余后端用下面的 kErr*。
+ */
+class ICameraBackend {
+public:
+  struct DeviceInfo {
+    QString name;
+    QString serialNumber;
+    int index = 0;
+    int deviceType = 0; // MV_GIGE_DEVICE / MV_USB_DEVICE，非海康后端为 0
+  };
+
+  struct FloatValue {
+    float min = 0.0f;
+    float max = 0.0f;
+    float current = 0.0f;
+  };
+
+  struct IntValue {
+    int64_t min = 0;
+    int64_t max = 0;
+    int64_t current = 0;
+    int64_t inc = 1;
+  };
+
+  enum class GrabResult {
+    Ok,
+    Timeout,        // 超时内没有新帧
+    PoolExhausted,  // 帧缓冲池用完，这一帧已丢弃（池子自己计数）
+    Oversize,       // 帧比池缓冲大（采集中改了 ROI / 像素格式），已丢弃
+    EndOfStream,    // 回放到文件末尾且不循环
+    Error
+  };
+
+  static constexpr int kOk = 0;
+  static constexpr int kErrNotSupported = -1; // 后端没有该参数 / 功能
+  static constexpr int kErrInvalidParam = -2; // 索引 / 取值越界
+  static constexpr int kErrNotOpen = -3;
+  static constexpr int kErrBusy = -4;         // 采集中不允许修改
+  static constexpr int kErrIo = -5;           // 文件读写失败
+
+  virtual ~ICameraBackend() = default;
+
+  // 日志 / UI 用的后端名，如 "hikvision"、"synthetic"
+  virtual QString backendName() const = 0;
+
+  virtual QList<DeviceInfo> enumerateDevices() = 0;
+  virtual int open(int deviceIndex) = 0;
+  virtual void close() = 0;
+  virtual bool isOpen() const = 0;
+
+  virtual int startGrabbing() = 0;
+  virtual void stopGrabbing() = 0;
+
+  /**
+   * @brief 取一帧，像素直接写进 pool 的缓冲（grab 线程调用）
+   * @param out 成功时为填好像素和 FrameInfo 的帧
+   */
+  virtual GrabResult grabFrame(FramePool &pool, FrameRef &out,
+                               unsigned int timeoutMs) = 0;
+
+  /**
+   * @brief 回调取帧：后端自己的线程在帧到达时调用，result 不是 Ok 时 frame 为空
+   *
+   * 回调里拿到的 frame 可以直接 move 走；回调应尽快返回（只做分发），
+   * 否则会占住后端的出帧线程。
+   */
+  using FrameCallback = std::function<void(GrabResult result, FrameRef &frame)>;
+
+  virtual bool supportsFrameCallback() const { return false; }
+
+  /**
+   * @brief 切换到回调取帧（推模式），必须在 startGrabbing 之前调用
+   * @param pool 回调帧的像素写进这个池，回调注册期间必须保持有效
+   * @param callback 为空表示取消注册、回到 grabFrame 轮询
+   * @return 采集中调用返回 kErrBusy；注册期间不能调用 grabFrame
+   */
+  virtual int setFrameCallback(FramePool *pool, FrameCallback callback) {
+    (void)pool;
+    (void)callback;
+    return kErrNotSupported;
+  }
+
+  /**
+   * @brief 设置 SDK 内部的取流缓存节点数，必须在 startGrabbing 之前调用
+   *
+   * 节点只需吸收取帧线程自己的调度抖动（帧一到就拷进池缓冲），
+   * 消费者停顿由帧缓冲池和录制队列吸收。
+   * @return 采集中调用返回 kErrBusy；没有该概念的后端返回 kErrNotSupported
+   */
+  virtual int setBufferNodeCount(unsigned int count) {
+    (void)count;
+    return kErrNotSupported;
+  }
+
+  virtual int getFloat(const char *key, FloatValue &out) = 0;
+  virtual int setFloat(const char *key, float value) = 0;
+  virtual int getInt(const char *key, IntValue &out) = 0;
+  virtual int setInt(const char *key, int64_t value) = 0;
+  virtual int getEnum(const char *key, uint32_t &out) = 0;
+  virtual int setEnum(const char *key, uint32_t value) = 0;
+  // 枚举节点当前可选的取值（如 BinningHorizontal 的 1 / 2 / 4）
+  virtual int getEnumEntries(const char *key, std::vector<uint32_t> &out) {
+    (void)key;
+    (void)out;
+    return kErrNotSupported;
+  }
+  virtual int setBool(const char *key, bool value) = 0;
+
+  /**
+   * @brief 海康 SDK 句柄
+   *
+   * SDK 直接渲染 / 像素转换 / AVI 录制 / 存图这些图像接口都要求设备句柄，
+   * 其他后端返回 nullptr，CameraController 会跳过显示并拒绝对应操作。
+   */
+  virtual void *sdkHandle() const { return nullptr; }
+};
+
+#endif // ICAMERABACKEND_H
@@ -0,0 +1,539 @@
+#include "ReplayCameraBackend.h"
+#include "../utils/TilePool.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QStringList>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+constexpr float kFrameRateMin = 0.1f;
+constexpr float kFrameRateMax = 1000.0f;
+// RIFF 嵌套：RIFF > LIST hdrl > LIST strl > chunk，movi 里还可能有 LIST rec
+constexpr int kMaxListDepth = 4;
+
+bool keyIs(const char *key, const char *name) {
+  return key && std::strcmp(key, name) == 0;
+}
+
+uint32_t readLE32(const char *p) {
+  const auto *u = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint32_t>(u[0]) | static_cast<uint32_t>(u[1]) << 8 |
+         static_cast<uint32_t>(u[2]) << 16 | static_cast<uint32_t>(u[3]) << 24;
+}
+
+uint16_t readLE16(const char *p) {
+  const auto *u = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint16_t>(u[0] | u[1] << 8);
+}
+
+bool fourccIs(const char *p, const char *fcc) {
+  return std::memcmp(p, fcc, 4) == 0;
+}
+
+// "00db" / "00dc"：返回流序号，不是视频帧块返回 -1
+int videoChunkStream(const char *id) {
+  if (id[0] < '0' || id[0] > '9' || id[1] < '0' || id[1] > '9')
+    return -1;
+  if (id[2] != 'd' || (id[3] != 'b' && id[3] != 'c'))
+    return -1;
+  return (id[0] - '0') * 10 + (id[1] - '0');
+}
+
+} // namespace
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+ReplayCameraBackend::Options
+ReplayCameraBackend::parseOptions(const QString &spec) {
+  Options options;
+  const int q = spec.indexOf('?');
+  options.path = (q < 0 ? spec : spec.left(q)).trimmed();
+  if (q < 0)
+    return options;
+
+  const QStringList pairs = spec.mid(q + 1).split('&', Qt::SkipEmptyParts);
+  for (const QString &pair : pairs) {
+    const int eq = pair.indexOf('=');
+    if (eq <= 0)
+      continue;
+    const QString key = pair.left(eq).trimmed().toLower();
+    const QString value = pair.mid(eq + 1).trimmed();
+    bool ok = false;
+    if (key == "fps") {
+      const double v = value.toDouble(&ok);
+      if (ok && v >= 0.0)
+        options.fps = v;
+    } else if (key == "loop") {
+      const int v = value.toInt(&ok);
+      if (ok)
+        options.loop = v != 0;
+    }
+  }
+  return options;
+}
+
+ReplayCameraBackend::ReplayCameraBackend(const Options &options)
+    : m_options(options) {}
+
+ReplayCameraBackend::~ReplayCameraBackend() { close(); }
+
+// ============================================================================
+// 设备管理
+// ============================================================================
+
+QList<ICameraBackend::DeviceInfo> ReplayCameraBackend::enumerateDevices() {
+  if (!QFileInfo(m_options.path).isFile())
+    return {};
+  DeviceInfo info;
+  info.index = 0;
+  info.name = QString("Replay %1").arg(QFileInfo(m_options.path).fileName());
+  info.serialNumber = m_options.path;
+  return {info};
+}
+
+int ReplayCameraBackend::open(int deviceIndex) {
+  if (deviceIndex != 0)
+    return kErrInvalidParam;
+  if (m_open)
+    return kOk;
+
+  m_width = 0;
+  m_height = 0;
+  m_fileFps = 0.0;
+  m_wvr = m_options.path.endsWith(".wvr", Qt::CaseInsensitive);
+  if (m_wvr) {
+    if (!openWvr())
+      return kErrNotSupported;
+  } else if (const int err = openAvi(); err != kOk) {
+    return err;
+  }
+
+  m_frameRate = static_cast<float>(
+      std::clamp(m_fileFps > 0.0 ? m_fileFps : 30.0,
+                 static_cast<double>(kFrameRateMin),
+                 static_cast<double>(kFrameRateMax)));
+  m_frameRateEnable = false;
+  m_nextChunk = 0;
+  m_open = true;
+  qDebug() << "回放文件已打开:" << m_options.path << m_width << "x" << m_height
+           << frameCount() << "帧" << m_fileFps << "fps";
+  return kOk;
+}
+
+int ReplayCameraBackend::openAvi() {
+  m_file.setFileName(m_options.path);
+  if (!m_file.open(QIODevice::ReadOnly)) {
+    qWarning() << "回放文件打开失败:" << m_options.path;
+    return kErrIo;
+  }
+
+  m_videoStream = -1;
+  m_streamIndex = 0;
+  m_chunks.clear();
+  if (!parseFile()) {
+    m_file.close();
+    return kErrNotSupported;
+  }
+  return kOk;
+}
+
+bool ReplayCameraBackend::openWvr() {
+  if (!m_wvrReader.open(m_options.path.toStdString())) {
+    qWarning() << "回放 .wvr 打开失败:" << m_options.path
+               << QString::fromStdString(m_wvrReader.error());
+    return false;
+  }
+  m_width = m_wvrReader.width();
+  m_height = m_wvrReader.height();
+  m_pixelType = m_wvrReader.pixelType();
+  m_fileFps = m_wvrReader.fps();
+  // 解码线程只在压缩文件上创建；原样的帧只是一次拷贝
+  if (m_wvrReader.codec() != WvrFormat::kCodecNone && !m_decodePool)
+    m_decodePool = std::make_unique<TilePool>();
+  return true;
+}
+
+void ReplayCameraBackend::close() {
+  stopGrabbing();
+  if (m_open) {
+    m_file.close();
+    m_wvrReader.close();
+  }
+  m_open = false;
+}
+
+// ============================================================================
+// AVI 解析
+// ============================================================================
+
+bool ReplayCameraBackend::parseFile() {
+  const qint64 fileSize = m_file.size();
+  qint64 pos = 0;
+  bool first = true;
+  // OpenDML：第一个 RIFF 'AVI '，超过 1 GB 的部分在后续 RIFF 'AVIX' 里
+  while (pos + 12 <= fileSize) {
+    if (!m_file.seek(pos))
+      break;
+    const QByteArray head = m_file.read(12);
+    if (head.size() < 12 || !fourccIs(head.constData(), "RIFF"))
+      break;
+    const uint32_t size = readLE32(head.constData() + 4);
+    const char *form = head.constData() + 8;
+    if (first && !fourccIs(form, "AVI "))
+      return false;
+    if (fourccIs(form, "AVI ") || fourccIs(form, "AVIX")) {
+      const qint64 end = std::min<qint64>(pos + 8 + size, fileSize);
+      if (!parseList(pos + 12, end, 1))
+        return false;
+    }
+    first = false;
+    pos += 8 + static_cast<qint64>(size) + (size & 1);
+  }
+
+  if (m_videoStream < 0 || m_width <= 0 || m_height <= 0) {
+    qWarning() << "回放文件没有可用的未压缩视频流:" << m_options.path;
+    return false;
+  }
+  if (m_chunks.empty()) {
+    qWarning() << "回放文件没有视频帧:" << m_options.path;
+    return false;
+  }
+  return true;
+}
+
+bool ReplayCameraBackend::parseList(qint64 begin, qint64 end, int depth) {
+  if (depth > kMaxListDepth)
+    return false;
+
+  qint64 pos = begin;
+  while (pos + 8 <= end) {
+    if (!m_file.seek(pos))
+      return false;
+    const QByteArray head = m_file.read(8);
+    if (head.size() < 8)
+      return false;
+    const char *id = head.constData();
+    const uint32_t size = readLE32(id + 4);
+    const qint64 dataPos = pos + 8;
+    const bool isList = fourccIs(id, "LIST");
+    // 录制中断的文件最后一块不完整：LIST 按实际长度截断继续解析，
+    // 普通块直接停止，保留已经完整的帧
+    if (!isList && dataPos + static_cast<qint64>(size) > end)
+      break;
+    const qint64 dataEnd = std::min(dataPos + static_cast<qint64>(size), end);
+
+    if (isList && size >= 4) {
+      const QByteArray listType = m_file.read(4);
+      if (listType.size() < 4)
+        return false;
+      const char *type = listType.constData();
+      if (fourccIs(type, "hdrl") || fourccIs(type, "movi") ||
+          fourccIs(type, "rec ")) {
+        if (!parseList(dataPos + 4, dataEnd, depth + 1))
+          return false;
+      } else if (fourccIs(type, "strl")) {
+        if (!parseList(dataPos + 4, dataEnd, depth + 1))
+          return false;
+        ++m_streamIndex;
+      }
+    } else if (fourccIs(id, "avih") && size >= 4) {
+      const QByteArray avih = m_file.read(4);
+      const uint32_t usPerFrame = avih.size() == 4 ? readLE32(avih.constData()) : 0;
+      if (usPerFrame > 0)
+        m_fileFps = 1000000.0 / usPerFrame;
+    } else if (fourccIs(id, "strh") && size >= 4) {
+      const QByteArray fccType = m_file.read(4);
+      if (m_videoStream < 0 && fccType.size() == 4 &&
+          fourccIs(fccType.constData(), "vids"))
+        m_videoStream = m_streamIndex;
+    } else if (fourccIs(id, "strf")) {
+      if (m_streamIndex == m_videoStream && m_width == 0 &&
+          !parseStreamFormat(m_file.read(size)))
+        return false;
+    } else if (size > 0 && m_videoStream >= 0 &&
+               videoChunkStream(id) == m_videoStream) {
+      // 0 字节的帧块是录制时丢掉的帧，直接跳过
+      m_chunks.push_back({dataPos, size});
+    }
+    // 其余块（JUNK / idx1 / ix## / strd …）跳过
+
+    pos = dataPos + static_cast<qint64>(size) + (size & 1);
+  }
+  return true;
+}
+
+bool ReplayCameraBackend::parseStreamFormat(const QByteArray &strf) {
+  // BITMAPINFOHEADER
+  if (strf.size() < 40)
+    return false;
+  const char *p = strf.constData();
+  const auto width = static_cast<int32_t>(readLE32(p + 4));
+  const auto height = static_cast<int32_t>(readLE32(p + 8));
+  const uint16_t bitCount = readLE16(p + 14);
+  const char *compression = p + 16;
+  if (width <= 0 || height == 0)
+    return false;
+
+  m_width = width;
+  m_height = height < 0 ? -height : height;
+  if (readLE32(compression) == 0) { // BI_RGB
+    if (bitCount == 8) {
+      m_pixelType = kPixelMono8;
+    } else if (bitCount == 24) {
+      m_pixelType = kPixelBGR8;
+    } else {
+      qWarning() << "回放不支持的 BI_RGB 位深:" << bitCount;
+      m_width = 0;
+      return false;
+    }
+    // 高度为正表示自底向上存储
+    m_bottomUp = height > 0;
+    m_srcStride =
+        (static_cast<std::size_t>(m_width) * bitCount + 31) / 32 * 4;
+    return true;
+  }
+  if (fourccIs(compression, "Y800") || fourccIs(compression, "Y8  ") ||
+      fourccIs(compression, "GREY")) {
+    m_pixelType = kPixelMono8;
+    m_bottomUp = false;
+    m_srcStride = static_cast<std::size_t>(m_width);
+    return true;
+  }
+
+  qWarning() << "回放只支持未压缩 AVI，文件编码为:"
+             << QString::fromLatin1(compression, 4);
+  m_width = 0;
+  return false;
+}
+
+// ============================================================================
+// 图像采集
+// ============================================================================
+
+int ReplayCameraBackend::startGrabbing() {
+  if (!m_open)
+    return kErrNotOpen;
+  if (m_grabbing)
+    return kOk;
+  m_frameNum = 0;
+  m_startTime = Clock::now();
+  m_nextFrameTime = m_startTime;
+  m_grabbing = true;
+  return kOk;
+}
+
+void ReplayCameraBackend::stopGrabbing() { m_grabbing = false; }
+
+ICameraBackend::GrabResult
+ReplayCameraBackend::grabFrame(FramePool &pool, FrameRef &out,
+                               unsigned int timeoutMs) {
+  out.reset();
+  if (!m_grabbing)
+    return GrabResult::Error;
+
+  if (m_nextChunk >= static_cast<std::size_t>(frameCount())) {
+    if (!m_options.loop)
+      return GrabResult::EndOfStream;
+    m_nextChunk = 0;
+  }
+
+  double fps = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    fps = effectiveFps();
+  }
+
+  // 按帧率节拍出图；回放不丢帧，落后时从当前时刻重新起拍
+  if (fps > 0.0) {
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / fps));
+    Clock::time_point now = Clock::now();
+    if (m_nextFrameTime > now) {
+      if (m_nextFrameTime - now > std::chrono::milliseconds(timeoutMs)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        return GrabResult::Timeout;
+      }
+      std::this_thread::sleep_until(m_nextFrameTime);
+    } else if (now - m_nextFrameTime > period) {
+      m_nextFrameTime = now;
+    }
+    m_nextFrameTime += period;
+  }
+
+  FrameRef frame = pool.acquire();
+  if (!frame)
+    return GrabResult::PoolExhausted;
+  const std::size_t len = payloadSize();
+  if (len > frame.capacity())
+    return GrabResult::Oversize;
+
+  unsigned char *dst = frame.writableData();
+  if (m_wvr) {
+    if (!m_wvrReader.readFrame(m_nextChunk++, dst, m_decodePool.get()))
+      return GrabResult::Error;
+  } else if (const GrabResult r = readAviFrame(dst, len);
+             r != GrabResult::Ok) {
+    return r;
+  }
+
+  FrameInfo &info = frame.writableInfo();
+  info.width = static_cast<uint32_t>(m_width);
+  info.height = static_cast<uint32_t>(m_height);
+  info.extendWidth = info.width;
+  info.extendHeight = info.height;
+  info.pixelType = m_pixelType;
+  info.frameLen = len;
+  info.frameNum = m_frameNum++;
+  const Clock::time_point now = Clock::now();
+  info.devTimestamp = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_startTime)
+          .count());
+  info.hostTimestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+  info.grabTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now.time_since_epoch())
+                        .count();
+
+  out = std::move(frame);
+  return GrabResult::Ok;
+}
+
+ICameraBackend::GrabResult
+ReplayCameraBackend::readAviFrame(unsigned char *dst, std::size_t len) {
+  const Chunk chunk = m_chunks[m_nextChunk++];
+  const std::size_t rowBytes = len / static_cast<std::size_t>(m_height);
+  const std::size_t srcBytes = m_srcStride * static_cast<std::size_t>(m_height);
+  if (chunk.size < srcBytes || !m_file.seek(chunk.offset))
+    return GrabResult::Error;
+
+  if (!m_bottomUp && m_srcStride == rowBytes) {
+    // 常见情况：自顶向下且无行填充，直接读进池缓冲
+    if (m_file.read(reinterpret_cast<char *>(dst),
+                    static_cast<qint64>(len)) != static_cast<qint64>(len))
+      return GrabResult::Error;
+    return GrabResult::Ok;
+  }
+  m_readBuffer.resize(srcBytes);
+  if (m_file.read(reinterpret_cast<char *>(m_readBuffer.data()),
+                  static_cast<qint64>(srcBytes)) !=
+      static_cast<qint64>(srcBytes))
+    return GrabResult::Error;
+  for (int y = 0; y < m_height; ++y) {
+    const int srcRow = m_bottomUp ? m_height - 1 - y : y;
+    std::memcpy(dst + static_cast<std::size_t>(y) * rowBytes,
+                m_readBuffer.data() + srcRow * m_srcStride, rowBytes);
+  }
+  return GrabResult::Ok;
+}
+
+double ReplayCameraBackend::effectiveFps() const {
+  if (m_frameRateEnable)
+    return m_frameRate;
+  if (m_options.fps >= 0.0)
+    return m_options.fps;
+  return m_fileFps;
+}
+
+std::size_t ReplayCameraBackend::payloadSize() const {
+  if (m_wvr)
+    return m_wvrReader.frameBytes();
+  const std::size_t bpp = m_pixelType == kPixelBGR8 ? 3 : 1;
+  return static_cast<std::size_t>(m_width) * m_height * bpp;
+}
+
+// ============================================================================
+// 参数读写
+// ============================================================================
+
+int ReplayCameraBackend::getFloat(const char *key, FloatValue &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "AcquisitionFrameRate")) {
+    out = {kFrameRateMin, kFrameRateMax, m_frameRate};
+  } else if (keyIs(key, "ResultingFrameRate")) {
+    out = {0.0f, kFrameRateMax, static_cast<float>(effectiveFps())};
+  } else {
+    return kErrNotSupported;
+  }
+  return kOk;
+}
+
+int ReplayCameraBackend::setFloat(const char *key, float value) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (!keyIs(key, "AcquisitionFrameRate"))
+    return kErrNotSupported;
+  if (value < kFrameRateMin || value > kFrameRateMax)
+    return kErrInvalidParam;
+  m_frameRate = value;
+  return kOk;
+}
+
+int ReplayCameraBackend::getInt(const char *key, IntValue &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "Width") || keyIs(key, "WidthMax")) {
+    out = {m_width, m_width, m_width, 1};
+  } else if (keyIs(key, "Height") || keyIs(key, "HeightMax")) {
+    out = {m_height, m_height, m_height, 1};
+  } else if (keyIs(key, "OffsetX") || keyIs(key, "OffsetY")) {
+    out = {0, 0, 0, 1};
+  } else if (keyIs(key, "PayloadSize")) {
+    const auto size = static_cast<int64_t>(payloadSize());
+    out = {size, size, size, 1};
+  } else {
+    return kErrNotSupported;
+  }
+  return kOk;
+}
+
+int ReplayCameraBackend::setInt(const char *, int64_t) {
+  // 分辨率由文件决定
+  return m_open ? kErrNotSupported : kErrNotOpen;
+}
+
+int ReplayCameraBackend::getEnum(const char *key, uint32_t &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "PixelFormat")) {
+    out = m_pixelType;
+  } else if (keyIs(key, "TriggerMode")) {
+    out = 0;
+  } else {
+    return kErrNotSupported;
+  }
+  return kOk;
+}
+
+int ReplayCameraBackend::setEnum(const char *key, uint32_t value) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  // 只接受与文件一致的取值，方便上层无差别地下发默认配置
+  if (keyIs(key, "PixelFormat"))
+    return value == m_pixelType ? kOk : kErrNotSupported;
+  if (keyIs(key, "TriggerMode"))
+    return value == 0 ? kOk : kErrNotSupported;
+  return kErrNotSupported;
+}
+
+int ReplayCameraBackend::setBool(const char *key, bool value) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "AcquisitionFrameRateEnable")) {
+    m_frameRateEnable = value;
+    return kOk;
+  }
+  return kErrNotSupported;
+}
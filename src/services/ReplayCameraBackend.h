@@ -0,0 +1,128 @@
+#ifndef REPLAYCAMERABACKEND_H
+#define REPLAYCAMERABACKEND_H
+
+#include "ICameraBackend.h"
+#include "../utils/WvrReader.h"
+#include <QFile>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TilePool;
+
+/**
+ * @brief 回放相机后端：把录好的未压缩 AVI / .wvr 当作相机逐帧输出
+ *
+ * 用真实实验画面复现问题、在 CI 上跑录制链路基准。AVI 只认未压缩视频流：
+ * - BI_RGB 8 bit 灰度  → Mono8
+ * - BI_RGB 24 bit      → BGR8（自底向上存储的行会翻转成自顶向下）
+ * - Y800 / Y8 / GREY   → Mono8
+ * 支持 OpenDML（RIFF AVIX 续段）。压缩格式（MJPG / H264 …）open 时返回
+ * kErrNotSupported。
+ *
+ * .wvr（按扩展名识别）经 WvrReader 读，像素格式就是录制时的原生格式；
+ * 无损压缩的帧解码直接写进池缓冲，条带分给后端自带的 TilePool。
+ *
+ * Width / Height / PixelFormat 由文件决定，只读；帧率默认取文件帧率，
+ * 可以用 AcquisitionFrameRate 覆盖。
+ */
+class ReplayCameraBackend : public ICameraBackend {
+public:
+  static constexpr uint32_t kPixelMono8 = 0x01080001;
+  static constexpr uint32_t kPixelBGR8 = 0x02180015;
+
+  struct Options {
+    QString path;
+    double fps = -1.0; // < 0 = 文件帧率，0 = 不限速
+    bool loop = true;  // 播完从头再来；false 时返回 EndOfStream
+  };
+
+  /**
+   * @brief 解析 "D:/data/run1.avi?fps=30&loop=0"
+   * 问号前是文件路径，未知 key / 非法值忽略
+   */
+  static Options parseOptions(const QString &spec);
+
+  explicit ReplayCameraBackend(const Options &options);
+  ~ReplayCameraBackend() override;
+
+  QString backendName() const override { return QStringLiteral("replay"); }
+
+  QList<DeviceInfo> enumerateDevices() override;
+  int open(int deviceIndex) override;
+  void close() override;
+  bool isOpen() const override { return m_open; }
+
+  int startGrabbing() override;
+  void stopGrabbing() override;
+  GrabResult grabFrame(FramePool &pool, FrameRef &out,
+                       unsigned int timeoutMs) override;
+
+  int getFloat(const char *key, FloatValue &out) override;
+  int setFloat(const char *key, float value) override;
+  int getInt(const char *key, IntValue &out) override;
+  int setInt(const char *key, int64_t value) override;
+  int getEnum(const char *key, uint32_t &out) override;
+  int setEnum(const char *key, uint32_t value) override;
+  int setBool(const char *key, bool value) override;
+
+  // 已索引的帧数（open 之后有效）
+  int frameCount() const {
+    return static_cast<int>(m_wvr ? m_wvrReader.frameCount()
+                                  : m_chunks.size());
+  }
+
+private:
+  struct Chunk {
+    qint64 offset; // 数据起始位置（跳过 8 字节块头）
+    uint32_t size;
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  int openAvi();
+  bool openWvr();
+  bool parseFile();
+  bool parseList(qint64 begin, qint64 end, int depth);
+  bool parseStreamFormat(const QByteArray &strf);
+  // 读 m_nextChunk 帧到 dst（len 字节），去行填充 / 翻转
+  GrabResult readAviFrame(unsigned char *dst, std::size_t len);
+  double effectiveFps() const;
+  std::size_t payloadSize() const;
+
+  Options m_options;
+  QFile m_file;
+  bool m_open = false;
+  std::atomic<bool> m_grabbing{false};
+  // 参数读写（UI 线程）与出图（grab 线程）互斥
+  mutable std::mutex m_mutex;
+
+  // 解析结果
+  int m_width = 0;
+  int m_height = 0;
+  uint32_t m_pixelType = kPixelMono8;
+  bool m_bottomUp = false;
+  std::size_t m_srcStride = 0; // 文件中每行字节数（BI_RGB 按 4 字节对齐）
+  double m_fileFps = 0.0;
+  int m_videoStream = -1; // 第一个 vids 流的序号
+  int m_streamIndex = 0;  // 解析 hdrl 时的当前 strl 序号
+  std::vector<Chunk> m_chunks;
+  // .wvr：帧从映射读，压缩帧由 m_decodePool 分条带解码
+  bool m_wvr = false;
+  WvrReader m_wvrReader;
+  std::unique_ptr<TilePool> m_decodePool;
+
+  float m_frameRate = 0.0f;
+  bool m_frameRateEnable = false;
+
+  std::size_t m_nextChunk = 0;
+  uint32_t m_frameNum = 0;
+  std::vector<unsigned char> m_readBuffer; // 需要翻转 / 去行填充时的中转
+  Clock::time_point m_startTime;
+  Clock::time_point m_nextFrameTime;
+};
+
+#endif // REPLAYCAMERABACKEND_H
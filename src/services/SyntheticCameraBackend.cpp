@@ -0,0 +1,618 @@
+#include "SyntheticCameraBackend.h"
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// 画面亮度（12 bit 标尺，编码时再换算到各像素格式）
+constexpr int kAgarLevel = 2900;
+constexpr int kWormLevel = 950;
+constexpr int kMaxLevel = 4095;
+
+// BayerRG8 各通道相对增益（/256）：RGGB，模拟偏暖的透射光源
+constexpr int kBayerGain[4] = {230, 256, 256, 180};
+
+// 参数范围（参考常见 500 万像素工业相机）
+constexpr float kExposureMin = 20.0f;
+constexpr float kExposureMax = 1000000.0f;
+constexpr float kExposureRef = 10000.0f; // 该曝光下为标称亮度
+constexpr float kGainMax = 24.0f;
+constexpr float kFrameRateMin = 0.1f;
+constexpr float kFrameRateMax = 1000.0f;
+constexpr int64_t kRoiMin = 64;
+constexpr int64_t kRoiInc = 8;
+// 回调线程单次等帧上限，决定 stopGrabbing 最长等待
+constexpr unsigned int kCallbackWaitMs = 50;
+
+bool keyIs(const char *key, const char *name) {
+  return key && std::strcmp(key, name) == 0;
+}
+
+int bytesPerPixel(uint32_t pixelType) {
+  return pixelType == SyntheticCameraBackend::kPixelMono12 ? 2 : 1;
+}
+
+} // namespace
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+SyntheticCameraBackend::Config
+SyntheticCameraBackend::parseOptions(const QString &options) {
+  Config config;
+  const QStringList pairs = options.split('&', Qt::SkipEmptyParts);
+  for (const QString &pair : pairs) {
+    const int eq = pair.indexOf('=');
+    if (eq <= 0)
+      continue;
+    const QString key = pair.left(eq).trimmed().toLower();
+    const QString value = pair.mid(eq + 1).trimmed();
+    bool ok = false;
+    if (key == "width") {
+      const int v = value.toInt(&ok);
+      if (ok && v >= kRoiMin)
+        config.width = v;
+    } else if (key == "height") {
+      const int v = value.toInt(&ok);
+      if (ok && v >= kRoiMin)
+        config.height = v;
+    } else if (key == "fps") {
+      const double v = value.toDouble(&ok);
+      if (ok && v >= 0.0)
+        config.fps = v;
+    } else if (key == "worms") {
+      const int v = value.toInt(&ok);
+      if (ok && v >= 0)
+        config.wormCount = v;
+    } else if (key == "seed") {
+      const uint v = value.toUInt(&ok);
+      if (ok)
+        config.seed = v;
+    } else if (key == "cameras") {
+      const int v = value.toInt(&ok);
+      if (ok && v >= 1)
+        config.cameras = v;
+    } else if (key == "format") {
+      const QString f = value.toLower();
+      if (f == "mono8")
+        config.pixelType = kPixelMono8;
+      else if (f == "bayerrg8")
+        config.pixelType = kPixelBayerRG8;
+      else if (f == "mono12")
+        config.pixelType = kPixelMono12;
+    }
+  }
+  // 与真实相机一致，宽高按步长对齐
+  config.width = static_cast<int>(config.width / kRoiInc * kRoiInc);
+  config.height = static_cast<int>(config.height / kRoiInc * kRoiInc);
+  return config;
+}
+
+bool SyntheticCameraBackend::isSupportedPixelType(uint32_t pixelType) {
+  return pixelType == kPixelMono8 || pixelType == kPixelBayerRG8 ||
+         pixelType == kPixelMono12;
+}
+
+SyntheticCameraBackend::SyntheticCameraBackend()
+    : SyntheticCameraBackend(Config()) {}
+
+SyntheticCameraBackend::SyntheticCameraBackend(const Config &config)
+    : m_config(config) {
+  if (!isSupportedPixelType(m_config.pixelType))
+    m_config.pixelType = kPixelMono8;
+  m_config.width = std::max<int>(m_config.width, kRoiMin);
+  m_config.height = std::max<int>(m_config.height, kRoiMin);
+}
+
+SyntheticCameraBackend::~SyntheticCameraBackend() { close(); }
+
+// ============================================================================
+// 设备管理
+// ============================================================================
+
+QList<ICameraBackend::DeviceInfo> SyntheticCameraBackend::enumerateDevices() {
+  QList<DeviceInfo> devices;
+  for (int i = 0; i < std::max(1, m_config.cameras); ++i) {
+    DeviceInfo info;
+    info.index = i;
+    info.name =
+        QString("Synthetic %1x%2").arg(m_config.width).arg(m_config.height);
+    info.serialNumber = QString("SYN-%1").arg(m_config.seed + i);
+    devices.append(info);
+  }
+  return devices;
+}
+
+int SyntheticCameraBackend::open(int deviceIndex) {
+  if (deviceIndex < 0 || deviceIndex >= std::max(1, m_config.cameras))
+    return kErrInvalidParam;
+  if (m_open)
+    return kOk;
+
+  m_deviceIndex = deviceIndex;
+  m_width = m_config.width;
+  m_height = m_config.height;
+  m_offsetX = 0;
+  m_offsetY = 0;
+  m_pixelType = m_config.pixelType;
+  m_exposureUs = kExposureRef;
+  m_gainDb = 0.0f;
+  m_frameRate = m_config.fps > 0.0 ? static_cast<float>(m_config.fps) : 60.0f;
+  m_frameRateEnable = false;
+  resetScene();
+  m_open = true;
+  return kOk;
+}
+
+void SyntheticCameraBackend::close() {
+  stopGrabbing();
+  m_open = false;
+}
+
+// ============================================================================
+// 图像采集
+// ============================================================================
+
+int SyntheticCameraBackend::startGrabbing() {
+  if (!m_open)
+    return kErrNotOpen;
+  if (m_grabbing)
+    return kOk;
+  m_frameNum = 0;
+  m_nextFrameTime = Clock::now();
+  m_grabbing = true;
+  if (m_callback)
+    m_callbackThread = std::thread(&SyntheticCameraBackend::callbackLoop, this);
+  return kOk;
+}
+
+void SyntheticCameraBackend::stopGrabbing() {
+  m_grabbing = false;
+  // 和 MV_CC_StopGrabbing 一样：返回时不会再进回调
+  if (m_callbackThread.joinable())
+    m_callbackThread.join();
+}
+
+int SyntheticCameraBackend::setFrameCallback(FramePool *pool,
+                                             FrameCallback callback) {
+  if (m_grabbing)
+    return kErrBusy;
+  if (callback && !pool)
+    return kErrInvalidParam;
+  m_callbackPool = callback ? pool : nullptr;
+  m_callback = std::move(callback);
+  return kOk;
+}
+
+void SyntheticCameraBackend::callbackLoop() {
+  while (m_grabbing) {
+    FrameRef frame;
+    const GrabResult result =
+        produceFrame(*m_callbackPool, frame, kCallbackWaitMs);
+    if (result == GrabResult::Timeout)
+      continue;
+    if (result == GrabResult::Error)
+      break;
+    m_callback(result, frame);
+  }
+}
+
+ICameraBackend::GrabResult
+SyntheticCameraBackend::grabFrame(FramePool &pool, FrameRef &out,
+                                  unsigned int timeoutMs) {
+  out.reset();
+  // 回调模式下帧只从回调出
+  if (m_callback)
+    return GrabResult::Error;
+  return produceFrame(pool, out, timeoutMs);
+}
+
+ICameraBackend::GrabResult
+SyntheticCameraBackend::produceFrame(FramePool &pool, FrameRef &out,
+                                     unsigned int timeoutMs) {
+  out.reset();
+  if (!m_grabbing)
+    return GrabResult::Error;
+
+  double fps = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    fps = effectiveFps();
+  }
+
+  // 按帧率节拍出图（m_nextFrameTime 只有 grab 线程访问）
+  uint32_t skipped = 0;
+  Clock::time_point exposureTime = Clock::now();
+  if (fps > 0.0) {
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / fps));
+    Clock::time_point now = Clock::now();
+    if (m_nextFrameTime > now) {
+      if (m_nextFrameTime - now > std::chrono::milliseconds(timeoutMs)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        return GrabResult::Timeout;
+      }
+      std::this_thread::sleep_until(m_nextFrameTime);
+      now = Clock::now();
+    }
+    // 取帧慢于帧率时，相机侧已经曝光的帧来不及传输：跳过它们，
+    // 帧号会出现空洞，和真实相机的表现一致
+    while (now - m_nextFrameTime >= period) {
+      m_nextFrameTime += period;
+      ++skipped;
+    }
+    exposureTime = m_nextFrameTime;
+    m_nextFrameTime += period;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (uint32_t i = 0; i < skipped; ++i)
+    advanceWorms();
+  m_frameNum += skipped;
+  const uint32_t frameNum = m_frameNum++;
+  advanceWorms();
+
+  FrameRef frame = pool.acquire();
+  if (!frame)
+    return GrabResult::PoolExhausted;
+  const std::size_t len = payloadSize();
+  if (len > frame.capacity())
+    return GrabResult::Oversize;
+
+  renderFrame(frame.writableData());
+
+  FrameInfo &info = frame.writableInfo();
+  info.width = static_cast<uint32_t>(m_width);
+  info.height = static_cast<uint32_t>(m_height);
+  info.extendWidth = info.width;
+  info.extendHeight = info.height;
+  info.pixelType = m_pixelType;
+  info.frameLen = len;
+  info.frameNum = frameNum;
+  const Clock::time_point now = Clock::now();
+  info.devTimestamp = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          exposureTime.time_since_epoch())
+          .count());
+  info.hostTimestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+  info.grabTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now.time_since_epoch())
+                        .count();
+
+  out = std::move(frame);
+  return GrabResult::Ok;
+}
+
+double SyntheticCameraBackend::effectiveFps() const {
+  if (m_frameRateEnable)
+    return m_frameRate;
+  return m_config.fps;
+}
+
+std::size_t SyntheticCameraBackend::payloadSize() const {
+  return static_cast<std::size_t>(m_width) * m_height *
+         bytesPerPixel(m_pixelType);
+}
+
+// ============================================================================
+// 画面生成
+// ============================================================================
+
+uint32_t SyntheticCameraBackend::nextRandom() {
+  // xorshift32：确定性、足够快
+  m_rng ^= m_rng << 13;
+  m_rng ^= m_rng >> 17;
+  m_rng ^= m_rng << 5;
+  return m_rng;
+}
+
+void SyntheticCameraBackend::resetScene() {
+  const uint32_t seed = m_config.seed + static_cast<uint32_t>(m_deviceIndex);
+  m_rng = seed ? seed : 1;
+  m_worms.clear();
+  const double w = m_config.width;
+  const double h = m_config.height;
+  for (int i = 0; i < m_config.wormCount; ++i) {
+    Worm worm;
+    worm.x = w * (0.15 + 0.7 * randomUnit());
+    worm.y = h * (0.15 + 0.7 * randomUnit());
+    worm.heading = 2.0 * kPi * randomUnit();
+    worm.phase = 2.0 * kPi * randomUnit();
+    worm.speed = std::min(w, h) * (0.0015 + 0.002 * randomUnit());
+    worm.turnRate = (randomUnit() - 0.5) * 0.02;
+    m_worms.push_back(worm);
+  }
+  m_backgroundDirty = true;
+}
+
+void SyntheticCameraBackend::advanceWorms() {
+  const double w = m_config.width;
+  const double h = m_config.height;
+  const double margin = std::min(w, h) * 0.08;
+  for (Worm &worm : m_worms) {
+    worm.phase += 0.22;
+    worm.heading += worm.turnRate + (randomUnit() - 0.5) * 0.05;
+    // 靠近边缘时掉头朝向画面中心
+    if (worm.x < margin || worm.x > w - margin || worm.y < margin ||
+        worm.y > h - margin) {
+      const double toCenter = std::atan2(h / 2 - worm.y, w / 2 - worm.x);
+      worm.heading += 0.15 * std::sin(toCenter - worm.heading);
+    }
+    worm.x += std::cos(worm.heading) * worm.speed;
+    worm.y += std::sin(worm.heading) * worm.speed;
+  }
+}
+
+void SyntheticCameraBackend::rebuildBackground() {
+  const double brightness =
+      (m_exposureUs / kExposureRef) * std::pow(10.0, m_gainDb / 20.0);
+  const int bpp = bytesPerPixel(m_pixelType);
+  m_background.assign(payloadSize(), 0);
+
+  // 透射照明的暗角 + 固定纹理（按全幅坐标生成，ROI 改变时纹理不跳）
+  const double cx = m_config.width / 2.0;
+  const double cy = m_config.height / 2.0;
+  const double r2max = cx * cx + cy * cy;
+  for (int y = 0; y < m_height; ++y) {
+    const int fy = y + m_offsetY;
+    for (int x = 0; x < m_width; ++x) {
+      const int fx = x + m_offsetX;
+      const double dx = fx - cx;
+      const double dy = fy - cy;
+      const double vignette = 1.0 - 0.35 * (dx * dx + dy * dy) / r2max;
+      uint32_t hsh = static_cast<uint32_t>(fx) * 73856093u ^
+                     static_cast<uint32_t>(fy) * 19349663u;
+      hsh ^= hsh >> 13;
+      const int texture = static_cast<int>(hsh & 0x7F) - 64;
+      int level = static_cast<int>((kAgarLevel * vignette + texture) *
+                                   brightness);
+      if (m_pixelType == kPixelBayerRG8)
+        level = level * kBayerGain[((y & 1) << 1) | (x & 1)] >> 8;
+      level = std::clamp(level, 0, kMaxLevel);
+      const std::size_t idx = (static_cast<std::size_t>(y) * m_width + x) * bpp;
+      if (bpp == 2) {
+        m_background[idx] = static_cast<unsigned char>(level & 0xFF);
+        m_background[idx + 1] = static_cast<unsigned char>(level >> 8);
+      } else {
+        m_background[idx] = static_cast<unsigned char>(level >> 4);
+      }
+    }
+  }
+  m_backgroundDirty = false;
+}
+
+void SyntheticCameraBackend::stampDisc(unsigned char *dst, double cx,
+                                       double cy, double radius, int level) {
+  // cx/cy 为 ROI 内坐标
+  const int x0 = std::max(0, static_cast<int>(std::floor(cx - radius)));
+  const int x1 = std::min(m_width - 1, static_cast<int>(std::ceil(cx + radius)));
+  const int y0 = std::max(0, static_cast<int>(std::floor(cy - radius)));
+  const int y1 =
+      std::min(m_height - 1, static_cast<int>(std::ceil(cy + radius)));
+  const double r2 = radius * radius;
+  const int bpp = bytesPerPixel(m_pixelType);
+  const bool bayer = m_pixelType == kPixelBayerRG8;
+  for (int y = y0; y <= y1; ++y) {
+    const double dy = y - cy;
+    unsigned char *row = dst + static_cast<std::size_t>(y) * m_width * bpp;
+    for (int x = x0; x <= x1; ++x) {
+      const double dx = x - cx;
+      if (dx * dx + dy * dy > r2)
+        continue;
+      int v = bayer ? level * kBayerGain[((y & 1) << 1) | (x & 1)] >> 8 : level;
+      v = std::clamp(v, 0, kMaxLevel);
+      if (bpp == 2) {
+        row[x * 2] = static_cast<unsigned char>(v & 0xFF);
+        row[x * 2 + 1] = static_cast<unsigned char>(v >> 8);
+      } else {
+        row[x] = static_cast<unsigned char>(v >> 4);
+      }
+    }
+  }
+}
+
+void SyntheticCameraBackend::renderFrame(unsigned char *dst) {
+  if (m_backgroundDirty || m_background.size() != payloadSize())
+    rebuildBackground();
+  std::memcpy(dst, m_background.data(), m_background.size());
+
+  const double brightness =
+      (m_exposureUs / kExposureRef) * std::pow(10.0, m_gainDb / 20.0);
+  const int wormLevel = static_cast<int>(kWormLevel * brightness);
+
+  // 身体 = 沿前进方向反向展开的正弦曲线，用一串圆盘叠出来，两头变细
+  const double bodyLength = std::min(m_config.width, m_config.height) * 0.18;
+  const double radius = bodyLength * 0.045;
+  const double wavelength = bodyLength * 0.6;
+  const double amplitude = radius * 1.6;
+  constexpr int kSegments = 28;
+  for (const Worm &worm : m_worms) {
+    const double dirX = std::cos(worm.heading);
+    const double dirY = std::sin(worm.heading);
+    for (int i = 0; i < kSegments; ++i) {
+      const double t = (i + 0.5) / kSegments;
+      const double s = t * bodyLength;
+      const double lateral =
+          amplitude * std::sin(2.0 * kPi * s / wavelength - worm.phase);
+      const double px = worm.x - dirX * s - dirY * lateral - m_offsetX;
+      const double py = worm.y - dirY * s + dirX * lateral - m_offsetY;
+      const double r = radius * (0.45 + 0.55 * std::sin(kPi * t));
+      stampDisc(dst, px, py, r, wormLevel);
+    }
+  }
+}
+
+// ============================================================================
+// 参数读写
+// ============================================================================
+
+int SyntheticCameraBackend::getFloat(const char *key, FloatValue &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "ExposureTime")) {
+    out = {kExposureMin, kExposureMax, m_exposureUs};
+  } else if (keyIs(key, "Gain")) {
+    out = {0.0f, kGainMax, m_gainDb};
+  } else if (keyIs(key, "AcquisitionFrameRate")) {
+    out = {kFrameRateMin, kFrameRateMax, m_frameRate};
+  } else if (keyIs(key, "ResultingFrameRate")) {
+    const float fps = static_cast<float>(effectiveFps());
+    out = {0.0f, kFrameRateMax, fps};
+  } else {
+    return kErrNotSupported;
+  }
+  return kOk;
+}
+
+int SyntheticCameraBackend::setFloat(const char *key, float value) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "ExposureTime")) {
+    if (value < kExposureMin || value > kExposureMax)
+      return kErrInvalidParam;
+    m_exposureUs = value;
+    m_backgroundDirty = true;
+  } else if (keyIs(key, "Gain")) {
+    if (value < 0.0f || value > kGainMax)
+      return kErrInvalidParam;
+    m_gainDb = value;
+    m_backgroundDirty = true;
+  } else if (keyIs(key, "AcquisitionFrameRate")) {
+    if (value < kFrameRateMin || value > kFrameRateMax)
+      return kErrInvalidParam;
+    m_frameRate = value;
+  } else {
+    return kErrNotSupported;
+  }
+  return kOk;
+}
+
+int SyntheticCameraBackend::getInt(const char *key, IntValue &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "Width")) {
+    out = {kRoiMin, m_config.width - m_offsetX, m_width, kRoiInc};
+  } else if (keyIs(key, "Height")) {
+    out = {kRoiMin, m_config.height - m_offsetY, m_height, kRoiInc};
+  } else if (keyIs(key, "OffsetX")) {
+    out = {0, m_config.width - m_width, m_offsetX, kRoiInc};
+  } else if (keyIs(key, "OffsetY")) {
+    out = {0, m_config.height - m_height, m_offsetY, kRoiInc};
+  } else if (keyIs(key, "WidthMax")) {
+    out = {m_config.width, m_config.width, m_config.width, 1};
+  } else if (keyIs(key, "HeightMax")) {
+    out = {m_config.height, m_config.height, m_config.height, 1};
+  } else if (keyIs(key, "PayloadSize")) {
+    const auto size = static_cast<int64_t>(payloadSize());
+    out = {size, size, size, 1};
+  } else {
+    return kErrNotSupported;
+  }
+  return kOk;
+}
+
+int SyntheticCameraBackend::setInt(const char *key, int64_t value) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  int *target = nullptr;
+  int64_t maxValue = 0;
+  int64_t minValue = 0;
+  if (keyIs(key, "Width")) {
+    target = &m_width;
+    minValue = kRoiMin;
+    maxValue = m_config.width - m_offsetX;
+  } else if (keyIs(key, "Height")) {
+    target = &m_height;
+    minValue = kRoiMin;
+    maxValue = m_config.height - m_offsetY;
+  } else if (keyIs(key, "OffsetX")) {
+    target = &m_offsetX;
+    maxValue = m_config.width - m_width;
+  } else if (keyIs(key, "OffsetY")) {
+    target = &m_offsetY;
+    maxValue = m_config.height - m_height;
+  } else {
+    return kErrNotSupported;
+  }
+  // 与真实相机一样，采集中 ROI 节点不可写
+  if (m_grabbing)
+    return kErrBusy;
+  if (value < minValue || value > maxValue || value % kRoiInc != 0)
+    return kErrInvalidParam;
+  *target = static_cast<int>(value);
+  m_backgroundDirty = true;
+  return kOk;
+}
+
+int SyntheticCameraBackend::getEnum(const char *key, uint32_t &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "PixelFormat")) {
+    out = m_pixelType;
+  } else if (keyIs(key, "TriggerMode")) {
+    out = 0;
+  } else {
+    return kErrNotSupported;
+  }
+  return kOk;
+}
+
+int SyntheticCameraBackend::setEnum(const char *key, uint32_t value) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "PixelFormat")) {
+    if (m_grabbing)
+      return kErrBusy;
+    if (!isSupportedPixelType(value))
+      return kErrInvalidParam;
+    m_pixelType = value;
+    m_backgroundDirty = true;
+    return kOk;
+  }
+  if (keyIs(key, "TriggerMode")) {
+    // 只模拟连续采集
+    return value == 0 ? kOk : kErrNotSupported;
+  }
+  return kErrNotSupported;
+}
+
+int SyntheticCameraBackend::getEnumEntries(const char *key,
+                                           std::vector<uint32_t> &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "PixelFormat")) {
+    out = {kPixelMono8, kPixelBayerRG8, kPixelMono12};
+    return kOk;
+  }
+  if (keyIs(key, "TriggerMode")) {
+    out = {0};
+    return kOk;
+  }
+  return kErrNotSupported;
+}
+
+int SyntheticCameraBackend::setBool(const char *key, bool value) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return kErrNotOpen;
+  if (keyIs(key, "AcquisitionFrameRateEnable")) {
+    m_frameRateEnable = value;
+    return kOk;
+  }
+  return kErrNotSupported;
+}
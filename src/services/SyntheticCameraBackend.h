@@ -0,0 +1,141 @@
+#ifndef SYNTHETICCAMERABACKEND_H
+#define SYNTHETICCAMERABACKEND_H
+
+#include "ICameraBackend.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 合成相机后端：不需要硬件，生成在琼脂背景上蠕动的线虫图像
+ *
+ * 用于在没有海康相机的 Linux 构建机 / CI 上跑通采集、录制链路并做吞吐基准。
+ * 支持 Mono8 / BayerRG8 / Mono12 三种像素格式，分辨率、帧率可配置；
+ * fps = 0 表示不限速（测最大吞吐）。同样的 seed 生成同样的画面序列。
+ * cameras > 1 时枚举出多台设备，每个后端实例打开其中一台
+ * （第 i 台用 seed + i），用于多相机采集的测试 / 基准。
+ *
+ * 参数节点模拟真实相机：Width / Height / OffsetX / OffsetY / PixelFormat
+ * 只能在停止采集时修改，ExposureTime / Gain 影响画面亮度。
+ * 参数读写可以和 grabFrame 在不同线程并发调用。
+ *
+ * devTimestamp 是该帧"曝光"节拍时刻的 steady_clock 纳秒（设备时钟与主机同源），
+ * 基准测试可以直接用 到达时间 − devTimestamp 算绝对延迟。
+ * 回调模式下由后端自己的出帧线程按节拍调用回调，模拟 SDK 取流线程。
+ */
+class SyntheticCameraBackend : public ICameraBackend {
+public:
+  // 与 MvGvspPixelType 取值一致（这里不 include SDK 头文件）
+  static constexpr uint32_t kPixelMono8 = 0x01080001;
+  static constexpr uint32_t kPixelBayerRG8 = 0x01080009;
+  static constexpr uint32_t kPixelMono12 = 0x01100005;
+
+  struct Config {
+    int width = 1280; // 同时作为 WidthMax / HeightMax
+    int height = 1024;
+    uint32_t pixelType = kPixelMono8;
+    double fps = 60.0; // 0 = 不限速
+    int wormCount = 6;
+    uint32_t seed = 1;
+    int cameras = 1; // enumerateDevices 报告的设备数
+  };
+
+  /**
+   * @brief 解析 "width=2448&height=2048&fps=60&format=BayerRG8&worms=8&seed=3&cameras=4"
+   * 未知 key / 非法值忽略并保留默认值
+   */
+  static Config parseOptions(const QString &options);
+
+  SyntheticCameraBackend();
+  explicit SyntheticCameraBackend(const Config &config);
+  ~SyntheticCameraBackend() override;
+
+  QString backendName() const override { return QStringLiteral("synthetic"); }
+
+  QList<DeviceInfo> enumerateDevices() override;
+  int open(int deviceIndex) override;
+  void close() override;
+  bool isOpen() const override { return m_open; }
+
+  int startGrabbing() override;
+  void stopGrabbing() override;
+  GrabResult grabFrame(FramePool &pool, FrameRef &out,
+                       unsigned int timeoutMs) override;
+
+  bool supportsFrameCallback() const override { return true; }
+  int setFrameCallback(FramePool *pool, FrameCallback callback) override;
+
+  int getFloat(const char *key, FloatValue &out) override;
+  int setFloat(const char *key, float value) override;
+  int getInt(const char *key, IntValue &out) override;
+  int setInt(const char *key, int64_t value) override;
+  int getEnum(const char *key, uint32_t &out) override;
+  int setEnum(const char *key, uint32_t value) override;
+  int getEnumEntries(const char *key, std::vector<uint32_t> &out) override;
+  int setBool(const char *key, bool value) override;
+
+  static bool isSupportedPixelType(uint32_t pixelType);
+
+private:
+  struct Worm {
+    double x, y;       // 头部位置（全幅坐标）
+    double heading;    // 前进方向（弧度）
+    double phase;      // 身体正弦波相位
+    double speed;      // 像素 / 帧
+    double turnRate;   // 每帧转向
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  GrabResult produceFrame(FramePool &pool, FrameRef &out,
+                          unsigned int timeoutMs);
+  void callbackLoop();
+
+  void resetScene();
+  void rebuildBackground();
+  void advanceWorms();
+  void renderFrame(unsigned char *dst);
+  void stampDisc(unsigned char *dst, double cx, double cy, double radius,
+                 int level);
+  double effectiveFps() const;
+  std::size_t payloadSize() const;
+  uint32_t nextRandom();
+  double randomUnit() { return (nextRandom() & 0xFFFFFF) / double(0x1000000); }
+
+  Config m_config;
+  bool m_open = false;
+  int m_deviceIndex = 0;
+  std::atomic<bool> m_grabbing{false};
+  // 参数读写（UI 线程）与出图（grab 线程）互斥
+  mutable std::mutex m_mutex;
+
+  // 当前 ROI（相对传感器全幅）
+  int m_width = 0;
+  int m_height = 0;
+  int m_offsetX = 0;
+  int m_offsetY = 0;
+  uint32_t m_pixelType = kPixelMono8;
+
+  float m_exposureUs = 10000.0f;
+  float m_gainDb = 0.0f;
+  float m_frameRate = 60.0f;
+  bool m_frameRateEnable = false;
+
+  std::vector<Worm> m_worms;
+  std::vector<unsigned char> m_background; // 已按当前像素格式 / 亮度编码
+  bool m_backgroundDirty = true;
+  uint32_t m_rng = 1;
+
+  uint32_t m_frameNum = 0;
+  Clock::time_point m_nextFrameTime;
+
+  // 回调模式：只在停止采集时修改
+  FramePool *m_callbackPool = nullptr;
+  FrameCallback m_callback;
+  std::thread m_callbackThread;
+};
+
+#endif // SYNTHETICCAMERABACKEND_H
@@ -0,0 +1,48 @@
+#include "AcquisitionStats.h"
+
+void FrameRateSampler::reset() {
+  m_window.fill({});
+  m_head = 0;
+  m_size = 0;
+  m_lastFrames = 0;
+  m_lastChangeNs = 0;
+  m_fps = 0.0;
+}
+
+double FrameRateSampler::update(const AcquisitionStatsBlock::Snapshot &s,
+                                int64_t nowNs) {
+  // 计数回退：控制器开始了新一轮采集
+  if (s.frames < m_lastFrames)
+    reset();
+  if (m_size == 0 || s.frames != m_lastFrames) {
+    m_lastFrames = s.frames;
+    m_lastChangeNs = nowNs;
+  }
+
+  // 覆盖最旧的样本
+  const std::size_t slot = (m_head + m_size) % kWindowSamples;
+  m_window[slot] = s;
+  if (m_size < kWindowSamples)
+    ++m_size;
+  else
+    m_head = (m_head + 1) % kWindowSamples;
+
+  if (nowNs - m_lastChangeNs > kStallNs) {
+    m_fps = 0.0;
+    return m_fps;
+  }
+
+  // 找窗口内最旧的、确实有帧且比当前少的样本；帧率很低时窗口里可能
+  // 没有新帧，沿用上一次的读数
+  for (std::size_t i = 0; i < m_size; ++i) {
+    const AcquisitionStatsBlock::Snapshot &old =
+        m_window[(m_head + i) % kWindowSamples];
+    if (old.lastGrabNs == 0 || old.frames >= s.frames)
+      continue;
+    const int64_t spanNs = s.lastGrabNs - old.lastGrabNs;
+    if (spanNs > 0)
+      m_fps = double(s.frames - old.frames) * 1e9 / double(spanNs);
+    break;
+  }
+  return m_fps;
+}
@@ -0,0 +1,104 @@
+#ifndef ACQUISITIONSTATS_H
+#define ACQUISITIONSTATS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief grab 线程写、UI 定时读的采集计数块
+ *
+ * 取代逐帧 emit 信号：grab 线程每帧只做几次 relaxed 原子写，
+ * UI 线程按自己的节奏（如 10 Hz）调用 snapshot() 取一致的快照，
+ * UI 开销与相机帧率无关。
+ *
+ * 单写者多读者的 seqlock：写前后各把序号加 1，读者看到奇数或
+ * 前后序号不一致就重读；写者从不等待。
+ */
+class AcquisitionStatsBlock {
+public:
+  struct Snapshot {
+    uint64_t frames = 0;     // 累计帧数
+    int64_t lastGrabNs = 0;  // 最后一帧的 FrameInfo::grabTimeNs（0 表示还没有帧）
+    uint32_t lastFrameNum = 0;
+  };
+
+  // grab 线程调用（单写者）
+  void recordFrame(int64_t grabTimeNs, uint32_t frameNum) {
+    const uint64_t seq = m_seq.load(std::memory_order_relaxed);
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_frames.store(m_frames.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    m_lastGrabNs.store(grabTimeNs, std::memory_order_relaxed);
+    m_lastFrameNum.store(frameNum, std::memory_order_relaxed);
+    m_seq.store(seq + 2, std::memory_order_release);
+  }
+
+  // 开始新的采集前调用（此时不能有写者）
+  void reset() {
+    m_frames.store(0, std::memory_order_relaxed);
+    m_lastGrabNs.store(0, std::memory_order_relaxed);
+    m_lastFrameNum.store(0, std::memory_order_relaxed);
+    m_seq.fetch_add(2, std::memory_order_release);
+  }
+
+  // 任意线程调用
+  Snapshot snapshot() const {
+    Snapshot s;
+    for (;;) {
+      const uint64_t before = m_seq.load(std::memory_order_acquire);
+      if (before & 1)
+        continue;
+      s.frames = m_frames.load(std::memory_order_relaxed);
+      s.lastGrabNs = m_lastGrabNs.load(std::memory_order_relaxed);
+      s.lastFrameNum = m_lastFrameNum.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (m_seq.load(std::memory_order_relaxed) == before)
+        return s;
+    }
+  }
+
+  uint64_t frames() const { return m_frames.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint64_t> m_seq{0};
+  std::atomic<uint64_t> m_frames{0};
+  std::atomic<int64_t> m_lastGrabNs{0};
+  std::atomic<uint32_t> m_lastFrameNum{0};
+};
+
+/**
+ * @brief UI 侧的帧率计算：用采集时间戳而不是 UI 收到通知的时间
+ *
+ * 每次定时器触发时喂一个快照，帧率 = 窗口内新增帧数 / 对应帧的
+ * grabTimeNs 差，事件循环卡顿不会让读数抖动。窗口覆盖最近
+ * kWindowSamples 次采样；超过 kStallNs 没有新帧时帧率归零。
+ */
+class FrameRateSampler {
+public:
+  static constexpr std::size_t kWindowSamples = 10;      // 10 Hz 采样约 1 秒
+  static constexpr int64_t kStallNs = 2'000'000'000;     // 2 s 无新帧视为停止
+
+  void reset();
+
+  /**
+   * @param s     AcquisitionStatsBlock::snapshot()
+   * @param nowNs 采样时刻的 steady_clock 纳秒（只用于判断停顿）
+   * @return 当前帧率（fps），帧数不足时返回 0
+   */
+  double update(const AcquisitionStatsBlock::Snapshot &s, int64_t nowNs);
+
+  double fps() const { return m_fps; }
+
+private:
+  std::array<AcquisitionStatsBlock::Snapshot, kWindowSamples> m_window{};
+  std::size_t m_head = 0;
+  std::size_t m_size = 0;
+  uint64_t m_lastFrames = 0;
+  int64_t m_lastChangeNs = 0;
+  double m_fps = 0.0;
+};
+
+#endif // ACQUISITIONSTATS_H
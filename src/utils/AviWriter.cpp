@@ -0,0 +1,497 @@
+#include "AviWriter.h"
+#include "PixelFormats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t kYuv422Uyvy = 0x0210001F;
+constexpr uint32_t kYuv422Yuyv = 0x02100032;
+
+// RIFF 块大小字段是 32 位，再留一点余量给块尾的索引
+constexpr uint64_t kMaxRiffBytes = 0xFFFF0000ull;
+
+constexpr uint32_t kAvihBytes = 56;
+constexpr uint32_t kStrhBytes = 56;
+constexpr uint32_t kBitmapInfoBytes = 40;
+constexpr uint32_t kPaletteBytes = 256 * 4;
+constexpr uint32_t kDmlhBytes = 248;
+constexpr uint32_t kSuperIndexHeaderBytes = 24;
+constexpr uint32_t kSuperIndexEntryBytes = 16;
+constexpr uint32_t kStdIndexHeaderBytes = 24;
+constexpr uint32_t kStdIndexEntryBytes = 8;
+constexpr uint32_t kIdx1EntryBytes = 16;
+
+constexpr uint32_t kAvifHasIndex = 0x10;
+constexpr uint32_t kAvifTrustCkType = 0x800;
+constexpr uint32_t kAviifKeyframe = 0x10;
+constexpr uint8_t kIndexOfIndexes = 0x00;
+constexpr uint8_t kIndexOfChunks = 0x01;
+
+constexpr uint32_t fourcc(const char (&s)[5]) {
+  return uint32_t(uint8_t(s[0])) | uint32_t(uint8_t(s[1])) << 8 |
+         uint32_t(uint8_t(s[2])) << 16 | uint32_t(uint8_t(s[3])) << 24;
+}
+
+void put8(std::vector<uint8_t> &v, uint8_t x) { v.push_back(x); }
+void put16(std::vector<uint8_t> &v, uint16_t x) {
+  v.push_back(uint8_t(x));
+  v.push_back(uint8_t(x >> 8));
+}
+void put32(std::vector<uint8_t> &v, uint32_t x) {
+  for (int i = 0; i < 4; ++i)
+    v.push_back(uint8_t(x >> (8 * i)));
+}
+void put64(std::vector<uint8_t> &v, uint64_t x) {
+  for (int i = 0; i < 8; ++i)
+    v.push_back(uint8_t(x >> (8 * i)));
+}
+void putFourcc(std::vector<uint8_t> &v, const char (&s)[5]) {
+  put32(v, fourcc(s));
+}
+
+} // namespace
+
+AviWriter::~AviWriter() { close(); }
+
+bool AviWriter::open(const std::string &path, const Format &format,
+                     const RecordFile::Options &file) {
+  Options options;
+  static_cast<Format &>(options) = format;
+  options.file = file;
+  return open(path, options);
+}
+
+std::size_t AviWriter::frameBytes() const {
+  return inputFrameBytes(m_options.pixelType, m_options.width,
+                         m_options.height);
+}
+
+bool AviWriter::supports(uint32_t pixelType) {
+  return pixelType == PixelFormats::kMono8 ||
+         pixelType == PixelFormats::kBgr8 ||
+         pixelType == PixelFormats::kRgb8 || pixelType == kYuv422Uyvy ||
+         pixelType == kYuv422Yuyv;
+}
+
+std::size_t AviWriter::inputFrameBytes(uint32_t pixelType, int width,
+                                       int height) {
+  if (!supports(pixelType) || width <= 0 || height <= 0)
+    return 0;
+  // YUV422 两个像素共用一组 UV，宽度必须是偶数
+  if ((pixelType == kYuv422Uyvy || pixelType == kYuv422Yuyv) && width % 2)
+    return 0;
+  return PixelFormats::frameBytes(pixelType, width, height);
+}
+
+bool AviWriter::open(const std::string &path, const Options &options) {
+  close();
+  m_error.clear();
+  m_failed = false;
+
+  const std::size_t frameBytes =
+      inputFrameBytes(options.pixelType, options.width, options.height);
+  if (frameBytes == 0)
+    return fail("不支持的录制格式或尺寸");
+  if (!(options.fps > 0.0))
+    return fail("帧率必须大于 0");
+  m_options = options;
+  m_options.riffLimitBytes =
+      std::min<uint64_t>(std::max<uint64_t>(options.riffLimitBytes, 1),
+                         kMaxRiffBytes);
+  m_options.framesPerIndex = std::max<uint32_t>(options.framesPerIndex, 1);
+  m_options.superIndexEntries =
+      std::max<uint32_t>(options.superIndexEntries, 1);
+
+  const PixelFormats::Descriptor *d = PixelFormats::find(options.pixelType);
+  m_bitCount = d->bitsPerPixel;
+  m_inputStride = std::size_t(options.width) * m_bitCount / 8;
+  if (d->family == PixelFormats::Family::Yuv) {
+    // FourCC 格式自顶向下、行不补齐
+    m_compression = options.pixelType == kYuv422Uyvy ? fourcc("UYVY")
+                                                     : fourcc("YUY2");
+    m_chunkId = fourcc("00dc");
+    m_bottomUp = false;
+    m_rowBytes = m_inputStride;
+  } else {
+    m_compression = 0; // BI_RGB
+    m_chunkId = fourcc("00db");
+    m_bottomUp = true;
+    m_rowBytes = (m_inputStride + 3) & ~std::size_t(3);
+  }
+  m_swapRb = options.pixelType == PixelFormats::kRgb8;
+  const uint64_t chunkBytes = uint64_t(m_rowBytes) * options.height;
+  if (chunkBytes + 1024 > kMaxRiffBytes)
+    return fail("单帧超过 RIFF 块上限");
+  m_frameChunkBytes = static_cast<uint32_t>(chunkBytes);
+
+  // 缓冲至少放得下一行（另留一页给直接 I/O 带过来的页），行翻转才能直接
+  // 写进缓冲
+  RecordFile::Options file = options.file;
+  file.bufferBytes =
+      std::max(file.bufferBytes, m_rowBytes + RecordFile::kAlignment);
+  if (!m_file.open(path, file))
+    return fileFail();
+  m_riffFrames = 0;
+  m_firstRiffFrames = 0;
+  m_frames = 0;
+  m_riffCount = 0;
+  m_pendingIndex.clear();
+  m_pendingIndex.reserve(m_options.framesPerIndex);
+  m_idx1.clear();
+  m_superIndex.clear();
+
+  if (!writeHeader()) {
+    m_file.close();
+    return false;
+  }
+  return true;
+}
+
+bool AviWriter::writeHeader() {
+  const Options &o = m_options;
+  const bool palette = m_bitCount == 8;
+  const uint32_t strfBytes = kBitmapInfoBytes + (palette ? kPaletteBytes : 0);
+  const uint32_t indxBytes =
+      kSuperIndexHeaderBytes + kSuperIndexEntryBytes * o.superIndexEntries;
+  const uint32_t strlBytes =
+      4 + (8 + kStrhBytes) + (8 + strfBytes) + (8 + indxBytes);
+  const uint32_t odmlBytes = 4 + 8 + kDmlhBytes;
+  const uint32_t hdrlBytes = 4 + (8 + kAvihBytes) + (8 + strlBytes) +
+                             (8 + odmlBytes);
+
+  std::vector<uint8_t> h;
+  h.reserve(12 + 8 + hdrlBytes + 12);
+  putFourcc(h, "RIFF");
+  put32(h, 0); // 结束这个 RIFF 块时回填
+  putFourcc(h, "AVI ");
+  putFourcc(h, "LIST");
+  put32(h, hdrlBytes);
+  putFourcc(h, "hdrl");
+
+  putFourcc(h, "avih");
+  put32(h, kAvihBytes);
+  m_avihPos = h.size();
+  h.resize(h.size() + kAvihBytes); // 内容由 patchHeader 写
+
+  putFourcc(h, "LIST");
+  put32(h, strlBytes);
+  putFourcc(h, "strl");
+  putFourcc(h, "strh");
+  put32(h, kStrhBytes);
+  m_strhPos = h.size();
+  h.resize(h.size() + kStrhBytes);
+
+  putFourcc(h, "strf");
+  put32(h, strfBytes);
+  put32(h, kBitmapInfoBytes);
+  put32(h, static_cast<uint32_t>(o.width));
+  put32(h, static_cast<uint32_t>(o.height)); // 正数：BI_RGB 自底向上
+  put16(h, 1);
+  put16(h, static_cast<uint16_t>(m_bitCount));
+  put32(h, m_compression);
+  put32(h, m_frameChunkBytes);
+  put32(h, 0);
+  put32(h, 0);
+  put32(h, palette ? 256 : 0);
+  put32(h, 0);
+  if (palette) {
+    for (int i = 0; i < 256; ++i) {
+      put8(h, uint8_t(i));
+      put8(h, uint8_t(i));
+      put8(h, uint8_t(i));
+      put8(h, 0);
+    }
+  }
+
+  putFourcc(h, "indx");
+  put32(h, indxBytes);
+  m_indxPos = h.size();
+  h.resize(h.size() + indxBytes);
+
+  putFourcc(h, "LIST");
+  put32(h, odmlBytes);
+  putFourcc(h, "odml");
+  putFourcc(h, "dmlh");
+  put32(h, kDmlhBytes);
+  m_dmlhPos = h.size();
+  h.resize(h.size() + kDmlhBytes);
+
+  m_riffPos = 0;
+  m_moviPos = h.size();
+  putFourcc(h, "LIST");
+  put32(h, 0);
+  putFourcc(h, "movi");
+  m_riffCount = 1;
+
+  // 先按 0 帧写一遍头，录制中途崩溃时文件头也是合法的
+  if (!m_file.append(h.data(), h.size()))
+    return fileFail();
+  return patchHeader();
+}
+
+bool AviWriter::beginRiff() {
+  std::vector<uint8_t> h;
+  putFourcc(h, "RIFF");
+  put32(h, 0);
+  putFourcc(h, "AVIX");
+  putFourcc(h, "LIST");
+  put32(h, 0);
+  putFourcc(h, "movi");
+  m_riffPos = m_file.pos();
+  m_moviPos = m_riffPos + 12;
+  m_riffFrames = 0;
+  ++m_riffCount;
+  return m_file.append(h.data(), h.size()) || fileFail();
+}
+
+bool AviWriter::endRiff() {
+  if (!writeStdIndex())
+    return false;
+  const uint64_t moviBytes = m_file.pos() - m_moviPos - 8;
+  if (m_riffCount == 1) {
+    m_firstRiffFrames = m_riffFrames;
+    if (!writeIdx1())
+      return false;
+  }
+  const uint64_t riffBytes = m_file.pos() - m_riffPos - 8;
+  uint8_t size[4];
+  for (int i = 0; i < 4; ++i)
+    size[i] = uint8_t(moviBytes >> (8 * i));
+  if (!m_file.patch(m_moviPos + 4, size, 4))
+    return fileFail();
+  for (int i = 0; i < 4; ++i)
+    size[i] = uint8_t(riffBytes >> (8 * i));
+  return m_file.patch(m_riffPos + 4, size, 4) || fileFail();
+}
+
+bool AviWriter::writeStdIndex() {
+  const std::size_t n = m_pendingIndex.size();
+  if (n == 0)
+    return true;
+  if (m_superIndex.size() >= m_options.superIndexEntries)
+    return fail("超级索引条目已用完");
+  const uint32_t dataBytes =
+      kStdIndexHeaderBytes + kStdIndexEntryBytes * static_cast<uint32_t>(n);
+  std::vector<uint8_t> ix;
+  ix.reserve(8 + dataBytes);
+  putFourcc(ix, "ix00");
+  put32(ix, dataBytes);
+  put16(ix, 2); // wLongsPerEntry
+  put8(ix, 0);  // bIndexSubType
+  put8(ix, kIndexOfChunks);
+  put32(ix, static_cast<uint32_t>(n));
+  put32(ix, m_chunkId);
+  put64(ix, m_riffPos); // qwBaseOffset
+  put32(ix, 0);
+  for (const IndexEntry &e : m_pendingIndex) {
+    put32(ix, e.offset);
+    put32(ix, e.size); // 最高位 0 = 关键帧
+  }
+  m_superIndex.push_back(
+      {m_file.pos(), 8 + dataBytes, static_cast<uint32_t>(n)});
+  m_pendingIndex.clear();
+  return m_file.append(ix.data(), ix.size()) || fileFail();
+}
+
+bool AviWriter::writeIdx1() {
+  std::vector<uint8_t> idx;
+  idx.reserve(8 + kIdx1EntryBytes * m_idx1.size());
+  putFourcc(idx, "idx1");
+  put32(idx, static_cast<uint32_t>(kIdx1EntryBytes * m_idx1.size()));
+  // idx1 的偏移相对 'movi' 四字符码，指向块头
+  const uint64_t base = m_moviPos + 8;
+  for (const IndexEntry &e : m_idx1) {
+    put32(idx, m_chunkId);
+    put32(idx, kAviifKeyframe);
+    put32(idx, static_cast<uint32_t>(e.offset - 8 - base));
+    put32(idx, e.size);
+  }
+  m_idx1.clear();
+  m_idx1.shrink_to_fit();
+  return m_file.append(idx.data(), idx.size()) || fileFail();
+}
+
+bool AviWriter::patchHeader() {
+  const Options &o = m_options;
+  const uint64_t firstFrames = m_riffCount > 1 ? m_firstRiffFrames : m_frames;
+  const uint32_t scale = 1000;
+  const uint32_t rate =
+      static_cast<uint32_t>(std::max(1.0, std::round(o.fps * scale)));
+  const uint32_t suggested = m_frameChunkBytes + 8;
+
+  std::vector<uint8_t> avih;
+  put32(avih, static_cast<uint32_t>(std::lround(1e6 / o.fps)));
+  put32(avih, static_cast<uint32_t>(
+                  std::min(double(UINT32_MAX), suggested * o.fps)));
+  put32(avih, 0); // dwPaddingGranularity
+  put32(avih, kAvifHasIndex | kAvifTrustCkType);
+  put32(avih, static_cast<uint32_t>(firstFrames));
+  put32(avih, 0); // dwInitialFrames
+  put32(avih, 1); // dwStreams
+  put32(avih, suggested);
+  put32(avih, static_cast<uint32_t>(o.width));
+  put32(avih, static_cast<uint32_t>(o.height));
+  avih.resize(kAvihBytes, 0);
+
+  std::vector<uint8_t> strh;
+  putFourcc(strh, "vids");
+  put32(strh, m_compression); // fccHandler：BI_RGB 为 0
+  put32(strh, 0);             // dwFlags
+  put32(strh, 0);             // wPriority / wLanguage
+  put32(strh, 0);             // dwInitialFrames
+  put32(strh, scale);
+  put32(strh, rate);
+  put32(strh, 0); // dwStart
+  put32(strh, static_cast<uint32_t>(m_frames));
+  put32(strh, suggested);
+  put32(strh, UINT32_MAX); // dwQuality：默认
+  put32(strh, 0);          // dwSampleSize：按块
+  put16(strh, 0);
+  put16(strh, 0);
+  put16(strh, static_cast<uint16_t>(o.width));
+  put16(strh, static_cast<uint16_t>(o.height));
+
+  std::vector<uint8_t> indx;
+  put16(indx, 4); // wLongsPerEntry
+  put8(indx, 0);
+  put8(indx, kIndexOfIndexes);
+  put32(indx, static_cast<uint32_t>(m_superIndex.size()));
+  put32(indx, m_chunkId);
+  put32(indx, 0);
+  put32(indx, 0);
+  put32(indx, 0);
+  for (const SuperIndexEntry &e : m_superIndex) {
+    put64(indx, e.offset);
+    put32(indx, e.size);
+    put32(indx, e.frames);
+  }
+
+  std::vector<uint8_t> dmlh;
+  put32(dmlh, static_cast<uint32_t>(m_frames));
+
+  if (!m_file.patch(m_avihPos, avih.data(), avih.size()) ||
+      !m_file.patch(m_strhPos, strh.data(), strh.size()) ||
+      !m_file.patch(m_indxPos, indx.data(), indx.size()) ||
+      !m_file.patch(m_dmlhPos, dmlh.data(), dmlh.size()))
+    return fileFail();
+  return true;
+}
+
+bool AviWriter::writeFrame(const uint8_t *data, std::size_t bytes,
+                           const FrameMeta &) {
+  if (!m_file.isOpen() || m_failed) {
+    if (!m_file.isOpen())
+      m_error = "文件未打开";
+    return false;
+  }
+  // 尺寸不符只丢这一帧，不影响后面的帧
+  if (bytes != inputFrameBytes(m_options.pixelType, m_options.width,
+                               m_options.height)) {
+    m_error = "帧大小与录制尺寸不符: " + std::to_string(bytes) + " 字节";
+    return false;
+  }
+
+  const uint64_t chunkBytes = 8 + ((uint64_t(m_frameChunkBytes) + 1) & ~1ull);
+  // 这一帧连同块尾的 ix00 / idx1 放不下就先收尾，开新的 AVIX
+  const uint64_t tailBytes =
+      8 + kStdIndexHeaderBytes +
+      kStdIndexEntryBytes * (m_pendingIndex.size() + 1) +
+      (m_riffCount == 1 ? 8 + kIdx1EntryBytes * (m_idx1.size() + 1) : 0);
+  if (m_riffFrames > 0 && m_file.pos() - m_riffPos + chunkBytes + tailBytes >
+                              m_options.riffLimitBytes) {
+    if (!endRiff() || !beginRiff())
+      return false;
+  }
+
+  const uint64_t dataPos = m_file.pos() + 8;
+  uint8_t header[8];
+  for (int i = 0; i < 4; ++i) {
+    header[i] = uint8_t(m_chunkId >> (8 * i));
+    header[4 + i] = uint8_t(m_frameChunkBytes >> (8 * i));
+  }
+  if (!m_file.append(header, sizeof(header)))
+    return fileFail();
+  if (!appendFrameRows(data))
+    return false;
+  if ((m_frameChunkBytes & 1) && !m_file.appendZeros(1))
+    return fileFail();
+
+  const IndexEntry entry{static_cast<uint32_t>(dataPos - m_riffPos),
+                         m_frameChunkBytes};
+  m_pendingIndex.push_back(entry);
+  if (m_riffCount == 1)
+    m_idx1.push_back(entry);
+  ++m_riffFrames;
+  ++m_frames;
+  // 超级索引用过一半后只在 RIFF 块结束时写 ix00，条目留给后面的块
+  if (m_pendingIndex.size() >= m_options.framesPerIndex &&
+      m_superIndex.size() < m_options.superIndexEntries / 2)
+    return writeStdIndex();
+  return true;
+}
+
+bool AviWriter::close() {
+  if (!m_file.isOpen())
+    return true;
+  if (!m_failed) {
+    if (endRiff())
+      patchHeader();
+  }
+  if (!m_file.close() && !m_failed)
+    fileFail();
+  m_pendingIndex.clear();
+  m_idx1.clear();
+  return !m_failed;
+}
+
+AviWriter::Stats AviWriter::stats() const {
+  Stats s;
+  s.frames = m_frames;
+  s.fileBytes = m_file.pos();
+  s.riffChunks = m_riffCount;
+  s.indexChunks = static_cast<uint32_t>(m_superIndex.size());
+  return s;
+}
+
+std::string AviWriter::summary() const {
+  return std::to_string(m_frames) + " 帧, " + std::to_string(m_riffCount) +
+         " 个 RIFF 块, " + std::to_string(m_superIndex.size()) + " 个 ix00";
+}
+
+bool AviWriter::appendFrameRows(const uint8_t *data) {
+  const int h = m_options.height;
+  if (!m_bottomUp && !m_swapRb && m_rowBytes == m_inputStride)
+    return m_file.append(data, m_inputStride * h) || fileFail();
+
+  const std::size_t pad = m_rowBytes - m_inputStride;
+  for (int row = 0; row < h; ++row) {
+    uint8_t *dst = m_file.reserve(m_rowBytes);
+    if (!dst)
+      return fileFail();
+    const uint8_t *src =
+        data + std::size_t(m_bottomUp ? h - 1 - row : row) * m_inputStride;
+    if (m_swapRb) {
+      for (std::size_t x = 0; x < m_inputStride; x += 3) {
+        dst[x] = src[x + 2];
+        dst[x + 1] = src[x + 1];
+        dst[x + 2] = src[x];
+      }
+    } else {
+      std::memcpy(dst, src, m_inputStride);
+    }
+    if (pad)
+      std::memset(dst + m_inputStride, 0, pad);
+    m_file.commit(m_rowBytes);
+  }
+  return true;
+}
+
+bool AviWriter::fail(const std::string &what) {
+  m_failed = true;
+  m_error = what;
+  return false;
+}
+
+bool AviWriter::fileFail() { return fail(m_file.error()); }
@@ -0,0 +1,159 @@
+#ifndef AVIWRITER_H
+#define AVIWRITER_H
+
+#include "IRecordWriter.h"
+#include "RecordFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 未压缩 AVI 写入器，带 OpenDML 扩展（无 Qt/SDK 依赖，可单测）
+ *
+ * 取代 MV_CC_StartRecord / InputOneFrame / StopRecord：SDK 录制器在 StopRecord
+ * 返回后还在异步写索引，只能轮询文件大小；文件受 AVI 1.0 的大小限制；出错只
+ * 有 InputOneFrame 的返回码。这里自己写 RIFF：
+ *
+ *   RIFF 'AVI '  hdrl（avih / strl{strh strf indx} / odml{dmlh}）
+ *                LIST 'movi' { 00db|00dc … ix00 … }  idx1
+ *   RIFF 'AVIX'  LIST 'movi' { 00db|00dc … ix00 … }
+ *   …
+ *
+ * 每个 RIFF 块不超过 riffLimitBytes（默认 1 GB），写满就开下一个 AVIX，文件
+ * 大小不受 4 GB 限制。标准索引 ix00 每 framesPerIndex 帧或一个 RIFF 块结束时
+ * 追加写进 movi，内存里只留未落盘的那一段；超级索引 indx 在文件头预留位置，
+ * close() 时回填。idx1 只覆盖第一个 RIFF 块，给只认 AVI 1.0 的播放器用。
+ *
+ * 像素格式：Mono8（8 位灰度调色板）、BGR8 / RGB8（24 位，RGB8 写入时换成
+ * BGR）按 BI_RGB 自底向上存，帧块为 00db；YUV422（UYVY）/ YUV422_YUYV（YUY2）
+ * 按 FourCC 自顶向下存，帧块为 00dc。输入都是紧排、自顶向下的一帧。
+ *
+ * 线程：非线程安全，由调用方串行调用（录制阶段持 m_recordMutex）。
+ * 出错：各接口返回 false，error() 给出最近一次的原因（I/O 错误附 errno
+ * 文本）。帧大小不符只丢那一帧；写盘失败是致命的，之后的 writeFrame 都
+ * 返回 false。不写逐帧元数据，FrameMeta 忽略。
+ */
+class AviWriter : public IRecordWriter {
+public:
+  // 格式（pixelType 见 supports()）+ 容器参数
+  struct Options : Format {
+    // 单个 RIFF 块的上限；OpenDML 建议 1 GB，超过 4 GB 时按 4 GB 截断
+    uint64_t riffLimitBytes = uint64_t(1) << 30;
+    // 每多少帧追加一个标准索引块 ix00
+    uint32_t framesPerIndex = 1024;
+    // 文件头里为超级索引预留的条目数，每个 ix00 占一条
+    uint32_t superIndexEntries = 8192;
+    // 写盘缓冲 / 直接 I/O / 预分配；行翻转、补齐都直接写进缓冲
+    RecordFile::Options file;
+  };
+
+  struct Stats {
+    uint64_t frames = 0;
+    uint64_t fileBytes = 0; // 已写出（含缓冲中）的字节数
+    uint32_t riffChunks = 0;
+    uint32_t indexChunks = 0;
+  };
+
+  AviWriter() = default;
+  ~AviWriter() override;
+  AviWriter(const AviWriter &) = delete;
+  AviWriter &operator=(const AviWriter &) = delete;
+
+  // 能直接写的像素格式
+  static bool supports(uint32_t pixelType);
+  // 输入一帧的字节数（紧排）；不支持的格式返回 0
+  static std::size_t inputFrameBytes(uint32_t pixelType, int width, int height);
+
+  /**
+   * @brief 创建文件并写好文件头（已有文件会被覆盖）
+   * @param path UTF-8 路径（Windows 下按宽字符打开）
+   */
+  bool open(const std::string &path, const Options &options);
+  // 容器参数取默认值
+  bool open(const std::string &path, const Format &format,
+            const RecordFile::Options &file) override;
+
+  const char *containerName() const override { return "AVI"; }
+  std::size_t frameBytes() const override;
+
+  /**
+   * @brief 追加一帧；bytes 必须等于 inputFrameBytes()
+   */
+  bool writeFrame(const uint8_t *data, std::size_t bytes,
+                  const FrameMeta &meta = FrameMeta()) override;
+
+  /**
+   * @brief 写完剩余索引、回填各处头部并关闭文件
+   * 同步完成：返回时文件已完整，可以直接读大小 / 入库。未打开时返回 true
+   */
+  bool close() override;
+
+  bool isOpen() const override { return m_file.isOpen(); }
+  const std::string &error() const override { return m_error; }
+  uint64_t frameCount() const override { return m_frames; }
+  uint64_t fileBytes() const override { return m_file.pos(); }
+  std::string summary() const override;
+  RecordFile::Stats fileStats() const override { return m_file.stats(); }
+  Stats stats() const;
+
+private:
+  struct IndexEntry {
+    uint32_t offset; // 相对本 RIFF 块起点，指向帧数据（跳过 8 字节块头）
+    uint32_t size;
+  };
+  struct SuperIndexEntry {
+    uint64_t offset; // ix00 块的绝对位置
+    uint32_t size;   // ix00 块大小（含块头）
+    uint32_t frames;
+  };
+
+  bool writeHeader();
+  bool beginRiff();
+  bool endRiff();
+  bool writeStdIndex();
+  bool writeIdx1();
+  bool patchHeader();
+
+  // 行翻转 / 补齐直接写进 m_file 的缓冲
+  bool appendFrameRows(const uint8_t *data);
+  // 致命错误：记下原因，之后的写入都返回 false
+  bool fail(const std::string &what);
+  // 同上，原因取 m_file 的 I/O 错误
+  bool fileFail();
+
+  RecordFile m_file;
+  Options m_options;
+  std::string m_error;
+  bool m_failed = false;
+
+  // 由像素格式决定的布局
+  int m_bitCount = 0;
+  uint32_t m_compression = 0;
+  uint32_t m_chunkId = 0; // 帧块 / 索引的块 id：BI_RGB 00db，FourCC 00dc
+  bool m_bottomUp = true;
+  bool m_swapRb = false;
+  std::size_t m_inputStride = 0;
+  std::size_t m_rowBytes = 0; // 文件里一行的字节数（BI_RGB 补齐到 4 字节）
+  uint32_t m_frameChunkBytes = 0; // 帧数据字节数（不含块头 / 奇数补齐）
+
+  // 文件头里需要回填的位置
+  uint64_t m_avihPos = 0;
+  uint64_t m_strhPos = 0;
+  uint64_t m_indxPos = 0;
+  uint64_t m_dmlhPos = 0;
+
+  // 当前 RIFF 块
+  uint64_t m_riffPos = 0;
+  uint64_t m_moviPos = 0; // LIST 'movi' 块头位置
+  uint64_t m_riffFrames = 0;
+  uint64_t m_firstRiffFrames = 0;
+  std::vector<IndexEntry> m_pendingIndex; // 还没写进 ix00 的帧
+  std::vector<IndexEntry> m_idx1;         // 第一个 RIFF 块的全部帧
+
+  std::vector<SuperIndexEntry> m_superIndex;
+  uint64_t m_frames = 0;
+  uint32_t m_riffCount = 0;
+};
+
+#endif // AVIWRITER_H
@@ -0,0 +1,413 @@
+#include "BayerDemosaic.h"
+#include "PixelFormats.h"
+#include <cstddef>
+
+#if defined(WV_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(WV_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace BayerDemosaic {
+
+namespace {
+
+enum class Output { Bgr, Mono, Green };
+
+// 一行的上下文：上下行已按镜像取好
+struct Row {
+  const uint8_t *up;
+  const uint8_t *cur;
+  const uint8_t *down;
+  int width;
+  bool aIsRed; // 本行非 G 的颜色是 R（否则是 B）
+  int aParity; // 非 G 颜色所在列的奇偶
+};
+
+Row makeRow(const uint8_t *src, int width, int height, int stride,
+            Pattern pattern, int y) {
+  // R 在 2x2 单元里的位置
+  const int rx = (pattern == Pattern::GR || pattern == Pattern::BG) ? 1 : 0;
+  const int ry = (pattern == Pattern::GB || pattern == Pattern::BG) ? 1 : 0;
+  const int yUp = y == 0 ? 1 : y - 1;
+  const int yDown = y == height - 1 ? height - 2 : y + 1;
+  Row row;
+  row.up = src + static_cast<std::ptrdiff_t>(yUp) * stride;
+  row.cur = src + static_cast<std::ptrdiff_t>(y) * stride;
+  row.down = src + static_cast<std::ptrdiff_t>(yDown) * stride;
+  row.width = width;
+  row.aIsRed = (y & 1) == ry;
+  row.aParity = row.aIsRed ? rx : rx ^ 1;
+  return row;
+}
+
+inline int reflect(int i, int n) {
+  return i < 0 ? -i : (i >= n ? 2 * n - 2 - i : i);
+}
+
+inline uint8_t avg2(int a, int b) { return uint8_t((a + b + 1) >> 1); }
+
+inline uint8_t avg4(int a, int b, int c, int d) {
+  return uint8_t((a + b + c + d + 2) >> 2);
+}
+
+inline uint8_t luma(int r, int g, int b) {
+  return uint8_t((77 * r + 150 * g + 29 * b + 128) >> 8);
+}
+
+template <Output out>
+void rowScalar(const Row &row, int x0, int x1, uint8_t *dst) {
+  for (int x = x0; x < x1; ++x) {
+    const int xl = reflect(x - 1, row.width);
+    const int xr = reflect(x + 1, row.width);
+    const int c = row.cur[x];
+    const bool aSite = (x & 1) == row.aParity;
+    const uint8_t g =
+        aSite ? avg4(row.cur[xl], row.cur[xr], row.up[x], row.down[x])
+              : uint8_t(c);
+    if (out == Output::Green) {
+      dst[x] = g;
+      continue;
+    }
+    const uint8_t a = aSite ? uint8_t(c) : avg2(row.cur[xl], row.cur[xr]);
+    const uint8_t o = aSite ? avg4(row.up[xl], row.up[xr], row.down[xl],
+                                   row.down[xr])
+                            : avg2(row.up[x], row.down[x]);
+    const uint8_t r = row.aIsRed ? a : o;
+    const uint8_t b = row.aIsRed ? o : a;
+    if (out == Output::Bgr) {
+      dst[3 * x] = b;
+      dst[3 * x + 1] = g;
+      dst[3 * x + 2] = r;
+    } else {
+      dst[x] = luma(r, g, b);
+    }
+  }
+}
+
+#if defined(WV_SIMD_SSE2)
+
+inline __m128i selectSse2(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i avg4Sse2(__m128i a, __m128i b, __m128i c, __m128i d) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16(2);
+  __m128i lo = _mm_add_epi16(
+      _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+      _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+  __m128i hi = _mm_add_epi16(
+      _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+      _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+  lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+  hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+  return _mm_packus_epi16(lo, hi);
+}
+
+// 16 位通道上算亮度：加权和最大 256 × 255，无符号 16 位放得下
+inline __m128i lumaHalfSse2(__m128i r, __m128i g, __m128i b) {
+  __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(77)),
+                            _mm_mullo_epi16(g, _mm_set1_epi16(150)));
+  y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(29)));
+  return _mm_srli_epi16(_mm_add_epi16(y, _mm_set1_epi16(128)), 8);
+}
+
+inline __m128i lumaSse2(__m128i r, __m128i g, __m128i b) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lo =
+      lumaHalfSse2(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero),
+                   _mm_unpacklo_epi8(b, zero));
+  const __m128i hi =
+      lumaHalfSse2(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero),
+                   _mm_unpackhi_epi8(b, zero));
+  return _mm_packus_epi16(lo, hi);
+}
+
+// 4 个 BGR0 像素压成 12 字节：每个 64 位里拼出 6 字节，分两次 8 字节写，
+// 后一次覆盖前一次多写的 2 字节
+inline void store4BgrSse2(__m128i bgr0, uint8_t *dst) {
+  const __m128i low24 = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF);
+  const __m128i mid24 = _mm_set_epi32(0x0000FFFF, int(0xFF000000u),
+                                      0x0000FFFF, int(0xFF000000u));
+  const __m128i packed =
+      _mm_or_si128(_mm_and_si128(bgr0, low24),
+                   _mm_and_si128(_mm_srli_epi64(bgr0, 8), mid24));
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), packed);
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + 6),
+                   _mm_srli_si128(packed, 8));
+}
+
+// 16 个像素交织成 48 字节 BGR；会多写下一个像素的前 2 字节
+inline void storeBgrSse2(__m128i b, __m128i g, __m128i r, uint8_t *dst) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bgLo = _mm_unpacklo_epi8(b, g);
+  const __m128i bgHi = _mm_unpackhi_epi8(b, g);
+  const __m128i r0Lo = _mm_unpacklo_epi8(r, zero);
+  const __m128i r0Hi = _mm_unpackhi_epi8(r, zero);
+  store4BgrSse2(_mm_unpacklo_epi16(bgLo, r0Lo), dst);
+  store4BgrSse2(_mm_unpackhi_epi16(bgLo, r0Lo), dst + 12);
+  store4BgrSse2(_mm_unpacklo_epi16(bgHi, r0Hi), dst + 24);
+  store4BgrSse2(_mm_unpackhi_epi16(bgHi, r0Hi), dst + 36);
+}
+
+inline __m128i loadSse2(const uint8_t *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+// 从偶数列 x 开始每次 16 像素，返回处理到的列（之后交给标量）
+template <Output out> int rowSse2(const Row &row, int x, uint8_t *dst) {
+  // 偶数列起步：lane 奇偶等于列奇偶
+  const __m128i aMask =
+      _mm_set1_epi16(row.aParity == 0 ? 0x00FF : short(0xFF00));
+  for (; x + 16 + 1 <= row.width; x += 16) {
+    const __m128i c = loadSse2(row.cur + x);
+    const __m128i l = loadSse2(row.cur + x - 1);
+    const __m128i r = loadSse2(row.cur + x + 1);
+    const __m128i u = loadSse2(row.up + x);
+    const __m128i d = loadSse2(row.down + x);
+    const __m128i cross = avg4Sse2(l, r, u, d);
+    if (out == Output::Green) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x),
+                       selectSse2(aMask, cross, c));
+      continue;
+    }
+    const __m128i diag =
+        avg4Sse2(loadSse2(row.up + x - 1), loadSse2(row.up + x + 1),
+                 loadSse2(row.down + x - 1), loadSse2(row.down + x + 1));
+    const __m128i a = selectSse2(aMask, c, _mm_avg_epu8(l, r));
+    const __m128i g = selectSse2(aMask, cross, c);
+    const __m128i o = selectSse2(aMask, diag, _mm_avg_epu8(u, d));
+    const __m128i red = row.aIsRed ? a : o;
+    const __m128i blue = row.aIsRed ? o : a;
+    if (out == Output::Bgr)
+      storeBgrSse2(blue, g, red, dst + 3 * x);
+    else
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x),
+                       lumaSse2(red, g, blue));
+  }
+  return x;
+}
+
+#endif // WV_SIMD_SSE2
+
+#if defined(WV_SIMD_AVX2)
+
+WV_TARGET_AVX2 inline __m256i selectAvx2(__m256i mask, __m256i a, __m256i b) {
+  return _mm256_or_si256(_mm256_and_si256(mask, a),
+                         _mm256_andnot_si256(mask, b));
+}
+
+// unpack / packus 都在 128 位 lane 内，先拆后合像素顺序不变
+WV_TARGET_AVX2 inline __m256i avg4Avx2(__m256i a, __m256i b, __m256i c,
+                                       __m256i d) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i two = _mm256_set1_epi16(2);
+  __m256i lo = _mm256_add_epi16(
+      _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero),
+                       _mm256_unpacklo_epi8(b, zero)),
+      _mm256_add_epi16(_mm256_unpacklo_epi8(c, zero),
+                       _mm256_unpacklo_epi8(d, zero)));
+  __m256i hi = _mm256_add_epi16(
+      _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero),
+                       _mm256_unpackhi_epi8(b, zero)),
+      _mm256_add_epi16(_mm256_unpackhi_epi8(c, zero),
+                       _mm256_unpackhi_epi8(d, zero)));
+  lo = _mm256_srli_epi16(_mm256_add_epi16(lo, two), 2);
+  hi = _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2);
+  return _mm256_packus_epi16(lo, hi);
+}
+
+WV_TARGET_AVX2 inline __m256i lumaHalfAvx2(__m256i r, __m256i g, __m256i b) {
+  __m256i y = _mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(77)),
+                               _mm256_mullo_epi16(g, _mm256_set1_epi16(150)));
+  y = _mm256_add_epi16(y, _mm256_mullo_epi16(b, _mm256_set1_epi16(29)));
+  return _mm256_srli_epi16(_mm256_add_epi16(y, _mm256_set1_epi16(128)), 8);
+}
+
+WV_TARGET_AVX2 inline __m256i lumaAvx2(__m256i r, __m256i g, __m256i b) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i lo = lumaHalfAvx2(_mm256_unpacklo_epi8(r, zero),
+                                  _mm256_unpacklo_epi8(g, zero),
+                                  _mm256_unpacklo_epi8(b, zero));
+  const __m256i hi = lumaHalfAvx2(_mm256_unpackhi_epi8(r, zero),
+                                  _mm256_unpackhi_epi8(g, zero),
+                                  _mm256_unpackhi_epi8(b, zero));
+  return _mm256_packus_epi16(lo, hi);
+}
+
+WV_TARGET_AVX2 inline __m256i loadAvx2(const uint8_t *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+// 同 rowSse2，每次 32 像素；BGR 交织拆成两个 128 位 lane 复用 SSE2 的写法
+template <Output out>
+WV_TARGET_AVX2 int rowAvx2(const Row &row, int x, uint8_t *dst) {
+  const __m256i aMask =
+      _mm256_set1_epi16(row.aParity == 0 ? 0x00FF : short(0xFF00));
+  for (; x + 32 + 1 <= row.width; x += 32) {
+    const __m256i c = loadAvx2(row.cur + x);
+    const __m256i l = loadAvx2(row.cur + x - 1);
+    const __m256i r = loadAvx2(row.cur + x + 1);
+    const __m256i u = loadAvx2(row.up + x);
+    const __m256i d = loadAvx2(row.down + x);
+    const __m256i cross = avg4Avx2(l, r, u, d);
+    if (out == Output::Green) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x),
+                          selectAvx2(aMask, cross, c));
+      continue;
+    }
+    const __m256i diag =
+        avg4Avx2(loadAvx2(row.up + x - 1), loadAvx2(row.up + x + 1),
+                 loadAvx2(row.down + x - 1), loadAvx2(row.down + x + 1));
+    const __m256i a = selectAvx2(aMask, c, _mm256_avg_epu8(l, r));
+    const __m256i g = selectAvx2(aMask, cross, c);
+    const __m256i o = selectAvx2(aMask, diag, _mm256_avg_epu8(u, d));
+    const __m256i red = row.aIsRed ? a : o;
+    const __m256i blue = row.aIsRed ? o : a;
+    if (out == Output::Bgr) {
+      storeBgrSse2(_mm256_castsi256_si128(blue), _mm256_castsi256_si128(g),
+                   _mm256_castsi256_si128(red), dst + 3 * x);
+      storeBgrSse2(_mm256_extracti128_si256(blue, 1),
+                   _mm256_extracti128_si256(g, 1),
+                   _mm256_extracti128_si256(red, 1), dst + 3 * (x + 16));
+    } else {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x),
+                          lumaAvx2(red, g, blue));
+    }
+  }
+  return x;
+}
+
+#endif // WV_SIMD_AVX2
+
+template <Output out>
+bool convert(const uint8_t *src, int width, int height, int srcStride,
+             Pattern pattern, uint8_t *dst, int dstStride, int y0, int y1,
+             Isa isa) {
+  if (!src || !dst || width < 2 || height < 2 || y0 < 0 || y1 > height ||
+      y0 > y1)
+    return false;
+  isa = CpuFeatures::resolve(isa);
+  for (int y = y0; y < y1; ++y) {
+    const Row row = makeRow(src, width, height, srcStride, pattern, y);
+    uint8_t *d = dst + static_cast<std::ptrdiff_t>(y) * dstStride;
+    // 第 0 / 1 列的左邻要镜像，交给标量；向量从偶数列开始
+    rowScalar<out>(row, 0, 2, d);
+    int x = 2;
+#if defined(WV_SIMD_AVX2)
+    if (isa == Isa::Avx2)
+      x = rowAvx2<out>(row, x, d);
+#endif
+#if defined(WV_SIMD_SSE2)
+    if (isa != Isa::Scalar)
+      x = rowSse2<out>(row, x, d);
+#endif
+    rowScalar<out>(row, x, width, d);
+  }
+  return true;
+}
+
+} // namespace
+
+bool patternFor(uint32_t pixelType, Pattern *pattern) {
+  const PixelFormats::Descriptor *d = PixelFormats::find(pixelType);
+  if (!d || d->family != PixelFormats::Family::Bayer || d->sampleBits != 8)
+    return false;
+  switch (d->bayer) {
+  case PixelFormats::BayerOrder::RG:
+    *pattern = Pattern::RG;
+    return true;
+  case PixelFormats::BayerOrder::GR:
+    *pattern = Pattern::GR;
+    return true;
+  case PixelFormats::BayerOrder::GB:
+    *pattern = Pattern::GB;
+    return true;
+  case PixelFormats::BayerOrder::BG:
+    *pattern = Pattern::BG;
+    return true;
+  case PixelFormats::BayerOrder::None:
+    break;
+  }
+  return false;
+}
+
+bool toBgr8(const uint8_t *src, int width, int height, int srcStride,
+            Pattern pattern, uint8_t *dst, int dstStride, Isa isa) {
+  return convert<Output::Bgr>(src, width, height, srcStride, pattern, dst,
+                              dstStride, 0, height, isa);
+}
+
+bool toBgr8(const uint8_t *src, int width, int height, int srcStride,
+            Pattern pattern, uint8_t *dst, int dstStride) {
+  return toBgr8(src, width, height, srcStride, pattern, dst, dstStride,
+                CpuFeatures::best());
+}
+
+bool toBgr8Rows(const uint8_t *src, int width, int height, int srcStride,
+                Pattern pattern, uint8_t *dst, int dstStride, int y0, int y1) {
+  return convert<Output::Bgr>(src, width, height, srcStride, pattern, dst,
+                              dstStride, y0, y1, CpuFeatures::best());
+}
+
+bool toMono8(const uint8_t *src, int width, int height, int srcStride,
+             Pattern pattern, uint8_t *dst, int dstStride, Isa isa) {
+  return convert<Output::Mono>(src, width, height, srcStride, pattern, dst,
+                               dstStride, 0, height, isa);
+}
+
+bool toMono8(const uint8_t *src, int width, int height, int srcStride,
+             Pattern pattern, uint8_t *dst, int dstStride) {
+  return toMono8(src, width, height, srcStride, pattern, dst, dstStride,
+                 CpuFeatures::best());
+}
+
+bool toMono8Rows(const uint8_t *src, int width, int height, int srcStride,
+                 Pattern pattern, uint8_t *dst, int dstStride, int y0,
+                 int y1) {
+  return convert<Output::Mono>(src, width, height, srcStride, pattern, dst,
+                               dstStride, y0, y1, CpuFeatures::best());
+}
+
+bool toGreen8(const uint8_t *src, int width, int height, int srcStride,
+              Pattern pattern, uint8_t *dst, int dstStride, Isa isa) {
+  return convert<Output::Green>(src, width, height, srcStride, pattern, dst,
+                                dstStride, 0, height, isa);
+}
+
+bool toGreen8(const uint8_t *src, int width, int height, int srcStride,
+              Pattern pattern, uint8_t *dst, int dstStride) {
+  return toGreen8(src, width, height, srcStride, pattern, dst, dstStride,
+                  CpuFeatures::best());
+}
+
+bool toGreen8Rows(const uint8_t *src, int width, int height, int srcStride,
+                  Pattern pattern, uint8_t *dst, int dstStride, int y0,
+                  int y1) {
+  return convert<Output::Green>(src, width, height, srcStride, pattern, dst,
+                                dstStride, y0, y1, CpuFeatures::best());
+}
+
+bool toMono8Rows(const uint8_t *src, int width, int height, int srcStride,
+                 Pattern pattern, uint8_t *dst, int dstStride, MonoMethod method,
+                 int y0, int y1) {
+  return method == MonoMethod::Green
+             ? toGreen8Rows(src, width, height, srcStride, pattern, dst,
+                            dstStride, y0, y1)
+             : toMono8Rows(src, width, height, srcStride, pattern, dst,
+                           dstStride, y0, y1);
+}
+
+const char *monoMethodName(MonoMethod method) {
+  switch (method) {
+  case MonoMethod::Luma:
+    return "加权亮度";
+  case MonoMethod::Green:
+    return "绿通道";
+  }
+  return "";
+}
+
+} // namespace BayerDemosaic
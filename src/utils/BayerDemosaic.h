@@ -0,0 +1,86 @@
+#ifndef BAYERDEMOSAIC_H
+#define BAYERDEMOSAIC_H
+
+#include "CpuFeatures.h"
+#include <cstdint>
+
+/**
+ * @brief 8 位 Bayer → BGR8 / Mono8 双线性插值（无 Qt/SDK 依赖，可单测）
+ *
+ * 录制时 Bayer 相机每帧都要转换，原来走 MV_CC_ConvertPixelTypeEx，
+ * 是 Bayer 相机录制掉帧的主要原因。这里自己实现同一种双线性插值：
+ *
+ * - R / B 位置：G 取上下左右四邻平均，另一色取四个对角平均
+ * - G 位置：与本行同色取左右平均，另一色取上下平均
+ * - 边界按镜像（-1 → 1，n → n-2）取邻居，保持 Bayer 排列的奇偶
+ * - Mono8 = (77 R + 150 G + 29 B + 128) >> 8（BT.601 亮度），
+ *   R / G / B 先按上面的规则取整
+ *
+ * 只要亮度时还可以只取 G：G 位置取原值，R / B 位置取上下左右四邻平均，
+ * 省掉对角插值和加权求和（G 像素占一半，明场下足够当亮度用）。
+ *
+ * 标量实现是基准；SSE2（16 像素一组）/ AVX2（32 像素一组）按相同的取整规则，
+ * 输出与标量逐字节一致。默认按 CPU 运行时选最快的实现。
+ *
+ * 线程：无共享状态。toBgr8Rows / toMono8Rows 只写 [y0, y1) 行，
+ * 上下各一行 halo 直接从完整的 src 读，可按水平条带分给多个线程（见 TilePool）。
+ */
+namespace BayerDemosaic {
+
+// 第一行前两个像素的颜色：RG = R 在 (0,0)，B 在 (1,1)
+enum class Pattern { RG, GR, GB, BG };
+
+using Isa = CpuFeatures::Isa;
+
+// Bayer → Mono8 的取法：加权亮度（toMono8）或只取绿通道（toGreen8）
+enum class MonoMethod { Luma, Green };
+
+// 8 位 Bayer 像素类型 → 排列；10/12 位及非 Bayer 返回 false
+bool patternFor(uint32_t pixelType, Pattern *pattern);
+
+/**
+ * @brief 转 BGR8（每像素 3 字节）
+ * @param srcStride / dstStride 每行字节数
+ * @param isa 指定实现；CPU 不支持时退到支持的最快实现
+ * @return 宽或高小于 2 时返回 false
+ */
+bool toBgr8(const uint8_t *src, int width, int height, int srcStride,
+            Pattern pattern, uint8_t *dst, int dstStride, Isa isa);
+bool toBgr8(const uint8_t *src, int width, int height, int srcStride,
+            Pattern pattern, uint8_t *dst, int dstStride);
+
+/**
+ * @brief 只转 [y0, y1) 行：src / dst 都是整帧的起始地址，第 y 行写到
+ * dst + y * dstStride；边界镜像仍按整帧的 height 处理，与整帧转换逐字节一致
+ */
+bool toBgr8Rows(const uint8_t *src, int width, int height, int srcStride,
+                Pattern pattern, uint8_t *dst, int dstStride, int y0, int y1);
+
+// 转 Mono8（每像素 1 字节），参数同 toBgr8
+bool toMono8(const uint8_t *src, int width, int height, int srcStride,
+             Pattern pattern, uint8_t *dst, int dstStride, Isa isa);
+bool toMono8(const uint8_t *src, int width, int height, int srcStride,
+             Pattern pattern, uint8_t *dst, int dstStride);
+bool toMono8Rows(const uint8_t *src, int width, int height, int srcStride,
+                 Pattern pattern, uint8_t *dst, int dstStride, int y0, int y1);
+
+// 转 Mono8，只取插值后的 G（同一规则下 toBgr8 的 G 通道），参数同 toBgr8
+bool toGreen8(const uint8_t *src, int width, int height, int srcStride,
+              Pattern pattern, uint8_t *dst, int dstStride, Isa isa);
+bool toGreen8(const uint8_t *src, int width, int height, int srcStride,
+              Pattern pattern, uint8_t *dst, int dstStride);
+bool toGreen8Rows(const uint8_t *src, int width, int height, int srcStride,
+                  Pattern pattern, uint8_t *dst, int dstStride, int y0,
+                  int y1);
+
+// 按 method 分派到 toMono8Rows / toGreen8Rows
+bool toMono8Rows(const uint8_t *src, int width, int height, int srcStride,
+                 Pattern pattern, uint8_t *dst, int dstStride, MonoMethod method,
+                 int y0, int y1);
+
+// 日志 / UI 用："加权亮度" / "绿通道"
+const char *monoMethodName(MonoMethod method);
+
+} // namespace BayerDemosaic
+
+#endif // BAYERDEMOSAIC_H
@@ -0,0 +1,39 @@
+#include "BufferSizing.h"
+#include <algorithm>
+#include <cmath>
+
+namespace BufferSizingPolicy {
+
+BufferSizing compute(const BufferSizingInput &input) {
+  const double fps = input.fps > 0.0 ? input.fps : kFallbackFps;
+  const std::size_t maxQueue = std::max<std::size_t>(1, input.maxQueueFrames);
+
+  // 停顿期间到达的帧 × 余量，再加上消费者手里正在处理的 1 帧
+  const double stallFrames = double(input.stallUs) / 1e6 * fps * kHeadroom;
+  std::size_t queue = static_cast<std::size_t>(std::ceil(stallFrames)) + 1;
+  queue = std::min(std::max(queue, kMinRecordQueue), maxQueue);
+
+  std::size_t nodes = static_cast<std::size_t>(std::ceil(fps * kSdkNodeSeconds));
+  nodes = std::clamp(nodes, kMinSdkNodes, kMaxSdkNodes);
+
+  BufferSizing sizing;
+  if (input.frameBytes > 0 && input.memoryBudgetBytes > 0) {
+    const std::size_t budgetFrames = input.memoryBudgetBytes / input.frameBytes;
+    if (nodes + input.fixedBuffers + queue > budgetFrames) {
+      sizing.budgetLimited = true;
+      nodes = kMinSdkNodes;
+      const std::size_t reserved = nodes + input.fixedBuffers;
+      // 预算连最小配置都放不下时仍保留 1 帧录制队列，能采集但扛不住停顿
+      queue = budgetFrames > reserved ? std::min(queue, budgetFrames - reserved)
+                                      : 1;
+    }
+  }
+
+  sizing.sdkNodes = nodes;
+  sizing.recordQueueLimit = queue;
+  sizing.poolBuffers = input.fixedBuffers + queue;
+  sizing.absorbableStallMs = double(queue) / fps * 1000.0;
+  return sizing;
+}
+
+} // namespace BufferSizingPolicy
@@ -0,0 +1,48 @@
+#ifndef BUFFERSIZING_H
+#define BUFFERSIZING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 按内存预算和观测到的消费者停顿计算缓冲配置（纯函数，可单测）
+ *
+ * 录制阶段卡住（磁盘 / 编码器停顿）期间新帧只能排在录制队列里，
+ * 每一帧都占一块帧缓冲池的缓冲；要吸收 S 秒的停顿，录制队列至少要
+ * S × fps 帧。SDK 缓存节点只负责吸收 grab 线程自己的调度抖动
+ * （帧一到就拷进池缓冲），按约 100 ms 的帧数给。
+ *
+ * 预算不够时先把 SDK 节点降到最少，再截短录制队列，
+ * absorbableStallMs 给出当前分辨率 / 帧率下真正能吸收的最长停顿。
+ */
+struct BufferSizingInput {
+  std::size_t frameBytes = 0;        // 一帧的字节数
+  double fps = 0.0;                  // 当前帧率，<= 0 时按 kFallbackFps
+  std::size_t memoryBudgetBytes = 0; // SDK 节点 + 帧缓冲池的总内存预算
+  uint64_t stallUs = 0;              // 需要吸收的消费者停顿
+  std::size_t fixedBuffers = 0;      // 显示 / 抓拍 / 在途帧固定占用的池缓冲
+  std::size_t maxQueueFrames = 0;    // 录制队列的物理容量
+};
+
+struct BufferSizing {
+  std::size_t sdkNodes = 0;         // MV_CC_SetImageNodeNum
+  std::size_t poolBuffers = 0;      // 帧缓冲池块数 = fixedBuffers + recordQueueLimit
+  std::size_t recordQueueLimit = 0; // 录制队列上限
+  double absorbableStallMs = 0.0;   // 录制队列能吸收的最长停顿
+  bool budgetLimited = false;       // 受内存预算限制，达不到 stallUs
+};
+
+namespace BufferSizingPolicy {
+
+constexpr double kFallbackFps = 30.0;
+constexpr double kHeadroom = 1.5;        // 停顿估计的余量
+constexpr std::size_t kMinRecordQueue = 8;
+constexpr std::size_t kMinSdkNodes = 3;
+constexpr std::size_t kMaxSdkNodes = 32;
+constexpr double kSdkNodeSeconds = 0.1;  // SDK 节点覆盖的 grab 线程抖动
+
+BufferSizing compute(const BufferSizingInput &input);
+
+} // namespace BufferSizingPolicy
+
+#endif // BUFFERSIZING_H
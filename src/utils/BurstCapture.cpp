@@ -0,0 +1,88 @@
+#include "BurstCapture.h"
+#include <algorithm>
+#include <cstring>
+
+std::size_t BurstCapture::slotsFor(std::size_t frameCount,
+                                   std::size_t memoryBudgetBytes,
+                                   std::size_t frameBytes) {
+  if (frameBytes == 0)
+    return 0;
+  std::size_t slotCount = frameCount;
+  if (memoryBudgetBytes > 0) {
+    const std::size_t budgetSlots = memoryBudgetBytes / frameBytes;
+    slotCount = slotCount > 0 ? std::min(slotCount, budgetSlots) : budgetSlots;
+  }
+  return slotCount;
+}
+
+bool BurstCapture::configure(std::size_t slotCount, std::size_t slotBytes) {
+  clear();
+  if (!m_pool.configure(slotCount, slotBytes))
+    return false;
+  // 缺页中断发生在这里，而不是连拍的 memcpy 里
+  m_pool.prefault();
+  std::vector<FrameRef> frames;
+  frames.reserve(slotCount);
+  m_frames.swap(frames);
+  return true;
+}
+
+void BurstCapture::release() {
+  clear();
+  m_frames.shrink_to_fit();
+  m_pool.release();
+}
+
+void BurstCapture::clear() {
+  m_frames.clear();
+  m_count.store(0, std::memory_order_release);
+  m_dropped = 0;
+  m_firstGrabNs = 0;
+  m_lastGrabNs = 0;
+  m_lastFrameNum = 0;
+}
+
+BurstCapture::StoreResult BurstCapture::store(const FrameRef &frame) {
+  const std::size_t n = m_count.load(std::memory_order_relaxed);
+  if (n >= m_frames.capacity())
+    return StoreResult::Full;
+  if (frame.size() > m_pool.bufferBytes())
+    return StoreResult::Oversize;
+
+  // 预分配的块数 == 容量，只要没满就一定取得到
+  FrameRef slot = m_pool.acquire();
+  if (!slot)
+    return StoreResult::Full;
+  std::memcpy(slot.writableData(), frame.data(), frame.size());
+  slot.writableInfo() = frame.info();
+
+  const FrameInfo &info = frame.info();
+  if (n == 0) {
+    m_firstGrabNs = info.grabTimeNs;
+  } else {
+    // 帧号按 uint32 回绕；相机重启导致的回退不算丢帧
+    const uint32_t step = info.frameNum - m_lastFrameNum;
+    if (step > 1 && step < 0x80000000u)
+      m_dropped += step - 1;
+  }
+  m_lastGrabNs = info.grabTimeNs;
+  m_lastFrameNum = info.frameNum;
+
+  // capacity 已 reserve，push_back 不会重新分配
+  m_frames.push_back(std::move(slot));
+  m_count.store(n + 1, std::memory_order_release);
+  return n + 1 >= m_frames.capacity() ? StoreResult::Complete
+                                      : StoreResult::Stored;
+}
+
+BurstCapture::Stats BurstCapture::stats() const {
+  Stats s;
+  s.target = capacity();
+  s.captured = size();
+  s.dropped = m_dropped;
+  if (s.captured >= 2 && m_lastGrabNs > m_firstGrabNs) {
+    s.durationMs = double(m_lastGrabNs - m_firstGrabNs) / 1e6;
+    s.achievedFps = double(s.captured - 1) * 1000.0 / s.durationMs;
+  }
+  return s;
+}
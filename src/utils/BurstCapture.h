@@ -0,0 +1,78 @@
+#ifndef BURSTCAPTURE_H
+#define BURSTCAPTURE_H
+
+#include "FramePool.h"
+#include "FrameRef.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 连拍内存区：预分配 N 帧，热路径只做一次 memcpy（无 Qt/SDK 依赖，可单测）
+ *
+ * 高速行为（逃避反应等）需要按传感器最高帧率连续抓 N 帧：开始前一次性
+ * 分配好全部帧缓冲，连拍期间不编码、不写盘，arena 满后再由调用方慢慢落盘。
+ * 帧从采集帧缓冲池拷进自己的缓冲，采集池立刻归还，预览不受影响。
+ *
+ * 线程：store() 只由一个线程（连拍阶段线程）调用；frame() / stats() 在
+ * isComplete() 之后由其他线程读取（调用方负责交接，例如经事件循环投递）。
+ */
+class BurstCapture {
+public:
+  struct Stats {
+    std::size_t target = 0;   // 预分配的帧数
+    std::size_t captured = 0; // 实际抓到的帧数
+    // 连拍期间相机帧号的空洞：相机 / 传输 / 缓冲池 / 队列任一环节丢的帧都算
+    uint64_t dropped = 0;
+    double durationMs = 0.0;  // 第一帧到最后一帧的采集时间跨度
+    double achievedFps = 0.0; // (captured - 1) / durationMs
+  };
+
+  enum class StoreResult {
+    Stored,   // 已存入，还没满
+    Complete, // 已存入，这是最后一帧
+    Full,     // 已经满了，没有存
+    Oversize, // 帧比预分配的缓冲大（连拍中改了 ROI）
+  };
+
+  /**
+   * @brief 按帧数 / 内存预算算出要预分配的帧数
+   * frameCount > 0 时取 frameCount，再受 memoryBudgetBytes（> 0 时）截断
+   */
+  static std::size_t slotsFor(std::size_t frameCount,
+                              std::size_t memoryBudgetBytes,
+                              std::size_t frameBytes);
+
+  /**
+   * @brief 预分配 slotCount 块、每块 slotBytes 字节并逐页预先写入（避免连拍时缺页）
+   * @return 仍有已捕获帧被外部持有时返回 false
+   */
+  bool configure(std::size_t slotCount, std::size_t slotBytes);
+  // 放掉已捕获的帧和全部内存
+  void release();
+  // 放掉已捕获的帧，内存保留，可以再连拍一次
+  void clear();
+
+  StoreResult store(const FrameRef &frame);
+
+  bool isComplete() const { return size() >= capacity() && capacity() > 0; }
+  std::size_t capacity() const { return m_frames.capacity(); }
+  std::size_t size() const { return m_count.load(std::memory_order_acquire); }
+  std::size_t slotBytes() const { return m_pool.bufferBytes(); }
+  // i < size()
+  const FrameRef &frame(std::size_t i) const { return m_frames[i]; }
+
+  Stats stats() const;
+
+private:
+  FramePool m_pool;
+  std::vector<FrameRef> m_frames;
+  std::atomic<std::size_t> m_count{0};
+  uint64_t m_dropped = 0;
+  int64_t m_firstGrabNs = 0;
+  int64_t m_lastGrabNs = 0;
+  uint32_t m_lastFrameNum = 0;
+};
+
+#endif // BURSTCAPTURE_H
@@ -0,0 +1,77 @@
+#include "CpuFeatures.h"
+
+#if defined(WV_SIMD_AVX2) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace CpuFeatures {
+
+namespace {
+
+#if defined(WV_SIMD_AVX2)
+bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  // OSXSAVE + AVX，且操作系统保存 YMM 状态
+  if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+    return false;
+  if ((_xgetbv(0) & 6) != 6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // WV_SIMD_AVX2
+
+} // namespace
+
+bool isSupported(Isa isa) {
+  switch (isa) {
+  case Isa::Scalar:
+    return true;
+  case Isa::Sse2:
+#if defined(WV_SIMD_SSE2)
+    return true;
+#else
+    return false;
+#endif
+  case Isa::Avx2: {
+#if defined(WV_SIMD_AVX2)
+    static const bool avx2 = cpuHasAvx2();
+    return avx2;
+#else
+    return false;
+#endif
+  }
+  }
+  return false;
+}
+
+Isa resolve(Isa isa) {
+  while (!isSupported(isa))
+    isa = static_cast<Isa>(static_cast<int>(isa) - 1);
+  return isa;
+}
+
+Isa best() { return resolve(Isa::Avx2); }
+
+const char *name(Isa isa) {
+  switch (isa) {
+  case Isa::Scalar:
+    return "scalar";
+  case Isa::Sse2:
+    return "SSE2";
+  case Isa::Avx2:
+    return "AVX2";
+  }
+  return "";
+}
+
+} // namespace CpuFeatures
@@ -0,0 +1,48 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+/**
+ * @brief SIMD 指令集的编译期开关与运行时检测（无 Qt/SDK 依赖）
+ *
+ * 像素内核（BayerDemosaic、PixelUnpack）按同一套规则分档：
+ * 标量是基准，SSE2 是 x86-64 的基线，AVX2 要运行时检测。
+ * 各 .cpp 用下面的宏决定编译哪些实现，再用 resolve() 选实际运行的一档。
+ *
+ * - WV_SIMD_SSE2：编译目标保证有 SSE2
+ * - WV_SIMD_AVX2：编译器能在单个函数上启用 AVX2（WV_TARGET_AVX2），
+ *   不需要整个工程开 -mavx2
+ */
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WV_SIMD_SSE2 1
+#endif
+
+#if defined(WV_SIMD_SSE2) && (defined(_MSC_VER) || defined(__GNUC__))
+#define WV_SIMD_AVX2 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#define WV_TARGET_AVX2
+#else
+#define WV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace CpuFeatures {
+
+// 从低到高排列：resolve() 依次往下退
+enum class Isa { Scalar, Sse2, Avx2 };
+
+// 编译进来了且当前 CPU 支持（AVX2 首次调用时检测）
+bool isSupported(Isa isa);
+
+// 不支持时退到支持的最高一档
+Isa resolve(Isa isa);
+
+// 当前 CPU 支持的最高一档
+Isa best();
+
+// 日志 / 基准用："scalar" / "SSE2" / "AVX2"
+const char *name(Isa isa);
+
+} // namespace CpuFeatures
+
+#endif // CPUFEATURES_H
@@ -0,0 +1,147 @@
+#include "FramePool.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+// 缓冲起始地址按 cache line 对齐，后续 SIMD 转换可直接用对齐加载
+constexpr std::size_t kBufferAlign = 64;
+constexpr std::size_t kPageBytes = 4096;
+
+std::size_t alignUp(std::size_t v, std::size_t a) {
+  return (v + a - 1) / a * a;
+}
+} // namespace
+
+FramePool::~FramePool() { release(); }
+
+bool FramePool::configure(std::size_t bufferCount, std::size_t bufferBytes,
+                          std::size_t maxBufferCount) {
+  if (inUse() != 0)
+    return false;
+  maxBufferCount = std::max(maxBufferCount, bufferCount);
+  if (bufferCount == this->bufferCount() && bufferBytes == m_bufferBytes &&
+      maxBufferCount == m_maxBufferCount && !m_chunks.empty()) {
+    resetCounters();
+    return true;
+  }
+
+  release();
+  if (bufferCount == 0 || bufferBytes == 0)
+    return true;
+
+  m_free = std::make_unique<MpmcRing<FrameBuffer *>>(maxBufferCount);
+  m_bufferBytes = bufferBytes;
+  m_maxBufferCount = maxBufferCount;
+  addChunk(bufferCount);
+  resetCounters();
+  return true;
+}
+
+std::size_t FramePool::grow(std::size_t extraBuffers) {
+  if (!m_free)
+    return 0;
+  const std::size_t room = m_maxBufferCount - bufferCount();
+  const std::size_t count = std::min(extraBuffers, room);
+  if (count > 0)
+    addChunk(count);
+  return count;
+}
+
+void FramePool::addChunk(std::size_t count) {
+  const std::size_t stride = alignUp(m_bufferBytes, kBufferAlign);
+  Chunk chunk;
+  chunk.bytes = stride * count + kBufferAlign;
+  chunk.storage.reset(new unsigned char[chunk.bytes]);
+  chunk.buffers.reset(new FrameBuffer[count]);
+
+  const auto base = reinterpret_cast<std::uintptr_t>(chunk.storage.get());
+  unsigned char *aligned =
+      chunk.storage.get() + (alignUp(base, kBufferAlign) - base);
+  for (std::size_t i = 0; i < count; ++i) {
+    FrameBuffer &b = chunk.buffers[i];
+    b.data = aligned + i * stride;
+    b.capacity = m_bufferBytes;
+    b.recycle = &FramePool::recycle;
+    b.recycleContext = this;
+    // 空闲链表容量 >= m_maxBufferCount，同样只会短暂返回"满"
+    while (!m_free->tryPush(&b))
+      std::this_thread::yield();
+  }
+  m_chunks.push_back(std::move(chunk));
+  m_bufferCount.fetch_add(count, std::memory_order_relaxed);
+}
+
+bool FramePool::release() {
+  if (inUse() != 0)
+    return false;
+  m_free.reset();
+  m_chunks.clear();
+  m_bufferCount.store(0, std::memory_order_relaxed);
+  m_maxBufferCount = 0;
+  m_bufferBytes = 0;
+  return true;
+}
+
+bool FramePool::prefault() {
+  if (inUse() != 0)
+    return false;
+  for (Chunk &chunk : m_chunks) {
+    for (std::size_t off = 0; off < chunk.bytes; off += kPageBytes)
+      chunk.storage[off] = 0;
+  }
+  return true;
+}
+
+FrameRef FramePool::acquire() {
+  FrameBuffer *buffer = nullptr;
+  if (!m_free || !m_free->tryPop(buffer)) {
+    m_exhausted.fetch_add(1, std::memory_order_relaxed);
+    return FrameRef();
+  }
+  buffer->info = FrameInfo();
+  const std::size_t used = m_inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+  std::size_t hw = m_highWater.load(std::memory_order_relaxed);
+  while (used > hw && !m_highWater.compare_exchange_weak(
+                          hw, used, std::memory_order_relaxed)) {
+  }
+  m_acquired.fetch_add(1, std::memory_order_relaxed);
+  return FrameRef::adopt(buffer);
+}
+
+void FramePool::recycle(FrameBuffer *buffer, void *context) {
+  auto *pool = static_cast<FramePool *>(context);
+  // 空闲链表容量 >= 缓冲数，不会真的满；MpmcRing 在另一线程 pop 到一半时
+  // 可能短暂返回"满"，这里必须重试，否则这块缓冲就永久丢了
+  while (!pool->m_free->tryPush(buffer))
+    std::this_thread::yield();
+  pool->m_inUse.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::size_t FramePool::inUse() const {
+  return m_inUse.load(std::memory_order_relaxed);
+}
+
+FramePool::Stats FramePool::stats() const {
+  Stats st;
+  st.bufferCount = bufferCount();
+  st.bufferBytes = m_bufferBytes;
+  st.inUse = inUse();
+  st.highWater = m_highWater.load(std::memory_order_relaxed);
+  st.acquired = m_acquired.load(std::memory_order_relaxed);
+  st.exhausted = m_exhausted.load(std::memory_order_relaxed);
+  return st;
+}
+
+void FramePool::resetCounters() {
+  m_highWater.store(inUse(), std::memory_order_relaxed);
+  m_acquired.store(0, std::memory_order_relaxed);
+  m_exhausted.store(0, std::memory_order_relaxed);
+}
+
+std::size_t FramePool::frameBytesFor(uint32_t width, uint32_t height,
+                                     uint32_t pixelType) {
+  const uint64_t bitsPerPixel = (pixelType >> 16) & 0xFF;
+  const uint64_t bits = static_cast<uint64_t>(width) * height *
+                        (bitsPerPixel ? bitsPerPixel : 8);
+  return static_cast<std::size_t>((bits + 7) / 8);
+}
@@ -0,0 +1,102 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include "FrameQueue.h"
+#include "FrameRef.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 预分配的帧缓冲池（无 Qt/SDK 依赖，可单测）
+ *
+ * startGrabbing 时按 PayloadSize（或宽 × 高 × 像素位深）一次性分配 N 块
+ * 64 字节对齐的缓冲，采集中 acquire() 只从无锁空闲链表取一块，
+ * 最后一个 FrameRef 释放时自动归还 —— 稳态下零堆分配。
+ * 池子用完时 acquire 返回空 FrameRef 并计入 exhausted，由调用方丢帧。
+ * 采集中可以 grow() 追加缓冲（上限在 configure 时定好），但不能缩小。
+ */
+class FramePool {
+public:
+  struct Stats {
+    std::size_t bufferCount = 0;
+    std::size_t bufferBytes = 0;
+    std::size_t inUse = 0;     // 当前被 FrameRef 持有的缓冲数
+    std::size_t highWater = 0; // 自上次 resetCounters 以来 inUse 的峰值
+    uint64_t acquired = 0;     // 成功 acquire 次数
+    uint64_t exhausted = 0;    // 池子用完导致 acquire 失败的次数
+  };
+
+  FramePool() = default;
+  ~FramePool();
+
+  FramePool(const FramePool &) = delete;
+  FramePool &operator=(const FramePool &) = delete;
+
+  /**
+   * @brief 重新分配缓冲区
+   * @param maxBufferCount 之后 grow() 能达到的总数上限（小于 bufferCount 时取 bufferCount）
+   * @return 仍有缓冲被 FrameRef 持有时拒绝重分配，返回 false
+   */
+  bool configure(std::size_t bufferCount, std::size_t bufferBytes,
+                 std::size_t maxBufferCount = 0);
+  /**
+   * @brief 采集中追加缓冲（只能由配置池子的线程调用，可与 acquire / 归还并发）
+   * @return 实际追加的块数（受 configure 时的上限约束）
+   */
+  std::size_t grow(std::size_t extraBuffers);
+  // 释放全部内存；同样要求没有缓冲在外
+  bool release();
+  /**
+   * @brief 每页先写一次，把缺页中断挪到这里（连拍 / 预触发这类大池子在热路径
+   * 第一次 memcpy 时才缺页会拖慢出帧）
+   * @return 有缓冲在外时不动内容，返回 false
+   */
+  bool prefault();
+
+  // 任意线程可调用；池子空时返回空 FrameRef
+  FrameRef acquire();
+
+  Stats stats() const;
+  void resetCounters();
+  std::size_t bufferCount() const {
+    return m_bufferCount.load(std::memory_order_relaxed);
+  }
+  std::size_t maxBufferCount() const { return m_maxBufferCount; }
+  std::size_t bufferBytes() const { return m_bufferBytes; }
+  std::size_t inUse() const;
+
+  /**
+   * @brief 按 GVSP 像素格式估算一帧的字节数
+   * 像素位深取自 MvGvspPixelType 的 bit 16-23（Mono12Packed = 12 等）
+   */
+  static std::size_t frameBytesFor(uint32_t width, uint32_t height,
+                                   uint32_t pixelType);
+
+private:
+  static void recycle(FrameBuffer *buffer, void *context);
+
+  // 一次 configure / grow 分配一块连续内存
+  struct Chunk {
+    std::unique_ptr<unsigned char[]> storage;
+    std::unique_ptr<FrameBuffer[]> buffers;
+    std::size_t bytes = 0;
+  };
+  void addChunk(std::size_t count);
+
+  std::vector<Chunk> m_chunks;
+  // 容量按 m_maxBufferCount 分配，grow 时不用重建
+  std::unique_ptr<MpmcRing<FrameBuffer *>> m_free;
+  std::atomic<std::size_t> m_bufferCount{0};
+  std::size_t m_maxBufferCount = 0;
+  std::size_t m_bufferBytes = 0;
+
+  std::atomic<std::size_t> m_inUse{0};
+  std::atomic<std::size_t> m_highWater{0};
+  std::atomic<uint64_t> m_acquired{0};
+  std::atomic<uint64_t> m_exhausted{0};
+};
+
+#endif // FRAMEPOOL_H
@@ -0,0 +1,183 @@
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief 采集流水线用的有界无锁环形队列（纯头文件，无 Qt/SDK 依赖，可单测）
+ *
+ * - SpscRing：单生产者/单消费者。grab 线程 → 某个消费阶段，每帧只有两次原子操作。
+ * - MpmcRing：多生产者/多消费者（Vyukov 有界队列）。多个线程归还缓冲区、
+ *   或多路相机汇入同一个写盘线程时使用。
+ *
+ * 两者容量都向上取整到 2 的幂；满时 tryPush 返回 false，由调用方决定丢帧策略，
+ * 队列本身永不阻塞、永不分配内存。
+ * 注意 MpmcRing 在其他线程 pop 到一半时可能短暂地对 tryPush 返回 false，
+ * 用作"元素总数不超过容量"的空闲链表时调用方要重试。
+ */
+
+namespace FrameQueueDetail {
+
+// 避免 head/tail 落在同一 cache line 上产生伪共享
+constexpr std::size_t kCacheLine = 64;
+
+inline std::size_t roundUpPow2(std::size_t v) {
+  std::size_t p = 1;
+  while (p < v)
+    p <<= 1;
+  return p;
+}
+
+} // namespace FrameQueueDetail
+
+template <typename T> class SpscRing {
+public:
+  explicit SpscRing(std::size_t capacity)
+      : m_capacity(FrameQueueDetail::roundUpPow2(capacity < 1 ? 1 : capacity)),
+        m_mask(m_capacity - 1), m_slots(new T[m_capacity]) {}
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // 仅生产者线程调用
+  bool tryPush(T &&value) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_headCache == m_capacity) {
+      m_headCache = m_head.load(std::memory_order_acquire);
+      if (tail - m_headCache == m_capacity)
+        return false;
+    }
+    m_slots[tail & m_mask] = std::move(value);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPush(const T &value) {
+    T copy(value);
+    return tryPush(std::move(copy));
+  }
+
+  // 仅消费者线程调用；取出后槽位重置为默认值，及时释放帧引用
+  bool tryPop(T &out) {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tailCache) {
+      m_tailCache = m_tail.load(std::memory_order_acquire);
+      if (head == m_tailCache)
+        return false;
+    }
+    out = std::move(m_slots[head & m_mask]);
+    m_slots[head & m_mask] = T();
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 任意线程可读的近似深度（用于统计）
+  std::size_t size() const {
+    const std::size_t tail = m_tail.load(std::memory_order_acquire);
+    const std::size_t head = m_head.load(std::memory_order_acquire);
+    return tail - head;
+  }
+  bool empty() const { return size() == 0; }
+  std::size_t capacity() const { return m_capacity; }
+
+private:
+  const std::size_t m_capacity;
+  const std::size_t m_mask;
+  std::unique_ptr<T[]> m_slots;
+
+  alignas(FrameQueueDetail::kCacheLine) std::atomic<std::size_t> m_head{0};
+  std::size_t m_tailCache = 0; // 消费者私有
+  alignas(FrameQueueDetail::kCacheLine) std::atomic<std::size_t> m_tail{0};
+  std::size_t m_headCache = 0; // 生产者私有
+};
+
+template <typename T> class MpmcRing {
+public:
+  explicit MpmcRing(std::size_t capacity)
+      : m_capacity(FrameQueueDetail::roundUpPow2(capacity < 2 ? 2 : capacity)),
+        m_mask(m_capacity - 1), m_cells(new Cell[m_capacity]) {
+    for (std::size_t i = 0; i < m_capacity; ++i)
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  MpmcRing(const MpmcRing &) = delete;
+  MpmcRing &operator=(const MpmcRing &) = delete;
+
+  bool tryPush(T &&value) {
+    Cell *cell = nullptr;
+    std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &m_cells[pos & m_mask];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) -
+                                  static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // 满
+      } else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPush(const T &value) {
+    T copy(value);
+    return tryPush(std::move(copy));
+  }
+
+  bool tryPop(T &out) {
+    Cell *cell = nullptr;
+    std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &m_cells[pos & m_mask];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) -
+                                  static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // 空
+      } else {
+        pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+    out = std::move(cell->value);
+    cell->value = T();
+    cell->sequence.store(pos + m_capacity, std::memory_order_release);
+    return true;
+  }
+
+  std::size_t size() const {
+    const std::size_t enq = m_enqueuePos.load(std::memory_order_acquire);
+    const std::size_t deq = m_dequeuePos.load(std::memory_order_acquire);
+    return enq > deq ? enq - deq : 0;
+  }
+  bool empty() const { return size() == 0; }
+  std::size_t capacity() const { return m_capacity; }
+
+private:
+  struct Cell {
+    std::atomic<std::size_t> sequence{0};
+    T value{};
+  };
+
+  const std::size_t m_capacity;
+  const std::size_t m_mask;
+  std::unique_ptr<Cell[]> m_cells;
+
+  alignas(FrameQueueDetail::kCacheLine) std::atomic<std::size_t> m_enqueuePos{0};
+  alignas(FrameQueueDetail::kCacheLine) std::atomic<std::size_t> m_dequeuePos{0};
+};
+
+#endif // FRAMEQUEUE_H
@@ -0,0 +1,92 @@
+#include "FrameRateEstimator.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace FrameRateEstimator {
+
+namespace {
+
+constexpr double kUnlimited = std::numeric_limits<double>::infinity();
+
+bool boundBy(double fps, double limit) {
+  return limit > 0.0 && limit < kUnlimited &&
+         fps >= limit * (1.0 - kBoundTolerance);
+}
+
+} // namespace
+
+FrameRateEstimate estimate(const FrameRateModelInput &input,
+                           const SamplingMode &target) {
+  FrameRateEstimate est;
+  const SamplingMode &cur = input.mode;
+  if (input.width <= 0 || input.height <= 0 || target.factorH() <= 0 ||
+      target.factorV() <= 0)
+    return est;
+
+  // 同一块传感器区域：输出尺寸按覆盖倍数之比缩放
+  est.width = std::max(1, input.width * cur.factorH() / target.factorH());
+  est.height = std::max(1, input.height * cur.factorV() / target.factorV());
+  est.frameBytes = static_cast<std::size_t>(double(est.width) * est.height *
+                                            input.bytesPerPixel);
+
+  const double exposureFps =
+      input.exposureUs > 0.0 ? 1e6 / input.exposureUs : kUnlimited;
+  const double limitFps =
+      input.frameRateLimit > 0.0 ? input.frameRateLimit : kUnlimited;
+  const double curFrameBytes =
+      double(input.width) * input.height * input.bytesPerPixel;
+  const double curLinkFps = input.linkBytesPerSec > 0.0 && curFrameBytes > 0.0
+                                ? input.linkBytesPerSec / curFrameBytes
+                                : kUnlimited;
+
+  double readoutFps = kUnlimited;
+  if (input.resultingFps > 0.0) {
+    est.readoutIsLowerBound = boundBy(input.resultingFps, exposureFps) ||
+                              boundBy(input.resultingFps, limitFps) ||
+                              boundBy(input.resultingFps, curLinkFps);
+    readoutFps = input.resultingFps * double(input.height) / est.height;
+  }
+  const double linkFps =
+      input.linkBytesPerSec > 0.0 && est.frameBytes > 0
+          ? input.linkBytesPerSec / double(est.frameBytes)
+          : kUnlimited;
+
+  // 读出上限只是下限估计时，与别的约束差不多就报别的约束（真正卡住的是它）
+  est.maxFps = readoutFps;
+  est.limitedBy = FrameRateEstimate::Limit::Readout;
+  double bound = est.readoutIsLowerBound
+                     ? readoutFps * (1.0 + kBoundTolerance)
+                     : readoutFps;
+  const std::pair<double, FrameRateEstimate::Limit> others[] = {
+      {exposureFps, FrameRateEstimate::Limit::Exposure},
+      {limitFps, FrameRateEstimate::Limit::FrameRateLimit},
+      {linkFps, FrameRateEstimate::Limit::Link}};
+  for (const auto &[fps, limit] : others) {
+    if (fps < bound) {
+      est.maxFps = fps;
+      est.limitedBy = limit;
+      bound = fps;
+    }
+  }
+  if (est.maxFps == kUnlimited)
+    est.maxFps = 0.0;
+  est.bandwidthBytesPerSec = est.maxFps * double(est.frameBytes);
+  return est;
+}
+
+const char *limitName(FrameRateEstimate::Limit limit) {
+  switch (limit) {
+  case FrameRateEstimate::Limit::Readout:
+    return "读出";
+  case FrameRateEstimate::Limit::Exposure:
+    return "曝光";
+  case FrameRateEstimate::Limit::FrameRateLimit:
+    return "帧率限制";
+  case FrameRateEstimate::Limit::Link:
+    return "链路带宽";
+  }
+  return "";
+}
+
+} // namespace FrameRateEstimator
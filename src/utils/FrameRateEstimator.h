@@ -0,0 +1,88 @@
+#ifndef FRAMERATEESTIMATOR_H
+#define FRAMERATEESTIMATOR_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Binning / 抽样（Decimation）对帧率和带宽影响的预估（纯函数，可单测）
+ *
+ * 换 binning 要停采集重配，操作员应该在应用之前就看到代价和收益：
+ * 输出尺寸、一帧字节数、最高帧率和链路带宽。最高帧率取下面几项的最小值：
+ * - 传感器读出：读出时间按输出行数缩放，以当前 ResultingFrameRate 为基准。
+ *   当前帧率受曝光 / 帧率限制 / 链路约束时，传感器实际能读得更快，
+ *   这里只能按当前帧率作下限（readoutIsLowerBound）
+ * - 曝光：1e6 / 曝光时间（us）
+ * - 帧率限制：AcquisitionFrameRate 启用时的设定值
+ * - 链路：链路有效带宽 / 一帧字节数
+ *
+ * 有的相机 binning 在 FPGA 里做、传感器照样全幅读出，实际帧率只会更低，
+ * 所以结果是"最高"帧率；应用后以相机回报的 ResultingFrameRate 为准。
+ */
+struct SamplingMode {
+  int binningH = 1;
+  int binningV = 1;
+  int decimationH = 1;
+  int decimationV = 1;
+
+  // 每个输出像素在水平 / 垂直方向覆盖的传感器像素数
+  int factorH() const { return binningH * decimationH; }
+  int factorV() const { return binningV * decimationV; }
+  bool operator==(const SamplingMode &o) const {
+    return binningH == o.binningH && binningV == o.binningV &&
+           decimationH == o.decimationH && decimationV == o.decimationV;
+  }
+  bool operator!=(const SamplingMode &o) const { return !(*this == o); }
+};
+
+// 相机各节点可选的倍数；没有该节点时对应列表为空
+struct SamplingOptions {
+  std::vector<int> binningH;
+  std::vector<int> binningV;
+  std::vector<int> decimationH;
+  std::vector<int> decimationV;
+
+  bool supported() const {
+    return binningH.size() > 1 || binningV.size() > 1 ||
+           decimationH.size() > 1 || decimationV.size() > 1;
+  }
+};
+
+struct FrameRateModelInput {
+  SamplingMode mode;           // 当前 binning / 抽样
+  int width = 0;               // 当前输出尺寸
+  int height = 0;
+  double bytesPerPixel = 1.0;  // PayloadSize / (宽 × 高)
+  double resultingFps = 0.0;   // 当前 ResultingFrameRate
+  double exposureUs = 0.0;     // <= 0 表示不计曝光限制
+  double frameRateLimit = 0.0; // AcquisitionFrameRate 限制，<= 0 表示未启用
+  double linkBytesPerSec = 0.0; // 链路有效带宽，<= 0 表示未知
+};
+
+struct FrameRateEstimate {
+  enum class Limit { Readout, Exposure, FrameRateLimit, Link };
+
+  int width = 0;
+  int height = 0;
+  std::size_t frameBytes = 0;
+  double maxFps = 0.0;
+  double bandwidthBytesPerSec = 0.0; // maxFps × frameBytes
+  Limit limitedBy = Limit::Readout;
+  // 当前帧率不是读出限制的，读出上限按当前帧率估（实际可能更快）
+  bool readoutIsLowerBound = false;
+};
+
+namespace FrameRateEstimator {
+
+// 判定"受某项约束"的容差：ResultingFrameRate 与约束值相差不到 3%
+constexpr double kBoundTolerance = 0.03;
+
+FrameRateEstimate estimate(const FrameRateModelInput &input,
+                           const SamplingMode &target);
+
+// 日志 / UI 用："读出" / "曝光" / "帧率限制" / "链路带宽"
+const char *limitName(FrameRateEstimate::Limit limit);
+
+} // namespace FrameRateEstimator
+
+#endif // FRAMERATEESTIMATOR_H
@@ -0,0 +1,129 @@
+#ifndef FRAMEREF_H
+#define FRAMEREF_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 单帧元数据（对应 MV_FRAME_OUT_INFO_EX 中流水线关心的字段）
+ *
+ * 与 RecordingDiagnostics 一样不 include SDK 头文件，便于在没有海康 SDK 的
+ * Linux 构建机上单测；pixelType 直接存 MvGvspPixelType 的 uint32 值。
+ */
+struct FrameInfo {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t extendWidth = 0;  // 含 stride padding 的宽（SDK nExtendWidth）
+  uint32_t extendHeight = 0; // SDK nExtendHeight
+  uint32_t pixelType = 0;    // MvGvspPixelType
+  uint64_t frameLen = 0;     // 有效数据字节数（SDK nFrameLenEx）
+  uint32_t frameNum = 0;     // 相机帧号（SDK nFrameNum）
+  uint64_t devTimestamp = 0; // 设备时间戳（nDevTimeStampHigh << 32 | Low）
+  int64_t hostTimestamp = 0; // SDK 主机时间戳（毫秒）
+  int64_t grabTimeNs = 0;    // grab 线程取到帧时的 steady_clock 纳秒
+};
+
+/**
+ * @brief 帧缓冲控制块：像素指针 + 元数据 + 引用计数 + 回收回调
+ *
+ * 缓冲区的真正所有者（SDK 节点、缓冲池等）负责分配 FrameBuffer，
+ * 最后一个 FrameRef 释放时调用 recycle 把它还回去。
+ */
+struct FrameBuffer {
+  using Recycler = void (*)(FrameBuffer *buffer, void *context);
+
+  unsigned char *data = nullptr;
+  std::size_t capacity = 0;
+  FrameInfo info;
+
+  std::atomic<int> refCount{0};
+  Recycler recycle = nullptr;
+  void *recycleContext = nullptr;
+};
+
+/**
+ * @brief FrameBuffer 的侵入式引用计数句柄
+ *
+ * 拷贝只做一次原子加，display / record / snapshot 各阶段共享同一份像素数据，
+ * 不做 memcpy。像素数据在句柄存活期间只读。
+ */
+class FrameRef {
+public:
+  FrameRef() = default;
+  ~FrameRef() { reset(); }
+
+  FrameRef(const FrameRef &other) : m_buffer(other.m_buffer) {
+    if (m_buffer)
+      m_buffer->refCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  FrameRef(FrameRef &&other) noexcept : m_buffer(other.m_buffer) {
+    other.m_buffer = nullptr;
+  }
+  FrameRef &operator=(const FrameRef &other) {
+    if (this != &other) {
+      FrameRef copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+  FrameRef &operator=(FrameRef &&other) noexcept {
+    if (this != &other) {
+      reset();
+      m_buffer = other.m_buffer;
+      other.m_buffer = nullptr;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief 接管一个引用计数为 0 的空闲缓冲，返回第一个引用
+   */
+  static FrameRef adopt(FrameBuffer *buffer) {
+    FrameRef ref;
+    if (buffer) {
+      buffer->refCount.store(1, std::memory_order_relaxed);
+      ref.m_buffer = buffer;
+    }
+    return ref;
+  }
+
+  void reset() {
+    if (!m_buffer)
+      return;
+    FrameBuffer *buffer = m_buffer;
+    m_buffer = nullptr;
+    if (buffer->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+        buffer->recycle) {
+      buffer->recycle(buffer, buffer->recycleContext);
+    }
+  }
+
+  void swap(FrameRef &other) noexcept {
+    FrameBuffer *tmp = m_buffer;
+    m_buffer = other.m_buffer;
+    other.m_buffer = tmp;
+  }
+
+  // 仅供生产者在把帧交给其他线程之前填充像素和元数据
+  unsigned char *writableData() const {
+    return m_buffer ? m_buffer->data : nullptr;
+  }
+  FrameInfo &writableInfo() const { return m_buffer->info; }
+  std::size_t capacity() const { return m_buffer ? m_buffer->capacity : 0; }
+
+  explicit operator bool() const { return m_buffer != nullptr; }
+  const unsigned char *data() const { return m_buffer ? m_buffer->data : nullptr; }
+  std::size_t size() const {
+    return m_buffer ? static_cast<std::size_t>(m_buffer->info.frameLen) : 0;
+  }
+  const FrameInfo &info() const { return m_buffer->info; }
+  int useCount() const {
+    return m_buffer ? m_buffer->refCount.load(std::memory_order_relaxed) : 0;
+  }
+
+private:
+  FrameBuffer *m_buffer = nullptr;
+};
+
+#endif // FRAMEREF_H
@@ -0,0 +1,213 @@
+#include "FrameTelemetry.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 基线窗口最多保存的样本数：5 s 窗口下可支撑 1600 fps，满了丢最旧的
+constexpr std::size_t kWindowCapacity = 8192;
+
+int highestBit(uint64_t v) {
+  int bit = 0;
+  while (v >>= 1)
+    ++bit;
+  return bit;
+}
+} // namespace
+
+// ============================================================================
+// LatencyHistogram
+// ============================================================================
+
+void LatencyHistogram::clear() {
+  m_buckets.fill(0);
+  m_count = 0;
+  m_sum = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+int LatencyHistogram::bucketOf(uint64_t v) {
+  if (v < kLinearBuckets)
+    return static_cast<int>(v);
+  const int msb = highestBit(v);
+  if (msb > kMaxExponent)
+    return kBucketCount - 1;
+  const int shift = msb - 5;
+  const int sub = static_cast<int>(v >> shift) - kSubBuckets;
+  return kLinearBuckets + (msb - 6) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketLow(int bucket) {
+  if (bucket < kLinearBuckets)
+    return static_cast<uint64_t>(bucket);
+  const int exponent = (bucket - kLinearBuckets) / kSubBuckets + 6;
+  const int sub = (bucket - kLinearBuckets) % kSubBuckets;
+  return static_cast<uint64_t>(kSubBuckets + sub) << (exponent - 5);
+}
+
+uint64_t LatencyHistogram::bucketHigh(int bucket) {
+  if (bucket < kLinearBuckets)
+    return static_cast<uint64_t>(bucket);
+  const int exponent = (bucket - kLinearBuckets) / kSubBuckets + 6;
+  return bucketLow(bucket) + (uint64_t(1) << (exponent - 5)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t valueUs) {
+  ++m_buckets[bucketOf(valueUs)];
+  if (m_count == 0 || valueUs < m_min)
+    m_min = valueUs;
+  m_max = std::max(m_max, valueUs);
+  m_sum += valueUs;
+  ++m_count;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+  if (m_count == 0)
+    return 0;
+  p = std::clamp(p, 0.0, 100.0);
+  const uint64_t target = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(p / 100.0 * m_count)));
+  if (target >= m_count)
+    return m_max;
+  uint64_t cumulative = 0;
+  for (int b = 0; b < kBucketCount; ++b) {
+    cumulative += m_buckets[b];
+    if (cumulative >= target) {
+      const uint64_t mid = (bucketLow(b) + bucketHigh(b)) / 2;
+      return std::clamp(mid, m_min, m_max);
+    }
+  }
+  return m_max;
+}
+
+// ============================================================================
+// FrameTelemetry
+// ============================================================================
+
+FrameTelemetry::FrameTelemetry() : m_window(kWindowCapacity) { reset(); }
+
+void FrameTelemetry::reset(double deviceTickHz) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_nsPerTick = deviceTickHz > 0.0 ? 1e9 / deviceTickHz : 1.0;
+  m_frames = 0;
+  m_lostFrames = 0;
+  m_gapEvents = 0;
+  m_largestGap = 0;
+  m_counterResets = 0;
+  m_firstFrameNum = 0;
+  m_lastFrameNum = 0;
+  m_firstHostNs = 0;
+  m_lastHostNs = 0;
+  m_lastDevTimestamp = 0;
+  m_windowHead = 0;
+  m_windowSize = 0;
+  m_latency.clear();
+  m_interval.clear();
+  m_jitter.clear();
+}
+
+void FrameTelemetry::record(const FrameInfo &info) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const int64_t hostNs = info.grabTimeNs;
+
+  if (m_frames == 0) {
+    m_firstFrameNum = info.frameNum;
+    m_firstHostNs = hostNs;
+  } else {
+    // 丢帧：帧号空洞
+    if (info.frameNum > m_lastFrameNum) {
+      const uint64_t gap = info.frameNum - m_lastFrameNum - 1;
+      if (gap > 0) {
+        m_lostFrames += gap;
+        ++m_gapEvents;
+        m_largestGap = std::max(m_largestGap, gap);
+      }
+    } else {
+      ++m_counterResets;
+    }
+
+    // 主机到达间隔 + 相对设备间隔的抖动
+    const int64_t hostIntervalNs = hostNs - m_lastHostNs;
+    if (hostIntervalNs >= 0) {
+      m_interval.record(static_cast<uint64_t>(hostIntervalNs) / 1000);
+      if (info.devTimestamp > m_lastDevTimestamp && m_lastDevTimestamp != 0) {
+        const double devIntervalNs =
+            double(info.devTimestamp - m_lastDevTimestamp) * m_nsPerTick;
+        m_jitter.record(static_cast<uint64_t>(
+            std::fabs(double(hostIntervalNs) - devIntervalNs) / 1000.0));
+      }
+    }
+  }
+
+  // 设备→主机相对延迟
+  if (info.devTimestamp != 0) {
+    const auto devNs =
+        static_cast<int64_t>(double(info.devTimestamp) * m_nsPerTick);
+    const int64_t offsetNs = hostNs - devNs;
+    pushOffset(hostNs, offsetNs);
+    m_latency.record(static_cast<uint64_t>(offsetNs - baselineOffset()) / 1000);
+  }
+
+  m_lastFrameNum = info.frameNum;
+  m_lastHostNs = hostNs;
+  m_lastDevTimestamp = info.devTimestamp;
+  ++m_frames;
+}
+
+void FrameTelemetry::pushOffset(int64_t hostNs, int64_t offsetNs) {
+  const std::size_t cap = m_window.size();
+  auto at = [&](std::size_t i) -> OffsetSample & {
+    return m_window[(m_windowHead + i) % cap];
+  };
+  // 单调队列：比新样本大的尾部样本不可能再成为最小值
+  while (m_windowSize > 0 && at(m_windowSize - 1).offsetNs >= offsetNs)
+    --m_windowSize;
+  if (m_windowSize == cap) {
+    m_windowHead = (m_windowHead + 1) % cap;
+    --m_windowSize;
+  }
+  at(m_windowSize++) = {hostNs, offsetNs};
+  // 过期样本出队（新样本本身一定保留）
+  while (m_windowSize > 1 && at(0).hostNs < hostNs - kBaselineWindowNs) {
+    m_windowHead = (m_windowHead + 1) % cap;
+    --m_windowSize;
+  }
+}
+
+int64_t FrameTelemetry::baselineOffset() const {
+  return m_windowSize ? m_window[m_windowHead].offsetNs : 0;
+}
+
+FrameTelemetry::Percentiles
+FrameTelemetry::percentilesOf(const LatencyHistogram &h) {
+  Percentiles p;
+  p.count = h.count();
+  p.mean = h.mean();
+  p.min = h.min();
+  p.p50 = h.percentile(50.0);
+  p.p95 = h.percentile(95.0);
+  p.p99 = h.percentile(99.0);
+  p.max = h.max();
+  return p;
+}
+
+FrameTelemetry::Summary FrameTelemetry::summary() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Summary s;
+  s.frames = m_frames;
+  s.lostFrames = m_lostFrames;
+  s.gapEvents = m_gapEvents;
+  s.largestGap = m_largestGap;
+  s.counterResets = m_counterResets;
+  s.firstFrameNum = m_firstFrameNum;
+  s.lastFrameNum = m_lastFrameNum;
+  if (m_frames > 1) {
+    s.durationSec = double(m_lastHostNs - m_firstHostNs) / 1e9;
+    if (s.durationSec > 0.0)
+      s.meanFps = double(m_frames - 1) / s.durationSec;
+  }
+  s.latencyUs = percentilesOf(m_latency);
+  s.intervalUs = percentilesOf(m_interval);
+  s.jitterUs = percentilesOf(m_jitter);
+  return s;
+}
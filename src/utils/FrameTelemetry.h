@@ -0,0 +1,140 @@
+#ifndef FRAMETELEMETRY_H
+#define FRAMETELEMETRY_H
+
+#include "FrameRef.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 对数分桶直方图（微秒），固定内存，记录 O(1)
+ *
+ * 0–63 µs 每 1 µs 一个桶，之后每个 2 的幂区间分 32 个桶，
+ * 分位数相对误差 < 3%，上限约 2^40 µs（远超任何实际延迟）。
+ */
+class LatencyHistogram {
+public:
+  void clear();
+  void record(uint64_t valueUs);
+
+  uint64_t count() const { return m_count; }
+  uint64_t min() const { return m_count ? m_min : 0; }
+  uint64_t max() const { return m_max; }
+  double mean() const { return m_count ? double(m_sum) / m_count : 0.0; }
+  // p ∈ [0, 100]；返回所在桶的中值（夹在 min/max 之间），空直方图返回 0
+  uint64_t percentile(double p) const;
+
+private:
+  static constexpr int kLinearBuckets = 64;
+  static constexpr int kSubBuckets = 32;
+  static constexpr int kMaxExponent = 40;
+  static constexpr int kBucketCount =
+      kLinearBuckets + (kMaxExponent - 6 + 1) * kSubBuckets;
+
+  static int bucketOf(uint64_t v);
+  static uint64_t bucketLow(int bucket);
+  static uint64_t bucketHigh(int bucket);
+
+  std::array<uint64_t, kBucketCount> m_buckets{};
+  uint64_t m_count = 0;
+  uint64_t m_sum = 0;
+  uint64_t m_min = 0;
+  uint64_t m_max = 0;
+};
+
+/**
+ * @brief 逐帧采集遥测：丢帧（帧号空洞）、设备→主机延迟、帧间抖动
+ *
+ * grab 线程每帧调用 record()，UI 线程定时取 summary()，内部互斥，
+ * 记录路径不分配内存。
+ *
+ * - 丢帧：相机帧号不连续的差值之和；帧号回退（相机重启 / 计数器回绕）
+ *   单独计数，不算丢帧。
+ * - 延迟：设备时间戳和主机时间不是同一时钟，只能测相对延迟——
+ *   (主机到达时间 − 设备时间) 减去最近 kBaselineWindowNs 内的最小值，
+ *   即超出"最快一帧"的那部分排队 / 传输延迟；滑动窗口同时吸收两个时钟的漂移。
+ * - 间隔：相邻两帧主机到达间隔。
+ * - 抖动：|主机到达间隔 − 设备时间戳间隔|，即传输链路引入的抖动。
+ * 没有设备时间戳（为 0）的帧只统计丢帧和间隔。
+ */
+class FrameTelemetry {
+public:
+  static constexpr int64_t kBaselineWindowNs = 5'000'000'000; // 5 s
+
+  struct Percentiles {
+    uint64_t count = 0;
+    double mean = 0.0;
+    uint64_t min = 0;
+    uint64_t p50 = 0;
+    uint64_t p95 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+  };
+
+  struct Summary {
+    uint64_t frames = 0;        // 已记录帧数
+    uint64_t lostFrames = 0;    // 帧号空洞累计（相机 / 传输 / 缓冲池丢帧）
+    uint64_t gapEvents = 0;     // 出现空洞的次数
+    uint64_t largestGap = 0;    // 单次最大空洞
+    uint64_t counterResets = 0; // 帧号回退次数
+    uint32_t firstFrameNum = 0;
+    uint32_t lastFrameNum = 0;
+    double durationSec = 0.0;   // 首帧到末帧的主机时间
+    double meanFps = 0.0;
+    Percentiles latencyUs;
+    Percentiles intervalUs;
+    Percentiles jitterUs;
+  };
+
+  FrameTelemetry();
+
+  /**
+   * @brief 清空统计，开始新的统计窗口
+   * @param deviceTickHz 设备时间戳频率（GevTimestampTickFrequency），
+   *        USB3 Vision / 合成后端为 1 GHz
+   */
+  void reset(double deviceTickHz = 1e9);
+
+  // grab 线程调用；使用 info.frameNum / devTimestamp / grabTimeNs
+  void record(const FrameInfo &info);
+
+  Summary summary() const;
+
+private:
+  struct OffsetSample {
+    int64_t hostNs;
+    int64_t offsetNs;
+  };
+
+  void pushOffset(int64_t hostNs, int64_t offsetNs);
+  int64_t baselineOffset() const;
+
+  static Percentiles percentilesOf(const LatencyHistogram &h);
+
+  mutable std::mutex m_mutex;
+  double m_nsPerTick = 1.0;
+
+  uint64_t m_frames = 0;
+  uint64_t m_lostFrames = 0;
+  uint64_t m_gapEvents = 0;
+  uint64_t m_largestGap = 0;
+  uint64_t m_counterResets = 0;
+  uint32_t m_firstFrameNum = 0;
+  uint32_t m_lastFrameNum = 0;
+  int64_t m_firstHostNs = 0;
+  int64_t m_lastHostNs = 0;
+  uint64_t m_lastDevTimestamp = 0;
+
+  // 最近 kBaselineWindowNs 内 offset 的单调递增队列（环形缓冲，容量固定）
+  std::vector<OffsetSample> m_window;
+  std::size_t m_windowHead = 0;
+  std::size_t m_windowSize = 0;
+
+  LatencyHistogram m_latency;
+  LatencyHistogram m_interval;
+  LatencyHistogram m_jitter;
+};
+
+#endif // FRAMETELEMETRY_H
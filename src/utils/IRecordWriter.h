@@ -0,0 +1,67 @@
+#ifndef IRECORDWRITER_H
+#define IRECORDWRITER_H
+
+#include "RecordFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 录制容器写入器接口（无 Qt/SDK 依赖）
+ *
+ * 录制阶段只认这个接口，容器由录制文件的扩展名决定（openRecorder）：
+ * - AviWriter：未压缩 AVI + OpenDML，通用播放器能打开
+ * - WvrWriter：WormVision 原始容器，任意像素格式原样落盘，带逐帧元数据
+ *
+ * 落盘都经 RecordFile：writeFrame 只把帧拷进写缓冲，写盘在它自己的线程上，
+ * 磁盘停顿不直接变成录制阶段的停顿。
+ *
+ * 约定：输入帧紧排、自顶向下；非线程安全，调用方串行调用；
+ * 出错返回 false，error() 给出最近一次的原因。
+ */
+class IRecordWriter {
+public:
+  // 录制格式：open 之后不变
+  struct Format {
+    int width = 0;
+    int height = 0;
+    uint32_t pixelType = 0; // 海康 MvGvspPixelType
+    double fps = 30.0;
+  };
+
+  // 一帧的采集信息；没有逐帧元数据的容器（AVI）忽略
+  struct FrameMeta {
+    uint64_t frameNum = 0;     // 相机帧号
+    uint64_t devTimestamp = 0; // 设备时间戳
+    int64_t grabTimeNs = 0;    // 主机取到帧的 steady_clock 纳秒
+  };
+
+  virtual ~IRecordWriter() = default;
+
+  // 日志里用的容器名，如 "AVI"
+  virtual const char *containerName() const = 0;
+
+  // 创建文件并写好文件头（已有文件会被覆盖）；path 为 UTF-8，
+  // file 是写缓冲 / 直接 I/O / 预分配设置
+  virtual bool open(const std::string &path, const Format &format,
+                    const RecordFile::Options &file) = 0;
+  // open 之后一帧输入的字节数
+  virtual std::size_t frameBytes() const = 0;
+  // 追加一帧；bytes 必须等于 frameBytes()，不符只丢这一帧
+  virtual bool writeFrame(const uint8_t *data, std::size_t bytes,
+                          const FrameMeta &meta) = 0;
+  // 同步收尾并关闭：返回时文件已完整。未打开时返回 true
+  virtual bool close() = 0;
+
+  virtual bool isOpen() const = 0;
+  virtual const std::string &error() const = 0;
+  // 已写入的帧数 / 字节数；close 之后仍有效
+  virtual uint64_t frameCount() const = 0;
+  virtual uint64_t fileBytes() const = 0;
+  // 一行摘要（块数、索引数等），关闭时写日志
+  virtual std::string summary() const = 0;
+  // 写盘统计（MB/s、最长单次写、缓冲高水位）；close 之后仍有效
+  virtual RecordFile::Stats fileStats() const = 0;
+};
+
+#endif // IRECORDWRITER_H
@@ -0,0 +1,79 @@
+#ifndef LATESTFRAMEMAILBOX_H
+#define LATESTFRAMEMAILBOX_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief "最新一帧"信箱：三缓冲，单写者 / 单读者，写端永不阻塞
+ *
+ * grab 线程每帧 publish() 只是把句柄 move 进自己的 back 槽，再用一次原子
+ * exchange 和 middle 槽交换 —— 对 FrameRef 而言就是指针交换，不拷贝像素。
+ * 读端（抓拍）需要时 acquire() 把 middle 换到 front 拿到最新帧，
+ * 真正的像素拷贝只在用户点抓拍时发生一次。
+ *
+ * 未被读走就被覆盖的旧帧在写端释放（对 FrameRef 即引用计数减一），
+ * 所以信箱最多同时持有 2 帧（middle + front）。
+ * 多个读线程需要调用方自己加锁串行化 acquire()。
+ */
+template <typename T> class LatestFrameMailbox {
+public:
+  LatestFrameMailbox() = default;
+
+  LatestFrameMailbox(const LatestFrameMailbox &) = delete;
+  LatestFrameMailbox &operator=(const LatestFrameMailbox &) = delete;
+
+  // 仅写线程调用
+  void publish(T value) {
+    m_slots[m_back] = std::move(value);
+    const uint8_t old =
+        m_middle.exchange(m_back | kFreshBit, std::memory_order_acq_rel);
+    m_back = old & kIndexMask;
+    // 换回来的槽里是没人读过的旧帧，立即释放，不让它占着缓冲
+    m_slots[m_back] = T();
+  }
+
+  /**
+   * @brief 取最新一帧（仅读线程调用）
+   * @return 自上次 acquire 以来有新帧时返回 true；
+   *         无论是否有新帧，out 都是当前已知的最新一帧（可能为空）
+   */
+  bool acquire(T &out) {
+    bool fresh = false;
+    if (m_middle.load(std::memory_order_relaxed) & kFreshBit) {
+      const uint8_t old = m_middle.exchange(m_front, std::memory_order_acq_rel);
+      m_front = old & kIndexMask;
+      fresh = true;
+    }
+    out = m_slots[m_front];
+    return fresh;
+  }
+
+  // 读端释放自己持有的 front 帧；写端释放交给 clear()
+  void releaseReader() { m_slots[m_front] = T(); }
+
+  // 两端都停下后调用，释放所有槽
+  void clear() {
+    for (T &slot : m_slots)
+      slot = T();
+    m_middle.store(1, std::memory_order_relaxed);
+    m_back = 0;
+    m_front = 2;
+  }
+
+  bool hasFresh() const {
+    return (m_middle.load(std::memory_order_acquire) & kFreshBit) != 0;
+  }
+
+private:
+  static constexpr uint8_t kFreshBit = 0x4;
+  static constexpr uint8_t kIndexMask = 0x3;
+
+  T m_slots[3]{};
+  std::atomic<uint8_t> m_middle{1};
+  uint8_t m_back = 0;  // 写端私有
+  uint8_t m_front = 2; // 读端私有
+};
+
+#endif // LATESTFRAMEMAILBOX_H
@@ -0,0 +1,532 @@
+#include "LosslessCodec.h"
+#include "PixelFormats.h"
+#include "TilePool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace LosslessCodec {
+
+namespace {
+
+struct StreamHeader {
+  uint32_t magic; // kStreamMagic
+  uint8_t bytesPerSample;
+  uint8_t xStep;
+  uint8_t yStep;
+  uint8_t reserved;
+  uint32_t samplesPerRow;
+  uint32_t rows;
+  uint32_t stripRows;
+  uint32_t stripCount;
+};
+static_assert(sizeof(StreamHeader) == 24, "StreamHeader 布局");
+
+constexpr uint32_t kStreamMagic = 0x434C5657; // "WVLC"
+constexpr uint32_t kRawStrip = 0x80000000u;   // 条带表：原样存
+constexpr int kEscape = 24;  // 商达到这个数就转义成原值
+constexpr int kCodeBits = 5; // 块参数：0 = 全 0，否则 k + 1
+// 一块的最长码长（字节）：编码时每块开始前按它检查暂存区
+constexpr std::size_t kMaxBlockBytes =
+    (kCodeBits + kBlockSamples * (kEscape + 16)) / 8 + 1;
+
+template <typename T> constexpr int sampleBits() {
+  return static_cast<int>(sizeof(T)) * 8;
+}
+
+inline int countLeadingZeros(uint64_t v) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index = 0;
+  _BitScanReverse64(&index, v);
+  return 63 - static_cast<int>(index);
+#else
+  return __builtin_clzll(v);
+#endif
+}
+
+inline uint64_t load64BigEndian(const uint8_t *p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+#if defined(_MSC_VER) && !defined(__clang__)
+  return _byteswap_uint64(v);
+#else
+  return __builtin_bswap64(v);
+#endif
+}
+
+// 高位在前的位流写出：攒满 32 位写一次
+class BitWriter {
+public:
+  explicit BitWriter(uint8_t *out) : m_begin(out), m_out(out) {}
+
+  // n <= 32，value < 2^n
+  void put(uint32_t value, int n) {
+    m_acc = (m_acc << n) | value;
+    m_bits += n;
+    if (m_bits >= 32) {
+      m_bits -= 32;
+      const uint32_t word = static_cast<uint32_t>(m_acc >> m_bits);
+      m_out[0] = static_cast<uint8_t>(word >> 24);
+      m_out[1] = static_cast<uint8_t>(word >> 16);
+      m_out[2] = static_cast<uint8_t>(word >> 8);
+      m_out[3] = static_cast<uint8_t>(word);
+      m_out += 4;
+    }
+  }
+
+  // 已写出的字节 + 还在累加器里的（上界）
+  std::size_t bytes() const {
+    return static_cast<std::size_t>(m_out - m_begin) + 4;
+  }
+
+  // 补 0 到整字节并写出，返回总字节数
+  std::size_t finish() {
+    if (m_bits % 8 != 0)
+      put(0, 8 - m_bits % 8);
+    while (m_bits > 0) {
+      m_bits -= 8;
+      *m_out++ = static_cast<uint8_t>(m_acc >> m_bits);
+    }
+    return static_cast<std::size_t>(m_out - m_begin);
+  }
+
+private:
+  uint8_t *m_begin;
+  uint8_t *m_out;
+  uint64_t m_acc = 0;
+  int m_bits = 0; // m_acc 低位里还没写出的位数（< 32）
+};
+
+// 高位在前的位流读取：refill 后累加器里至少 56 位有效
+class BitReader {
+public:
+  BitReader(const uint8_t *data, std::size_t bytes)
+      : m_begin(data), m_p(data), m_end(data + bytes) {}
+
+  void refill() {
+    if (m_end - m_p >= 8) {
+      // 一次读 8 字节，只算进整字节；多读的部分下次会原样再或一遍
+      m_acc |= load64BigEndian(m_p) >> m_bits;
+      const int bytes = (63 - m_bits) >> 3;
+      m_p += bytes;
+      m_bits += bytes * 8;
+      return;
+    }
+    while (m_bits <= 56) {
+      uint64_t b = 0;
+      if (m_p < m_end)
+        b = *m_p++;
+      else
+        ++m_padded;
+      m_acc |= b << (56 - m_bits);
+      m_bits += 8;
+    }
+  }
+
+  uint64_t peek() const { return m_acc; }
+  void skip(int n) {
+    m_acc <<= n;
+    m_bits -= n;
+  }
+  // n <= 32；n = 0 时返回 0（两次移位，避免移 64 位）
+  uint32_t get(int n) {
+    const uint32_t v = static_cast<uint32_t>((m_acc >> 1) >> (63 - n));
+    skip(n);
+    return v;
+  }
+
+  // 没有读过码流末尾
+  bool ok() const {
+    const uint64_t loaded =
+        uint64_t(m_p - m_begin) + m_padded; // 读进累加器的字节
+    return loaded * 8 - uint64_t(m_bits) <= uint64_t(m_end - m_begin) * 8;
+  }
+
+private:
+  const uint8_t *m_begin;
+  const uint8_t *m_p;
+  const uint8_t *m_end;
+  uint64_t m_acc = 0;
+  int m_bits = 0;
+  uint64_t m_padded = 0; // 码流末尾之后补的 0 字节
+};
+
+// MED 预测：左 a、上 b、左上 c。等价于把 a + b - c 夹到 [min(a,b), max(a,b)]。
+// 噪声画面上比较的结果基本猜不中，min / max 用符号掩码算，不让编译器生成分支
+inline uint32_t med(int a, int b, int c) {
+  const int d = a - b;
+  const int m = d & (d >> 31); // a < b 时为 a - b，否则 0
+  const int lo = b + m;
+  const int hi = a - m;
+  return static_cast<uint32_t>(std::min(std::max(a + b - c, lo), hi));
+}
+
+// 按采样位宽回绕的差值 → 0, -1, 1, -2, … 映射成 0, 1, 2, 3, …
+template <typename T> inline uint32_t zigzag(uint32_t diff) {
+  constexpr int bits = sampleBits<T>();
+  constexpr uint32_t mask = (1u << bits) - 1;
+  diff &= mask;
+  return ((diff << 1) ^ (0u - (diff >> (bits - 1)))) & mask;
+}
+
+inline uint32_t unzigzag(uint32_t m) { return (m >> 1) ^ (0u - (m & 1)); }
+
+const uint8_t *rowAt(const Layout &l, const uint8_t *frame, int y) {
+  return frame + std::size_t(y) * l.rowBytes();
+}
+
+// 一行的残差。up 为 nullptr 表示条带开头没有上邻的行：只用左邻，
+// 行首 xStep 个采样用上邻（没有时为 0）。分成无分支的几段，编译器能向量化
+template <typename T>
+void residualRow(const T *row, const T *up, int width, int xStep,
+                 uint16_t *out) {
+  const int head = std::min(xStep, width);
+  for (int x = 0; x < head; ++x)
+    out[x] = static_cast<uint16_t>(
+        zigzag<T>(uint32_t(row[x]) - (up ? uint32_t(up[x]) : 0u)));
+  if (!up) {
+    for (int x = head; x < width; ++x)
+      out[x] = static_cast<uint16_t>(
+          zigzag<T>(uint32_t(row[x]) - uint32_t(row[x - xStep])));
+    return;
+  }
+  for (int x = head; x < width; ++x)
+    out[x] = static_cast<uint16_t>(zigzag<T>(
+        uint32_t(row[x]) -
+        med(row[x - xStep], up[x], up[x - xStep])));
+}
+
+// 由残差还原一行（residualRow 的逆），预测依赖刚还原的左邻，只能串行
+template <typename T>
+void reconstructRow(T *row, const T *up, int width, int xStep,
+                    const uint16_t *residuals) {
+  const int head = std::min(xStep, width);
+  for (int x = 0; x < head; ++x)
+    row[x] = static_cast<T>((up ? uint32_t(up[x]) : 0u) +
+                            unzigzag(residuals[x]));
+  if (!up) {
+    for (int x = head; x < width; ++x)
+      row[x] = static_cast<T>(uint32_t(row[x - xStep]) +
+                              unzigzag(residuals[x]));
+    return;
+  }
+  if (xStep == 1) {
+    // 左邻留在寄存器里，不经过刚写出的内存再读回来
+    int a = row[0];
+    for (int x = 1; x < width; ++x) {
+      a = static_cast<T>(med(a, up[x], up[x - 1]) + unzigzag(residuals[x]));
+      row[x] = static_cast<T>(a);
+    }
+    return;
+  }
+  for (int x = head; x < width; ++x)
+    row[x] = static_cast<T>(med(row[x - xStep], up[x], up[x - xStep]) +
+                            unzigzag(residuals[x]));
+}
+
+// 编码 [y0, y1) 行；码长超过 capacity - kMaxBlockBytes 时放弃，返回 0。
+// residuals 是一行的暂存
+template <typename T>
+std::size_t encodeStrip(const Layout &l, const uint8_t *frame, int y0, int y1,
+                        uint8_t *out, std::size_t capacity,
+                        uint16_t *residuals) {
+  constexpr int bits = sampleBits<T>();
+  const int width = l.samplesPerRow;
+  BitWriter writer(out);
+  for (int y = y0; y < y1; ++y) {
+    const T *row = reinterpret_cast<const T *>(rowAt(l, frame, y));
+    const T *up = nullptr;
+    if (y - y0 >= l.yStep)
+      up = reinterpret_cast<const T *>(rowAt(l, frame, y - l.yStep));
+    residualRow(row, up, width, l.xStep, residuals);
+    for (int x0 = 0; x0 < width; x0 += kBlockSamples) {
+      if (writer.bytes() + kMaxBlockBytes > capacity)
+        return 0;
+      const int n = std::min(kBlockSamples, width - x0);
+      const uint16_t *r = residuals + x0;
+      uint32_t sum = 0;
+      for (int i = 0; i < n; ++i)
+        sum += r[i];
+      if (sum == 0) {
+        writer.put(0, kCodeBits);
+        continue;
+      }
+      // k ≈ log2(块内均值)
+      int k = 0;
+      while (k < bits && (uint32_t(n) << (k + 1)) <= sum)
+        ++k;
+      writer.put(uint32_t(k + 1), kCodeBits);
+      const uint32_t lowMask = (1u << k) - 1;
+      for (int i = 0; i < n; ++i) {
+        const uint32_t q = uint32_t(r[i]) >> k;
+        if (q < uint32_t(kEscape)) {
+          // q 个 0、一个 1、k 位余数：q + 1 + k ≤ 24 + 16，超过 32 位时分两次
+          const int len = static_cast<int>(q) + 1 + k;
+          if (len <= 32) {
+            writer.put((1u << k) | (r[i] & lowMask), len);
+          } else {
+            writer.put(1, static_cast<int>(q) + 1);
+            writer.put(r[i] & lowMask, k);
+          }
+        } else {
+          writer.put(0, kEscape);
+          writer.put(r[i], bits);
+        }
+      }
+    }
+  }
+  return writer.finish();
+}
+
+template <typename T>
+bool decodeStrip(const Layout &l, const uint8_t *src, std::size_t bytes,
+                 uint8_t *frame, int y0, int y1) {
+  constexpr int bits = sampleBits<T>();
+  const int width = l.samplesPerRow;
+  BitReader reader(src, bytes);
+  // 先把一行的残差全部读出来，再一遍还原：位流解析和预测互不打断
+  std::vector<uint16_t> residuals(static_cast<std::size_t>(width));
+  for (int y = y0; y < y1; ++y) {
+    T *row = reinterpret_cast<T *>(frame + std::size_t(y) * l.rowBytes());
+    const T *up = y - y0 >= l.yStep ? row - std::size_t(l.yStep) * width
+                                    : nullptr;
+    for (int x0 = 0; x0 < width; x0 += kBlockSamples) {
+      const int n = std::min(kBlockSamples, width - x0);
+      uint16_t *r = residuals.data() + x0;
+      reader.refill();
+      const uint32_t code = reader.get(kCodeBits);
+      if (code == 0) {
+        std::fill(r, r + n, uint16_t(0));
+        continue;
+      }
+      const int k = static_cast<int>(code) - 1;
+      if (k > bits)
+        return false;
+      for (int i = 0; i < n; ++i) {
+        reader.refill();
+        // 累加器全 0 时按 63 个前导 0 算，同样落到转义
+        const int zeros = countLeadingZeros(reader.peek() | 1);
+        uint32_t m;
+        if (zeros >= kEscape) {
+          reader.skip(kEscape);
+          m = reader.get(bits);
+        } else {
+          reader.skip(zeros + 1);
+          m = (uint32_t(zeros) << k) | reader.get(k);
+        }
+        r[i] = static_cast<uint16_t>(m);
+      }
+    }
+    reconstructRow(row, up, width, l.xStep, residuals.data());
+  }
+  return reader.ok();
+}
+
+bool validLayout(const Layout &l) {
+  return (l.bytesPerSample == 1 || l.bytesPerSample == 2) &&
+         l.samplesPerRow > 0 && l.rows > 0 && l.xStep >= 1 &&
+         l.xStep <= 255 && l.yStep >= 1 && l.yStep <= 255;
+}
+
+int stripRowsFor(const Layout &l) {
+  return (kStripRows + l.yStep - 1) / l.yStep * l.yStep;
+}
+
+} // namespace
+
+bool layoutFor(uint32_t pixelType, int width, int height, Layout *out) {
+  using namespace PixelFormats;
+  const Descriptor *d = find(pixelType);
+  const std::size_t bytes = frameBytes(pixelType, width, height);
+  if (!d || bytes == 0 || bytes % std::size_t(height) != 0)
+    return false;
+  const std::size_t rowBytes = bytes / std::size_t(height);
+
+  Layout l;
+  const bool bayer = d->family == Family::Bayer;
+  if (d->packing == Packing::Packed) {
+    // 两个像素 3 字节：同一像素的高 8 位隔 3 个字节
+    l.bytesPerSample = 1;
+    l.xStep = 3;
+  } else if (d->family == Family::Rgb) {
+    l.bytesPerSample = 1;
+    l.xStep = 3;
+  } else if (d->family == Family::Yuv) {
+    l.bytesPerSample = 1;
+    l.xStep = 4; // UYVY / YUYV：U、V 每 4 字节一个
+  } else {
+    l.bytesPerSample = d->bitsPerPixel / 8;
+    l.xStep = bayer ? 2 : 1;
+  }
+  l.yStep = bayer ? 2 : 1;
+  if (rowBytes % std::size_t(l.bytesPerSample) != 0)
+    return false;
+  l.samplesPerRow = static_cast<int>(rowBytes / l.bytesPerSample);
+  l.rows = height;
+  if (!validLayout(l))
+    return false;
+  *out = l;
+  return true;
+}
+
+std::size_t maxEncodedBytes(const Layout &layout) {
+  if (!validLayout(layout))
+    return 0;
+  const int stripRows = stripRowsFor(layout);
+  const std::size_t strips =
+      std::size_t((layout.rows + stripRows - 1) / stripRows);
+  return sizeof(StreamHeader) + strips * sizeof(uint32_t) +
+         layout.frameBytes();
+}
+
+bool Encoder::configure(const Layout &layout) {
+  if (!validLayout(layout))
+    return false;
+  m_layout = layout;
+  m_stripRows = stripRowsFor(layout);
+  m_strips = (layout.rows + m_stripRows - 1) / m_stripRows;
+  // 每条带的暂存区比原样略大：码长一超过原样就放弃，多出来的是一块的余量
+  m_stripCapacity =
+      (std::size_t(m_stripRows) * layout.rowBytes() + kMaxBlockBytes + 8 +
+       63) &
+      ~std::size_t(63);
+  m_scratch.assign(std::size_t(m_strips) * m_stripCapacity, 0);
+  m_residuals.assign(std::size_t(m_strips) * std::size_t(layout.samplesPerRow),
+                     0);
+  m_stripEntries.assign(std::size_t(m_strips), 0);
+  m_head.assign(sizeof(StreamHeader) + std::size_t(m_strips) * sizeof(uint32_t),
+                0);
+
+  StreamHeader header{};
+  header.magic = kStreamMagic;
+  header.bytesPerSample = static_cast<uint8_t>(layout.bytesPerSample);
+  header.xStep = static_cast<uint8_t>(layout.xStep);
+  header.yStep = static_cast<uint8_t>(layout.yStep);
+  header.samplesPerRow = static_cast<uint32_t>(layout.samplesPerRow);
+  header.rows = static_cast<uint32_t>(layout.rows);
+  header.stripRows = static_cast<uint32_t>(m_stripRows);
+  header.stripCount = static_cast<uint32_t>(m_strips);
+  std::memcpy(m_head.data(), &header, sizeof(header));
+
+  m_pieces.clear();
+  m_pieces.reserve(std::size_t(m_strips) + 1);
+  m_encodedBytes = 0;
+  return true;
+}
+
+std::size_t Encoder::encode(const uint8_t *frame, TilePool *pool) {
+  const Layout &l = m_layout;
+  auto encodeStrips = [&](int s0, int s1) {
+    for (int s = s0; s < s1; ++s) {
+      const int y0 = s * m_stripRows;
+      const int y1 = std::min(l.rows, y0 + m_stripRows);
+      const std::size_t rawBytes = std::size_t(y1 - y0) * l.rowBytes();
+      uint8_t *out = m_scratch.data() + std::size_t(s) * m_stripCapacity;
+      uint16_t *residuals =
+          m_residuals.data() + std::size_t(s) * std::size_t(l.samplesPerRow);
+      const std::size_t n =
+          l.bytesPerSample == 1
+              ? encodeStrip<uint8_t>(l, frame, y0, y1, out, m_stripCapacity,
+                                     residuals)
+              : encodeStrip<uint16_t>(l, frame, y0, y1, out, m_stripCapacity,
+                                      residuals);
+      m_stripEntries[std::size_t(s)] =
+          n == 0 || n >= rawBytes ? uint32_t(rawBytes) | kRawStrip
+                                  : uint32_t(n);
+    }
+  };
+  if (pool)
+    pool->run(m_strips, 1, encodeStrips);
+  else
+    encodeStrips(0, m_strips);
+
+  std::memcpy(m_head.data() + sizeof(StreamHeader), m_stripEntries.data(),
+              m_stripEntries.size() * sizeof(uint32_t));
+  m_pieces.clear();
+  m_pieces.push_back({m_head.data(), m_head.size()});
+  m_encodedBytes = m_head.size();
+  for (int s = 0; s < m_strips; ++s) {
+    const uint32_t entry = m_stripEntries[std::size_t(s)];
+    const std::size_t n = entry & ~kRawStrip;
+    const uint8_t *data =
+        entry & kRawStrip
+            ? rowAt(l, frame, s * m_stripRows)
+            : m_scratch.data() + std::size_t(s) * m_stripCapacity;
+    m_pieces.push_back({data, n});
+    m_encodedBytes += n;
+  }
+  return m_encodedBytes;
+}
+
+bool decode(const Layout &layout, const uint8_t *src, std::size_t bytes,
+            uint8_t *dst, TilePool *pool) {
+  if (!validLayout(layout) || bytes < sizeof(StreamHeader))
+    return false;
+  StreamHeader header;
+  std::memcpy(&header, src, sizeof(header));
+  if (header.magic != kStreamMagic ||
+      header.bytesPerSample != layout.bytesPerSample ||
+      header.xStep != layout.xStep || header.yStep != layout.yStep ||
+      header.samplesPerRow != uint32_t(layout.samplesPerRow) ||
+      header.rows != uint32_t(layout.rows) || header.stripRows == 0 ||
+      header.stripCount !=
+          (uint64_t(header.rows) + header.stripRows - 1) / header.stripRows)
+    return false;
+  const std::size_t tableBytes =
+      std::size_t(header.stripCount) * sizeof(uint32_t);
+  if (bytes - sizeof(header) < tableBytes)
+    return false;
+
+  // 条带起点：先串行把表走一遍，越界的码流在这里就拒掉
+  const int strips = static_cast<int>(header.stripCount);
+  const int stripRows = static_cast<int>(
+      std::min<uint32_t>(header.stripRows, uint32_t(layout.rows)));
+  std::vector<uint32_t> entries(static_cast<std::size_t>(strips));
+  std::memcpy(entries.data(), src + sizeof(header), tableBytes);
+  std::vector<std::size_t> offsets(std::size_t(strips) + 1);
+  offsets[0] = sizeof(header) + tableBytes;
+  for (int s = 0; s < strips; ++s) {
+    const uint32_t entry = entries[std::size_t(s)];
+    const std::size_t n = entry & ~kRawStrip;
+    if (entry & kRawStrip) {
+      const int y0 = s * stripRows;
+      const int y1 = std::min(layout.rows, y0 + stripRows);
+      if (n != std::size_t(y1 - y0) * layout.rowBytes())
+        return false;
+    }
+    if (n > bytes - offsets[std::size_t(s)])
+      return false;
+    offsets[std::size_t(s) + 1] = offsets[std::size_t(s)] + n;
+  }
+
+  std::atomic<bool> ok{true};
+  auto decodeStrips = [&](int s0, int s1) {
+    for (int s = s0; s < s1; ++s) {
+      const int y0 = s * stripRows;
+      const int y1 = std::min(layout.rows, y0 + stripRows);
+      const uint8_t *data = src + offsets[std::size_t(s)];
+      const std::size_t n = entries[std::size_t(s)] & ~kRawStrip;
+      if (entries[std::size_t(s)] & kRawStrip) {
+        std::memcpy(dst + std::size_t(y0) * layout.rowBytes(), data, n);
+        continue;
+      }
+      const bool stripOk =
+          layout.bytesPerSample == 1
+              ? decodeStrip<uint8_t>(layout, data, n, dst, y0, y1)
+              : decodeStrip<uint16_t>(layout, data, n, dst, y0, y1);
+      if (!stripOk)
+        ok = false;
+    }
+  };
+  if (pool)
+    pool->run(strips, 1, decodeStrips);
+  else
+    decodeStrips(0, strips);
+  return ok;
+}
+
+} // namespace LosslessCodec
@@ -0,0 +1,103 @@
+#ifndef LOSSLESSCODEC_H
+#define LOSSLESSCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TilePool;
+
+/**
+ * @brief 帧内无损压缩：中值预测 + 分块自适应 Rice 编码（无 Qt/SDK 依赖）
+ *
+ * 5 MP 黑白 60 fps 未压缩约 300 MB/s，普通工作站磁盘撑不了几个小时；
+ * SDK 的码率路径又是有损的。琼脂背景大片平坦、噪声只有几个灰阶，
+ * 预测残差几乎都落在 0 附近，简单的熵编码就能压到原来的几分之一。
+ *
+ * - 预测：JPEG-LS 的 MED（左 a、上 b、左上 c：c ≥ max(a,b) 取 min，
+ *   c ≤ min(a,b) 取 max，否则 a + b − c）。邻居按同颜色 / 同分量取：
+ *   Bayer 左右隔一个、上下隔一行，RGB / 打包格式按字节隔 3 个，见 Layout
+ * - 残差按采样位宽回绕后 zigzag 成无符号数
+ * - 每行按 32 个采样分块，每块选一个 Rice 参数 k（5 位），全 0 的块只占
+ *   这 5 位；商超过 24 时转义成原值，单个采样的码长有上限
+ * - 帧按 64 行切成互不依赖的条带（每条带开头几行只用左邻），编码 / 解码
+ *   都可以按条带分给 TilePool；条带编出来比原样还大时原样存
+ *
+ * 码流（小端）：StreamHeader，条带表（每条带 uint32：低 31 位字节数，
+ * 最高位 = 原样存），然后各条带首尾相接。条带的位流按高位在前。
+ *
+ * 线程：Encoder 非线程安全（一个写入器一个）；decode 无共享状态。
+ */
+namespace LosslessCodec {
+
+// 一帧按采样看的排列：行与行紧挨着，没有行填充
+struct Layout {
+  int bytesPerSample = 1; // 1，或 2（小端 16 位容器）
+  int samplesPerRow = 0;
+  int rows = 0;
+  int xStep = 1; // 同颜色 / 同分量左邻的距离（采样数）
+  int yStep = 1; // 同颜色上邻的距离（行数）
+
+  std::size_t rowBytes() const {
+    return std::size_t(samplesPerRow) * bytesPerSample;
+  }
+  std::size_t frameBytes() const { return rowBytes() * rows; }
+};
+
+constexpr int kStripRows = 64;    // 每条带行数（不足 yStep 的整数倍时取整）
+constexpr int kBlockSamples = 32; // 每块采样数，块内共用一个 Rice 参数
+
+/**
+ * @brief 按像素格式排列采样：8 位 Mono / Bayer / RGB / YUV 按字节，
+ * 10/12/16 位非打包按 16 位，打包格式按字节（同一像素的字节隔 3 个）
+ * @return 不认识的格式，或一帧不能整除成行（打包格式宽度为奇数）时 false
+ */
+bool layoutFor(uint32_t pixelType, int width, int height, Layout *out);
+
+// 一帧编码后的最大字节数（全部条带原样存 + 流头 + 条带表）
+std::size_t maxEncodedBytes(const Layout &layout);
+
+class Encoder {
+public:
+  // 码流分段：流头 + 条带表，然后各条带；顺序拼起来就是完整的一帧
+  struct Piece {
+    const uint8_t *data = nullptr;
+    std::size_t bytes = 0;
+  };
+
+  // 按排列分配暂存区；排列不合法返回 false
+  bool configure(const Layout &layout);
+  const Layout &layout() const { return m_layout; }
+
+  /**
+   * @brief 编码一帧（layout().frameBytes() 字节），返回码流总字节数
+   * pool 为 nullptr 时在调用线程上串行。pieces() 指向内部暂存区和
+   * frame（原样存的条带不拷贝），下次 encode 前、frame 释放前有效
+   */
+  std::size_t encode(const uint8_t *frame, TilePool *pool = nullptr);
+  const std::vector<Piece> &pieces() const { return m_pieces; }
+  std::size_t encodedBytes() const { return m_encodedBytes; }
+
+private:
+  Layout m_layout;
+  int m_stripRows = 0;
+  int m_strips = 0;
+  std::size_t m_stripCapacity = 0; // 每条带在暂存区里占的字节
+  std::vector<uint8_t> m_head;     // 流头 + 条带表
+  std::vector<uint8_t> m_scratch;  // 各条带的编码结果
+  std::vector<uint16_t> m_residuals; // 每条带一行残差
+  std::vector<uint32_t> m_stripEntries;
+  std::vector<Piece> m_pieces;
+  std::size_t m_encodedBytes = 0;
+};
+
+/**
+ * @brief 解码一帧到 dst（layout.frameBytes() 字节）
+ * 码流和 layout 不符、条带越界、位流读过头都返回 false（dst 内容未定义）
+ */
+bool decode(const Layout &layout, const uint8_t *src, std::size_t bytes,
+            uint8_t *dst, TilePool *pool = nullptr);
+
+} // namespace LosslessCodec
+
+#endif // LOSSLESSCODEC_H
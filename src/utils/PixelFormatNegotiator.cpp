@@ -0,0 +1,168 @@
+#include "PixelFormatNegotiator.h"
+#include <algorithm>
+
+namespace PixelFormatNegotiator {
+
+namespace {
+
+// 每像素转换开销（ns），单核 MV_CC_ConvertPixelType 的量级
+constexpr double kDemosaicToBgrNs = 3.0; // Bayer 插值出三通道
+constexpr double kBayerDisplayNs = 2.5;  // SDK 渲染前的插值
+constexpr double kBayerToMonoNs = 1.2;   // 插值后只取亮度
+constexpr double kRgbToMonoNs = 0.9;
+constexpr double kYuvToMonoNs = 0.3;     // 只取 Y
+constexpr double kYuvDisplayNs = 0.6;
+constexpr double kUnpack16Ns = 0.5;      // 10/12 位移位到 8 位
+constexpr double kUnpackPackedNs = 0.8;  // 12 位紧凑排列先拆包
+
+double unpackNs(const FormatTraits &f) {
+  if (f.family != Family::Mono && f.family != Family::Bayer)
+    return 0.0;
+  if (f.packing == PixelFormats::Packing::Packed)
+    return kUnpackPackedNs;
+  return f.sampleBits > 8 ? kUnpack16Ns : 0.0;
+}
+
+double convertNsPerPixel(const FormatTraits &f, Workflow workflow,
+                         uint32_t target) {
+  if (workflow == Workflow::Preview) {
+    switch (f.family) {
+    case Family::Mono:
+      return unpackNs(f);
+    case Family::Bayer:
+      return kBayerDisplayNs + unpackNs(f);
+    case Family::Rgb:
+      return 0.0;
+    case Family::Yuv:
+      return kYuvDisplayNs;
+    }
+  }
+  if (target == f.pixelType)
+    return 0.0;
+  if (target == kMono8) {
+    switch (f.family) {
+    case Family::Mono:
+      return unpackNs(f);
+    case Family::Bayer:
+      return kBayerToMonoNs + unpackNs(f);
+    case Family::Rgb:
+      return kRgbToMonoNs;
+    case Family::Yuv:
+      return kYuvToMonoNs;
+    }
+  }
+  // 转 BGR8
+  return kDemosaicToBgrNs + unpackNs(f);
+}
+
+bool isColor(const FormatTraits &f) { return f.family != Family::Mono; }
+
+bool isHighDepth(const FormatTraits &f) {
+  return f.sampleBits > 8 &&
+         (f.family == Family::Mono || f.family == Family::Bayer);
+}
+
+} // namespace
+
+const FormatTraits *traits(uint32_t pixelType) {
+  return PixelFormats::find(pixelType);
+}
+
+uint32_t recordPixelType(uint32_t pixelType, Workflow workflow) {
+  const FormatTraits *f = traits(pixelType);
+  if (!f)
+    return kBgr8;
+  const bool direct = f->recordable;
+  switch (workflow) {
+  case Workflow::MonoRecording:
+  case Workflow::HighDepthRecording:
+    return kMono8;
+  case Workflow::ColorRecording:
+    if (f->family == Family::Mono)
+      return kMono8;
+    return direct ? pixelType : kBgr8;
+  case Workflow::Preview:
+    break;
+  }
+  return direct ? pixelType : kBgr8;
+}
+
+Choice evaluate(uint32_t pixelType, Workflow workflow, int width, int height,
+                double linkBytesPerSec) {
+  Choice choice;
+  const FormatTraits *f = traits(pixelType);
+  if (!f || width <= 0 || height <= 0)
+    return choice;
+  const double pixels = double(width) * height;
+  const double link =
+      linkBytesPerSec > 0.0 ? linkBytesPerSec : kDefaultLinkBytesPerSec;
+  choice.pixelType = pixelType;
+  choice.recordPixelType = recordPixelType(pixelType, workflow);
+  choice.convertUsPerFrame =
+      pixels * convertNsPerPixel(*f, workflow, choice.recordPixelType) / 1e3;
+  choice.bytesPerFrame = pixels * f->bitsPerPixel / 8.0;
+  choice.transferUsPerFrame = choice.bytesPerFrame / link * 1e6;
+  choice.costUsPerFrame = choice.convertUsPerFrame + choice.transferUsPerFrame;
+  return choice;
+}
+
+Choice negotiate(const Input &input) {
+  std::vector<uint32_t> candidates = input.supported;
+  if (candidates.empty() && input.current != 0)
+    candidates.push_back(input.current);
+
+  // 彩色录制：相机能出彩色就不退到黑白；高位深录制：相机能出高位深就不退到
+  // 8 位，其中有黑白格式时不选 Bayer
+  bool colorAvailable = false;
+  bool highDepthAvailable = false;
+  bool monoHighDepthAvailable = false;
+  for (uint32_t t : candidates) {
+    const FormatTraits *f = traits(t);
+    if (!f)
+      continue;
+    colorAvailable = colorAvailable || isColor(*f);
+    highDepthAvailable = highDepthAvailable || isHighDepth(*f);
+    monoHighDepthAvailable =
+        monoHighDepthAvailable || (isHighDepth(*f) && !isColor(*f));
+  }
+
+  Choice best;
+  for (uint32_t t : candidates) {
+    const FormatTraits *f = traits(t);
+    if (!f)
+      continue;
+    if (input.workflow == Workflow::ColorRecording && colorAvailable &&
+        !isColor(*f))
+      continue;
+    if (input.workflow == Workflow::HighDepthRecording &&
+        ((highDepthAvailable && !isHighDepth(*f)) ||
+         (monoHighDepthAvailable && isColor(*f))))
+      continue;
+    const Choice c = evaluate(t, input.workflow, input.width, input.height,
+                              input.linkBytesPerSec);
+    if (!c.valid())
+      continue;
+    const bool better =
+        !best.valid() || c.costUsPerFrame < best.costUsPerFrame ||
+        (c.costUsPerFrame == best.costUsPerFrame && t == input.current);
+    if (better)
+      best = c;
+  }
+  return best;
+}
+
+const char *workflowName(Workflow workflow) {
+  switch (workflow) {
+  case Workflow::Preview:
+    return "仅预览";
+  case Workflow::MonoRecording:
+    return "黑白录制";
+  case Workflow::ColorRecording:
+    return "彩色录制";
+  case Workflow::HighDepthRecording:
+    return "高位深录制";
+  }
+  return "";
+}
+
+} // namespace PixelFormatNegotiator
@@ -0,0 +1,91 @@
+#ifndef PIXELFORMATNEGOTIATOR_H
+#define PIXELFORMATNEGOTIATOR_H
+
+#include "PixelFormats.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 打开相机时按用途挑像素格式（纯函数，可单测）
+ *
+ * 以前像素格式沿用相机里存的值，开始录制时才发现是 Bayer，于是每帧都做一次
+ * 完整的去马赛克转 BGR8——而线虫成像实际上是黑白的。这里在打开相机时读
+ * PixelFormat 的可选值，按用途估算每个格式的代价，取最小的：
+ *
+ *   代价 = 每帧转换耗时（像素数 × 每像素转换开销）+ 每帧链路传输时间
+ *
+ * 每像素开销是按 MV_CC_ConvertPixelType 单核实测量级给的常数，只用来比较
+ * 格式之间的相对代价；带宽未知时按千兆网有效带宽计。
+ *
+ * 用途：
+ * - Preview：只预览，代价是显示前的转换（SDK 渲染 Bayer 要先插值）
+ * - MonoRecording：录黑白 AVI，Mono8 直接写；其他格式转 Mono8
+ * - ColorRecording：录彩色 AVI，RGB8 / BGR8 / YUV422 直接写，Bayer 转 BGR8；
+ *   相机有彩色格式时不选黑白格式
+ * - HighDepthRecording：荧光等要保留位深的场合，相机有 10/12/16 位格式时
+ *   只在其中选（黑白优先）；抓拍按 16 位保存。AVI 只收 8 位，录制暂时
+ *   取高 8 位写 Mono8
+ */
+namespace PixelFormatNegotiator {
+
+enum class Workflow {
+  Preview,
+  MonoRecording,
+  ColorRecording,
+  HighDepthRecording
+};
+
+using Family = PixelFormats::Family;
+using FormatTraits = PixelFormats::Descriptor;
+
+constexpr uint32_t kMono8 = PixelFormats::kMono8;
+constexpr uint32_t kBgr8 = PixelFormats::kBgr8;
+
+// 查 PixelFormats 表；不认识的格式返回 nullptr（协商时跳过）
+const FormatTraits *traits(uint32_t pixelType);
+
+struct Input {
+  std::vector<uint32_t> supported; // PixelFormat 可选值；为空时只评估 current
+  uint32_t current = 0;
+  int width = 0;
+  int height = 0;
+  double linkBytesPerSec = 0.0; // <= 0 时按 kDefaultLinkBytesPerSec
+  Workflow workflow = Workflow::MonoRecording;
+};
+
+struct Choice {
+  uint32_t pixelType = 0;       // 相机输出格式，0 表示没有可用格式
+  uint32_t recordPixelType = 0; // 录制写入格式；等于 pixelType 表示直接写
+  double convertUsPerFrame = 0.0;
+  double bytesPerFrame = 0.0;
+  double transferUsPerFrame = 0.0;
+  double costUsPerFrame = 0.0;  // convert + transfer
+
+  bool valid() const { return pixelType != 0; }
+  bool needsConvert() const { return recordPixelType != pixelType; }
+};
+
+// 千兆网扣掉协议开销后的有效带宽
+constexpr double kDefaultLinkBytesPerSec = 118e6;
+
+// 估算一个格式在该用途下的代价；不认识的格式返回 !valid()
+Choice evaluate(uint32_t pixelType, Workflow workflow, int width, int height,
+                double linkBytesPerSec);
+
+// 代价最小的格式；并列时保留 current，避免无谓地改相机设置
+Choice negotiate(const Input &input);
+
+/**
+ * @brief 录制写入格式：MonoRecording / HighDepthRecording 一律 Mono8；
+ * ColorRecording 彩色格式里
+ * SDK 能直接录的直接写、Bayer 转 BGR8、黑白格式转 Mono8；
+ * Preview（没有声明录制用途）沿用旧规则：能直接录的直接写，其余转 BGR8
+ */
+uint32_t recordPixelType(uint32_t pixelType, Workflow workflow);
+
+// 日志 / UI 用："仅预览" / "黑白录制" / "彩色录制" / "高位深录制"
+const char *workflowName(Workflow workflow);
+
+} // namespace PixelFormatNegotiator
+
+#endif // PIXELFORMATNEGOTIATOR_H
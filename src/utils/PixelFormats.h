@@ -0,0 +1,156 @@
+#ifndef PIXELFORMATS_H
+#define PIXELFORMATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 海康像素格式描述表（constexpr，无 Qt/SDK 依赖）
+ *
+ * 以前每个模块各有一份 switch：RecordingDiagnostics 判断能否直接录制、
+ * PixelFormatNegotiator 估算代价、BayerDemosaic 认排列，彼此的格式列表还不一致。
+ * 现在统一查这张表：位深、链路上的打包方式、能否直接写进 AVI、
+ * Bayer 排列。值来自 SDK PixelType.h（MvGvspPixelType）。
+ */
+namespace PixelFormats {
+
+enum class Family { Mono, Bayer, Rgb, Yuv };
+
+// 链路上的排列方式
+enum class Packing {
+  None,   // 每个采样占整字节（8 位一个字节，10/12/16 位小端 16 位容器）
+  Packed, // GigE Vision 打包：两个像素占 3 字节（10/12 位）
+};
+
+// Bayer 排列：第一行前两个像素的颜色
+enum class BayerOrder { None, RG, GR, GB, BG };
+
+struct Descriptor {
+  uint32_t pixelType;
+  const char *name;
+  Family family;
+  int bitsPerPixel; // 链路上每像素位数（Packed 为 12）
+  int sampleBits;   // 有效位深：8 / 10 / 12 / 16
+  Packing packing;
+  BayerOrder bayer;
+  bool recordable;  // AVI 录制（AviWriter）能直接写
+};
+
+constexpr uint32_t kMono8 = 0x01080001;
+constexpr uint32_t kMono10 = 0x01100003;
+constexpr uint32_t kMono10Packed = 0x010C0004;
+constexpr uint32_t kMono12 = 0x01100005;
+constexpr uint32_t kMono12Packed = 0x010C0006;
+constexpr uint32_t kMono16 = 0x01100007;
+constexpr uint32_t kRgb8 = 0x02180014;
+constexpr uint32_t kBgr8 = 0x02180015;
+
+inline constexpr Descriptor kTable[] = {
+    // pixelType   name  family  bpp  bits  packing  bayer  recordable
+    {kMono8, "Mono8", Family::Mono, 8, 8, Packing::None, BayerOrder::None,
+     true},
+    {kMono10, "Mono10", Family::Mono, 16, 10, Packing::None, BayerOrder::None,
+     false},
+    {kMono10Packed, "Mono10Packed", Family::Mono, 12, 10, Packing::Packed,
+     BayerOrder::None, false},
+    {kMono12, "Mono12", Family::Mono, 16, 12, Packing::None, BayerOrder::None,
+     false},
+    {kMono12Packed, "Mono12Packed", Family::Mono, 12, 12, Packing::Packed,
+     BayerOrder::None, false},
+    {kMono16, "Mono16", Family::Mono, 16, 16, Packing::None, BayerOrder::None,
+     false},
+
+    {0x01080008, "BayerGR8", Family::Bayer, 8, 8, Packing::None,
+     BayerOrder::GR, false},
+    {0x01080009, "BayerRG8", Family::Bayer, 8, 8, Packing::None,
+     BayerOrder::RG, false},
+    {0x0108000A, "BayerGB8", Family::Bayer, 8, 8, Packing::None,
+     BayerOrder::GB, false},
+    {0x0108000B, "BayerBG8", Family::Bayer, 8, 8, Packing::None,
+     BayerOrder::BG, false},
+    {0x0110000C, "BayerGR10", Family::Bayer, 16, 10, Packing::None,
+     BayerOrder::GR, false},
+    {0x0110000D, "BayerRG10", Family::Bayer, 16, 10, Packing::None,
+     BayerOrder::RG, false},
+    {0x0110000E, "BayerGB10", Family::Bayer, 16, 10, Packing::None,
+     BayerOrder::GB, false},
+    {0x0110000F, "BayerBG10", Family::Bayer, 16, 10, Packing::None,
+     BayerOrder::BG, false},
+    {0x01100010, "BayerGR12", Family::Bayer, 16, 12, Packing::None,
+     BayerOrder::GR, false},
+    {0x01100011, "BayerRG12", Family::Bayer, 16, 12, Packing::None,
+     BayerOrder::RG, false},
+    {0x01100012, "BayerGB12", Family::Bayer, 16, 12, Packing::None,
+     BayerOrder::GB, false},
+    {0x01100013, "BayerBG12", Family::Bayer, 16, 12, Packing::None,
+     BayerOrder::BG, false},
+    {0x010C0026, "BayerGR10Packed", Family::Bayer, 12, 10, Packing::Packed,
+     BayerOrder::GR, false},
+    {0x010C0027, "BayerRG10Packed", Family::Bayer, 12, 10, Packing::Packed,
+     BayerOrder::RG, false},
+    {0x010C0028, "BayerGB10Packed", Family::Bayer, 12, 10, Packing::Packed,
+     BayerOrder::GB, false},
+    {0x010C0029, "BayerBG10Packed", Family::Bayer, 12, 10, Packing::Packed,
+     BayerOrder::BG, false},
+    {0x010C002A, "BayerGR12Packed", Family::Bayer, 12, 12, Packing::Packed,
+     BayerOrder::GR, false},
+    {0x010C002B, "BayerRG12Packed", Family::Bayer, 12, 12, Packing::Packed,
+     BayerOrder::RG, false},
+    {0x010C002C, "BayerGB12Packed", Family::Bayer, 12, 12, Packing::Packed,
+     BayerOrder::GB, false},
+    {0x010C002D, "BayerBG12Packed", Family::Bayer, 12, 12, Packing::Packed,
+     BayerOrder::BG, false},
+
+    {kRgb8, "RGB8", Family::Rgb, 24, 8, Packing::None, BayerOrder::None, true},
+    {kBgr8, "BGR8", Family::Rgb, 24, 8, Packing::None, BayerOrder::None, true},
+    {0x0210001F, "YUV422", Family::Yuv, 16, 8, Packing::None, BayerOrder::None,
+     true},
+    {0x02100032, "YUV422_YUYV", Family::Yuv, 16, 8, Packing::None,
+     BayerOrder::None, true},
+};
+
+// 不认识的格式返回 nullptr
+constexpr const Descriptor *find(uint32_t pixelType) {
+  for (const Descriptor &d : kTable)
+    if (d.pixelType == pixelType)
+      return &d;
+  return nullptr;
+}
+
+// 有效位深超过 8 位（需要按 16 位保存才不丢信息）
+constexpr bool isHighBitDepth(uint32_t pixelType) {
+  const Descriptor *d = find(pixelType);
+  return d && d->sampleBits > 8;
+}
+
+// 一帧在链路上的字节数；不认识的格式返回 0
+constexpr std::size_t frameBytes(uint32_t pixelType, int width, int height) {
+  const Descriptor *d = find(pixelType);
+  if (!d || width <= 0 || height <= 0)
+    return 0;
+  return (std::size_t(width) * height * d->bitsPerPixel + 7) / 8;
+}
+
+// 高位深 Mono / Bayer 取高 8 位后的格式（Bayer 排列不变）；
+// 本身就是 8 位或不是 Mono / Bayer 时返回 0
+constexpr uint32_t eightBitType(uint32_t pixelType) {
+  const Descriptor *d = find(pixelType);
+  if (!d || d->sampleBits <= 8 ||
+      (d->family != Family::Mono && d->family != Family::Bayer))
+    return 0;
+  for (const Descriptor &e : kTable)
+    if (e.family == d->family && e.bayer == d->bayer && e.sampleBits == 8)
+      return e.pixelType;
+  return 0;
+}
+
+static_assert(find(kMono12Packed)->packing == Packing::Packed,
+              "Mono12Packed 必须标成打包格式");
+static_assert(frameBytes(kMono12Packed, 4, 2) == 12,
+              "打包格式 1.5 字节/像素");
+static_assert(eightBitType(0x010C002B) == 0x01080009,
+              "BayerRG12Packed 取高 8 位是 BayerRG8");
+
+} // namespace PixelFormats
+
+#endif // PIXELFORMATS_H
@@ -0,0 +1,211 @@
+#include "PixelUnpack.h"
+#include "PixelFormats.h"
+#include <type_traits>
+
+#if defined(WV_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(WV_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace PixelUnpack {
+
+namespace {
+
+struct Layout {
+  int bits;    // 有效位深
+  bool packed; // 两像素 3 字节
+};
+
+bool layoutFor(uint32_t pixelType, Layout *layout) {
+  const PixelFormats::Descriptor *d = PixelFormats::find(pixelType);
+  if (!d || d->sampleBits <= 8 ||
+      (d->family != PixelFormats::Family::Mono &&
+       d->family != PixelFormats::Family::Bayer))
+    return false;
+  layout->bits = d->sampleBits;
+  layout->packed = d->packing == PixelFormats::Packing::Packed;
+  return true;
+}
+
+// uint16_t 输出原值；uint8_t 输出高 8 位
+template <typename T> inline T narrow(unsigned v, int bits) {
+  if (std::is_same<T, uint16_t>::value)
+    return static_cast<T>(v);
+  return static_cast<T>(v >> (bits - 8));
+}
+
+template <typename T>
+void unpack16Scalar(const uint8_t *src, std::size_t i, std::size_t n, int bits,
+                    T *dst) {
+  const unsigned mask = (1u << bits) - 1;
+  for (; i < n; ++i) {
+    const unsigned v = (src[2 * i] | (unsigned(src[2 * i + 1]) << 8)) & mask;
+    dst[i] = narrow<T>(v, bits);
+  }
+}
+
+// i 必须是偶数；奇数个像素时最后一个只用到 b0 / b1
+template <typename T>
+void unpackPackedScalar(const uint8_t *src, std::size_t i, std::size_t n,
+                        int bits, T *dst) {
+  const int shift = bits - 8;
+  const unsigned low = (1u << shift) - 1;
+  for (; i < n; i += 2) {
+    const uint8_t *p = src + i / 2 * 3;
+    dst[i] = narrow<T>((unsigned(p[0]) << shift) | (p[1] & low), bits);
+    if (i + 1 < n)
+      dst[i + 1] =
+          narrow<T>((unsigned(p[2]) << shift) | ((p[1] >> 4) & low), bits);
+  }
+}
+
+#if defined(WV_SIMD_SSE2)
+
+template <typename T> inline void store8Sse2(__m128i v, int bits, T *dst) {
+  if (std::is_same<T, uint16_t>::value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), v);
+  } else {
+    v = _mm_srl_epi16(v, _mm_cvtsi32_si128(bits - 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(v, v));
+  }
+}
+
+// 非打包：每次 8 像素，返回处理到的像素
+template <typename T>
+std::size_t unpack16Sse2(const uint8_t *src, std::size_t n, int bits, T *dst) {
+  const __m128i mask = _mm_set1_epi16(short((1u << bits) - 1));
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+    store8Sse2(_mm_and_si128(v, mask), bits, dst + i);
+  }
+  return i;
+}
+
+#endif // WV_SIMD_SSE2
+
+#if defined(WV_SIMD_AVX2)
+
+template <typename T>
+WV_TARGET_AVX2 inline void store16Avx2(__m256i v, int bits, T *dst) {
+  if (std::is_same<T, uint16_t>::value) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), v);
+  } else {
+    v = _mm256_srl_epi16(v, _mm_cvtsi32_si128(bits - 8));
+    // packus 在 lane 内交错，把两个 lane 的低 64 位收拢到一起
+    const __m256i packed =
+        _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                     _mm256_castsi256_si128(packed));
+  }
+}
+
+template <typename T>
+WV_TARGET_AVX2 std::size_t unpack16Avx2(const uint8_t *src, std::size_t n,
+                                        int bits, T *dst) {
+  const __m256i mask = _mm256_set1_epi16(short((1u << bits) - 1));
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * i));
+    store16Avx2(_mm256_and_si256(v, mask), bits, dst + i);
+  }
+  return i;
+}
+
+// 打包：每个 lane 8 像素（12 字节）。pshufb 先拼出 16 位字
+//   偶数像素：(b0 << 8) | b1    奇数像素：(b2 << 8) | b1
+// 高字节左移 bits - 8 位补上 b1 里对应的低位：偶数取 b1 低 4 位，奇数取高 4 位。
+// 第二个 lane 从 src + 12 读 16 字节，所以要求源数据比消费的多 4 字节
+template <typename T>
+WV_TARGET_AVX2 std::size_t unpackPackedAvx2(const uint8_t *src,
+                                            std::size_t srcBytes,
+                                            std::size_t n, int bits, T *dst) {
+  const __m128i shuffle128 =
+      _mm_setr_epi8(1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11);
+  const __m256i shuffle = _mm256_broadcastsi128_si256(shuffle128);
+  const __m256i low = _mm256_set1_epi16(short((1u << (bits - 8)) - 1));
+  const __m128i shift = _mm_cvtsi32_si128(bits - 8);
+  std::size_t i = 0;
+  for (; i + 16 <= n && i / 2 * 3 + 28 <= srcBytes; i += 16) {
+    const uint8_t *p = src + i / 2 * 3;
+    const __m256i bytes = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 12)), 1);
+    const __m256i words = _mm256_shuffle_epi8(bytes, shuffle);
+    const __m256i high = _mm256_sll_epi16(_mm256_srli_epi16(words, 8), shift);
+    // blend 立即数按 lane 内 8 个字生效：奇数字取右移 4 位后的 b1
+    const __m256i lowBits = _mm256_and_si256(
+        _mm256_blend_epi16(words, _mm256_srli_epi16(words, 4), 0xAA), low);
+    store16Avx2(_mm256_or_si256(high, lowBits), bits, dst + i);
+  }
+  return i;
+}
+
+#endif // WV_SIMD_AVX2
+
+template <typename T>
+bool unpack(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+            int width, int height, T *dst, Isa isa) {
+  Layout layout;
+  if (!src || !dst || width <= 0 || height <= 0 ||
+      !layoutFor(pixelType, &layout) ||
+      srcBytes < PixelFormats::frameBytes(pixelType, width, height))
+    return false;
+  isa = CpuFeatures::resolve(isa);
+  const std::size_t n = std::size_t(width) * height;
+  std::size_t i = 0;
+  if (layout.packed) {
+#if defined(WV_SIMD_AVX2)
+    if (isa == Isa::Avx2)
+      i = unpackPackedAvx2(src, srcBytes, n, layout.bits, dst);
+#endif
+    unpackPackedScalar(src, i, n, layout.bits, dst);
+    return true;
+  }
+#if defined(WV_SIMD_AVX2)
+  if (isa == Isa::Avx2)
+    i = unpack16Avx2(src, n, layout.bits, dst);
+#endif
+#if defined(WV_SIMD_SSE2)
+  if (isa == Isa::Sse2)
+    i = unpack16Sse2(src, n, layout.bits, dst);
+#endif
+  unpack16Scalar(src, i, n, layout.bits, dst);
+  return true;
+}
+
+} // namespace
+
+bool canUnpack(uint32_t pixelType) {
+  Layout layout;
+  return layoutFor(pixelType, &layout);
+}
+
+bool toU16(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+           int width, int height, uint16_t *dst, Isa isa) {
+  return unpack(src, srcBytes, pixelType, width, height, dst, isa);
+}
+
+bool toU16(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+           int width, int height, uint16_t *dst) {
+  return toU16(src, srcBytes, pixelType, width, height, dst,
+               CpuFeatures::best());
+}
+
+bool toU8(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+          int width, int height, uint8_t *dst, Isa isa) {
+  return unpack(src, srcBytes, pixelType, width, height, dst, isa);
+}
+
+bool toU8(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+          int width, int height, uint8_t *dst) {
+  return toU8(src, srcBytes, pixelType, width, height, dst,
+              CpuFeatures::best());
+}
+
+} // namespace PixelUnpack
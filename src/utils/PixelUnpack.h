@@ -0,0 +1,54 @@
+#ifndef PIXELUNPACK_H
+#define PIXELUNPACK_H
+
+#include "CpuFeatures.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 10 / 12 / 16 位 Mono、Bayer 帧解包（无 Qt/SDK 依赖，可单测）
+ *
+ * 荧光成像要保留传感器的位深，不能一进来就截成 8 位。相机出的高位深格式有两种排列：
+ *
+ * - 非打包（Mono10 / Mono12 / Mono16 / BayerXX10 / 12）：每个采样一个
+ *   小端 16 位字，高位补 0
+ * - 打包（Mono10Packed / Mono12Packed / BayerXX10Packed / 12Packed）：
+ *   两个像素占 3 字节。12 位：b0 = p0[11:4]，b1 = p1[3:0] << 4 | p0[3:0]，
+ *   b2 = p1[11:4]；10 位同理，b1 的低 2 位 / 第 4、5 位是两个像素的最低 2 位
+ *
+ * toU16 把两种排列统一解成每像素一个 uint16，值按 LSB 对齐（12 位的满量程是
+ * 4095），Bayer 只解包不插值。toU8 取每个采样的高 8 位，给只收 8 位的消费方
+ * （AVI 录制、SDK 显示）用。
+ *
+ * 帧按 width * height 个像素连续排列（GigE Vision 打包格式行间不留空）。
+ * 标量实现是基准；AVX2 一次 16 像素（打包格式用 pshufb 拆两组 12 字节），
+ * SSE2 只加速非打包格式（没有 pshufb），输出与标量逐字节一致。
+ */
+namespace PixelUnpack {
+
+using Isa = CpuFeatures::Isa;
+
+// 有效位深 > 8 的 Mono / Bayer 格式
+bool canUnpack(uint32_t pixelType);
+
+/**
+ * @brief 解成 LSB 对齐的 16 位
+ * @param srcBytes 源帧字节数，至少 PixelFormats::frameBytes(pixelType, w, h)
+ * @param dst 至少 width * height 个 uint16
+ * @param isa 指定实现；CPU 不支持时退到支持的最快实现
+ * @return 格式不支持或源数据不够时返回 false
+ */
+bool toU16(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+           int width, int height, uint16_t *dst, Isa isa);
+bool toU16(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+           int width, int height, uint16_t *dst);
+
+// 取高 8 位：dst 至少 width * height 字节，参数同 toU16
+bool toU8(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+          int width, int height, uint8_t *dst, Isa isa);
+bool toU8(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+          int width, int height, uint8_t *dst);
+
+} // namespace PixelUnpack
+
+#endif // PIXELUNPACK_H
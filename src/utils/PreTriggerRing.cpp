@@ -0,0 +1,88 @@
+#include "PreTriggerRing.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+std::size_t PreTriggerRing::slotsFor(double seconds, double fps,
+                                     std::size_t memoryBudgetBytes,
+                                     std::size_t frameBytes) {
+  if (seconds <= 0.0 || fps <= 0.0 || frameBytes == 0)
+    return 0;
+  std::size_t slotCount = static_cast<std::size_t>(std::ceil(seconds * fps));
+  if (memoryBudgetBytes > 0)
+    slotCount = std::min(slotCount, memoryBudgetBytes / frameBytes);
+  return slotCount;
+}
+
+bool PreTriggerRing::configure(std::size_t slotCount, std::size_t slotBytes) {
+  clear();
+  if (!m_pool.configure(slotCount, slotBytes))
+    return false;
+  // 缺页中断发生在这里，而不是录制阶段的 memcpy 里
+  m_pool.prefault();
+  std::vector<FrameRef> ring(slotCount);
+  m_slots.swap(ring);
+  return true;
+}
+
+void PreTriggerRing::release() {
+  clear();
+  std::vector<FrameRef>().swap(m_slots);
+  m_pool.release();
+}
+
+void PreTriggerRing::clear() {
+  for (FrameRef &slot : m_slots)
+    slot.reset();
+  m_head = 0;
+  m_size = 0;
+  m_overwritten = 0;
+}
+
+bool PreTriggerRing::push(const FrameRef &frame) {
+  if (m_slots.empty() || frame.size() > m_pool.bufferBytes())
+    return false;
+  if (m_size == m_slots.size()) {
+    // 覆盖最旧的一帧：先还它的缓冲，下面 acquire 才取得到
+    m_slots[m_head].reset();
+    m_head = (m_head + 1) % m_slots.size();
+    --m_size;
+    ++m_overwritten;
+  }
+  return copyIn(frame);
+}
+
+bool PreTriggerRing::append(const FrameRef &frame) {
+  if (m_size == m_slots.size() || frame.size() > m_pool.bufferBytes())
+    return false;
+  return copyIn(frame);
+}
+
+bool PreTriggerRing::copyIn(const FrameRef &frame) {
+  // pop 出去的帧还没释放时池里可能暂时没有空块
+  FrameRef slot = m_pool.acquire();
+  if (!slot)
+    return false;
+  std::memcpy(slot.writableData(), frame.data(), frame.size());
+  slot.writableInfo() = frame.info();
+  m_slots[(m_head + m_size) % m_slots.size()] = std::move(slot);
+  ++m_size;
+  return true;
+}
+
+FrameRef PreTriggerRing::pop() {
+  if (m_size == 0)
+    return FrameRef();
+  FrameRef frame = std::move(m_slots[m_head]);
+  m_head = (m_head + 1) % m_slots.size();
+  --m_size;
+  return frame;
+}
+
+int64_t PreTriggerRing::spanNs() const {
+  if (m_size < 2)
+    return 0;
+  const FrameRef &oldest = m_slots[m_head];
+  const FrameRef &newest = m_slots[(m_head + m_size - 1) % m_slots.size()];
+  return newest.info().grabTimeNs - oldest.info().grabTimeNs;
+}
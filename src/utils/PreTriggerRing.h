@@ -0,0 +1,68 @@
+#ifndef PRETRIGGERRING_H
+#define PRETRIGGERRING_H
+
+#include "FramePool.h"
+#include "FrameRef.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 预触发环形缓冲："录下按键之前的 N 秒"（无 Qt/SDK 依赖，可单测）
+ *
+ * 线虫的行为往往是发生之后才被注意到。没在录制时，每帧拷进自己预分配的
+ * 缓冲，满了覆盖最旧的一帧；开始录制后先把环里的历史按顺序写出去，
+ * 新到的帧排到环尾（append 不覆盖），写空之前顺序不变、不缺帧。
+ *
+ * 所有缓冲在 configure 时一次分配并预先写页，push / append / pop
+ * 都不分配内存。帧从采集帧缓冲池拷出，采集池缓冲立即归还。
+ *
+ * 线程：不加锁，调用方串行化（CameraController 里由 m_recordMutex 保护）。
+ */
+class PreTriggerRing {
+public:
+  /**
+   * @brief 按秒数 × 帧率算槽位数，再受 memoryBudgetBytes（> 0 时）截断
+   * fps <= 0 时返回 0（帧率未知时由调用方给兜底值）
+   */
+  static std::size_t slotsFor(double seconds, double fps,
+                              std::size_t memoryBudgetBytes,
+                              std::size_t frameBytes);
+
+  /**
+   * @brief 预分配 slotCount 块、每块 slotBytes 字节（清空已缓存的帧）
+   * @return 仍有 pop 出去的帧被外部持有时返回 false
+   */
+  bool configure(std::size_t slotCount, std::size_t slotBytes);
+  // 放掉已缓存的帧和全部内存
+  void release();
+  // 放掉已缓存的帧，内存保留
+  void clear();
+
+  // 拷入一帧，满时覆盖最旧的一帧；帧比槽大时返回 false
+  bool push(const FrameRef &frame);
+  // 拷入一帧，满时不覆盖、返回 false（录制补写历史期间用）
+  bool append(const FrameRef &frame);
+  // 取出最旧的一帧；空时返回空 FrameRef。用完释放后槽位回到池里
+  FrameRef pop();
+
+  bool empty() const { return m_size == 0; }
+  std::size_t size() const { return m_size; }
+  std::size_t capacity() const { return m_slots.size(); }
+  std::size_t slotBytes() const { return m_pool.bufferBytes(); }
+  // 环里最旧一帧到最新一帧的采集时间跨度
+  int64_t spanNs() const;
+  // 自 configure / clear 以来被覆盖掉的帧数
+  uint64_t overwritten() const { return m_overwritten; }
+
+private:
+  bool copyIn(const FrameRef &frame);
+
+  FramePool m_pool;
+  std::vector<FrameRef> m_slots;
+  std::size_t m_head = 0; // 最旧一帧
+  std::size_t m_size = 0;
+  uint64_t m_overwritten = 0;
+};
+
+#endif // PRETRIGGERRING_H
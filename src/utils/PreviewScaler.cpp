@@ -0,0 +1,382 @@
+#include "PreviewScaler.h"
+#include "BayerDemosaic.h"
+#include "PixelFormats.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(WV_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(WV_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace PreviewScaler {
+
+namespace {
+
+// 每像素字节数；不支持的格式返回 0
+int channelsFor(uint32_t pixelType, bool *bayer) {
+  const PixelFormats::Descriptor *d = PixelFormats::find(pixelType);
+  *bayer = false;
+  if (!d || d->sampleBits != 8)
+    return 0;
+  switch (d->family) {
+  case PixelFormats::Family::Mono:
+    return 1;
+  case PixelFormats::Family::Rgb:
+    return 3;
+  case PixelFormats::Family::Bayer:
+    *bayer = true;
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+// 四舍五入除以块内像素数 n：(sum + n/2) * ceil(2^40 / n) >> 40。
+// sum <= 255n，n <= kMaxFactor^2，误差小于 1/n，结果与整数除法一致
+class Divider {
+public:
+  explicit Divider(uint32_t n)
+      : m_half(n / 2), m_mul(((uint64_t(1) << 40) + n - 1) / n) {}
+  uint8_t operator()(uint32_t sum) const {
+    return static_cast<uint8_t>((uint64_t(sum + m_half) * m_mul) >> 40);
+  }
+
+private:
+  uint32_t m_half;
+  uint64_t m_mul;
+};
+
+void accumulateScalar(const uint8_t *row, int i, int n, uint16_t *acc) {
+  for (; i < n; ++i)
+    acc[i] = static_cast<uint16_t>(acc[i] + row[i]);
+}
+
+#if defined(WV_SIMD_SSE2)
+
+int accumulateSse2(const uint8_t *row, int n, uint16_t *acc) {
+  const __m128i zero = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+    __m128i *a = reinterpret_cast<__m128i *>(acc + i);
+    _mm_storeu_si128(a, _mm_add_epi16(_mm_loadu_si128(a),
+                                      _mm_unpacklo_epi8(v, zero)));
+    _mm_storeu_si128(a + 1, _mm_add_epi16(_mm_loadu_si128(a + 1),
+                                          _mm_unpackhi_epi8(v, zero)));
+  }
+  return i;
+}
+
+#endif // WV_SIMD_SSE2
+
+#if defined(WV_SIMD_AVX2)
+
+WV_TARGET_AVX2 int accumulateAvx2(const uint8_t *row, int n, uint16_t *acc) {
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m128i lo =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+    const __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i + 16));
+    __m256i *a = reinterpret_cast<__m256i *>(acc + i);
+    _mm256_storeu_si256(a, _mm256_add_epi16(_mm256_loadu_si256(a),
+                                            _mm256_cvtepu8_epi16(lo)));
+    _mm256_storeu_si256(a + 1, _mm256_add_epi16(_mm256_loadu_si256(a + 1),
+                                                _mm256_cvtepu8_epi16(hi)));
+  }
+  return i;
+}
+
+#endif // WV_SIMD_AVX2
+
+// acc[0, n) += row[0, n)
+void accumulate(const uint8_t *row, int n, uint16_t *acc, Isa isa) {
+  int i = 0;
+#if defined(WV_SIMD_AVX2)
+  if (isa == Isa::Avx2)
+    i = accumulateAvx2(row, n, acc);
+#endif
+#if defined(WV_SIMD_SSE2)
+  if (isa == Isa::Sse2)
+    i = accumulateSse2(row, n, acc);
+#endif
+  (void)isa;
+  accumulateScalar(row, i, n, acc);
+}
+
+// 横向按块求和：K / C 是编译期常量时内层循环完全展开（常见倍数走这里），
+// 否则按运行时的 k / channels 循环
+template <int K, int C>
+void reduceRow(const uint16_t *a, int outWidth, int k, int channels,
+               const Divider &divide, uint8_t *out) {
+  if (K > 0)
+    k = K;
+  if (C > 0)
+    channels = C;
+  for (int ox = 0; ox < outWidth; ++ox) {
+    for (int c = 0; c < channels; ++c) {
+      uint32_t sum = 0;
+      for (int j = 0; j < k; ++j)
+        sum += a[j * channels + c];
+      // 常量除数交给编译器换成乘法 / 移位
+      *out++ = K > 0 ? uint8_t((sum + K * K / 2) / (K * K)) : divide(sum);
+    }
+    a += k * channels;
+  }
+}
+
+using ReduceRowFn = void (*)(const uint16_t *, int, int, int, const Divider &,
+                             uint8_t *);
+
+template <int C> ReduceRowFn reduceRowFor(int k) {
+  switch (k) {
+  case 2:
+    return reduceRow<2, C>;
+  case 3:
+    return reduceRow<3, C>;
+  case 4:
+    return reduceRow<4, C>;
+  case 5:
+    return reduceRow<5, C>;
+  case 6:
+    return reduceRow<6, C>;
+  case 8:
+    return reduceRow<8, C>;
+  default:
+    return reduceRow<0, C>;
+  }
+}
+
+// Mono8 / RGB8 / BGR8：每个输出行先竖直累加 factor 行，再按块横向求和
+void scalePlanar(const uint8_t *src, std::size_t srcStride, int channels,
+                 const Plan &plan, uint8_t *dst, Isa isa) {
+  const int k = plan.factor;
+  const int rowBytes = plan.outWidth * k * channels;
+  const Divider divide(uint32_t(k) * k);
+  const ReduceRowFn reduce =
+      channels == 1 ? reduceRowFor<1>(k) : reduceRowFor<3>(k);
+  static thread_local std::vector<uint16_t> acc;
+  acc.resize(std::size_t(rowBytes));
+  const uint8_t *base =
+      src + std::size_t(plan.source.y) * srcStride + plan.source.x * channels;
+  for (int oy = 0; oy < plan.outHeight; ++oy) {
+    std::fill(acc.begin(), acc.end(), uint16_t(0));
+    for (int j = 0; j < k; ++j)
+      accumulate(base + std::size_t(oy * k + j) * srcStride, rowBytes,
+                 acc.data(), isa);
+    reduce(acc.data(), plan.outWidth, k, channels, divide,
+           dst + std::size_t(oy) * plan.outWidth * channels);
+  }
+}
+
+// Bayer 一个输出行：r / b / g0 / g1 指向竖直累加结果里每块第一个
+// R / B / 两个 G 采样（偶数行、奇数行分开累加），块内每隔 2 列取一个；
+// K 含义同 reduceRow
+template <int K>
+void reduceBayerRow(const uint16_t *r, const uint16_t *b, const uint16_t *g0,
+                    const uint16_t *g1, int outWidth, int k,
+                    const Divider &divideRb, const Divider &divideG,
+                    uint8_t *out) {
+  if (K > 0)
+    k = K;
+  constexpr uint32_t n = uint32_t(K / 2) * (K / 2);
+  for (int ox = 0; ox < outWidth; ++ox) {
+    uint32_t sumR = 0, sumB = 0, sumG = 0;
+    for (int j = 0; j < k; j += 2) {
+      sumR += r[j];
+      sumB += b[j];
+      sumG += g0[j] + g1[j];
+    }
+    if (K > 0) {
+      out[0] = uint8_t((sumB + n / 2) / n);
+      out[1] = uint8_t((sumG + n) / (2 * n));
+      out[2] = uint8_t((sumR + n / 2) / n);
+    } else {
+      out[0] = divideRb(sumB);
+      out[1] = divideG(sumG);
+      out[2] = divideRb(sumR);
+    }
+    out += 3;
+    r += k;
+    b += k;
+    g0 += k;
+    g1 += k;
+  }
+}
+
+using ReduceBayerRowFn = void (*)(const uint16_t *, const uint16_t *,
+                                  const uint16_t *, const uint16_t *, int, int,
+                                  const Divider &, const Divider &, uint8_t *);
+
+ReduceBayerRowFn reduceBayerRowFor(int k) {
+  switch (k) {
+  case 2:
+    return reduceBayerRow<2>;
+  case 4:
+    return reduceBayerRow<4>;
+  case 6:
+    return reduceBayerRow<6>;
+  case 8:
+    return reduceBayerRow<8>;
+  default:
+    return reduceBayerRow<0>;
+  }
+}
+
+// 8 位 Bayer → BGR8：偶数行 / 奇数行分开累加；factor 为偶数、源区域按 2 对齐，
+// 块内 R / B 各 (k/2)^2 个像素，G 有两倍
+void scaleBayer(const uint8_t *src, std::size_t srcStride,
+                BayerDemosaic::Pattern pattern, const Plan &plan,
+                uint8_t *dst, Isa isa) {
+  const int k = plan.factor;
+  const int rowBytes = plan.outWidth * k;
+  const uint32_t n = uint32_t(k / 2) * (k / 2);
+  const Divider divideRb(n);
+  const Divider divideG(2 * n);
+  const ReduceBayerRowFn reduce = reduceBayerRowFor(k);
+  // R 所在的行 / 列奇偶；B 在对角，G 在另外两个位置
+  int rRow = 0, rCol = 0;
+  switch (pattern) {
+  case BayerDemosaic::Pattern::RG:
+    break;
+  case BayerDemosaic::Pattern::GR:
+    rCol = 1;
+    break;
+  case BayerDemosaic::Pattern::GB:
+    rRow = 1;
+    break;
+  case BayerDemosaic::Pattern::BG:
+    rRow = rCol = 1;
+    break;
+  }
+  static thread_local std::vector<uint16_t> acc;
+  acc.resize(std::size_t(rowBytes) * 2);
+  uint16_t *accRow[2] = {acc.data(), acc.data() + rowBytes};
+  const uint8_t *base =
+      src + std::size_t(plan.source.y) * srcStride + plan.source.x;
+  for (int oy = 0; oy < plan.outHeight; ++oy) {
+    std::fill(acc.begin(), acc.end(), uint16_t(0));
+    for (int j = 0; j < k; ++j)
+      accumulate(base + std::size_t(oy * k + j) * srcStride, rowBytes,
+                 accRow[j & 1], isa);
+    const uint16_t *rowR = accRow[rRow];
+    const uint16_t *rowB = accRow[1 - rRow];
+    reduce(rowR + rCol, rowB + 1 - rCol, rowR + 1 - rCol, rowB + rCol,
+           plan.outWidth, k, divideRb, divideG,
+           dst + std::size_t(oy) * plan.outWidth * 3);
+  }
+}
+
+} // namespace
+
+bool canScale(uint32_t pixelType) {
+  bool bayer;
+  return channelsFor(pixelType, &bayer) > 0;
+}
+
+Plan plan(uint32_t pixelType, int imageWidth, int imageHeight,
+          const Rect &visible, int displayWidth, int displayHeight) {
+  Plan p;
+  p.source = {0, 0, std::max(imageWidth, 0), std::max(imageHeight, 0)};
+  p.outWidth = p.source.width;
+  p.outHeight = p.source.height;
+  p.outPixelType = pixelType;
+  bool bayer;
+  if (channelsFor(pixelType, &bayer) == 0 || imageWidth <= 0 ||
+      imageHeight <= 0)
+    return p;
+
+  int x0 = 0, y0 = 0, x1 = imageWidth, y1 = imageHeight;
+  if (visible.width > 0 && visible.height > 0) {
+    x0 = std::clamp(visible.x, 0, imageWidth);
+    y0 = std::clamp(visible.y, 0, imageHeight);
+    x1 = std::clamp(visible.x + visible.width, 0, imageWidth);
+    y1 = std::clamp(visible.y + visible.height, 0, imageHeight);
+    if (x1 <= x0 || y1 <= y0) {
+      x0 = y0 = 0;
+      x1 = imageWidth;
+      y1 = imageHeight;
+    }
+  }
+  if (bayer) {
+    x0 &= ~1;
+    y0 &= ~1;
+    x1 = x0 + ((x1 - x0) & ~1);
+    y1 = y0 + ((y1 - y0) & ~1);
+    if (x1 <= x0 || y1 <= y0)
+      return p; // 不到一个 2x2 单元：原样显示
+  }
+  p.source = {x0, y0, x1 - x0, y1 - y0};
+
+  int factor = 1;
+  if (displayWidth > 0 && displayHeight > 0)
+    factor = std::min(p.source.width / displayWidth,
+                      p.source.height / displayHeight);
+  factor = std::clamp(factor, 1, kMaxFactor);
+  if (bayer && factor > 1)
+    factor &= ~1;
+  p.factor = factor;
+  p.outWidth = p.source.width / factor;
+  p.outHeight = p.source.height / factor;
+  p.outPixelType = bayer && factor > 1 ? PixelFormats::kBgr8 : pixelType;
+  p.passthrough = factor == 1 && p.source.x == 0 && p.source.y == 0 &&
+                  p.source.width == imageWidth &&
+                  p.source.height == imageHeight;
+  return p;
+}
+
+std::size_t outputBytes(const Plan &plan) {
+  bool bayer;
+  const int channels = channelsFor(plan.outPixelType, &bayer);
+  return std::size_t(plan.outWidth) * plan.outHeight * channels;
+}
+
+bool scale(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+           int imageWidth, int imageHeight, const Plan &plan, uint8_t *dst,
+           Isa isa) {
+  bool bayer;
+  const int channels = channelsFor(pixelType, &bayer);
+  const Rect &s = plan.source;
+  if (!src || !dst || channels == 0 || plan.passthrough || plan.factor < 1 ||
+      plan.factor > kMaxFactor || plan.outWidth <= 0 || plan.outHeight <= 0 ||
+      s.x < 0 || s.y < 0 || s.x + plan.outWidth * plan.factor > imageWidth ||
+      s.y + plan.outHeight * plan.factor > imageHeight)
+    return false;
+  const std::size_t stride = std::size_t(imageWidth) * channels;
+  if (srcBytes < stride * imageHeight)
+    return false;
+  isa = CpuFeatures::resolve(isa);
+
+  if (plan.factor == 1) {
+    // 放大显示：只裁剪，逐行拷成紧密排列
+    const std::size_t rowBytes = std::size_t(plan.outWidth) * channels;
+    for (int y = 0; y < plan.outHeight; ++y)
+      std::memcpy(dst + y * rowBytes,
+                  src + std::size_t(s.y + y) * stride + s.x * channels,
+                  rowBytes);
+    return true;
+  }
+  if (bayer) {
+    BayerDemosaic::Pattern pattern;
+    if (plan.factor % 2 != 0 || s.x % 2 != 0 || s.y % 2 != 0 ||
+        !BayerDemosaic::patternFor(pixelType, &pattern))
+      return false;
+    scaleBayer(src, stride, pattern, plan, dst, isa);
+    return true;
+  }
+  scalePlanar(src, stride, channels, plan, dst, isa);
+  return true;
+}
+
+bool scale(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+           int imageWidth, int imageHeight, const Plan &plan, uint8_t *dst) {
+  return scale(src, srcBytes, pixelType, imageWidth, imageHeight, plan, dst,
+               CpuFeatures::best());
+}
+
+} // namespace PreviewScaler
@@ -0,0 +1,81 @@
+#ifndef PREVIEWSCALER_H
+#define PREVIEWSCALER_H
+
+#include "CpuFeatures.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 预览缩小：按窗口大小面积平均（无 Qt/SDK 依赖，可单测）
+ *
+ * 以前显示阶段每帧把整幅传感器图像交给 MV_CC_DisplayOneFrameEx2，
+ * 20 MP 相机在 25% 缩放下显示的像素只有 1/16，SDK 却照样处理全部像素。
+ * 现在显示前先裁出可见区域，再按整数倍 factor 做 factor × factor 面积平均，
+ * 交给 SDK 的像素数只和窗口大小有关：
+ *
+ * - factor = floor(可见源区域 / 显示尺寸)，输出不小于显示尺寸，剩下的不到 2 倍
+ *   由 SDK 拉伸；放大显示（factor = 1）时只裁剪不平均
+ * - Mono8 / RGB8 / BGR8：每个通道各自平均，输出格式不变
+ * - 8 位 Bayer：源区域按 2 对齐，排列不变；factor 取偶数，每块内 R / G / B
+ *   各自平均成一个 BGR8 像素（相当于超像素去马赛克，不需要插值）
+ * - 右 / 下不够一整块的源像素丢掉（不到 factor 个，显示上不到 1 个屏幕像素）
+ *
+ * 竖直方向逐行累加到 16 位累加器（SSE2 / AVX2 一次 16 / 32 字节），
+ * 再按块横向求和、四舍五入除以块内像素数；各档累加结果相同，输出逐字节一致。
+ *
+ * 线程：累加器是 thread_local，可在多个显示线程上同时调用。
+ */
+namespace PreviewScaler {
+
+using Isa = CpuFeatures::Isa;
+
+// 16 位累加器一列最多加 257 行 255，再留余量
+constexpr int kMaxFactor = 64;
+
+struct Rect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+struct Plan {
+  Rect source;              // 裁到图像内（Bayer 按 2 对齐）后的源区域
+  int factor = 1;           // factor × factor 个源像素平均成一个输出像素
+  int outWidth = 0;
+  int outHeight = 0;
+  uint32_t outPixelType = 0;
+  bool passthrough = true;  // 整帧、不缩小：原帧直接显示，不用 scale()
+};
+
+// Mono8、RGB8、BGR8、8 位 Bayer
+bool canScale(uint32_t pixelType);
+
+/**
+ * @brief 按可见区域和显示尺寸决定裁剪范围与缩小倍数
+ * @param visible 可见的源图像区域；空矩形表示整帧
+ * @param displayWidth / displayHeight 可见区域在屏幕上的像素尺寸，<= 0 表示不缩小
+ *
+ * 不支持的格式、或整帧且 factor = 1 时返回 passthrough。
+ */
+Plan plan(uint32_t pixelType, int imageWidth, int imageHeight,
+          const Rect &visible, int displayWidth, int displayHeight);
+
+// scale() 输出字节数（outWidth × outHeight × 通道数）
+std::size_t outputBytes(const Plan &plan);
+
+/**
+ * @brief 按 plan 裁剪 + 面积平均，输出紧密排列（行间不留空）
+ * @param src 整帧，行宽 imageWidth × 通道数
+ * @param dst 至少 outputBytes(plan) 字节
+ * @return passthrough、格式不支持或源数据不够时返回 false
+ */
+bool scale(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+           int imageWidth, int imageHeight, const Plan &plan, uint8_t *dst,
+           Isa isa);
+bool scale(const uint8_t *src, std::size_t srcBytes, uint32_t pixelType,
+           int imageWidth, int imageHeight, const Plan &plan, uint8_t *dst);
+
+} // namespace PreviewScaler
+
+#endif // PREVIEWSCALER_H
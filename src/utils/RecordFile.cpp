@@ -0,0 +1,590 @@
+#include "RecordFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kMinBufferBytes = std::size_t(64) << 10;
+constexpr std::align_val_t kBufferAlign{RecordFile::kAlignment};
+// Windows 单次 WriteFile / ReadFile 的上限（DWORD），取对齐的 1 GB
+constexpr std::size_t kMaxIoChunk = std::size_t(1) << 30;
+
+int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t alignDown(uint64_t v) {
+  return v & ~uint64_t(RecordFile::kAlignment - 1);
+}
+
+uint64_t alignUp(uint64_t v) {
+  return alignDown(v + RecordFile::kAlignment - 1);
+}
+
+uint8_t *allocAligned(std::size_t bytes) {
+  return static_cast<uint8_t *>(::operator new(bytes, kBufferAlign));
+}
+
+struct AlignedFree {
+  void operator()(uint8_t *p) const { ::operator delete(p, kBufferAlign); }
+};
+
+// 紧跟在失败的系统调用之后调用，附上 errno / 系统错误码
+std::string systemError(const char *what) {
+#if defined(_WIN32)
+  return std::string(what) + ": 错误 " + std::to_string(GetLastError());
+#else
+  const int err = errno;
+  std::string text(what);
+  if (err != 0)
+    text += std::string(": ") + std::strerror(err);
+  return text;
+#endif
+}
+
+} // namespace
+
+RecordFile::~RecordFile() { close(); }
+
+bool RecordFile::open(const std::string &path, const Options &options) {
+  close();
+  m_error.clear();
+  m_failed = false;
+  m_bufferBytes =
+      static_cast<std::size_t>(alignUp(std::max(options.bufferBytes,
+                                                kMinBufferBytes)));
+  const int count = std::max(options.bufferCount, 2);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ops.clear();
+    m_free.clear();
+    m_stop = false;
+    m_busy = false;
+    m_writerFailed = false;
+    m_writerError.clear();
+    m_queuedBytes = 0;
+    m_stats = Stats();
+    m_stats.bufferBytes = m_bufferBytes;
+    m_stats.bufferCount = count;
+    m_stats.queueCapacityBytes = uint64_t(count) * m_bufferBytes;
+  }
+
+  if (!openFile(path, options.directIo))
+    return false;
+  // 预分配失败不致命（文件系统不支持 / 空间不够时照常写，只是可能更碎）
+  const bool preallocated =
+      options.preallocateBytes > 0 && preallocate(options.preallocateBytes);
+
+  try {
+    m_buffers.resize(static_cast<std::size_t>(count));
+    for (Buffer &b : m_buffers) {
+      b.data = allocAligned(m_bufferBytes);
+      // 逐页写一遍，录制中不再缺页
+      std::memset(b.data, 0, m_bufferBytes);
+    }
+  } catch (const std::bad_alloc &) {
+    releaseBuffers();
+    closeFile();
+    return fail("写缓冲分配失败: " + std::to_string(count) + " × " +
+                std::to_string(m_bufferBytes >> 20) + " MB");
+  }
+  m_fill = &m_buffers[0];
+  m_fill->used = 0;
+  m_fill->fileOffset = 0;
+  m_carry = 0;
+  m_pos = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t i = 1; i < m_buffers.size(); ++i)
+      m_free.push_back(&m_buffers[i]);
+    m_stats.directIo = m_directIo;
+    m_stats.preallocated = preallocated;
+  }
+  m_open = true;
+  m_openNs = nowNs();
+  m_closeNs = 0;
+  m_writer = std::thread(&RecordFile::writerLoop, this);
+  return true;
+}
+
+bool RecordFile::append(const void *data, std::size_t bytes) {
+  if (m_failed || !m_open)
+    return false;
+  const uint8_t *src = static_cast<const uint8_t *>(data);
+  while (bytes > 0) {
+    if (m_fill->used == m_bufferBytes && !handOff(false))
+      return false;
+    const std::size_t n = std::min(bytes, m_bufferBytes - m_fill->used);
+    std::memcpy(m_fill->data + m_fill->used, src, n);
+    m_fill->used += n;
+    m_pos += n;
+    src += n;
+    bytes -= n;
+  }
+  return true;
+}
+
+bool RecordFile::appendZeros(std::size_t bytes) {
+  if (m_failed || !m_open)
+    return false;
+  while (bytes > 0) {
+    if (m_fill->used == m_bufferBytes && !handOff(false))
+      return false;
+    const std::size_t n = std::min(bytes, m_bufferBytes - m_fill->used);
+    std::memset(m_fill->data + m_fill->used, 0, n);
+    m_fill->used += n;
+    m_pos += n;
+    bytes -= n;
+  }
+  return true;
+}
+
+uint8_t *RecordFile::reserve(std::size_t bytes) {
+  if (m_failed || !m_open || bytes > m_bufferBytes - kAlignment)
+    return nullptr;
+  if (bytes > m_bufferBytes - m_fill->used && !handOff(false))
+    return nullptr;
+  return m_fill->data + m_fill->used;
+}
+
+void RecordFile::commit(std::size_t bytes) {
+  m_fill->used += bytes;
+  m_pos += bytes;
+}
+
+bool RecordFile::handOff(bool last) {
+  Buffer *full = m_fill;
+  // 只有带过来的页、没有新数据：不用再写一遍
+  if (full->used <= m_carry) {
+    if (last)
+      m_fill = nullptr;
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_writerFailed) {
+    const std::string what = m_writerError;
+    lock.unlock();
+    return fail(what);
+  }
+  Op op;
+  op.buffer = full;
+  m_ops.push_back(std::move(op));
+  m_queuedBytes += full->used;
+  m_stats.highWaterBytes = std::max(m_stats.highWaterBytes, m_queuedBytes);
+  m_workReady.notify_one();
+  if (last) {
+    m_fill = nullptr;
+    return true;
+  }
+
+  if (m_free.empty()) {
+    // 缓冲全部排队：磁盘跟不上，只能等
+    const int64_t t0 = nowNs();
+    m_bufferFree.wait(lock,
+                      [this] { return !m_free.empty() || m_writerFailed; });
+    const uint32_t waitedUs = static_cast<uint32_t>((nowNs() - t0) / 1000);
+    ++m_stats.producerWaits;
+    m_stats.maxProducerWaitUs = std::max(m_stats.maxProducerWaitUs, waitedUs);
+    if (m_writerFailed) {
+      const std::string what = m_writerError;
+      lock.unlock();
+      return fail(what);
+    }
+  }
+  Buffer *next = m_free.back();
+  m_free.pop_back();
+  lock.unlock();
+
+  // 直接 I/O 的写盘偏移要对齐：最后一个不完整的页带进新缓冲，下次重写。
+  // full 可能已经写完、又被取回来当 next，所以先算好源位置再用 memmove
+  const uint64_t start = m_directIo ? alignDown(m_pos) : m_pos;
+  const std::size_t carry = static_cast<std::size_t>(m_pos - start);
+  const uint8_t *carrySrc = full->data + (start - full->fileOffset);
+  if (carry > 0)
+    std::memmove(next->data, carrySrc, carry);
+  next->fileOffset = start;
+  next->used = carry;
+  m_carry = carry;
+  m_fill = next;
+  return true;
+}
+
+bool RecordFile::patch(uint64_t offset, const void *data, std::size_t bytes) {
+  if (m_failed || !m_open)
+    return false;
+  const uint8_t *src = static_cast<const uint8_t *>(data);
+  const uint64_t end = offset + bytes;
+  // 落在当前缓冲里的部分直接改
+  const uint64_t fillStart = m_fill->fileOffset;
+  if (end > fillStart) {
+    const uint64_t from = std::max(offset, fillStart);
+    std::memcpy(m_fill->data + (from - fillStart), src + (from - offset),
+                static_cast<std::size_t>(end - from));
+  }
+  // 带过来的页已经随上一块交出过，两边都要改；更早的只能排队回填
+  const uint64_t handedEnd = fillStart + m_carry;
+  if (offset >= handedEnd)
+    return true;
+  Op op;
+  op.offset = offset;
+  op.patch.assign(src, src + (std::min(end, handedEnd) - offset));
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_writerFailed) {
+    const std::string what = m_writerError;
+    lock.unlock();
+    return fail(what);
+  }
+  m_ops.push_back(std::move(op));
+  m_workReady.notify_one();
+  return true;
+}
+
+bool RecordFile::flush() {
+  if (!m_open)
+    return !m_failed;
+  if (m_failed)
+    return false;
+  return handOff(false);
+}
+
+bool RecordFile::sync() {
+  if (!flush() || !m_open)
+    return !m_failed;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_bufferFree.wait(lock, [this] {
+    return (m_ops.empty() && !m_busy) || m_writerFailed;
+  });
+  if (m_writerFailed) {
+    const std::string what = m_writerError;
+    lock.unlock();
+    return fail(what);
+  }
+  return true;
+}
+
+bool RecordFile::close() {
+  if (!m_open)
+    return true;
+  if (!m_failed)
+    handOff(true);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_workReady.notify_all();
+  if (m_writer.joinable())
+    m_writer.join();
+
+  std::string writerError;
+  bool preallocated = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_writerFailed)
+      writerError = m_writerError;
+    preallocated = m_stats.preallocated;
+  }
+  if (!m_failed && !writerError.empty())
+    fail(writerError);
+  // 去掉直接 I/O 最后一页的补齐和没用完的预分配空间
+  std::string what;
+  if (!m_failed && (m_directIo || preallocated) && !truncateTo(m_pos, &what))
+    fail(what);
+  if (!closeFile() && !m_failed)
+    fail(systemError("关闭文件失败"));
+  releaseBuffers();
+  m_fill = nullptr;
+  m_carry = 0;
+  m_open = false;
+  m_closeNs = nowNs();
+  return !m_failed;
+}
+
+RecordFile::Stats RecordFile::stats() const {
+  Stats s;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    s = m_stats;
+  }
+  s.bytes = m_pos;
+  if (m_openNs != 0)
+    s.elapsedSec = ((m_closeNs != 0 ? m_closeNs : nowNs()) - m_openNs) / 1e9;
+  return s;
+}
+
+void RecordFile::writerLoop() {
+  for (;;) {
+    Op op;
+    bool skip = false;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_workReady.wait(lock, [this] { return !m_ops.empty() || m_stop; });
+      if (m_ops.empty())
+        return;
+      op = std::move(m_ops.front());
+      m_ops.pop_front();
+      m_busy = true;
+      skip = m_writerFailed;
+    }
+    // 出错之后的操作全部丢弃，缓冲照样还回去，调用方不会卡住
+    std::string what;
+    uint64_t diskBytes = 0;
+    const int64_t t0 = nowNs();
+    const bool ok = skip || execute(op, &diskBytes, &what);
+    const int64_t ns = nowNs() - t0;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!skip) {
+        if (!ok) {
+          m_writerFailed = true;
+          m_writerError = what;
+        }
+        m_stats.busySec += ns / 1e9;
+        m_stats.diskBytes += diskBytes;
+        if (op.buffer) {
+          ++m_stats.writes;
+          m_stats.maxWriteUs = std::max(m_stats.maxWriteUs,
+                                        static_cast<uint32_t>(ns / 1000));
+        } else {
+          ++m_stats.patches;
+        }
+      }
+      if (op.buffer) {
+        m_queuedBytes -= op.buffer->used;
+        m_free.push_back(op.buffer);
+      }
+      m_busy = false;
+    }
+    m_bufferFree.notify_all();
+  }
+}
+
+bool RecordFile::execute(Op &op, uint64_t *diskBytes, std::string *what) {
+  if (op.buffer) {
+    Buffer *b = op.buffer;
+    std::size_t n = b->used;
+    if (m_directIo) {
+      // 补齐到整页；补齐部分在文件末尾之外，会被下一块重写或在 close 时截掉
+      const std::size_t padded = static_cast<std::size_t>(alignUp(n));
+      std::memset(b->data + n, 0, padded - n);
+      n = padded;
+    }
+    *diskBytes = n;
+    return writeAt(b->data, n, b->fileOffset, what);
+  }
+  if (!m_directIo) {
+    *diskBytes = op.patch.size();
+    return writeAt(op.patch.data(), op.patch.size(), op.offset, what);
+  }
+  // 直接 I/O 只能整页读写：读出所在的页，改完写回
+  const uint64_t first = alignDown(op.offset);
+  const std::size_t n =
+      static_cast<std::size_t>(alignUp(op.offset + op.patch.size()) - first);
+  std::unique_ptr<uint8_t, AlignedFree> page(allocAligned(n));
+  if (!readAt(page.get(), n, first, what))
+    return false;
+  std::memcpy(page.get() + (op.offset - first), op.patch.data(),
+              op.patch.size());
+  *diskBytes = n;
+  return writeAt(page.get(), n, first, what);
+}
+
+bool RecordFile::writeAt(const uint8_t *data, std::size_t bytes,
+                         uint64_t offset, std::string *what) {
+  while (bytes > 0) {
+#if defined(_WIN32)
+    const DWORD chunk = static_cast<DWORD>(std::min(bytes, kMaxIoChunk));
+    OVERLAPPED ov = {};
+    ov.Offset = static_cast<DWORD>(offset);
+    ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD written = 0;
+    if (!WriteFile(static_cast<HANDLE>(m_handle), data, chunk, &written, &ov) ||
+        written == 0) {
+      *what = systemError("写入失败");
+      return false;
+    }
+    const std::size_t n = written;
+#else
+    const ssize_t r = ::pwrite(m_fd, data, bytes, static_cast<off_t>(offset));
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r <= 0) {
+      *what = systemError("写入失败");
+      return false;
+    }
+    const std::size_t n = static_cast<std::size_t>(r);
+#endif
+    data += n;
+    bytes -= n;
+    offset += n;
+  }
+  return true;
+}
+
+bool RecordFile::readAt(uint8_t *data, std::size_t bytes, uint64_t offset,
+                        std::string *what) {
+  // 只用于回填前读出整页，远小于单次读写上限
+#if defined(_WIN32)
+  OVERLAPPED ov = {};
+  ov.Offset = static_cast<DWORD>(offset);
+  ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+  DWORD got = 0;
+  if (!ReadFile(static_cast<HANDLE>(m_handle), data, static_cast<DWORD>(bytes),
+                &got, &ov) &&
+      GetLastError() != ERROR_HANDLE_EOF) {
+    *what = systemError("回填时读取失败");
+    return false;
+  }
+  const std::size_t n = got;
+#else
+  ssize_t r;
+  do {
+    r = ::pread(m_fd, data, bytes, static_cast<off_t>(offset));
+  } while (r < 0 && errno == EINTR);
+  if (r < 0) {
+    *what = systemError("回填时读取失败");
+    return false;
+  }
+  const std::size_t n = static_cast<std::size_t>(r);
+#endif
+  // 普通文件只有读到末尾才会读不满：后面还没写过，按 0 处理
+  std::memset(data + n, 0, bytes - n);
+  return true;
+}
+
+bool RecordFile::openFile(const std::string &path, bool directIo) {
+  m_directIo = false;
+#if defined(_WIN32)
+  const int n = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  if (n <= 0)
+    return fail("无法创建文件: 路径不是合法的 UTF-8");
+  std::wstring wide(static_cast<std::size_t>(n), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], n);
+  // 允许别的进程同时读：录制中的文件也能打开看已经写好的部分
+  HANDLE h = INVALID_HANDLE_VALUE;
+  if (directIo) {
+    h = CreateFileW(wide.c_str(), GENERIC_READ | GENERIC_WRITE,
+                    FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, nullptr);
+    m_directIo = h != INVALID_HANDLE_VALUE;
+  }
+  if (h == INVALID_HANDLE_VALUE)
+    h = CreateFileW(wide.c_str(), GENERIC_READ | GENERIC_WRITE,
+                    FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                    FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h == INVALID_HANDLE_VALUE)
+    return fail(systemError("无法创建文件"));
+  m_handle = h;
+#else
+  int flags = O_RDWR | O_CREAT | O_TRUNC;
+#if defined(O_CLOEXEC)
+  flags |= O_CLOEXEC;
+#endif
+#if defined(O_DIRECT)
+  // tmpfs 等不支持 O_DIRECT 的文件系统 open 就会失败：退回普通写
+  if (directIo) {
+    m_fd = ::open(path.c_str(), flags | O_DIRECT, 0666);
+    m_directIo = m_fd >= 0;
+  }
+#endif
+  if (m_fd < 0)
+    m_fd = ::open(path.c_str(), flags, 0666);
+  if (m_fd < 0)
+    return fail(systemError("无法创建文件"));
+#if defined(__APPLE__)
+  // macOS 没有 O_DIRECT，F_NOCACHE 起同样作用
+  if (directIo)
+    m_directIo = ::fcntl(m_fd, F_NOCACHE, 1) == 0;
+#endif
+#endif
+  return true;
+}
+
+bool RecordFile::preallocate(uint64_t bytes) {
+#if defined(_WIN32)
+  FILE_ALLOCATION_INFO info = {};
+  info.AllocationSize.QuadPart = static_cast<LONGLONG>(bytes);
+  return SetFileInformationByHandle(static_cast<HANDLE>(m_handle),
+                                    FileAllocationInfo, &info,
+                                    sizeof(info)) != 0;
+#elif defined(__linux__)
+  // KEEP_SIZE：只占盘不改文件大小，读端看到的仍是实际写入的部分
+  return ::fallocate(m_fd, FALLOC_FL_KEEP_SIZE, 0,
+                     static_cast<off_t>(bytes)) == 0;
+#elif defined(__APPLE__)
+  fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0,
+                    static_cast<off_t>(bytes), 0};
+  if (::fcntl(m_fd, F_PREALLOCATE, &store) == 0)
+    return true;
+  store.fst_flags = F_ALLOCATEALL;
+  return ::fcntl(m_fd, F_PREALLOCATE, &store) == 0;
+#else
+  (void)bytes;
+  return false;
+#endif
+}
+
+bool RecordFile::truncateTo(uint64_t bytes, std::string *what) {
+#if defined(_WIN32)
+  FILE_END_OF_FILE_INFO info = {};
+  info.EndOfFile.QuadPart = static_cast<LONGLONG>(bytes);
+  if (!SetFileInformationByHandle(static_cast<HANDLE>(m_handle),
+                                  FileEndOfFileInfo, &info, sizeof(info))) {
+    *what = systemError("截断文件失败");
+    return false;
+  }
+#else
+  if (::ftruncate(m_fd, static_cast<off_t>(bytes)) != 0) {
+    *what = systemError("截断文件失败");
+    return false;
+  }
+#endif
+  return true;
+}
+
+bool RecordFile::closeFile() {
+  bool ok = true;
+#if defined(_WIN32)
+  if (m_handle) {
+    ok = CloseHandle(static_cast<HANDLE>(m_handle)) != 0;
+    m_handle = nullptr;
+  }
+#else
+  if (m_fd >= 0) {
+    ok = ::close(m_fd) == 0;
+    m_fd = -1;
+  }
+#endif
+  return ok;
+}
+
+void RecordFile::releaseBuffers() {
+  for (Buffer &b : m_buffers)
+    if (b.data)
+      ::operator delete(b.data, kBufferAlign);
+  m_buffers.clear();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_free.clear();
+  m_ops.clear();
+}
+
+bool RecordFile::fail(const std::string &what) {
+  m_failed = true;
+  m_error = what;
+  return false;
+}
@@ -0,0 +1,177 @@
+#ifndef RECORDFILE_H
+#define RECORDFILE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 录制文件的顺序写出端：专用写盘线程 + 多块对齐大缓冲 + 回填
+ * （无 Qt/SDK 依赖，可单测）
+ *
+ * AviWriter / WvrWriter 共用。调用方只把数据拷进当前缓冲；缓冲写满就交给
+ * 写盘线程，换一块空闲缓冲继续填，磁盘停顿不会卡住录制阶段，除非
+ * bufferCount 块缓冲全部排队未写完（这时调用方等，计入 Stats）。
+ *
+ * 缓冲按 4 KB 对齐分配、写盘偏移也对齐，可以选直接 I/O（Linux O_DIRECT /
+ * Windows FILE_FLAG_NO_BUFFERING）绕过页缓存；文件系统不支持时退回普通写。
+ * 不满一块就交出时（flush / close），最后一个不完整的页会拷进下一块缓冲，
+ * 下次连同新数据一起重写，写盘偏移始终对齐。
+ *
+ * patch() 回填已经交出的位置（文件头、块大小）：目标还在当前缓冲里就直接
+ * 改缓冲，否则排进写盘队列，按顺序在它之前的数据写完后再改；直接 I/O 时
+ * 读出所在的页改完整页写回。
+ *
+ * 路径按 UTF-8，Windows 下转宽字符打开；按偏移写，文件 > 4 GB 没有问题。
+ * 线程：非线程安全，由所属的写入器串行调用；写盘线程是内部的。
+ * 出错：返回 false，error() 给出原因（附 errno / 系统错误码）；写盘线程的
+ * 错误在之后第一次交出缓冲 / 回填 / 关闭时报告，出错后所有写入都返回 false。
+ */
+class RecordFile {
+public:
+  // 写盘偏移、缓冲大小和地址的对齐粒度（覆盖 512 B / 4 KB 扇区）
+  static constexpr std::size_t kAlignment = 4096;
+
+  struct Options {
+    // 单块缓冲大小（向上对齐到 4 KB，下限 64 KB）；录制设置里可选 4–64 MB
+    std::size_t bufferBytes = std::size_t(8) << 20;
+    // 缓冲块数（下限 2）：一块在填，其余可以排队等写盘
+    int bufferCount = 4;
+    // 绕过系统页缓存直接写盘
+    bool directIo = false;
+    // open 时预分配的磁盘空间（0 = 不预分配），不改变文件大小；
+    // close 时截到实际写入的大小
+    uint64_t preallocateBytes = 0;
+  };
+
+  // 写盘统计；open 时清零，close 之后仍有效
+  struct Stats {
+    uint64_t bytes = 0;        // 文件的逻辑大小
+    uint64_t diskBytes = 0;    // 实际写盘字节（含对齐补齐和重写的页）
+    uint32_t writes = 0;       // 写盘次数（不含回填）
+    uint32_t patches = 0;      // 排队执行的回填次数
+    double elapsedSec = 0.0;   // open → close（或到现在）
+    double busySec = 0.0;      // 写盘线程在写 / 回填调用里的时间
+    uint32_t maxWriteUs = 0;   // 单次写盘最长耗时
+    uint64_t highWaterBytes = 0; // 排队等写盘的最多字节数
+    uint64_t queueCapacityBytes = 0; // 可排队的字节数 = 块数 × 块大小
+    uint32_t producerWaits = 0;  // 缓冲全部排队、调用方等写盘的次数
+    uint32_t maxProducerWaitUs = 0;
+    std::size_t bufferBytes = 0;
+    int bufferCount = 0;
+    bool directIo = false;     // 实际是否用上了直接 I/O
+    bool preallocated = false; // 预分配是否成功
+
+    // 录制期间的持续写盘速度（逻辑字节 / 整个时长）
+    double mbPerSec() const {
+      return elapsedSec > 0.0 ? bytes / 1e6 / elapsedSec : 0.0;
+    }
+    // 磁盘在忙时的吞吐（写盘字节 / 写盘耗时）
+    double diskMbPerSec() const {
+      return busySec > 0.0 ? diskBytes / 1e6 / busySec : 0.0;
+    }
+  };
+
+  RecordFile() = default;
+  ~RecordFile();
+  RecordFile(const RecordFile &) = delete;
+  RecordFile &operator=(const RecordFile &) = delete;
+
+  // 创建文件（已有文件会被覆盖）、分配缓冲并启动写盘线程
+  bool open(const std::string &path, const Options &options);
+
+  bool append(const void *data, std::size_t bytes);
+  bool appendZeros(std::size_t bytes);
+
+  /**
+   * @brief 在缓冲里预留 bytes 字节给调用方直接填（行翻转、补齐不用中转）
+   * bytes 不能超过 bufferBytes() - kAlignment；填完调用 commit(bytes)。
+   * 出错返回 nullptr
+   */
+  uint8_t *reserve(std::size_t bytes);
+  void commit(std::size_t bytes);
+
+  bool patch(uint64_t offset, const void *data, std::size_t bytes);
+  // 把当前缓冲交给写盘线程（不等待）：之后的 patch 排在它后面
+  bool flush();
+  // flush 并等写盘线程写完已交出的全部数据（不 fsync），之后别的进程能读到
+  bool sync();
+  // 写完全部数据、截到实际大小并关闭；未打开时返回 true
+  bool close();
+
+  bool isOpen() const { return m_open; }
+  bool failed() const { return m_failed; }
+  const std::string &error() const { return m_error; }
+  // 逻辑写位置 = 已交出 + 当前缓冲中
+  uint64_t pos() const { return m_pos; }
+  std::size_t bufferBytes() const { return m_bufferBytes; }
+  Stats stats() const;
+
+private:
+  struct Buffer {
+    uint8_t *data = nullptr;
+    std::size_t used = 0;    // 从 data 开始的有效字节
+    uint64_t fileOffset = 0; // data[0] 在文件里的位置
+  };
+  // 排给写盘线程的操作：写一块缓冲，或回填一段数据
+  struct Op {
+    Buffer *buffer = nullptr;
+    uint64_t offset = 0;
+    std::vector<uint8_t> patch;
+  };
+
+  // 把 m_fill 交出去，换一块空闲缓冲；last 为 true 时不再换
+  bool handOff(bool last);
+  void writerLoop();
+  bool execute(Op &op, uint64_t *diskBytes, std::string *what);
+  bool writeAt(const uint8_t *data, std::size_t bytes, uint64_t offset,
+               std::string *what);
+  bool readAt(uint8_t *data, std::size_t bytes, uint64_t offset,
+              std::string *what);
+  bool openFile(const std::string &path, bool directIo);
+  bool preallocate(uint64_t bytes);
+  bool truncateTo(uint64_t bytes, std::string *what);
+  bool closeFile();
+  void releaseBuffers();
+  bool fail(const std::string &what);
+
+#if defined(_WIN32)
+  void *m_handle = nullptr;
+#else
+  int m_fd = -1;
+#endif
+  bool m_open = false;
+  bool m_directIo = false; // 实际用上了直接 I/O（写盘线程只读）
+  bool m_failed = false;
+  std::string m_error;
+
+  std::size_t m_bufferBytes = 0;
+  std::vector<Buffer> m_buffers;
+  Buffer *m_fill = nullptr;  // 调用方正在填的缓冲
+  std::size_t m_carry = 0;   // m_fill 开头从上一块带过来的字节（已交出过）
+  uint64_t m_pos = 0;
+  int64_t m_openNs = 0; // steady_clock
+  int64_t m_closeNs = 0;
+
+  // 以下由 m_mutex 保护
+  mutable std::mutex m_mutex;
+  std::condition_variable m_workReady;
+  std::condition_variable m_bufferFree;
+  std::deque<Op> m_ops;
+  std::vector<Buffer *> m_free;
+  bool m_stop = false;
+  bool m_busy = false;
+  bool m_writerFailed = false;
+  std::string m_writerError;
+  uint64_t m_queuedBytes = 0;
+  Stats m_stats;
+
+  std::thread m_writer;
+};
+
+#endif // RECORDFILE_H
@@ -0,0 +1,78 @@
+#include "RecordFileSettings.h"
+#include <QSettings>
+#include <algorithm>
+
+namespace RecordFileSettings {
+
+namespace {
+
+constexpr char kBufferMBKey[] = "recordFile/bufferMB";
+constexpr char kDirectIoKey[] = "recordFile/directIo";
+constexpr char kPreallocateGBKey[] = "recordFile/preallocateGB";
+constexpr char kSegmentMinutesKey[] = "recordSegment/minutes";
+constexpr char kSegmentGBKey[] = "recordSegment/gb";
+constexpr int64_t kMinuteNs = int64_t(60) * 1000000000;
+
+} // namespace
+
+RecordFile::Options load(const QSettings &settings) {
+  RecordFile::Options options;
+  bool ok = false;
+  int bufferMB = settings.value(kBufferMBKey, kDefaultBufferMB).toInt(&ok);
+  if (!ok)
+    bufferMB = kDefaultBufferMB;
+  bufferMB = std::clamp(bufferMB, kMinBufferMB, kMaxBufferMB);
+  options.bufferBytes = std::size_t(bufferMB) << 20;
+  options.directIo = settings.value(kDirectIoKey, false).toBool();
+  const int preallocateGB = settings.value(kPreallocateGBKey, 0).toInt(&ok);
+  if (ok && preallocateGB > 0)
+    options.preallocateBytes =
+        uint64_t(std::min(preallocateGB, kMaxPreallocateGB)) << 30;
+  return options;
+}
+
+void save(QSettings &settings, const RecordFile::Options &options) {
+  settings.setValue(kBufferMBKey, static_cast<int>(options.bufferBytes >> 20));
+  settings.setValue(kDirectIoKey, options.directIo);
+  settings.setValue(kPreallocateGBKey,
+                    static_cast<int>(options.preallocateBytes >> 30));
+  settings.sync();
+}
+
+RecordSegmenter::Policy loadSegmentPolicy(const QSettings &settings) {
+  RecordSegmenter::Policy policy;
+  bool ok = false;
+  const int minutes = settings.value(kSegmentMinutesKey, 0).toInt(&ok);
+  if (ok && minutes > 0)
+    policy.maxDurationNs = std::min(minutes, kMaxSegmentMinutes) * kMinuteNs;
+  const int gb = settings.value(kSegmentGBKey, 0).toInt(&ok);
+  if (ok && gb > 0)
+    policy.maxBytes = uint64_t(std::min(gb, kMaxSegmentGB)) << 30;
+  return policy;
+}
+
+void saveSegmentPolicy(QSettings &settings,
+                       const RecordSegmenter::Policy &policy) {
+  settings.setValue(kSegmentMinutesKey,
+                    static_cast<int>(policy.maxDurationNs / kMinuteNs));
+  settings.setValue(kSegmentGBKey, static_cast<int>(policy.maxBytes >> 30));
+  settings.sync();
+}
+
+RecordFile::Options load() { return load(QSettings()); }
+
+void save(const RecordFile::Options &options) {
+  QSettings settings;
+  save(settings, options);
+}
+
+RecordSegmenter::Policy loadSegmentPolicy() {
+  return loadSegmentPolicy(QSettings());
+}
+
+void saveSegmentPolicy(const RecordSegmenter::Policy &policy) {
+  QSettings settings;
+  saveSegmentPolicy(settings, policy);
+}
+
+} // namespace RecordFileSettings
@@ -0,0 +1,41 @@
+#ifndef RECORDFILESETTINGS_H
+#define RECORDFILESETTINGS_H
+
+#include "utils/RecordFile.h"
+#include "utils/RecordSegmenter.h"
+
+class QSettings;
+
+// 录制文件的写盘选项，持久化在 QSettings 的 recordFile/ 分组下：
+//   recordFile/bufferMB       单块写盘缓冲 MB，夹到 4–64，默认 8
+//   recordFile/directIo       绕过系统页缓存，默认 false
+//   recordFile/preallocateGB  开始录制时预分配的 GB，0 = 不预分配
+// 缺省或无法识别的值按默认处理；缓冲块数不开放，用 RecordFile 的默认。
+// 长时间录制分段在 recordSegment/ 分组下：
+//   recordSegment/minutes     每段分钟数，0 = 不按时长分段
+//   recordSegment/gb          每段 GB，0 = 不按大小分段；两者都为 0 时不分段
+namespace RecordFileSettings {
+
+constexpr int kMinBufferMB = 4;
+constexpr int kMaxBufferMB = 64;
+constexpr int kDefaultBufferMB = 8;
+constexpr int kMaxPreallocateGB = 1024;
+constexpr int kMaxSegmentMinutes = 24 * 60;
+constexpr int kMaxSegmentGB = 1024;
+
+RecordFile::Options load(const QSettings &settings);
+void save(QSettings &settings, const RecordFile::Options &options);
+
+RecordSegmenter::Policy loadSegmentPolicy(const QSettings &settings);
+void saveSegmentPolicy(QSettings &settings,
+                       const RecordSegmenter::Policy &policy);
+
+// 用应用默认的 QSettings
+RecordFile::Options load();
+void save(const RecordFile::Options &options);
+RecordSegmenter::Policy loadSegmentPolicy();
+void saveSegmentPolicy(const RecordSegmenter::Policy &policy);
+
+} // namespace RecordFileSettings
+
+#endif // RECORDFILESETTINGS_H
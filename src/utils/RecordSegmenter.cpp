@@ -0,0 +1,98 @@
+#include "RecordSegmenter.h"
+
+#include <algorithm>
+#include <cstdio>
+
+void RecordSegmenter::start(const Policy &policy) {
+  m_policy = policy;
+  m_current = Segment();
+  m_current.index = 1;
+  m_windowStartNs = 0;
+  m_windowBaseBytes = 0;
+  m_windowStarted = false;
+}
+
+bool RecordSegmenter::shouldRollOver(int64_t grabTimeNs, uint64_t segmentBytes,
+                                     std::size_t frameBytes) const {
+  if (!m_policy.enabled() || m_current.frames == 0 || !m_windowStarted)
+    return false;
+  if (m_policy.maxDurationNs > 0 &&
+      grabTimeNs - m_windowStartNs >= m_policy.maxDurationNs)
+    return true;
+  if (m_policy.maxBytes > 0) {
+    const uint64_t used =
+        segmentBytes > m_windowBaseBytes ? segmentBytes - m_windowBaseBytes : 0;
+    if (used + frameBytes > m_policy.maxBytes)
+      return true;
+  }
+  return false;
+}
+
+bool RecordSegmenter::shouldPrepare(int64_t grabTimeNs,
+                                    uint64_t segmentBytes) const {
+  if (!m_policy.enabled() || m_current.frames == 0 || !m_windowStarted)
+    return false;
+  const int64_t elapsedNs = grabTimeNs - m_windowStartNs;
+  if (m_policy.maxDurationNs > 0) {
+    const int64_t lead =
+        std::min(kMaxPrepareLeadNs, m_policy.maxDurationNs / 4);
+    if (elapsedNs >= m_policy.maxDurationNs - lead)
+      return true;
+  }
+  if (m_policy.maxBytes > 0) {
+    const uint64_t used =
+        segmentBytes > m_windowBaseBytes ? segmentBytes - m_windowBaseBytes : 0;
+    // 剩周期的 1/4（写满 3/4），且按本段的平均写入速率估计不到
+    // kMaxPrepareLeadNs 就写满时准备；只有一帧、没有速率可估时写满 3/4 就准备
+    if (used >= m_policy.maxBytes - m_policy.maxBytes / 4 &&
+        (used == 0 || used >= m_policy.maxBytes || elapsedNs <= 0 ||
+         double(m_policy.maxBytes - used) * double(elapsedNs) / double(used) <=
+             double(kMaxPrepareLeadNs)))
+      return true;
+  }
+  return false;
+}
+
+void RecordSegmenter::frameWritten(uint64_t frameNum, int64_t grabTimeNs) {
+  if (m_current.frames == 0) {
+    m_current.firstFrameNum = frameNum;
+    m_current.firstGrabNs = grabTimeNs;
+  }
+  if (!m_windowStarted) {
+    m_windowStartNs = grabTimeNs;
+    m_windowStarted = true;
+  }
+  m_current.lastFrameNum = frameNum;
+  m_current.lastGrabNs = grabTimeNs;
+  ++m_current.frames;
+}
+
+RecordSegmenter::Segment RecordSegmenter::rollOver() {
+  const Segment done = m_current;
+  m_current = Segment();
+  m_current.index = done.index + 1;
+  m_windowStartNs = 0;
+  m_windowBaseBytes = 0;
+  m_windowStarted = false;
+  return done;
+}
+
+void RecordSegmenter::deferRollOver(int64_t grabTimeNs,
+                                    uint64_t segmentBytes) {
+  m_windowStartNs = grabTimeNs;
+  m_windowBaseBytes = segmentBytes;
+  m_windowStarted = true;
+}
+
+std::string RecordSegmenter::segmentPath(const std::string &basePath,
+                                         int index) {
+  const std::size_t slash = basePath.find_last_of("/\\");
+  const std::size_t nameStart = slash == std::string::npos ? 0 : slash + 1;
+  std::size_t dot = basePath.find_last_of('.');
+  // 目录名里的点、以点开头的文件名（".avi"）都不算扩展名
+  if (dot == std::string::npos || dot <= nameStart)
+    dot = basePath.size();
+  char suffix[16];
+  std::snprintf(suffix, sizeof(suffix), "_%03d", index);
+  return basePath.substr(0, dot) + suffix + basePath.substr(dot);
+}
@@ -0,0 +1,89 @@
+#ifndef RECORDSEGMENTER_H
+#define RECORDSEGMENTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 长时间录制分段：决定在哪一帧之前换新文件（无 Qt/SDK 依赖，可单测）
+ *
+ * 过夜实验录成一个几百 GB 的文件，拷贝、校验都慢，坏一处整个文件难救。
+ * 开启分段后每满 N 分钟或 N 字节换一个新文件，文件名按段号编号：
+ * run.avi → run_001.avi、run_002.avi ...
+ *
+ * 只在帧与帧之间换段：写下一帧前问 shouldRollOver，是就先换文件再写这帧，
+ * 一帧要么整帧在上一段、要么整帧在下一段，段与段之间不缺帧也不重帧。
+ * 时长按帧的采集时刻算（不是写盘时刻），各段时长与相机时间一致。
+ *
+ * 下一段的文件要在换段之前就在别的线程打开好（shouldPrepare），写帧的线程
+ * 换段时只做交接，不等打开文件。
+ *
+ * 线程：不加锁，调用方串行化（CameraController 里由 m_recordMutex 保护）。
+ */
+class RecordSegmenter {
+public:
+  // 离换段还剩多久开始准备下一段：周期的 1/4，最多 5 秒
+  static constexpr int64_t kMaxPrepareLeadNs = 5'000'000'000;
+
+  struct Policy {
+    int64_t maxDurationNs = 0; // 每段最长（段首帧起的采集时长），0 = 不限
+    uint64_t maxBytes = 0; // 每段文件大小上限（关闭时写的索引另算），0 = 不限
+    bool enabled() const { return maxDurationNs > 0 || maxBytes > 0; }
+  };
+
+  // 一段的帧范围；index 从 1 开始
+  struct Segment {
+    int index = 0;
+    uint64_t frames = 0;
+    uint64_t firstFrameNum = 0;
+    uint64_t lastFrameNum = 0;
+    int64_t firstGrabNs = 0;
+    int64_t lastGrabNs = 0;
+  };
+
+  // 开始一次录制：回到第 1 段
+  void start(const Policy &policy);
+  const Policy &policy() const { return m_policy; }
+
+  /**
+   * @brief 写下一帧前调用：当前段已有帧，且这帧的采集时刻距段首帧满
+   * maxDurationNs，或 segmentBytes（当前段文件已写字节）加上这帧会超过
+   * maxBytes 时返回 true。空段永远不换，一帧比上限还大时一段一帧
+   */
+  bool shouldRollOver(int64_t grabTimeNs, uint64_t segmentBytes,
+                      std::size_t frameBytes) const;
+  /**
+   * @brief 当前段快到上限时返回 true（之后一直为 true，直到换段）：
+   * 按时长离 maxDurationNs 不到提前量；按大小已写满 3/4，或按本段的写入
+   * 速率折算离 maxBytes 不到提前量。空段返回 false
+   */
+  bool shouldPrepare(int64_t grabTimeNs, uint64_t segmentBytes) const;
+  // 一帧成功写进当前段
+  void frameWritten(uint64_t frameNum, int64_t grabTimeNs);
+  // 新文件已打开：换到下一段，返回刚结束那段的帧范围
+  Segment rollOver();
+  /**
+   * @brief 新文件打不开：继续写当前段，从这帧起满一个周期（时长 / 字节数
+   * 按此刻重新计）再试，不逐帧重试
+   */
+  void deferRollOver(int64_t grabTimeNs, uint64_t segmentBytes);
+
+  const Segment &current() const { return m_current; }
+
+  /**
+   * @brief 第 index 段的文件名："D:/data/run.avi", 3 → "D:/data/run_003.avi"
+   * 扩展名只看最后一个路径分隔符之后；段号不足 3 位补 0
+   */
+  static std::string segmentPath(const std::string &basePath, int index);
+
+private:
+  Policy m_policy;
+  Segment m_current;
+  // 时长 / 字节数从这里开始计：段首帧，或上一次换段失败的那一帧
+  int64_t m_windowStartNs = 0;
+  uint64_t m_windowBaseBytes = 0;
+  bool m_windowStarted = false;
+};
+
+#endif // RECORDSEGMENTER_H
@@ -1,64 +1,21 @@
 ﻿#include "RecordingDiagnostics.h"
+#include "PixelFormats.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 namespace RecordingDiagnostics {
 
-// 海康 MvGvspPixelType 常用值（来自 SDK 头文件 PixelType.h）
-// 完整列表很长，这里只列我们关心的"可直接录制"白名单。
-namespace {
-constexpr quint32 PT_Mono8 = 0x01080001;
-constexpr quint32 PT_RGB8_Packed = 0x02180014;  // RGB8
-constexpr quint32 PT_BGR8_Packed = 0x02180015;  // BGR8
-constexpr quint32 PT_YUV422_Packed = 0x02100032;
-constexpr quint32 PT_YUV422_YUYV_Packed = 0x02100047;
-
-constexpr quint32 PT_BayerGR8 = 0x01080008;
-constexpr quint32 PT_BayerRG8 = 0x01080009;
-constexpr quint32 PT_BayerGB8 = 0x0108000A;
-constexpr quint32 PT_BayerBG8 = 0x0108000B;
-constexpr quint32 PT_BayerRG10 = 0x0110000D;
-constexpr quint32 PT_BayerRG12 = 0x01100011;
-} // namespace
-
 bool isPixelTypeDirectlyRecordable(quint32 t) {
-  switch (t) {
-  case PT_Mono8:
-  case PT_RGB8_Packed:
-  case PT_BGR8_Packed:
-  case PT_YUV422_Packed:
-  case PT_YUV422_YUYV_Packed:
-    return true;
-  default:
-    return false;
-  }
+  const PixelFormats::Descriptor *d = PixelFormats::find(t);
+  return d && d->recordable;
 }
 
 QString pixelTypeName(quint32 t) {
-  switch (t) {
-  case PT_Mono8:
-    return QStringLiteral("Mono8");
-  case PT_RGB8_Packed:
-    return QStringLiteral("RGB8");
-  case PT_BGR8_Packed:
-    return QStringLiteral("BGR8");
-  case PT_YUV422_Packed:
-    return QStringLiteral("YUV422");
-  case PT_YUV422_YUYV_Packed:
-    return QStringLiteral("YUV422_YUYV");
-  case PT_BayerGR8:
-    return QStringLiteral("BayerGR8");
-  case PT_BayerRG8:
-    return QStringLiteral("BayerRG8");
-  case PT_BayerGB8:
-    return QStringLiteral("BayerGB8");
-  case PT_BayerBG8:
-    return QStringLiteral("BayerBG8");
-  case PT_BayerRG10:
-    return QStringLiteral("BayerRG10");
-  case PT_BayerRG12:
-    return QStringLiteral("BayerRG12");
-  default:
-    return QString("0x%1").arg(t, 8, 16, QChar('0'));
-  }
+  if (const PixelFormats::Descriptor *d = PixelFormats::find(t))
+    return QString::fromLatin1(d->name);
+  return QString("0x%1").arg(t, 8, 16, QChar('0'));
 }
 
 QString formatRecordingStats(qint64 totalFrames, qint64 inputOk,
@@ -70,4 +27,150 @@ QString formatRecordingStats(qint64 totalFrames, qint64 inputOk,
       .arg(fileSizeBytes);
 }
 
+namespace {
+QJsonObject percentilesJson(const FrameTelemetry::Percentiles &p) {
+  QJsonObject o;
+  o["count"] = static_cast<qint64>(p.count);
+  o["mean"] = p.mean;
+  o["min"] = static_cast<qint64>(p.min);
+  o["p50"] = static_cast<qint64>(p.p50);
+  o["p95"] = static_cast<qint64>(p.p95);
+  o["p99"] = static_cast<qint64>(p.p99);
+  o["max"] = static_cast<qint64>(p.max);
+  return o;
+}
+
+QJsonObject telemetryJson(const FrameTelemetry::Summary &t) {
+  QJsonObject telemetry;
+  telemetry["frames"] = static_cast<qint64>(t.frames);
+  telemetry["lostFrames"] = static_cast<qint64>(t.lostFrames);
+  telemetry["gapEvents"] = static_cast<qint64>(t.gapEvents);
+  telemetry["largestGap"] = static_cast<qint64>(t.largestGap);
+  telemetry["counterResets"] = static_cast<qint64>(t.counterResets);
+  telemetry["firstFrameNum"] = static_cast<qint64>(t.firstFrameNum);
+  telemetry["lastFrameNum"] = static_cast<qint64>(t.lastFrameNum);
+  telemetry["durationSec"] = t.durationSec;
+  telemetry["meanFps"] = t.meanFps;
+  telemetry["latencyUs"] = percentilesJson(t.latencyUs);
+  telemetry["intervalUs"] = percentilesJson(t.intervalUs);
+  telemetry["jitterUs"] = percentilesJson(t.jitterUs);
+  return telemetry;
+}
+} // namespace
+
+QString statsSidecarPath(const QString &videoPath) {
+  return videoPath + QStringLiteral(".stats.json");
+}
+
+bool discardRecording(const QString &videoPath) {
+  QFile::remove(statsSidecarPath(videoPath));
+  return !QFile::exists(videoPath) || QFile::remove(videoPath);
+}
+
+QByteArray recordingReportJson(const RecordingReport &report) {
+  QJsonObject input;
+  input["totalFrames"] = report.totalFrames;
+  input["inputOk"] = report.inputOk;
+  input["inputFail"] = report.inputFail;
+  input["convertFail"] = report.convertFail;
+  input["queueDrop"] = report.queueDrop;
+  input["fileBytes"] = report.fileBytes;
+  input["lastErrCode"] =
+      QString("0x%1").arg(report.lastErrCode, 8, 16, QChar('0'));
+  input["pixelType"] = pixelTypeName(report.pixelType);
+  if (!report.writerError.isEmpty())
+    input["writerError"] = report.writerError;
+
+  QJsonObject root;
+  root["recording"] = input;
+  root["telemetry"] = telemetryJson(report.telemetry);
+  if (report.syncStartNs != 0) {
+    QJsonObject sync;
+    sync["group"] = report.syncGroup;
+    sync["startNs"] = report.syncStartNs;
+    sync["firstFrameGrabNs"] = report.firstFrameGrabNs;
+    // 第一帧相对共同起点的偏移：没有预触发历史时各路最多差一个帧间隔，
+    // 补写了历史时第一帧是历史帧、偏移为负，各路历史长短不一定相同
+    sync["firstFrameOffsetUs"] =
+        report.firstFrameGrabNs > 0
+            ? (report.firstFrameGrabNs - report.syncStartNs) / 1000
+            : qint64(-1);
+    sync["firstFrameDevTimestamp"] =
+        QString::number(report.firstFrameDevTimestamp);
+    root["sync"] = sync;
+  }
+  if (!report.threads.empty()) {
+    QJsonArray threads;
+    for (const ThreadAffinity::Applied &t : report.threads) {
+      QJsonObject thread;
+      thread["name"] = QString::fromStdString(t.thread);
+      thread["core"] = t.requested.core;
+      thread["priority"] =
+          QString::fromLatin1(ThreadAffinity::priorityName(t.requested.priority));
+      thread["pinned"] = t.pinned;
+      thread["prioritized"] = t.prioritized;
+      threads.append(thread);
+    }
+    root["threads"] = threads;
+  }
+  if (report.preTriggerFrames > 0) {
+    QJsonObject preTrigger;
+    preTrigger["frames"] = report.preTriggerFrames;
+    preTrigger["spanMs"] = report.preTriggerSpanMs;
+    preTrigger["lost"] = report.preTriggerLost;
+    root["preTrigger"] = preTrigger;
+  }
+  if (report.segmentIndex > 0) {
+    QJsonObject segment;
+    segment["index"] = report.segmentIndex;
+    segment["frames"] = report.segmentFrames;
+    segment["firstFrameNum"] =
+        static_cast<qint64>(report.segmentFirstFrameNum);
+    segment["lastFrameNum"] = static_cast<qint64>(report.segmentLastFrameNum);
+    segment["firstGrabNs"] = report.segmentFirstGrabNs;
+    segment["lastGrabNs"] = report.segmentLastGrabNs;
+    root["segment"] = segment;
+  }
+  if (report.session.segments > 0) {
+    const RecordingReport::SessionTotals &s = report.session;
+    QJsonObject session;
+    session["segments"] = s.segments;
+    session["totalFrames"] = s.totalFrames;
+    session["inputOk"] = s.inputOk;
+    session["inputFail"] = s.inputFail;
+    session["convertFail"] = s.convertFail;
+    session["queueDrop"] = s.queueDrop;
+    session["preTriggerLost"] = s.preTriggerLost;
+    session["fileBytes"] = s.fileBytes;
+    session["telemetry"] = telemetryJson(s.telemetry);
+    root["session"] = session;
+  }
+  if (report.disk.bytes > 0) {
+    const RecordFile::Stats &d = report.disk;
+    QJsonObject disk;
+    disk["mbPerSec"] = d.mbPerSec();
+    disk["diskMbPerSec"] = d.diskMbPerSec();
+    disk["maxWriteUs"] = static_cast<qint64>(d.maxWriteUs);
+    disk["highWaterBytes"] = static_cast<qint64>(d.highWaterBytes);
+    disk["queueCapacityBytes"] = static_cast<qint64>(d.queueCapacityBytes);
+    disk["producerWaits"] = static_cast<qint64>(d.producerWaits);
+    disk["maxProducerWaitUs"] = static_cast<qint64>(d.maxProducerWaitUs);
+    disk["bufferBytes"] = static_cast<qint64>(d.bufferBytes);
+    disk["bufferCount"] = d.bufferCount;
+    disk["directIo"] = d.directIo;
+    disk["preallocated"] = d.preallocated;
+    root["disk"] = disk;
+  }
+  return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+bool writeRecordingReport(const QString &videoPath,
+                          const RecordingReport &report) {
+  QFile file(statsSidecarPath(videoPath));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  const QByteArray json = recordingReportJson(report);
+  return file.write(json) == json.size();
+}
+
 } // namespace RecordingDiagnostics
@@ -1,8 +1,13 @@
 ﻿#ifndef RECORDINGDIAGNOSTICS_H
 #define RECORDINGDIAGNOSTICS_H
 
+#include "FrameTelemetry.h"
+#include "RecordFile.h"
+#include "ThreadAffinity.h"
+#include <QByteArray>
 #include <QString>
 #include <cstdint>
+#include <vector>
 
 /**
  * @brief 录制相关的纯诊断工具（无 SDK 依赖，可单测）
@@ -12,9 +17,8 @@ namespace RecordingDiagnostics {
 /**
  * @brief 判断一个海康 MvGvspPixelType 值能否直接 AVI 录制。
  *
- * 海康 SDK 的 MV_CC_StartRecord 只支持 Mono8 / BGR8 / RGB8 / YUV422 等少数格式，
- * Bayer / 10/12-bit / 压缩格式 必须先经 MV_CC_ConvertPixelType 转 BGR8 再
- * InputOneFrame。
+ * AviWriter 只写 Mono8 / BGR8 / RGB8 / YUV422 这几种格式，Bayer / 10/12-bit /
+ * 压缩格式必须先转成 Mono8 或 BGR8 再写。格式属性统一查 PixelFormats 表。
  *
  * @param mvGvspPixelType 海康的 MvGvspPixelType 枚举值（uint32）
  */
@@ -29,13 +33,90 @@ QString pixelTypeName(quint32 mvGvspPixelType);
  * @brief 录制结束时把统计数据格式化成给用户看的字符串。
  *
  * @param totalFrames grab 总帧数
- * @param inputOk 调用 MV_CC_InputOneFrame 成功次数
- * @param inputFail 调用 MV_CC_InputOneFrame 失败次数
+ * @param inputOk 写入 AVI 成功的帧数
+ * @param inputFail 写入 AVI 失败的帧数
  * @param fileSizeBytes 最终文件大小（用于检测"0 字节"故障）
  */
 QString formatRecordingStats(qint64 totalFrames, qint64 inputOk,
                              qint64 inputFail, qint64 fileSizeBytes);
 
+/**
+ * @brief 一次录制的完整统计：写入计数 + 采集遥测（丢帧 / 延迟 / 抖动）
+ */
+struct RecordingReport {
+  qint64 totalFrames = 0;
+  qint64 inputOk = 0;
+  qint64 inputFail = 0;
+  qint64 convertFail = 0; // 像素转换失败
+  qint64 queueDrop = 0;   // 录制队列满、没进录制阶段就丢掉的帧
+  qint64 fileBytes = 0;
+  quint32 lastErrCode = 0; // 最后一次 SDK 像素转换的错误码
+  quint32 pixelType = 0;  // 录制实际使用的像素类型
+  QString writerError;    // AVI 写入 / 关闭失败的原因（空 = 成功）
+  FrameTelemetry::Summary telemetry;
+  // 多相机同步录制：共同起点（steady_clock 纳秒，0 表示单路录制）、
+  // 同组编号和本路第一帧的采集时刻 / 设备时间戳，离线按这些对齐各路视频
+  qint64 syncStartNs = 0;
+  QString syncGroup;
+  qint64 firstFrameGrabNs = 0;
+  quint64 firstFrameDevTimestamp = 0;
+  // 预触发：开始录制前已缓存、先写进文件的历史帧数和时间跨度（0 表示未启用），
+  // 以及补写历史期间新帧排不进环尾而丢掉的帧数
+  qint64 preTriggerFrames = 0;
+  qint64 preTriggerSpanMs = 0;
+  qint64 preTriggerLost = 0;
+  // 分段录制：本文件的段号（从 1 开始，0 = 未分段）和帧范围，相邻两段的
+  // 帧号首尾相接。分段时写入计数、遥测、写盘统计都只算本段；同步起点和
+  // 预触发只在第 1 段；整次录制的合计见 session
+  int segmentIndex = 0;
+  qint64 segmentFrames = 0;
+  quint64 segmentFirstFrameNum = 0;
+  quint64 segmentLastFrameNum = 0;
+  qint64 segmentFirstGrabNs = 0;
+  qint64 segmentLastGrabNs = 0;
+  // 分段录制的整次合计，只写进最后一段（segments 为 0 时不写）
+  struct SessionTotals {
+    int segments = 0;
+    qint64 totalFrames = 0;
+    qint64 inputOk = 0;
+    qint64 inputFail = 0;
+    qint64 convertFail = 0;
+    qint64 queueDrop = 0;
+    qint64 preTriggerLost = 0;
+    qint64 fileBytes = 0; // 各段文件大小之和
+    FrameTelemetry::Summary telemetry;
+  };
+  SessionTotals session;
+  // 采集线程实际生效的绑核 / 优先级（权限不足时设置会失败）
+  std::vector<ThreadAffinity::Applied> threads;
+  // 写盘线程统计：持续 MB/s、单次写盘最长耗时、排队峰值（bytes 为 0 表示没有）
+  RecordFile::Stats disk;
+};
+
+/**
+ * @brief 录制统计旁注文件路径：<视频路径>.stats.json
+ * 删除视频时应一并删除
+ */
+QString statsSidecarPath(const QString &videoPath);
+
+/**
+ * @brief 删除作废的录制：视频文件和它的 .stats.json（不存在的跳过）
+ * @return 视频文件还在（删除失败）时返回 false
+ */
+bool discardRecording(const QString &videoPath);
+
+/**
+ * @brief 把录制统计序列化为 JSON（UTF-8，带缩进）
+ */
+QByteArray recordingReportJson(const RecordingReport &report);
+
+/**
+ * @brief 把录制统计写到 statsSidecarPath(videoPath)
+ * @return 写入失败返回 false
+ */
+bool writeRecordingReport(const QString &videoPath,
+                          const RecordingReport &report);
+
 } // namespace RecordingDiagnostics
 
 #endif // RECORDINGDIAGNOSTICS_H
@@ -0,0 +1,19 @@
+#include "RecordingSync.h"
+
+int64_t SyncedStart::run(int count, int *failedIndex) const {
+  if (failedIndex)
+    *failedIndex = -1;
+  for (int i = 0; i < count; ++i) {
+    if (startHeld(i))
+      continue;
+    for (int j = 0; j < i; ++j)
+      abortHeld(j);
+    if (failedIndex)
+      *failedIndex = i;
+    return 0;
+  }
+  const int64_t startNs = nowNs();
+  for (int i = 0; i < count; ++i)
+    release(i, startNs);
+  return startNs;
+}
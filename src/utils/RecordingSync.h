@@ -0,0 +1,65 @@
+#ifndef RECORDINGSYNC_H
+#define RECORDINGSYNC_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief 多相机同步录制的起点闸门（无 Qt/SDK 依赖，可单测）
+ *
+ * 每台相机的录制阶段持有一个闸门，决定一帧是写进录制文件，还是只作为
+ * 预触发历史（预触发环开着时进环，开录后补写在文件开头）：
+ *   - 0（默认）：不同步，开录后每帧都写
+ *   - kHoldNs：文件已打开但还没放行，一帧都不写
+ *   - 其他值：共同起点，只写采集时刻（steady_clock 纳秒）不早于它的帧
+ *
+ * CameraManager 先让各路在 kHoldNs 下开好文件，全部成功后取同一个时刻
+ * 放行，各路文件的第一帧都不早于这个时刻（顺序见 SyncedStart）。
+ *
+ * 线程：set / take 在 UI 线程，admits 在录制阶段和 grab 线程，原子读写。
+ */
+class RecordingSyncGate {
+public:
+  static constexpr int64_t kHoldNs = INT64_MAX;
+
+  void set(int64_t startNs) {
+    m_startNs.store(startNs, std::memory_order_relaxed);
+  }
+  int64_t startNs() const { return m_startNs.load(std::memory_order_relaxed); }
+  // 录制结束：取出起点并回到不同步
+  int64_t take() { return m_startNs.exchange(0); }
+
+  // 采集时刻为 grabTimeNs 的帧是否写进录制文件
+  bool admits(int64_t grabTimeNs) const { return grabTimeNs >= startNs(); }
+  // startNs 是放行后的共同起点（不是不同步，也不是还在等）
+  static bool isCommonStart(int64_t startNs) {
+    return startNs > 0 && startNs != kHoldNs;
+  }
+
+private:
+  std::atomic<int64_t> m_startNs{0};
+};
+
+/**
+ * @brief 同步开录的顺序：依次 hold 开录，全部成功才放行，任一路失败就回滚
+ *
+ * 各步由调用方填入（CameraManager 填各路 CameraController 的操作）。
+ * hold 中的文件还没写过帧，回滚时 abortHeld 直接作废（删文件、不写旁注），
+ * 不能当成一次录完的录制去停止。
+ */
+struct SyncedStart {
+  std::function<bool(int)> startHeld;        // 第 i 路在 kHoldNs 下开好文件
+  std::function<void(int)> abortHeld;        // 作废第 i 路已开好的文件
+  std::function<void(int, int64_t)> release; // 第 i 路从共同起点开始写
+  std::function<int64_t()> nowNs;            // 取共同起点
+
+  /**
+   * @brief 依次 startHeld 0..count-1，全部成功后取一次 nowNs，用同一个起点
+   * release 各路并返回它。第 i 路失败时按 0..i-1 的顺序 abortHeld、一路都不
+   * 放行，返回 0，*failedIndex = i
+   */
+  int64_t run(int count, int *failedIndex = nullptr) const;
+};
+
+#endif // RECORDINGSYNC_H
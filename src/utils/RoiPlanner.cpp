@@ -0,0 +1,69 @@
+#include "RoiPlanner.h"
+#include <algorithm>
+
+namespace RoiPlanner {
+
+namespace {
+
+int alignDown(int value, int inc) {
+  return inc > 1 ? (value / inc) * inc : value;
+}
+
+// 最小值本身未必在步长上：取不小于 min 的第一个对齐值
+int alignUp(int value, int inc) {
+  return inc > 1 ? ((value + inc - 1) / inc) * inc : value;
+}
+
+void planAxis(const char *offsetKey, int currentOffset, int targetOffset,
+              const char *sizeKey, int currentSize, int targetSize,
+              std::vector<RoiStep> &steps) {
+  const bool offsetChanged = targetOffset != currentOffset;
+  const bool sizeChanged = targetSize != currentSize;
+  if (targetSize <= currentSize) {
+    if (sizeChanged)
+      steps.push_back({sizeKey, targetSize});
+    if (offsetChanged)
+      steps.push_back({offsetKey, targetOffset});
+  } else {
+    if (offsetChanged)
+      steps.push_back({offsetKey, targetOffset});
+    steps.push_back({sizeKey, targetSize});
+  }
+}
+
+} // namespace
+
+Roi align(const Roi &requested, const RoiLimits &limits) {
+  Roi roi;
+  const int widthMin = std::min(alignUp(std::max(1, limits.widthMin),
+                                        limits.widthInc),
+                                limits.widthMax);
+  const int heightMin = std::min(alignUp(std::max(1, limits.heightMin),
+                                         limits.heightInc),
+                                 limits.heightMax);
+  roi.width = std::clamp(alignDown(requested.width, limits.widthInc), widthMin,
+                         std::max(widthMin, alignDown(limits.widthMax,
+                                                      limits.widthInc)));
+  roi.height =
+      std::clamp(alignDown(requested.height, limits.heightInc), heightMin,
+                 std::max(heightMin,
+                          alignDown(limits.heightMax, limits.heightInc)));
+  roi.x = alignDown(std::clamp(requested.x, 0,
+                               std::max(0, limits.widthMax - roi.width)),
+                    limits.offsetXInc);
+  roi.y = alignDown(std::clamp(requested.y, 0,
+                               std::max(0, limits.heightMax - roi.height)),
+                    limits.offsetYInc);
+  return roi;
+}
+
+std::vector<RoiStep> plan(const Roi &current, const Roi &target) {
+  std::vector<RoiStep> steps;
+  planAxis("OffsetX", current.x, target.x, "Width", current.width,
+           target.width, steps);
+  planAxis("OffsetY", current.y, target.y, "Height", current.height,
+           target.height, steps);
+  return steps;
+}
+
+} // namespace RoiPlanner
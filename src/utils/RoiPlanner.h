@@ -0,0 +1,56 @@
+#ifndef ROIPLANNER_H
+#define ROIPLANNER_H
+
+#include <vector>
+
+/**
+ * @brief ROI（OffsetX / OffsetY / Width / Height）变更的对齐与写入顺序（纯函数，可单测）
+ *
+ * 相机要求任何时刻 Offset + 尺寸 <= 传感器最大尺寸，而且每次只能写一个节点：
+ * 从右下角的小窗口挪到左上角的大窗口时，先写尺寸会越界，先写偏移才对；
+ * 反过来缩小时要先缩尺寸再挪偏移。两个轴互不影响，分别按
+ * "目标尺寸不比当前大 → 先尺寸后偏移，否则先偏移后尺寸" 排序，
+ * 每一步写完都满足约束。
+ */
+struct Roi {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+
+  bool isEmpty() const { return width <= 0 || height <= 0; }
+  bool operator==(const Roi &o) const {
+    return x == o.x && y == o.y && width == o.width && height == o.height;
+  }
+  bool operator!=(const Roi &o) const { return !(*this == o); }
+};
+
+struct RoiLimits {
+  int widthMax = 0;  // 传感器最大宽度（WidthMax，与当前偏移无关）
+  int heightMax = 0;
+  int widthMin = 1;
+  int heightMin = 1;
+  int widthInc = 1;
+  int heightInc = 1;
+  int offsetXInc = 1;
+  int offsetYInc = 1;
+};
+
+// 一次节点写入：key 为 "OffsetX" / "OffsetY" / "Width" / "Height"
+struct RoiStep {
+  const char *key = nullptr;
+  int value = 0;
+};
+
+namespace RoiPlanner {
+
+// 尺寸向下对齐到步长并夹到 [min, max]，偏移向下对齐并保证窗口不出传感器
+Roi align(const Roi &requested, const RoiLimits &limits);
+
+// 从 current 变到 target 的写入序列；两者都必须已经在传感器范围内。
+// 没变化的节点不写
+std::vector<RoiStep> plan(const Roi &current, const Roi &target);
+
+} // namespace RoiPlanner
+
+#endif // ROIPLANNER_H
@@ -0,0 +1,97 @@
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ThreadAffinity {
+
+namespace {
+#if defined(__linux__)
+// SCHED_FIFO 取低档，高于所有普通线程但不压过内核的中断线程（默认 50）
+constexpr int kRealtimePriority = 10;
+constexpr int kHighNice = -10;
+#endif
+} // namespace
+
+int coreCount() {
+  const unsigned int n = std::thread::hardware_concurrency();
+  return n > 0 ? static_cast<int>(n) : 1;
+}
+
+bool pinCurrentThread(int core) {
+  if (core < 0 || core >= coreCount())
+    return false;
+#if defined(_WIN32)
+  // 超过 64 核需要处理器组，这里只覆盖第一组
+  if (core >= static_cast<int>(sizeof(DWORD_PTR) * 8))
+    return false;
+  return SetThreadAffinityMask(GetCurrentThread(),
+                               static_cast<DWORD_PTR>(1) << core) != 0;
+#elif defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(core, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+bool setCurrentThreadPriority(Priority priority) {
+  if (priority == Priority::Normal)
+    return true;
+#if defined(_WIN32)
+  const int level = priority == Priority::Realtime
+                        ? THREAD_PRIORITY_TIME_CRITICAL
+                        : THREAD_PRIORITY_HIGHEST;
+  return SetThreadPriority(GetCurrentThread(), level) != 0;
+#elif defined(__linux__)
+  if (priority == Priority::Realtime) {
+    sched_param param{};
+    param.sched_priority =
+        std::clamp(kRealtimePriority, sched_get_priority_min(SCHED_FIFO),
+                   sched_get_priority_max(SCHED_FIFO));
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+  }
+  // Linux 的 nice 值是按线程（tid）算的
+  const id_t tid = static_cast<id_t>(syscall(SYS_gettid));
+  return setpriority(PRIO_PROCESS, tid, kHighNice) == 0;
+#else
+  return false;
+#endif
+}
+
+Applied applyToCurrentThread(const std::string &thread,
+                             const ThreadSetting &setting) {
+  Applied applied;
+  applied.thread = thread;
+  applied.requested = setting;
+  if (setting.core >= 0)
+    applied.pinned = pinCurrentThread(setting.core);
+  if (setting.priority != Priority::Normal)
+    applied.prioritized = setCurrentThreadPriority(setting.priority);
+  return applied;
+}
+
+const char *priorityName(Priority priority) {
+  switch (priority) {
+  case Priority::High:
+    return "high";
+  case Priority::Realtime:
+    return "realtime";
+  case Priority::Normal:
+    break;
+  }
+  return "normal";
+}
+
+} // namespace ThreadAffinity
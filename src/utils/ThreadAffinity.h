@@ -0,0 +1,68 @@
+#ifndef THREADAFFINITY_H
+#define THREADAFFINITY_H
+
+#include <string>
+
+/**
+ * @brief 线程绑核 / 调度优先级（无 Qt/SDK 依赖）
+ *
+ * 多相机同时采集时每台相机的 grab 线程绑到不同的核，避免调度器把几个
+ * 忙碌的 grab 线程挤到同一个核上互相拖慢；grab / 录制线程调高优先级，
+ * 不和 GUI、日志、磁盘回写抢 CPU。不支持的平台上什么也不做。
+ */
+namespace ThreadAffinity {
+
+enum class Priority {
+  Normal,   // 系统默认
+  High,     // Linux nice -10 / Windows THREAD_PRIORITY_HIGHEST
+  Realtime, // Linux SCHED_FIFO / Windows THREAD_PRIORITY_TIME_CRITICAL
+};
+
+// 一个线程的绑核和优先级设置；core < 0 表示不绑核
+struct ThreadSetting {
+  int core = -1;
+  Priority priority = Priority::Normal;
+
+  bool isDefault() const { return core < 0 && priority == Priority::Normal; }
+};
+
+// 采集相关线程的调度配置
+struct Tuning {
+  ThreadSetting grab;    // grab 线程（轮询取帧）
+  ThreadSetting record;  // 写盘阶段：录制 / 连拍
+  ThreadSetting workers; // 其余流水线阶段：显示 / 抓拍
+};
+
+// 某个线程实际生效的结果，写进录制统计
+struct Applied {
+  std::string thread;
+  ThreadSetting requested;
+  bool pinned = false;      // 绑核成功（没要求绑核时为 false）
+  bool prioritized = false; // 优先级设置成功（Normal 时为 false）
+};
+
+// 逻辑核数，取不到时返回 1
+int coreCount();
+
+/**
+ * @brief 把调用线程绑到第 core 个逻辑核
+ * @return core 越界或系统调用失败返回 false（线程继续按默认调度运行）
+ */
+bool pinCurrentThread(int core);
+
+/**
+ * @brief 设置调用线程的调度优先级
+ * Linux 上 Realtime 需要 CAP_SYS_NICE 或 RLIMIT_RTPRIO，High 需要 RLIMIT_NICE，
+ * 权限不够时返回 false，线程保持原优先级
+ */
+bool setCurrentThreadPriority(Priority priority);
+
+// 按 setting 绑核并调优先级，返回实际结果
+Applied applyToCurrentThread(const std::string &thread,
+                             const ThreadSetting &setting);
+
+const char *priorityName(Priority priority);
+
+} // namespace ThreadAffinity
+
+#endif // THREADAFFINITY_H
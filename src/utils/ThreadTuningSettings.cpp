@@ -0,0 +1,62 @@
+#include "ThreadTuningSettings.h"
+#include <QSettings>
+
+namespace ThreadTuningSettings {
+
+namespace {
+
+struct Entry {
+  const char *group;
+  ThreadAffinity::ThreadSetting ThreadAffinity::Tuning::*member;
+};
+
+constexpr Entry kEntries[] = {
+    {"threads/grab", &ThreadAffinity::Tuning::grab},
+    {"threads/record", &ThreadAffinity::Tuning::record},
+    {"threads/workers", &ThreadAffinity::Tuning::workers},
+};
+
+ThreadAffinity::Priority priorityFromName(const QString &name) {
+  for (ThreadAffinity::Priority p :
+       {ThreadAffinity::Priority::High, ThreadAffinity::Priority::Realtime}) {
+    if (name == QLatin1String(ThreadAffinity::priorityName(p)))
+      return p;
+  }
+  return ThreadAffinity::Priority::Normal;
+}
+
+} // namespace
+
+ThreadAffinity::Tuning load(const QSettings &settings) {
+  ThreadAffinity::Tuning tuning;
+  for (const Entry &e : kEntries) {
+    const QString group = QString::fromLatin1(e.group);
+    ThreadAffinity::ThreadSetting &s = tuning.*e.member;
+    bool ok = false;
+    const int core = settings.value(group + "/core", -1).toInt(&ok);
+    s.core = ok && core >= 0 ? core : -1;
+    s.priority = priorityFromName(
+        settings.value(group + "/priority").toString().trimmed().toLower());
+  }
+  return tuning;
+}
+
+void save(QSettings &settings, const ThreadAffinity::Tuning &tuning) {
+  for (const Entry &e : kEntries) {
+    const QString group = QString::fromLatin1(e.group);
+    const ThreadAffinity::ThreadSetting &s = tuning.*e.member;
+    settings.setValue(group + "/core", s.core);
+    settings.setValue(group + "/priority",
+                      QString::fromLatin1(ThreadAffinity::priorityName(s.priority)));
+  }
+  settings.sync();
+}
+
+ThreadAffinity::Tuning load() { return load(QSettings()); }
+
+void save(const ThreadAffinity::Tuning &tuning) {
+  QSettings settings;
+  save(settings, tuning);
+}
+
+} // namespace ThreadTuningSettings
@@ -0,0 +1,23 @@
+#ifndef THREADTUNINGSETTINGS_H
+#define THREADTUNINGSETTINGS_H
+
+#include "utils/ThreadAffinity.h"
+
+class QSettings;
+
+// grab / 流水线线程的绑核和优先级，持久化在 QSettings 的 threads/ 分组下：
+//   threads/<grab|record|workers>/core      逻辑核号，-1 = 不绑核
+//   threads/<grab|record|workers>/priority  normal / high / realtime
+// 缺省或无法识别的值按默认（不绑核、系统默认优先级）处理
+namespace ThreadTuningSettings {
+
+ThreadAffinity::Tuning load(const QSettings &settings);
+void save(QSettings &settings, const ThreadAffinity::Tuning &tuning);
+
+// 用应用默认的 QSettings
+ThreadAffinity::Tuning load();
+void save(const ThreadAffinity::Tuning &tuning);
+
+} // namespace ThreadTuningSettings
+
+#endif // THREADTUNINGSETTINGS_H
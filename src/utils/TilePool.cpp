@@ -0,0 +1,110 @@
+#include "TilePool.h"
+#include <algorithm>
+
+TilePool::TilePool(int workers) {
+  if (workers < 0)
+    workers = std::max(
+        0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+  m_threads.reserve(workers);
+  for (int i = 0; i < workers; ++i)
+    m_threads.emplace_back(&TilePool::workerLoop, this);
+}
+
+TilePool::~TilePool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (std::thread &t : m_threads)
+    t.join();
+}
+
+int TilePool::tileCount(int rows, int threads, int minTileRows) {
+  if (rows <= 0)
+    return 0;
+  const int byRows = std::max(1, rows / std::max(1, minTileRows));
+  return std::min(std::max(1, threads) * kTilesPerThread, byRows);
+}
+
+void TilePool::run(int rows, int minTileRows, const TileFn &fn) {
+  std::lock_guard<std::mutex> runLock(m_runMutex);
+  const int tiles = tileCount(rows, threadCount(), minTileRows);
+  if (tiles == 0)
+    return;
+  if (tiles == 1 || m_threads.empty()) {
+    fn(0, rows);
+    return;
+  }
+
+  Job job;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    job.fn = &fn;
+    job.rows = rows;
+    job.tiles = tiles;
+    job.generation = m_job.generation + 1;
+    m_job = job;
+    m_finishedTiles = 0;
+    m_claim.store(uint64_t(job.generation) << 32, std::memory_order_release);
+  }
+  m_wake.notify_all();
+
+  // 调用线程也领条带，工作线程还没醒时不干等
+  const int mine = drainTiles(job);
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_finishedTiles += mine;
+  m_done.wait(lock, [&] { return m_finishedTiles == tiles; });
+}
+
+bool TilePool::claim(const Job &job, int *tile) {
+  uint64_t cur = m_claim.load(std::memory_order_acquire);
+  for (;;) {
+    if (uint32_t(cur >> 32) != job.generation)
+      return false;
+    const uint32_t next = uint32_t(cur);
+    if (next >= uint32_t(job.tiles))
+      return false;
+    if (m_claim.compare_exchange_weak(cur, cur + 1,
+                                      std::memory_order_acq_rel)) {
+      *tile = int(next);
+      return true;
+    }
+  }
+}
+
+int TilePool::drainTiles(const Job &job) {
+  int count = 0;
+  int tile = 0;
+  while (claim(job, &tile)) {
+    const int y0 = int(int64_t(job.rows) * tile / job.tiles);
+    const int y1 = int(int64_t(job.rows) * (tile + 1) / job.tiles);
+    (*job.fn)(y0, y1);
+    ++count;
+  }
+  return count;
+}
+
+void TilePool::workerLoop() {
+  uint32_t seen = 0;
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock,
+                  [&] { return m_stopping || m_job.generation != seen; });
+      if (m_stopping)
+        return;
+      job = m_job;
+      seen = job.generation;
+    }
+    // 领到的条带没做完之前 run 不会返回，job.fn 一直有效
+    const int count = drainTiles(job);
+    if (count == 0)
+      continue;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finishedTiles += count;
+    if (m_finishedTiles == job.tiles)
+      m_done.notify_one();
+  }
+}
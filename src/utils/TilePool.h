@@ -0,0 +1,86 @@
+#ifndef TILEPOOL_H
+#define TILEPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 固定线程池，把一帧按水平条带分给多个核处理（无 Qt/SDK 依赖，可单测）
+ *
+ * 大画幅（20 MP）Bayer 帧即使用 SIMD 单核转换也可能超过帧间隔。run() 把
+ * [0, rows) 切成若干条带，工作线程和调用线程一起按原子计数领取条带，
+ * 全部完成后才返回：调用方（录制线程）一帧一帧地调用，输出顺序就是帧顺序。
+ *
+ * 条带函数只写自己的行，可以读条带外的行（去马赛克的上下各一行 halo
+ * 直接从完整的源帧读，不需要拷贝）。
+ *
+ * 线程在构造时创建、析构时退出，run 期间不创建线程也不分配内存。
+ * run 可被多个线程调用，互相串行。
+ */
+class TilePool {
+public:
+  // 条带函数：处理 [y0, y1) 行
+  using TileFn = std::function<void(int y0, int y1)>;
+
+  /**
+   * @param workers 工作线程数（不含调用线程）；< 0 时取核数 - 1，
+   *   0 表示只在调用线程上串行执行
+   */
+  explicit TilePool(int workers = -1);
+  ~TilePool();
+
+  TilePool(const TilePool &) = delete;
+  TilePool &operator=(const TilePool &) = delete;
+
+  int workerCount() const { return static_cast<int>(m_threads.size()); }
+  // 参与处理的线程数（工作线程 + 调用线程）
+  int threadCount() const { return workerCount() + 1; }
+
+  /**
+   * @brief 条带数：每线程 kTilesPerThread 条以均衡负载，每条至少 minTileRows 行
+   */
+  static int tileCount(int rows, int threads, int minTileRows);
+
+  /**
+   * @brief 并行处理 [0, rows)，全部条带完成后返回
+   * @param minTileRows 每条带的最少行数（太细时调度开销大于收益）
+   */
+  void run(int rows, int minTileRows, const TileFn &fn);
+
+  static constexpr int kTilesPerThread = 2;
+
+private:
+  struct Job {
+    const TileFn *fn = nullptr;
+    int rows = 0;
+    int tiles = 0;
+    uint32_t generation = 0;
+  };
+
+  void workerLoop();
+  // 领取 job 的下一个条带；job 已领完或已被下一次 run 取代时返回 false
+  bool claim(const Job &job, int *tile);
+  // 领取并处理条带直到领完，返回处理的条数
+  int drainTiles(const Job &job);
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_runMutex; // 串行化 run
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  Job m_job;               // m_mutex 保护
+  int m_finishedTiles = 0; // m_mutex 保护
+  bool m_stopping = false;
+  // 高 32 位：job.generation；低 32 位：下一个待领的条带。
+  // 带上 generation，醒得晚的工作线程不会领到下一次 run 的条带
+  std::atomic<uint64_t> m_claim{0};
+};
+
+#endif // TILEPOOL_H
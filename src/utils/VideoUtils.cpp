@@ -1,4 +1,5 @@
 ﻿#include "VideoUtils.h"
+#include "WvrFormat.h"
 
 #include <QChar>
 #include <QFile>
@@ -63,33 +64,39 @@ QString formatFileSize(qint64 bytes) {
 // 时长 = totalFrames * microSecPerFrame / 1e6
 // ============================================================================
 
-double parseAviDuration(const QByteArray &header) {
+// 读 avih 的 dwMicroSecPerFrame / dwTotalFrames；不是有效 AVI 返回 false
+static bool readAvih(const QByteArray &header, quint32 &microSecPerFrame,
+                     quint32 &totalFrames) {
   if (header.size() < 64) {
-    return 0.0;
+    return false;
   }
   // 验证 RIFF...AVI  签名
   if (header.mid(0, 4) != QByteArray("RIFF") ||
       header.mid(8, 4) != QByteArray("AVI ")) {
-    return 0.0;
+    return false;
   }
 
   const int avihPos = header.indexOf("avih");
   if (avihPos < 0 || avihPos + 4 + 4 + 20 > header.size()) {
-    return 0.0;
+    return false;
   }
 
   // 跳过 "avih"(4) 和 size 字段(4)，开始读 struct
   const char *data = header.constData() + avihPos + 8;
-  quint32 microSecPerFrame = 0;
-  quint32 totalFrames = 0;
   std::memcpy(&microSecPerFrame, data, 4);
   std::memcpy(&totalFrames, data + 16, 4);
 
   // AVI 是 little-endian
   microSecPerFrame = qFromLittleEndian(microSecPerFrame);
   totalFrames = qFromLittleEndian(totalFrames);
+  return true;
+}
 
-  if (microSecPerFrame == 0 || totalFrames == 0) {
+double parseAviDuration(const QByteArray &header) {
+  quint32 microSecPerFrame = 0;
+  quint32 totalFrames = 0;
+  if (!readAvih(header, microSecPerFrame, totalFrames) ||
+      microSecPerFrame == 0 || totalFrames == 0) {
     return 0.0;
   }
   return static_cast<double>(totalFrames) * microSecPerFrame / 1'000'000.0;
@@ -219,31 +226,74 @@ double parseMp4Duration(const QByteArray &data) {
   return static_cast<double>(duration) / static_cast<double>(timescale);
 }
 
+// ============================================================================
+// WVR 解析
+// ============================================================================
+//
+// 文件头是 WvrFormat::FileHeader（小端，104 字节），正常关闭时 frameCount
+// 是总帧数，录制中途 / 崩溃时是最后一个检查点覆盖的帧数。v1（不压缩）
+// 和 v2（无损压缩）的文件头相同，时长的算法也一样。
+// ============================================================================
+
+VideoProbe parseWvrHeader(const QByteArray &header) {
+  VideoProbe probe;
+  WvrFormat::FileHeader h;
+  if (header.size() < static_cast<qsizetype>(sizeof(h))) {
+    return probe;
+  }
+  std::memcpy(&h, header.constData(), sizeof(h));
+  if (std::memcmp(h.magic, WvrFormat::kMagic, sizeof(h.magic)) != 0 ||
+      h.version < WvrFormat::kMinVersion || h.version > WvrFormat::kVersion) {
+    return probe;
+  }
+  probe.frameCount = static_cast<qint64>(h.frameCount);
+  if (h.fps > 0.0) {
+    probe.durationSeconds = static_cast<double>(h.frameCount) / h.fps;
+  }
+  return probe;
+}
+
 // ============================================================================
 // 文件入口
 // ============================================================================
 
-double parseVideoDurationFromFile(const QString &filepath) {
+VideoProbe probeVideoFile(const QString &filepath) {
+  VideoProbe probe;
   QFile file(filepath);
   if (!file.open(QIODevice::ReadOnly)) {
-    return 0.0;
+    return probe;
   }
-  // 读前 4KB 足够覆盖大多数 AVI/MP4 的头部 box
+  // 读前 4KB 足够覆盖大多数 AVI/MP4 的头部 box 和整个 WVR 文件头
   const QByteArray head = file.read(4096);
   file.close();
   if (head.size() < 12) {
-    return 0.0;
+    return probe;
   }
 
   // 优先按签名判断
   if (head.mid(0, 4) == QByteArray("RIFF") &&
       head.mid(8, 4) == QByteArray("AVI ")) {
-    return parseAviDuration(head);
+    quint32 microSecPerFrame = 0;
+    quint32 totalFrames = 0;
+    if (readAvih(head, microSecPerFrame, totalFrames)) {
+      probe.frameCount = totalFrames;
+    }
+    probe.durationSeconds = parseAviDuration(head);
+    return probe;
   }
   if (head.size() >= 8 && std::memcmp(head.constData() + 4, "ftyp", 4) == 0) {
-    return parseMp4Duration(head);
+    probe.durationSeconds = parseMp4Duration(head);
+    return probe;
+  }
+  if (std::memcmp(head.constData(), WvrFormat::kMagic,
+                  sizeof(WvrFormat::kMagic)) == 0) {
+    return parseWvrHeader(head);
   }
-  return 0.0;
+  return probe;
+}
+
+double parseVideoDurationFromFile(const QString &filepath) {
+  return probeVideoFile(filepath).durationSeconds;
 }
 
 } // namespace VideoUtils
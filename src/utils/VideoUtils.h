@@ -11,6 +11,12 @@
  */
 namespace VideoUtils {
 
+// 文件头里能读到的基本信息；读不出的字段为 0
+struct VideoProbe {
+  double durationSeconds = 0.0;
+  qint64 frameCount = 0;
+};
+
 /**
  * @brief 把秒数格式化成 "mm:ss" 或 "h:mm:ss"
  * @param seconds 秒数，<= 0 返回 "--:--"
@@ -23,11 +29,19 @@ QString formatDuration(double seconds);
 QString formatFileSize(qint64 bytes);
 
 /**
- * @brief 从文件读取视频时长（自动识别 AVI/MP4）
+ * @brief 从文件读取视频时长（自动识别 AVI/MP4/WVR）
  * @return 秒数；无法解析时返回 0.0
  */
 double parseVideoDurationFromFile(const QString &filepath);
 
+/**
+ * @brief 从文件头读取时长和帧数（自动识别 AVI/MP4/WVR）
+ *
+ * 帧数：WVR 取文件头（未正常关闭的取最后一个检查点），AVI 取 avih
+ * （OpenDML 文件只是第一个 RIFF 块的帧数），MP4 不解析（0）。
+ */
+VideoProbe probeVideoFile(const QString &filepath);
+
 // === 以下为暴露出来便于测试的内部函数 ===
 
 /**
@@ -48,6 +62,16 @@ double parseAviDuration(const QByteArray &header);
  */
 double parseMp4Duration(const QByteArray &data);
 
+/**
+ * @brief 从内存字节流解析 .wvr 原始容器的文件头（WvrFormat::FileHeader）
+ *
+ * 时长 = 帧数 / 标称帧率，和 AVI 一致。
+ *
+ * @param header 文件前若干字节（≥ 104）
+ * @return 不是 .wvr 时全为 0
+ */
+VideoProbe parseWvrHeader(const QByteArray &header);
+
 } // namespace VideoUtils
 
 #endif // VIDEOUTILS_H
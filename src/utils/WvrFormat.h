@@ -0,0 +1,123 @@
+#ifndef WVRFORMAT_H
+#define WVRFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief .wvr 原始录制容器的磁盘布局（WvrWriter / WvrReader / VideoUtils 共用）
+ *
+ * 不转换：相机给什么像素格式就原样存什么（含 Bayer、10/12 位打包）。
+ * 默认不编码；codec = kCodecLossless 时帧按 LosslessCodec 无损压缩，
+ * 每帧的 FrameRecord::encoding 说明这一帧是压缩的还是原样（压不动的
+ * 帧原样存）。全部小端，结构体按自然对齐排好、没有隐式填充，写读两端直接
+ * memcpy（只支持小端主机，x86 / ARM 都是）。
+ *
+ *   [0, 4096)      FileHeader，其余补 0
+ *   帧块           FrameRecord(64) + 像素数据，补齐到 4096 的整数倍
+ *   …
+ *   检查点         IndexRecord(kind=Checkpoint) + 本段各帧块的偏移，补齐
+ *   帧块 …
+ *   尾索引         IndexRecord(kind=Trailer) + 全部帧块的偏移，补齐
+ *
+ * 每个块都从 4 KB 边界开始，块内像素从块头后 64 字节开始（缓存行对齐）。
+ * 每 checkpointFrames 帧写一个检查点，并回填文件头的 lastCheckpoint：
+ * 录制中途断电 / 崩溃时，读端顺着检查点链（prevCheckpoint）拿回到最后
+ * 一个检查点为止的索引，只需逐块扫描其后不到一个间隔的帧。正常关闭时
+ * 写尾索引并回填 frameCount / trailerOffset，读端一次读完索引。
+ *
+ * 版本：1 = 不压缩（codec 字段在 v1 文件里是补齐的 0）；2 = 有压缩帧，
+ * 帧块大小随帧变化，扫描按块头的 chunkBytes 前进。不压缩的文件仍写 1，
+ * 旧版本程序照样能读。
+ */
+namespace WvrFormat {
+
+constexpr char kMagic[8] = {'W', 'V', 'R', 'A', 'W', '\r', '\n', '\x1a'};
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kMinVersion = 1; // 读端能读的最老版本
+constexpr uint32_t kHeaderBytes = 4096;
+constexpr uint32_t kAlignment = 4096;
+
+constexpr uint32_t kFrameMagic = 0x52465657; // "WVFR"
+constexpr uint32_t kIndexMagic = 0x58495657; // "WVIX"
+
+enum HeaderFlags : uint32_t {
+  kFlagComplete = 1u << 0, // 正常关闭：frameCount / trailerOffset 可信
+};
+
+// 文件的编码方式（FileHeader::codec）和单帧的编码（FrameRecord::encoding）
+enum Codec : uint32_t {
+  kCodecNone = 0,     // 原样
+  kCodecLossless = 1, // LosslessCodec 码流
+};
+
+enum class IndexKind : uint32_t {
+  Checkpoint = 1, // 覆盖上一个检查点之后的帧
+  Trailer = 2,    // 覆盖全部帧，正常关闭时写
+};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerBytes; // 第一个块的位置
+  uint32_t alignment;   // 块对齐
+  uint32_t flags;       // HeaderFlags
+  uint32_t pixelType;   // 海康 MvGvspPixelType
+  uint32_t width;
+  uint32_t height;
+  uint32_t checkpointFrames;
+  uint64_t frameBytes; // 一帧像素字节数（紧排）
+  double fps;          // 标称帧率
+  uint64_t frameCount; // 正常关闭时回填；录制中途为最后一个检查点的帧数
+  uint64_t trailerOffset;  // 尾索引位置，未正常关闭为 0
+  uint64_t lastCheckpoint; // 最后一个检查点的位置，0 = 还没有
+  int64_t firstGrabTimeNs; // 第一帧的主机时间
+  int64_t lastGrabTimeNs;  // 最后一帧的主机时间（关闭 / 检查点时回填）
+  uint32_t codec;          // Codec，v1 为 0
+  uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 104, "FileHeader 布局");
+
+struct FrameRecord {
+  uint32_t magic;        // kFrameMagic
+  uint32_t recordBytes;  // 本结构大小，像素从块头 + recordBytes 开始
+  uint64_t chunkBytes;   // 整块大小（含补齐）
+  uint64_t index;        // 文件内序号，从 0 起
+  uint64_t frameNum;     // 相机帧号
+  uint64_t devTimestamp; // 设备时间戳
+  int64_t grabTimeNs;    // 主机取到帧的 steady_clock 纳秒
+  uint64_t payloadBytes; // 块内数据字节数（压缩帧为码流长度）
+  uint32_t encoding;     // Codec：本帧是否压缩
+  uint32_t reserved;
+};
+static_assert(sizeof(FrameRecord) == 64, "FrameRecord 布局");
+
+struct IndexRecord {
+  uint32_t magic; // kIndexMagic
+  uint32_t kind;  // IndexKind
+  uint64_t chunkBytes;
+  uint64_t firstFrame; // 条目覆盖 [firstFrame, firstFrame + count)
+  uint64_t count;
+  uint64_t prevCheckpoint; // 上一个检查点的位置，0 = 没有
+  uint64_t reserved;
+  // 后跟 count 个 uint64_t：各帧块的绝对位置
+};
+static_assert(sizeof(IndexRecord) == 48, "IndexRecord 布局");
+
+constexpr uint64_t alignUp(uint64_t bytes) {
+  return (bytes + kAlignment - 1) & ~uint64_t(kAlignment - 1);
+}
+
+// 一个帧块的总大小（payloadBytes 为块内实际数据长度）
+constexpr uint64_t frameChunkBytes(uint64_t payloadBytes) {
+  return alignUp(sizeof(FrameRecord) + payloadBytes);
+}
+
+// 覆盖 count 帧的索引块大小
+constexpr uint64_t indexChunkBytes(uint64_t count) {
+  return alignUp(sizeof(IndexRecord) + count * sizeof(uint64_t));
+}
+
+} // namespace WvrFormat
+
+#endif // WVRFORMAT_H
@@ -0,0 +1,292 @@
+#include "WvrReader.h"
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace WvrFormat;
+
+WvrReader::~WvrReader() { close(); }
+
+bool WvrReader::open(const std::string &path) {
+  close();
+  m_error.clear();
+  if (!mapFile(path))
+    return false;
+
+  if (m_size < kHeaderBytes) {
+    close();
+    return fail("文件太小，不是 .wvr");
+  }
+  std::memcpy(&m_header, m_data, sizeof(m_header));
+  if (std::memcmp(m_header.magic, kMagic, sizeof(kMagic)) != 0) {
+    close();
+    return fail("不是 .wvr 文件");
+  }
+  if (m_header.version < kMinVersion || m_header.version > kVersion ||
+      m_header.headerBytes != kHeaderBytes ||
+      m_header.alignment != kAlignment || m_header.frameBytes == 0) {
+    close();
+    return fail("不支持的 .wvr 版本: " + std::to_string(m_header.version));
+  }
+  // v1 的 codec 位置是补齐的 0
+  if (m_header.version == 1)
+    m_header.codec = kCodecNone;
+  if (m_header.codec != kCodecNone &&
+      (m_header.codec != kCodecLossless ||
+       !LosslessCodec::layoutFor(m_header.pixelType,
+                                 static_cast<int>(m_header.width),
+                                 static_cast<int>(m_header.height),
+                                 &m_layout) ||
+       m_layout.frameBytes() != m_header.frameBytes)) {
+    close();
+    return fail("不支持的 .wvr 编码: " + std::to_string(m_header.codec));
+  }
+
+  m_complete = loadTrailer();
+  if (!m_complete)
+    recover();
+  if (m_offsets.empty()) {
+    close();
+    return fail("文件里没有完整的帧");
+  }
+  return true;
+}
+
+bool WvrReader::mapFile(const std::string &path) {
+#if defined(_WIN32)
+  const int n = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  if (n <= 0)
+    return fail("路径不是合法的 UTF-8");
+  std::wstring wide(static_cast<std::size_t>(n), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], n);
+  // 允许别的进程同时写：录制中的文件也能打开看已经写好的部分
+  HANDLE file = CreateFileW(wide.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return fail("无法打开文件: 错误 " + std::to_string(GetLastError()));
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+    CloseHandle(file);
+    return fail("文件为空");
+  }
+  HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    const DWORD err = GetLastError();
+    CloseHandle(file);
+    return fail("无法映射文件: 错误 " + std::to_string(err));
+  }
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    const DWORD err = GetLastError();
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return fail("无法映射文件: 错误 " + std::to_string(err));
+  }
+  m_fileHandle = file;
+  m_mapping = mapping;
+  m_data = static_cast<const uint8_t *>(view);
+  m_size = static_cast<uint64_t>(size.QuadPart);
+  return true;
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return fail(std::string("无法打开文件: ") + std::strerror(errno));
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return fail("文件为空");
+  }
+  void *view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                      PROT_READ, MAP_SHARED, fd, 0);
+  const int err = errno;
+  // 映射建立后就不再需要描述符
+  ::close(fd);
+  if (view == MAP_FAILED)
+    return fail(std::string("无法映射文件: ") + std::strerror(err));
+  m_data = static_cast<const uint8_t *>(view);
+  m_size = static_cast<uint64_t>(st.st_size);
+  return true;
+#endif
+}
+
+void WvrReader::close() {
+  if (m_data) {
+#if defined(_WIN32)
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    CloseHandle(static_cast<HANDLE>(m_fileHandle));
+    m_mapping = nullptr;
+    m_fileHandle = nullptr;
+#else
+    ::munmap(const_cast<uint8_t *>(m_data), static_cast<std::size_t>(m_size));
+#endif
+  }
+  m_data = nullptr;
+  m_size = 0;
+  m_offsets.clear();
+  m_complete = false;
+}
+
+bool WvrReader::loadTrailer() {
+  if (!(m_header.flags & kFlagComplete) || m_header.trailerOffset == 0)
+    return false;
+  const IndexRecord *trailer =
+      indexAt(m_header.trailerOffset, IndexKind::Trailer);
+  if (!trailer || trailer->firstFrame != 0 ||
+      trailer->count != m_header.frameCount)
+    return false;
+  const uint8_t *entries = reinterpret_cast<const uint8_t *>(trailer + 1);
+  m_offsets.resize(static_cast<std::size_t>(trailer->count));
+  if (!m_offsets.empty())
+    std::memcpy(m_offsets.data(), entries,
+                m_offsets.size() * sizeof(uint64_t));
+  // 只抽查首尾两帧，不为校验把整个文件读一遍
+  if (!m_offsets.empty() &&
+      (!frameAt(m_offsets.front(), 0) ||
+       !frameAt(m_offsets.back(), m_offsets.size() - 1))) {
+    m_offsets.clear();
+    return false;
+  }
+  return true;
+}
+
+void WvrReader::recover() {
+  m_offsets.clear();
+  // 检查点链从新到旧，倒过来就是帧顺序
+  std::vector<const IndexRecord *> chain;
+  uint64_t pos = m_header.lastCheckpoint;
+  while (pos != 0) {
+    const IndexRecord *checkpoint = indexAt(pos, IndexKind::Checkpoint);
+    // 链必须严格往前指，防止损坏的文件绕成环
+    if (!checkpoint || checkpoint->prevCheckpoint >= pos) {
+      chain.clear();
+      break;
+    }
+    chain.push_back(checkpoint);
+    pos = checkpoint->prevCheckpoint;
+  }
+
+  uint64_t resume = kHeaderBytes;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    const IndexRecord *checkpoint = *it;
+    if (checkpoint->firstFrame != m_offsets.size()) {
+      chain.clear();
+      m_offsets.clear();
+      break;
+    }
+    const uint8_t *entries = reinterpret_cast<const uint8_t *>(checkpoint + 1);
+    const std::size_t first = m_offsets.size();
+    m_offsets.resize(first + static_cast<std::size_t>(checkpoint->count));
+    std::memcpy(m_offsets.data() + first, entries,
+                static_cast<std::size_t>(checkpoint->count) * sizeof(uint64_t));
+    resume = static_cast<uint64_t>(
+                 reinterpret_cast<const uint8_t *>(checkpoint) - m_data) +
+             checkpoint->chunkBytes;
+  }
+  if (!m_offsets.empty() && !frameAt(m_offsets.back(), m_offsets.size() - 1)) {
+    m_offsets.clear();
+    resume = kHeaderBytes;
+  }
+  if (m_offsets.empty())
+    resume = kHeaderBytes;
+  scanFrom(resume);
+}
+
+void WvrReader::scanFrom(uint64_t pos) {
+  const uint64_t headerBytes = sizeof(FrameRecord);
+  while (pos + headerBytes <= m_size) {
+    if (frameAt(pos, m_offsets.size())) {
+      m_offsets.push_back(pos);
+      // 压缩帧的块大小逐帧不同，frameAt 已核对过 chunkBytes
+      pos += reinterpret_cast<const FrameRecord *>(m_data + pos)->chunkBytes;
+      continue;
+    }
+    uint32_t magic = 0;
+    std::memcpy(&magic, m_data + pos, sizeof(magic));
+    if (magic != kIndexMagic || pos + sizeof(IndexRecord) > m_size)
+      break;
+    IndexRecord record;
+    std::memcpy(&record, m_data + pos, sizeof(record));
+    if (record.chunkBytes == 0 || record.chunkBytes % kAlignment != 0 ||
+        record.chunkBytes > m_size - pos)
+      break;
+    pos += record.chunkBytes;
+  }
+}
+
+const IndexRecord *WvrReader::indexAt(uint64_t pos, IndexKind kind) const {
+  if (pos < kHeaderBytes || pos % kAlignment != 0 ||
+      pos + sizeof(IndexRecord) > m_size)
+    return nullptr;
+  const auto *record = reinterpret_cast<const IndexRecord *>(m_data + pos);
+  if (record->magic != kIndexMagic ||
+      record->kind != static_cast<uint32_t>(kind) ||
+      record->count > (m_size - pos) / sizeof(uint64_t) ||
+      record->chunkBytes != indexChunkBytes(record->count) ||
+      record->chunkBytes > m_size - pos)
+    return nullptr;
+  return record;
+}
+
+bool WvrReader::frameAt(uint64_t pos, uint64_t index) const {
+  if (pos < kHeaderBytes || pos % kAlignment != 0 ||
+      pos + sizeof(FrameRecord) > m_size)
+    return false;
+  const auto *record = reinterpret_cast<const FrameRecord *>(m_data + pos);
+  if (record->magic != kFrameMagic ||
+      record->recordBytes != sizeof(FrameRecord) || record->index != index)
+    return false;
+  // 原样的帧正好一帧；压缩帧不超过码流上限（文件没用压缩时不该出现）
+  if (record->encoding == kCodecNone) {
+    if (record->payloadBytes != m_header.frameBytes)
+      return false;
+  } else if (record->encoding != m_header.codec ||
+             m_header.codec != kCodecLossless || record->payloadBytes == 0 ||
+             record->payloadBytes > LosslessCodec::maxEncodedBytes(m_layout)) {
+    return false;
+  }
+  return record->chunkBytes == frameChunkBytes(record->payloadBytes) &&
+         record->chunkBytes <= m_size - pos;
+}
+
+bool WvrReader::frame(uint64_t index, Frame *out) const {
+  if (index >= m_offsets.size())
+    return false;
+  const uint64_t pos = m_offsets[static_cast<std::size_t>(index)];
+  if (!frameAt(pos, index))
+    return false;
+  const auto *record = reinterpret_cast<const FrameRecord *>(m_data + pos);
+  out->data = m_data + pos + record->recordBytes;
+  out->bytes = static_cast<std::size_t>(record->payloadBytes);
+  out->encoding = record->encoding;
+  out->frameNum = record->frameNum;
+  out->devTimestamp = record->devTimestamp;
+  out->grabTimeNs = record->grabTimeNs;
+  return true;
+}
+
+bool WvrReader::readFrame(uint64_t index, uint8_t *dst, TilePool *pool) const {
+  Frame f;
+  if (!frame(index, &f))
+    return false;
+  if (f.encoding == kCodecNone) {
+    std::memcpy(dst, f.data, f.bytes);
+    return true;
+  }
+  return LosslessCodec::decode(m_layout, f.data, f.bytes, dst, pool);
+}
+
+bool WvrReader::fail(const std::string &what) {
+  m_error = what;
+  return false;
+}
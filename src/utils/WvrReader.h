@@ -0,0 +1,99 @@
+#ifndef WVRREADER_H
+#define WVRREADER_H
+
+#include "LosslessCodec.h"
+#include "WvrFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class TilePool;
+
+/**
+ * @brief .wvr 原始容器读取器：整个文件只读映射，按帧号 O(1) 取帧
+ *
+ * open 时只读文件头和索引（正常关闭的文件一个尾索引块；没正常关闭的顺着
+ * 检查点链恢复，再逐块扫描最后一个检查点之后的帧）。frame() 返回指向
+ * 映射内存的指针，不拷贝；页面由系统按需调入，随机跳帧不用读前面的数据。
+ * 无损压缩的文件（v2）里 frame() 给出的是码流，readFrame() 解码到调用方
+ * 的缓冲（条带可以分给 TilePool）；原样存的帧 readFrame() 只是一次拷贝。
+ *
+ * 线程：open / close 之外的接口只读，可以多线程同时调用。
+ * 映射在 close() / 析构前有效，frame() 给出的指针同样只在此之前有效。
+ */
+class WvrReader {
+public:
+  struct Frame {
+    const uint8_t *data = nullptr; // 指向映射内存
+    std::size_t bytes = 0;
+    uint32_t encoding = WvrFormat::kCodecNone; // 非 kCodecNone 时 data 是码流
+    uint64_t frameNum = 0;
+    uint64_t devTimestamp = 0;
+    int64_t grabTimeNs = 0;
+  };
+
+  WvrReader() = default;
+  ~WvrReader();
+  WvrReader(const WvrReader &) = delete;
+  WvrReader &operator=(const WvrReader &) = delete;
+
+  // path 为 UTF-8；不是 .wvr / 没有一帧可用时返回 false
+  bool open(const std::string &path);
+  void close();
+
+  bool isOpen() const { return m_data != nullptr; }
+  const std::string &error() const { return m_error; }
+
+  const WvrFormat::FileHeader &header() const { return m_header; }
+  int width() const { return static_cast<int>(m_header.width); }
+  int height() const { return static_cast<int>(m_header.height); }
+  uint32_t pixelType() const { return m_header.pixelType; }
+  double fps() const { return m_header.fps; }
+  std::size_t frameBytes() const {
+    return static_cast<std::size_t>(m_header.frameBytes);
+  }
+  // 文件的编码方式（WvrFormat::Codec），v1 文件为 kCodecNone
+  uint32_t codec() const { return m_header.codec; }
+  uint64_t frameCount() const { return m_offsets.size(); }
+  // 正常关闭（索引来自尾索引）；false 表示是从检查点 / 扫描恢复的
+  bool complete() const { return m_complete; }
+
+  // 取第 index 帧；越界或块头校验失败返回 false
+  bool frame(uint64_t index, Frame *out) const;
+
+  /**
+   * @brief 取第 index 帧的像素到 dst（frameBytes() 字节），压缩帧在这里解码
+   * @param pool 解码的条带分给它；nullptr 时在调用线程上串行
+   * @return 越界、块头校验失败或码流损坏时 false
+   */
+  bool readFrame(uint64_t index, uint8_t *dst, TilePool *pool = nullptr) const;
+
+private:
+  bool mapFile(const std::string &path);
+  bool loadTrailer();
+  void recover();
+  // 从 pos 开始逐块扫描，接在 m_offsets 后面
+  void scanFrom(uint64_t pos);
+  // pos 处完整、类型匹配的索引块；否则 nullptr
+  const WvrFormat::IndexRecord *indexAt(uint64_t pos,
+                                        WvrFormat::IndexKind kind) const;
+  // pos 处是否为第 index 帧的完整帧块
+  bool frameAt(uint64_t pos, uint64_t index) const;
+  bool fail(const std::string &what);
+
+  const uint8_t *m_data = nullptr;
+  uint64_t m_size = 0;
+#if defined(_WIN32)
+  void *m_fileHandle = nullptr;
+  void *m_mapping = nullptr;
+#endif
+  std::string m_error;
+
+  WvrFormat::FileHeader m_header{};
+  LosslessCodec::Layout m_layout; // 压缩文件的采样布局
+  std::vector<uint64_t> m_offsets; // 各帧块的位置
+  bool m_complete = false;
+};
+
+#endif // WVRREADER_H
@@ -0,0 +1,252 @@
+#include "WvrWriter.h"
+#include "PixelFormats.h"
+#include "TilePool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace WvrFormat;
+
+WvrWriter::WvrWriter() = default;
+
+WvrWriter::~WvrWriter() { close(); }
+
+bool WvrWriter::supports(uint32_t pixelType) {
+  return PixelFormats::find(pixelType) != nullptr;
+}
+
+std::size_t WvrWriter::inputFrameBytes(uint32_t pixelType, int width,
+                                       int height) {
+  return PixelFormats::frameBytes(pixelType, width, height);
+}
+
+bool WvrWriter::open(const std::string &path, const Format &format,
+                     const RecordFile::Options &file) {
+  Options options;
+  static_cast<Format &>(options) = format;
+  options.file = file;
+  return open(path, options);
+}
+
+bool WvrWriter::open(const std::string &path, const Options &options) {
+  close();
+  m_error.clear();
+  m_failed = false;
+
+  m_frameBytes =
+      inputFrameBytes(options.pixelType, options.width, options.height);
+  if (m_frameBytes == 0)
+    return fail("不支持的录制格式或尺寸");
+  if (!(options.fps > 0.0))
+    return fail("帧率必须大于 0");
+  m_options = options;
+  m_options.checkpointFrames = std::max<uint32_t>(options.checkpointFrames, 1);
+  m_chunkBytes = frameChunkBytes(m_frameBytes);
+
+  // 压缩：排不出采样布局的格式退回原样，不算错误（summary 里能看到）
+  uint32_t codec = kCodecNone;
+  LosslessCodec::Layout layout;
+  if (options.codec == kCodecLossless &&
+      LosslessCodec::layoutFor(options.pixelType, options.width,
+                               options.height, &layout) &&
+      m_encoder.configure(layout)) {
+    codec = kCodecLossless;
+    if (!m_encodePool || (options.encodeThreads >= 0 &&
+                          m_encodePool->workerCount() != options.encodeThreads))
+      m_encodePool = std::make_unique<TilePool>(options.encodeThreads);
+  } else {
+    m_encodePool.reset();
+  }
+
+  if (!m_file.open(path, options.file))
+    return fileFail();
+
+  std::memset(&m_header, 0, sizeof(m_header));
+  std::memcpy(m_header.magic, kMagic, sizeof(kMagic));
+  // 不压缩的文件仍写 v1，旧版本程序照样能读
+  m_header.version = codec == kCodecNone ? kMinVersion : kVersion;
+  m_header.codec = codec;
+  m_header.headerBytes = kHeaderBytes;
+  m_header.alignment = kAlignment;
+  m_header.pixelType = options.pixelType;
+  m_header.width = static_cast<uint32_t>(options.width);
+  m_header.height = static_cast<uint32_t>(options.height);
+  m_header.checkpointFrames = m_options.checkpointFrames;
+  m_header.frameBytes = m_frameBytes;
+  m_header.fps = options.fps;
+
+  m_offsets.clear();
+  m_checkpointFirst = 0;
+  m_checkpoints = 0;
+  m_inputBytes = 0;
+  m_payloadBytes = 0;
+  m_rawFrames = 0;
+  m_maxEncodeMs = 0.0;
+
+  if (!m_file.append(&m_header, sizeof(m_header)) ||
+      !m_file.appendZeros(kHeaderBytes - sizeof(m_header))) {
+    fileFail();
+    m_file.close();
+    return false;
+  }
+  return true;
+}
+
+bool WvrWriter::writeFrame(const uint8_t *data, std::size_t bytes,
+                           const FrameMeta &meta) {
+  if (!m_file.isOpen() || m_failed) {
+    if (!m_file.isOpen())
+      m_error = "文件未打开";
+    return false;
+  }
+  // 尺寸不符只丢这一帧，不影响后面的帧
+  if (bytes != m_frameBytes) {
+    m_error = "帧大小与录制尺寸不符: " + std::to_string(bytes) + " 字节";
+    return false;
+  }
+
+  FrameRecord record{};
+  record.magic = kFrameMagic;
+  record.recordBytes = sizeof(FrameRecord);
+  record.chunkBytes = m_chunkBytes;
+  record.index = m_offsets.size();
+  record.frameNum = meta.frameNum;
+  record.devTimestamp = meta.devTimestamp;
+  record.grabTimeNs = meta.grabTimeNs;
+  record.payloadBytes = bytes;
+  record.encoding = kCodecNone;
+
+  if (m_header.codec == kCodecLossless) {
+    const auto t0 = std::chrono::steady_clock::now();
+    const std::size_t encoded = m_encoder.encode(data, m_encodePool.get());
+    const double ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - t0)
+                          .count();
+    m_maxEncodeMs = std::max(m_maxEncodeMs, ms);
+    // 压不动（全是噪声）的帧原样存：读端少一次解码
+    if (encoded < bytes) {
+      record.payloadBytes = encoded;
+      record.chunkBytes = frameChunkBytes(encoded);
+      record.encoding = kCodecLossless;
+    } else {
+      ++m_rawFrames;
+    }
+  }
+
+  const uint64_t chunkPos = m_file.pos();
+  if (!m_file.append(&record, sizeof(record)))
+    return fileFail();
+  if (record.encoding == kCodecLossless) {
+    for (const LosslessCodec::Encoder::Piece &piece : m_encoder.pieces())
+      if (!m_file.append(piece.data, piece.bytes))
+        return fileFail();
+  } else if (!m_file.append(data, bytes)) {
+    return fileFail();
+  }
+  if (!m_file.appendZeros(record.chunkBytes - sizeof(record) -
+                          record.payloadBytes))
+    return fileFail();
+  m_inputBytes += bytes;
+  m_payloadBytes += record.payloadBytes;
+
+  if (m_offsets.empty())
+    m_header.firstGrabTimeNs = meta.grabTimeNs;
+  m_header.lastGrabTimeNs = meta.grabTimeNs;
+  m_offsets.push_back(chunkPos);
+
+  const std::size_t pending = m_offsets.size() - m_checkpointFirst;
+  if (pending < m_options.checkpointFrames)
+    return true;
+  // 检查点先交给写盘线程，文件头的回填排在它后面：文件头不会指到还没
+  // 写出的位置
+  const uint64_t checkpointPos = m_file.pos();
+  if (!writeIndex(IndexKind::Checkpoint, m_checkpointFirst, pending))
+    return false;
+  if (!m_file.flush())
+    return fileFail();
+  m_header.lastCheckpoint = checkpointPos;
+  m_header.frameCount = m_offsets.size();
+  m_checkpointFirst = m_offsets.size();
+  ++m_checkpoints;
+  return patchHeader();
+}
+
+bool WvrWriter::writeIndex(IndexKind kind, std::size_t first,
+                           std::size_t count) {
+  IndexRecord record{};
+  record.magic = kIndexMagic;
+  record.kind = static_cast<uint32_t>(kind);
+  record.chunkBytes = indexChunkBytes(count);
+  record.firstFrame = first;
+  record.count = count;
+  record.prevCheckpoint = m_header.lastCheckpoint;
+  const std::size_t entryBytes = count * sizeof(uint64_t);
+  if (!m_file.append(&record, sizeof(record)) ||
+      (count > 0 && !m_file.append(m_offsets.data() + first, entryBytes)) ||
+      !m_file.appendZeros(record.chunkBytes - sizeof(record) - entryBytes))
+    return fileFail();
+  return true;
+}
+
+bool WvrWriter::patchHeader() {
+  return m_file.patch(0, &m_header, sizeof(m_header)) || fileFail();
+}
+
+bool WvrWriter::close() {
+  if (!m_file.isOpen())
+    return true;
+  if (!m_failed) {
+    const uint64_t trailerPos = m_file.pos();
+    if (writeIndex(IndexKind::Trailer, 0, m_offsets.size())) {
+      m_header.trailerOffset = trailerPos;
+      m_header.frameCount = m_offsets.size();
+      m_header.flags |= kFlagComplete;
+      patchHeader();
+    }
+  }
+  if (!m_file.close() && !m_failed)
+    fileFail();
+  return !m_failed;
+}
+
+bool WvrWriter::sync() {
+  if (!m_file.isOpen() || m_failed)
+    return !m_failed;
+  return m_file.sync() || fileFail();
+}
+
+WvrWriter::Stats WvrWriter::stats() const {
+  Stats s;
+  s.frames = m_offsets.size();
+  s.fileBytes = m_file.pos();
+  s.checkpoints = m_checkpoints;
+  s.inputBytes = m_inputBytes;
+  s.payloadBytes = m_payloadBytes;
+  s.rawFrames = m_rawFrames;
+  s.maxEncodeMs = m_maxEncodeMs;
+  return s;
+}
+
+std::string WvrWriter::summary() const {
+  std::string text = std::to_string(m_offsets.size()) + " 帧, " +
+                     std::to_string(m_checkpoints) + " 个检查点";
+  if (m_header.codec != kCodecLossless)
+    return text;
+  const Stats s = stats();
+  char buf[96];
+  std::snprintf(buf, sizeof(buf), ", 无损压缩 %.2f:1, 单帧最长 %.1f ms",
+                s.compressionRatio(), s.maxEncodeMs);
+  text += buf;
+  if (s.rawFrames > 0)
+    text += ", " + std::to_string(s.rawFrames) + " 帧原样存";
+  return text;
+}
+
+bool WvrWriter::fail(const std::string &what) {
+  m_failed = true;
+  m_error = what;
+  return false;
+}
+
+bool WvrWriter::fileFail() { return fail(m_file.error()); }
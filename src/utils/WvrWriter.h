@@ -0,0 +1,135 @@
+#ifndef WVRWRITER_H
+#define WVRWRITER_H
+
+#include "IRecordWriter.h"
+#include "LosslessCodec.h"
+#include "RecordFile.h"
+#include "WvrFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TilePool;
+
+/**
+ * @brief .wvr 原始容器写入器（无 Qt/SDK 依赖，可单测）
+ *
+ * 高帧率实验不要任何编码：帧原样拷进 4 KB 对齐的块，前面带一条 64 字节
+ * 的逐帧元数据（相机帧号、设备时间戳、主机时间）。布局见 WvrFormat.h。
+ * 每帧只有一次 memcpy 进写缓冲，没有行翻转、没有颜色转换；写盘在
+ * RecordFile 的线程上，CPU 开销基本就是这次拷贝和 write 系统调用本身。
+ *
+ * codec = kCodecLossless 时每帧先按 LosslessCodec 无损压缩（条带分给
+ * 自带的 TilePool，在调用线程上等全部条带编完），再写码流；压缩后不比
+ * 原样小的帧原样存。磁盘带宽换 CPU：平坦的琼脂背景通常能压到几分之一。
+ *
+ * 每 checkpointFrames 帧追加一个检查点并回填文件头，崩溃后读端最多
+ * 扫描一个间隔的帧就能恢复；close() 写尾索引、标记完整。
+ *
+ * 线程：非线程安全，由调用方串行调用（录制阶段持 m_recordMutex）。
+ * 出错：同 AviWriter——帧大小不符只丢那一帧，写盘失败是致命的。
+ */
+class WvrWriter : public IRecordWriter {
+public:
+  // 格式（任何 PixelFormats 认识的像素格式）+ 容器参数
+  struct Options : Format {
+    // 每多少帧写一个检查点（回填一次文件头）
+    uint32_t checkpointFrames = 256;
+    // 写盘缓冲 / 直接 I/O / 预分配
+    RecordFile::Options file;
+    // WvrFormat::Codec；像素格式排不出 LosslessCodec::Layout 时退回原样
+    uint32_t codec = WvrFormat::kCodecNone;
+    // 压缩的工作线程数（不含调用线程），< 0 时取核数 - 1
+    int encodeThreads = -1;
+  };
+
+  struct Stats {
+    uint64_t frames = 0;
+    uint64_t fileBytes = 0; // 已写出（含缓冲中）的字节数
+    uint32_t checkpoints = 0;
+    uint64_t inputBytes = 0;   // 收到的像素字节数
+    uint64_t payloadBytes = 0; // 写进帧块的数据字节数（压缩后）
+    uint64_t rawFrames = 0;    // 开了压缩但压不动、原样存的帧
+    double maxEncodeMs = 0.0;  // 单帧压缩的最长耗时
+
+    // 压缩比（原始 / 压缩后），没有帧时为 1
+    double compressionRatio() const {
+      return payloadBytes > 0 ? double(inputBytes) / double(payloadBytes)
+                              : 1.0;
+    }
+  };
+
+  // 构造 / 析构放在 .cpp：m_encodePool 的 TilePool 在这里只有前置声明
+  WvrWriter();
+  ~WvrWriter() override;
+  WvrWriter(const WvrWriter &) = delete;
+  WvrWriter &operator=(const WvrWriter &) = delete;
+
+  // 能直接写的像素格式：PixelFormats 表里的全部格式
+  static bool supports(uint32_t pixelType);
+  // 输入一帧的字节数（紧排，打包格式按链路字节数）；不支持返回 0
+  static std::size_t inputFrameBytes(uint32_t pixelType, int width, int height);
+
+  bool open(const std::string &path, const Options &options);
+  // 容器参数取默认值
+  bool open(const std::string &path, const Format &format,
+            const RecordFile::Options &file) override;
+
+  const char *containerName() const override { return "WVR"; }
+  std::size_t frameBytes() const override { return m_frameBytes; }
+  // 实际使用的编码（请求压缩但格式不支持时为 kCodecNone）
+  uint32_t codec() const { return m_header.codec; }
+
+  bool writeFrame(const uint8_t *data, std::size_t bytes,
+                  const FrameMeta &meta = FrameMeta()) override;
+
+  /**
+   * @brief 写尾索引、回填文件头并关闭
+   * 同步完成：返回时文件已完整。未打开时返回 true
+   */
+  bool close() override;
+
+  bool isOpen() const override { return m_file.isOpen(); }
+  const std::string &error() const override { return m_error; }
+  uint64_t frameCount() const override { return m_offsets.size(); }
+  uint64_t fileBytes() const override { return m_file.pos(); }
+  std::string summary() const override;
+  RecordFile::Stats fileStats() const override { return m_file.stats(); }
+  Stats stats() const;
+
+  // 已经写入的帧全部写到文件（不 fsync、不写尾索引）：录制中别的进程打开
+  // 能读到最新的帧（按检查点 + 扫描恢复）
+  bool sync();
+
+private:
+  // 追加一个索引块，覆盖 m_offsets[first, first + count)
+  bool writeIndex(WvrFormat::IndexKind kind, std::size_t first,
+                  std::size_t count);
+  bool patchHeader();
+  bool fail(const std::string &what);
+  bool fileFail();
+
+  RecordFile m_file;
+  Options m_options;
+  std::string m_error;
+  bool m_failed = false;
+
+  std::size_t m_frameBytes = 0;
+  uint64_t m_chunkBytes = 0; // 不压缩的帧块（含元数据和补齐）
+  WvrFormat::FileHeader m_header{};
+
+  LosslessCodec::Encoder m_encoder;
+  std::unique_ptr<TilePool> m_encodePool; // 只在压缩时创建
+  uint64_t m_inputBytes = 0;
+  uint64_t m_payloadBytes = 0;
+  uint64_t m_rawFrames = 0;
+  double m_maxEncodeMs = 0.0;
+
+  std::vector<uint64_t> m_offsets; // 全部帧块的位置，尾索引用
+  std::size_t m_checkpointFirst = 0; // 上个检查点之后的第一帧
+  uint32_t m_checkpoints = 0;
+};
+
+#endif // WVRWRITER_H
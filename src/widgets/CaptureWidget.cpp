@@ -3,12 +3,16 @@
 #include "data/VideoLibraryService.h"
 #include "services/CameraController.h"
 #include "utils/AppPaths.h"
+#include "utils/PixelFormats.h"
+#include "utils/RecordFileSettings.h"
 #include "utils/RecordingDiagnostics.h"
+#include "utils/ThreadTuningSettings.h"
 #include "utils/VideoUtils.h"
 #include "widgets/ControlPanelWidget.h"
 #include "widgets/VideoDisplayWidget.h"
 #include <QFileInfo>
 #include <QScrollBar>
+#include <QSettings>
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QDir>
@@ -17,6 +21,19 @@
 #include <QShowEvent>
 #include <QSplitter>
 #include <QVBoxLayout>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+// 帧数 / FPS 标签刷新周期（10 Hz）
+constexpr int kStatsIntervalMs = 100;
+constexpr char kPixelWorkflowKey[] = "capture/pixelWorkflow";
+constexpr char kBayerMonoMethodKey[] = "capture/bayerMonoMethod";
+constexpr char kRecordContainerKey[] = "capture/recordContainer";
+constexpr char kRecordLosslessKey[] = "capture/recordLossless";
+} // namespace
 
 // ============================================================================
 // 构造与析构
@@ -48,7 +65,8 @@ void CaptureWidget::setupUI() {
   QSplitter *splitter = new QSplitter(Qt::Horizontal, this);
 
   // 视频显示区
-  // 使用 QScrollArea 包裹 VideoDisplayWidget 以支持缩放
+  // 使用 QScrollArea 包裹画布以支持缩放；VideoDisplayWidget 放在画布上，
+  // 只占视口里看得见的那一块，SDK 只渲染可见区域（见 updateDisplayViewport）
   m_videoContainer = new QWidget(this);
   m_videoContainer->setLayout(new QVBoxLayout());
   m_videoContainer->layout()->setContentsMargins(0, 0, 0, 0);
@@ -58,8 +76,12 @@ void CaptureWidget::setupUI() {
   m_scrollArea->setAlignment(Qt::AlignCenter);
   m_scrollArea->setStyleSheet("background-color: #282828; border: none;");
 
-  m_videoDisplay = new VideoDisplayWidget(m_scrollArea);
-  m_scrollArea->setWidget(m_videoDisplay);
+  m_videoCanvas = new QWidget(m_scrollArea);
+  m_videoCanvas->resize(640, 480);
+  m_videoDisplay = new VideoDisplayWidget(m_videoCanvas);
+  m_videoDisplay->setGeometry(m_videoCanvas->rect());
+  m_scrollArea->setWidget(m_videoCanvas);
+  m_scrollArea->viewport()->installEventFilter(this);
 
   m_videoContainer->layout()->addWidget(m_scrollArea);
 
@@ -98,6 +120,54 @@ void CaptureWidget::setupUI() {
   m_taskInfoEdit->setFixedWidth(150);
   toolLayout->addWidget(m_taskInfoEdit);
 
+  // 用途：打开相机时据此挑像素格式（Bayer 相机录黑白时不再每帧去马赛克）
+  m_workflowCombo = new QComboBox(toolbar);
+  for (PixelFormatNegotiator::Workflow workflow :
+       {PixelFormatNegotiator::Workflow::Preview,
+        PixelFormatNegotiator::Workflow::MonoRecording,
+        PixelFormatNegotiator::Workflow::ColorRecording,
+        PixelFormatNegotiator::Workflow::HighDepthRecording})
+    m_workflowCombo->addItem(
+        QString::fromUtf8(PixelFormatNegotiator::workflowName(workflow)),
+        static_cast<int>(workflow));
+  m_workflowCombo->setToolTip("按用途挑转换和传输代价最小的像素格式");
+  toolLayout->addWidget(m_workflowCombo);
+
+  // Bayer 相机录黑白时 Mono8 怎么取：明场不需要颜色，绿通道最快
+  m_monoMethodCombo = new QComboBox(toolbar);
+  for (BayerDemosaic::MonoMethod method :
+       {BayerDemosaic::MonoMethod::Luma, BayerDemosaic::MonoMethod::Green})
+    m_monoMethodCombo->addItem(
+        QString::fromUtf8(BayerDemosaic::monoMethodName(method)),
+        static_cast<int>(method));
+  m_monoMethodCombo->setToolTip(
+      "Bayer 相机录 Mono8 的取法：加权亮度 (77R+150G+29B) 或只取绿通道");
+  toolLayout->addWidget(m_monoMethodCombo);
+
+  // 录制容器（按扩展名交给 CameraController）：AVI 通用；WVR 不编码不转换，
+  // 高帧率实验用
+  m_containerCombo = new QComboBox(toolbar);
+  m_containerCombo->addItem("AVI", "avi");
+  m_containerCombo->addItem("WVR 原始", "wvr");
+  m_containerCombo->setToolTip(
+      "AVI：未压缩，播放器通用；WVR：相机原始格式直接落盘，可随机跳帧，"
+      "CPU 占用最低");
+  toolLayout->addWidget(m_containerCombo);
+  m_losslessCheck = new QCheckBox("无损压缩", toolbar);
+  m_losslessCheck->setToolTip(
+      "WVR 逐帧无损压缩：琼脂背景通常能省一半以上的磁盘带宽和空间，"
+      "编码占用多个 CPU 核");
+  toolLayout->addWidget(m_losslessCheck);
+
+  // 预触发：开始录制时先写入按键之前这几秒（0 = 关闭）
+  m_preTriggerSpin = new QSpinBox(toolbar);
+  m_preTriggerSpin->setRange(0, 30);
+  m_preTriggerSpin->setValue(0);
+  m_preTriggerSpin->setPrefix("预录 ");
+  m_preTriggerSpin->setSuffix(" 秒");
+  m_preTriggerSpin->setToolTip("在内存里保留最近几秒的画面，开始录制时一并写入");
+  toolLayout->addWidget(m_preTriggerSpin);
+
   m_startRecordBtn = new QPushButton("开始录制", toolbar);
   m_startRecordBtn->setObjectName("primaryButton");
   m_startRecordBtn->setEnabled(false);
@@ -107,6 +177,18 @@ void CaptureWidget::setupUI() {
   toolLayout->addWidget(m_startRecordBtn);
   toolLayout->addWidget(m_stopRecordBtn);
 
+  // 连拍：按相机当前帧率抓满 N 帧到内存，结束后再写盘
+  m_burstFramesSpin = new QSpinBox(toolbar);
+  m_burstFramesSpin->setRange(10, 100000);
+  m_burstFramesSpin->setValue(300);
+  m_burstFramesSpin->setSuffix(" 帧");
+  m_burstFramesSpin->setToolTip("连拍帧数（受内存预算限制）");
+  m_burstBtn = new QPushButton("连拍", toolbar);
+  m_burstBtn->setEnabled(false);
+  m_burstBtn->setToolTip("全部帧先进内存，不编码不写盘；抓满后按所选容器保存");
+  toolLayout->addWidget(m_burstFramesSpin);
+  toolLayout->addWidget(m_burstBtn);
+
   // 缩放控制
   toolLayout->addWidget(new QLabel("|", toolbar)); // 分隔符
 
@@ -126,6 +208,15 @@ void CaptureWidget::setupUI() {
   toolLayout->addWidget(m_zoomInBtn);
   toolLayout->addWidget(m_fitWindowBtn);
 
+  m_roiSelectBtn = new QPushButton("框选 ROI", toolbar);
+  m_roiSelectBtn->setCheckable(true);
+  m_roiSelectBtn->setEnabled(false);
+  m_roiSelectBtn->setToolTip("在画面上拖出矩形作为新的 ROI；预览中修改会短暂中断采集");
+  m_fullRoiBtn = new QPushButton("全幅", toolbar);
+  m_fullRoiBtn->setEnabled(false);
+  toolLayout->addWidget(m_roiSelectBtn);
+  toolLayout->addWidget(m_fullRoiBtn);
+
   toolLayout->addStretch();
 
   // 状态标签（P3：FPS/分辨率/帧数做成 pill badge）
@@ -170,6 +261,119 @@ void CaptureWidget::setupConnections() {
           &CaptureWidget::onStartRecordingClicked);
   connect(m_stopRecordBtn, &QPushButton::clicked, this,
           &CaptureWidget::onStopRecordingClicked);
+  connect(m_burstBtn, &QPushButton::clicked, this,
+          &CaptureWidget::onBurstClicked);
+  connect(m_preTriggerSpin, QOverload<int>::of(&QSpinBox::valueChanged), this,
+          [this](int seconds) { m_camera->setPreTrigger(seconds); });
+
+  // ===== 线程调度：保存在 QSettings，下次开始采集生效 =====
+  const ThreadAffinity::Tuning tuning = ThreadTuningSettings::load();
+  m_camera->setThreadTuning(tuning);
+  m_controlPanel->setThreadTuning(tuning);
+  connect(m_controlPanel, &ControlPanelWidget::threadTuningChanged, this,
+          [this](const ThreadAffinity::Tuning &t) {
+            m_camera->setThreadTuning(t);
+            ThreadTuningSettings::save(t);
+          });
+
+  // ===== 录制写盘：保存在 QSettings，下次开始录制 / 连拍生效 =====
+  const RecordFile::Options fileOptions = RecordFileSettings::load();
+  m_camera->setRecordFileOptions(fileOptions);
+  m_controlPanel->setRecordFileOptions(fileOptions);
+  connect(m_controlPanel, &ControlPanelWidget::recordFileOptionsChanged, this,
+          [this](const RecordFile::Options &o) {
+            m_camera->setRecordFileOptions(o);
+            RecordFileSettings::save(o);
+          });
+  const RecordSegmenter::Policy segmentPolicy =
+      RecordFileSettings::loadSegmentPolicy();
+  m_camera->setRecordSegmentPolicy(segmentPolicy);
+  m_controlPanel->setRecordSegmentPolicy(segmentPolicy);
+  connect(m_controlPanel, &ControlPanelWidget::recordSegmentPolicyChanged,
+          this, [this](const RecordSegmenter::Policy &p) {
+            m_camera->setRecordSegmentPolicy(p);
+            RecordFileSettings::saveSegmentPolicy(p);
+          });
+
+  // ===== 像素格式用途：保存在 QSettings，open 时协商 =====
+  const int savedWorkflow =
+      QSettings()
+          .value(kPixelWorkflowKey,
+                 static_cast<int>(PixelFormatNegotiator::Workflow::MonoRecording))
+          .toInt();
+  m_workflowCombo->setCurrentIndex(
+      std::max(0, m_workflowCombo->findData(savedWorkflow)));
+  m_camera->setPixelWorkflow(static_cast<PixelFormatNegotiator::Workflow>(
+      m_workflowCombo->currentData().toInt()));
+  connect(m_workflowCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, [this](int) {
+            const auto workflow = static_cast<PixelFormatNegotiator::Workflow>(
+                m_workflowCombo->currentData().toInt());
+            if (!m_camera->setPixelWorkflow(workflow)) {
+              // 录制 / 连拍中被拒绝：下拉框回到实际用途
+              QSignalBlocker blocker(m_workflowCombo);
+              m_workflowCombo->setCurrentIndex(m_workflowCombo->findData(
+                  static_cast<int>(m_camera->pixelWorkflow())));
+              return;
+            }
+            QSettings().setValue(kPixelWorkflowKey, static_cast<int>(workflow));
+          });
+  const int savedMonoMethod =
+      QSettings()
+          .value(kBayerMonoMethodKey,
+                 static_cast<int>(BayerDemosaic::MonoMethod::Luma))
+          .toInt();
+  m_monoMethodCombo->setCurrentIndex(
+      std::max(0, m_monoMethodCombo->findData(savedMonoMethod)));
+  m_camera->setBayerMonoMethod(static_cast<BayerDemosaic::MonoMethod>(
+      m_monoMethodCombo->currentData().toInt()));
+  connect(m_monoMethodCombo,
+          QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+          [this](int) {
+            const int method = m_monoMethodCombo->currentData().toInt();
+            m_camera->setBayerMonoMethod(
+                static_cast<BayerDemosaic::MonoMethod>(method));
+            QSettings().setValue(kBayerMonoMethodKey, method);
+          });
+  m_containerCombo->setCurrentIndex(std::max(
+      0, m_containerCombo->findData(
+             QSettings().value(kRecordContainerKey, "avi").toString())));
+  connect(m_containerCombo,
+          QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+          [this](int) {
+            QSettings().setValue(kRecordContainerKey,
+                                 m_containerCombo->currentData().toString());
+            m_losslessCheck->setEnabled(m_containerCombo->currentData() ==
+                                        "wvr");
+          });
+  m_losslessCheck->setChecked(
+      QSettings().value(kRecordLosslessKey, false).toBool());
+  m_losslessCheck->setEnabled(m_containerCombo->currentData() == "wvr");
+  m_camera->setRecordLossless(m_losslessCheck->isChecked());
+  connect(m_losslessCheck, &QCheckBox::toggled, this, [this](bool checked) {
+    m_camera->setRecordLossless(checked);
+    QSettings().setValue(kRecordLosslessKey, checked);
+  });
+  connect(m_camera, &CameraController::pixelFormatNegotiated, this,
+          [this](const PixelFormatNegotiator::Choice &choice,
+                 PixelFormatNegotiator::Workflow workflow) {
+            const QString detail =
+                QString("%1：相机输出 %2，录制 %3；每帧转换约 %4 ms、"
+                        "传输约 %5 ms（%6 KB）")
+                    .arg(QString::fromUtf8(
+                             PixelFormatNegotiator::workflowName(workflow)),
+                         RecordingDiagnostics::pixelTypeName(choice.pixelType),
+                         choice.needsConvert()
+                             ? RecordingDiagnostics::pixelTypeName(
+                                   choice.recordPixelType)
+                             : QString("直接写入"))
+                    .arg(choice.convertUsPerFrame / 1000.0, 0, 'f', 2)
+                    .arg(choice.transferUsPerFrame / 1000.0, 0, 'f', 2)
+                    .arg(choice.bytesPerFrame / 1024.0, 0, 'f', 0);
+            m_workflowCombo->setToolTip(detail);
+            m_statusLabel->setText(detail);
+            m_highBitDepth = PixelFormats::isHighBitDepth(choice.pixelType);
+          });
 
   // ===== 设备选择 =====
   connect(m_refreshDevicesBtn, &QPushButton::clicked, this,
@@ -212,6 +416,35 @@ void CaptureWidget::setupConnections() {
   connect(m_videoDisplay, &VideoDisplayWidget::imageSizeChanged, this,
           [this](int, int) { this->updateVideoLayout(); });
 
+  // ===== Binning / 抽样：选中即预估，点应用才下发 =====
+  connect(m_camera, &CameraController::samplingOptionsReady, this,
+          [this](const SamplingOptions &options, const SamplingMode &current) {
+            m_controlPanel->setSamplingOptions(options, current);
+            m_controlPanel->setSamplingEstimate(
+                m_camera->estimateSamplingMode(current));
+          });
+  connect(m_controlPanel, &ControlPanelWidget::samplingPreviewRequested, this,
+          [this](const SamplingMode &mode) {
+            m_controlPanel->setSamplingEstimate(
+                m_camera->estimateSamplingMode(mode));
+          });
+  connect(m_controlPanel, &ControlPanelWidget::samplingApplyRequested,
+          m_camera, &CameraController::setSamplingMode);
+  connect(m_camera, &CameraController::samplingModeChanged, this,
+          [this](const SamplingMode &mode, const FrameRateEstimate &predicted,
+                 float resultingFps) {
+            m_controlPanel->setSamplingMode(mode);
+            m_statusLabel->setText(
+                QString("Binning %1x%2 抽样 %3x%4：预估最高 %5 fps，"
+                        "相机报告 %6 fps")
+                    .arg(mode.binningH)
+                    .arg(mode.binningV)
+                    .arg(mode.decimationH)
+                    .arg(mode.decimationV)
+                    .arg(predicted.maxFps, 0, 'f', 1)
+                    .arg(resultingFps, 0, 'f', 1));
+          });
+
   // ===== ControlPanel → CameraController (参数设置) =====
   connect(m_controlPanel, &ControlPanelWidget::exposureChanged, m_camera,
           &CameraController::setExposure);
@@ -233,10 +466,15 @@ void CaptureWidget::setupConnections() {
   // ===== CameraController → UI 更新 =====
   connect(m_camera, &CameraController::cameraOpened, this, [this]() {
     m_controlPanel->enableControls(true);
+    m_roiSelectBtn->setEnabled(true);
+    m_fullRoiBtn->setEnabled(true);
     m_statusLabel->setText("相机已连接");
   });
   connect(m_camera, &CameraController::cameraClosed, this, [this]() {
     m_controlPanel->enableControls(false);
+    m_roiSelectBtn->setChecked(false);
+    m_roiSelectBtn->setEnabled(false);
+    m_fullRoiBtn->setEnabled(false);
     m_statusLabel->setText("就绪");
   });
   connect(m_camera, &CameraController::resolutionChanged, this,
@@ -244,16 +482,32 @@ void CaptureWidget::setupConnections() {
             m_resolutionLabel->setText(QString("分辨率: %1x%2").arg(w).arg(h));
             m_videoDisplay->setImageSize(w, h);
           });
-  connect(m_camera, &CameraController::frameRendered, this, [this](int count) {
-    m_frameCountLabel->setText(QString("帧数: %1").arg(count));
-    m_videoDisplay->notifyFrameRendered();
-  });
+  connect(m_camera, &CameraController::telemetryUpdated, this,
+          [this](const FrameTelemetry::Summary &t) {
+            m_lostFrames = t.lostFrames;
+            m_frameCountLabel->setToolTip(
+                QString("丢帧: %1（%2 次，最大 %3）\n"
+                        "延迟 p50/p95/p99: %4 / %5 / %6 µs\n"
+                        "帧间隔 p50/p99: %7 / %8 µs\n"
+                        "抖动 p95/p99: %9 / %10 µs\n"
+                        "可吸收录制停顿: %11 ms")
+                    .arg(t.lostFrames)
+                    .arg(t.gapEvents)
+                    .arg(t.largestGap)
+                    .arg(t.latencyUs.p50)
+                    .arg(t.latencyUs.p95)
+                    .arg(t.latencyUs.p99)
+                    .arg(t.intervalUs.p50)
+                    .arg(t.intervalUs.p99)
+                    .arg(t.jitterUs.p95)
+                    .arg(t.jitterUs.p99)
+                    .arg(qRound(m_camera->bufferSizing().absorbableStallMs)));
+          });
   connect(m_camera, &CameraController::recordingStarted, this,
           [this](const QString &) { m_recordingLabel->setText("● 录制中"); });
   connect(m_camera, &CameraController::recordingStopped, this,
           [this](const QString & /*filePath*/) {
-            // 立即给 UI 反馈，但不在这里入库——SDK 此刻还在 flush AVI 索引，
-            // 入库逻辑移到 recordingStats（1.2s 后触发，那时文件大小才稳定）
+            // 只给 UI 反馈；入库放在 recordingStats（文件关闭、统计齐全后发出）
             m_recordingLabel->setText("");
           });
   connect(m_camera, &CameraController::recordingError, this,
@@ -264,8 +518,45 @@ void CaptureWidget::setupConnections() {
             QMessageBox::warning(this, "录制错误", msg);
           });
 
-  // 录制统计在 SDK flush 完成后 1.2 秒触发，承担两个职责：
-  //   1) bytes > 0 → 把视频入库（路径由 CameraController 记录在 m_recordingPath，
+  // ===== 连拍 =====
+  connect(m_camera, &CameraController::burstStarted, this,
+          [this](const QString &, int frames) {
+            m_burstBtn->setEnabled(false);
+            m_startRecordBtn->setEnabled(false);
+            m_recordingLabel->setText(QString("● 连拍中 (%1 帧)").arg(frames));
+          });
+  connect(m_camera, &CameraController::burstCaptured, this,
+          [this](const BurstCapture::Stats &st) {
+            m_recordingLabel->setText("连拍保存中...");
+            m_statusLabel->setText(QString("连拍 %1/%2 帧, %3 fps, 丢帧 %4")
+                                       .arg(st.captured)
+                                       .arg(st.target)
+                                       .arg(st.achievedFps, 0, 'f', 1)
+                                       .arg(st.dropped));
+          });
+  connect(m_camera, &CameraController::burstSaved, this,
+          [this](const QString &path, qint64 bytes) {
+            m_recordingLabel->setText("");
+            m_burstBtn->setEnabled(m_isPreviewActive);
+            m_startRecordBtn->setEnabled(m_isPreviewActive);
+            if (bytes > 0)
+              VideoLibraryService::addRecording(path,
+                                                DatabaseManager::instance());
+            else
+              QMessageBox::warning(this, "连拍问题",
+                                   QString("连拍文件 0 字节：%1").arg(path));
+          });
+  connect(m_camera, &CameraController::burstError, this,
+          [this](const QString &msg) {
+            m_recordingLabel->setText("");
+            m_burstBtn->setEnabled(m_isPreviewActive);
+            m_startRecordBtn->setEnabled(m_isPreviewActive &&
+                                         !m_camera->isRecording());
+            QMessageBox::warning(this, "连拍错误", msg);
+          });
+
+  // 录制统计在文件关闭后立即触发，承担两个职责：
+  //   1) bytes > 0 → 把视频入库（路径由 CameraController 记录在 m_recordingPathQt，
   //      这里通过最近一次 lastSavedRecordingPath 拿到。但为了零耦合，
   //      我们让 addRecording 接收路径——由 stats 信号附带不便，
   //      改成：CaptureWidget 自己记下 startRecording 时的路径）
@@ -273,14 +564,17 @@ void CaptureWidget::setupConnections() {
   connect(
       m_camera, &CameraController::recordingStats, this,
       [this](qint64 total, qint64 ok, qint64 fail, qint64 bytes,
-             quint32 lastErr, quint32 pixelType, qint64 convFail) {
+             quint32 lastErr, quint32 pixelType, qint64 convFail,
+             qint64 queueDrop) {
         qDebug() << "录制 stats: total=" << total << " ok=" << ok
                  << " inputFail=" << fail << " convFail=" << convFail
+                 << " queueDrop=" << queueDrop
                  << " bytes=" << bytes << " lastErr=0x"
                  << QString::number(lastErr, 16);
 
-        if (bytes > 0 && !m_lastRecordingPath.isEmpty()) {
-          // 正常：入库
+        if (bytes > 0 && !m_lastRecordingPath.isEmpty() &&
+            !m_recordSegmented) {
+          // 正常：入库（分段录制的各段走 recordingSegmentSaved）
           VideoLibraryService::addRecording(m_lastRecordingPath,
                                             DatabaseManager::instance());
         } else if (bytes == 0 && total > 0) {
@@ -289,22 +583,40 @@ void CaptureWidget::setupConnections() {
           QMessageBox::warning(
               this, "录制问题",
               QString("文件 0 字节。\n\n"
-                      "帧统计：grab=%1, ok=%2, inputFail=%3, convFail=%4\n"
-                      "录制像素类型：%5\n"
-                      "最后 SDK 错误码：%6\n\n"
+                      "帧统计：grab=%1, ok=%2, inputFail=%3, convFail=%4, "
+                      "queueDrop=%5\n"
+                      "录制像素类型：%6\n"
+                      "最后 SDK 错误码：%7\n\n"
                       "请把这个对话框截图发回去诊断。")
                   .arg(total)
                   .arg(ok)
                   .arg(fail)
                   .arg(convFail)
+                  .arg(queueDrop)
                   .arg(pixelName)
                   .arg(errHex));
         }
       });
 
-  // ===== VideoDisplayWidget FPS 更新 =====
-  connect(m_videoDisplay, &VideoDisplayWidget::fpsUpdated, this,
-          &CaptureWidget::onFpsUpdated);
+  // 分段录制：每段关闭后入库，按会话归组
+  connect(m_camera, &CameraController::recordingSegmentSaved, this,
+          [this](const QString &path, int segmentIndex, qint64 bytes) {
+            if (bytes > 0)
+              VideoLibraryService::addRecording(path,
+                                                DatabaseManager::instance(),
+                                                m_recordSessionId,
+                                                segmentIndex);
+            m_statusLabel->setText(
+                QString("录制分段 %1 已保存: %2")
+                    .arg(segmentIndex)
+                    .arg(QFileInfo(path).fileName()));
+          });
+
+  // ===== 帧数 / FPS：定时采样 grab 线程的计数块，不逐帧走事件循环 =====
+  m_statsTimer = new QTimer(this);
+  m_statsTimer->setInterval(kStatsIntervalMs);
+  connect(m_statsTimer, &QTimer::timeout, this,
+          &CaptureWidget::onStatsTimerTimeout);
 
   // 初始刷新设备列表
   onRefreshDevicesClicked();
@@ -325,6 +637,45 @@ void CaptureWidget::setupConnections() {
           &CaptureWidget::onVideoWheelEvent);
   connect(m_videoDisplay, &VideoDisplayWidget::panDelta, this,
           &CaptureWidget::onVideoPanDelta);
+  // 滚动（拖动、滚动条）后渲染窗口跟着可见区域走
+  connect(m_scrollArea->horizontalScrollBar(), &QScrollBar::valueChanged, this,
+          [this](int) { updateDisplayViewport(); });
+  connect(m_scrollArea->verticalScrollBar(), &QScrollBar::valueChanged, this,
+          [this](int) { updateDisplayViewport(); });
+
+  // ===== ROI =====
+  connect(m_roiSelectBtn, &QPushButton::toggled, m_videoDisplay,
+          &VideoDisplayWidget::setRoiSelectionEnabled);
+  connect(m_videoDisplay, &VideoDisplayWidget::roiSelected, this,
+          [this](const QRect &r) {
+            m_roiSelectBtn->setChecked(false);
+            // 框选坐标相对当前画面，也就是相对当前 ROI
+            const Roi current = m_camera->roi();
+            if (current.isEmpty())
+              return;
+            m_camera->setRoi(
+                {current.x + r.x(), current.y + r.y(), r.width(), r.height()});
+          });
+  connect(m_fullRoiBtn, &QPushButton::clicked, this, [this]() {
+    // 超出传感器的尺寸由 RoiPlanner::align 夹到最大值
+    m_camera->setRoi({0, 0, std::numeric_limits<int>::max(),
+                      std::numeric_limits<int>::max()});
+  });
+  connect(m_camera, &CameraController::roiReconfigured, this,
+          [this](int x, int y, int w, int h, double reconfigureMs) {
+            m_statusLabel->setText(QString("ROI %1x%2 @ (%3, %4)，重配置 %5 ms")
+                                       .arg(w)
+                                       .arg(h)
+                                       .arg(x)
+                                       .arg(y)
+                                       .arg(reconfigureMs, 0, 'f', 1));
+          });
+  connect(m_camera, &CameraController::reconfigureGapMeasured, this,
+          [this](double gapMs) {
+            m_statusLabel->setText(m_statusLabel->text() +
+                                   QString("，采集中断 %1 ms")
+                                       .arg(gapMs, 0, 'f', 1));
+          });
 }
 
 // ============================================================================
@@ -377,7 +728,7 @@ void CaptureWidget::onRefreshDevicesClicked() {
   m_deviceCombo->blockSignals(true);
   m_deviceCombo->clear();
 
-  auto devices = CameraController::enumerateDevices();
+  auto devices = m_camera->enumerateDevices();
   for (const auto &dev : devices) {
     QString displayName = QString("%1 [%2]").arg(dev.name, dev.serialNumber);
     m_deviceCombo->addItem(displayName, dev.index);
@@ -446,6 +797,7 @@ void CaptureWidget::onStartPreviewClicked() {
   }
 
   m_lastCameraError.clear();
+  m_fpsSampler.reset();
   if (!m_camera->startGrabbing()) {
     const QString detail =
         m_lastCameraError.isEmpty()
@@ -463,12 +815,12 @@ void CaptureWidget::onStartPreviewClicked() {
 
   // 只有在预览时才允许录制
   m_startRecordBtn->setEnabled(true);
-
-  // 预览时禁用分辨率设置 (防止硬件错误)
-  m_controlPanel->setResolutionEnabled(false);
+  m_burstBtn->setEnabled(m_camera->burstState() ==
+                         CameraController::BurstState::Idle);
 
   m_videoDisplay->setStreaming(true);
   m_statusLabel->setText("预览中...");
+  m_statsTimer->start();
 
   // 自动适应窗口大小
   onFitWindowClicked();
@@ -483,15 +835,18 @@ void CaptureWidget::onStopPreviewClicked() {
   // 逻辑优化：停止预览时不关闭相机连接，保持参数可调
   // m_camera->close();
 
+  // 最后刷新一次帧数，FPS 清空
+  m_statsTimer->stop();
+  onStatsTimerTimeout();
+  m_fpsLabel->setText("FPS: --");
+
   m_isPreviewActive = false;
   m_startPreviewBtn->setEnabled(true);
   m_stopPreviewBtn->setEnabled(false);
   m_snapshotBtn->setEnabled(false);
   m_startRecordBtn->setEnabled(false);
   m_stopRecordBtn->setEnabled(false);
-
-  // 停止预览后恢复分辨率设置
-  m_controlPanel->setResolutionEnabled(true);
+  m_burstBtn->setEnabled(false);
 
   m_videoDisplay->setStreaming(false);
   m_videoDisplay->clear(); // 明确清空并在此时刷黑
@@ -508,10 +863,16 @@ void CaptureWidget::onCaptureSnapshotClicked() {
   if (taskName.isEmpty())
     taskName = "snapshot";
 
-  QString filename = QString("%1_%2.jpg").arg(taskName, timestamp);
+  // 10/12/16 位相机存 16 位 PNG，JPEG 会截成 8 位
+  QString filename = QString("%1_%2.%3")
+                         .arg(taskName, timestamp,
+                              m_highBitDepth ? QString("png") : QString("jpg"));
   QString filePath = QDir(AppPaths::snapshotsDir()).absoluteFilePath(filename);
 
-  m_camera->saveSnapshot(filePath, CameraController::FORMAT_JPEG, 90);
+  m_camera->saveSnapshot(filePath,
+                         m_highBitDepth ? CameraController::FORMAT_PNG
+                                        : CameraController::FORMAT_JPEG,
+                         90);
 }
 
 void CaptureWidget::onStartRecordingClicked() {
@@ -523,16 +884,34 @@ void CaptureWidget::onStartRecordingClicked() {
   if (taskName.isEmpty())
     taskName = "recording";
 
-  // SDK 仅支持 AVI 格式
-  QString filename = QString("%1_%2.avi").arg(taskName, timestamp);
+  // 扩展名决定容器（.avi / .wvr）
+  QString filename = QString("%1_%2.%3").arg(
+      taskName, timestamp, m_containerCombo->currentData().toString());
   QString filePath = QDir(AppPaths::recordingsDir()).absoluteFilePath(filename);
 
   // 记录路径供延迟入库使用
   m_lastRecordingPath = filePath;
+  m_recordSegmented = m_camera->recordSegmentPolicy().enabled();
+  m_recordSessionId = 0;
   // Phase 3 修复 #4：fps 不再写死，传 -1 让 CameraController 用真实 ResultingFrameRate
   if (m_camera->startRecording(filePath, -1.0f, 4000)) {
+    // 分段录制：开录成功后再建会话（失败不留空会话），各段（filePath
+    // 派生的 _001、_002 ...）入库时归组；分段通知经事件队列，晚于这里
+    if (m_recordSegmented)
+      m_recordSessionId = VideoLibraryService::beginRecordingSession(
+          filePath, DatabaseManager::instance());
     m_startRecordBtn->setEnabled(false);
     m_stopRecordBtn->setEnabled(true);
+    m_burstBtn->setEnabled(false);
+    // 录制中 ROI 不可改（改了会中断录制文件的帧尺寸）
+    m_controlPanel->setResolutionEnabled(false);
+    m_workflowCombo->setEnabled(false);
+    m_monoMethodCombo->setEnabled(false);
+    m_containerCombo->setEnabled(false);
+    m_losslessCheck->setEnabled(false);
+    m_roiSelectBtn->setChecked(false);
+    m_roiSelectBtn->setEnabled(false);
+    m_fullRoiBtn->setEnabled(false);
     m_recordStartTime = QDateTime::currentDateTime();
 
     // 启动录制计时器
@@ -541,10 +920,33 @@ void CaptureWidget::onStartRecordingClicked() {
   }
 }
 
+void CaptureWidget::onBurstClicked() {
+  if (!m_isPreviewActive || m_camera->isRecording())
+    return;
+
+  QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+  QString taskName = m_taskInfoEdit->text().trimmed();
+  if (taskName.isEmpty())
+    taskName = "burst";
+
+  QString filename = QString("%1_%2_burst.%3").arg(
+      taskName, timestamp, m_containerCombo->currentData().toString());
+  QString filePath = QDir(AppPaths::recordingsDir()).absoluteFilePath(filename);
+  m_camera->startBurst(filePath, m_burstFramesSpin->value());
+}
+
 void CaptureWidget::onStopRecordingClicked() {
   m_camera->stopRecording();
   m_startRecordBtn->setEnabled(true);
   m_stopRecordBtn->setEnabled(false);
+  m_burstBtn->setEnabled(m_isPreviewActive);
+  m_controlPanel->setResolutionEnabled(true);
+  m_workflowCombo->setEnabled(true);
+  m_monoMethodCombo->setEnabled(true);
+  m_containerCombo->setEnabled(true);
+  m_losslessCheck->setEnabled(m_containerCombo->currentData() == "wvr");
+  m_roiSelectBtn->setEnabled(m_camera->isOpen());
+  m_fullRoiBtn->setEnabled(m_camera->isOpen());
   m_recordTimer->stop();
   emit recordingStopped();
 }
@@ -556,8 +958,24 @@ void CaptureWidget::onRecordTimerTimeout() {
   m_recordingLabel->setText(QString("● 录制中 %1").arg(time.toString("mm:ss")));
 }
 
-void CaptureWidget::onFpsUpdated(float fps) {
-  m_fpsLabel->setText(QString("FPS: %1").arg(fps, 0, 'f', 1));
+void CaptureWidget::onStatsTimerTimeout() {
+  const AcquisitionStatsBlock::Snapshot stats = m_camera->acquisitionStats();
+  const int64_t nowNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  const double fps = m_fpsSampler.update(stats, nowNs);
+
+  // 文本不变时不 setText，避免无谓的重新布局
+  const QString fpsText = QString("FPS: %1").arg(fps, 0, 'f', 1);
+  if (m_fpsLabel->text() != fpsText)
+    m_fpsLabel->setText(fpsText);
+  const QString countText =
+      m_lostFrames > 0
+          ? QString("帧数: %1 (丢 %2)").arg(stats.frames).arg(m_lostFrames)
+          : QString("帧数: %1").arg(stats.frames);
+  if (m_frameCountLabel->text() != countText)
+    m_frameCountLabel->setText(countText);
 }
 
 void CaptureWidget::updateVideoLayout() {
@@ -592,8 +1010,57 @@ void CaptureWidget::updateVideoLayout() {
   m_zoomLabel->setText(
       QString("%1%").arg(static_cast<int>(m_currentZoom * 100)));
 
-  // 设置 VideoDisplayWidget 的固定大小，触发 ScrollArea 的滚动条
-  m_videoDisplay->setFixedSize(targetSize);
+  // 设置画布的固定大小，触发 ScrollArea 的滚动条
+  m_videoCanvas->setFixedSize(targetSize);
+  updateDisplayViewport();
+}
+
+void CaptureWidget::updateDisplayViewport() {
+  if (!m_scrollArea || !m_videoCanvas || !m_videoDisplay)
+    return;
+  const QSize imageSize = m_videoDisplay->sizeHint(); // 原始图像大小
+  const QSize canvasSize = m_videoCanvas->size();
+  if (imageSize.isEmpty() || canvasSize.isEmpty())
+    return;
+
+  // 画布上露在视口里的部分（画布坐标）
+  QWidget *viewport = m_scrollArea->viewport();
+  const QRect visible =
+      QRect(m_videoCanvas->mapFrom(viewport, QPoint(0, 0)), viewport->size()) &
+      m_videoCanvas->rect();
+  if (visible.isEmpty())
+    return;
+
+  // 换成图像坐标：向外取整，起点和宽高按 2 对齐（裁 Bayer 不能打乱排列）
+  const double sx = double(imageSize.width()) / canvasSize.width();
+  const double sy = double(imageSize.height()) / canvasSize.height();
+  const int x0 = int(std::floor(visible.left() * sx)) & ~1;
+  const int y0 = int(std::floor(visible.top() * sy)) & ~1;
+  int x1 = std::min(imageSize.width(),
+                    int(std::ceil((visible.right() + 1) * sx)));
+  int y1 = std::min(imageSize.height(),
+                    int(std::ceil((visible.bottom() + 1) * sy)));
+  x1 = std::min(imageSize.width(), x0 + ((x1 - x0 + 1) & ~1));
+  y1 = std::min(imageSize.height(), y0 + ((y1 - y0 + 1) & ~1));
+  const QRect source(x0, y0, x1 - x0, y1 - y0);
+
+  // 渲染窗口正好盖住 source 在画布上的位置（比可见部分最多多出一个源像素，
+  // 多出的被视口裁掉），SDK 把裁出来的图拉满整个窗口
+  const QRect geometry(QPoint(qRound(x0 / sx), qRound(y0 / sy)),
+                       QPoint(qRound(x1 / sx) - 1, qRound(y1 / sy) - 1));
+  if (m_videoDisplay->geometry() != geometry)
+    m_videoDisplay->setGeometry(geometry);
+  m_videoDisplay->setSourceRect(source);
+  if (m_camera)
+    m_camera->setDisplayViewport(source, geometry.size());
+}
+
+bool CaptureWidget::eventFilter(QObject *watched, QEvent *event) {
+  // 视口尺寸变化（窗口缩放、拖动分割条、滚动条出现 / 消失）
+  if (m_scrollArea && watched == m_scrollArea->viewport() &&
+      event->type() == QEvent::Resize)
+    updateDisplayViewport();
+  return QWidget::eventFilter(watched, event);
 }
 
 void CaptureWidget::resizeEvent(QResizeEvent *event) {
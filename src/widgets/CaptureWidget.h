@@ -3,6 +3,9 @@
 
 #include <QScrollArea>
 
+#include "utils/AcquisitionStats.h"
+
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDateTime>
 #include <QDir>
@@ -13,6 +16,7 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QResizeEvent>
+#include <QSpinBox>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
@@ -40,7 +44,8 @@ private slots:
   void onCaptureSnapshotClicked();
   void onStartRecordingClicked();
   void onStopRecordingClicked();
-  void onFpsUpdated(float fps);
+  void onBurstClicked();
+  void onStatsTimerTimeout();
   void onRefreshDevicesClicked();
   void onDeviceSelectionChanged(int index);
   void onRecordTimerTimeout();
@@ -53,6 +58,7 @@ private slots:
   void onVideoPanDelta(int dx, int dy);
 
 protected:
+  bool eventFilter(QObject *watched, QEvent *event) override;
   void resizeEvent(QResizeEvent *event) override;
   void showEvent(QShowEvent *event) override;
   void hideEvent(QHideEvent *event) override;
@@ -60,6 +66,9 @@ protected:
 private:
   void setupUI();
   void setupConnections();
+  // 按画布在视口里露出的部分摆放渲染窗口，并把对应的图像区域和屏幕尺寸
+  // 告诉 CameraController（缩放、滚动、视口尺寸变化后调用）
+  void updateDisplayViewport();
 
   QWidget *m_videoContainer = nullptr;
   VideoDisplayWidget *m_videoDisplay = nullptr;
@@ -72,14 +81,32 @@ private:
   QPushButton *m_snapshotBtn = nullptr;
   QPushButton *m_startRecordBtn = nullptr;
   QPushButton *m_stopRecordBtn = nullptr;
+  QSpinBox *m_preTriggerSpin = nullptr;
+  // 像素格式用途（仅预览 / 黑白录制 / 彩色录制 / 高位深录制），决定协商出的
+  // 相机格式和录制格式
+  QComboBox *m_workflowCombo = nullptr;
+  // Bayer → Mono8 取法（加权亮度 / 绿通道）
+  QComboBox *m_monoMethodCombo = nullptr;
+  // 录制容器（AVI / WVR 原始），决定录制和连拍文件的扩展名
+  QComboBox *m_containerCombo = nullptr;
+  // WVR 按帧无损压缩（只在选了 WVR 时可用）
+  QCheckBox *m_losslessCheck = nullptr;
+  QPushButton *m_burstBtn = nullptr;
+  QSpinBox *m_burstFramesSpin = nullptr;
   QLineEdit *m_taskInfoEdit = nullptr;
 
   // 缩放控制
   QPushButton *m_zoomInBtn = nullptr;
   QPushButton *m_zoomOutBtn = nullptr;
   QPushButton *m_fitWindowBtn = nullptr;
+  // ROI：在画面上框选 / 恢复全幅（采集中也可用，由 CameraController::setRoi 重配）
+  QPushButton *m_roiSelectBtn = nullptr;
+  QPushButton *m_fullRoiBtn = nullptr;
   QLabel *m_zoomLabel = nullptr;
   QScrollArea *m_scrollArea = nullptr;
+  // ScrollArea 的内容：按 图像尺寸 × 缩放 定大小，只负责滚动范围；
+  // 原生渲染窗口 m_videoDisplay 是它的子控件，只盖住视口里看得见的部分
+  QWidget *m_videoCanvas = nullptr;
   double m_currentZoom = -1.0;
 
   // 状态显示
@@ -88,6 +115,13 @@ private:
   QLabel *m_statusLabel = nullptr;
   QLabel *m_recordingLabel = nullptr;
   QLabel *m_resolutionLabel = nullptr;
+  // 最近一次遥测的累计丢帧数（帧数标签里一起显示）
+  quint64 m_lostFrames = 0;
+
+  // 预览期间定时采样 CameraController::acquisitionStats()，
+  // 帧数 / FPS 标签的刷新频率与相机帧率无关
+  QTimer *m_statsTimer = nullptr;
+  FrameRateSampler m_fpsSampler;
 
   // 设备列表引用 (对应 ControlPanel 中的控件)
   QComboBox *m_deviceCombo = nullptr;
@@ -96,10 +130,16 @@ private:
   QTimer *m_recordTimer = nullptr;
   QDateTime m_recordStartTime;
   bool m_isPreviewActive = false;
+  // 协商出的相机格式超过 8 位：抓拍存 16 位 PNG
+  bool m_highBitDepth = false;
   int m_selectedDeviceIndex = -1;
   QString m_lastCameraError;
   // 记录最近一次开始录制的路径，stats 信号（延迟 1.2s）回来时用它入库
   QString m_lastRecordingPath;
+  // 分段录制：各段由 recordingSegmentSaved 逐段入库，归到这个会话下
+  // （0 = 单文件录制，或建会话失败）
+  bool m_recordSegmented = false;
+  int m_recordSessionId = 0;
 };
 
 #endif // CAPTUREWIDGET_H
@@ -1,6 +1,8 @@
 ﻿#include "widgets/ControlPanelWidget.h"
+#include "utils/RecordFileSettings.h"
 #include <QGridLayout>
 #include <QLabel>
+#include <QSignalBlocker>
 #include <QVBoxLayout>
 #include <cmath>
 
@@ -23,9 +25,12 @@ void ControlPanelWidget::setupUI() {
 
   mainLayout->addWidget(createDeviceGroup());
   mainLayout->addWidget(createResolutionGroup());
+  mainLayout->addWidget(createSamplingGroup());
   mainLayout->addWidget(createExposureGroup());
   mainLayout->addWidget(createGainGroup());
   mainLayout->addWidget(createFrameRateGroup());
+  mainLayout->addWidget(createThreadGroup());
+  mainLayout->addWidget(createDiskGroup());
   mainLayout->addStretch();
 
   // 默认禁用所有控件 (相机未连接)
@@ -86,6 +91,12 @@ QGroupBox *ControlPanelWidget::createResolutionGroup() {
   connect(m_offsetYSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this,
           &ControlPanelWidget::onOffsetYChanged);
 
+  // 采集中改 ROI 要停采集重配，输入完成（回车 / 失焦 / 箭头）才下发，
+  // 不按每次按键下发
+  for (QSpinBox *spin : {m_widthSpinBox, m_heightSpinBox, m_offsetXSpinBox,
+                         m_offsetYSpinBox})
+    spin->setKeyboardTracking(false);
+
   return m_resolutionGroup;
 }
 
@@ -166,6 +177,274 @@ QGroupBox *ControlPanelWidget::createFrameRateGroup() {
   return m_frameRateGroup;
 }
 
+QGroupBox *ControlPanelWidget::createThreadGroup() {
+  // 不随相机连接状态禁用：设置保存后下次开始采集生效
+  QGroupBox *group = new QGroupBox("线程调度", this);
+  QGridLayout *layout = new QGridLayout(group);
+  layout->addWidget(new QLabel("绑核", this), 0, 1);
+  layout->addWidget(new QLabel("优先级", this), 0, 2);
+
+  const char *names[3] = {"采集", "写盘", "显示"};
+  for (int i = 0; i < 3; ++i) {
+    layout->addWidget(new QLabel(names[i], this), i + 1, 0);
+    m_threadCoreSpin[i] = new QSpinBox(this);
+    m_threadCoreSpin[i]->setRange(-1, ThreadAffinity::coreCount() - 1);
+    m_threadCoreSpin[i]->setSpecialValueText("不绑");
+    m_threadCoreSpin[i]->setValue(-1);
+    layout->addWidget(m_threadCoreSpin[i], i + 1, 1);
+
+    m_threadPriorityCombo[i] = new QComboBox(this);
+    m_threadPriorityCombo[i]->addItem("默认", int(ThreadAffinity::Priority::Normal));
+    m_threadPriorityCombo[i]->addItem("高", int(ThreadAffinity::Priority::High));
+    m_threadPriorityCombo[i]->addItem("实时",
+                                      int(ThreadAffinity::Priority::Realtime));
+    layout->addWidget(m_threadPriorityCombo[i], i + 1, 2);
+
+    connect(m_threadCoreSpin[i], QOverload<int>::of(&QSpinBox::valueChanged),
+            this, [this](int) { emit threadTuningChanged(threadTuning()); });
+    connect(m_threadPriorityCombo[i],
+            QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this](int) { emit threadTuningChanged(threadTuning()); });
+  }
+  group->setToolTip("实时优先级在 Linux 上需要 CAP_SYS_NICE / rtprio 限额，"
+                    "设置失败时按默认优先级运行并记入录制统计");
+  return group;
+}
+
+QGroupBox *ControlPanelWidget::createDiskGroup() {
+  // 同线程调度：不随相机连接状态禁用，下次开始录制 / 连拍生效
+  QGroupBox *group = new QGroupBox("录制写盘", this);
+  QGridLayout *layout = new QGridLayout(group);
+
+  layout->addWidget(new QLabel("写盘缓冲", this), 0, 0);
+  m_diskBufferSpin = new QSpinBox(this);
+  m_diskBufferSpin->setRange(RecordFileSettings::kMinBufferMB,
+                             RecordFileSettings::kMaxBufferMB);
+  m_diskBufferSpin->setSingleStep(4);
+  m_diskBufferSpin->setSuffix(" MB");
+  m_diskBufferSpin->setValue(RecordFileSettings::kDefaultBufferMB);
+  m_diskBufferSpin->setToolTip(
+      QString("每块缓冲的大小，共 %1 块；磁盘偶尔停顿时排队的缓冲越多越不会"
+              "卡住录制")
+          .arg(RecordFile::Options().bufferCount));
+  layout->addWidget(m_diskBufferSpin, 0, 1);
+
+  m_diskDirectIoCheck = new QCheckBox("绕过系统缓存 (直接 I/O)", this);
+  m_diskDirectIoCheck->setToolTip(
+      "长时间录制时不占用系统页缓存、写盘速度更稳定；文件系统不支持时自动"
+      "退回普通写入");
+  layout->addWidget(m_diskDirectIoCheck, 1, 0, 1, 2);
+
+  layout->addWidget(new QLabel("预分配", this), 2, 0);
+  m_diskPreallocateSpin = new QSpinBox(this);
+  m_diskPreallocateSpin->setRange(0, RecordFileSettings::kMaxPreallocateGB);
+  m_diskPreallocateSpin->setSuffix(" GB");
+  m_diskPreallocateSpin->setSpecialValueText("不预分配");
+  m_diskPreallocateSpin->setToolTip(
+      "开始录制时先向文件系统申请这么多连续空间，减少碎片；结束时截到实际大小");
+  layout->addWidget(m_diskPreallocateSpin, 2, 1);
+
+  // 长时间录制分段：满任一条件就在帧与帧之间换新文件
+  layout->addWidget(new QLabel("分段时长", this), 3, 0);
+  m_segmentMinutesSpin = new QSpinBox(this);
+  m_segmentMinutesSpin->setRange(0, RecordFileSettings::kMaxSegmentMinutes);
+  m_segmentMinutesSpin->setSingleStep(10);
+  m_segmentMinutesSpin->setSuffix(" 分钟");
+  m_segmentMinutesSpin->setSpecialValueText("不分段");
+  m_segmentMinutesSpin->setToolTip(
+      "过夜录制每满这么长换一个新文件（_001、_002 ...），段与段之间不丢帧；"
+      "各段在视频库里归到同一次录制下");
+  layout->addWidget(m_segmentMinutesSpin, 3, 1);
+
+  layout->addWidget(new QLabel("分段大小", this), 4, 0);
+  m_segmentGBSpin = new QSpinBox(this);
+  m_segmentGBSpin->setRange(0, RecordFileSettings::kMaxSegmentGB);
+  m_segmentGBSpin->setSuffix(" GB");
+  m_segmentGBSpin->setSpecialValueText("不限");
+  m_segmentGBSpin->setToolTip("单个文件写到这么大就换下一段，和分段时长"
+                              "先到先换");
+  layout->addWidget(m_segmentGBSpin, 4, 1);
+
+  connect(m_diskBufferSpin, QOverload<int>::of(&QSpinBox::valueChanged), this,
+          [this](int) { emit recordFileOptionsChanged(recordFileOptions()); });
+  connect(m_diskDirectIoCheck, &QCheckBox::toggled, this,
+          [this](bool) { emit recordFileOptionsChanged(recordFileOptions()); });
+  connect(m_diskPreallocateSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+          this,
+          [this](int) { emit recordFileOptionsChanged(recordFileOptions()); });
+  connect(m_segmentMinutesSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+          this, [this](int) {
+            emit recordSegmentPolicyChanged(recordSegmentPolicy());
+          });
+  connect(m_segmentGBSpin, QOverload<int>::of(&QSpinBox::valueChanged), this,
+          [this](int) {
+            emit recordSegmentPolicyChanged(recordSegmentPolicy());
+          });
+  return group;
+}
+
+QGroupBox *ControlPanelWidget::createSamplingGroup() {
+  m_samplingGroup = new QGroupBox("Binning / 抽样", this);
+  QGridLayout *layout = new QGridLayout(m_samplingGroup);
+  layout->addWidget(new QLabel("水平", this), 0, 1);
+  layout->addWidget(new QLabel("垂直", this), 0, 2);
+  layout->addWidget(new QLabel("Binning:", this), 1, 0);
+  layout->addWidget(new QLabel("抽样:", this), 2, 0);
+  for (int i = 0; i < 4; ++i) {
+    m_samplingCombo[i] = new QComboBox(this);
+    m_samplingCombo[i]->addItem("1", 1);
+    layout->addWidget(m_samplingCombo[i], 1 + i / 2, 1 + i % 2);
+    connect(m_samplingCombo[i],
+            QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this](int) {
+              const SamplingMode mode = selectedSamplingMode();
+              m_samplingApplyBtn->setEnabled(mode != m_appliedSampling);
+              emit samplingPreviewRequested(mode);
+            });
+  }
+
+  m_samplingEstimateLabel = new QLabel("预计: --", this);
+  m_samplingEstimateLabel->setWordWrap(true);
+  layout->addWidget(m_samplingEstimateLabel, 3, 0, 1, 3);
+
+  m_samplingApplyBtn = new QPushButton("应用", this);
+  m_samplingApplyBtn->setEnabled(false);
+  m_samplingApplyBtn->setToolTip("预览中应用会短暂停止采集；录制中不可修改");
+  layout->addWidget(m_samplingApplyBtn, 4, 0, 1, 3);
+  connect(m_samplingApplyBtn, &QPushButton::clicked, this,
+          [this]() { emit samplingApplyRequested(selectedSamplingMode()); });
+  return m_samplingGroup;
+}
+
+SamplingMode ControlPanelWidget::selectedSamplingMode() const {
+  SamplingMode mode;
+  int *fields[4] = {&mode.binningH, &mode.binningV, &mode.decimationH,
+                    &mode.decimationV};
+  for (int i = 0; i < 4; ++i)
+    *fields[i] = qMax(1, m_samplingCombo[i]->currentData().toInt());
+  return mode;
+}
+
+void ControlPanelWidget::setSamplingOptions(const SamplingOptions &options,
+                                            const SamplingMode &current) {
+  const std::vector<int> *lists[4] = {&options.binningH, &options.binningV,
+                                      &options.decimationH,
+                                      &options.decimationV};
+  for (int i = 0; i < 4; ++i) {
+    QSignalBlocker blocker(m_samplingCombo[i]);
+    m_samplingCombo[i]->clear();
+    for (int factor : *lists[i])
+      m_samplingCombo[i]->addItem(QString::number(factor), factor);
+    if (m_samplingCombo[i]->count() == 0)
+      m_samplingCombo[i]->addItem("1", 1);
+    m_samplingCombo[i]->setEnabled(m_samplingCombo[i]->count() > 1);
+  }
+  m_samplingSupported = options.supported();
+  m_samplingGroup->setEnabled(m_samplingSupported);
+  m_samplingGroup->setToolTip(m_samplingSupported
+                                  ? QString()
+                                  : QString("当前相机不支持 binning / 抽样"));
+  setSamplingMode(current);
+}
+
+void ControlPanelWidget::setSamplingMode(const SamplingMode &mode) {
+  const int values[4] = {mode.binningH, mode.binningV, mode.decimationH,
+                         mode.decimationV};
+  for (int i = 0; i < 4; ++i) {
+    QSignalBlocker blocker(m_samplingCombo[i]);
+    const int index = m_samplingCombo[i]->findData(values[i]);
+    m_samplingCombo[i]->setCurrentIndex(index >= 0 ? index : 0);
+  }
+  m_appliedSampling = mode;
+  m_samplingApplyBtn->setEnabled(false);
+}
+
+void ControlPanelWidget::setSamplingEstimate(
+    const FrameRateEstimate &estimate) {
+  if (estimate.width <= 0) {
+    m_samplingEstimateLabel->setText("预计: --");
+    return;
+  }
+  QString fps = estimate.maxFps > 0
+                    ? QString("%1%2 fps（%3）")
+                          .arg(estimate.readoutIsLowerBound &&
+                                       estimate.limitedBy ==
+                                           FrameRateEstimate::Limit::Readout
+                                   ? "≥ "
+                                   : "")
+                          .arg(estimate.maxFps, 0, 'f', 1)
+                          .arg(FrameRateEstimator::limitName(
+                              estimate.limitedBy))
+                    : QString("-- fps");
+  m_samplingEstimateLabel->setText(
+      QString("预计: %1 x %2，最高 %3，带宽 %4 MB/s")
+          .arg(estimate.width)
+          .arg(estimate.height)
+          .arg(fps)
+          .arg(estimate.bandwidthBytesPerSec / 1e6, 0, 'f', 1));
+}
+
+ThreadAffinity::Tuning ControlPanelWidget::threadTuning() const {
+  ThreadAffinity::Tuning tuning;
+  ThreadAffinity::ThreadSetting *settings[3] = {&tuning.grab, &tuning.record,
+                                                &tuning.workers};
+  for (int i = 0; i < 3; ++i) {
+    settings[i]->core = m_threadCoreSpin[i]->value();
+    settings[i]->priority = static_cast<ThreadAffinity::Priority>(
+        m_threadPriorityCombo[i]->currentData().toInt());
+  }
+  return tuning;
+}
+
+void ControlPanelWidget::setThreadTuning(const ThreadAffinity::Tuning &tuning) {
+  const ThreadAffinity::ThreadSetting *settings[3] = {
+      &tuning.grab, &tuning.record, &tuning.workers};
+  for (int i = 0; i < 3; ++i) {
+    QSignalBlocker coreBlocker(m_threadCoreSpin[i]);
+    QSignalBlocker priorityBlocker(m_threadPriorityCombo[i]);
+    m_threadCoreSpin[i]->setValue(settings[i]->core);
+    const int index =
+        m_threadPriorityCombo[i]->findData(int(settings[i]->priority));
+    m_threadPriorityCombo[i]->setCurrentIndex(index >= 0 ? index : 0);
+  }
+}
+
+RecordFile::Options ControlPanelWidget::recordFileOptions() const {
+  RecordFile::Options options;
+  options.bufferBytes = std::size_t(m_diskBufferSpin->value()) << 20;
+  options.directIo = m_diskDirectIoCheck->isChecked();
+  options.preallocateBytes = uint64_t(m_diskPreallocateSpin->value()) << 30;
+  return options;
+}
+
+void ControlPanelWidget::setRecordFileOptions(
+    const RecordFile::Options &options) {
+  QSignalBlocker bufferBlocker(m_diskBufferSpin);
+  QSignalBlocker directIoBlocker(m_diskDirectIoCheck);
+  QSignalBlocker preallocateBlocker(m_diskPreallocateSpin);
+  m_diskBufferSpin->setValue(static_cast<int>(options.bufferBytes >> 20));
+  m_diskDirectIoCheck->setChecked(options.directIo);
+  m_diskPreallocateSpin->setValue(
+      static_cast<int>(options.preallocateBytes >> 30));
+}
+
+RecordSegmenter::Policy ControlPanelWidget::recordSegmentPolicy() const {
+  RecordSegmenter::Policy policy;
+  policy.maxDurationNs =
+      int64_t(m_segmentMinutesSpin->value()) * 60 * 1000000000;
+  policy.maxBytes = uint64_t(m_segmentGBSpin->value()) << 30;
+  return policy;
+}
+
+void ControlPanelWidget::setRecordSegmentPolicy(
+    const RecordSegmenter::Policy &policy) {
+  QSignalBlocker minutesBlocker(m_segmentMinutesSpin);
+  QSignalBlocker gbBlocker(m_segmentGBSpin);
+  m_segmentMinutesSpin->setValue(
+      static_cast<int>(policy.maxDurationNs / (int64_t(60) * 1000000000)));
+  m_segmentGBSpin->setValue(static_cast<int>(policy.maxBytes >> 30));
+}
+
 // ============================================================================
 // Slider 与 SpinBox 同步
 // ============================================================================
@@ -317,8 +596,12 @@ void ControlPanelWidget::setFrameRateRange(float min, float max,
 }
 
 void ControlPanelWidget::setResolution(int width, int height) {
+  m_widthSpinBox->blockSignals(true);
+  m_heightSpinBox->blockSignals(true);
   m_widthSpinBox->setValue(width);
   m_heightSpinBox->setValue(height);
+  m_widthSpinBox->blockSignals(false);
+  m_heightSpinBox->blockSignals(false);
 }
 
 void ControlPanelWidget::setResolutionMax(int w, int h) {
@@ -350,6 +633,7 @@ void ControlPanelWidget::enableControls(bool enabled) {
   m_gainGroup->setEnabled(enabled);
   m_frameRateGroup->setEnabled(enabled);
   m_resolutionGroup->setEnabled(enabled);
+  m_samplingGroup->setEnabled(enabled && m_samplingSupported);
 }
 
 void ControlPanelWidget::onWidthChanged(int value) { emit widthChanged(value); }
@@ -362,4 +646,7 @@ void ControlPanelWidget::setResolutionEnabled(bool enabled) {
   if (m_resolutionGroup) {
     m_resolutionGroup->setEnabled(enabled);
   }
+  if (m_samplingGroup) {
+    m_samplingGroup->setEnabled(enabled && m_samplingSupported);
+  }
 }
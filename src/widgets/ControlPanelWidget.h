@@ -11,6 +11,11 @@
 #include <QSpinBox>
 #include <QWidget>
 
+#include "utils/FrameRateEstimator.h"
+#include "utils/RecordFile.h"
+#include "utils/RecordSegmenter.h"
+#include "utils/ThreadAffinity.h"
+
 /**
  * @brief 相机参数控制面板
  *
@@ -19,7 +24,10 @@
  * - 曝光控制
  * - 增益控制
  * - 帧率控制
- * - 分辨率显示 (只读)
+ * - 分辨率 / ROI
+ * - Binning / 抽样（应用前显示预估的最高帧率和带宽）
+ * - 线程调度（grab / 写盘 / 其余阶段的绑核和优先级，下次开始采集生效）
+ * - 录制写盘（写盘缓冲大小、直接 I/O、预分配、分段，下次开始录制生效）
  */
 class ControlPanelWidget : public QWidget {
   Q_OBJECT
@@ -61,6 +69,35 @@ public slots:
   void setResolutionMax(int w, int h);
   void setOffset(int x, int y);
   void setResultingFrameRate(float fps);
+  // 不发 threadTuningChanged
+  void setThreadTuning(const ThreadAffinity::Tuning &tuning);
+
+signals:
+  void threadTuningChanged(const ThreadAffinity::Tuning &tuning);
+
+public slots:
+  // 不发 recordFileOptionsChanged
+  void setRecordFileOptions(const RecordFile::Options &options);
+
+  // 不发 recordSegmentPolicyChanged
+  void setRecordSegmentPolicy(const RecordSegmenter::Policy &policy);
+
+signals:
+  void recordFileOptionsChanged(const RecordFile::Options &options);
+  void recordSegmentPolicyChanged(const RecordSegmenter::Policy &policy);
+
+public slots:
+  // 填可选倍数并选中当前设置（不发信号）；不支持时整组禁用
+  void setSamplingOptions(const SamplingOptions &options,
+                          const SamplingMode &current);
+  void setSamplingMode(const SamplingMode &mode);
+  void setSamplingEstimate(const FrameRateEstimate &estimate);
+
+signals:
+  // 下拉框选了新的倍数：请求预估（还没应用）
+  void samplingPreviewRequested(const SamplingMode &mode);
+  // 点"应用"
+  void samplingApplyRequested(const SamplingMode &mode);
 
 private slots:
   void onExposureSpinBoxChanged(double value);
@@ -82,6 +119,13 @@ private:
   QGroupBox *createGainGroup();
   QGroupBox *createFrameRateGroup();
   QGroupBox *createResolutionGroup();
+  QGroupBox *createThreadGroup();
+  QGroupBox *createSamplingGroup();
+  QGroupBox *createDiskGroup();
+  SamplingMode selectedSamplingMode() const;
+  ThreadAffinity::Tuning threadTuning() const;
+  RecordFile::Options recordFileOptions() const;
+  RecordSegmenter::Policy recordSegmentPolicy() const;
 
   // Slider 值与实际值转换
   int valueToSlider(float value, float min, float max);
@@ -125,6 +169,25 @@ private:
   QLabel *m_resolutionMaxLabel = nullptr;
   QSpinBox *m_offsetXSpinBox = nullptr;
   QSpinBox *m_offsetYSpinBox = nullptr;
+
+  // Binning / 抽样：0 binning 水平 / 1 binning 垂直 / 2 抽样水平 / 3 抽样垂直
+  QGroupBox *m_samplingGroup = nullptr;
+  QComboBox *m_samplingCombo[4] = {};
+  QLabel *m_samplingEstimateLabel = nullptr;
+  QPushButton *m_samplingApplyBtn = nullptr;
+  bool m_samplingSupported = false;
+  SamplingMode m_appliedSampling;
+
+  // 线程调度：0 grab / 1 写盘 / 2 其余阶段
+  QSpinBox *m_threadCoreSpin[3] = {};
+  QComboBox *m_threadPriorityCombo[3] = {};
+
+  // 录制写盘
+  QSpinBox *m_diskBufferSpin = nullptr;
+  QCheckBox *m_diskDirectIoCheck = nullptr;
+  QSpinBox *m_diskPreallocateSpin = nullptr;
+  QSpinBox *m_segmentMinutesSpin = nullptr;
+  QSpinBox *m_segmentGBSpin = nullptr;
 };
 
 #endif // CONTROLPANELWIDGET_H
@@ -3,6 +3,7 @@
 #include <QEnterEvent>
 #include <QMouseEvent>
 #include <QPalette>
+#include <QRubberBand>
 #include <QWheelEvent>
 
 #ifdef Q_OS_WIN
@@ -18,20 +19,10 @@ VideoDisplayWidget::VideoDisplayWidget(QWidget *parent) : QWidget(parent) {
   setAttribute(Qt::WA_PaintOnScreen);
   setAttribute(Qt::WA_NoSystemBackground);
   setAttribute(Qt::WA_OpaquePaintEvent);
-
-  // 初始化帧计时器
-  m_frameTimer.start();
-
-  // FPS 发送定时器
-  m_fpsEmitTimer = new QTimer(this);
-  connect(m_fpsEmitTimer, &QTimer::timeout, this, &VideoDisplayWidget::emitFps);
-  m_fpsEmitTimer->start(200);
-
-  // 初始最小大小
-  setMinimumSize(640, 480);
+  // 大小由 CaptureWidget 按可见区域摆放，不设最小尺寸
 }
 
-VideoDisplayWidget::~VideoDisplayWidget() {}
+VideoDisplayWidget::~VideoDisplayWidget() { delete m_rubberBand; }
 
 void *VideoDisplayWidget::getNativeHandle() {
 #ifdef Q_OS_WIN
@@ -41,22 +32,6 @@ void *VideoDisplayWidget::getNativeHandle() {
 #endif
 }
 
-void VideoDisplayWidget::notifyFrameRendered() {
-  qint64 elapsed = m_frameTimer.restart();
-  if (m_firstFrame) {
-    m_firstFrame = false;
-    return;
-  }
-  if (elapsed > 0) {
-    float instantFps = 1000.0f / static_cast<float>(elapsed);
-    if (m_smoothFps < 0.1f) {
-      m_smoothFps = instantFps;
-    } else {
-      m_smoothFps = EMA_ALPHA * instantFps + (1.0f - EMA_ALPHA) * m_smoothFps;
-    }
-  }
-}
-
 void VideoDisplayWidget::clear() {
 #ifdef Q_OS_WIN
   HWND hwnd = reinterpret_cast<HWND>(winId());
@@ -77,8 +52,6 @@ void VideoDisplayWidget::clear() {
 #endif
 }
 
-void VideoDisplayWidget::emitFps() { emit fpsUpdated(m_smoothFps); }
-
 void VideoDisplayWidget::setImageSize(int width, int height) {
   if (m_imageSize.width() != width || m_imageSize.height() != height) {
     m_imageSize = QSize(width, height);
@@ -87,10 +60,44 @@ void VideoDisplayWidget::setImageSize(int width, int height) {
   }
 }
 
+void VideoDisplayWidget::setSourceRect(const QRect &imageRect) {
+  m_sourceRect = imageRect;
+}
+
 void VideoDisplayWidget::setStreaming(bool streaming) {
   m_isStreaming = streaming;
 }
 
+void VideoDisplayWidget::setRoiSelectionEnabled(bool enabled) {
+  m_roiSelectionEnabled = enabled;
+  if (!enabled && m_isSelecting) {
+    m_isSelecting = false;
+    m_rubberBand->hide();
+  }
+  if (underMouse())
+    setCursor(enabled ? Qt::CrossCursor : Qt::OpenHandCursor);
+}
+
+QRect VideoDisplayWidget::widgetToImage(const QRect &widgetRect) const {
+  if (!m_imageSize.isValid() || width() <= 0 || height() <= 0)
+    return QRect();
+  // 源区域拉伸铺满整个控件（updateDisplayViewport 按缩放比例定控件大小）
+  const QRect source =
+      m_sourceRect.isEmpty() ? QRect(QPoint(0, 0), m_imageSize) : m_sourceRect;
+  const double sx = double(source.width()) / width();
+  const double sy = double(source.height()) / height();
+  const QRect r = widgetRect.normalized();
+  const int x0 =
+      qBound(0, source.x() + int(r.left() * sx), m_imageSize.width());
+  const int y0 =
+      qBound(0, source.y() + int(r.top() * sy), m_imageSize.height());
+  const int x1 = qBound(0, source.x() + int((r.right() + 1) * sx),
+                        m_imageSize.width());
+  const int y1 = qBound(0, source.y() + int((r.bottom() + 1) * sy),
+                        m_imageSize.height());
+  return QRect(x0, y0, x1 - x0, y1 - y0);
+}
+
 QSize VideoDisplayWidget::sizeHint() const {
   if (m_imageSize.isValid()) {
     return m_imageSize;
@@ -150,6 +157,16 @@ void VideoDisplayWidget::wheelEvent(QWheelEvent *event) {
 
 // 拖动 pan：标准图片查看器交互（按下变 ClosedHand，拖动时计算 delta）
 void VideoDisplayWidget::mousePressEvent(QMouseEvent *event) {
+  if (event->button() == Qt::LeftButton && m_roiSelectionEnabled) {
+    m_isSelecting = true;
+    m_selectOrigin = event->position().toPoint();
+    if (!m_rubberBand)
+      m_rubberBand = new QRubberBand(QRubberBand::Rectangle);
+    m_rubberBand->setGeometry(QRect(mapToGlobal(m_selectOrigin), QSize()));
+    m_rubberBand->show();
+    event->accept();
+    return;
+  }
   if (event->button() == Qt::LeftButton) {
     m_isPanning = true;
     m_lastPanPos = event->globalPosition().toPoint();
@@ -161,6 +178,14 @@ void VideoDisplayWidget::mousePressEvent(QMouseEvent *event) {
 }
 
 void VideoDisplayWidget::mouseMoveEvent(QMouseEvent *event) {
+  if (m_isSelecting) {
+    const QPoint cur = event->position().toPoint();
+    const QRect local = QRect(m_selectOrigin, cur).normalized() & rect();
+    m_rubberBand->setGeometry(
+        QRect(mapToGlobal(local.topLeft()), local.size()));
+    event->accept();
+    return;
+  }
   if (m_isPanning) {
     const QPoint cur = event->globalPosition().toPoint();
     const QPoint delta = cur - m_lastPanPos;
@@ -173,6 +198,19 @@ void VideoDisplayWidget::mouseMoveEvent(QMouseEvent *event) {
 }
 
 void VideoDisplayWidget::mouseReleaseEvent(QMouseEvent *event) {
+  if (event->button() == Qt::LeftButton && m_isSelecting) {
+    m_isSelecting = false;
+    m_rubberBand->hide();
+    const QRect local =
+        QRect(m_selectOrigin, event->position().toPoint()).normalized() &
+        rect();
+    const QRect imageRect = widgetToImage(local);
+    // 误点（几乎没拖动）不改 ROI
+    if (local.width() > 4 && local.height() > 4 && !imageRect.isEmpty())
+      emit roiSelected(imageRect);
+    event->accept();
+    return;
+  }
   if (event->button() == Qt::LeftButton && m_isPanning) {
     m_isPanning = false;
     setCursor(Qt::OpenHandCursor);
@@ -183,12 +221,13 @@ void VideoDisplayWidget::mouseReleaseEvent(QMouseEvent *event) {
 }
 
 void VideoDisplayWidget::enterEvent(QEnterEvent *event) {
-  setCursor(Qt::OpenHandCursor); // 提示可拖
+  // 提示可拖 / 可框选
+  setCursor(m_roiSelectionEnabled ? Qt::CrossCursor : Qt::OpenHandCursor);
   QWidget::enterEvent(event);
 }
 
 void VideoDisplayWidget::leaveEvent(QEvent *event) {
-  if (!m_isPanning) {
+  if (!m_isPanning && !m_isSelecting) {
     unsetCursor();
   }
   QWidget::leaveEvent(event);
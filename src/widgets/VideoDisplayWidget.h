@@ -1,12 +1,13 @@
 ﻿#ifndef VIDEODISPLAYWIDGET_H
 #define VIDEODISPLAYWIDGET_H
 
-#include <QElapsedTimer>
+#include <QRect>
 #include <QResizeEvent>
 #include <QSize>
-#include <QTimer>
 #include <QWidget>
 
+class QRubberBand;
+
 /**
  * @brief SDK 直接渲染视频显示组件
  *
@@ -24,11 +25,6 @@ public:
    */
   void *getNativeHandle();
 
-  /**
-   * @brief 通知帧已更新 (用于 EMA FPS 统计)
-   */
-  void notifyFrameRendered();
-
   /**
    * @brief 强制清空显示内容 (黑屏)
    */
@@ -39,6 +35,14 @@ public:
    */
   void setImageSize(int width, int height);
 
+  /**
+   * @brief 本窗口显示的图像区域（图像像素坐标）
+   *
+   * 放大时窗口只盖住可见部分，CameraController 只把这块裁出来交给 SDK；
+   * 框选坐标按它换算。空矩形表示整幅图像。
+   */
+  void setSourceRect(const QRect &imageRect);
+
   /**
    * @brief 设置当前是否正在进行视频流渲染
    *
@@ -46,18 +50,26 @@ public:
    */
   void setStreaming(bool streaming);
 
+  /**
+   * @brief ROI 框选模式：开启后左键拖出矩形，松开时发 roiSelected，
+   * 不再拖动画面
+   */
+  void setRoiSelectionEnabled(bool enabled);
+  bool roiSelectionEnabled() const { return m_roiSelectionEnabled; }
+
   // 保持纵横比的 sizeHint
   QSize sizeHint() const override;
   bool hasHeightForWidth() const override { return true; }
   int heightForWidth(int w) const override;
 
 signals:
-  void fpsUpdated(float fps);
   void imageSizeChanged(int width, int height);
   void wheelEventTriggered(QWheelEvent *event);
   // 左键拖动画面时发出：dx/dy 是相对上一帧光标的位移（像素）
   // 由 CaptureWidget 接住 → 调 ScrollArea 的 scrollBar 实现 pan
   void panDelta(int dx, int dy);
+  // 框选结束：矩形是当前图像（即相机当前 ROI）内的像素坐标
+  void roiSelected(const QRect &imageRect);
 
 protected:
   // 禁止 Qt 绘制，完全交给 SDK
@@ -71,22 +83,23 @@ protected:
   void enterEvent(QEnterEvent *event) override;
   void leaveEvent(QEvent *event) override;
 
-private slots:
-  void emitFps();
-
 private:
-  QTimer *m_fpsEmitTimer = nullptr;        // 定期发送 FPS 信号
-  QElapsedTimer m_frameTimer;              // 测量帧间隔
-  float m_smoothFps = 0.0f;                // EMA 平滑后的 FPS
-  bool m_firstFrame = true;                // 是否第一帧
-  static constexpr float EMA_ALPHA = 0.1f; // EMA 平滑系数
-
   QSize m_imageSize;          // 图像原始尺寸
+  QRect m_sourceRect;         // 本窗口显示的图像区域，空 = 整幅
   bool m_isStreaming = false; // 是否正在采集/预览
 
   // 拖动 pan 状态
   bool m_isPanning = false;
   QPoint m_lastPanPos; // 全局坐标，避免 widget 内部坐标因 scroll 抖动
+
+  // ROI 框选状态
+  bool m_roiSelectionEnabled = false;
+  bool m_isSelecting = false;
+  QPoint m_selectOrigin; // widget 坐标
+  // SDK 直接画在本窗口上，子控件会被视频帧盖掉，橡皮筋用独立的顶层窗口
+  QRubberBand *m_rubberBand = nullptr;
+
+  QRect widgetToImage(const QRect &widgetRect) const;
 };
 
 #endif // VIDEODISPLAYWIDGET_H
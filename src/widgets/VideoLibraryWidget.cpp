@@ -3,6 +3,7 @@
 #include "../data/VideoLibraryService.h"
 #include "../services/CloudService.h"
 #include "../utils/AppPaths.h"
+#include "../utils/RecordingDiagnostics.h"
 #include "../utils/VideoUtils.h"
 #include <QAction>
 #include <QCoreApplication>
@@ -124,7 +125,7 @@ void VideoLibraryWidget::scanVideoFolder() {
   qDebug() << "扫描视频目录:" << videoDir << "存在:" << dir.exists();
 
   QStringList filters;
-  filters << "*.mp4" << "*.avi";
+  filters << "*.mp4" << "*.avi" << "*.wvr";
   QFileInfoList fileList = dir.entryInfoList(filters, QDir::Files);
   qDebug() << "目录中发现" << fileList.size() << "个文件。";
 
@@ -135,7 +136,10 @@ void VideoLibraryWidget::scanVideoFolder() {
     info.filepath = fileInfo.absoluteFilePath();
     info.filesize = fileInfo.size();
     info.createdAt = fileInfo.birthTime();
-    info.duration = static_cast<qint64>(getVideoDuration(info.filepath));
+    const VideoUtils::VideoProbe probe =
+        VideoUtils::probeVideoFile(info.filepath);
+    info.duration = static_cast<qint64>(probe.durationSeconds);
+    info.frameCount = probe.frameCount;
 
     if (DatabaseManager::instance().upsertVideo(info)) {
       total++;
@@ -178,6 +182,8 @@ void VideoLibraryWidget::refreshLibrary() {
     QTableWidgetItem *durationItem = new QTableWidgetItem(
         video.duration > 0 ? formatDuration(video.duration) : "--:--");
     durationItem->setTextAlignment(Qt::AlignCenter);
+    if (video.frameCount > 0)
+      durationItem->setToolTip(QString("%1 帧").arg(video.frameCount));
     m_tableWidget->setItem(row, 2, durationItem);
 
     // Column 3: Size
@@ -206,10 +212,6 @@ QString VideoLibraryWidget::formatFileSize(qint64 bytes) {
   return VideoUtils::formatFileSize(bytes);
 }
 
-double VideoLibraryWidget::getVideoDuration(const QString &filepath) {
-  return VideoUtils::parseVideoDurationFromFile(filepath);
-}
-
 void VideoLibraryWidget::onRefreshClicked() {
   rescanAndRefresh();
 }
@@ -321,6 +323,7 @@ void VideoLibraryWidget::onDeleteAction() {
     QString filepath = item->data(Qt::UserRole + 1).toString();
 
     QFile::remove(filepath);
+    QFile::remove(RecordingDiagnostics::statsSidecarPath(filepath));
     DatabaseManager::instance().deleteVideo(id);
     m_tableWidget->removeRow(row);
   }
@@ -364,6 +367,7 @@ void VideoLibraryWidget::onBatchDeleteClicked() {
       int id = item->data(Qt::UserRole).toInt();
       QString filepath = item->data(Qt::UserRole + 1).toString();
       QFile::remove(filepath);
+      QFile::remove(RecordingDiagnostics::statsSidecarPath(filepath));
       DatabaseManager::instance().deleteVideo(id);
       m_tableWidget->removeRow(row);
     }
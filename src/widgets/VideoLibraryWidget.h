@@ -42,7 +42,6 @@ private:
   void scanVideoFolder(); // Helper to scan folder and update DB
   QString formatDuration(double seconds);
   QString formatFileSize(qint64 bytes);
-  double getVideoDuration(const QString &filepath);
 
   QTableWidget *m_tableWidget;
   QPushButton *m_refreshBtn;
@@ -0,0 +1,139 @@
+// 取帧方式对比基准：轮询（grab 线程循环 grabFrame）vs 回调（后端取流线程推帧）
+// 合成相机按固定帧率出图，devTimestamp 是节拍时刻的 steady_clock 纳秒，
+// 消费阶段收到帧时的时刻减去它就是"曝光 → 进入流水线阶段"的绝对延迟。
+// 每行跑固定帧数，输出延迟 p50 / p99 / max 和整个进程的 CPU 占用；
+// walltime 由帧率决定，没有参考意义。
+// 运行：bench_acquisition_mode
+#include "services/AcquisitionPipeline.h"
+#include "services/SyntheticCameraBackend.h"
+#include "utils/FramePool.h"
+#include "utils/FrameTelemetry.h"
+
+#include <QtTest>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+namespace {
+
+constexpr int kFramesPerRow = 600;
+// 与 CameraController 的池 / 队列配置保持一致
+constexpr std::size_t kRecordQueueCapacity = 8;
+constexpr std::size_t kFramePoolBuffers = 16;
+
+int64_t steadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+class BenchAcquisitionMode : public QObject {
+  Q_OBJECT
+private slots:
+
+  void latency_and_cpu_data() {
+    QTest::addColumn<bool>("callback");
+    QTest::addColumn<double>("fps");
+    QTest::newRow("polling 200fps") << false << 200.0;
+    QTest::newRow("callback 200fps") << true << 200.0;
+    QTest::newRow("polling 1000fps") << false << 1000.0;
+    QTest::newRow("callback 1000fps") << true << 1000.0;
+  }
+
+  void latency_and_cpu() {
+    QFETCH(bool, callback);
+    QFETCH(double, fps);
+
+    SyntheticCameraBackend::Config config;
+    config.width = 640;
+    config.height = 480;
+    config.fps = fps;
+    SyntheticCameraBackend backend(config);
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+
+    FramePool pool;
+    QVERIFY(pool.configure(kFramePoolBuffers,
+                           FramePool::frameBytesFor(640, 480,
+                                                    config.pixelType)));
+
+    // 只有一个消费阶段，直方图只在该阶段线程里写
+    LatencyHistogram latency;
+    std::atomic<int> received{0};
+    AcquisitionPipeline pipeline;
+    pipeline.addStage("consumer", kRecordQueueCapacity,
+                      AcquisitionPipeline::DropPolicy::DropNewest,
+                      [&](const FrameRef &frame) {
+                        const int64_t lagNs =
+                            steadyNowNs() -
+                            static_cast<int64_t>(frame.info().devTimestamp);
+                        latency.record(
+                            static_cast<uint64_t>(std::max<int64_t>(0, lagNs)) /
+                            1000);
+                        received.fetch_add(1, std::memory_order_relaxed);
+                      });
+    pipeline.start();
+
+    std::atomic<bool> stop{false};
+    std::thread grabThread;
+    if (callback) {
+      QCOMPARE(backend.setFrameCallback(
+                   &pool,
+                   [&pipeline](ICameraBackend::GrabResult result,
+                               FrameRef &frame) {
+                     if (result == ICameraBackend::GrabResult::Ok)
+                       pipeline.submit(frame);
+                   }),
+               ICameraBackend::kOk);
+    }
+
+    const std::clock_t cpu0 = std::clock();
+    const auto wall0 = std::chrono::steady_clock::now();
+    QBENCHMARK_ONCE {
+      QCOMPARE(backend.startGrabbing(), ICameraBackend::kOk);
+      if (!callback) {
+        // 与 CameraController::grabLoop 相同
+        grabThread = std::thread([&] {
+          while (!stop.load(std::memory_order_relaxed)) {
+            FrameRef frame;
+            const ICameraBackend::GrabResult result =
+                backend.grabFrame(pool, frame, 1000);
+            if (result == ICameraBackend::GrabResult::Ok)
+              pipeline.submit(frame);
+            else if (result == ICameraBackend::GrabResult::Error)
+              std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          }
+        });
+      }
+      const auto deadline = std::chrono::steady_clock::now() +
+                            std::chrono::seconds(30);
+      while (received.load(std::memory_order_relaxed) < kFramesPerRow &&
+             std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      stop = true;
+      if (grabThread.joinable())
+        grabThread.join();
+      backend.stopGrabbing();
+    }
+    const double cpuMs = 1000.0 * double(std::clock() - cpu0) / CLOCKS_PER_SEC;
+    const double wallMs = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - wall0)
+                              .count();
+    pipeline.stop();
+    backend.setFrameCallback(nullptr, nullptr);
+    QVERIFY(received.load() >= kFramesPerRow);
+
+    qInfo() << (callback ? "callback" : "polling") << fps << "fps:"
+            << "latency us p50" << latency.percentile(50) << "p99"
+            << latency.percentile(99) << "max" << latency.max() << "| cpu"
+            << cpuMs << "ms over" << wallMs << "ms ="
+            << (wallMs > 0 ? 100.0 * cpuMs / wallMs : 0.0) << "% of one core"
+            << "| dropped" << pipeline.stageStats(0).dropped << "pool exhausted"
+            << pool.stats().exhausted;
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchAcquisitionMode)
+#include "bench_acquisition_mode.moc"
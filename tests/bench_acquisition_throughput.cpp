@@ -0,0 +1,105 @@
+// 采集链路吞吐基准：合成相机（不限速）→ FramePool → AcquisitionPipeline
+// 和 CameraController 的 grab 线程走同一条路径：grabFrame 直接写池缓冲，
+// submit 给 display（KeepLatest）/ record（DropNewest）两个阶段。
+// 每个数据行固定取 kFramesPerIteration 帧，walltime 除以帧数即单帧开销；
+// 每次构建跑一遍即可看出吞吐回退。
+// 运行：bench_acquisition_throughput（可加 -tickcounter）
+#include "services/AcquisitionPipeline.h"
+#include "services/SyntheticCameraBackend.h"
+#include "utils/FramePool.h"
+
+#include <QtTest>
+#include <atomic>
+#include <cstdint>
+
+namespace {
+
+constexpr int kFramesPerIteration = 120;
+// 与 CameraController 的池 / 队列配置保持一致
+constexpr std::size_t kDisplayQueueCapacity = 2;
+constexpr std::size_t kRecordQueueCapacity = 8;
+constexpr std::size_t kFramePoolBuffers = 16;
+
+} // namespace
+
+class BenchAcquisitionThroughput : public QObject {
+  Q_OBJECT
+private slots:
+
+  void synthetic_to_pipeline_data() {
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<uint32_t>("pixelType");
+    QTest::newRow("1280x1024 Mono8")
+        << 1280 << 1024 << SyntheticCameraBackend::kPixelMono8;
+    QTest::newRow("2448x2048 Mono8")
+        << 2448 << 2048 << SyntheticCameraBackend::kPixelMono8;
+    QTest::newRow("2448x2048 BayerRG8")
+        << 2448 << 2048 << SyntheticCameraBackend::kPixelBayerRG8;
+    QTest::newRow("2448x2048 Mono12")
+        << 2448 << 2048 << SyntheticCameraBackend::kPixelMono12;
+  }
+
+  void synthetic_to_pipeline() {
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(uint32_t, pixelType);
+
+    SyntheticCameraBackend::Config config;
+    config.width = width;
+    config.height = height;
+    config.pixelType = pixelType;
+    config.fps = 0.0;
+    SyntheticCameraBackend backend(config);
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+
+    FramePool pool;
+    QVERIFY(pool.configure(kFramePoolBuffers,
+                           FramePool::frameBytesFor(width, height, pixelType)));
+
+    // 录制阶段模拟编码器读一遍像素
+    std::atomic<uint64_t> checksum{0};
+    AcquisitionPipeline pipeline;
+    pipeline.addStage("display", kDisplayQueueCapacity,
+                      AcquisitionPipeline::DropPolicy::KeepLatest,
+                      [](const FrameRef &) {});
+    pipeline.addStage(
+        "record", kRecordQueueCapacity,
+        AcquisitionPipeline::DropPolicy::DropNewest,
+        [&checksum](const FrameRef &frame) {
+          uint64_t sum = 0;
+          const auto *p = reinterpret_cast<const uint64_t *>(frame.data());
+          for (std::size_t i = 0; i < frame.size() / sizeof(uint64_t); ++i)
+            sum += p[i];
+          checksum.fetch_add(sum, std::memory_order_relaxed);
+        },
+        true);
+    pipeline.start();
+    QCOMPARE(backend.startGrabbing(), ICameraBackend::kOk);
+
+    int grabbed = 0;
+    QBENCHMARK {
+      for (int i = 0; i < kFramesPerIteration; ++i) {
+        FrameRef frame;
+        if (backend.grabFrame(pool, frame, 1000) !=
+            ICameraBackend::GrabResult::Ok)
+          continue;
+        pipeline.submit(frame);
+        ++grabbed;
+      }
+    }
+
+    backend.stopGrabbing();
+    pipeline.stop();
+    QVERIFY(grabbed > 0);
+
+    // 丢帧数一并输出，吞吐变化时能区分是 grab 变慢还是消费者变慢
+    const AcquisitionPipeline::StageStats record = pipeline.stageStats(1);
+    qInfo() << "grabbed" << grabbed << "pool exhausted"
+            << pool.stats().exhausted << "record processed" << record.processed
+            << "dropped" << record.dropped;
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchAcquisitionThroughput)
+#include "bench_acquisition_throughput.moc"
@@ -0,0 +1,101 @@
+// Bayer 去马赛克基准：1080p 与 5 MP 下标量 / SSE2 / AVX2 转 BGR8、
+// Mono8（加权亮度）和 Mono8（绿通道）的单帧耗时，以及相对标量的加速比。
+// 录制线程每帧都做这一步，单帧耗时必须明显小于帧间隔，否则 Bayer 相机录制时会掉帧。
+// 运行：bench_bayer_demosaic
+#include "utils/BayerDemosaic.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace BayerDemosaic;
+
+namespace {
+
+constexpr int kFramesPerIsa = 30;
+
+enum { kBgr, kLuma, kGreen };
+const char *const kOutputNames[] = {"BGR8", "Mono8", "Mono8(G)"};
+
+// 每种实现跑 kFramesPerIsa 帧，返回单帧耗时中位数（ms）
+template <typename Fn> double medianFrameMs(Fn &&convertOnce) {
+  std::vector<double> ms;
+  ms.reserve(kFramesPerIsa);
+  for (int i = 0; i < kFramesPerIsa; ++i) {
+    const auto t0 = std::chrono::steady_clock::now();
+    convertOnce();
+    ms.push_back(std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - t0)
+                     .count());
+  }
+  std::nth_element(ms.begin(), ms.begin() + ms.size() / 2, ms.end());
+  return ms[ms.size() / 2];
+}
+
+} // namespace
+
+class BenchBayerDemosaic : public QObject {
+  Q_OBJECT
+private slots:
+
+  void demosaic_data() {
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("output");
+    QTest::newRow("1920x1080 → BGR8") << 1920 << 1080 << int(kBgr);
+    QTest::newRow("1920x1080 → Mono8") << 1920 << 1080 << int(kLuma);
+    QTest::newRow("2448x2048 (5 MP) → BGR8") << 2448 << 2048 << int(kBgr);
+    QTest::newRow("2448x2048 (5 MP) → Mono8") << 2448 << 2048 << int(kLuma);
+    QTest::newRow("2448x2048 (5 MP) → Mono8 绿通道")
+        << 2448 << 2048 << int(kGreen);
+  }
+
+  void demosaic() {
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, output);
+    const bool mono = output != kBgr;
+
+    std::vector<uint8_t> raw(std::size_t(width) * height);
+    std::mt19937 rng(42);
+    for (uint8_t &b : raw)
+      b = uint8_t(rng());
+    const int dstStride = mono ? width : width * 3;
+    std::vector<uint8_t> dst(std::size_t(dstStride) * height);
+
+    double scalarMs = 0.0;
+    double bestMs = 0.0;
+    QBENCHMARK_ONCE {
+      for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+        if (!CpuFeatures::isSupported(isa))
+          continue;
+        const double ms = medianFrameMs([&] {
+          if (output == kGreen)
+            toGreen8(raw.data(), width, height, width, Pattern::RG,
+                     dst.data(), dstStride, isa);
+          else if (output == kLuma)
+            toMono8(raw.data(), width, height, width, Pattern::RG, dst.data(),
+                    dstStride, isa);
+          else
+            toBgr8(raw.data(), width, height, width, Pattern::RG, dst.data(),
+                   dstStride, isa);
+        });
+        if (isa == Isa::Scalar)
+          scalarMs = ms;
+        bestMs = ms;
+        qInfo() << width << "x" << height << kOutputNames[output]
+                << CpuFeatures::name(isa) << ms << "ms/帧 | 相对标量"
+                << (ms > 0 ? scalarMs / ms : 0.0) << "x | 约"
+                << (ms > 0 ? 1000.0 / ms : 0.0) << "fps（单线程）";
+      }
+    }
+    // 有 SIMD 时必须比标量快
+    if (CpuFeatures::best() != Isa::Scalar)
+      QVERIFY(bestMs < scalarMs);
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchBayerDemosaic)
+#include "bench_bayer_demosaic.moc"
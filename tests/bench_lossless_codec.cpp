@@ -0,0 +1,190 @@
+// 无损压缩基准：合成的线虫画面（琼脂背景的暗角渐变 + 几个灰阶的传感器
+// 噪声 + 十几条正弦形的暗色虫体，逐帧移动），5 MP Mono8 / Mono12 与
+// 1080p BayerRG8。输出压缩比，以及单线程 / TilePool 全核的编码、解码
+// MB/s（按原始帧字节算）。对照：5 MP Mono8 60 fps 原样写盘约 300 MB/s，
+// 编码吞吐要高于它，压缩比决定实际写盘带宽。
+// 运行：bench_lossless_codec
+#include "utils/LosslessCodec.h"
+#include "utils/PixelFormats.h"
+#include "utils/TilePool.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kFrames = 4;       // 不同的虫体位置，轮流编码
+constexpr int kFramesPerRow = 20; // 每种配置编 / 解码的帧数
+constexpr int kWorms = 14;
+constexpr double kPi = 3.14159265358979323846;
+
+struct Worm {
+  double x0, y0, angle, wavelength, amplitude, phase;
+};
+
+// 一帧的亮度：灰度按 maxValue 缩放，Bayer 各颜色通道增益不同
+std::vector<uint8_t> makeWormFrame(uint32_t pixelType, int width, int height,
+                                   const std::vector<Worm> &worms, int frame,
+                                   std::mt19937 &rng) {
+  const PixelFormats::Descriptor *d = PixelFormats::find(pixelType);
+  const bool wide = d->bitsPerPixel == 16;
+  const double scale = wide ? 16.0 : 1.0; // 12 位低位对齐
+  const bool bayer = d->family == PixelFormats::Family::Bayer;
+
+  std::vector<double> luma(std::size_t(width) * height);
+  const double cx = width / 2.0;
+  const double cy = height / 2.0;
+  const double r2 = cx * cx + cy * cy;
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x) {
+      const double dx = x - cx;
+      const double dy = y - cy;
+      luma[std::size_t(y) * width + x] =
+          185.0 - 35.0 * (dx * dx + dy * dy) / r2;
+    }
+
+  // 虫体：沿正弦中线画暗色圆盘（5 MP 下半径 4 像素），每帧往前爬一点
+  const int radius = std::max(3, width / 500);
+  for (const Worm &w : worms) {
+    const double length = width / 6.0;
+    for (double t = 0.0; t < length; t += 1.0) {
+      const double s = w.amplitude *
+                       std::sin(2 * kPi * t / w.wavelength + w.phase + frame);
+      const double px = w.x0 + frame * 3.0 + t * std::cos(w.angle) -
+                        s * std::sin(w.angle);
+      const double py = w.y0 + t * std::sin(w.angle) + s * std::cos(w.angle);
+      for (int dy = -radius; dy <= radius; ++dy)
+        for (int dx = -radius; dx <= radius; ++dx) {
+          const int x = int(px) + dx;
+          const int y = int(py) + dy;
+          if (x < 0 || y < 0 || x >= width || y >= height ||
+              dx * dx + dy * dy > radius * radius)
+            continue;
+          luma[std::size_t(y) * width + x] = 70.0;
+        }
+    }
+  }
+
+  std::vector<uint8_t> out(PixelFormats::frameBytes(pixelType, width, height));
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x) {
+      double v = luma[std::size_t(y) * width + x];
+      if (bayer) // RGGB：R 偏亮、B 偏暗
+        v *= (y & 1) == 0 ? ((x & 1) == 0 ? 1.1 : 1.0)
+                          : ((x & 1) == 0 ? 1.0 : 0.75);
+      // 三角分布噪声，±2 个灰阶（12 位时 ±32）
+      const double noise = int(rng() % 3) + int(rng() % 3) - 2;
+      const int value = int(std::lround((v + noise) * scale));
+      const std::size_t i = std::size_t(y) * width + x;
+      if (wide) {
+        const uint16_t s = uint16_t(std::clamp(value, 0, 4095));
+        std::memcpy(out.data() + i * 2, &s, 2);
+      } else {
+        out[i] = uint8_t(std::clamp(value, 0, 255));
+      }
+    }
+  return out;
+}
+
+double msSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+} // namespace
+
+class BenchLosslessCodec : public QObject {
+  Q_OBJECT
+private slots:
+
+  void throughput_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::newRow("Mono8 2448x2048 (5 MP)")
+        << uint(PixelFormats::kMono8) << 2448 << 2048;
+    QTest::newRow("Mono12 2448x2048 (5 MP)")
+        << uint(PixelFormats::kMono12) << 2448 << 2048;
+    QTest::newRow("BayerRG8 1920x1080") << uint(0x01080009) << 1920 << 1080;
+  }
+
+  void throughput() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(int, height);
+
+    LosslessCodec::Layout layout;
+    QVERIFY(LosslessCodec::layoutFor(pixelType, width, height, &layout));
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<Worm> worms;
+    for (int i = 0; i < kWorms; ++i)
+      worms.push_back({u(rng) * width * 0.8, u(rng) * height * 0.9,
+                       u(rng) * 2 * kPi, 60.0 + u(rng) * 60.0,
+                       8.0 + u(rng) * 12.0, u(rng) * 2 * kPi});
+    std::vector<std::vector<uint8_t>> frames;
+    for (int f = 0; f < kFrames; ++f)
+      frames.push_back(
+          makeWormFrame(pixelType, width, height, worms, f, rng));
+
+    TilePool pool;
+    std::vector<std::vector<uint8_t>> streams(kFrames);
+    std::vector<uint8_t> decoded(layout.frameBytes());
+    const double frameMB = double(layout.frameBytes()) / (1 << 20);
+
+    QBENCHMARK_ONCE {
+      uint64_t encodedBytes = 0;
+      double encodeMs[2] = {0.0, 0.0};
+      double decodeMs[2] = {0.0, 0.0};
+      for (int mode = 0; mode < 2; ++mode) {
+        TilePool *p = mode == 0 ? nullptr : &pool;
+        LosslessCodec::Encoder encoder;
+        QVERIFY(encoder.configure(layout));
+        encoder.encode(frames[0].data(), p); // 预热
+        for (int i = 0; i < kFramesPerRow; ++i) {
+          const std::vector<uint8_t> &frame = frames[std::size_t(i % kFrames)];
+          const auto t0 = std::chrono::steady_clock::now();
+          const std::size_t bytes = encoder.encode(frame.data(), p);
+          encodeMs[mode] += msSince(t0);
+          if (mode == 0 && i < kFrames) {
+            encodedBytes += bytes;
+            std::vector<uint8_t> &s = streams[std::size_t(i)];
+            s.clear();
+            for (const LosslessCodec::Encoder::Piece &piece : encoder.pieces())
+              s.insert(s.end(), piece.data, piece.data + piece.bytes);
+          }
+        }
+        for (int i = 0; i < kFramesPerRow; ++i) {
+          const std::vector<uint8_t> &s = streams[std::size_t(i % kFrames)];
+          const auto t0 = std::chrono::steady_clock::now();
+          QVERIFY(LosslessCodec::decode(layout, s.data(), s.size(),
+                                        decoded.data(), p));
+          decodeMs[mode] += msSince(t0);
+          QVERIFY(decoded == frames[std::size_t(i % kFrames)]);
+        }
+      }
+
+      const double ratio =
+          double(layout.frameBytes()) * kFrames / double(encodedBytes);
+      const double totalMB = frameMB * kFramesPerRow;
+      qInfo() << width << "x" << height
+              << PixelFormats::find(pixelType)->name
+              << "压缩比" << ratio << ":1 | 单线程 编码"
+              << totalMB / (encodeMs[0] / 1000.0) << "MB/s 解码"
+              << totalMB / (decodeMs[0] / 1000.0) << "MB/s |"
+              << pool.threadCount() << "线程 编码"
+              << totalMB / (encodeMs[1] / 1000.0) << "MB/s 解码"
+              << totalMB / (decodeMs[1] / 1000.0) << "MB/s";
+      QVERIFY(ratio > 1.5);
+    }
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchLosslessCodec)
+#include "bench_lossless_codec.moc"
@@ -0,0 +1,180 @@
+// 多相机并发采集基准：N 台合成相机各自 60 fps，每台独立的帧缓冲池、流水线
+// 和（可绑核的）grab 线程。CameraController 直接调用海康 SDK，不链接 SDK 时
+// 建不出来，这里只按同样的结构搭（缓冲配置取自 CameraBufferLayout），测的是
+// 相机之间互不拖累；CameraManager 的同步开录见 test_recording_sync。
+// 第 0 台的录制阶段每 kStallEveryFrames 帧卡 kStallMs（模拟磁盘停顿），
+// 检查：各相机帧数达标、没有帧号空洞、其他相机的延迟不受第 0 台影响；
+// 启动时先全部分配好缓冲池再背靠背 startGrabbing，输出启动时间差。
+// 运行：bench_multi_camera
+#include "services/AcquisitionPipeline.h"
+#include "services/CameraBufferLayout.h"
+#include "services/SyntheticCameraBackend.h"
+#include "utils/BufferSizing.h"
+#include "utils/FramePool.h"
+#include "utils/FrameTelemetry.h"
+#include "utils/ThreadAffinity.h"
+
+#include <QtTest>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr double kFps = 60.0;
+constexpr int kRunMs = 3000;
+constexpr int kStallEveryFrames = 40;
+constexpr int kStallMs = 200;
+
+int64_t steadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Camera {
+  std::unique_ptr<SyntheticCameraBackend> backend;
+  FramePool pool;
+  AcquisitionPipeline pipeline;
+  std::thread grabThread;
+  // grab 线程写，停止后主线程读
+  FrameTelemetry telemetry;
+  // 录制阶段线程写
+  LatencyHistogram latencyUs;
+  std::atomic<int> recorded{0};
+};
+
+} // namespace
+
+class BenchMultiCamera : public QObject {
+  Q_OBJECT
+private slots:
+
+  void concurrent_streams_data() {
+    QTest::addColumn<int>("cameras");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<bool>("pin");
+    // 合成相机自己生成画面也要占 CPU：大分辨率行需要每台相机一个核
+    QTest::addColumn<bool>("needsCorePerCamera");
+    QTest::newRow("4 x 640x480") << 4 << 640 << 480 << false << false;
+    QTest::newRow("4 x 640x480 pinned") << 4 << 640 << 480 << true << false;
+    QTest::newRow("4 x 1280x1024 pinned")
+        << 4 << 1280 << 1024 << true << true;
+  }
+
+  void concurrent_streams() {
+    QFETCH(int, cameras);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(bool, pin);
+    QFETCH(bool, needsCorePerCamera);
+    if (needsCorePerCamera && ThreadAffinity::coreCount() <= cameras)
+      QSKIP("逻辑核数不足，合成相机出图本身跟不上 60 fps");
+
+    SyntheticCameraBackend::Config config;
+    config.width = width;
+    config.height = height;
+    config.fps = kFps;
+    config.cameras = cameras;
+
+    // 与 CameraController::startGrabbing 相同的缓冲配置（还没观测到停顿）
+    const BufferSizingInput sizingInput = CameraBufferLayout::sizingInput(
+        FramePool::frameBytesFor(width, height, config.pixelType), kFps,
+        CameraBufferLayout::kDefaultBufferBudgetBytes,
+        CameraBufferLayout::kDefaultStallUs);
+    const BufferSizing sizing = BufferSizingPolicy::compute(sizingInput);
+
+    std::vector<std::unique_ptr<Camera>> cams;
+    for (int i = 0; i < cameras; ++i) {
+      auto cam = std::make_unique<Camera>();
+      cam->backend = std::make_unique<SyntheticCameraBackend>(config);
+      QCOMPARE(cam->backend->open(i), ICameraBackend::kOk);
+      QVERIFY(cam->pool.configure(sizing.poolBuffers, sizingInput.frameBytes));
+      Camera *raw = cam.get();
+      const bool stalls = i == 0;
+      const int recordStage = cam->pipeline.addStage(
+          "record", CameraBufferLayout::kRecordQueueMaxCapacity,
+          AcquisitionPipeline::DropPolicy::DropNewest,
+          [raw, stalls](const FrameRef &frame) {
+            const int64_t lagNs =
+                steadyNowNs() - static_cast<int64_t>(frame.info().devTimestamp);
+            raw->latencyUs.record(
+                static_cast<uint64_t>(std::max<int64_t>(0, lagNs)) / 1000);
+            const int n = raw->recorded.fetch_add(1) + 1;
+            if (stalls && n % kStallEveryFrames == 0)
+              std::this_thread::sleep_for(std::chrono::milliseconds(kStallMs));
+          },
+          true);
+      cam->pipeline.setStageLimit(recordStage, sizing.recordQueueLimit);
+      cam->pipeline.start();
+      cam->telemetry.reset(1e9);
+      cams.push_back(std::move(cam));
+    }
+
+    std::atomic<bool> stop{false};
+    const int cores = ThreadAffinity::coreCount();
+    int64_t skewUs = 0;
+    QBENCHMARK_ONCE {
+      const auto t0 = std::chrono::steady_clock::now();
+      for (auto &cam : cams)
+        QCOMPARE(cam->backend->startGrabbing(), ICameraBackend::kOk);
+      skewUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - t0)
+                   .count();
+      for (int i = 0; i < cameras; ++i) {
+        Camera *cam = cams[static_cast<std::size_t>(i)].get();
+        const int core = pin && cores > cameras ? (i + 1) % cores : -1;
+        // 与 CameraController::grabLoop 相同
+        cam->grabThread = std::thread([cam, core, &stop] {
+          if (core >= 0)
+            ThreadAffinity::pinCurrentThread(core);
+          while (!stop.load(std::memory_order_relaxed)) {
+            FrameRef frame;
+            const ICameraBackend::GrabResult result =
+                cam->backend->grabFrame(cam->pool, frame, 1000);
+            if (result == ICameraBackend::GrabResult::Ok) {
+              cam->telemetry.record(frame.info());
+              cam->pipeline.submit(frame);
+            } else if (result == ICameraBackend::GrabResult::Error) {
+              std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+          }
+        });
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(kRunMs));
+      stop = true;
+      for (auto &cam : cams) {
+        cam->grabThread.join();
+        cam->backend->stopGrabbing();
+      }
+    }
+
+    const int expected = static_cast<int>(kFps * kRunMs / 1000.0);
+    qInfo() << cameras << "台" << width << "x" << height
+            << (pin ? "绑核" : "不绑核") << "| 启动时间差" << skewUs << "us"
+            << "| 录制队列" << sizing.recordQueueLimit << "可吸收停顿"
+            << sizing.absorbableStallMs << "ms";
+    for (int i = 0; i < cameras; ++i) {
+      Camera &cam = *cams[static_cast<std::size_t>(i)];
+      cam.pipeline.stop();
+      const FrameTelemetry::Summary t = cam.telemetry.summary();
+      const AcquisitionPipeline::StageStats st = cam.pipeline.stageStats(0);
+      qInfo() << "  相机" << i << (i == 0 ? "(录制停顿)" : "") << "帧"
+              << t.frames << "丢帧" << t.lostFrames << "队列丢弃" << st.dropped
+              << "池耗尽" << cam.pool.stats().exhausted << "队列峰值"
+              << st.highWater << "| 采集 → 录制延迟 us p50"
+              << cam.latencyUs.percentile(50) << "p99"
+              << cam.latencyUs.percentile(99);
+      QVERIFY(t.frames >= static_cast<uint64_t>(expected * 9 / 10));
+      QCOMPARE(t.lostFrames, uint64_t(0));
+      QCOMPARE(st.dropped, uint64_t(0));
+      QCOMPARE(cam.pool.stats().exhausted, uint64_t(0));
+    }
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchMultiCamera)
+#include "bench_multi_camera.moc"
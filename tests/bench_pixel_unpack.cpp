@@ -0,0 +1,104 @@
+// 高位深解包基准：5 MP / 20 MP 的 Mono12Packed、Mono10Packed、Mono12
+// 解成 16 位（快照）和取高 8 位（录制）时，标量 / SSE2 / AVX2 的单帧耗时。
+// 20 MP 帧在 30 fps 下帧间隔约 33 ms，解包只能占其中一小部分。
+// 运行：bench_pixel_unpack
+#include "utils/PixelFormats.h"
+#include "utils/PixelUnpack.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace PixelUnpack;
+
+namespace {
+
+constexpr int kFramesPerIsa = 20;
+
+// 每种实现跑 kFramesPerIsa 帧，返回单帧耗时中位数（ms）
+template <typename Fn> double medianFrameMs(Fn &&unpackOnce) {
+  std::vector<double> ms;
+  ms.reserve(kFramesPerIsa);
+  for (int i = 0; i < kFramesPerIsa; ++i) {
+    const auto t0 = std::chrono::steady_clock::now();
+    unpackOnce();
+    ms.push_back(std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - t0)
+                     .count());
+  }
+  std::nth_element(ms.begin(), ms.begin() + ms.size() / 2, ms.end());
+  return ms[ms.size() / 2];
+}
+
+} // namespace
+
+class BenchPixelUnpack : public QObject {
+  Q_OBJECT
+private slots:
+
+  void unpack_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<bool>("to8");
+    QTest::newRow("Mono12Packed 5 MP → 16 位")
+        << uint(PixelFormats::kMono12Packed) << 2448 << 2048 << false;
+    QTest::newRow("Mono12Packed 5 MP → 8 位")
+        << uint(PixelFormats::kMono12Packed) << 2448 << 2048 << true;
+    QTest::newRow("Mono10Packed 20 MP → 16 位")
+        << uint(PixelFormats::kMono10Packed) << 5472 << 3648 << false;
+    QTest::newRow("Mono12Packed 20 MP → 8 位")
+        << uint(PixelFormats::kMono12Packed) << 5472 << 3648 << true;
+    QTest::newRow("Mono12 20 MP → 16 位")
+        << uint(PixelFormats::kMono12) << 5472 << 3648 << false;
+  }
+
+  void unpack() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(bool, to8);
+
+    std::vector<uint8_t> raw(
+        PixelFormats::frameBytes(pixelType, width, height));
+    std::mt19937 rng(42);
+    for (uint8_t &b : raw)
+      b = uint8_t(rng());
+    const std::size_t pixels = std::size_t(width) * height;
+    std::vector<uint16_t> dst16(pixels);
+    std::vector<uint8_t> dst8(pixels);
+
+    double scalarMs = 0.0;
+    double bestMs = 0.0;
+    QBENCHMARK_ONCE {
+      for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+        if (!CpuFeatures::isSupported(isa))
+          continue;
+        const double ms = medianFrameMs([&] {
+          if (to8)
+            toU8(raw.data(), raw.size(), pixelType, width, height,
+                 dst8.data(), isa);
+          else
+            toU16(raw.data(), raw.size(), pixelType, width, height,
+                  dst16.data(), isa);
+        });
+        if (isa == Isa::Scalar)
+          scalarMs = ms;
+        bestMs = ms;
+        qInfo() << width << "x" << height
+                << PixelFormats::find(pixelType)->name
+                << (to8 ? "→ 8 位" : "→ 16 位") << CpuFeatures::name(isa)
+                << ms << "ms/帧 | 相对标量" << (ms > 0 ? scalarMs / ms : 0.0)
+                << "x";
+      }
+    }
+    // 打包格式有 AVX2 时必须比标量快（SSE2 对打包格式退回标量）
+    if (CpuFeatures::isSupported(Isa::Avx2))
+      QVERIFY(bestMs < scalarMs);
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchPixelUnpack)
+#include "bench_pixel_unpack.moc"
@@ -0,0 +1,104 @@
+// 预触发环形缓冲基准：按传感器最高帧率持续 push（环满后每帧覆盖最旧一帧），
+// 单帧耗时的 p99 必须小于帧间隔，否则录制阶段跟不上相机。
+// 环在 configure 时一次分配并写页，稳态 push 只有 memcpy，不分配内存；
+// 这里同时检查环的缓冲池没有耗尽、源帧缓冲被及时归还。
+// 运行：bench_pre_trigger
+#include "utils/FrameTelemetry.h"
+#include "utils/PreTriggerRing.h"
+
+#include <QtTest>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+constexpr int kPushesPerRow = 2000;
+constexpr double kPreTriggerSeconds = 2.0;
+// 与 CameraController 的默认预触发内存预算同量级，避免在 CI 机器上吃满内存
+constexpr std::size_t kBudgetBytes = std::size_t(256) << 20;
+constexpr std::size_t kSourceBuffers = 4;
+
+} // namespace
+
+class BenchPreTrigger : public QObject {
+  Q_OBJECT
+private slots:
+
+  void push_at_sensor_rate_data() {
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<double>("sensorFps");
+    QTest::newRow("640x480 Mono8 @1000fps") << 640 << 480 << 1000.0;
+    QTest::newRow("1280x1024 Mono8 @200fps") << 1280 << 1024 << 200.0;
+    QTest::newRow("2448x2048 Mono8 @75fps") << 2448 << 2048 << 75.0;
+  }
+
+  void push_at_sensor_rate() {
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(double, sensorFps);
+    const std::size_t frameBytes = std::size_t(width) * height;
+
+    FramePool source;
+    QVERIFY(source.configure(kSourceBuffers, frameBytes));
+    std::vector<FrameRef> frames;
+    for (std::size_t i = 0; i < kSourceBuffers; ++i) {
+      FrameRef f = source.acquire();
+      std::memset(f.writableData(), int(i), frameBytes);
+      f.writableInfo().frameLen = frameBytes;
+      frames.push_back(std::move(f));
+    }
+
+    PreTriggerRing ring;
+    const std::size_t slotCount = PreTriggerRing::slotsFor(
+        kPreTriggerSeconds, sensorFps, kBudgetBytes, frameBytes);
+    QVERIFY(slotCount > 0);
+    QVERIFY(ring.configure(slotCount, frameBytes));
+
+    // 先填满，之后每次 push 都是覆盖
+    uint32_t frameNum = 0;
+    const int64_t intervalNs = int64_t(1e9 / sensorFps);
+    auto pushNext = [&] {
+      FrameRef &f = frames[frameNum % kSourceBuffers];
+      f.writableInfo().frameNum = frameNum;
+      f.writableInfo().grabTimeNs = int64_t(frameNum) * intervalNs;
+      ++frameNum;
+      return ring.push(f);
+    };
+    for (std::size_t i = 0; i < slotCount; ++i)
+      QVERIFY(pushNext());
+
+    LatencyHistogram pushUs;
+    const auto wall0 = std::chrono::steady_clock::now();
+    QBENCHMARK_ONCE {
+      for (int i = 0; i < kPushesPerRow; ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool ok = pushNext();
+        const auto t1 = std::chrono::steady_clock::now();
+        QVERIFY(ok);
+        pushUs.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0)
+                .count()));
+      }
+    }
+    const double wallSec = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - wall0)
+                               .count();
+
+    QCOMPARE(ring.size(), slotCount);
+    QCOMPARE(ring.overwritten(), uint64_t(kPushesPerRow));
+    QCOMPARE(ring.spanNs(), int64_t(slotCount - 1) * intervalNs);
+
+    const double intervalUs = 1e6 / sensorFps;
+    qInfo() << width << "x" << height << "@" << sensorFps << "fps:" << slotCount
+            << "slots" << (slotCount * frameBytes >> 20) << "MiB | push us p50"
+            << pushUs.percentile(50) << "p99" << pushUs.percentile(99) << "max"
+            << pushUs.max() << "| frame interval" << intervalUs
+            << "us | sustained" << (wallSec > 0 ? kPushesPerRow / wallSec : 0.0)
+            << "fps";
+    QVERIFY(double(pushUs.percentile(99)) < intervalUs);
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchPreTrigger)
+#include "bench_pre_trigger.moc"
@@ -0,0 +1,102 @@
+// 预览缩小基准：20 MP / 5 MP 帧缩到常见窗口大小时，标量 / SSE2 / AVX2 的
+// 单帧耗时，以及交给 SDK 显示的像素比整帧少了多少。
+// 显示阶段每帧都做这一步，耗时要远小于原来 SDK 处理整帧的开销。
+// 运行：bench_preview_scaler
+#include "utils/PixelFormats.h"
+#include "utils/PreviewScaler.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace PreviewScaler;
+
+namespace {
+
+constexpr int kFramesPerIsa = 20;
+
+// 每种实现跑 kFramesPerIsa 帧，返回单帧耗时中位数（ms）
+template <typename Fn> double medianFrameMs(Fn &&scaleOnce) {
+  std::vector<double> ms;
+  ms.reserve(kFramesPerIsa);
+  for (int i = 0; i < kFramesPerIsa; ++i) {
+    const auto t0 = std::chrono::steady_clock::now();
+    scaleOnce();
+    ms.push_back(std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - t0)
+                     .count());
+  }
+  std::nth_element(ms.begin(), ms.begin() + ms.size() / 2, ms.end());
+  return ms[ms.size() / 2];
+}
+
+} // namespace
+
+class BenchPreviewScaler : public QObject {
+  Q_OBJECT
+private slots:
+
+  void downscale_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("displayWidth");
+    QTest::addColumn<int>("displayHeight");
+    QTest::newRow("Mono8 20 MP → 1280x800 窗口")
+        << uint(PixelFormats::kMono8) << 5472 << 3648 << 1280 << 800;
+    QTest::newRow("BayerRG8 20 MP → 1280x800 窗口")
+        << uint(0x01080009) << 5472 << 3648 << 1280 << 800;
+    QTest::newRow("Mono8 5 MP → 1024x768 窗口")
+        << uint(PixelFormats::kMono8) << 2448 << 2048 << 1024 << 768;
+    QTest::newRow("BGR8 5 MP → 640x480 窗口")
+        << uint(PixelFormats::kBgr8) << 2448 << 2048 << 640 << 480;
+  }
+
+  void downscale() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, displayWidth);
+    QFETCH(int, displayHeight);
+
+    std::vector<uint8_t> raw(
+        PixelFormats::frameBytes(pixelType, width, height));
+    std::mt19937 rng(42);
+    for (uint8_t &b : raw)
+      b = uint8_t(rng());
+    const Plan p =
+        plan(pixelType, width, height, {}, displayWidth, displayHeight);
+    QVERIFY(!p.passthrough);
+    std::vector<uint8_t> dst(outputBytes(p));
+
+    double scalarMs = 0.0;
+    double bestMs = 0.0;
+    QBENCHMARK_ONCE {
+      for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+        if (!CpuFeatures::isSupported(isa))
+          continue;
+        const double ms = medianFrameMs([&] {
+          scale(raw.data(), raw.size(), pixelType, width, height, p,
+                dst.data(), isa);
+        });
+        if (isa == Isa::Scalar)
+          scalarMs = ms;
+        bestMs = ms;
+        qInfo() << width << "x" << height
+                << PixelFormats::find(pixelType)->name << "→" << p.outWidth
+                << "x" << p.outHeight << "(" << p.factor << "倍 )"
+                << CpuFeatures::name(isa) << ms << "ms/帧 | 相对标量"
+                << (ms > 0 ? scalarMs / ms : 0.0) << "x | 显示像素减少到"
+                << 100.0 * p.outWidth * p.outHeight / (double(width) * height)
+                << "%";
+      }
+    }
+    if (CpuFeatures::best() != Isa::Scalar)
+      QVERIFY(bestMs < scalarMs);
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchPreviewScaler)
+#include "bench_preview_scaler.moc"
@@ -0,0 +1,74 @@
+// 抓拍帧交接微基准：grab 线程每帧的开销
+//   copy_into_frame_buffer  —— 旧做法：加锁 + m_frameBuffer.assign 整帧拷贝
+//   publish_to_mailbox      —— 新做法：LatestFrameMailbox::publish 交换句柄
+// 运行：bench_snapshot_handoff -tickcounter（或默认 walltime）
+#include "utils/FrameRef.h"
+#include "utils/LatestFrameMailbox.h"
+
+#include <QtTest>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// 5 MP Mono8（2448 x 2048），和 60 fps 下 ~300 MB/s 的估算一致
+constexpr std::size_t kFrameBytes = 2448u * 2048u;
+constexpr int kFramesPerIteration = 60;
+constexpr int kBufferCount = 8;
+
+void noRecycle(FrameBuffer *, void *) {}
+
+struct FakeSdkFrames {
+  FakeSdkFrames() : pixels(kBufferCount), buffers(kBufferCount) {
+    for (int i = 0; i < kBufferCount; ++i) {
+      pixels[i].assign(kFrameBytes, static_cast<unsigned char>(i));
+      buffers[i].data = pixels[i].data();
+      buffers[i].capacity = kFrameBytes;
+      buffers[i].info.frameLen = kFrameBytes;
+      buffers[i].recycle = &noRecycle;
+    }
+  }
+  std::vector<std::vector<unsigned char>> pixels;
+  std::vector<FrameBuffer> buffers;
+};
+
+} // namespace
+
+class BenchSnapshotHandoff : public QObject {
+  Q_OBJECT
+private slots:
+
+  void copy_into_frame_buffer() {
+    FakeSdkFrames frames;
+    std::mutex frameMutex;
+    std::vector<unsigned char> frameBuffer;
+
+    QBENCHMARK {
+      for (int i = 0; i < kFramesPerIteration; ++i) {
+        const FrameBuffer &src = frames.buffers[i % kBufferCount];
+        std::lock_guard<std::mutex> lock(frameMutex);
+        frameBuffer.assign(src.data, src.data + src.info.frameLen);
+      }
+    }
+    QCOMPARE(frameBuffer.size(), kFrameBytes);
+  }
+
+  void publish_to_mailbox() {
+    FakeSdkFrames frames;
+    LatestFrameMailbox<FrameRef> mailbox;
+
+    QBENCHMARK {
+      for (int i = 0; i < kFramesPerIteration; ++i) {
+        FrameBuffer &src = frames.buffers[i % kBufferCount];
+        mailbox.publish(FrameRef::adopt(&src));
+      }
+    }
+
+    FrameRef latest;
+    QVERIFY(mailbox.acquire(latest));
+    QCOMPARE(latest.size(), kFrameBytes);
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchSnapshotHandoff)
+#include "bench_snapshot_handoff.moc"
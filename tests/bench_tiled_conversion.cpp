@@ -0,0 +1,93 @@
+// 按条带并行转换基准：5 MP / 20 MP Bayer → BGR8 / Mono8，线程数从 1 加到核数，
+// 输出每帧耗时、相对单线程的加速比和并行效率。单线程 SIMD 转一帧 20 MP
+// 可能超过帧间隔，这里看加核之后能否压回帧间隔以内、在几核处饱和（内存带宽）。
+// 运行：bench_tiled_conversion
+#include "utils/BayerDemosaic.h"
+#include "utils/TilePool.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kFramesPerRow = 20;
+constexpr int kMinTileRows = 64;
+// 核数很多的机器上只测到 16 线程，再往上早已受内存带宽限制
+constexpr int kMaxThreads = 16;
+
+} // namespace
+
+class BenchTiledConversion : public QObject {
+  Q_OBJECT
+private slots:
+
+  void scaling_data() {
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<bool>("mono");
+    QTest::newRow("2448x2048 (5 MP) → BGR8") << 2448 << 2048 << false;
+    QTest::newRow("5472x3648 (20 MP) → BGR8") << 5472 << 3648 << false;
+    QTest::newRow("5472x3648 (20 MP) → Mono8") << 5472 << 3648 << true;
+  }
+
+  void scaling() {
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(bool, mono);
+
+    std::vector<uint8_t> raw(std::size_t(width) * height);
+    std::mt19937 rng(42);
+    for (uint8_t &b : raw)
+      b = uint8_t(rng());
+    const int dstStride = mono ? width : width * 3;
+    std::vector<uint8_t> dst(std::size_t(dstStride) * height);
+    const auto tile = [&](int y0, int y1) {
+      if (mono)
+        BayerDemosaic::toMono8Rows(raw.data(), width, height, width,
+                                   BayerDemosaic::Pattern::RG, dst.data(),
+                                   dstStride, y0, y1);
+      else
+        BayerDemosaic::toBgr8Rows(raw.data(), width, height, width,
+                                  BayerDemosaic::Pattern::RG, dst.data(),
+                                  dstStride, y0, y1);
+    };
+
+    const int maxThreads = std::min(
+        kMaxThreads, std::max(1, int(std::thread::hardware_concurrency())));
+    double singleMs = 0.0;
+    double bestMs = 0.0;
+    QBENCHMARK_ONCE {
+      for (int threads = 1; threads <= maxThreads; ++threads) {
+        TilePool pool(threads - 1);
+        pool.run(height, kMinTileRows, tile); // 预热：线程起来、页写过
+        std::vector<double> ms;
+        for (int i = 0; i < kFramesPerRow; ++i) {
+          const auto t0 = std::chrono::steady_clock::now();
+          pool.run(height, kMinTileRows, tile);
+          ms.push_back(std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - t0)
+                           .count());
+        }
+        std::nth_element(ms.begin(), ms.begin() + ms.size() / 2, ms.end());
+        const double median = ms[ms.size() / 2];
+        if (threads == 1)
+          singleMs = median;
+        bestMs = threads == 1 ? median : std::min(bestMs, median);
+        qInfo() << width << "x" << height << (mono ? "Mono8" : "BGR8")
+                << CpuFeatures::name(CpuFeatures::best()) << threads
+                << "线程:" << median << "ms/帧 | 加速"
+                << singleMs / median << "x | 效率"
+                << singleMs / median / threads;
+      }
+    }
+    if (maxThreads > 1)
+      QVERIFY(bestMs < singleMs);
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchTiledConversion)
+#include "bench_tiled_conversion.moc"
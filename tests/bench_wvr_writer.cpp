@@ -0,0 +1,153 @@
+// .wvr 原始容器写入基准：5 MP Mono8 / Mono12Packed / 1080p BayerRG8，每行写
+// 约 kBytesPerRow 字节到临时目录。报告写盘 MB/s、等效帧率、单帧 writeFrame
+// 最大耗时，以及写入期间进程 CPU 时间占墙钟时间的比例（目标：跑满磁盘顺序
+// 带宽时 < 5%，即基本只剩 write 系统调用）。每种格式分普通写和直接 I/O
+// 两行，另报写盘线程的单次写盘最长耗时和缓冲排队峰值。
+// 结果受临时目录所在磁盘和页缓存影响：页缓存吸收写入时 MB/s 是内存带宽，
+// CPU 占比偏高；要看真实磁盘把 kBytesPerRow 调到超过空闲内存，或看直接
+// I/O 那一行（tmpfs 不支持直接 I/O，会退回普通写）。
+// 运行：bench_wvr_writer
+#include "utils/PixelFormats.h"
+#include "utils/WvrWriter.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr uint64_t kBytesPerRow = uint64_t(1536) << 20;
+
+double msSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+// 进程用户态 + 内核态 CPU 时间（毫秒），写盘的系统调用也算在内
+double processCpuMs() {
+#if defined(_WIN32)
+  FILETIME created, exited, kernel, user;
+  if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+    return 0.0;
+  auto ms = [](const FILETIME &t) {
+    ULARGE_INTEGER v;
+    v.LowPart = t.dwLowDateTime;
+    v.HighPart = t.dwHighDateTime;
+    return v.QuadPart / 1e4; // 100 ns 为单位
+  };
+  return ms(kernel) + ms(user);
+#else
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0.0;
+  auto ms = [](const timeval &t) { return t.tv_sec * 1e3 + t.tv_usec / 1e3; };
+  return ms(usage.ru_utime) + ms(usage.ru_stime);
+#endif
+}
+
+} // namespace
+
+class BenchWvrWriter : public QObject {
+  Q_OBJECT
+private slots:
+
+  void write_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<bool>("directIo");
+    for (bool directIo : {false, true}) {
+      const char *io = directIo ? " 直接 I/O" : "";
+      QTest::addRow("Mono8 5 MP 2448x2048%s", io)
+          << uint(PixelFormats::kMono8) << 2448 << 2048 << directIo;
+      QTest::addRow("Mono12Packed 5 MP 2448x2048%s", io)
+          << uint(PixelFormats::kMono12Packed) << 2448 << 2048 << directIo;
+      QTest::addRow("BayerRG8 1920x1080%s", io)
+          << uint(0x01080009) << 1920 << 1080 << directIo;
+    }
+  }
+
+  void write() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(bool, directIo);
+
+    const std::size_t frameBytes =
+        WvrWriter::inputFrameBytes(pixelType, width, height);
+    QVERIFY(frameBytes > 0);
+    // 几帧轮流写，避免同一块内存一直在缓存里
+    std::vector<std::vector<uint8_t>> frames(
+        4, std::vector<uint8_t>(frameBytes));
+    std::mt19937 rng(7);
+    for (std::vector<uint8_t> &f : frames)
+      for (uint8_t &b : f)
+        b = uint8_t(rng());
+    const int count = static_cast<int>(kBytesPerRow / frameBytes);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    WvrWriter::Options o;
+    o.width = width;
+    o.height = height;
+    o.pixelType = pixelType;
+    o.fps = 60.0;
+    o.file.directIo = directIo;
+
+    double totalMs = 0.0;
+    double cpuMs = 0.0;
+    double maxFrameMs = 0.0;
+    double closeMs = 0.0;
+    WvrWriter::Stats stats;
+    RecordFile::Stats disk;
+    QBENCHMARK_ONCE {
+      WvrWriter writer;
+      QVERIFY(writer.open(dir.filePath("bench.wvr").toStdString(), o));
+      IRecordWriter::FrameMeta meta;
+      const double cpu0 = processCpuMs();
+      const auto t0 = std::chrono::steady_clock::now();
+      for (int i = 0; i < count; ++i) {
+        const auto tf = std::chrono::steady_clock::now();
+        const std::vector<uint8_t> &f = frames[i % frames.size()];
+        meta.frameNum = uint64_t(i);
+        QVERIFY2(writer.writeFrame(f.data(), f.size(), meta),
+                 writer.error().c_str());
+        maxFrameMs = std::max(maxFrameMs, msSince(tf));
+      }
+      const auto tc = std::chrono::steady_clock::now();
+      QVERIFY2(writer.close(), writer.error().c_str());
+      closeMs = msSince(tc);
+      totalMs = msSince(t0);
+      cpuMs = processCpuMs() - cpu0;
+      stats = writer.stats();
+      disk = writer.fileStats();
+    }
+    QCOMPARE(stats.frames, uint64_t(count));
+
+    const double mbps = stats.fileBytes / 1e6 / (totalMs / 1e3);
+    qInfo() << width << "x" << height << PixelFormats::find(pixelType)->name
+            << count << "帧" << stats.fileBytes / 1e6 << "MB |" << mbps
+            << "MB/s ≈" << count / (totalMs / 1e3) << "fps | CPU"
+            << 100.0 * cpuMs / totalMs << "% | 单帧最大" << maxFrameMs
+            << "ms | close" << closeMs << "ms |" << stats.checkpoints
+            << "个检查点";
+    qInfo() << "  写盘线程:" << (disk.directIo ? "直接 I/O" : "普通写")
+            << "| 磁盘忙时" << disk.diskMbPerSec() << "MB/s | 单次最长"
+            << disk.maxWriteUs / 1e3 << "ms | 排队峰值"
+            << disk.highWaterBytes / 1e6 << "/" << disk.queueCapacityBytes / 1e6
+            << "MB | 缓冲用尽等待" << disk.producerWaits << "次";
+  }
+};
+
+QTEST_GUILESS_MAIN(BenchWvrWriter)
+#include "bench_wvr_writer.moc"
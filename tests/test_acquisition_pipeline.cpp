@@ -0,0 +1,311 @@
+// AcquisitionPipeline 单元测试：用模拟帧源在 Linux 上以 200+ fps 验证
+// 多阶段分发、各阶段丢帧策略和队列深度计数
+#include "services/AcquisitionPipeline.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * 模拟帧源：预分配若干 FrameBuffer，回收时放回空闲队列，
+ * 按固定间隔产生带递增帧号的帧（和 grab 线程一样单生产者）。
+ */
+class SimulatedFrameSource {
+public:
+  SimulatedFrameSource(int bufferCount, std::size_t frameBytes)
+      : m_buffers(bufferCount), m_pixels(bufferCount * frameBytes),
+        m_free(bufferCount) {
+    for (int i = 0; i < bufferCount; ++i) {
+      FrameBuffer &b = m_buffers[i];
+      b.data = m_pixels.data() + i * frameBytes;
+      b.capacity = frameBytes;
+      b.recycle = &SimulatedFrameSource::recycle;
+      b.recycleContext = this;
+      m_free.tryPush(&b);
+    }
+  }
+
+  // 取一个空闲缓冲；池耗尽时返回空引用（计入 exhausted）
+  FrameRef next() {
+    FrameBuffer *b = nullptr;
+    if (!m_free.tryPop(b)) {
+      ++exhausted;
+      ++frameNum;
+      return FrameRef();
+    }
+    b->info.frameNum = frameNum++;
+    b->info.frameLen = b->capacity;
+    b->data[0] = static_cast<unsigned char>(b->info.frameNum);
+    return FrameRef::adopt(b);
+  }
+
+  std::size_t freeCount() const { return m_free.size(); }
+
+  uint32_t frameNum = 0;
+  int exhausted = 0;
+
+private:
+  static void recycle(FrameBuffer *b, void *ctx) {
+    static_cast<SimulatedFrameSource *>(ctx)->m_free.tryPush(b);
+  }
+
+  std::vector<FrameBuffer> m_buffers;
+  std::vector<unsigned char> m_pixels;
+  MpmcRing<FrameBuffer *> m_free;
+};
+
+// 以 fps 速率推送 count 帧，返回单次 submit 的最大耗时（微秒）
+long long pump(AcquisitionPipeline &pipeline, SimulatedFrameSource &source,
+               int count, double fps) {
+  using clock = std::chrono::steady_clock;
+  const auto interval = std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>(1.0 / fps));
+  auto due = clock::now();
+  long long worstUs = 0;
+  for (int i = 0; i < count; ++i) {
+    std::this_thread::sleep_until(due);
+    due += interval;
+    FrameRef frame = source.next();
+    const auto t0 = clock::now();
+    pipeline.submit(frame);
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        clock::now() - t0)
+                        .count();
+    worstUs = std::max<long long>(worstUs, us);
+  }
+  return worstUs;
+}
+
+} // namespace
+
+class TestAcquisitionPipeline : public QObject {
+  Q_OBJECT
+private slots:
+
+  void all_stages_receive_every_frame_at_250fps() {
+    SimulatedFrameSource source(64, 4096);
+    AcquisitionPipeline pipeline;
+    std::vector<uint32_t> recorded;
+    std::atomic<int> displayed{0};
+    const int display = pipeline.addStage(
+        "display", 4, AcquisitionPipeline::DropPolicy::KeepLatest,
+        [&](const FrameRef &) { displayed.fetch_add(1); });
+    const int record = pipeline.addStage(
+        "record", 32, AcquisitionPipeline::DropPolicy::DropNewest,
+        [&](const FrameRef &f) { recorded.push_back(f.info().frameNum); },
+        true);
+    pipeline.start();
+    pump(pipeline, source, 250, 250.0);
+    QVERIFY(pipeline.waitStageIdle(record, std::chrono::seconds(2)));
+    QVERIFY(pipeline.waitStageIdle(display, std::chrono::seconds(2)));
+    pipeline.stop();
+
+    const auto rec = pipeline.stageStats(record);
+    QCOMPARE(rec.processed, uint64_t(250));
+    QCOMPARE(rec.dropped, uint64_t(0));
+    QCOMPARE(static_cast<int>(recorded.size()), 250);
+    for (int i = 0; i < 250; ++i)
+      QCOMPARE(recorded[i], static_cast<uint32_t>(i));
+
+    const auto disp = pipeline.stageStats(display);
+    QCOMPARE(disp.processed + disp.dropped, uint64_t(250));
+    QVERIFY(displayed.load() > 0);
+    QCOMPARE(source.exhausted, 0);
+  }
+
+  void slow_record_stage_drops_without_stalling_producer() {
+    SimulatedFrameSource source(32, 4096);
+    AcquisitionPipeline pipeline;
+    std::vector<uint32_t> recorded;
+    // 模拟编码器/磁盘抖动：每帧 20ms，远慢于 4ms 的帧间隔
+    const int record = pipeline.addStage(
+        "record", 8, AcquisitionPipeline::DropPolicy::DropNewest,
+        [&](const FrameRef &f) {
+          recorded.push_back(f.info().frameNum);
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        },
+        true);
+    std::atomic<int> displayed{0};
+    const int display = pipeline.addStage(
+        "display", 2, AcquisitionPipeline::DropPolicy::KeepLatest,
+        [&](const FrameRef &) { displayed.fetch_add(1); });
+    pipeline.start();
+    const long long worstSubmitUs = pump(pipeline, source, 250, 250.0);
+    pipeline.stop(); // record 阶段 drain
+
+    const auto rec = pipeline.stageStats(record);
+    QVERIFY(rec.dropped > 0);
+    QCOMPARE(rec.processed + rec.dropped, uint64_t(250));
+    QVERIFY(rec.highWater <= rec.capacity);
+    QCOMPARE(rec.highWater, rec.capacity);
+    // 录制阶段即使丢帧也必须保持顺序
+    for (std::size_t i = 1; i < recorded.size(); ++i)
+      QVERIFY(recorded[i] > recorded[i - 1]);
+    // grab 线程不被慢消费者反压
+    QVERIFY2(worstSubmitUs < 2000, "submit blocked on a slow stage");
+    // 显示阶段不受录制阶段影响
+    const auto disp = pipeline.stageStats(display);
+    QVERIFY(disp.processed > 200);
+    // stop 之后所有缓冲都已归还
+    QCOMPARE(source.freeCount(), std::size_t(32));
+  }
+
+  void keep_latest_stage_ends_on_newest_frame() {
+    SimulatedFrameSource source(16, 64);
+    AcquisitionPipeline pipeline;
+    std::mutex mutex;
+    uint32_t last = 0;
+    const int snap = pipeline.addStage(
+        "snapshot", 4, AcquisitionPipeline::DropPolicy::KeepLatest,
+        [&](const FrameRef &f) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(3));
+          std::lock_guard<std::mutex> lock(mutex);
+          last = f.info().frameNum;
+        });
+    pipeline.start();
+    for (int i = 0; i < 100; ++i) {
+      pipeline.submit(source.next());
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    QVERIFY(pipeline.waitStageIdle(snap, std::chrono::seconds(2)));
+    pipeline.stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto st = pipeline.stageStats(snap);
+    QVERIFY(st.dropped > 0);
+    QCOMPARE(st.processed + st.dropped, uint64_t(100));
+    QCOMPARE(last, uint32_t(99)); // 消费者每轮都跳到最新，最后处理的就是最后一帧
+  }
+
+  void disabled_stage_receives_nothing() {
+    SimulatedFrameSource source(8, 64);
+    AcquisitionPipeline pipeline;
+    std::atomic<int> count{0};
+    const int record = pipeline.addStage(
+        "record", 8, AcquisitionPipeline::DropPolicy::DropNewest,
+        [&](const FrameRef &) { count.fetch_add(1); }, true);
+    pipeline.setStageEnabled(record, false);
+    pipeline.start();
+    for (int i = 0; i < 10; ++i)
+      QCOMPARE(pipeline.submit(source.next()), 0);
+    pipeline.setStageEnabled(record, true);
+    QCOMPARE(pipeline.submit(source.next()), 1);
+    QVERIFY(pipeline.waitStageIdle(record, std::chrono::seconds(1)));
+    pipeline.stop();
+    QCOMPARE(count.load(), 1);
+    QCOMPARE(pipeline.stageStats(record).dropped, uint64_t(0));
+  }
+
+  void stage_limit_caps_queue_and_stall_is_measured() {
+    SimulatedFrameSource source(32, 64);
+    AcquisitionPipeline pipeline;
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    // 第一帧卡住消费者，模拟一次磁盘停顿
+    const int record = pipeline.addStage(
+        "record", 32, AcquisitionPipeline::DropPolicy::DropNewest,
+        [&](const FrameRef &) {
+          if (!started.exchange(true)) {
+            while (!release.load())
+              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+        },
+        true);
+    pipeline.setStageLimit(record, 4);
+    QCOMPARE(pipeline.stageStats(record).limit, std::size_t(4));
+    pipeline.start();
+
+    pipeline.submit(source.next());
+    while (!started.load())
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    for (int i = 0; i < 10; ++i)
+      pipeline.submit(source.next());
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    release = true;
+    QVERIFY(pipeline.waitStageIdle(record, std::chrono::seconds(1)));
+
+    AcquisitionPipeline::StageStats st = pipeline.stageStats(record);
+    QCOMPARE(st.processed, uint64_t(5));
+    QCOMPARE(st.dropped, uint64_t(6));
+    QCOMPARE(st.highWater, std::size_t(4));
+    QVERIFY(st.serviceMaxUs >= 30000);
+    QVERIFY(st.serviceP50Us < 30000);
+    // 峰值按窗口取：取过一次就清零
+    QVERIFY(pipeline.takeServicePeakUs(record) >= 30000);
+    QCOMPARE(pipeline.takeServicePeakUs(record), uint64_t(0));
+
+    // 运行中放宽上限；超过容量按容量算
+    pipeline.setStageLimit(record, 1000);
+    QCOMPARE(pipeline.stageStats(record).limit, st.capacity);
+    for (int i = 0; i < 10; ++i)
+      QCOMPARE(pipeline.submit(source.next()), 1);
+    pipeline.stop();
+    QCOMPARE(pipeline.stageStats(record).processed, uint64_t(15));
+  }
+
+  void reset_counters_keeps_idle_tracking_consistent() {
+    SimulatedFrameSource source(8, 64);
+    AcquisitionPipeline pipeline;
+    const int record = pipeline.addStage(
+        "record", 8, AcquisitionPipeline::DropPolicy::DropNewest,
+        [](const FrameRef &) {}, true);
+    pipeline.start();
+    for (int i = 0; i < 5; ++i)
+      pipeline.submit(source.next());
+    QVERIFY(pipeline.waitStageIdle(record, std::chrono::seconds(1)));
+    pipeline.resetCounters();
+    QCOMPARE(pipeline.stageStats(record).processed, uint64_t(0));
+    pipeline.submit(source.next());
+    QVERIFY(pipeline.waitStageIdle(record, std::chrono::seconds(1)));
+    QCOMPARE(pipeline.stageStats(record).processed, uint64_t(1));
+    pipeline.stop();
+  }
+
+  void thread_init_runs_on_each_stage_thread_before_first_frame() {
+    SimulatedFrameSource source(8, 64);
+    AcquisitionPipeline pipeline;
+    std::mutex mutex;
+    std::vector<std::pair<int, std::string>> inits;
+    std::vector<std::thread::id> initThreads(2);
+    std::vector<std::thread::id> consumerThreads(2);
+    for (int i = 0; i < 2; ++i) {
+      pipeline.addStage(
+          i == 0 ? "display" : "record", 8,
+          AcquisitionPipeline::DropPolicy::DropNewest,
+          [&, i](const FrameRef &) {
+            std::lock_guard<std::mutex> lock(mutex);
+            consumerThreads[i] = std::this_thread::get_id();
+          },
+          true);
+    }
+    pipeline.setThreadInit([&](int stage, const std::string &name) {
+      std::lock_guard<std::mutex> lock(mutex);
+      inits.emplace_back(stage, name);
+      initThreads[stage] = std::this_thread::get_id();
+      // 第一帧之前调用：此时还没有消费过任何帧
+      QVERIFY(consumerThreads[stage] == std::thread::id());
+    });
+    pipeline.start();
+    pipeline.submit(source.next());
+    QVERIFY(pipeline.waitStageIdle(0, std::chrono::seconds(1)));
+    QVERIFY(pipeline.waitStageIdle(1, std::chrono::seconds(1)));
+    pipeline.stop();
+
+    QCOMPARE(inits.size(), std::size_t(2));
+    std::sort(inits.begin(), inits.end());
+    QCOMPARE(inits[0].first, 0);
+    QVERIFY(inits[0].second == "display");
+    QCOMPARE(inits[1].first, 1);
+    QVERIFY(inits[1].second == "record");
+    QVERIFY(initThreads[0] == consumerThreads[0]);
+    QVERIFY(initThreads[1] == consumerThreads[1]);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestAcquisitionPipeline)
+#include "test_acquisition_pipeline.moc"
@@ -0,0 +1,115 @@
+// AcquisitionStatsBlock / FrameRateSampler 单元测试：
+// 快照一致性（并发写读）、帧率取自采集时间戳、停顿归零、新一轮采集重置
+#include "utils/AcquisitionStats.h"
+
+#include <QtTest>
+#include <atomic>
+#include <thread>
+
+namespace {
+
+constexpr int64_t kMs = 1'000'000;
+
+} // namespace
+
+class TestAcquisitionStats : public QObject {
+  Q_OBJECT
+private slots:
+
+  void snapshot_reflects_last_frame() {
+    AcquisitionStatsBlock block;
+    QCOMPARE(block.snapshot().frames, uint64_t(0));
+    block.recordFrame(10 * kMs, 7);
+    block.recordFrame(20 * kMs, 8);
+    const AcquisitionStatsBlock::Snapshot s = block.snapshot();
+    QCOMPARE(s.frames, uint64_t(2));
+    QCOMPARE(s.lastGrabNs, 20 * kMs);
+    QCOMPARE(s.lastFrameNum, 8u);
+
+    block.reset();
+    QCOMPARE(block.snapshot().frames, uint64_t(0));
+    QCOMPARE(block.snapshot().lastGrabNs, int64_t(0));
+  }
+
+  void concurrent_snapshots_are_consistent() {
+    AcquisitionStatsBlock block;
+    std::atomic<bool> stop{false};
+    // 第 n 帧的时间戳固定为 n µs：快照里两个字段必须对得上
+    std::thread writer([&] {
+      for (uint64_t n = 1; !stop.load(std::memory_order_relaxed); ++n)
+        block.recordFrame(static_cast<int64_t>(n) * 1000,
+                          static_cast<uint32_t>(n));
+    });
+    bool consistent = true;
+    uint64_t lastFrames = 0;
+    for (int i = 0; i < 200000 && consistent; ++i) {
+      const AcquisitionStatsBlock::Snapshot s = block.snapshot();
+      consistent = s.lastGrabNs == static_cast<int64_t>(s.frames) * 1000 &&
+                   s.lastFrameNum == static_cast<uint32_t>(s.frames) &&
+                   s.frames >= lastFrames;
+      lastFrames = s.frames;
+    }
+    stop = true;
+    writer.join();
+    QVERIFY(consistent);
+  }
+
+  void fps_uses_grab_timestamps() {
+    AcquisitionStatsBlock block;
+    FrameRateSampler sampler;
+    // 相机稳定 200 fps，UI 采样时刻不规律（事件循环偶尔卡 250 ms）
+    int64_t grabNs = 0;
+    int64_t nowNs = 0;
+    const int64_t sampleGaps[] = {100, 100, 250, 60, 100, 140, 100, 100};
+    for (int64_t gapMs : sampleGaps) {
+      const int64_t until = nowNs + gapMs * kMs;
+      while (grabNs + 5 * kMs <= until) {
+        grabNs += 5 * kMs;
+        block.recordFrame(grabNs, 0);
+      }
+      nowNs = until;
+      sampler.update(block.snapshot(), nowNs);
+    }
+    QVERIFY(std::abs(sampler.fps() - 200.0) < 1e-6);
+  }
+
+  void fps_is_zero_before_two_frames_and_after_stall() {
+    AcquisitionStatsBlock block;
+    FrameRateSampler sampler;
+    QCOMPARE(sampler.update(block.snapshot(), 0), 0.0);
+    block.recordFrame(kMs, 0);
+    QCOMPARE(sampler.update(block.snapshot(), 100 * kMs), 0.0);
+    block.recordFrame(101 * kMs, 1);
+    QVERIFY(std::abs(sampler.update(block.snapshot(), 200 * kMs) - 10.0) <
+            1e-9);
+
+    // 没有新帧：2 秒内保持读数，之后归零
+    QVERIFY(sampler.update(block.snapshot(), 1500 * kMs) > 0.0);
+    QCOMPARE(sampler.update(block.snapshot(), 2300 * kMs), 0.0);
+  }
+
+  void new_session_restarts_window() {
+    AcquisitionStatsBlock block;
+    FrameRateSampler sampler;
+    int64_t grabNs = 0;
+    for (int i = 0; i < 50; ++i) {
+      grabNs += 10 * kMs;
+      block.recordFrame(grabNs, 0);
+    }
+    sampler.update(block.snapshot(), grabNs);
+
+    // 新一轮采集：计数清零后以 25 fps 重新开始，旧窗口不能混进来
+    block.reset();
+    int64_t nowNs = grabNs;
+    for (int i = 0; i < 10; ++i) {
+      grabNs += 40 * kMs;
+      block.recordFrame(grabNs, 0);
+      nowNs = grabNs;
+      sampler.update(block.snapshot(), nowNs);
+    }
+    QVERIFY(std::abs(sampler.fps() - 25.0) < 1e-6);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestAcquisitionStats)
+#include "test_acquisition_stats.moc"
@@ -0,0 +1,319 @@
+// AviWriter 单元测试：写出的文件经 ReplayCameraBackend 读回逐像素比对；
+// 直接解析 RIFF 校验 OpenDML 结构（AVIX 分块、indx / ix00 / idx1 指向正确的帧、
+// 各级大小与帧数回填）；FourCC 格式的帧块和各级索引用 00dc；同步 close 后
+// 文件即完整；出错路径
+#include "services/ReplayCameraBackend.h"
+#include "utils/AviWriter.h"
+#include "utils/PixelFormats.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <vector>
+
+namespace {
+
+using Backend = ReplayCameraBackend;
+using GrabResult = ICameraBackend::GrabResult;
+
+// 第 index 帧：每个字节都和帧号 / 位置相关，行翻转或错位都能看出来
+std::vector<uint8_t> makeFrame(std::size_t bytes, int index) {
+  std::vector<uint8_t> f(bytes);
+  for (std::size_t i = 0; i < bytes; ++i)
+    f[i] = static_cast<uint8_t>(index * 37 + i * 7 + (i >> 8));
+  return f;
+}
+
+bool writeFrames(const QString &path, const AviWriter::Options &options,
+                 int frames, AviWriter::Stats *stats = nullptr) {
+  AviWriter writer;
+  if (!writer.open(path.toStdString(), options))
+    return false;
+  const std::size_t bytes = AviWriter::inputFrameBytes(
+      options.pixelType, options.width, options.height);
+  for (int i = 0; i < frames; ++i) {
+    const std::vector<uint8_t> f = makeFrame(bytes, i);
+    if (!writer.writeFrame(f.data(), f.size()))
+      return false;
+  }
+  const bool closed = writer.close();
+  if (stats)
+    *stats = writer.stats();
+  return closed;
+}
+
+uint32_t get32(const QByteArray &b, qint64 pos) {
+  uint32_t v = 0;
+  for (int i = 3; i >= 0; --i)
+    v = (v << 8) | static_cast<uint8_t>(b[static_cast<qsizetype>(pos + i)]);
+  return v;
+}
+
+uint64_t get64(const QByteArray &b, qint64 pos) {
+  return uint64_t(get32(b, pos)) | uint64_t(get32(b, pos + 4)) << 32;
+}
+
+bool idAt(const QByteArray &b, qint64 pos, const char *id) {
+  return b.mid(static_cast<qsizetype>(pos), 4) == QByteArray(id, 4);
+}
+
+// 在 [begin, end) 里按 RIFF 块顺序找第一个 id 块，返回块头位置，找不到返回 -1；
+// LIST 会递归进入
+qint64 findChunk(const QByteArray &b, qint64 begin, qint64 end,
+                 const char *id) {
+  qint64 pos = begin;
+  while (pos + 8 <= end) {
+    const uint32_t size = get32(b, pos + 4);
+    if (idAt(b, pos, id))
+      return pos;
+    if (idAt(b, pos, "LIST")) {
+      const qint64 inner = findChunk(b, pos + 12, pos + 8 + size, id);
+      if (inner >= 0)
+        return inner;
+    }
+    pos += 8 + size + (size & 1);
+  }
+  return -1;
+}
+
+Backend::Options unpaced(const QString &path) {
+  Backend::Options options;
+  options.path = path;
+  options.fps = 0.0;
+  return options;
+}
+
+} // namespace
+
+class TestAviWriter : public QObject {
+  Q_OBJECT
+private slots:
+
+  void round_trips_through_replay_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<uint>("replayType");
+    // 18 / 10 像素宽：BI_RGB 行要补齐到 4 字节
+    QTest::newRow("Mono8 行补齐") << uint(PixelFormats::kMono8) << 18
+                                   << uint(Backend::kPixelMono8);
+    QTest::newRow("BGR8 行补齐") << uint(PixelFormats::kBgr8) << 10
+                                  << uint(Backend::kPixelBGR8);
+    QTest::newRow("RGB8 写成 BGR") << uint(PixelFormats::kRgb8) << 8
+                                    << uint(Backend::kPixelBGR8);
+  }
+
+  void round_trips_through_replay() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(uint, replayType);
+    QTemporaryDir dir;
+    const QString path = dir.filePath("rt.avi");
+    AviWriter::Options o;
+    o.width = width;
+    o.height = 6;
+    o.pixelType = pixelType;
+    o.fps = 25.0;
+    QVERIFY(writeFrames(path, o, 5));
+
+    Backend backend(unpaced(path));
+    ICameraBackend::IntValue payload;
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+    QCOMPARE(backend.frameCount(), 5);
+    ICameraBackend::FloatValue fps;
+    QCOMPARE(backend.getFloat("AcquisitionFrameRate", fps),
+             ICameraBackend::kOk);
+    QCOMPARE(fps.current, 25.0f);
+    QCOMPARE(backend.getInt("PayloadSize", payload), ICameraBackend::kOk);
+    FramePool pool;
+    QVERIFY(pool.configure(2, static_cast<std::size_t>(payload.current)));
+    QCOMPARE(backend.startGrabbing(), ICameraBackend::kOk);
+
+    const std::size_t bytes = AviWriter::inputFrameBytes(pixelType, width, 6);
+    for (int i = 0; i < 5; ++i) {
+      FrameRef frame;
+      QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+      QCOMPARE(frame.info().width, uint32_t(width));
+      QCOMPARE(frame.info().height, 6u);
+      QCOMPARE(frame.info().pixelType, uint32_t(replayType));
+      QCOMPARE(frame.info().frameLen, bytes);
+      std::vector<uint8_t> expected = makeFrame(bytes, i);
+      if (pixelType == PixelFormats::kRgb8)
+        for (std::size_t p = 0; p < bytes; p += 3)
+          std::swap(expected[p], expected[p + 2]);
+      QVERIFY(std::equal(expected.begin(), expected.end(), frame.data()));
+    }
+  }
+
+  void opendml_rolls_over_into_avix() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("odml.avi");
+    AviWriter::Options o;
+    o.width = 32;
+    o.height = 16; // 512 字节一帧
+    o.pixelType = PixelFormats::kMono8;
+    o.fps = 100.0;
+    o.riffLimitBytes = 8192;
+    o.framesPerIndex = 3;
+    o.superIndexEntries = 64;
+    o.file.bufferBytes = 1000; // 取下限 64 KB
+    const int frames = 60;
+    AviWriter::Stats stats;
+    QVERIFY(writeFrames(path, o, frames, &stats));
+    QCOMPARE(stats.frames, uint64_t(frames));
+    QVERIFY(stats.riffChunks >= 4);
+
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    const QByteArray b = f.readAll();
+    QCOMPARE(uint64_t(b.size()), stats.fileBytes);
+
+    // RIFF 块首尾相接、正好铺满整个文件，每块都不超过上限
+    qint64 pos = 0;
+    std::vector<qint64> riffs;
+    while (pos < b.size()) {
+      QVERIFY(idAt(b, pos, "RIFF"));
+      QVERIFY(idAt(b, pos + 8, riffs.empty() ? "AVI " : "AVIX"));
+      const uint32_t size = get32(b, pos + 4);
+      QVERIFY(size + 8 <= o.riffLimitBytes);
+      riffs.push_back(pos);
+      pos += 8 + size;
+    }
+    QCOMPARE(pos, qint64(b.size()));
+    QCOMPARE(uint32_t(riffs.size()), stats.riffChunks);
+
+    // avih 只数第一个 RIFF 块；strh / dmlh 是总帧数
+    const qint64 firstEnd = 8 + get32(b, 4);
+    const qint64 avih = findChunk(b, 12, firstEnd, "avih");
+    const qint64 strh = findChunk(b, 12, firstEnd, "strh");
+    const qint64 dmlh = findChunk(b, 12, firstEnd, "dmlh");
+    const qint64 indx = findChunk(b, 12, firstEnd, "indx");
+    const qint64 idx1 = findChunk(b, 12, firstEnd, "idx1");
+    QVERIFY(avih > 0 && strh > 0 && dmlh > 0 && indx > 0 && idx1 > 0);
+    QCOMPARE(get32(b, avih + 8), 10000u); // 100 fps
+    QCOMPARE(get32(b, strh + 8 + 32), uint32_t(frames));
+    QCOMPARE(get32(b, dmlh + 8), uint32_t(frames));
+
+    // 超级索引 → 每个 ix00 → 每帧：帧号按顺序、块头是 00db、数据与写入一致
+    const uint32_t superEntries = get32(b, indx + 8 + 4);
+    QCOMPARE(superEntries, stats.indexChunks);
+    QVERIFY(superEntries > stats.riffChunks); // 块中途也写过 ix00
+    int frame = 0;
+    for (uint32_t e = 0; e < superEntries; ++e) {
+      const qint64 entry = indx + 8 + 24 + 16 * e;
+      const qint64 ix = static_cast<qint64>(get64(b, entry));
+      QVERIFY(idAt(b, ix, "ix00"));
+      QCOMPARE(get32(b, entry + 8), get32(b, ix + 4) + 8);
+      const uint32_t n = get32(b, ix + 8 + 4);
+      QCOMPARE(get32(b, entry + 12), n);
+      const uint64_t base = get64(b, ix + 8 + 12);
+      for (uint32_t k = 0; k < n; ++k, ++frame) {
+        const qint64 data =
+            static_cast<qint64>(base + get32(b, ix + 8 + 24 + 8 * k));
+        QCOMPARE(get32(b, ix + 8 + 24 + 8 * k + 4), 512u);
+        QVERIFY(idAt(b, data - 8, "00db"));
+        // 自底向上存：文件里第一行是输入的最后一行
+        const std::vector<uint8_t> in = makeFrame(512, frame);
+        QCOMPARE(static_cast<uint8_t>(b[static_cast<qsizetype>(data)]),
+                 in[15 * 32]);
+      }
+    }
+    QCOMPARE(frame, frames);
+
+    // idx1 覆盖第一个 RIFF 块，偏移相对 'movi' 四字符码
+    qint64 movi = 12;
+    while (movi < firstEnd &&
+           !(idAt(b, movi, "LIST") && idAt(b, movi + 8, "movi")))
+      movi += 8 + get32(b, movi + 4);
+    QVERIFY(movi < firstEnd);
+    movi += 8;
+    const uint32_t idx1Entries = get32(b, idx1 + 4) / 16;
+    QCOMPARE(idx1Entries, get32(b, avih + 8 + 16));
+    for (uint32_t k = 0; k < idx1Entries; ++k) {
+      const qint64 e = idx1 + 8 + 16 * k;
+      QVERIFY(idAt(b, e, "00db"));
+      QVERIFY(idAt(b, movi + get32(b, e + 8), "00db"));
+    }
+
+    // 回放端按 movi 扫描也能读到全部帧
+    Backend backend(unpaced(path));
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+    QCOMPARE(backend.frameCount(), frames);
+  }
+
+  void fourcc_streams_use_compressed_chunk_id() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("yuv.avi");
+    AviWriter::Options o;
+    o.width = 16;
+    o.height = 4;
+    o.pixelType = 0x0210001F; // YUV422（UYVY）
+    o.fps = 25.0;
+    QVERIFY(writeFrames(path, o, 3));
+
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    const QByteArray b = f.readAll();
+    const qint64 end = 8 + get32(b, 4);
+    const qint64 indx = findChunk(b, 12, end, "indx");
+    const qint64 ix = findChunk(b, 12, end, "ix00");
+    const qint64 idx1 = findChunk(b, 12, end, "idx1");
+    QVERIFY(indx > 0 && ix > 0 && idx1 > 0);
+    // 超级索引、标准索引的 dwChunkId 和 idx1 条目都跟帧块一致
+    QVERIFY(idAt(b, indx + 8 + 8, "00dc"));
+    QVERIFY(idAt(b, ix + 8 + 8, "00dc"));
+    QVERIFY(idAt(b, idx1 + 8, "00dc"));
+    QVERIFY(findChunk(b, 12, end, "00dc") > 0);
+    QCOMPARE(findChunk(b, 12, end, "00db"), qint64(-1));
+  }
+
+  void close_is_synchronous() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("sync.avi");
+    AviWriter writer;
+    AviWriter::Options o;
+    o.width = 64;
+    o.height = 48;
+    o.pixelType = PixelFormats::kBgr8;
+    QVERIFY(writer.open(path.toStdString(), o));
+    const std::vector<uint8_t> f = makeFrame(64 * 48 * 3, 0);
+    for (int i = 0; i < 3; ++i)
+      QVERIFY(writer.writeFrame(f.data(), f.size()));
+    QVERIFY(writer.close());
+    QVERIFY(!writer.isOpen());
+    const AviWriter::Stats stats = writer.stats();
+    // close 返回即完整：不需要轮询文件大小
+    QCOMPARE(uint64_t(QFileInfo(path).size()), stats.fileBytes);
+    QVERIFY(writer.close());
+  }
+
+  void rejects_bad_input() {
+    QTemporaryDir dir;
+    AviWriter writer;
+    AviWriter::Options o;
+    o.width = 16;
+    o.height = 4;
+    o.pixelType = 0x01080009; // BayerRG8：要先转换
+    QVERIFY(!writer.open(dir.filePath("a.avi").toStdString(), o));
+    QVERIFY(!writer.error().empty());
+    QVERIFY(!AviWriter::supports(PixelFormats::kMono12));
+    QCOMPARE(AviWriter::inputFrameBytes(0x0210001F, 15, 4), std::size_t(0));
+
+    o.pixelType = PixelFormats::kMono8;
+    QVERIFY(!writer.open(dir.filePath("missing/a.avi").toStdString(), o));
+    QVERIFY(!writer.error().empty());
+
+    // 尺寸不符只丢这一帧
+    QVERIFY(writer.open(dir.filePath("b.avi").toStdString(), o));
+    const std::vector<uint8_t> small(10);
+    QVERIFY(!writer.writeFrame(small.data(), small.size()));
+    QVERIFY(!writer.error().empty());
+    const std::vector<uint8_t> good(16 * 4);
+    QVERIFY(writer.writeFrame(good.data(), good.size()));
+    QVERIFY(writer.close());
+    QCOMPARE(writer.stats().frames, uint64_t(1));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestAviWriter)
+#include "test_avi_writer.moc"
@@ -0,0 +1,199 @@
+// BayerDemosaic 单元测试：手算的双线性插值结果、纯色场还原、四种排列、
+// 镜像边界、绿通道等于 BGR8 的 G，以及 SSE2 / AVX2 与标量逐字节一致
+//（含奇数宽高、行尾余数、行跨距）
+#include "utils/BayerDemosaic.h"
+
+#include <QtTest>
+#include <random>
+#include <vector>
+
+using namespace BayerDemosaic;
+
+namespace {
+
+// 按排列把一幅 RGB 纯色场采样成 Bayer 马赛克
+std::vector<uint8_t> mosaic(int width, int height, Pattern pattern, int r,
+                            int g, int b) {
+  // 2x2 单元按行展开
+  const char *const cells[] = {"RGGB", "GRBG", "GBRG", "BGGR"};
+  const char *cell = cells[int(pattern)];
+  std::vector<uint8_t> raw(std::size_t(width) * height);
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x) {
+      const char color = cell[(y & 1) * 2 + (x & 1)];
+      raw[std::size_t(y) * width + x] =
+          uint8_t(color == 'R' ? r : (color == 'G' ? g : b));
+    }
+  return raw;
+}
+
+std::vector<uint8_t> noise(std::size_t bytes, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::vector<uint8_t> v(bytes);
+  for (uint8_t &b : v)
+    b = uint8_t(dist(rng));
+  return v;
+}
+
+} // namespace
+
+Q_DECLARE_METATYPE(Pattern)
+
+class TestBayerDemosaic : public QObject {
+  Q_OBJECT
+private slots:
+
+  void pattern_for_pixel_type() {
+    Pattern p;
+    QVERIFY(patternFor(0x01080009, &p) && p == Pattern::RG);
+    QVERIFY(patternFor(0x01080008, &p) && p == Pattern::GR);
+    QVERIFY(patternFor(0x0108000A, &p) && p == Pattern::GB);
+    QVERIFY(patternFor(0x0108000B, &p) && p == Pattern::BG);
+    // 10/12 位 Bayer、Mono8 不走这里
+    QVERIFY(!patternFor(0x0110000D, &p));
+    QVERIFY(!patternFor(0x01080001, &p));
+  }
+
+  void golden_4x4_rggb() {
+    // R G R G / G B G B / ...，每个位置值不同，手算几个代表点
+    const uint8_t raw[16] = {10, 20, 30, 40,  //
+                             50, 60, 70, 80,  //
+                             90, 100, 110, 120, //
+                             130, 140, 150, 160};
+    uint8_t bgr[16 * 3];
+    QVERIFY(toBgr8(raw, 4, 4, 4, Pattern::RG, bgr, 12, Isa::Scalar));
+    auto px = [&](int x, int y) { return bgr + (y * 4 + x) * 3; };
+
+    // (2,2) R 位置：R = 110，G = (100+120+70+150+2)/4 = 110，
+    // B = (60+80+140+160+2)/4 = 110
+    QCOMPARE(int(px(2, 2)[2]), 110);
+    QCOMPARE(int(px(2, 2)[1]), 110);
+    QCOMPARE(int(px(2, 2)[0]), 110);
+    // (1,0) G 位置在 R 行：R = (10+30+1)/2 = 20，B 取上下，上边镜像到第 1 行：
+    // (60+60+1)/2 = 60
+    QCOMPARE(int(px(1, 0)[2]), 20);
+    QCOMPARE(int(px(1, 0)[1]), 20);
+    QCOMPARE(int(px(1, 0)[0]), 60);
+    // (1,1) B 位置：B = 60，G = (50+70+20+100+2)/4 = 60，
+    // R = (10+30+90+110+2)/4 = 60
+    QCOMPARE(int(px(1, 1)[0]), 60);
+    QCOMPARE(int(px(1, 1)[1]), 60);
+    QCOMPARE(int(px(1, 1)[2]), 60);
+    // (0,0) 角上的 R：左邻镜像到第 1 列、上邻镜像到第 1 行
+    // G = (20+20+50+50+2)/4 = 35，B = (60*4+2)/4 = 60
+    QCOMPARE(int(px(0, 0)[2]), 10);
+    QCOMPARE(int(px(0, 0)[1]), 35);
+    QCOMPARE(int(px(0, 0)[0]), 60);
+    // (3,3) 角上的 B：右 / 下镜像
+    // G = (150+150+120+120+2)/4 = 135，R = (110*4+2)/4 = 110
+    QCOMPARE(int(px(3, 3)[0]), 160);
+    QCOMPARE(int(px(3, 3)[1]), 135);
+    QCOMPARE(int(px(3, 3)[2]), 110);
+
+    // Mono8 = (77 R + 150 G + 29 B + 128) >> 8
+    uint8_t mono[16];
+    QVERIFY(toMono8(raw, 4, 4, 4, Pattern::RG, mono, 4, Isa::Scalar));
+    QCOMPARE(int(mono[0]), (77 * 10 + 150 * 35 + 29 * 60 + 128) >> 8);
+    QCOMPARE(int(mono[2 * 4 + 2]), 110);
+  }
+
+  void flat_field_is_reconstructed_data() {
+    QTest::addColumn<Pattern>("pattern");
+    QTest::newRow("RG") << Pattern::RG;
+    QTest::newRow("GR") << Pattern::GR;
+    QTest::newRow("GB") << Pattern::GB;
+    QTest::newRow("BG") << Pattern::BG;
+  }
+
+  void flat_field_is_reconstructed() {
+    // 纯色场插值后每个像素都应还原出原色，排列搞错时 R / B 会对调
+    QFETCH(Pattern, pattern);
+    const int w = 37, h = 9;
+    const std::vector<uint8_t> raw = mosaic(w, h, pattern, 200, 120, 40);
+    const int expectedY = (77 * 200 + 150 * 120 + 29 * 40 + 128) >> 8;
+    for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+      std::vector<uint8_t> bgr(std::size_t(w) * h * 3);
+      std::vector<uint8_t> mono(std::size_t(w) * h);
+      std::vector<uint8_t> green(std::size_t(w) * h);
+      QVERIFY(toBgr8(raw.data(), w, h, w, pattern, bgr.data(), w * 3, isa));
+      QVERIFY(toMono8(raw.data(), w, h, w, pattern, mono.data(), w, isa));
+      QVERIFY(toGreen8(raw.data(), w, h, w, pattern, green.data(), w, isa));
+      for (int i = 0; i < w * h; ++i) {
+        QCOMPARE(int(bgr[3 * i]), 40);
+        QCOMPARE(int(bgr[3 * i + 1]), 120);
+        QCOMPARE(int(bgr[3 * i + 2]), 200);
+        QCOMPARE(int(mono[i]), expectedY);
+        QCOMPARE(int(green[i]), 120);
+      }
+    }
+  }
+
+  void simd_matches_scalar_data() {
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<Pattern>("pattern");
+    QTest::newRow("2x2 RG") << 2 << 2 << Pattern::RG;
+    QTest::newRow("17x3 GR（不足一组向量）") << 17 << 3 << Pattern::GR;
+    QTest::newRow("35x5 GB（SSE2 一组 + 余数）") << 35 << 5 << Pattern::GB;
+    QTest::newRow("67x7 BG（AVX2 一组 + SSE2 + 余数）") << 67 << 7
+                                                      << Pattern::BG;
+    QTest::newRow("640x480 RG") << 640 << 480 << Pattern::RG;
+    QTest::newRow("1001x33 GB（奇数宽高）") << 1001 << 33 << Pattern::GB;
+  }
+
+  void simd_matches_scalar() {
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(Pattern, pattern);
+    // 行跨距比宽度大：向量化不能读写到跨距里的填充
+    const int srcStride = width + 24;
+    const int bgrStride = width * 3 + 40;
+    const std::vector<uint8_t> raw =
+        noise(std::size_t(srcStride) * height, unsigned(width * 31 + height));
+
+    std::vector<uint8_t> refBgr(std::size_t(bgrStride) * height, 0xCD);
+    std::vector<uint8_t> refMono(std::size_t(srcStride) * height, 0xCD);
+    QVERIFY(toBgr8(raw.data(), width, height, srcStride, pattern,
+                   refBgr.data(), bgrStride, Isa::Scalar));
+    QVERIFY(toMono8(raw.data(), width, height, srcStride, pattern,
+                    refMono.data(), srcStride, Isa::Scalar));
+    std::vector<uint8_t> refGreen(refMono.size(), 0xCD);
+    QVERIFY(toGreen8(raw.data(), width, height, srcStride, pattern,
+                     refGreen.data(), srcStride, Isa::Scalar));
+    // 绿通道就是 BGR8 的 G
+    for (int y = 0; y < height; ++y)
+      for (int x = 0; x < width; ++x)
+        QCOMPARE(refGreen[std::size_t(y) * srcStride + x],
+                 refBgr[std::size_t(y) * bgrStride + 3 * x + 1]);
+
+    for (Isa isa : {Isa::Sse2, Isa::Avx2}) {
+      if (!CpuFeatures::isSupported(isa))
+        continue;
+      std::vector<uint8_t> bgr(refBgr.size(), 0xCD);
+      std::vector<uint8_t> mono(refMono.size(), 0xCD);
+      std::vector<uint8_t> green(refGreen.size(), 0xCD);
+      QVERIFY(toBgr8(raw.data(), width, height, srcStride, pattern,
+                     bgr.data(), bgrStride, isa));
+      QVERIFY(toMono8(raw.data(), width, height, srcStride, pattern,
+                      mono.data(), srcStride, isa));
+      QVERIFY(toGreen8(raw.data(), width, height, srcStride, pattern,
+                       green.data(), srcStride, isa));
+      QVERIFY2(bgr == refBgr, CpuFeatures::name(isa));
+      QVERIFY2(mono == refMono, CpuFeatures::name(isa));
+      QVERIFY2(green == refGreen, CpuFeatures::name(isa));
+    }
+  }
+
+  void rejects_degenerate_sizes() {
+    uint8_t raw[4] = {};
+    uint8_t out[12];
+    QVERIFY(!toBgr8(raw, 1, 4, 1, Pattern::RG, out, 3));
+    QVERIFY(!toMono8(raw, 4, 1, 4, Pattern::RG, out, 4));
+    QVERIFY(CpuFeatures::isSupported(Isa::Scalar));
+    QVERIFY(CpuFeatures::isSupported(CpuFeatures::best()));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestBayerDemosaic)
+#include "test_bayer_demosaic.moc"
@@ -0,0 +1,83 @@
+// BufferSizingPolicy 单元测试：停顿 → 队列深度、内存预算截断、SDK 节点随帧率
+#include "utils/BufferSizing.h"
+
+#include <QtTest>
+
+namespace {
+
+constexpr std::size_t kMiB = 1024 * 1024;
+
+BufferSizingInput input5MP(double fps, uint64_t stallUs,
+                           std::size_t budget = 2048 * kMiB) {
+  BufferSizingInput in;
+  in.frameBytes = 2448 * 2048; // 500 万像素 Mono8
+  in.fps = fps;
+  in.memoryBudgetBytes = budget;
+  in.stallUs = stallUs;
+  in.fixedBuffers = 8;
+  in.maxQueueFrames = 512;
+  return in;
+}
+
+} // namespace
+
+class TestBufferSizing : public QObject {
+  Q_OBJECT
+private slots:
+
+  void no_stall_uses_minimum_queue() {
+    const BufferSizing s = BufferSizingPolicy::compute(input5MP(60.0, 0));
+    QCOMPARE(s.recordQueueLimit, BufferSizingPolicy::kMinRecordQueue);
+    QCOMPARE(s.poolBuffers, std::size_t(8) + s.recordQueueLimit);
+    QCOMPARE(s.sdkNodes, std::size_t(6));
+    QVERIFY(!s.budgetLimited);
+  }
+
+  void queue_absorbs_observed_stall_with_headroom() {
+    // 60 fps 下 200 ms 磁盘停顿：12 帧 × 1.5 + 1
+    const BufferSizing s =
+        BufferSizingPolicy::compute(input5MP(60.0, 200000));
+    QCOMPARE(s.recordQueueLimit, std::size_t(19));
+    QVERIFY(s.absorbableStallMs >= 200.0 * BufferSizingPolicy::kHeadroom);
+    QVERIFY(!s.budgetLimited);
+
+    // 帧率越高需要的队列越深
+    const BufferSizing fast =
+        BufferSizingPolicy::compute(input5MP(200.0, 200000));
+    QCOMPARE(fast.recordQueueLimit, std::size_t(61));
+    QCOMPARE(fast.sdkNodes, std::size_t(20));
+  }
+
+  void budget_truncates_queue_and_reports_real_capacity() {
+    // 128 MiB 只放得下 26 帧 5 MP：3 个 SDK 节点 + 8 固定 + 15 队列
+    const BufferSizing s =
+        BufferSizingPolicy::compute(input5MP(60.0, 500000, 128 * kMiB));
+    QVERIFY(s.budgetLimited);
+    QCOMPARE(s.sdkNodes, BufferSizingPolicy::kMinSdkNodes);
+    QCOMPARE(s.recordQueueLimit, std::size_t(15));
+    QCOMPARE(s.absorbableStallMs, 250.0);
+
+    // 预算连固定占用都不够时仍然能采集
+    const BufferSizing tiny =
+        BufferSizingPolicy::compute(input5MP(60.0, 500000, 16 * kMiB));
+    QVERIFY(tiny.budgetLimited);
+    QCOMPARE(tiny.recordQueueLimit, std::size_t(1));
+  }
+
+  void queue_never_exceeds_physical_capacity() {
+    BufferSizingInput in = input5MP(1000.0, 5000000, 64ull * 1024 * kMiB);
+    in.maxQueueFrames = 256;
+    const BufferSizing s = BufferSizingPolicy::compute(in);
+    QCOMPARE(s.recordQueueLimit, std::size_t(256));
+    QCOMPARE(s.sdkNodes, BufferSizingPolicy::kMaxSdkNodes);
+  }
+
+  void unknown_fps_falls_back() {
+    const BufferSizing s = BufferSizingPolicy::compute(input5MP(0.0, 1000000));
+    // 30 fps × 1 s × 1.5 + 1
+    QCOMPARE(s.recordQueueLimit, std::size_t(46));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestBufferSizing)
+#include "test_buffer_sizing.moc"
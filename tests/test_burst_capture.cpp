@@ -0,0 +1,103 @@
+// BurstCapture 单元测试：按帧数 / 预算预分配、拷贝与源缓冲解耦、
+// 满后拒收、帧号空洞计丢帧、实际帧率取自采集时间戳
+#include "utils/BurstCapture.h"
+
+#include <QtTest>
+#include <cstring>
+
+namespace {
+
+constexpr int64_t kMs = 1'000'000;
+
+FrameRef makeFrame(FramePool &pool, uint32_t frameNum, int64_t grabNs,
+                   unsigned char fill, std::size_t bytes = 64) {
+  FrameRef frame = pool.acquire();
+  std::memset(frame.writableData(), fill, bytes);
+  frame.writableInfo().frameLen = bytes;
+  frame.writableInfo().frameNum = frameNum;
+  frame.writableInfo().grabTimeNs = grabNs;
+  return frame;
+}
+
+} // namespace
+
+class TestBurstCapture : public QObject {
+  Q_OBJECT
+private slots:
+
+  void slots_follow_count_and_budget() {
+    QCOMPARE(BurstCapture::slotsFor(500, 0, 1000), std::size_t(500));
+    // 预算截断帧数
+    QCOMPARE(BurstCapture::slotsFor(500, 100 * 1000, 1000), std::size_t(100));
+    // 只给预算时把预算用满
+    QCOMPARE(BurstCapture::slotsFor(0, 100 * 1000 + 999, 1000),
+             std::size_t(100));
+    QCOMPARE(BurstCapture::slotsFor(10, 0, 0), std::size_t(0));
+  }
+
+  void frames_are_copied_and_source_pool_is_released() {
+    FramePool source;
+    QVERIFY(source.configure(1, 64));
+    BurstCapture burst;
+    QVERIFY(burst.configure(3, 64));
+    QCOMPARE(burst.capacity(), std::size_t(3));
+
+    for (uint32_t i = 0; i < 3; ++i) {
+      const FrameRef frame =
+          makeFrame(source, i, int64_t(i) * 10 * kMs, (unsigned char)(i + 1));
+      const BurstCapture::StoreResult r = burst.store(frame);
+      QCOMPARE(r, i < 2 ? BurstCapture::StoreResult::Stored
+                        : BurstCapture::StoreResult::Complete);
+    }
+    // 源池只有 1 块：能连续取 3 帧说明 arena 没有持有源缓冲
+    QCOMPARE(source.inUse(), std::size_t(0));
+    QVERIFY(burst.isComplete());
+    QCOMPARE(burst.frame(1).data()[0], (unsigned char)2);
+    QCOMPARE(burst.frame(2).info().frameNum, 2u);
+
+    const FrameRef extra = makeFrame(source, 3, 30 * kMs, 9);
+    QCOMPARE(burst.store(extra), BurstCapture::StoreResult::Full);
+    QCOMPARE(burst.size(), std::size_t(3));
+  }
+
+  void stats_report_gaps_and_achieved_fps() {
+    FramePool source;
+    QVERIFY(source.configure(2, 64));
+    BurstCapture burst;
+    QVERIFY(burst.configure(4, 64));
+    // 200 fps 节拍，帧号 10, 11, 14, 15：中间丢了 2 帧
+    const uint32_t nums[] = {10, 11, 14, 15};
+    const int64_t times[] = {0, 5, 20, 25};
+    for (int i = 0; i < 4; ++i)
+      burst.store(makeFrame(source, nums[i], times[i] * kMs, 0));
+
+    const BurstCapture::Stats s = burst.stats();
+    QCOMPARE(s.target, std::size_t(4));
+    QCOMPARE(s.captured, std::size_t(4));
+    QCOMPARE(s.dropped, uint64_t(2));
+    QCOMPARE(s.durationMs, 25.0);
+    QCOMPARE(s.achievedFps, 120.0);
+  }
+
+  void counter_wrap_is_not_a_gap_and_oversize_is_rejected() {
+    FramePool source;
+    QVERIFY(source.configure(2, 128));
+    BurstCapture burst;
+    QVERIFY(burst.configure(3, 64));
+    burst.store(makeFrame(source, 0xFFFFFFFFu, 0, 0));
+    burst.store(makeFrame(source, 0, kMs, 0));
+    QCOMPARE(burst.stats().dropped, uint64_t(0));
+    QCOMPARE(burst.store(makeFrame(source, 1, 2 * kMs, 0, 128)),
+             BurstCapture::StoreResult::Oversize);
+
+    // clear 之后可以再连拍一次
+    burst.clear();
+    QCOMPARE(burst.size(), std::size_t(0));
+    QCOMPARE(burst.store(makeFrame(source, 5, 0, 7)),
+             BurstCapture::StoreResult::Stored);
+    QCOMPARE(burst.frame(0).data()[0], (unsigned char)7);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestBurstCapture)
+#include "test_burst_capture.moc"
@@ -7,6 +7,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QSignalSpy>
+#include <QSqlQuery>
 #include <QTemporaryDir>
 #include <QtTest>
 
@@ -209,6 +210,139 @@ private slots:
     QCOMPARE(list.first().duration, qint64(99));
     QCOMPARE(list.first().filesize, qint64(88888));
   }
+
+  // ========== 帧数 ==========
+  void upsertVideo_stores_frame_count() {
+    resetDb();
+    VideoInfo v = makeSampleVideo("/tmp/f.wvr", 10, 4096);
+    v.frameCount = 600;
+    QVERIFY(DatabaseManager::instance().upsertVideo(v));
+    QCOMPARE(DatabaseManager::instance().getAllVideos().first().frameCount,
+             qint64(600));
+
+    v.frameCount = 1200;
+    QVERIFY(DatabaseManager::instance().upsertVideo(v));
+    QCOMPARE(DatabaseManager::instance().getAllVideos().first().frameCount,
+             qint64(1200));
+    // 不带帧数的更新保留原值
+    QVERIFY(DatabaseManager::instance().updateVideoMetadataByPath(
+        "/tmp/f.wvr", 20, 8192));
+    QCOMPARE(DatabaseManager::instance().getAllVideos().first().frameCount,
+             qint64(1200));
+  }
+
+  // ========== 分段录制会话 ==========
+  void recording_session_groups_segments_in_order() {
+    resetDb();
+    RecordingSession session;
+    session.name = "overnight_20261017";
+    session.basePath = "/data/overnight_20261017.avi";
+    const int sessionId =
+        DatabaseManager::instance().insertRecordingSession(session);
+    QVERIFY(sessionId > 0);
+    const RecordingSession stored =
+        DatabaseManager::instance().getRecordingSession(sessionId);
+    QCOMPARE(stored.id, sessionId);
+    QCOMPARE(stored.name, QString("overnight_20261017"));
+    QCOMPARE(stored.basePath, QString("/data/overnight_20261017.avi"));
+    QVERIFY(stored.createdAt.isValid());
+
+    // 入库顺序和段号无关；其他录制不混进来
+    for (int index : {2, 1, 3}) {
+      VideoInfo v = makeSampleVideo(
+          QString("/data/overnight_20261017_%1.avi").arg(index, 3, 10,
+                                                          QChar('0')));
+      v.sessionId = sessionId;
+      v.segmentIndex = index;
+      QVERIFY(DatabaseManager::instance().upsertVideo(v));
+    }
+    QVERIFY(DatabaseManager::instance().upsertVideo(
+        makeSampleVideo("/data/single.avi")));
+
+    const QVector<VideoInfo> segments =
+        DatabaseManager::instance().getVideosInSession(sessionId);
+    QCOMPARE(segments.size(), 3);
+    for (int i = 0; i < 3; ++i) {
+      QCOMPARE(segments[i].sessionId, sessionId);
+      QCOMPARE(segments[i].segmentIndex, i + 1);
+    }
+    QCOMPARE(DatabaseManager::instance().getAllVideos().size(), 4);
+    QCOMPARE(DatabaseManager::instance().getRecordingSession(999).id, -1);
+  }
+
+  void upsertVideo_attaches_existing_file_to_session() {
+    // 视频库扫目录先把分段文件入了库（没有会话归属），录制结束再补上
+    resetDb();
+    QVERIFY(DatabaseManager::instance().insertVideo(
+                makeSampleVideo("/data/run_001.wvr", 0, 0)) > 0);
+    RecordingSession session;
+    session.name = "run";
+    session.basePath = "/data/run.wvr";
+    const int sessionId =
+        DatabaseManager::instance().insertRecordingSession(session);
+    VideoInfo v = makeSampleVideo("/data/run_001.wvr", 600, 4096);
+    v.sessionId = sessionId;
+    v.segmentIndex = 1;
+    QVERIFY(DatabaseManager::instance().upsertVideo(v));
+
+    const auto all = DatabaseManager::instance().getAllVideos();
+    QCOMPARE(all.size(), 1);
+    QCOMPARE(all.first().sessionId, sessionId);
+    QCOMPARE(all.first().segmentIndex, 1);
+    QCOMPARE(all.first().duration, qint64(600));
+
+    // 不带会话的 upsert 不清掉已有归属
+    QVERIFY(DatabaseManager::instance().upsertVideo(
+        makeSampleVideo("/data/run_001.wvr", 601, 4096)));
+    QCOMPARE(DatabaseManager::instance().getAllVideos().first().sessionId,
+             sessionId);
+  }
+
+  void initialize_adds_frame_count_to_old_table() {
+    ensureSqlDriverPath();
+    DatabaseManager::instance().close();
+    QTemporaryDir dir;
+    const QString path = dir.filePath("old.db");
+    // 旧版本建的表：没有 frame_count 列
+    QVERIFY(DatabaseManager::instance().initialize(path));
+    {
+      QSqlQuery q;
+      QVERIFY(q.exec("DROP TABLE videos"));
+      QVERIFY(q.exec("CREATE TABLE videos ("
+                     "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                     "filename TEXT NOT NULL,"
+                     "filepath TEXT NOT NULL UNIQUE,"
+                     "duration INTEGER DEFAULT 0,"
+                     "filesize INTEGER DEFAULT 0,"
+                     "created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
+                     "upload_status TEXT DEFAULT 'NONE',"
+                     "workspace_id INTEGER DEFAULT 0)"));
+      QVERIFY(q.exec("INSERT INTO videos (filename, filepath) "
+                     "VALUES ('old.avi', '/tmp/old.avi')"));
+    }
+    DatabaseManager::instance().close();
+
+    QVERIFY(DatabaseManager::instance().initialize(path));
+    QCOMPARE(DatabaseManager::instance().getAllVideos().size(), 1);
+    VideoInfo v = makeSampleVideo("/tmp/new.wvr");
+    v.frameCount = 42;
+    const int id = DatabaseManager::instance().insertVideo(v);
+    QVERIFY(id > 0);
+    QCOMPARE(DatabaseManager::instance().getVideoById(id).frameCount,
+             qint64(42));
+    // 分段录制的列和会话表也补上了
+    RecordingSession session;
+    session.name = "old";
+    session.basePath = "/tmp/old.avi";
+    const int sessionId =
+        DatabaseManager::instance().insertRecordingSession(session);
+    QVERIFY(sessionId > 0);
+    QVERIFY(DatabaseManager::instance().updateVideoSessionByPath(
+        "/tmp/old.avi", sessionId, 1));
+    QCOMPARE(DatabaseManager::instance().getVideosInSession(sessionId).size(),
+             1);
+    DatabaseManager::instance().close();
+  }
 };
 
 QTEST_GUILESS_MAIN(TestDatabaseManager)
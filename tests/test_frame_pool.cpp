@@ -0,0 +1,142 @@
+// FramePool 单元测试：预分配帧缓冲池的占用 / 耗尽计数与回收
+#include "utils/FramePool.h"
+
+#include <QtTest>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class TestFramePool : public QObject {
+  Q_OBJECT
+private slots:
+
+  void frame_bytes_follow_gvsp_bit_depth() {
+    // Mono8 / Mono12 (16 bit 容器) / Mono12Packed / RGB8
+    QCOMPARE(FramePool::frameBytesFor(640, 480, 0x01080001u),
+             std::size_t(640 * 480));
+    QCOMPARE(FramePool::frameBytesFor(640, 480, 0x01100005u),
+             std::size_t(640 * 480 * 2));
+    QCOMPARE(FramePool::frameBytesFor(640, 480, 0x010C0006u),
+             std::size_t(640 * 480 * 3 / 2));
+    QCOMPARE(FramePool::frameBytesFor(640, 480, 0x02180014u),
+             std::size_t(640 * 480 * 3));
+    // 未知格式按 8 bit 兜底
+    QCOMPARE(FramePool::frameBytesFor(10, 10, 0u), std::size_t(100));
+  }
+
+  void buffers_are_aligned_and_distinct() {
+    FramePool pool;
+    QVERIFY(pool.configure(4, 1000));
+    std::vector<FrameRef> held;
+    for (int i = 0; i < 4; ++i) {
+      FrameRef f = pool.acquire();
+      QVERIFY(f);
+      QCOMPARE(f.capacity(), std::size_t(1000));
+      QCOMPARE(reinterpret_cast<std::uintptr_t>(f.data()) % 64,
+               std::uintptr_t(0));
+      for (const FrameRef &other : held)
+        QVERIFY(other.data() != f.data());
+      held.push_back(f);
+    }
+  }
+
+  void exhaustion_is_counted_and_buffers_come_back() {
+    FramePool pool;
+    QVERIFY(pool.configure(3, 256));
+
+    std::vector<FrameRef> held;
+    for (int i = 0; i < 3; ++i)
+      held.push_back(pool.acquire());
+    QCOMPARE(pool.inUse(), std::size_t(3));
+
+    QVERIFY(!pool.acquire());
+    QVERIFY(!pool.acquire());
+
+    FramePool::Stats st = pool.stats();
+    QCOMPARE(st.acquired, uint64_t(3));
+    QCOMPARE(st.exhausted, uint64_t(2));
+    QCOMPARE(st.highWater, std::size_t(3));
+
+    // 共享引用不会提前归还
+    FrameRef shared = held[0];
+    held.clear();
+    QCOMPARE(pool.inUse(), std::size_t(1));
+    shared.reset();
+    QCOMPARE(pool.inUse(), std::size_t(0));
+    QVERIFY(pool.acquire());
+  }
+
+  void grow_adds_buffers_while_in_use_up_to_max() {
+    FramePool pool;
+    QVERIFY(pool.configure(2, 256, 5));
+    QCOMPARE(pool.maxBufferCount(), std::size_t(5));
+
+    std::vector<FrameRef> held;
+    held.push_back(pool.acquire());
+    held.push_back(pool.acquire());
+    QVERIFY(!pool.acquire());
+
+    // 缓冲被持有时也能追加，超出上限的部分被截掉
+    QCOMPARE(pool.grow(2), std::size_t(2));
+    QCOMPARE(pool.bufferCount(), std::size_t(4));
+    QCOMPARE(pool.grow(10), std::size_t(1));
+    QCOMPARE(pool.grow(1), std::size_t(0));
+    for (int i = 0; i < 3; ++i) {
+      held.push_back(pool.acquire());
+      QVERIFY(held.back());
+      QCOMPARE(held.back().capacity(), std::size_t(256));
+    }
+    QVERIFY(!pool.acquire());
+    QCOMPARE(pool.stats().bufferCount, std::size_t(5));
+
+    held.clear();
+    QCOMPARE(pool.inUse(), std::size_t(0));
+    // 重新配置回到初始块数
+    QVERIFY(pool.configure(2, 256));
+    QCOMPARE(pool.bufferCount(), std::size_t(2));
+    QCOMPARE(pool.grow(1), std::size_t(0));
+  }
+
+  void reconfigure_is_refused_while_buffers_are_held() {
+    FramePool pool;
+    QVERIFY(pool.configure(2, 128));
+    FrameRef held = pool.acquire();
+    QVERIFY(!pool.configure(4, 256));
+    QVERIFY(!pool.release());
+    QVERIFY(!pool.prefault());
+    QCOMPARE(pool.bufferBytes(), std::size_t(128));
+
+    held.reset();
+    QVERIFY(pool.configure(4, 256));
+    QVERIFY(pool.prefault());
+    QCOMPARE(pool.bufferCount(), std::size_t(4));
+    QCOMPARE(pool.stats().exhausted, uint64_t(0));
+  }
+
+  void concurrent_acquire_release_never_loses_buffers() {
+    FramePool pool;
+    QVERIFY(pool.configure(8, 64));
+
+    auto worker = [&pool]() {
+      for (int i = 0; i < 20000; ++i) {
+        FrameRef f = pool.acquire();
+        if (f)
+          f.writableData()[0] = static_cast<unsigned char>(i);
+      }
+    };
+    std::thread a(worker), b(worker), c(worker);
+    a.join();
+    b.join();
+    c.join();
+
+    QCOMPARE(pool.inUse(), std::size_t(0));
+    std::vector<FrameRef> all;
+    for (int i = 0; i < 8; ++i)
+      all.push_back(pool.acquire());
+    for (const FrameRef &f : all)
+      QVERIFY(f);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestFramePool)
+#include "test_frame_pool.moc"
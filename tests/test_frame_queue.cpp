@@ -0,0 +1,134 @@
+// FrameQueue / FrameRef 单元测试：采集流水线的无锁队列与帧引用计数
+#include "utils/FrameQueue.h"
+#include "utils/FrameRef.h"
+
+#include <QtTest>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void countRecycle(FrameBuffer *, void *context) {
+  static_cast<std::atomic<int> *>(context)->fetch_add(1);
+}
+
+} // namespace
+
+class TestFrameQueue : public QObject {
+  Q_OBJECT
+private slots:
+
+  void spsc_capacity_rounds_up_to_pow2() {
+    SpscRing<int> ring(5);
+    QCOMPARE(ring.capacity(), std::size_t(8));
+  }
+
+  void spsc_rejects_push_when_full_and_keeps_fifo_order() {
+    SpscRing<int> ring(4);
+    for (int i = 0; i < 4; ++i)
+      QVERIFY(ring.tryPush(i));
+    QVERIFY(!ring.tryPush(99));
+    QCOMPARE(ring.size(), std::size_t(4));
+
+    int v = -1;
+    for (int i = 0; i < 4; ++i) {
+      QVERIFY(ring.tryPop(v));
+      QCOMPARE(v, i);
+    }
+    QVERIFY(!ring.tryPop(v));
+    QVERIFY(ring.empty());
+  }
+
+  void spsc_cross_thread_preserves_order() {
+    SpscRing<int> ring(64);
+    const int total = 200000;
+    std::thread producer([&]() {
+      for (int i = 0; i < total; ++i) {
+        while (!ring.tryPush(i))
+          std::this_thread::yield();
+      }
+    });
+    int expected = 0;
+    int v = 0;
+    while (expected < total) {
+      if (ring.tryPop(v)) {
+        QCOMPARE(v, expected);
+        ++expected;
+      }
+    }
+    producer.join();
+    QVERIFY(ring.empty());
+  }
+
+  void mpmc_multiple_producers_no_loss() {
+    MpmcRing<int> ring(128);
+    const int perProducer = 50000;
+    const int producers = 4;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+      threads.emplace_back([&ring, p]() {
+        for (int i = 0; i < perProducer; ++i) {
+          while (!ring.tryPush(p * perProducer + i + 1))
+            std::this_thread::yield();
+        }
+      });
+    }
+    long long sum = 0;
+    int received = 0;
+    int v = 0;
+    while (received < perProducer * producers) {
+      if (ring.tryPop(v)) {
+        sum += v;
+        ++received;
+      }
+    }
+    for (auto &t : threads)
+      t.join();
+    const long long n = static_cast<long long>(perProducer) * producers;
+    QCOMPARE(sum, n * (n + 1) / 2);
+  }
+
+  void frameref_recycles_once_after_last_release() {
+    std::atomic<int> recycled{0};
+    unsigned char pixels[16] = {};
+    FrameBuffer buffer;
+    buffer.data = pixels;
+    buffer.capacity = sizeof(pixels);
+    buffer.info.frameLen = sizeof(pixels);
+    buffer.recycle = &countRecycle;
+    buffer.recycleContext = &recycled;
+
+    FrameRef a = FrameRef::adopt(&buffer);
+    QCOMPARE(a.useCount(), 1);
+    {
+      FrameRef b = a;
+      FrameRef c = std::move(b);
+      QCOMPARE(a.useCount(), 2);
+      QVERIFY(!b);
+      QCOMPARE(c.data(), static_cast<const unsigned char *>(pixels));
+    }
+    QCOMPARE(recycled.load(), 0);
+    a.reset();
+    QCOMPARE(recycled.load(), 1);
+  }
+
+  void frameref_survives_queue_round_trip() {
+    std::atomic<int> recycled{0};
+    FrameBuffer buffer;
+    buffer.recycle = &countRecycle;
+    buffer.recycleContext = &recycled;
+
+    SpscRing<FrameRef> ring(2);
+    QVERIFY(ring.tryPush(FrameRef::adopt(&buffer)));
+    QCOMPARE(recycled.load(), 0);
+    FrameRef out;
+    QVERIFY(ring.tryPop(out));
+    QCOMPARE(out.useCount(), 1);
+    out.reset();
+    QCOMPARE(recycled.load(), 1);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestFrameQueue)
+#include "test_frame_queue.moc"
@@ -0,0 +1,118 @@
+// FrameRateEstimator 单元测试：binning / 抽样后的输出尺寸、读出帧率缩放、
+// 曝光 / 帧率限制 / 链路带宽谁先卡住，以及读出上限何时只是下限估计
+#include "utils/FrameRateEstimator.h"
+
+#include <QtTest>
+
+namespace {
+
+// 2448x2048 Mono8，读出限制 75 fps，GigE 约 118 MB/s
+FrameRateModelInput fullSensor() {
+  FrameRateModelInput in;
+  in.width = 2448;
+  in.height = 2048;
+  in.bytesPerPixel = 1.0;
+  in.resultingFps = 75.0;
+  in.exposureUs = 1000.0;
+  in.linkBytesPerSec = 0.0;
+  return in;
+}
+
+} // namespace
+
+class TestFrameRateEstimator : public QObject {
+  Q_OBJECT
+private slots:
+
+  void same_mode_reproduces_current() {
+    const FrameRateEstimate est =
+        FrameRateEstimator::estimate(fullSensor(), SamplingMode{});
+    QCOMPARE(est.width, 2448);
+    QCOMPARE(est.height, 2048);
+    QCOMPARE(est.frameBytes, std::size_t(2448) * 2048);
+    QCOMPARE(est.maxFps, 75.0);
+    QCOMPARE(est.bandwidthBytesPerSec, 75.0 * 2448 * 2048);
+    QVERIFY(est.limitedBy == FrameRateEstimate::Limit::Readout);
+    QVERIFY(!est.readoutIsLowerBound);
+  }
+
+  void binning_scales_size_and_readout() {
+    SamplingMode bin2;
+    bin2.binningH = 2;
+    bin2.binningV = 2;
+    FrameRateEstimate est = FrameRateEstimator::estimate(fullSensor(), bin2);
+    QCOMPARE(est.width, 1224);
+    QCOMPARE(est.height, 1024);
+    QCOMPARE(est.maxFps, 150.0);
+
+    // 只水平抽样：行数不变，读出帧率不变，带宽减半
+    SamplingMode decH;
+    decH.decimationH = 2;
+    est = FrameRateEstimator::estimate(fullSensor(), decH);
+    QCOMPARE(est.width, 1224);
+    QCOMPARE(est.height, 2048);
+    QCOMPARE(est.maxFps, 75.0);
+
+    // 从 binning 2 回到 1：输出放大，帧率降回
+    FrameRateModelInput binned = fullSensor();
+    binned.mode = bin2;
+    binned.width = 1224;
+    binned.height = 1024;
+    binned.resultingFps = 150.0;
+    est = FrameRateEstimator::estimate(binned, SamplingMode{});
+    QCOMPARE(est.width, 2448);
+    QCOMPARE(est.height, 2048);
+    QCOMPARE(est.maxFps, 75.0);
+  }
+
+  void exposure_and_frame_rate_limit_cap_the_gain() {
+    SamplingMode bin4;
+    bin4.binningV = 4;
+    FrameRateModelInput in = fullSensor();
+    in.exposureUs = 5000.0; // 最多 200 fps
+    FrameRateEstimate est = FrameRateEstimator::estimate(in, bin4);
+    QCOMPARE(est.maxFps, 200.0);
+    QVERIFY(est.limitedBy == FrameRateEstimate::Limit::Exposure);
+
+    in.exposureUs = 1000.0;
+    in.frameRateLimit = 100.0;
+    est = FrameRateEstimator::estimate(in, bin4);
+    QCOMPARE(est.maxFps, 100.0);
+    QVERIFY(est.limitedBy == FrameRateEstimate::Limit::FrameRateLimit);
+  }
+
+  void link_bandwidth_limits_large_frames() {
+    FrameRateModelInput in = fullSensor();
+    in.linkBytesPerSec = 118e6; // 满幅只能 ~23.5 fps
+    in.resultingFps = 23.5;
+    FrameRateEstimate est = FrameRateEstimator::estimate(in, SamplingMode{});
+    QVERIFY(est.limitedBy == FrameRateEstimate::Limit::Link);
+    QVERIFY(qAbs(est.maxFps - 118e6 / (2448.0 * 2048)) < 1e-6);
+    // 当前帧率被链路卡住：读出能力只知道下限
+    QVERIFY(est.readoutIsLowerBound);
+
+    SamplingMode bin2;
+    bin2.binningH = 2;
+    bin2.binningV = 2;
+    est = FrameRateEstimator::estimate(in, bin2);
+    // 读出下限 47 fps 小于链路允许的 ~94 fps
+    QVERIFY(est.limitedBy == FrameRateEstimate::Limit::Readout);
+    QCOMPARE(est.maxFps, 47.0);
+    QVERIFY(est.readoutIsLowerBound);
+    QVERIFY(est.bandwidthBytesPerSec < in.linkBytesPerSec);
+  }
+
+  void unknown_current_rate_is_reported_as_zero() {
+    FrameRateModelInput in = fullSensor();
+    in.resultingFps = 0.0;
+    in.exposureUs = 0.0;
+    const FrameRateEstimate est =
+        FrameRateEstimator::estimate(in, SamplingMode{});
+    QCOMPARE(est.maxFps, 0.0);
+    QCOMPARE(est.bandwidthBytesPerSec, 0.0);
+    QCOMPARE(est.width, 2448);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestFrameRateEstimator)
+#include "test_frame_rate_estimator.moc"
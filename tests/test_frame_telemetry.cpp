@@ -0,0 +1,143 @@
+// FrameTelemetry 单元测试：帧号空洞、相对延迟基线（含时钟漂移）、抖动、分位数
+#include "utils/FrameTelemetry.h"
+
+#include <QtTest>
+#include <cstdint>
+
+namespace {
+
+constexpr int64_t kMs = 1'000'000;
+
+FrameInfo frameAt(uint32_t frameNum, int64_t hostNs, uint64_t devTicks = 0) {
+  FrameInfo info;
+  info.frameNum = frameNum;
+  info.grabTimeNs = hostNs;
+  info.devTimestamp = devTicks;
+  return info;
+}
+
+} // namespace
+
+class TestFrameTelemetry : public QObject {
+  Q_OBJECT
+private slots:
+
+  void histogram_small_values_are_exact() {
+    LatencyHistogram h;
+    for (int i = 0; i < 5; ++i)
+      h.record(10);
+    h.record(40);
+    QCOMPARE(h.count(), uint64_t(6));
+    QCOMPARE(h.percentile(50), uint64_t(10));
+    QCOMPARE(h.percentile(100), uint64_t(40));
+    QCOMPARE(h.min(), uint64_t(10));
+    QCOMPARE(h.max(), uint64_t(40));
+    QCOMPARE(h.mean(), 15.0);
+  }
+
+  void histogram_percentiles_within_bucket_error() {
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 100000; ++v)
+      h.record(v);
+    const auto within = [](uint64_t got, double want) {
+      return std::abs(double(got) - want) / want < 0.035;
+    };
+    QVERIFY(within(h.percentile(50), 50000));
+    QVERIFY(within(h.percentile(95), 95000));
+    QVERIFY(within(h.percentile(99), 99000));
+    QCOMPARE(h.percentile(100), uint64_t(100000));
+
+    h.clear();
+    QCOMPARE(h.count(), uint64_t(0));
+    QCOMPARE(h.percentile(99), uint64_t(0));
+    // 超大值落在最后一个桶，不越界
+    h.record(uint64_t(1) << 50);
+    QCOMPARE(h.max(), uint64_t(1) << 50);
+  }
+
+  void frame_number_gaps_are_counted() {
+    FrameTelemetry t;
+    int64_t host = 0;
+    for (uint32_t n : {1u, 2u, 3u, 6u, 7u, 10u, 11u}) {
+      t.record(frameAt(n, host));
+      host += 10 * kMs;
+    }
+    const FrameTelemetry::Summary s = t.summary();
+    QCOMPARE(s.frames, uint64_t(7));
+    QCOMPARE(s.lostFrames, uint64_t(4));
+    QCOMPARE(s.gapEvents, uint64_t(2));
+    QCOMPARE(s.largestGap, uint64_t(2));
+    QCOMPARE(s.firstFrameNum, 1u);
+    QCOMPARE(s.lastFrameNum, 11u);
+    QCOMPARE(s.durationSec, 0.06);
+    QVERIFY(std::abs(s.meanFps - 100.0) < 1e-6);
+    // 没有设备时间戳：只有间隔
+    QCOMPARE(s.intervalUs.p50, uint64_t(10000));
+    QCOMPARE(s.latencyUs.count, uint64_t(0));
+    QCOMPARE(s.jitterUs.count, uint64_t(0));
+  }
+
+  void counter_reset_is_not_a_loss() {
+    FrameTelemetry t;
+    int64_t host = 0;
+    for (uint32_t n : {5u, 6u, 0u, 1u, 2u}) {
+      t.record(frameAt(n, host));
+      host += kMs;
+    }
+    const FrameTelemetry::Summary s = t.summary();
+    QCOMPARE(s.lostFrames, uint64_t(0));
+    QCOMPARE(s.counterResets, uint64_t(1));
+  }
+
+  void latency_is_relative_to_fastest_frame() {
+    FrameTelemetry t;
+    t.reset(1e9);
+    // 设备与主机时钟相差任意常数，第 50 帧多排队 3 ms
+    const int64_t clockOffset = 123456789;
+    for (uint32_t i = 0; i < 100; ++i) {
+      const int64_t dev = int64_t(i) * 10 * kMs;
+      const int64_t extra = i == 50 ? 3 * kMs : 0;
+      t.record(frameAt(i, dev + clockOffset + extra, uint64_t(dev) + 1));
+    }
+    const FrameTelemetry::Summary s = t.summary();
+    QCOMPARE(s.latencyUs.count, uint64_t(100));
+    QCOMPARE(s.latencyUs.p50, uint64_t(0));
+    QCOMPARE(s.latencyUs.max, uint64_t(3000));
+    // 第 50 帧到得晚 3 ms、第 51 帧间隔短 3 ms：两次抖动
+    QCOMPARE(s.jitterUs.max, uint64_t(3000));
+    QCOMPARE(s.jitterUs.p95, uint64_t(0));
+  }
+
+  void baseline_window_absorbs_clock_drift() {
+    FrameTelemetry t;
+    // 设备时钟 100 MHz，比主机慢 100 ppm；100 fps 跑 60 秒
+    t.reset(1e8);
+    for (uint32_t i = 0; i < 6000; ++i) {
+      const int64_t host = int64_t(i) * 10 * kMs;
+      const auto devTicks = static_cast<uint64_t>(
+          double(host) * (1.0 - 100e-6) / 10.0) + 1;
+      t.record(frameAt(i, host, devTicks));
+    }
+    const FrameTelemetry::Summary s = t.summary();
+    // 全程漂移 6 ms；5 s 窗口内最多 0.5 ms
+    QVERIFY(s.latencyUs.max <= 520);
+    QVERIFY(s.jitterUs.max <= 2);
+    QCOMPARE(s.lostFrames, uint64_t(0));
+  }
+
+  void reset_starts_a_new_window() {
+    FrameTelemetry t;
+    t.record(frameAt(1, 0));
+    t.record(frameAt(5, kMs));
+    QCOMPARE(t.summary().lostFrames, uint64_t(3));
+    t.reset();
+    const FrameTelemetry::Summary s = t.summary();
+    QCOMPARE(s.frames, uint64_t(0));
+    QCOMPARE(s.lostFrames, uint64_t(0));
+    QCOMPARE(s.intervalUs.count, uint64_t(0));
+    QCOMPARE(s.meanFps, 0.0);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestFrameTelemetry)
+#include "test_frame_telemetry.moc"
@@ -0,0 +1,110 @@
+// LatestFrameMailbox 单元测试：抓拍用的"最新一帧"三缓冲信箱
+#include "utils/FrameRef.h"
+#include "utils/LatestFrameMailbox.h"
+
+#include <QtTest>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void countRecycle(FrameBuffer *, void *context) {
+  static_cast<std::atomic<int> *>(context)->fetch_add(1);
+}
+
+} // namespace
+
+class TestLatestFrameMailbox : public QObject {
+  Q_OBJECT
+private slots:
+
+  void acquire_on_empty_mailbox_returns_nothing() {
+    LatestFrameMailbox<int> box;
+    int v = -1;
+    QVERIFY(!box.acquire(v));
+    QCOMPARE(v, 0);
+  }
+
+  void acquire_returns_newest_published_value() {
+    LatestFrameMailbox<int> box;
+    box.publish(1);
+    box.publish(2);
+    box.publish(3);
+    QVERIFY(box.hasFresh());
+
+    int v = 0;
+    QVERIFY(box.acquire(v));
+    QCOMPARE(v, 3);
+
+    // 没有新帧时仍返回上一次的最新值，但不算 fresh
+    QVERIFY(!box.acquire(v));
+    QCOMPARE(v, 3);
+
+    box.publish(4);
+    QVERIFY(box.acquire(v));
+    QCOMPARE(v, 4);
+  }
+
+  void overwritten_frames_are_recycled_immediately() {
+    std::atomic<int> recycled{0};
+    std::vector<FrameBuffer> buffers(10);
+    for (auto &b : buffers) {
+      b.recycle = &countRecycle;
+      b.recycleContext = &recycled;
+    }
+
+    LatestFrameMailbox<FrameRef> box;
+    for (auto &b : buffers)
+      box.publish(FrameRef::adopt(&b));
+
+    // 只有最新一帧还留在信箱里
+    QCOMPARE(recycled.load(), 9);
+    QCOMPARE(buffers.back().refCount.load(), 1);
+
+    FrameRef latest;
+    QVERIFY(box.acquire(latest));
+    QCOMPARE(latest.data(), buffers.back().data);
+    QCOMPARE(latest.useCount(), 2);
+
+    latest.reset();
+    box.releaseReader();
+    QCOMPARE(recycled.load(), 10);
+
+    box.clear();
+    QCOMPARE(recycled.load(), 10);
+  }
+
+  void reader_never_sees_torn_or_stale_values_across_threads() {
+    // 写端发布递增序号，读端看到的序号必须单调不减
+    LatestFrameMailbox<std::vector<int>> box;
+    constexpr int kCount = 100000;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&]() {
+      for (int i = 1; i <= kCount; ++i)
+        box.publish(std::vector<int>{i, i, i, i});
+      done = true;
+    });
+
+    int last = 0;
+    bool monotonic = true;
+    bool consistent = true;
+    std::vector<int> v;
+    while (!done.load() || box.hasFresh()) {
+      if (box.acquire(v) && !v.empty()) {
+        consistent = consistent && v[0] == v[1] && v[1] == v[2] && v[2] == v[3];
+        monotonic = monotonic && v[0] >= last;
+        last = v[0];
+      }
+    }
+    writer.join();
+
+    QVERIFY(consistent);
+    QVERIFY(monotonic);
+    QCOMPARE(last, kCount);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestLatestFrameMailbox)
+#include "test_latest_frame_mailbox.moc"
@@ -0,0 +1,249 @@
+// LosslessCodec 单元测试：各像素格式的采样排列；平坦 / 噪声 / 渐变 / 大跳变
+// 画面逐字节往返；多线程与单线程码流一致；压缩不了的条带原样存；
+// 截断 / 篡改的码流被拒且不越界
+#include "utils/LosslessCodec.h"
+#include "utils/PixelFormats.h"
+#include "utils/TilePool.h"
+
+#include <QtTest>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+enum Content { Flat, Noise, Gradient, Jumps, FullRandom };
+
+// 按 layout 生成一帧：平坦背景 / 小噪声 / 斜渐变 / 相邻采样大跳变 / 全随机
+std::vector<uint8_t> makeFrame(const LosslessCodec::Layout &l, Content content,
+                               uint32_t seed) {
+  std::vector<uint8_t> frame(l.frameBytes());
+  std::mt19937 rng(seed);
+  const uint32_t maxValue = l.bytesPerSample == 1 ? 255 : 65535;
+  for (int y = 0; y < l.rows; ++y) {
+    for (int x = 0; x < l.samplesPerRow; ++x) {
+      uint32_t v = 0;
+      switch (content) {
+      case Flat:
+        v = maxValue / 2;
+        break;
+      case Noise:
+        v = maxValue / 3 + rng() % 5;
+        break;
+      case Gradient:
+        v = (uint32_t(x) * 3 + uint32_t(y) * 7) % (maxValue + 1);
+        break;
+      case Jumps:
+        v = (x + y) % 2 ? maxValue : 0;
+        break;
+      case FullRandom:
+        v = rng() & maxValue;
+        break;
+      }
+      const std::size_t i = std::size_t(y) * l.samplesPerRow + x;
+      if (l.bytesPerSample == 1) {
+        frame[i] = uint8_t(v);
+      } else {
+        const uint16_t s = uint16_t(v);
+        std::memcpy(frame.data() + i * 2, &s, 2);
+      }
+    }
+  }
+  return frame;
+}
+
+std::vector<uint8_t> concat(const LosslessCodec::Encoder &encoder) {
+  std::vector<uint8_t> out;
+  for (const LosslessCodec::Encoder::Piece &p : encoder.pieces())
+    out.insert(out.end(), p.data, p.data + p.bytes);
+  return out;
+}
+
+LosslessCodec::Layout layout(int bps, int samples, int rows, int xStep,
+                             int yStep) {
+  LosslessCodec::Layout l;
+  l.bytesPerSample = bps;
+  l.samplesPerRow = samples;
+  l.rows = rows;
+  l.xStep = xStep;
+  l.yStep = yStep;
+  return l;
+}
+
+} // namespace
+
+class TestLosslessCodec : public QObject {
+  Q_OBJECT
+private slots:
+
+  void layout_follows_pixel_format() {
+    LosslessCodec::Layout l;
+    QVERIFY(LosslessCodec::layoutFor(PixelFormats::kMono8, 640, 480, &l));
+    QCOMPARE(l.bytesPerSample, 1);
+    QCOMPARE(l.samplesPerRow, 640);
+    QCOMPARE(l.rows, 480);
+    QCOMPARE(l.xStep, 1);
+    QCOMPARE(l.yStep, 1);
+
+    QVERIFY(LosslessCodec::layoutFor(PixelFormats::kMono12, 640, 480, &l));
+    QCOMPARE(l.bytesPerSample, 2);
+    QCOMPARE(l.samplesPerRow, 640);
+
+    // BayerRG8 / BayerRG12：同颜色左右隔一个、上下隔一行
+    QVERIFY(LosslessCodec::layoutFor(0x01080009, 640, 480, &l));
+    QCOMPARE(l.xStep, 2);
+    QCOMPARE(l.yStep, 2);
+    QVERIFY(LosslessCodec::layoutFor(0x01100011, 640, 480, &l));
+    QCOMPARE(l.bytesPerSample, 2);
+    QCOMPARE(l.xStep, 2);
+
+    // 打包格式按字节，两个像素 3 字节
+    QVERIFY(
+        LosslessCodec::layoutFor(PixelFormats::kMono12Packed, 640, 480, &l));
+    QCOMPARE(l.bytesPerSample, 1);
+    QCOMPARE(l.samplesPerRow, 960);
+    QCOMPARE(l.xStep, 3);
+    // 宽度为奇数时一行不是整字节
+    QVERIFY(
+        !LosslessCodec::layoutFor(PixelFormats::kMono12Packed, 641, 480, &l));
+
+    QVERIFY(LosslessCodec::layoutFor(PixelFormats::kBgr8, 640, 480, &l));
+    QCOMPARE(l.samplesPerRow, 1920);
+    QCOMPARE(l.xStep, 3);
+
+    QVERIFY(!LosslessCodec::layoutFor(0x12345678, 640, 480, &l));
+    QVERIFY(!LosslessCodec::layoutFor(PixelFormats::kMono8, 0, 480, &l));
+
+    // 表里每个格式在常见尺寸下都能排列
+    for (const PixelFormats::Descriptor &d : PixelFormats::kTable)
+      QVERIFY2(LosslessCodec::layoutFor(d.pixelType, 2448, 2048, &l), d.name);
+  }
+
+  void round_trip_data() {
+    QTest::addColumn<int>("bps");
+    QTest::addColumn<int>("samples");
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("xStep");
+    QTest::addColumn<int>("yStep");
+    QTest::addColumn<int>("content");
+    QTest::addColumn<int>("workers");
+    const int contents[] = {Flat, Noise, Gradient, Jumps, FullRandom};
+    const char *names[] = {"平坦", "噪声", "渐变", "跳变", "全随机"};
+    for (int c = 0; c < 5; ++c) {
+      for (int workers : {0, 3}) {
+        QTest::addRow("Mono8 %s %d 线程", names[c], workers)
+            << 1 << 333 << 200 << 1 << 1 << contents[c] << workers;
+        QTest::addRow("Bayer16 %s %d 线程", names[c], workers)
+            << 2 << 130 << 131 << 2 << 2 << contents[c] << workers;
+      }
+      QTest::addRow("RGB8 %s", names[c])
+          << 1 << 3 * 97 << 65 << 3 << 1 << contents[c] << 0;
+      // 比一块还窄、只有一行
+      QTest::addRow("窄 %s", names[c])
+          << 1 << 5 << 1 << 1 << 1 << contents[c] << 0;
+    }
+  }
+
+  void round_trip() {
+    QFETCH(int, bps);
+    QFETCH(int, samples);
+    QFETCH(int, rows);
+    QFETCH(int, xStep);
+    QFETCH(int, yStep);
+    QFETCH(int, content);
+    QFETCH(int, workers);
+    const LosslessCodec::Layout l = layout(bps, samples, rows, xStep, yStep);
+    const std::vector<uint8_t> frame =
+        makeFrame(l, static_cast<Content>(content), 5);
+
+    TilePool pool(workers);
+    LosslessCodec::Encoder encoder;
+    QVERIFY(encoder.configure(l));
+    const std::size_t bytes = encoder.encode(frame.data(), &pool);
+    QCOMPARE(bytes, encoder.encodedBytes());
+    QVERIFY(bytes <= LosslessCodec::maxEncodedBytes(l));
+    const std::vector<uint8_t> stream = concat(encoder);
+    QCOMPARE(stream.size(), bytes);
+
+    std::vector<uint8_t> decoded(l.frameBytes(), 0xcd);
+    QVERIFY(LosslessCodec::decode(l, stream.data(), stream.size(),
+                                  decoded.data(), &pool));
+    QVERIFY(decoded == frame);
+    // 单线程解码结果相同
+    std::fill(decoded.begin(), decoded.end(), 0);
+    QVERIFY(LosslessCodec::decode(l, stream.data(), stream.size(),
+                                  decoded.data()));
+    QVERIFY(decoded == frame);
+
+    if (content == Flat && l.frameBytes() > 10000)
+      QVERIFY(bytes * 30 < l.frameBytes());
+    if (content == Noise && l.frameBytes() > 10000)
+      QVERIFY(bytes * 2 < l.frameBytes());
+  }
+
+  void pool_does_not_change_the_stream() {
+    const LosslessCodec::Layout l = layout(1, 1000, 700, 2, 2);
+    const std::vector<uint8_t> frame = makeFrame(l, Noise, 9);
+    LosslessCodec::Encoder serial;
+    LosslessCodec::Encoder parallel;
+    QVERIFY(serial.configure(l));
+    QVERIFY(parallel.configure(l));
+    TilePool pool(4);
+    serial.encode(frame.data(), nullptr);
+    parallel.encode(frame.data(), &pool);
+    QVERIFY(concat(serial) == concat(parallel));
+    // 同一编码器连续编码：上一帧的暂存不影响下一帧
+    const std::vector<uint8_t> flat = makeFrame(l, Flat, 1);
+    parallel.encode(flat.data(), &pool);
+    serial.encode(flat.data(), nullptr);
+    QVERIFY(concat(serial) == concat(parallel));
+  }
+
+  void incompressible_strips_are_stored_raw() {
+    const LosslessCodec::Layout l = layout(1, 512, 256, 1, 1);
+    const std::vector<uint8_t> frame = makeFrame(l, FullRandom, 3);
+    LosslessCodec::Encoder encoder;
+    QVERIFY(encoder.configure(l));
+    const std::size_t bytes = encoder.encode(frame.data());
+    QCOMPARE(bytes, LosslessCodec::maxEncodedBytes(l));
+    // 原样存的条带直接指向输入帧，不拷贝
+    QCOMPARE(encoder.pieces().size(), std::size_t(1 + 256 / 64));
+    QVERIFY(encoder.pieces()[1].data == frame.data());
+  }
+
+  void corrupt_streams_are_rejected() {
+    const LosslessCodec::Layout l = layout(1, 300, 150, 1, 1);
+    const std::vector<uint8_t> frame = makeFrame(l, Noise, 4);
+    LosslessCodec::Encoder encoder;
+    QVERIFY(encoder.configure(l));
+    encoder.encode(frame.data());
+    const std::vector<uint8_t> stream = concat(encoder);
+    std::vector<uint8_t> out(l.frameBytes());
+
+    // 截断
+    QVERIFY(!LosslessCodec::decode(l, stream.data(), 10, out.data()));
+    QVERIFY(!LosslessCodec::decode(l, stream.data(), stream.size() - 1,
+                                   out.data()));
+    // 与 layout 不符
+    LosslessCodec::Layout other = l;
+    other.rows = 151;
+    QVERIFY(!LosslessCodec::decode(other, stream.data(), stream.size(),
+                                   out.data()));
+    // 条带表指到码流外
+    std::vector<uint8_t> bad = stream;
+    const uint32_t huge = 0x7fffffff;
+    std::memcpy(bad.data() + 24, &huge, 4);
+    QVERIFY(!LosslessCodec::decode(l, bad.data(), bad.size(), out.data()));
+
+    // 随机改字节：结果可以不对，但不能越界 / 崩溃
+    std::mt19937 rng(8);
+    for (int i = 0; i < 200; ++i) {
+      bad = stream;
+      bad[rng() % bad.size()] ^= uint8_t(1 + rng() % 255);
+      LosslessCodec::decode(l, bad.data(), bad.size(), out.data());
+    }
+  }
+};
+
+QTEST_GUILESS_MAIN(TestLosslessCodec)
+#include "test_lossless_codec.moc"
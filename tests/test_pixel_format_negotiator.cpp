@@ -0,0 +1,135 @@
+// PixelFormatNegotiator 单元测试：按用途挑代价最小的像素格式、录制写入格式、
+// 彩色录制不退到黑白、带宽高时改选不用转换的格式
+#include "utils/PixelFormatNegotiator.h"
+
+#include <QtTest>
+
+namespace {
+
+using namespace PixelFormatNegotiator;
+
+constexpr uint32_t kMono12 = 0x01100005;
+constexpr uint32_t kMono12Packed = 0x010C0006;
+constexpr uint32_t kBayerRG8 = 0x01080009;
+constexpr uint32_t kBayerRG12Packed = 0x010C002B;
+constexpr uint32_t kRgb8 = 0x02180014;
+constexpr uint32_t kYuv422 = 0x0210001F;
+
+Input input(std::vector<uint32_t> supported, uint32_t current,
+            Workflow workflow) {
+  Input in;
+  in.supported = std::move(supported);
+  in.current = current;
+  in.width = 2448;
+  in.height = 2048;
+  in.workflow = workflow;
+  return in;
+}
+
+} // namespace
+
+class TestPixelFormatNegotiator : public QObject {
+  Q_OBJECT
+private slots:
+
+  void mono_recording_on_bayer_camera_converts_to_mono8() {
+    // 相机只能出 Bayer：转 Mono8 比去马赛克转 BGR8 便宜
+    const Choice c = negotiate(
+        input({kBayerRG8, kBayerRG12Packed}, kBayerRG12Packed,
+              Workflow::MonoRecording));
+    QCOMPARE(c.pixelType, kBayerRG8);
+    QCOMPARE(c.recordPixelType, kMono8);
+    QVERIFY(c.needsConvert());
+    const Choice bgr = evaluate(kBayerRG8, Workflow::ColorRecording, 2448,
+                                2048, 0.0);
+    QCOMPARE(bgr.recordPixelType, kBgr8);
+    QVERIFY(c.convertUsPerFrame < bgr.convertUsPerFrame);
+  }
+
+  void mono_recording_prefers_camera_side_mono8() {
+    // 彩色相机自己能出 Mono8：零转换、带宽最小
+    const Choice c = negotiate(input({kBayerRG8, kMono8, kRgb8}, kBayerRG8,
+                                     Workflow::MonoRecording));
+    QCOMPARE(c.pixelType, kMono8);
+    QVERIFY(!c.needsConvert());
+    QCOMPARE(c.convertUsPerFrame, 0.0);
+    QCOMPARE(c.bytesPerFrame, 2448.0 * 2048);
+
+    // 黑白相机：Mono8 比 Mono12 省拆包和一半带宽
+    QCOMPARE(negotiate(input({kMono8, kMono12}, kMono12,
+                             Workflow::MonoRecording))
+                 .pixelType,
+             kMono8);
+  }
+
+  void color_recording_never_falls_back_to_mono() {
+    Choice c = negotiate(input({kMono8, kBayerRG8, kRgb8}, kMono8,
+                               Workflow::ColorRecording));
+    QVERIFY(c.pixelType != kMono8);
+    // 千兆网：Bayer 传 1 字节 / 像素再插值，比传 3 字节的 RGB8 快
+    QCOMPARE(c.pixelType, kBayerRG8);
+    QCOMPARE(c.recordPixelType, kBgr8);
+
+    // 万兆网：传输不再是瓶颈，直接录的 RGB8 省掉插值
+    Input fast = input({kMono8, kBayerRG8, kRgb8}, kMono8,
+                       Workflow::ColorRecording);
+    fast.linkBytesPerSec = 1.18e9;
+    c = negotiate(fast);
+    QCOMPARE(c.pixelType, kRgb8);
+    QVERIFY(!c.needsConvert());
+
+    // 黑白相机录彩色：只能录 Mono8
+    c = negotiate(input({kMono8, kMono12}, kMono12, Workflow::ColorRecording));
+    QCOMPARE(c.pixelType, kMono8);
+    QCOMPARE(c.recordPixelType, kMono8);
+  }
+
+  void high_depth_recording_keeps_bit_depth() {
+    // Mono8 最便宜，但高位深录制只在 10/12 位里选：千兆网上打包格式少传 1/4
+    Choice c =
+        negotiate(input({kMono8, kMono12, kMono12Packed, kBayerRG12Packed},
+                        kMono8, Workflow::HighDepthRecording));
+    QCOMPARE(c.pixelType, kMono12Packed);
+    QCOMPARE(c.recordPixelType, kMono8);
+
+    // 链路够快时不必付拆包的开销
+    Input fast = input({kMono12, kMono12Packed}, kMono12Packed,
+                       Workflow::HighDepthRecording);
+    fast.linkBytesPerSec = 10e9;
+    QCOMPARE(negotiate(fast).pixelType, kMono12);
+
+    // 没有黑白高位深格式时退到 Bayer 高位深；都没有时照常选 8 位
+    c = negotiate(input({kBayerRG8, kBayerRG12Packed}, kBayerRG8,
+                        Workflow::HighDepthRecording));
+    QCOMPARE(c.pixelType, kBayerRG12Packed);
+    c = negotiate(input({kMono8, kRgb8}, kRgb8, Workflow::HighDepthRecording));
+    QCOMPARE(c.pixelType, kMono8);
+  }
+
+  void record_pixel_type_follows_workflow() {
+    QCOMPARE(recordPixelType(kBayerRG8, Workflow::Preview), kBgr8);
+    QCOMPARE(recordPixelType(kMono8, Workflow::Preview), kMono8);
+    QCOMPARE(recordPixelType(kYuv422, Workflow::ColorRecording), kYuv422);
+    QCOMPARE(recordPixelType(kRgb8, Workflow::MonoRecording), kMono8);
+    QCOMPARE(recordPixelType(kMono12, Workflow::ColorRecording), kMono8);
+  }
+
+  void unknown_formats_are_skipped_and_ties_keep_current() {
+    const uint32_t unknown = 0x81000000;
+    Choice c = negotiate(input({unknown}, unknown, Workflow::Preview));
+    QVERIFY(!c.valid());
+
+    // 没读到可选值时只评估当前格式
+    c = negotiate(input({}, kBayerRG8, Workflow::MonoRecording));
+    QCOMPARE(c.pixelType, kBayerRG8);
+
+    // BayerRG8 / BayerGR8 代价相同：保留当前的
+    const uint32_t kBayerGR8 = 0x01080008;
+    c = negotiate(input({kBayerRG8, kBayerGR8}, kBayerGR8,
+                        Workflow::ColorRecording));
+    QCOMPARE(c.pixelType, kBayerGR8);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestPixelFormatNegotiator)
+#include "test_pixel_format_negotiator.moc"
@@ -0,0 +1,159 @@
+// PixelUnpack 单元测试：手工打包的已知字节解出原值、非打包格式屏蔽高位、
+// 奇数像素数的尾巴、SSE2 / AVX2 与标量逐字节一致，以及 PixelFormats 描述表
+#include "utils/PixelFormats.h"
+#include "utils/PixelUnpack.h"
+
+#include <QtTest>
+#include <random>
+#include <vector>
+
+using namespace PixelUnpack;
+
+namespace {
+
+// 按 GigE Vision 的打包规则把 LSB 对齐的采样打成两像素 3 字节
+std::vector<uint8_t> pack(const std::vector<uint16_t> &pixels, int bits) {
+  const int shift = bits - 8;
+  const unsigned low = (1u << shift) - 1;
+  std::vector<uint8_t> out((pixels.size() * 3 + 1) / 2);
+  for (std::size_t i = 0; i < pixels.size(); i += 2) {
+    uint8_t *p = out.data() + i / 2 * 3;
+    p[0] = uint8_t(pixels[i] >> shift);
+    p[1] = uint8_t(pixels[i] & low);
+    if (i + 1 < pixels.size()) {
+      p[1] |= uint8_t((pixels[i + 1] & low) << 4);
+      p[2] = uint8_t(pixels[i + 1] >> shift);
+    }
+  }
+  return out;
+}
+
+std::vector<uint16_t> randomSamples(std::size_t n, int bits, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint16_t> v(n);
+  for (uint16_t &s : v)
+    s = uint16_t(rng() & ((1u << bits) - 1));
+  return v;
+}
+
+// 小端 16 位容器，高位填满垃圾：解包时必须屏蔽
+std::vector<uint8_t> widen(const std::vector<uint16_t> &pixels, int bits) {
+  std::vector<uint8_t> out(pixels.size() * 2);
+  for (std::size_t i = 0; i < pixels.size(); ++i) {
+    const unsigned v = pixels[i] | (bits < 16 ? 0xFFFFu << bits : 0u);
+    out[2 * i] = uint8_t(v);
+    out[2 * i + 1] = uint8_t(v >> 8);
+  }
+  return out;
+}
+
+} // namespace
+
+class TestPixelUnpack : public QObject {
+  Q_OBJECT
+private slots:
+
+  void descriptor_table() {
+    using namespace PixelFormats;
+    QVERIFY(find(kMono8)->recordable);
+    QVERIFY(!find(kMono12Packed)->recordable);
+    QCOMPARE(find(kMono12Packed)->bitsPerPixel, 12);
+    QCOMPARE(find(kMono10)->sampleBits, 10);
+    QVERIFY(find(0x010C002B)->bayer == BayerOrder::RG);
+    QVERIFY(find(0xDEADBEEF) == nullptr);
+    QVERIFY(isHighBitDepth(kMono16));
+    QVERIFY(!isHighBitDepth(kBgr8));
+    QCOMPARE(frameBytes(kMono10Packed, 5, 1), std::size_t(8));
+    QCOMPARE(frameBytes(kMono12, 4, 3), std::size_t(24));
+
+    QVERIFY(canUnpack(kMono12Packed));
+    QVERIFY(canUnpack(0x01100011)); // BayerRG12
+    QVERIFY(!canUnpack(kMono8));
+    QVERIFY(!canUnpack(kBgr8));
+  }
+
+  void known_packed_bytes() {
+    // Mono12Packed：0xABC、0x123 → AB 3C 12
+    const uint8_t mono12[] = {0xAB, 0x3C, 0x12};
+    uint16_t out[2] = {};
+    QVERIFY(toU16(mono12, sizeof(mono12), PixelFormats::kMono12Packed, 2, 1,
+                  out, Isa::Scalar));
+    QCOMPARE(out[0], uint16_t(0xABC));
+    QCOMPARE(out[1], uint16_t(0x123));
+
+    // Mono10Packed：0x2A5 (1010100101)、0x0FE (0011111110) → A9 21 3F
+    const uint8_t mono10[] = {0xA9, 0x21, 0x3F};
+    QVERIFY(toU16(mono10, sizeof(mono10), PixelFormats::kMono10Packed, 2, 1,
+                  out, Isa::Scalar));
+    QCOMPARE(out[0], uint16_t(0x2A5));
+    QCOMPARE(out[1], uint16_t(0x0FE));
+
+    uint8_t high[2] = {};
+    QVERIFY(toU8(mono12, sizeof(mono12), PixelFormats::kMono12Packed, 2, 1,
+                 high, Isa::Scalar));
+    QCOMPARE(high[0], uint8_t(0xAB));
+    QCOMPARE(high[1], uint8_t(0x12));
+  }
+
+  void round_trip_all_layouts_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    // 宽度覆盖向量整块、行尾余数和奇数像素数
+    QTest::newRow("Mono12Packed 64x4") << uint(0x010C0006) << 64 << 4;
+    QTest::newRow("Mono12Packed 37x3") << uint(0x010C0006) << 37 << 3;
+    QTest::newRow("Mono10Packed 61x5") << uint(0x010C0004) << 61 << 5;
+    QTest::newRow("BayerRG12Packed 48x2") << uint(0x010C002B) << 48 << 2;
+    QTest::newRow("Mono12 33x3") << uint(0x01100005) << 33 << 3;
+    QTest::newRow("Mono10 17x1") << uint(0x01100003) << 17 << 1;
+    QTest::newRow("Mono16 40x2") << uint(0x01100007) << 40 << 2;
+    QTest::newRow("BayerGR10 24x2") << uint(0x0110000C) << 24 << 2;
+  }
+
+  void round_trip_all_layouts() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    const PixelFormats::Descriptor *d = PixelFormats::find(pixelType);
+    QVERIFY(d);
+    const std::vector<uint16_t> samples = randomSamples(
+        std::size_t(width) * height, d->sampleBits, pixelType ^ width);
+    const std::vector<uint8_t> raw =
+        d->packing == PixelFormats::Packing::Packed
+            ? pack(samples, d->sampleBits)
+            : widen(samples, d->sampleBits);
+    QCOMPARE(raw.size(), PixelFormats::frameBytes(pixelType, width, height));
+
+    for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+      if (!CpuFeatures::isSupported(isa))
+        continue;
+      std::vector<uint16_t> out(samples.size(), 0xCDCD);
+      QVERIFY(toU16(raw.data(), raw.size(), pixelType, width, height,
+                    out.data(), isa));
+      QVERIFY2(out == samples, CpuFeatures::name(isa));
+
+      std::vector<uint8_t> high(samples.size(), 0xCD);
+      QVERIFY(toU8(raw.data(), raw.size(), pixelType, width, height,
+                   high.data(), isa));
+      bool same = true;
+      for (std::size_t i = 0; i < samples.size(); ++i)
+        same = same && high[i] == uint8_t(samples[i] >> (d->sampleBits - 8));
+      QVERIFY2(same, CpuFeatures::name(isa));
+    }
+  }
+
+  void rejects_short_or_unsupported_input() {
+    std::vector<uint8_t> raw(15);
+    std::vector<uint16_t> out(16);
+    // 16 像素 Mono12Packed 要 24 字节
+    QVERIFY(!toU16(raw.data(), raw.size(), PixelFormats::kMono12Packed, 16, 1,
+                   out.data()));
+    QVERIFY(!toU16(raw.data(), raw.size(), PixelFormats::kMono8, 4, 1,
+                   out.data()));
+    QVERIFY(!toU16(raw.data(), raw.size(), PixelFormats::kMono12, 0, 1,
+                   out.data()));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestPixelUnpack)
+#include "test_pixel_unpack.moc"
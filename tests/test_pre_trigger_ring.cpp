@@ -0,0 +1,109 @@
+// PreTriggerRing 单元测试：按秒数 / 预算定槽位、满后覆盖最旧帧、
+// 录制交接时历史在前新帧在后且不缺帧、超尺寸帧拒收
+#include "utils/PreTriggerRing.h"
+
+#include <QtTest>
+#include <cstring>
+
+namespace {
+
+constexpr int64_t kMs = 1'000'000;
+
+FrameRef makeFrame(FramePool &pool, uint32_t frameNum, std::size_t bytes = 64) {
+  FrameRef frame = pool.acquire();
+  std::memset(frame.writableData(), static_cast<int>(frameNum & 0xFF), bytes);
+  frame.writableInfo().frameLen = bytes;
+  frame.writableInfo().frameNum = frameNum;
+  frame.writableInfo().grabTimeNs = int64_t(frameNum) * 10 * kMs;
+  return frame;
+}
+
+} // namespace
+
+class TestPreTriggerRing : public QObject {
+  Q_OBJECT
+private slots:
+
+  void slots_follow_seconds_and_budget() {
+    QCOMPARE(PreTriggerRing::slotsFor(2.0, 100.0, 0, 1000), std::size_t(200));
+    QCOMPARE(PreTriggerRing::slotsFor(2.5, 30.0, 0, 1000), std::size_t(75));
+    // 预算截断
+    QCOMPARE(PreTriggerRing::slotsFor(10.0, 100.0, 50 * 1000, 1000),
+             std::size_t(50));
+    QCOMPARE(PreTriggerRing::slotsFor(0.0, 100.0, 0, 1000), std::size_t(0));
+    QCOMPARE(PreTriggerRing::slotsFor(2.0, 0.0, 0, 1000), std::size_t(0));
+  }
+
+  void full_ring_overwrites_oldest() {
+    FramePool source;
+    QVERIFY(source.configure(1, 64));
+    PreTriggerRing ring;
+    QVERIFY(ring.configure(4, 64));
+
+    for (uint32_t n = 0; n < 10; ++n)
+      QVERIFY(ring.push(makeFrame(source, n)));
+    // 源池只有 1 块：环里不持有源缓冲
+    QCOMPARE(source.inUse(), std::size_t(0));
+    QCOMPARE(ring.size(), std::size_t(4));
+    QCOMPARE(ring.overwritten(), uint64_t(6));
+    QCOMPARE(ring.spanNs(), 30 * kMs);
+
+    for (uint32_t n = 6; n < 10; ++n) {
+      const FrameRef frame = ring.pop();
+      QCOMPARE(frame.info().frameNum, n);
+      QCOMPARE(frame.data()[0], (unsigned char)n);
+    }
+    QVERIFY(ring.empty());
+    QVERIFY(!ring.pop());
+  }
+
+  void handoff_writes_history_then_live_without_gap() {
+    FramePool source;
+    QVERIFY(source.configure(1, 64));
+    PreTriggerRing ring;
+    QVERIFY(ring.configure(8, 64));
+    uint32_t n = 0;
+    for (; n < 20; ++n)
+      ring.push(makeFrame(source, n));
+
+    // 与 CameraController::recordFrame 相同：每来一帧先补写至多 3 帧，
+    // 新帧排到环尾，环写空后直接写
+    std::vector<uint32_t> written;
+    for (; n < 40; ++n) {
+      const FrameRef live = makeFrame(source, n);
+      if (ring.empty()) {
+        written.push_back(live.info().frameNum);
+        continue;
+      }
+      for (int i = 0; i < 3 && !ring.empty(); ++i)
+        written.push_back(ring.pop().info().frameNum);
+      QVERIFY(ring.append(live));
+    }
+    while (!ring.empty())
+      written.push_back(ring.pop().info().frameNum);
+
+    QCOMPARE(written.size(), std::size_t(40 - 12));
+    for (std::size_t i = 0; i < written.size(); ++i)
+      QCOMPARE(written[i], uint32_t(12 + i));
+  }
+
+  void append_does_not_overwrite_and_oversize_is_rejected() {
+    FramePool source;
+    QVERIFY(source.configure(1, 128));
+    PreTriggerRing ring;
+    QVERIFY(ring.configure(2, 64));
+    QVERIFY(ring.append(makeFrame(source, 0)));
+    QVERIFY(ring.append(makeFrame(source, 1)));
+    QVERIFY(!ring.append(makeFrame(source, 2)));
+    QCOMPARE(ring.overwritten(), uint64_t(0));
+    QVERIFY(!ring.push(makeFrame(source, 3, 128)));
+    QCOMPARE(ring.size(), std::size_t(2));
+
+    // pop 出去的帧还被持有时不能重新配置
+    const FrameRef held = ring.pop();
+    QVERIFY(!ring.configure(4, 64));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestPreTriggerRing)
+#include "test_pre_trigger_ring.moc"
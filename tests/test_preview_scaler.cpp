@@ -0,0 +1,275 @@
+// PreviewScaler 单元测试：裁剪 / 倍数计算（含 Bayer 对齐）、手算的平均值与
+// 四舍五入、Bayer 超像素颜色、与朴素实现一致，以及 SSE2 / AVX2 与标量逐字节一致
+#include "utils/PixelFormats.h"
+#include "utils/PreviewScaler.h"
+
+#include <QtTest>
+#include <random>
+#include <vector>
+
+using namespace PreviewScaler;
+
+namespace {
+
+constexpr uint32_t kBayerRG8 = 0x01080009;
+constexpr uint32_t kBayerGR8 = 0x01080008;
+constexpr uint32_t kBayerGB8 = 0x0108000A;
+constexpr uint32_t kBayerBG8 = 0x0108000B;
+
+std::vector<uint8_t> randomBytes(std::size_t n, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> v(n);
+  for (uint8_t &b : v)
+    b = uint8_t(rng());
+  return v;
+}
+
+// 朴素参考：逐块逐通道求和再做整数除法
+std::vector<uint8_t> referencePlanar(const std::vector<uint8_t> &src,
+                                     int width, int channels,
+                                     const Plan &plan) {
+  const int k = plan.factor;
+  const unsigned n = unsigned(k) * k;
+  std::vector<uint8_t> out;
+  for (int oy = 0; oy < plan.outHeight; ++oy)
+    for (int ox = 0; ox < plan.outWidth; ++ox)
+      for (int c = 0; c < channels; ++c) {
+        unsigned sum = 0;
+        for (int y = 0; y < k; ++y)
+          for (int x = 0; x < k; ++x)
+            sum += src[(std::size_t(plan.source.y + oy * k + y) * width +
+                        plan.source.x + ox * k + x) *
+                           channels +
+                       c];
+        out.push_back(uint8_t((sum + n / 2) / n));
+      }
+  return out;
+}
+
+// 每个 2x2 单元填同一组 R / G / B
+std::vector<uint8_t> mosaic(int width, int height, uint32_t pixelType,
+                            uint8_t r, uint8_t g, uint8_t b) {
+  const PixelFormats::BayerOrder order = PixelFormats::find(pixelType)->bayer;
+  // 与 PixelFormats::BayerOrder 对应的 (0,0)、(0,1)、(1,0)、(1,1) 颜色
+  uint8_t cell[4];
+  switch (order) {
+  case PixelFormats::BayerOrder::RG:
+    cell[0] = r, cell[1] = g, cell[2] = g, cell[3] = b;
+    break;
+  case PixelFormats::BayerOrder::GR:
+    cell[0] = g, cell[1] = r, cell[2] = b, cell[3] = g;
+    break;
+  case PixelFormats::BayerOrder::GB:
+    cell[0] = g, cell[1] = b, cell[2] = r, cell[3] = g;
+    break;
+  default:
+    cell[0] = b, cell[1] = g, cell[2] = g, cell[3] = r;
+    break;
+  }
+  std::vector<uint8_t> raw(std::size_t(width) * height);
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x)
+      raw[std::size_t(y) * width + x] = cell[(y & 1) * 2 + (x & 1)];
+  return raw;
+}
+
+} // namespace
+
+class TestPreviewScaler : public QObject {
+  Q_OBJECT
+private slots:
+
+  void plan_picks_factor_and_crop() {
+    // 20 MP 缩到 1368x912 窗口：4 倍，输出正好等于窗口
+    Plan p = plan(PixelFormats::kMono8, 5472, 3648, {}, 1368, 912);
+    QCOMPARE(p.factor, 4);
+    QCOMPARE(p.outWidth, 1368);
+    QCOMPARE(p.outHeight, 912);
+    QVERIFY(!p.passthrough);
+    QCOMPARE(outputBytes(p), std::size_t(1368) * 912);
+
+    // 窗口比图像大：整帧原样显示
+    p = plan(PixelFormats::kMono8, 640, 480, {}, 1280, 960);
+    QVERIFY(p.passthrough);
+    QCOMPARE(p.factor, 1);
+
+    // 取两个方向里较小的倍数，输出不小于窗口
+    p = plan(PixelFormats::kBgr8, 1000, 1000, {}, 300, 450);
+    QCOMPARE(p.factor, 2);
+    QCOMPARE(p.outWidth, 500);
+    QCOMPARE(outputBytes(p), std::size_t(500) * 500 * 3);
+
+    // 放大显示：只裁剪可见区域，超出图像的部分裁掉
+    p = plan(PixelFormats::kMono8, 1000, 800, {900, 700, 300, 300}, 400, 400);
+    QCOMPARE(p.factor, 1);
+    QCOMPARE(p.source.x, 900);
+    QCOMPARE(p.source.width, 100);
+    QCOMPARE(p.source.height, 100);
+    QVERIFY(!p.passthrough);
+
+    // 可见区域整个在图像外：退回整帧
+    p = plan(PixelFormats::kMono8, 100, 100, {200, 200, 10, 10}, 50, 50);
+    QCOMPARE(p.source.width, 100);
+    QCOMPARE(p.factor, 2);
+
+    // 不支持的格式原样显示
+    p = plan(PixelFormats::kMono12, 5472, 3648, {}, 640, 480);
+    QVERIFY(p.passthrough);
+    QVERIFY(!canScale(PixelFormats::kMono12));
+    QVERIFY(!canScale(0x0210001F)); // YUV422
+  }
+
+  void plan_keeps_bayer_alignment() {
+    // 奇数起点往前对齐，宽高取偶数，排列不变
+    Plan p = plan(kBayerRG8, 1000, 800, {101, 51, 301, 201}, 1000, 1000);
+    QCOMPARE(p.source.x, 100);
+    QCOMPARE(p.source.y, 50);
+    QCOMPARE(p.source.width, 302);
+    QCOMPARE(p.source.height, 202);
+    QCOMPARE(p.factor, 1);
+    QCOMPARE(p.outPixelType, kBayerRG8);
+
+    // 3 倍退成 2 倍，输出 BGR8
+    p = plan(kBayerRG8, 1200, 900, {}, 400, 300);
+    QCOMPARE(p.factor, 2);
+    QCOMPARE(p.outPixelType, PixelFormats::kBgr8);
+    QCOMPARE(p.outWidth, 600);
+    QCOMPARE(outputBytes(p), std::size_t(600) * 450 * 3);
+  }
+
+  void averages_and_rounds_half_up() {
+    // 4x2 Mono8，2 倍：(0+1+0+0)/4 = 0.25 → 0，(1+1+0+0)/4 = 0.5 → 1
+    const uint8_t mono[] = {0, 1, 1, 1, 0, 0, 0, 0};
+    Plan p = plan(PixelFormats::kMono8, 4, 2, {}, 2, 1);
+    QCOMPARE(p.factor, 2);
+    uint8_t out[2] = {0xCD, 0xCD};
+    QVERIFY(scale(mono, sizeof(mono), PixelFormats::kMono8, 4, 2, p, out,
+                  Isa::Scalar));
+    QCOMPARE(out[0], uint8_t(0));
+    QCOMPARE(out[1], uint8_t(1));
+
+    // BGR8 每个通道各自平均
+    const uint8_t bgr[] = {10, 20, 255, 30, 40, 255, //
+                           50, 60, 254, 70, 80, 255};
+    p = plan(PixelFormats::kBgr8, 2, 2, {}, 1, 1);
+    uint8_t pixel[3] = {};
+    QVERIFY(scale(bgr, sizeof(bgr), PixelFormats::kBgr8, 2, 2, p, pixel,
+                  Isa::Scalar));
+    QCOMPARE(pixel[0], uint8_t(40));
+    QCOMPARE(pixel[1], uint8_t(50));
+    QCOMPARE(pixel[2], uint8_t(255)); // 254.75 → 255
+  }
+
+  void bayer_superpixel_colors_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("factor");
+    QTest::newRow("RG 2x") << uint(kBayerRG8) << 2;
+    QTest::newRow("GR 4x") << uint(kBayerGR8) << 4;
+    QTest::newRow("GB 2x") << uint(kBayerGB8) << 2;
+    QTest::newRow("BG 6x") << uint(kBayerBG8) << 6;
+  }
+
+  void bayer_superpixel_colors() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, factor);
+    const int width = 48, height = 36;
+    const std::vector<uint8_t> raw = mosaic(width, height, pixelType, 200, 100,
+                                            30);
+    const Plan p = plan(pixelType, width, height, {}, width / factor,
+                        height / factor);
+    QCOMPARE(p.factor, factor);
+    QCOMPARE(p.outPixelType, PixelFormats::kBgr8);
+    std::vector<uint8_t> out(outputBytes(p));
+    for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+      if (!CpuFeatures::isSupported(isa))
+        continue;
+      QVERIFY(scale(raw.data(), raw.size(), pixelType, width, height, p,
+                    out.data(), isa));
+      bool same = true;
+      for (std::size_t i = 0; i < out.size(); i += 3)
+        same = same && out[i] == 30 && out[i + 1] == 100 && out[i + 2] == 200;
+      QVERIFY2(same, CpuFeatures::name(isa));
+    }
+
+    // 放大显示：只裁剪，仍是同一排列的 Bayer
+    const Plan crop = plan(pixelType, width, height, {5, 3, 10, 6}, 40, 40);
+    QCOMPARE(crop.outPixelType, uint32_t(pixelType));
+    std::vector<uint8_t> cropped(outputBytes(crop));
+    QVERIFY(scale(raw.data(), raw.size(), pixelType, width, height, crop,
+                  cropped.data()));
+    QCOMPARE(cropped[0], raw[std::size_t(2) * width + 4]);
+    QCOMPARE(cropped[1], raw[std::size_t(2) * width + 5]);
+  }
+
+  void matches_reference_on_all_isas_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("displayWidth");
+    QTest::addColumn<int>("displayHeight");
+    QTest::addColumn<int>("x");
+    QTest::addColumn<int>("y");
+    // 宽度覆盖向量整块、行尾余数和不整除的块
+    QTest::newRow("Mono8 2x") << uint(PixelFormats::kMono8) << 130 << 20 << 65
+                              << 10 << 0 << 0;
+    QTest::newRow("Mono8 3x 裁剪") << uint(PixelFormats::kMono8) << 211 << 50
+                                  << 68 << 15 << 7 << 5;
+    QTest::newRow("Mono8 64x 满量程") << uint(PixelFormats::kMono8) << 200
+                                     << 130 << 3 << 2 << 0 << 0;
+    QTest::newRow("BGR8 5x") << uint(PixelFormats::kBgr8) << 103 << 31 << 20
+                             << 6 << 0 << 0;
+    QTest::newRow("RGB8 1x 裁剪") << uint(PixelFormats::kRgb8) << 77 << 9
+                                 << 200 << 200 << 3 << 1;
+  }
+
+  void matches_reference_on_all_isas() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, displayWidth);
+    QFETCH(int, displayHeight);
+    QFETCH(int, x);
+    QFETCH(int, y);
+    const int channels = pixelType == PixelFormats::kMono8 ? 1 : 3;
+    std::vector<uint8_t> src =
+        randomBytes(std::size_t(width) * height * channels, pixelType ^ width);
+    // 满量程：验证 16 位累加器和除法在最大和上不出错
+    if (displayWidth == 3)
+      std::fill(src.begin(), src.begin() + src.size() / 2, uint8_t(255));
+    const Plan p = plan(pixelType, width, height,
+                        {x, y, width - x, height - y}, displayWidth,
+                        displayHeight);
+    QVERIFY(!p.passthrough);
+    const std::vector<uint8_t> expected =
+        referencePlanar(src, width, channels, p);
+    QCOMPARE(outputBytes(p), expected.size());
+
+    for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+      if (!CpuFeatures::isSupported(isa))
+        continue;
+      std::vector<uint8_t> out(expected.size(), 0xCD);
+      QVERIFY(scale(src.data(), src.size(), pixelType, width, height, p,
+                    out.data(), isa));
+      QVERIFY2(out == expected, CpuFeatures::name(isa));
+    }
+  }
+
+  void rejects_bad_input() {
+    std::vector<uint8_t> raw(100);
+    std::vector<uint8_t> out(100);
+    const Plan full = plan(PixelFormats::kMono8, 10, 10, {}, 20, 20);
+    QVERIFY(full.passthrough);
+    QVERIFY(!scale(raw.data(), raw.size(), PixelFormats::kMono8, 10, 10, full,
+                   out.data()));
+    // 源数据不够一帧
+    const Plan half = plan(PixelFormats::kMono8, 10, 10, {}, 5, 5);
+    QVERIFY(!scale(raw.data(), 99, PixelFormats::kMono8, 10, 10, half,
+                   out.data()));
+    // plan 与图像尺寸不符
+    QVERIFY(!scale(raw.data(), raw.size(), PixelFormats::kMono8, 6, 6, half,
+                   out.data()));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestPreviewScaler)
+#include "test_preview_scaler.moc"
@@ -0,0 +1,245 @@
+// RecordFile 单元测试：随机追加 / 预留 / 回填 / flush 与内存里的参考数据
+// 逐字节一致（普通写和直接 I/O，直接 I/O 不支持时自动退回）；预分配不改变
+// 文件大小；缓冲对齐和统计；写盘线程的错误在调用方报告；QSettings 持久化
+#include "utils/RecordFile.h"
+#include "utils/RecordFileSettings.h"
+
+#include <QFile>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+QByteArray readAll(const QString &path) {
+  QFile f(path);
+  return f.open(QIODevice::ReadOnly) ? f.readAll() : QByteArray();
+}
+
+bool sameAs(const QByteArray &file, const std::vector<uint8_t> &expect) {
+  return std::size_t(file.size()) == expect.size() &&
+         std::memcmp(file.constData(), expect.data(), expect.size()) == 0;
+}
+
+} // namespace
+
+class TestRecordFile : public QObject {
+  Q_OBJECT
+private slots:
+
+  void matches_reference_data_data() {
+    QTest::addColumn<bool>("directIo");
+    QTest::addColumn<int>("bufferCount");
+    QTest::newRow("普通写, 2 块") << false << 2;
+    QTest::newRow("普通写, 4 块") << false << 4;
+    QTest::newRow("直接 I/O, 2 块") << true << 2;
+    QTest::newRow("直接 I/O, 4 块") << true << 4;
+  }
+
+  void matches_reference_data() {
+    QFETCH(bool, directIo);
+    QFETCH(int, bufferCount);
+    QTemporaryDir dir;
+    const QString path = dir.filePath("a.bin");
+
+    RecordFile::Options o;
+    o.bufferBytes = 0; // 下限 64 KB：频繁换块，也常有跨块的追加和回填
+    o.bufferCount = bufferCount;
+    o.directIo = directIo;
+    RecordFile file;
+    QVERIFY2(file.open(path.toStdString(), o), file.error().c_str());
+    QCOMPARE(file.bufferBytes(), std::size_t(64) << 10);
+
+    std::vector<uint8_t> expect;
+    std::mt19937 rng(11);
+    auto randomBytes = [&](std::size_t n) {
+      std::vector<uint8_t> v(n);
+      for (uint8_t &b : v)
+        b = uint8_t(rng());
+      return v;
+    };
+    for (int step = 0; step < 400; ++step) {
+      switch (rng() % 6) {
+      case 0:
+      case 1: {
+        // 小到几字节、大到跨好几块缓冲
+        const std::vector<uint8_t> v =
+            randomBytes(rng() % 3 == 0 ? rng() % 200000 : rng() % 3000);
+        QVERIFY(file.append(v.data(), v.size()));
+        expect.insert(expect.end(), v.begin(), v.end());
+        break;
+      }
+      case 2: {
+        const std::size_t n = rng() % 5000;
+        QVERIFY(file.appendZeros(n));
+        expect.insert(expect.end(), n, 0);
+        break;
+      }
+      case 3: {
+        const std::size_t n = 1 + rng() % 6000;
+        uint8_t *dst = file.reserve(n);
+        QVERIFY(dst);
+        const std::vector<uint8_t> v = randomBytes(n);
+        std::memcpy(dst, v.data(), n);
+        file.commit(n);
+        expect.insert(expect.end(), v.begin(), v.end());
+        break;
+      }
+      case 4: {
+        // 回填：文件头附近、刚交出的块、当前缓冲里都会碰到
+        if (expect.empty())
+          break;
+        const std::size_t n = 1 + rng() % 64;
+        std::size_t at = rng() % 3 == 0 ? rng() % 64 : rng() % expect.size();
+        at = std::min(at, expect.size() - std::min(n, expect.size()));
+        const std::vector<uint8_t> v =
+            randomBytes(std::min(n, expect.size() - at));
+        QVERIFY(file.patch(at, v.data(), v.size()));
+        std::copy(v.begin(), v.end(), expect.begin() + at);
+        break;
+      }
+      default:
+        // 不满一块就交出：直接 I/O 下要把最后半页带进下一块
+        QVERIFY(rng() % 8 ? file.flush() : file.sync());
+        break;
+      }
+      QCOMPARE(file.pos(), uint64_t(expect.size()));
+    }
+    QVERIFY(file.sync());
+    // sync 之后别的进程能读到全部数据（直接 I/O 的补齐在末尾之后）
+    const QByteArray live = readAll(path);
+    QVERIFY(std::size_t(live.size()) >= expect.size());
+    QVERIFY(std::memcmp(live.constData(), expect.data(), expect.size()) == 0);
+
+    QVERIFY2(file.close(), file.error().c_str());
+    QVERIFY(sameAs(readAll(path), expect));
+
+    const RecordFile::Stats st = file.stats();
+    QCOMPARE(st.bytes, uint64_t(expect.size()));
+    QVERIFY(st.diskBytes >= st.bytes);
+    QVERIFY(st.writes > 0);
+    QVERIFY(st.patches > 0);
+    QVERIFY(st.highWaterBytes > 0);
+    QVERIFY(st.highWaterBytes <= st.queueCapacityBytes);
+    QCOMPARE(st.bufferCount, bufferCount);
+    QVERIFY(st.elapsedSec > 0.0);
+    QVERIFY(st.mbPerSec() > 0.0);
+    if (!directIo)
+      QVERIFY(!st.directIo);
+  }
+
+  void buffer_size_is_page_aligned_and_preallocation_keeps_size() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("b.bin");
+    RecordFile::Options o;
+    o.bufferBytes = 100000;
+    o.bufferCount = 1; // 至少两块
+    o.preallocateBytes = uint64_t(16) << 20;
+    RecordFile file;
+    QVERIFY(file.open(path.toStdString(), o));
+    QCOMPARE(file.bufferBytes(), std::size_t(102400));
+    const RecordFile::Stats opened = file.stats();
+    QCOMPARE(opened.bufferCount, 2);
+    QCOMPARE(opened.queueCapacityBytes, uint64_t(2 * 102400));
+
+    const std::vector<uint8_t> v(300000, 0x5a);
+    QVERIFY(file.append(v.data(), v.size()));
+    QVERIFY(file.close());
+    // 预分配（文件系统支持时）只占盘，关闭后文件就是实际写入的大小
+    QCOMPARE(QFile(path).size(), qint64(v.size()));
+    QVERIFY(sameAs(readAll(path), v));
+    // 关闭后统计仍有效；再关一次无害
+    QCOMPARE(file.stats().bytes, uint64_t(v.size()));
+    QVERIFY(file.close());
+  }
+
+  void reports_errors() {
+    QTemporaryDir dir;
+    RecordFile file;
+    QVERIFY(!file.open(dir.filePath("missing/a.bin").toStdString(),
+                       RecordFile::Options()));
+    QVERIFY(!file.error().empty());
+    QVERIFY(!file.isOpen());
+    QVERIFY(!file.append("x", 1));
+    QVERIFY(file.reserve(1) == nullptr);
+
+#if defined(Q_OS_LINUX)
+    // 写盘线程写失败（磁盘满）：之后的交出 / 关闭返回 false 并带上原因
+    RecordFile::Options o;
+    o.bufferBytes = 0;
+    QVERIFY(file.open("/dev/full", o));
+    const std::vector<uint8_t> v(std::size_t(1) << 20, 1);
+    bool ok = true;
+    for (int i = 0; i < 8 && ok; ++i)
+      ok = file.append(v.data(), v.size());
+    ok = file.close() && ok;
+    QVERIFY(!ok);
+    QVERIFY(file.failed());
+    QVERIFY(!file.error().empty());
+#endif
+  }
+
+  void settings_round_trip_and_clamp() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("record.ini");
+    RecordFile::Options options;
+    options.bufferBytes = std::size_t(32) << 20;
+    options.directIo = true;
+    options.preallocateBytes = uint64_t(20) << 30;
+    {
+      QSettings settings(path, QSettings::IniFormat);
+      RecordFileSettings::save(settings, options);
+    }
+    QSettings settings(path, QSettings::IniFormat);
+    RecordFile::Options loaded = RecordFileSettings::load(settings);
+    QCOMPARE(loaded.bufferBytes, options.bufferBytes);
+    QVERIFY(loaded.directIo);
+    QCOMPARE(loaded.preallocateBytes, options.preallocateBytes);
+    QCOMPARE(loaded.bufferCount, RecordFile::Options().bufferCount);
+
+    settings.setValue("recordFile/bufferMB", 1000);
+    settings.setValue("recordFile/preallocateGB", -3);
+    loaded = RecordFileSettings::load(settings);
+    QCOMPARE(loaded.bufferBytes, std::size_t(64) << 20);
+    QCOMPARE(loaded.preallocateBytes, uint64_t(0));
+    settings.setValue("recordFile/bufferMB", "abc");
+    QCOMPARE(RecordFileSettings::load(settings).bufferBytes,
+             std::size_t(8) << 20);
+    settings.setValue("recordFile/bufferMB", 1);
+    QCOMPARE(RecordFileSettings::load(settings).bufferBytes,
+             std::size_t(4) << 20);
+  }
+
+  void segment_settings_round_trip_and_clamp() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QSettings settings(dir.filePath("record.ini"), QSettings::IniFormat);
+    // 缺省不分段
+    QVERIFY(!RecordFileSettings::loadSegmentPolicy(settings).enabled());
+
+    RecordSegmenter::Policy policy;
+    policy.maxDurationNs = int64_t(30) * 60 * 1000000000;
+    policy.maxBytes = uint64_t(50) << 30;
+    RecordFileSettings::saveSegmentPolicy(settings, policy);
+    RecordSegmenter::Policy loaded =
+        RecordFileSettings::loadSegmentPolicy(settings);
+    QCOMPARE(loaded.maxDurationNs, policy.maxDurationNs);
+    QCOMPARE(loaded.maxBytes, policy.maxBytes);
+
+    settings.setValue("recordSegment/minutes", 100000);
+    settings.setValue("recordSegment/gb", -1);
+    loaded = RecordFileSettings::loadSegmentPolicy(settings);
+    QCOMPARE(loaded.maxDurationNs, int64_t(24 * 60) * 60 * 1000000000);
+    QCOMPARE(loaded.maxBytes, uint64_t(0));
+    settings.setValue("recordSegment/minutes", "abc");
+    QVERIFY(!RecordFileSettings::loadSegmentPolicy(settings).enabled());
+  }
+};
+
+QTEST_GUILESS_MAIN(TestRecordFile)
+#include "test_record_file.moc"
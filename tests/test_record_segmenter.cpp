@@ -0,0 +1,261 @@
+// RecordSegmenter 单元测试：分段文件命名；按时长 / 大小在帧边界换段；
+// 空段不换、超大帧独占一段；换段前提前准备下一段；换段失败后满一个周期再试；
+// 和 CameraController 一样提前打开下一段、边写边换 WvrWriter，各段读回
+// 首尾相接、每帧恰好出现一次
+#include "utils/PixelFormats.h"
+#include "utils/RecordSegmenter.h"
+#include "utils/WvrReader.h"
+#include "utils/WvrWriter.h"
+
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr int64_t kFrameIntervalNs = 16666667; // 60 fps
+constexpr int64_t kSecondNs = 1000000000;
+
+int64_t grabNs(int index) { return 7 * kSecondNs + index * kFrameIntervalNs; }
+
+} // namespace
+
+class TestRecordSegmenter : public QObject {
+  Q_OBJECT
+private slots:
+
+  void segment_path_numbers_files() {
+    QCOMPARE(RecordSegmenter::segmentPath("D:/data/run1.avi", 1),
+             std::string("D:/data/run1_001.avi"));
+    QCOMPARE(RecordSegmenter::segmentPath("D:\\data\\run1.wvr", 12),
+             std::string("D:\\data\\run1_012.wvr"));
+    QCOMPARE(RecordSegmenter::segmentPath("run.avi", 1234),
+             std::string("run_1234.avi"));
+    // 目录里的点不是扩展名，没有扩展名时加在末尾
+    QCOMPARE(RecordSegmenter::segmentPath("/tmp/a.b/run", 2),
+             std::string("/tmp/a.b/run_002"));
+    QCOMPARE(RecordSegmenter::segmentPath("/tmp/.avi", 2),
+             std::string("/tmp/.avi_002"));
+  }
+
+  void disabled_policy_never_rolls_over() {
+    RecordSegmenter s;
+    s.start(RecordSegmenter::Policy());
+    QVERIFY(!s.policy().enabled());
+    for (int i = 0; i < 1000; ++i) {
+      QVERIFY(!s.shouldRollOver(grabNs(i), uint64_t(i) << 30, 1 << 20));
+      s.frameWritten(uint64_t(i), grabNs(i));
+    }
+    QCOMPARE(s.current().index, 1);
+    QCOMPARE(s.current().frames, uint64_t(1000));
+  }
+
+  void rolls_over_on_duration_at_frame_boundary() {
+    RecordSegmenter::Policy policy;
+    policy.maxDurationNs = kSecondNs;
+    RecordSegmenter s;
+    s.start(policy);
+    std::vector<RecordSegmenter::Segment> done;
+    for (int i = 0; i < 200; ++i) {
+      if (s.shouldRollOver(grabNs(i), 0, 100))
+        done.push_back(s.rollOver());
+      s.frameWritten(uint64_t(500 + i), grabNs(i));
+    }
+    // 60 fps、每段 1 秒：第 60 帧距段首帧刚好满 1 秒，进下一段
+    QCOMPARE(done.size(), std::size_t(3));
+    for (std::size_t k = 0; k < done.size(); ++k) {
+      QCOMPARE(done[k].index, int(k) + 1);
+      QCOMPARE(done[k].frames, uint64_t(60));
+      QCOMPARE(done[k].firstFrameNum, uint64_t(500 + 60 * k));
+      QCOMPARE(done[k].lastFrameNum, uint64_t(500 + 60 * k + 59));
+      QCOMPARE(done[k].firstGrabNs, grabNs(int(60 * k)));
+    }
+    // 段与段首尾相接
+    QCOMPARE(s.current().index, 4);
+    QCOMPARE(s.current().firstFrameNum, done.back().lastFrameNum + 1);
+    QCOMPARE(s.current().frames, uint64_t(20));
+  }
+
+  void rolls_over_before_exceeding_size() {
+    RecordSegmenter::Policy policy;
+    policy.maxBytes = 4500;
+    RecordSegmenter s;
+    s.start(policy);
+    uint64_t segmentBytes = 0;
+    std::vector<uint64_t> perSegment;
+    for (int i = 0; i < 20; ++i) {
+      if (s.shouldRollOver(grabNs(i), segmentBytes, 1000)) {
+        perSegment.push_back(s.rollOver().frames);
+        segmentBytes = 0;
+      }
+      segmentBytes += 1000;
+      QVERIFY(segmentBytes <= policy.maxBytes);
+      s.frameWritten(uint64_t(i), grabNs(i));
+    }
+    QCOMPARE(perSegment, std::vector<uint64_t>({4, 4, 4, 4}));
+    QCOMPARE(s.current().frames, uint64_t(4));
+  }
+
+  void oversize_frame_gets_its_own_segment() {
+    RecordSegmenter::Policy policy;
+    policy.maxBytes = 100;
+    RecordSegmenter s;
+    s.start(policy);
+    // 空段永远不换：比上限还大的帧也先写进去，下一帧再换
+    QVERIFY(!s.shouldRollOver(grabNs(0), 0, 1000));
+    s.frameWritten(0, grabNs(0));
+    QVERIFY(s.shouldRollOver(grabNs(1), 1000, 1000));
+    QCOMPARE(s.rollOver().frames, uint64_t(1));
+    QVERIFY(!s.shouldRollOver(grabNs(1), 0, 1000));
+  }
+
+  void prepares_next_segment_ahead_of_rollover() {
+    RecordSegmenter::Policy policy;
+    policy.maxDurationNs = kSecondNs;
+    RecordSegmenter s;
+    s.start(policy);
+    QVERIFY(!s.shouldPrepare(grabNs(0), 0)); // 空段
+    int prepareAt = -1;
+    int rollAt = -1;
+    for (int i = 0; i < 100 && rollAt < 0; ++i) {
+      if (prepareAt < 0 && s.shouldPrepare(grabNs(i), 0))
+        prepareAt = i;
+      if (s.shouldRollOver(grabNs(i), 0, 100))
+        rollAt = i;
+      else
+        s.frameWritten(uint64_t(i), grabNs(i));
+    }
+    // 1 秒一段：提前 1/4 秒（15 帧）
+    QCOMPARE(prepareAt, 45);
+    QCOMPARE(rollAt, 60);
+
+    // 周期长时提前量封顶 5 秒
+    policy.maxDurationNs = 60 * kSecondNs;
+    s.start(policy);
+    s.frameWritten(0, grabNs(0));
+    QVERIFY(!s.shouldPrepare(grabNs(0) + 55 * kSecondNs - 1, 0));
+    QVERIFY(s.shouldPrepare(grabNs(0) + 55 * kSecondNs, 0));
+
+    // 按大小：短周期写满 3/4 时准备
+    policy = RecordSegmenter::Policy();
+    policy.maxBytes = 10000;
+    s.start(policy);
+    s.frameWritten(0, grabNs(0));
+    QVERIFY(!s.shouldPrepare(grabNs(74), 7400));
+    QVERIFY(s.shouldPrepare(grabNs(75), 7500));
+    // 长周期（60 fps、每帧 1 MB、每段 2 GB ≈ 34 秒）：按写入速率估计剩
+    // 5 秒（300 帧）时准备，不等到 3/4
+    const uint64_t mb = uint64_t(1) << 20;
+    policy.maxBytes = 2048 * mb;
+    s.start(policy);
+    s.frameWritten(0, grabNs(0));
+    QVERIFY(!s.shouldPrepare(grabNs(1740), 1740 * mb));
+    QVERIFY(s.shouldPrepare(grabNs(1760), 1760 * mb));
+  }
+
+  void deferred_rollover_waits_a_full_period() {
+    RecordSegmenter::Policy policy;
+    policy.maxDurationNs = kSecondNs;
+    policy.maxBytes = 10000;
+    RecordSegmenter s;
+    s.start(policy);
+    for (int i = 0; i < 60; ++i)
+      s.frameWritten(uint64_t(i), grabNs(i));
+    QVERIFY(s.shouldRollOver(grabNs(60), 6000, 100));
+    // 新文件打不开：从第 60 帧起重新计时 / 计字节，不逐帧重试
+    s.deferRollOver(grabNs(60), 6000);
+    for (int i = 60; i < 119; ++i) {
+      QVERIFY(!s.shouldRollOver(grabNs(i), 6000 + uint64_t(i - 60) * 100,
+                                100));
+      s.frameWritten(uint64_t(i), grabNs(i));
+    }
+    QVERIFY(s.shouldRollOver(grabNs(120), 12000, 100));
+    // 按字节也从失败那一刻重新计
+    QVERIFY(s.shouldRollOver(grabNs(61), 6000 + 9950, 100));
+    QVERIFY(!s.shouldRollOver(grabNs(61), 6000 + 9900, 100));
+    const RecordSegmenter::Segment done = s.rollOver();
+    QCOMPARE(done.index, 1);
+    QCOMPARE(done.frames, uint64_t(119));
+    QCOMPARE(s.current().index, 2);
+  }
+
+  void segments_cover_every_frame_once() {
+    QTemporaryDir dir;
+    const std::string base = dir.filePath("run.wvr").toStdString();
+    WvrWriter::Options o;
+    o.width = 64;
+    o.height = 48;
+    o.pixelType = PixelFormats::kMono8;
+    o.fps = 60.0;
+    const std::size_t frameBytes =
+        PixelFormats::frameBytes(o.pixelType, o.width, o.height);
+
+    RecordSegmenter::Policy policy;
+    policy.maxBytes = 64 * 1024; // 一帧一个 4 KB 块，文件头 4 KB
+    policy.maxDurationNs = 2 * kSecondNs;
+    RecordSegmenter s;
+    s.start(policy);
+
+    // 与 CameraController::writeRecordFrame 相同：快到上限时打开下一段，
+    // 写下一帧前问要不要换，换的时候只交接已打开的写入器
+    const int frames = 300;
+    std::vector<std::unique_ptr<WvrWriter>> closed;
+    auto writer = std::make_unique<WvrWriter>();
+    QVERIFY(writer->open(RecordSegmenter::segmentPath(base, 1), o));
+    std::unique_ptr<WvrWriter> next;
+    std::vector<uint8_t> pixels(frameBytes);
+    for (int i = 0; i < frames; ++i) {
+      // 中途停顿 3 秒：按时长换段
+      const int64_t t = grabNs(i) + (i >= 200 ? 3 * kSecondNs : 0);
+      if (!next && s.shouldPrepare(t, writer->fileBytes())) {
+        next = std::make_unique<WvrWriter>();
+        QVERIFY(next->open(
+            RecordSegmenter::segmentPath(base, s.current().index + 1), o));
+      }
+      if (s.shouldRollOver(t, writer->fileBytes(), frameBytes)) {
+        QVERIFY(next); // 换段前一定已经准备好
+        s.rollOver();
+        QVERIFY(writer->close());
+        closed.push_back(std::move(writer));
+        writer = std::move(next);
+      }
+      std::fill(pixels.begin(), pixels.end(), uint8_t(i));
+      IRecordWriter::FrameMeta meta;
+      meta.frameNum = uint64_t(i);
+      meta.grabTimeNs = t;
+      QVERIFY(writer->writeFrame(pixels.data(), pixels.size(), meta));
+      s.frameWritten(meta.frameNum, meta.grabTimeNs);
+    }
+    QVERIFY(writer->close());
+    QVERIFY(!next);
+    const int segments = s.current().index;
+    QVERIFY(segments >= 3);
+    QCOMPARE(int(closed.size()) + 1, segments);
+
+    // 逐段读回：帧号连续、不缺不重，像素对得上，文件不超上限
+    uint64_t expect = 0;
+    for (int k = 1; k <= segments; ++k) {
+      const std::string path = RecordSegmenter::segmentPath(base, k);
+      QVERIFY(uint64_t(QFileInfo(QString::fromStdString(path)).size()) <=
+              policy.maxBytes + 4096); // 关闭时的尾索引另算
+      WvrReader reader;
+      QVERIFY2(reader.open(path), reader.error().c_str());
+      QVERIFY(reader.complete());
+      QVERIFY(reader.frameCount() > 0);
+      for (uint64_t f = 0; f < reader.frameCount(); ++f, ++expect) {
+        WvrReader::Frame frame;
+        QVERIFY(reader.frame(f, &frame));
+        QCOMPARE(frame.frameNum, expect);
+        QCOMPARE(frame.data[0], uint8_t(expect));
+      }
+    }
+    QCOMPARE(expect, uint64_t(frames));
+    QVERIFY(!QFileInfo::exists(QString::fromStdString(
+        RecordSegmenter::segmentPath(base, segments + 1))));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestRecordSegmenter)
+#include "test_record_segmenter.moc"
@@ -1,5 +1,10 @@
 // Phase 5 - RecordingDiagnostics 单元测试
 #include "utils/RecordingDiagnostics.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
 #include <QtTest>
 
 class TestRecordingDiagnostics : public QObject {
@@ -54,6 +59,209 @@ private slots:
     QVERIFY(s.contains("5"));
     QVERIFY(s.contains("1234567"));
   }
+
+  void report_sidecar_contains_telemetry() {
+    RecordingDiagnostics::RecordingReport report;
+    report.totalFrames = 7200;
+    report.inputOk = 7195;
+    report.convertFail = 2;
+    report.queueDrop = 3;
+    report.fileBytes = 4096;
+    report.pixelType = 0x01080001;
+    report.telemetry.frames = 7200;
+    report.telemetry.lostFrames = 3;
+    report.telemetry.latencyUs.p99 = 850;
+
+    QTemporaryDir dir;
+    const QString video = dir.filePath("run1.avi");
+    QCOMPARE(RecordingDiagnostics::statsSidecarPath(video),
+             video + ".stats.json");
+    QVERIFY(RecordingDiagnostics::writeRecordingReport(video, report));
+
+    QFile file(RecordingDiagnostics::statsSidecarPath(video));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    const QJsonObject rec = root["recording"].toObject();
+    const QJsonObject tel = root["telemetry"].toObject();
+    QCOMPARE(rec["inputOk"].toInteger(), qint64(7195));
+    // 队列满丢帧单独记，不算进像素转换失败
+    QCOMPARE(rec["convertFail"].toInteger(), qint64(2));
+    QCOMPARE(rec["queueDrop"].toInteger(), qint64(3));
+    QCOMPARE(rec["pixelType"].toString(), QString("Mono8"));
+    QCOMPARE(tel["lostFrames"].toInteger(), qint64(3));
+    QCOMPARE(tel["latencyUs"].toObject()["p99"].toInteger(), qint64(850));
+    // 单路录制不写同步信息；写入成功不写 writerError
+    QVERIFY(!root.contains("sync"));
+    QVERIFY(!rec.contains("writerError"));
+
+    report.writerError = "写入失败: No space left on device";
+    const QJsonObject failed =
+        QJsonDocument::fromJson(RecordingDiagnostics::recordingReportJson(report))
+            .object()["recording"]
+            .toObject();
+    QCOMPARE(failed["writerError"].toString(), report.writerError);
+  }
+
+  void discard_removes_video_and_sidecar() {
+    QTemporaryDir dir;
+    const QString video = dir.filePath("run1_cam1.avi");
+    QFile file(video);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write("RIFF", 4) == 4);
+    file.close();
+    RecordingDiagnostics::RecordingReport report;
+    report.fileBytes = 4;
+    QVERIFY(RecordingDiagnostics::writeRecordingReport(video, report));
+
+    QVERIFY(RecordingDiagnostics::discardRecording(video));
+    QVERIFY(!QFile::exists(video));
+    QVERIFY(!QFile::exists(RecordingDiagnostics::statsSidecarPath(video)));
+    // 已经没有的文件算删掉了
+    QVERIFY(RecordingDiagnostics::discardRecording(video));
+  }
+
+  void report_sidecar_contains_sync_offsets() {
+    RecordingDiagnostics::RecordingReport report;
+    report.syncStartNs = 5'000'000'000;
+    report.syncGroup = "20261017_101500";
+    report.firstFrameGrabNs = 5'012'500'000;
+    report.firstFrameDevTimestamp = 123456789012ull;
+
+    const QJsonObject root =
+        QJsonDocument::fromJson(RecordingDiagnostics::recordingReportJson(report))
+            .object();
+    const QJsonObject sync = root["sync"].toObject();
+    QCOMPARE(sync["group"].toString(), QString("20261017_101500"));
+    QCOMPARE(sync["startNs"].toInteger(), qint64(5'000'000'000));
+    QCOMPARE(sync["firstFrameOffsetUs"].toInteger(), qint64(12500));
+    QCOMPARE(sync["firstFrameDevTimestamp"].toString(),
+             QString("123456789012"));
+  }
+
+  void report_sidecar_lists_applied_thread_settings() {
+    RecordingDiagnostics::RecordingReport report;
+    ThreadAffinity::Applied grab;
+    grab.thread = "grab";
+    grab.requested.core = 3;
+    grab.requested.priority = ThreadAffinity::Priority::Realtime;
+    grab.pinned = true;
+    grab.prioritized = false;
+    report.threads.push_back(grab);
+
+    const QJsonObject root =
+        QJsonDocument::fromJson(RecordingDiagnostics::recordingReportJson(report))
+            .object();
+    const QJsonArray threads = root["threads"].toArray();
+    QCOMPARE(threads.size(), 1);
+    const QJsonObject t = threads.at(0).toObject();
+    QCOMPARE(t["name"].toString(), QString("grab"));
+    QCOMPARE(t["core"].toInt(), 3);
+    QCOMPARE(t["priority"].toString(), QString("realtime"));
+    QVERIFY(t["pinned"].toBool());
+    QVERIFY(!t["prioritized"].toBool());
+  }
+
+  void report_sidecar_contains_pre_trigger_history_only_when_used() {
+    RecordingDiagnostics::RecordingReport report;
+    QByteArray json = RecordingDiagnostics::recordingReportJson(report);
+    QVERIFY(!QJsonDocument::fromJson(json).object().contains("preTrigger"));
+
+    report.preTriggerFrames = 300;
+    report.preTriggerSpanMs = 2990;
+    report.preTriggerLost = 4;
+    json = RecordingDiagnostics::recordingReportJson(report);
+    const QJsonObject root = QJsonDocument::fromJson(json).object();
+    const QJsonObject preTrigger = root["preTrigger"].toObject();
+    QCOMPARE(preTrigger["frames"].toInteger(), qint64(300));
+    QCOMPARE(preTrigger["spanMs"].toInteger(), qint64(2990));
+    // 补写期间丢的帧记在这里，不算像素转换失败
+    QCOMPARE(preTrigger["lost"].toInteger(), qint64(4));
+    QCOMPARE(root["recording"].toObject()["convertFail"].toInteger(),
+             qint64(0));
+  }
+
+  void report_sidecar_contains_segment_range_only_when_segmented() {
+    RecordingDiagnostics::RecordingReport report;
+    QByteArray json = RecordingDiagnostics::recordingReportJson(report);
+    QVERIFY(!QJsonDocument::fromJson(json).object().contains("segment"));
+
+    report.segmentIndex = 3;
+    report.segmentFrames = 36000;
+    report.segmentFirstFrameNum = 72001;
+    report.segmentLastFrameNum = 108000;
+    report.segmentFirstGrabNs = 1'200'000'000'000;
+    report.segmentLastGrabNs = 1'799'983'333'333;
+    json = RecordingDiagnostics::recordingReportJson(report);
+    const QJsonObject segment =
+        QJsonDocument::fromJson(json).object()["segment"].toObject();
+    QCOMPARE(segment["index"].toInt(), 3);
+    QCOMPARE(segment["frames"].toInteger(), qint64(36000));
+    QCOMPARE(segment["firstFrameNum"].toInteger(), qint64(72001));
+    QCOMPARE(segment["lastFrameNum"].toInteger(), qint64(108000));
+    QCOMPARE(segment["firstGrabNs"].toInteger(), qint64(1'200'000'000'000));
+    QCOMPARE(segment["lastGrabNs"].toInteger(), qint64(1'799'983'333'333));
+    // 中间段只写本段，不写整次合计
+    QVERIFY(!QJsonDocument::fromJson(json).object().contains("session"));
+  }
+
+  void report_sidecar_contains_session_totals_in_last_segment() {
+    RecordingDiagnostics::RecordingReport report;
+    report.segmentIndex = 4;
+    report.inputOk = 1000; // 本段
+    report.telemetry.frames = 1000;
+    report.session.segments = 4;
+    report.session.totalFrames = 4012;
+    report.session.inputOk = 4000;
+    report.session.queueDrop = 7;
+    report.session.preTriggerLost = 5;
+    report.session.fileBytes = 4'000'000'000;
+    report.session.telemetry.frames = 4000;
+    report.session.telemetry.lostFrames = 2;
+
+    const QJsonObject root =
+        QJsonDocument::fromJson(RecordingDiagnostics::recordingReportJson(report))
+            .object();
+    QCOMPARE(root["recording"].toObject()["inputOk"].toInteger(),
+             qint64(1000));
+    QCOMPARE(root["telemetry"].toObject()["frames"].toInteger(), qint64(1000));
+    const QJsonObject session = root["session"].toObject();
+    QCOMPARE(session["segments"].toInt(), 4);
+    QCOMPARE(session["totalFrames"].toInteger(), qint64(4012));
+    QCOMPARE(session["inputOk"].toInteger(), qint64(4000));
+    QCOMPARE(session["queueDrop"].toInteger(), qint64(7));
+    QCOMPARE(session["preTriggerLost"].toInteger(), qint64(5));
+    QCOMPARE(session["fileBytes"].toInteger(), qint64(4'000'000'000));
+    const QJsonObject telemetry = session["telemetry"].toObject();
+    QCOMPARE(telemetry["frames"].toInteger(), qint64(4000));
+    QCOMPARE(telemetry["lostFrames"].toInteger(), qint64(2));
+  }
+
+  void report_sidecar_contains_disk_stats_only_when_written() {
+    RecordingDiagnostics::RecordingReport report;
+    QByteArray json = RecordingDiagnostics::recordingReportJson(report);
+    QVERIFY(!QJsonDocument::fromJson(json).object().contains("disk"));
+
+    report.disk.bytes = 3000000000ull;
+    report.disk.elapsedSec = 10.0;
+    report.disk.maxWriteUs = 42000;
+    report.disk.highWaterBytes = uint64_t(16) << 20;
+    report.disk.queueCapacityBytes = uint64_t(32) << 20;
+    report.disk.producerWaits = 2;
+    report.disk.bufferBytes = std::size_t(8) << 20;
+    report.disk.bufferCount = 4;
+    report.disk.directIo = true;
+    json = RecordingDiagnostics::recordingReportJson(report);
+    const QJsonObject disk =
+        QJsonDocument::fromJson(json).object()["disk"].toObject();
+    QCOMPARE(disk["mbPerSec"].toDouble(), 300.0);
+    QCOMPARE(disk["maxWriteUs"].toInteger(), qint64(42000));
+    QCOMPARE(disk["highWaterBytes"].toInteger(), qint64(16) << 20);
+    QCOMPARE(disk["queueCapacityBytes"].toInteger(), qint64(32) << 20);
+    QCOMPARE(disk["producerWaits"].toInteger(), qint64(2));
+    QCOMPARE(disk["bufferCount"].toInt(), 4);
+    QVERIFY(disk["directIo"].toBool());
+    QVERIFY(!disk["preallocated"].toBool());
+  }
 };
 
 QTEST_GUILESS_MAIN(TestRecordingDiagnostics)
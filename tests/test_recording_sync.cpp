@@ -0,0 +1,121 @@
+// RecordingSync 单元测试：不同步时每帧都写；hold 时一帧不写；放行后
+// 只写不早于共同起点的帧；录制结束取出起点并回到不同步。
+// 同步开录：全部 hold 成功后用同一个起点放行；某一路失败时作废前面
+// 已开好的各路、一路都不放行
+#include "utils/RecordingSync.h"
+
+#include <QStringList>
+#include <QtTest>
+#include <vector>
+
+namespace {
+
+constexpr int64_t kFrameIntervalNs = 16666667; // 60 fps
+constexpr int64_t kSecondNs = 1000000000;
+
+int64_t grabNs(int index) { return 5 * kSecondNs + index * kFrameIntervalNs; }
+
+// 和 CameraController::recordFrame 一样逐帧问闸门，返回写进文件的帧序号
+std::vector<int> admitted(const RecordingSyncGate &gate, int first, int last) {
+  std::vector<int> frames;
+  for (int i = first; i <= last; ++i) {
+    if (gate.admits(grabNs(i)))
+      frames.push_back(i);
+  }
+  return frames;
+}
+
+// 按调用顺序记下每一步；failAt 那一路 startHeld 失败
+SyncedStart recordingSteps(QStringList *log, int failAt = -1) {
+  SyncedStart start;
+  start.startHeld = [log, failAt](int i) {
+    log->append(QString("hold %1").arg(i));
+    return i != failAt;
+  };
+  start.abortHeld = [log](int i) { log->append(QString("abort %1").arg(i)); };
+  start.release = [log](int i, int64_t startNs) {
+    log->append(QString("release %1 @%2").arg(i).arg(startNs));
+  };
+  start.nowNs = [log]() {
+    log->append("now");
+    return grabNs(100);
+  };
+  return start;
+}
+
+} // namespace
+
+class TestRecordingSync : public QObject {
+  Q_OBJECT
+private slots:
+
+  void unsynced_gate_admits_every_frame() {
+    RecordingSyncGate gate;
+    QCOMPARE(gate.startNs(), int64_t(0));
+    QCOMPARE(admitted(gate, 0, 9).size(), std::size_t(10));
+  }
+
+  void held_gate_admits_nothing_until_released() {
+    RecordingSyncGate gate;
+    gate.set(RecordingSyncGate::kHoldNs);
+    QVERIFY(admitted(gate, 0, 59).empty());
+
+    // 放行：起点落在第 30、31 帧之间，第 31 帧起才写
+    const int64_t startNs = grabNs(30) + kFrameIntervalNs / 2;
+    gate.set(startNs);
+    const std::vector<int> frames = admitted(gate, 0, 59);
+    QCOMPARE(frames.size(), std::size_t(29));
+    QCOMPARE(frames.front(), 31);
+    QCOMPARE(frames.back(), 59);
+    // 恰好在起点采集的帧算起点之后
+    QVERIFY(gate.admits(startNs));
+    QVERIFY(!gate.admits(startNs - 1));
+  }
+
+  void take_returns_start_and_clears_sync() {
+    RecordingSyncGate gate;
+    gate.set(grabNs(10));
+    QCOMPARE(gate.take(), grabNs(10));
+    QCOMPARE(gate.startNs(), int64_t(0));
+    QVERIFY(gate.admits(grabNs(0)));
+  }
+
+  void common_start_excludes_unsynced_and_hold() {
+    QVERIFY(!RecordingSyncGate::isCommonStart(0));
+    QVERIFY(!RecordingSyncGate::isCommonStart(RecordingSyncGate::kHoldNs));
+    QVERIFY(RecordingSyncGate::isCommonStart(grabNs(0)));
+  }
+
+  void synced_start_releases_all_with_one_start() {
+    QStringList log;
+    int failed = 0;
+    QCOMPARE(recordingSteps(&log).run(3, &failed), grabNs(100));
+    QCOMPARE(failed, -1);
+    // 全部开好之后才取起点，各路放行用同一个起点
+    const QString at = QString::number(grabNs(100));
+    QCOMPARE(log, QStringList({"hold 0", "hold 1", "hold 2", "now",
+                               "release 0 @" + at, "release 1 @" + at,
+                               "release 2 @" + at}));
+  }
+
+  void failed_start_aborts_held_streams_and_releases_none() {
+    QStringList log;
+    int failed = -1;
+    QCOMPARE(recordingSteps(&log, 2).run(4, &failed), int64_t(0));
+    QCOMPARE(failed, 2);
+    // 序号 3 那一路不再开；失败的那一路自己没开成，不用作废
+    QCOMPARE(log,
+             QStringList({"hold 0", "hold 1", "hold 2", "abort 0", "abort 1"}));
+  }
+
+  void failed_first_start_aborts_nothing() {
+    QStringList log;
+    int failed = -1;
+    QCOMPARE(recordingSteps(&log, 0).run(2, &failed), int64_t(0));
+    QCOMPARE(failed, 0);
+    QCOMPARE(log, QStringList({"hold 0"}));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestRecordingSync)
+#include "test_recording_sync.moc"
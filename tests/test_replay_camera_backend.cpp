@@ -0,0 +1,316 @@
+// ReplayCameraBackend 单元测试：手写最小 AVI 文件，验证 RIFF / OpenDML 解析、
+// 行翻转 / 去行填充、循环与结束、非法文件拒绝
+#include "services/ReplayCameraBackend.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using Backend = ReplayCameraBackend;
+using GrabResult = ICameraBackend::GrabResult;
+
+struct AviSpec {
+  int width = 16;
+  int height = 8; // 负数 = 自顶向下
+  int bitCount = 8;
+  const char *compression = nullptr; // nullptr = BI_RGB
+  uint32_t usPerFrame = 40000;       // 25 fps
+  int frames = 3;
+  int avixFrames = 0;                 // 写进第二个 RIFF AVIX 的帧数
+  bool truncateLast = false;          // 模拟录制中断：AVIX 最后一帧不完整
+};
+
+void put32(QByteArray &b, uint32_t v) {
+  for (int i = 0; i < 4; ++i)
+    b.append(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+void put16(QByteArray &b, uint16_t v) {
+  b.append(static_cast<char>(v & 0xFF));
+  b.append(static_cast<char>(v >> 8));
+}
+
+QByteArray chunk(const char *id, const QByteArray &data) {
+  QByteArray b(id, 4);
+  put32(b, static_cast<uint32_t>(data.size()));
+  b.append(data);
+  if (data.size() & 1)
+    b.append('\0');
+  return b;
+}
+
+QByteArray list(const char *type, const QByteArray &data) {
+  return chunk("LIST", QByteArray(type, 4) + data);
+}
+
+std::size_t strideOf(const AviSpec &s) {
+  if (s.compression)
+    return static_cast<std::size_t>(s.width);
+  return (static_cast<std::size_t>(s.width) * s.bitCount + 31) / 32 * 4;
+}
+
+// 文件里第 index 帧的像素：每行首字节 = 帧号 * 16 + 存储行号
+QByteArray frameData(const AviSpec &s, int index) {
+  const int rows = s.height < 0 ? -s.height : s.height;
+  QByteArray b(static_cast<qsizetype>(strideOf(s) * rows), '\x7F');
+  for (int r = 0; r < rows; ++r)
+    b[static_cast<qsizetype>(r * strideOf(s))] = static_cast<char>(index * 16 + r);
+  return b;
+}
+
+// 视频是第 2 个流（前面有一个音频流）→ 帧块 id "01db"
+QByteArray movi(const AviSpec &s, int first, int count) {
+  QByteArray b;
+  b.append(chunk("JUNK", QByteArray(6, '\0')));
+  for (int i = first; i < first + count; ++i) {
+    // 丢帧的 0 字节块要被跳过
+    if (i == first)
+      b.append(chunk("01db", QByteArray()));
+    b.append(chunk("01db", frameData(s, i)));
+  }
+  return list("movi", b);
+}
+
+bool writeAvi(const QString &path, const AviSpec &s) {
+  QByteArray avih;
+  put32(avih, s.usPerFrame);
+  avih.append(QByteArray(52, '\0'));
+
+  QByteArray strh("vids", 4);
+  strh.append(s.compression ? QByteArray(s.compression, 4) : QByteArray("DIB ", 4));
+  strh.append(QByteArray(48, '\0'));
+
+  QByteArray strf;
+  put32(strf, 40);
+  put32(strf, static_cast<uint32_t>(s.width));
+  put32(strf, static_cast<uint32_t>(s.height));
+  put16(strf, 1);
+  put16(strf, static_cast<uint16_t>(s.bitCount));
+  if (s.compression)
+    strf.append(s.compression, 4);
+  else
+    put32(strf, 0);
+  strf.append(QByteArray(20, '\0'));
+  if (!s.compression && s.bitCount == 8) {
+    // 灰度调色板
+    for (int i = 0; i < 256; ++i)
+      put32(strf, static_cast<uint32_t>(i * 0x010101));
+  }
+
+  // 音频流排在视频流前面，确认按 strh 找视频流
+  QByteArray audioStrl =
+      list("strl", chunk("strh", QByteArray("auds", 4) + QByteArray(52, '\0')) +
+                       chunk("strf", QByteArray(18, '\0')));
+  QByteArray hdrl = list("hdrl", chunk("avih", avih) + audioStrl +
+                                     list("strl", chunk("strh", strh) +
+                                                      chunk("strf", strf)));
+
+  QByteArray riff = hdrl + movi(s, 0, s.frames);
+  riff.append(chunk("idx1", QByteArray(16, '\0')));
+  QByteArray file = chunk("RIFF", QByteArray("AVI ", 4) + riff);
+  if (s.avixFrames > 0) {
+    const int extra = s.truncateLast ? 1 : 0;
+    file.append(chunk("RIFF", QByteArray("AVIX", 4) +
+                                  movi(s, s.frames, s.avixFrames + extra)));
+    // 多写的一帧只保留 10 字节，块头里的长度保持原样
+    if (s.truncateLast)
+      file.chop(frameData(s, 0).size() - 10);
+  }
+
+  QFile f(path);
+  return f.open(QIODevice::WriteOnly) && f.write(file) == file.size();
+}
+
+Backend::Options unpaced(const QString &path) {
+  Backend::Options options;
+  options.path = path;
+  options.fps = 0.0;
+  return options;
+}
+
+bool startWithPool(Backend &backend, FramePool &pool) {
+  ICameraBackend::IntValue payload;
+  return backend.open(0) == ICameraBackend::kOk &&
+         backend.getInt("PayloadSize", payload) == ICameraBackend::kOk &&
+         pool.configure(4, static_cast<std::size_t>(payload.current)) &&
+         backend.startGrabbing() == ICameraBackend::kOk;
+}
+
+} // namespace
+
+class TestReplayCameraBackend : public QObject {
+  Q_OBJECT
+private slots:
+
+  void parse_options_splits_path_and_query() {
+    const Backend::Options o =
+        Backend::parseOptions("D:/data/run 1.avi?fps=30&loop=0");
+    QCOMPARE(o.path, QString("D:/data/run 1.avi"));
+    QCOMPARE(o.fps, 30.0);
+    QCOMPARE(o.loop, false);
+
+    const Backend::Options d = Backend::parseOptions("/tmp/a.avi");
+    QCOMPARE(d.path, QString("/tmp/a.avi"));
+    QVERIFY(d.fps < 0.0);
+    QCOMPARE(d.loop, true);
+  }
+
+  void bottom_up_mono8_is_flipped() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("mono.avi");
+    AviSpec spec;
+    QVERIFY(writeAvi(path, spec));
+
+    Backend backend(unpaced(path));
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+    QCOMPARE(backend.frameCount(), 3);
+
+    ICameraBackend::FloatValue fps;
+    QCOMPARE(backend.getFloat("AcquisitionFrameRate", fps), ICameraBackend::kOk);
+    QCOMPARE(fps.current, 25.0f);
+
+    for (int i = 0; i < 3; ++i) {
+      FrameRef frame;
+      QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+      QCOMPARE(frame.info().width, 16u);
+      QCOMPARE(frame.info().height, 8u);
+      QCOMPARE(frame.info().pixelType, Backend::kPixelMono8);
+      QCOMPARE(frame.info().frameNum, uint32_t(i));
+      // 输出第 0 行 = 文件里最后存储的一行
+      for (int y = 0; y < 8; ++y)
+        QCOMPARE(int(frame.data()[y * 16]), i * 16 + (7 - y));
+    }
+  }
+
+  void bgr24_row_padding_is_removed() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("bgr.avi");
+    AviSpec spec;
+    spec.width = 10; // 30 字节一行，文件里按 32 字节对齐
+    spec.height = -4;
+    spec.bitCount = 24;
+    QVERIFY(writeAvi(path, spec));
+
+    Backend backend(unpaced(path));
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+    FrameRef frame;
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+    QCOMPARE(frame.info().pixelType, Backend::kPixelBGR8);
+    QCOMPARE(frame.info().frameLen, std::size_t(10 * 4 * 3));
+    for (int y = 0; y < 4; ++y) {
+      QCOMPARE(int(frame.data()[y * 30]), y);
+      QCOMPARE(int(frame.data()[y * 30 + 29]), 0x7F);
+    }
+  }
+
+  void y800_and_opendml_segments_are_read() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("y800.avi");
+    AviSpec spec;
+    spec.compression = "Y800";
+    spec.frames = 2;
+    spec.avixFrames = 2;
+    spec.truncateLast = true;
+    QVERIFY(writeAvi(path, spec));
+
+    Backend::Options options = unpaced(path);
+    options.loop = false;
+    Backend backend(options);
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+    // 不完整的最后一块被忽略
+    QCOMPARE(backend.frameCount(), 4);
+
+    FrameRef frame;
+    for (int i = 0; i < 4; ++i) {
+      QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+      QCOMPARE(int(frame.data()[0]), i * 16); // 自顶向下，不翻转
+    }
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::EndOfStream);
+  }
+
+  void loops_by_default() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("loop.avi");
+    AviSpec spec;
+    spec.frames = 2;
+    QVERIFY(writeAvi(path, spec));
+
+    Backend backend(unpaced(path));
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+    FrameRef frame;
+    for (int i = 0; i < 5; ++i) {
+      QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+      QCOMPARE(frame.info().frameNum, uint32_t(i));
+      QCOMPARE(int(frame.data()[7 * 16]), (i % 2) * 16);
+    }
+  }
+
+  void paced_by_file_frame_rate() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("paced.avi");
+    AviSpec spec;
+    spec.usPerFrame = 10000; // 100 fps
+    QVERIFY(writeAvi(path, spec));
+
+    Backend::Options options;
+    options.path = path;
+    Backend backend(options);
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+    FrameRef frame;
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+    QCOMPARE(backend.grabFrame(pool, frame, 2), GrabResult::Timeout);
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+  }
+
+  void rejects_compressed_and_non_avi_files() {
+    QTemporaryDir dir;
+    const QString mjpg = dir.filePath("mjpg.avi");
+    AviSpec spec;
+    spec.compression = "MJPG";
+    spec.bitCount = 24;
+    QVERIFY(writeAvi(mjpg, spec));
+    Backend compressed(unpaced(mjpg));
+    QCOMPARE(compressed.open(0), ICameraBackend::kErrNotSupported);
+    QVERIFY(!compressed.isOpen());
+
+    const QString text = dir.filePath("notes.avi");
+    QFile f(text);
+    QVERIFY(f.open(QIODevice::WriteOnly));
+    f.write("not a riff file at all");
+    f.close();
+    Backend bogus(unpaced(text));
+    QCOMPARE(bogus.open(0), ICameraBackend::kErrNotSupported);
+
+    Backend missing(unpaced(dir.filePath("missing.avi")));
+    QVERIFY(missing.enumerateDevices().isEmpty());
+    QCOMPARE(missing.open(0), ICameraBackend::kErrIo);
+  }
+
+  void geometry_is_read_only() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("ro.avi");
+    QVERIFY(writeAvi(path, AviSpec()));
+    Backend backend(unpaced(path));
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+    QCOMPARE(backend.setInt("Width", 8), ICameraBackend::kErrNotSupported);
+    QCOMPARE(backend.setEnum("PixelFormat", Backend::kPixelMono8),
+             ICameraBackend::kOk);
+    QCOMPARE(backend.setEnum("PixelFormat", Backend::kPixelBGR8),
+             ICameraBackend::kErrNotSupported);
+    ICameraBackend::FloatValue v;
+    QCOMPARE(backend.getFloat("ExposureTime", v),
+             ICameraBackend::kErrNotSupported);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestReplayCameraBackend)
+#include "test_replay_camera_backend.moc"
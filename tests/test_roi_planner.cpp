@@ -0,0 +1,141 @@
+// RoiPlanner 单元测试：对齐 / 夹取、写入顺序在每一步都满足 Offset + 尺寸 <= 最大值，
+// 并在 SyntheticCameraBackend（与真实相机同样的节点约束）上实际写一遍
+#include "services/SyntheticCameraBackend.h"
+#include "utils/RoiPlanner.h"
+
+#include <QtTest>
+
+namespace {
+
+RoiLimits limits1280x1024() {
+  RoiLimits limits;
+  limits.widthMax = 1280;
+  limits.heightMax = 1024;
+  limits.widthMin = 32;
+  limits.heightMin = 32;
+  limits.widthInc = 8;
+  limits.heightInc = 8;
+  limits.offsetXInc = 8;
+  limits.offsetYInc = 8;
+  return limits;
+}
+
+// 按相机的规则逐步模拟：任何一步越界都算失败
+bool replay(Roi roi, const std::vector<RoiStep> &steps, const RoiLimits &limits,
+            Roi *out) {
+  for (const RoiStep &step : steps) {
+    const QByteArray key(step.key);
+    if (key == "OffsetX")
+      roi.x = step.value;
+    else if (key == "OffsetY")
+      roi.y = step.value;
+    else if (key == "Width")
+      roi.width = step.value;
+    else if (key == "Height")
+      roi.height = step.value;
+    else
+      return false;
+    if (roi.x < 0 || roi.y < 0 || roi.x + roi.width > limits.widthMax ||
+        roi.y + roi.height > limits.heightMax)
+      return false;
+  }
+  *out = roi;
+  return true;
+}
+
+} // namespace
+
+Q_DECLARE_METATYPE(Roi)
+
+class TestRoiPlanner : public QObject {
+  Q_OBJECT
+private slots:
+
+  void align_rounds_down_and_clamps() {
+    const RoiLimits limits = limits1280x1024();
+    Roi r = RoiPlanner::align({13, 7, 645, 483}, limits);
+    QVERIFY(r == (Roi{8, 0, 640, 480}));
+
+    // 尺寸超出传感器 → 满幅；偏移把窗口推出传感器 → 贴边
+    r = RoiPlanner::align({0, 0, 5000, 5000}, limits);
+    QVERIFY(r == (Roi{0, 0, 1280, 1024}));
+    r = RoiPlanner::align({1200, 1000, 320, 240}, limits);
+    QVERIFY(r == (Roi{960, 784, 320, 240}));
+
+    // 太小 → 最小尺寸；负偏移 → 0
+    r = RoiPlanner::align({-20, -1, 3, 0}, limits);
+    QVERIFY(r == (Roi{0, 0, 32, 32}));
+  }
+
+  void plan_keeps_every_step_inside_sensor_data() {
+    QTest::addColumn<Roi>("from");
+    QTest::addColumn<Roi>("to");
+    QTest::addColumn<int>("steps");
+    QTest::newRow("满幅 → 右下小窗")
+        << Roi{0, 0, 1280, 1024} << Roi{960, 784, 320, 240} << 4;
+    QTest::newRow("右下小窗 → 满幅")
+        << Roi{960, 784, 320, 240} << Roi{0, 0, 1280, 1024} << 4;
+    QTest::newRow("右下小窗 → 左上大窗")
+        << Roi{960, 784, 320, 240} << Roi{0, 0, 1024, 800} << 4;
+    QTest::newRow("只挪位置")
+        << Roi{0, 0, 640, 480} << Roi{640, 544, 640, 480} << 2;
+    QTest::newRow("只改宽度")
+        << Roi{0, 0, 640, 480} << Roi{0, 0, 1280, 480} << 1;
+    QTest::newRow("不变") << Roi{8, 8, 640, 480} << Roi{8, 8, 640, 480} << 0;
+  }
+
+  void plan_keeps_every_step_inside_sensor() {
+    QFETCH(Roi, from);
+    QFETCH(Roi, to);
+    QFETCH(int, steps);
+    const std::vector<RoiStep> plan = RoiPlanner::plan(from, to);
+    QCOMPARE(int(plan.size()), steps);
+    Roi result;
+    QVERIFY(replay(from, plan, limits1280x1024(), &result));
+    QVERIFY(result == to);
+  }
+
+  void plan_applies_on_backend_with_real_constraints() {
+    SyntheticCameraBackend::Config config;
+    config.width = 640;
+    config.height = 480;
+    config.fps = 0.0;
+    SyntheticCameraBackend backend(config);
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+
+    // 与 SyntheticCameraBackend 的 ROI 节点一致：步长 8、最小 64
+    RoiLimits limits;
+    limits.widthMax = 640;
+    limits.heightMax = 480;
+    limits.widthMin = limits.heightMin = 64;
+    limits.widthInc = limits.heightInc = 8;
+    limits.offsetXInc = limits.offsetYInc = 8;
+
+    Roi current{0, 0, 640, 480};
+    const Roi targets[] = {{480, 320, 160, 160},
+                           {0, 0, 600, 400},
+                           {40, 80, 600, 400},
+                           {0, 0, 640, 480}};
+    for (const Roi &requested : targets) {
+      const Roi target = RoiPlanner::align(requested, limits);
+      QVERIFY(target == requested);
+      for (const RoiStep &step : RoiPlanner::plan(current, target))
+        QCOMPARE(backend.setInt(step.key, step.value), ICameraBackend::kOk);
+      ICameraBackend::IntValue v;
+      QCOMPARE(backend.getInt("Width", v), ICameraBackend::kOk);
+      QCOMPARE(int(v.current), target.width);
+      QCOMPARE(backend.getInt("OffsetY", v), ICameraBackend::kOk);
+      QCOMPARE(int(v.current), target.y);
+      current = target;
+    }
+
+    // 采集中 ROI 节点不可写：调用方必须先停采集
+    QCOMPARE(backend.startGrabbing(), ICameraBackend::kOk);
+    QCOMPARE(backend.setInt("Width", 320), ICameraBackend::kErrBusy);
+    backend.stopGrabbing();
+    backend.close();
+  }
+};
+
+QTEST_GUILESS_MAIN(TestRoiPlanner)
+#include "test_roi_planner.moc"
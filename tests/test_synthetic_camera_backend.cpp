@@ -0,0 +1,333 @@
+// SyntheticCameraBackend 单元测试：像素格式 / 可复现画面 / 参数节点 / 节拍
+#include "services/SyntheticCameraBackend.h"
+
+#include <QtTest>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Backend = SyntheticCameraBackend;
+using GrabResult = ICameraBackend::GrabResult;
+
+Backend::Config smallConfig(uint32_t pixelType = Backend::kPixelMono8) {
+  Backend::Config config;
+  config.width = 320;
+  config.height = 240;
+  config.pixelType = pixelType;
+  config.fps = 0.0; // 不限速
+  config.wormCount = 3;
+  return config;
+}
+
+// 按当前 PayloadSize 配置池并开始采集
+bool startWithPool(Backend &backend, FramePool &pool, std::size_t count = 4) {
+  ICameraBackend::IntValue payload;
+  if (backend.open(0) != ICameraBackend::kOk ||
+      backend.getInt("PayloadSize", payload) != ICameraBackend::kOk)
+    return false;
+  return pool.configure(count, static_cast<std::size_t>(payload.current)) &&
+         backend.startGrabbing() == ICameraBackend::kOk;
+}
+
+double meanLevel(const FrameRef &frame) {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < frame.size(); ++i)
+    sum += frame.data()[i];
+  return sum / frame.size();
+}
+
+} // namespace
+
+class TestSyntheticCameraBackend : public QObject {
+  Q_OBJECT
+private slots:
+
+  void parse_options_reads_known_keys() {
+    const Backend::Config c = Backend::parseOptions(
+        "width=2448&height=2048&fps=30&format=BayerRG8&worms=8&seed=7");
+    QCOMPARE(c.width, 2448);
+    QCOMPARE(c.height, 2048);
+    QCOMPARE(c.fps, 30.0);
+    QCOMPARE(c.pixelType, Backend::kPixelBayerRG8);
+    QCOMPARE(c.wormCount, 8);
+    QCOMPARE(c.seed, uint32_t(7));
+
+    // 非法值保留默认值，宽高按步长 8 对齐
+    const Backend::Config d =
+        Backend::parseOptions("width=abc&height=1001&format=H264&bogus=1");
+    QCOMPARE(d.width, Backend::Config().width);
+    QCOMPARE(d.height, 1000);
+    QCOMPARE(d.pixelType, Backend::kPixelMono8);
+  }
+
+  void frames_match_requested_pixel_format_data() {
+    QTest::addColumn<uint32_t>("pixelType");
+    QTest::addColumn<int>("bytesPerPixel");
+    QTest::newRow("Mono8") << Backend::kPixelMono8 << 1;
+    QTest::newRow("BayerRG8") << Backend::kPixelBayerRG8 << 1;
+    QTest::newRow("Mono12") << Backend::kPixelMono12 << 2;
+  }
+
+  void frames_match_requested_pixel_format() {
+    QFETCH(uint32_t, pixelType);
+    QFETCH(int, bytesPerPixel);
+
+    Backend backend(smallConfig(pixelType));
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+
+    FrameRef frame;
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+    QVERIFY(frame);
+    const FrameInfo &info = frame.info();
+    QCOMPARE(info.width, 320u);
+    QCOMPARE(info.height, 240u);
+    QCOMPARE(info.pixelType, pixelType);
+    QCOMPARE(info.frameLen, std::size_t(320 * 240 * bytesPerPixel));
+    QCOMPARE(info.frameLen, FramePool::frameBytesFor(320, 240, pixelType));
+
+    if (pixelType == Backend::kPixelMono12) {
+      // 12 bit 数据放在 16 bit 小端容器里，高 4 位必须为 0
+      for (std::size_t i = 1; i < frame.size(); i += 2)
+        QVERIFY(frame.data()[i] <= 0x0F);
+    }
+  }
+
+  void worms_are_darker_than_agar_and_move() {
+    Backend backend(smallConfig());
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+
+    FrameRef first;
+    QCOMPARE(backend.grabFrame(pool, first, 100), GrabResult::Ok);
+    const auto [lo, hi] =
+        std::minmax_element(first.data(), first.data() + first.size());
+    QVERIFY(*hi - *lo > 80);
+
+    FrameRef later;
+    for (int i = 0; i < 10; ++i)
+      QCOMPARE(backend.grabFrame(pool, later, 100), GrabResult::Ok);
+    QCOMPARE(later.info().frameNum, uint32_t(10));
+    QVERIFY(std::memcmp(first.data(), later.data(), first.size()) != 0);
+  }
+
+  void same_seed_gives_identical_frames() {
+    Backend a(smallConfig());
+    Backend b(smallConfig());
+    FramePool poolA, poolB;
+    QVERIFY(startWithPool(a, poolA));
+    QVERIFY(startWithPool(b, poolB));
+    for (int i = 0; i < 5; ++i) {
+      FrameRef fa, fb;
+      QCOMPARE(a.grabFrame(poolA, fa, 100), GrabResult::Ok);
+      QCOMPARE(b.grabFrame(poolB, fb, 100), GrabResult::Ok);
+      QCOMPARE(std::memcmp(fa.data(), fb.data(), fa.size()), 0);
+    }
+  }
+
+  void multiple_devices_have_distinct_serials_and_scenes() {
+    Backend::Config config = smallConfig();
+    config.cameras = 3;
+    QCOMPARE(Backend::parseOptions("cameras=4").cameras, 4);
+    QCOMPARE(Backend::parseOptions("cameras=0").cameras, 1);
+
+    Backend a(config);
+    const QList<ICameraBackend::DeviceInfo> devices = a.enumerateDevices();
+    QCOMPARE(devices.size(), 3);
+    QCOMPARE(devices[2].index, 2);
+    QVERIFY(devices[0].serialNumber != devices[1].serialNumber);
+    QCOMPARE(a.open(3), ICameraBackend::kErrInvalidParam);
+
+    // 每个实例打开不同的设备，画面不同
+    Backend b(config);
+    FramePool poolA, poolB;
+    QVERIFY(startWithPool(a, poolA));
+    ICameraBackend::IntValue payload;
+    QCOMPARE(b.open(1), ICameraBackend::kOk);
+    QCOMPARE(b.getInt("PayloadSize", payload), ICameraBackend::kOk);
+    QVERIFY(poolB.configure(4, static_cast<std::size_t>(payload.current)));
+    QCOMPARE(b.startGrabbing(), ICameraBackend::kOk);
+    FrameRef fa, fb;
+    QCOMPARE(a.grabFrame(poolA, fa, 100), GrabResult::Ok);
+    QCOMPARE(b.grabFrame(poolB, fb, 100), GrabResult::Ok);
+    QVERIFY(std::memcmp(fa.data(), fb.data(), fa.size()) != 0);
+  }
+
+  void roi_nodes_locked_while_grabbing() {
+    Backend backend(smallConfig());
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+    QCOMPARE(backend.setInt("Width", 160), ICameraBackend::kErrBusy);
+    QCOMPARE(backend.setEnum("PixelFormat", Backend::kPixelMono12),
+             ICameraBackend::kErrBusy);
+    backend.stopGrabbing();
+
+    QCOMPARE(backend.setInt("Width", 161), ICameraBackend::kErrInvalidParam);
+    QCOMPARE(backend.setInt("Width", 160), ICameraBackend::kOk);
+    QCOMPARE(backend.setInt("OffsetX", 160), ICameraBackend::kOk);
+    QCOMPARE(backend.setInt("OffsetX", 168), ICameraBackend::kErrInvalidParam);
+    QCOMPARE(backend.setEnum("PixelFormat", Backend::kPixelMono12),
+             ICameraBackend::kOk);
+
+    ICameraBackend::IntValue v;
+    QCOMPARE(backend.getInt("PayloadSize", v), ICameraBackend::kOk);
+    QCOMPARE(v.current, int64_t(160 * 240 * 2));
+    QCOMPARE(backend.getInt("WidthMax", v), ICameraBackend::kOk);
+    QCOMPARE(v.current, int64_t(320));
+    QCOMPARE(backend.setInt("WidthMax", 64), ICameraBackend::kErrNotSupported);
+
+    QCOMPARE(backend.startGrabbing(), ICameraBackend::kOk);
+    FrameRef frame;
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+    QCOMPARE(frame.info().width, 160u);
+    QCOMPARE(frame.info().frameLen, std::size_t(160 * 240 * 2));
+  }
+
+  void exposure_and_gain_scale_brightness() {
+    Backend backend(smallConfig());
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+    FrameRef base;
+    QCOMPARE(backend.grabFrame(pool, base, 100), GrabResult::Ok);
+
+    QCOMPARE(backend.setFloat("ExposureTime", 5000.0f), ICameraBackend::kOk);
+    FrameRef dim;
+    QCOMPARE(backend.grabFrame(pool, dim, 100), GrabResult::Ok);
+    QVERIFY(meanLevel(dim) < meanLevel(base) * 0.6);
+
+    QCOMPARE(backend.setFloat("Gain", 6.0f), ICameraBackend::kOk);
+    FrameRef gained;
+    QCOMPARE(backend.grabFrame(pool, gained, 100), GrabResult::Ok);
+    QVERIFY(meanLevel(gained) > meanLevel(dim) * 1.5);
+
+    QCOMPARE(backend.setFloat("Gain", 100.0f), ICameraBackend::kErrInvalidParam);
+    QCOMPARE(backend.setFloat("Temperature", 1.0f),
+             ICameraBackend::kErrNotSupported);
+  }
+
+  void paced_frames_follow_frame_rate() {
+    Backend::Config config = smallConfig();
+    config.fps = 200.0;
+    Backend backend(config);
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool));
+
+    const auto t0 = std::chrono::steady_clock::now();
+    FrameRef frame;
+    for (int i = 0; i < 21; ++i)
+      QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - t0)
+                        .count();
+    // 第一帧立即出，之后 20 个 5 ms 周期
+    QVERIFY2(ms >= 95, qPrintable(QString("elapsed %1 ms").arg(ms)));
+
+    // AcquisitionFrameRateEnable 打开后以节点帧率为准
+    QCOMPARE(backend.setFloat("AcquisitionFrameRate", 2.0f), ICameraBackend::kOk);
+    QCOMPARE(backend.setBool("AcquisitionFrameRateEnable", true),
+             ICameraBackend::kOk);
+    ICameraBackend::FloatValue fps;
+    QCOMPARE(backend.getFloat("ResultingFrameRate", fps), ICameraBackend::kOk);
+    QCOMPARE(fps.current, 2.0f);
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+    QCOMPARE(backend.grabFrame(pool, frame, 20), GrabResult::Timeout);
+  }
+
+  void callback_mode_pushes_frames() {
+    Backend::Config config = smallConfig();
+    config.fps = 200.0;
+    Backend backend(config);
+    FramePool pool;
+    QVERIFY(pool.configure(4, 320 * 240));
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+    QVERIFY(backend.supportsFrameCallback());
+
+    std::mutex mutex;
+    std::vector<uint32_t> frameNums;
+    bool timestampsOrdered = true;
+    QCOMPARE(backend.setFrameCallback(
+                 &pool,
+                 [&](GrabResult result, FrameRef &frame) {
+                   if (result != GrabResult::Ok)
+                     return;
+                   std::lock_guard<std::mutex> lock(mutex);
+                   frameNums.push_back(frame.info().frameNum);
+                   // 设备时间戳 = 节拍时刻，不晚于出帧时刻
+                   timestampsOrdered &= static_cast<int64_t>(
+                                            frame.info().devTimestamp) <=
+                                        frame.info().grabTimeNs;
+                 }),
+             ICameraBackend::kOk);
+    QCOMPARE(backend.startGrabbing(), ICameraBackend::kOk);
+
+    // 推模式下不能再轮询，也不能换回调
+    FrameRef frame;
+    QCOMPARE(backend.grabFrame(pool, frame, 10), GrabResult::Error);
+    QCOMPARE(backend.setFrameCallback(nullptr, nullptr), ICameraBackend::kErrBusy);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    backend.stopGrabbing();
+    std::size_t delivered = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      delivered = frameNums.size();
+      QVERIFY2(delivered >= 10, qPrintable(QString("%1 frames").arg(delivered)));
+      for (std::size_t i = 1; i < frameNums.size(); ++i)
+        QVERIFY(frameNums[i] > frameNums[i - 1]);
+      QVERIFY(timestampsOrdered);
+    }
+    // stopGrabbing 返回后不再回调，回调没留住的帧都已还给池子
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    QCOMPARE(frameNums.size(), delivered);
+    QCOMPARE(pool.inUse(), std::size_t(0));
+
+    // 取消注册后回到轮询
+    QCOMPARE(backend.setFrameCallback(nullptr, nullptr), ICameraBackend::kOk);
+    QCOMPARE(backend.startGrabbing(), ICameraBackend::kOk);
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::Ok);
+  }
+
+  void pool_exhaustion_and_oversize_are_reported() {
+    Backend backend(smallConfig());
+    FramePool pool;
+    QVERIFY(startWithPool(backend, pool, 1));
+
+    FrameRef held;
+    QCOMPARE(backend.grabFrame(pool, held, 100), GrabResult::Ok);
+    FrameRef frame;
+    QCOMPARE(backend.grabFrame(pool, frame, 100), GrabResult::PoolExhausted);
+    QVERIFY(!frame);
+    QCOMPARE(pool.stats().exhausted, uint64_t(1));
+    held.reset();
+
+    FramePool tiny;
+    QVERIFY(tiny.configure(1, 1024));
+    QCOMPARE(backend.grabFrame(tiny, frame, 100), GrabResult::Oversize);
+    QVERIFY(!frame);
+    QCOMPARE(tiny.inUse(), std::size_t(0));
+  }
+
+  void requires_open_and_grabbing() {
+    Backend backend(smallConfig());
+    FramePool pool;
+    QVERIFY(pool.configure(1, 320 * 240));
+    ICameraBackend::FloatValue v;
+    QCOMPARE(backend.getFloat("ExposureTime", v), ICameraBackend::kErrNotOpen);
+    QCOMPARE(backend.startGrabbing(), ICameraBackend::kErrNotOpen);
+    QCOMPARE(backend.open(1), ICameraBackend::kErrInvalidParam);
+    QCOMPARE(backend.enumerateDevices().size(), 1);
+
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+    FrameRef frame;
+    QCOMPARE(backend.grabFrame(pool, frame, 10), GrabResult::Error);
+    QVERIFY(backend.sdkHandle() == nullptr);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestSyntheticCameraBackend)
+#include "test_synthetic_camera_backend.moc"
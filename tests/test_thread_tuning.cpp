@@ -0,0 +1,96 @@
+// 线程调度配置单元测试：QSettings 读写往返、非法值回落默认，
+// 绑核 / 优先级的实际结果如实上报（没有权限时 prioritized 为 false）
+#include "utils/ThreadAffinity.h"
+#include "utils/ThreadTuningSettings.h"
+
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+class TestThreadTuning : public QObject {
+  Q_OBJECT
+private slots:
+
+  void settings_round_trip() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("tuning.ini");
+
+    ThreadAffinity::Tuning tuning;
+    tuning.grab.core = 2;
+    tuning.grab.priority = ThreadAffinity::Priority::Realtime;
+    tuning.record.priority = ThreadAffinity::Priority::High;
+    {
+      QSettings settings(path, QSettings::IniFormat);
+      ThreadTuningSettings::save(settings, tuning);
+    }
+    QSettings settings(path, QSettings::IniFormat);
+    const ThreadAffinity::Tuning loaded = ThreadTuningSettings::load(settings);
+    QCOMPARE(loaded.grab.core, 2);
+    QVERIFY(loaded.grab.priority == ThreadAffinity::Priority::Realtime);
+    QCOMPARE(loaded.record.core, -1);
+    QVERIFY(loaded.record.priority == ThreadAffinity::Priority::High);
+    QVERIFY(loaded.workers.isDefault());
+  }
+
+  void invalid_values_fall_back_to_defaults() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QSettings settings(dir.filePath("bad.ini"), QSettings::IniFormat);
+    settings.setValue("threads/grab/core", "abc");
+    settings.setValue("threads/grab/priority", "turbo");
+    settings.setValue("threads/record/core", -7);
+    settings.setValue("threads/record/priority", " REALTIME ");
+    const ThreadAffinity::Tuning loaded = ThreadTuningSettings::load(settings);
+    QVERIFY(loaded.grab.isDefault());
+    QCOMPARE(loaded.record.core, -1);
+    QVERIFY(loaded.record.priority == ThreadAffinity::Priority::Realtime);
+  }
+
+  void default_setting_changes_nothing() {
+    const ThreadAffinity::Applied applied =
+        ThreadAffinity::applyToCurrentThread("grab", {});
+    QCOMPARE(applied.thread, std::string("grab"));
+    QVERIFY(!applied.pinned);
+    QVERIFY(!applied.prioritized);
+  }
+
+  void applied_result_matches_scheduler_state() {
+#if !defined(__linux__)
+    QSKIP("只在 Linux 上核对调度器状态");
+#else
+    ThreadAffinity::ThreadSetting setting;
+    setting.core = 0;
+    setting.priority = ThreadAffinity::Priority::Realtime;
+    ThreadAffinity::Applied applied;
+    bool onlyCore0 = false;
+    int policy = -1;
+    // 在新线程里改，不影响测试主线程
+    std::thread worker([&] {
+      applied = ThreadAffinity::applyToCurrentThread("record", setting);
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+        onlyCore0 = CPU_COUNT(&set) == 1 && CPU_ISSET(0, &set);
+      sched_param param{};
+      pthread_getschedparam(pthread_self(), &policy, &param);
+    });
+    worker.join();
+    QVERIFY(applied.pinned);
+    QVERIFY(onlyCore0);
+    // 没有 CAP_SYS_NICE 时设置失败，必须如实报告
+    QCOMPARE(applied.prioritized, policy == SCHED_FIFO);
+    // 越界的核不绑
+    QVERIFY(!ThreadAffinity::pinCurrentThread(ThreadAffinity::coreCount()));
+#endif
+  }
+};
+
+QTEST_GUILESS_MAIN(TestThreadTuning)
+#include "test_thread_tuning.moc"
@@ -0,0 +1,107 @@
+// TilePool 单元测试：条带不重不漏、调用线程参与、连续多次 run 互不串扰，
+// 以及按条带并行去马赛克与整帧转换逐字节一致（halo 行取自整帧）
+#include "utils/BayerDemosaic.h"
+#include "utils/TilePool.h"
+
+#include <QtTest>
+#include <atomic>
+#include <random>
+#include <set>
+#include <vector>
+
+class TestTilePool : public QObject {
+  Q_OBJECT
+private slots:
+
+  void tile_count_respects_min_rows() {
+    QCOMPARE(TilePool::tileCount(0, 4, 16), 0);
+    QCOMPARE(TilePool::tileCount(2048, 4, 16), 4 * TilePool::kTilesPerThread);
+    // 行数不够分：每条至少 minTileRows 行
+    QCOMPARE(TilePool::tileCount(40, 8, 16), 2);
+    QCOMPARE(TilePool::tileCount(10, 8, 16), 1);
+    QCOMPARE(TilePool::tileCount(100, 0, 1), TilePool::kTilesPerThread);
+  }
+
+  void every_row_is_processed_once() {
+    for (int workers : {0, 1, 3, 7}) {
+      TilePool pool(workers);
+      QCOMPARE(pool.threadCount(), workers + 1);
+      for (int rows : {1, 17, 480, 2048}) {
+        std::vector<std::atomic<int>> hits(rows);
+        for (auto &h : hits)
+          h.store(0);
+        std::mutex threadsMutex;
+        std::set<std::thread::id> threads;
+        std::atomic<int> emptyTiles{0};
+        pool.run(rows, 8, [&](int y0, int y1) {
+          if (y0 >= y1)
+            emptyTiles.fetch_add(1);
+          for (int y = y0; y < y1; ++y)
+            hits[y].fetch_add(1);
+          std::lock_guard<std::mutex> lock(threadsMutex);
+          threads.insert(std::this_thread::get_id());
+        });
+        QCOMPARE(emptyTiles.load(), 0);
+        for (int y = 0; y < rows; ++y)
+          QCOMPARE(hits[y].load(), 1);
+        QVERIFY(int(threads.size()) <= pool.threadCount());
+      }
+    }
+  }
+
+  void back_to_back_runs_do_not_interfere() {
+    // 录制线程一帧接一帧地 run：上一帧的条带不会被算进下一帧
+    TilePool pool(4);
+    std::vector<int> rowsDone(64, 0);
+    for (int frame = 0; frame < 500; ++frame) {
+      std::atomic<int> sum{0};
+      pool.run(64, 1, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+          rowsDone[y] = frame;
+          sum.fetch_add(y);
+        }
+      });
+      QCOMPARE(sum.load(), 63 * 64 / 2);
+      for (int y = 0; y < 64; ++y)
+        QCOMPARE(rowsDone[y], frame);
+    }
+  }
+
+  void tiled_demosaic_matches_whole_frame() {
+    const int w = 333, h = 257;
+    std::vector<uint8_t> raw(std::size_t(w) * h);
+    std::mt19937 rng(7);
+    for (uint8_t &b : raw)
+      b = uint8_t(rng());
+    std::vector<uint8_t> refBgr(std::size_t(w) * h * 3);
+    std::vector<uint8_t> refMono(std::size_t(w) * h);
+    QVERIFY(BayerDemosaic::toBgr8(raw.data(), w, h, w,
+                                  BayerDemosaic::Pattern::GB, refBgr.data(),
+                                  w * 3));
+    QVERIFY(BayerDemosaic::toMono8(raw.data(), w, h, w,
+                                   BayerDemosaic::Pattern::GB, refMono.data(),
+                                   w));
+
+    TilePool pool(3);
+    std::vector<uint8_t> bgr(refBgr.size());
+    std::vector<uint8_t> mono(refMono.size());
+    // 奇数行数的条带：条带边界落在 Bayer 的奇数行上也要一致
+    pool.run(h, 7, [&](int y0, int y1) {
+      BayerDemosaic::toBgr8Rows(raw.data(), w, h, w,
+                                BayerDemosaic::Pattern::GB, bgr.data(), w * 3,
+                                y0, y1);
+      BayerDemosaic::toMono8Rows(raw.data(), w, h, w,
+                                 BayerDemosaic::Pattern::GB, mono.data(), w,
+                                 y0, y1);
+    });
+    QVERIFY(bgr == refBgr);
+    QVERIFY(mono == refMono);
+
+    QVERIFY(!BayerDemosaic::toMono8Rows(raw.data(), w, h, w,
+                                        BayerDemosaic::Pattern::GB,
+                                        mono.data(), w, 10, h + 1));
+  }
+};
+
+QTEST_GUILESS_MAIN(TestTilePool)
+#include "test_tile_pool.moc"
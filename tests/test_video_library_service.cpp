@@ -137,6 +137,32 @@ private slots:
     QCOMPARE(DatabaseManager::instance().getAllVideos().size(), 1);
   }
 
+  void addRecording_segments_grouped_under_session() {
+    resetDb();
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString base = dir.filePath("overnight.avi");
+    const int sessionId = VideoLibraryService::beginRecordingSession(
+        base, DatabaseManager::instance());
+    QVERIFY(sessionId > 0);
+    QCOMPARE(DatabaseManager::instance().getRecordingSession(sessionId).name,
+             QString("overnight"));
+
+    for (int index = 1; index <= 3; ++index) {
+      const QString path = dir.filePath(
+          QString("overnight_%1.avi").arg(index, 3, 10, QChar('0')));
+      QVERIFY(writeAviFile(path, 30 * index));
+      QVERIFY(VideoLibraryService::addRecording(
+          path, DatabaseManager::instance(), sessionId, index));
+    }
+    const auto segments =
+        DatabaseManager::instance().getVideosInSession(sessionId);
+    QCOMPARE(segments.size(), 3);
+    QCOMPARE(segments[2].filename, QString("overnight_003.avi"));
+    QCOMPARE(segments[2].segmentIndex, 3);
+    QCOMPARE(segments[2].duration, qint64(3));
+  }
+
   // ============================================================================
   // Phase 5 防回归：pruneOrphans
   // ============================================================================
@@ -1,7 +1,9 @@
 // Phase 1 - VideoUtils 单元测试
 #include "utils/VideoUtils.h"
+#include "utils/WvrFormat.h"
 
 #include <QtTest>
+#include <cstring>
 
 // ---- 字节流构造助手 ----
 namespace {
@@ -89,6 +91,26 @@ QByteArray makeMp4Header(quint32 timescale, quint32 duration_v0) {
   return ftyp + moov;
 }
 
+// 构造 .wvr 文件头（WvrFormat::FileHeader，补齐到 4 KB）
+QByteArray makeWvrHeader(quint64 frameCount, double fps,
+                         quint32 version = WvrFormat::kVersion) {
+  WvrFormat::FileHeader h{};
+  std::memcpy(h.magic, WvrFormat::kMagic, sizeof(h.magic));
+  h.version = version;
+  h.headerBytes = WvrFormat::kHeaderBytes;
+  h.alignment = WvrFormat::kAlignment;
+  h.flags = WvrFormat::kFlagComplete;
+  h.pixelType = 0x01080001; // Mono8
+  h.width = 64;
+  h.height = 32;
+  h.frameBytes = 64 * 32;
+  h.fps = fps;
+  h.frameCount = frameCount;
+  QByteArray buf(reinterpret_cast<const char *>(&h), sizeof(h));
+  buf.append(QByteArray(WvrFormat::kHeaderBytes - sizeof(h), '\0'));
+  return buf;
+}
+
 } // namespace
 
 class TestVideoUtils : public QObject {
@@ -204,6 +226,44 @@ private slots:
     QCOMPARE(VideoUtils::parseMp4Duration(buf), 0.0);
   }
 
+  // ========== parseWvrHeader ==========
+  void parseWvr_frames_and_duration() {
+    const VideoUtils::VideoProbe probe =
+        VideoUtils::parseWvrHeader(makeWvrHeader(600, 120.0));
+    QCOMPARE(probe.frameCount, qint64(600));
+    QVERIFY(probe.durationSeconds > 4.99 && probe.durationSeconds < 5.01);
+  }
+
+  void parseWvr_bad_magic_or_short_returns_zero() {
+    QByteArray buf = makeWvrHeader(600, 120.0);
+    buf[0] = 'X';
+    QCOMPARE(VideoUtils::parseWvrHeader(buf).frameCount, qint64(0));
+    QCOMPARE(VideoUtils::parseWvrHeader(makeWvrHeader(600, 120.0).left(40))
+                 .frameCount,
+             qint64(0));
+  }
+
+  void parseWvr_accepts_known_versions_only() {
+    // v1 = 不压缩，v2 = 无损压缩，文件头一样
+    QCOMPARE(VideoUtils::parseWvrHeader(makeWvrHeader(600, 120.0, 1))
+                 .frameCount,
+             qint64(600));
+    QCOMPARE(VideoUtils::parseWvrHeader(makeWvrHeader(600, 120.0, 2))
+                 .frameCount,
+             qint64(600));
+    QCOMPARE(VideoUtils::parseWvrHeader(
+                 makeWvrHeader(600, 120.0, WvrFormat::kVersion + 1))
+                 .frameCount,
+             qint64(0));
+  }
+
+  void parseWvr_zero_fps_keeps_frame_count() {
+    const VideoUtils::VideoProbe probe =
+        VideoUtils::parseWvrHeader(makeWvrHeader(10, 0.0));
+    QCOMPARE(probe.frameCount, qint64(10));
+    QCOMPARE(probe.durationSeconds, 0.0);
+  }
+
   // ========== parseVideoDurationFromFile（集成） ==========
   void parseFile_avi_temp() {
     QTemporaryFile f;
@@ -223,6 +283,27 @@ private slots:
     QVERIFY(sec > 4.99 && sec < 5.01);
   }
 
+  void probeFile_wvr_temp() {
+    QTemporaryFile f;
+    QVERIFY(f.open());
+    f.write(makeWvrHeader(900, 30.0));
+    f.close();
+    const VideoUtils::VideoProbe probe =
+        VideoUtils::probeVideoFile(f.fileName());
+    QCOMPARE(probe.frameCount, qint64(900));
+    QVERIFY(probe.durationSeconds > 29.9 && probe.durationSeconds < 30.1);
+    QCOMPARE(VideoUtils::parseVideoDurationFromFile(f.fileName()),
+             probe.durationSeconds);
+  }
+
+  void probeFile_avi_reports_frame_count() {
+    QTemporaryFile f;
+    QVERIFY(f.open());
+    f.write(makeAviHeader(33333, 300));
+    f.close();
+    QCOMPARE(VideoUtils::probeVideoFile(f.fileName()).frameCount, qint64(300));
+  }
+
   void parseFile_nonexistent_returns_zero() {
     QCOMPARE(VideoUtils::parseVideoDurationFromFile("Z:/no/such/file.avi"),
              0.0);
@@ -0,0 +1,402 @@
+// .wvr 原始容器单元测试：WvrWriter 写、WvrReader 映射读回逐字节比对（含
+// 打包格式和逐帧元数据）；块对齐与文件头回填；未正常关闭的文件顺着检查点
+// 链 / 逐块扫描恢复；无损压缩的帧（块大小逐帧不同）读回、解码、恢复，
+// 经 ReplayCameraBackend 回放；出错路径
+#include "services/ReplayCameraBackend.h"
+#include "utils/FramePool.h"
+#include "utils/LosslessCodec.h"
+#include "utils/PixelFormats.h"
+#include "utils/TilePool.h"
+#include "utils/WvrReader.h"
+#include "utils/WvrWriter.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace WvrFormat;
+
+// 第 index 帧：每个字节都和帧号 / 位置相关，错位能看出来
+std::vector<uint8_t> makeFrame(std::size_t bytes, int index) {
+  std::vector<uint8_t> f(bytes);
+  for (std::size_t i = 0; i < bytes; ++i)
+    f[i] = static_cast<uint8_t>(index * 37 + i * 7 + (i >> 8));
+  return f;
+}
+
+IRecordWriter::FrameMeta metaFor(int index) {
+  IRecordWriter::FrameMeta meta;
+  meta.frameNum = 1000 + index * 2; // 相机帧号不连续也原样保存
+  meta.devTimestamp = uint64_t(index) * 16666;
+  meta.grabTimeNs = 5000000000ll + int64_t(index) * 16666667;
+  return meta;
+}
+
+bool writeFrames(WvrWriter &writer, int first, int count) {
+  for (int i = first; i < first + count; ++i) {
+    const std::vector<uint8_t> f = makeFrame(writer.frameBytes(), i);
+    if (!writer.writeFrame(f.data(), f.size(), metaFor(i)))
+      return false;
+  }
+  return true;
+}
+
+// 压得动的帧：平坦背景 + 几个灰阶的噪声 + 随帧移动的暗条；noise 时全随机
+std::vector<uint8_t> makeTextureFrame(const LosslessCodec::Layout &l, int index,
+                                      bool noise) {
+  std::vector<uint8_t> f(l.frameBytes());
+  std::mt19937 rng(uint32_t(index) + 1);
+  for (int y = 0; y < l.rows; ++y) {
+    for (int x = 0; x < l.samplesPerRow; ++x) {
+      uint32_t v = noise ? rng() : 180 + rng() % 4;
+      if (!noise && (x + index * 3) % 40 < 5)
+        v = 40 + rng() % 4;
+      const std::size_t i = std::size_t(y) * l.samplesPerRow + x;
+      if (l.bytesPerSample == 1) {
+        f[i] = uint8_t(v);
+      } else {
+        const uint16_t s = uint16_t(v);
+        std::memcpy(f.data() + i * 2, &s, 2);
+      }
+    }
+  }
+  return f;
+}
+
+// 逐帧比对像素和元数据
+bool framesMatch(const WvrReader &reader, uint64_t count) {
+  for (uint64_t i = 0; i < count; ++i) {
+    WvrReader::Frame frame;
+    if (!reader.frame(i, &frame))
+      return false;
+    const std::vector<uint8_t> expect =
+        makeFrame(reader.frameBytes(), static_cast<int>(i));
+    const IRecordWriter::FrameMeta meta = metaFor(static_cast<int>(i));
+    if (frame.bytes != expect.size() ||
+        std::memcmp(frame.data, expect.data(), expect.size()) != 0 ||
+        frame.frameNum != meta.frameNum ||
+        frame.devTimestamp != meta.devTimestamp ||
+        frame.grabTimeNs != meta.grabTimeNs)
+      return false;
+  }
+  return true;
+}
+
+// 模拟崩溃：复制还在写的文件（只含写盘线程已经写出的部分）
+QString snapshot(const QString &path, const QString &copy) {
+  QFile::remove(copy);
+  return QFile::copy(path, copy) ? copy : QString();
+}
+
+} // namespace
+
+class TestWvrContainer : public QObject {
+  Q_OBJECT
+private slots:
+
+  void round_trips_raw_frames_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::newRow("Mono8") << uint(PixelFormats::kMono8) << 64 << 32;
+    // 不转换：Bayer 和 12 位打包原样落盘
+    QTest::newRow("BayerRG8") << uint(0x01080009) << 40 << 30;
+    QTest::newRow("Mono12Packed 奇数字节")
+        << uint(PixelFormats::kMono12Packed) << 6 << 5;
+  }
+
+  void round_trips_raw_frames() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QTemporaryDir dir;
+    const QString path = dir.filePath("a.wvr");
+    const int frames = 11;
+
+    WvrWriter::Options o;
+    o.width = width;
+    o.height = height;
+    o.pixelType = pixelType;
+    o.fps = 120.0;
+    o.checkpointFrames = 4;
+    WvrWriter writer;
+    QVERIFY(writer.open(path.toStdString(), o));
+    QCOMPARE(writer.frameBytes(),
+             PixelFormats::frameBytes(pixelType, width, height));
+    QVERIFY(writeFrames(writer, 0, frames));
+    QVERIFY2(writer.close(), writer.error().c_str());
+    QCOMPARE(writer.stats().frames, uint64_t(frames));
+    QCOMPARE(writer.stats().checkpoints, 2u);
+    // close 返回即完整
+    QCOMPARE(uint64_t(QFileInfo(path).size()), writer.stats().fileBytes);
+    QCOMPARE(writer.stats().fileBytes % kAlignment, uint64_t(0));
+
+    WvrReader reader;
+    QVERIFY2(reader.open(path.toStdString()), reader.error().c_str());
+    QVERIFY(reader.complete());
+    // 不压缩的文件仍是 v1
+    QCOMPARE(reader.header().version, 1u);
+    QCOMPARE(reader.codec(), uint32_t(kCodecNone));
+    QCOMPARE(reader.width(), width);
+    QCOMPARE(reader.height(), height);
+    QCOMPARE(reader.pixelType(), uint32_t(pixelType));
+    QCOMPARE(reader.fps(), 120.0);
+    QCOMPARE(reader.frameCount(), uint64_t(frames));
+    QCOMPARE(reader.header().frameCount, uint64_t(frames));
+    QCOMPARE(reader.header().firstGrabTimeNs, metaFor(0).grabTimeNs);
+    QCOMPARE(reader.header().lastGrabTimeNs, metaFor(frames - 1).grabTimeNs);
+    QVERIFY(framesMatch(reader, frames));
+
+    // 随机访问：倒着取，像素指针按缓存行对齐
+    for (int i = frames - 1; i >= 0; --i) {
+      WvrReader::Frame frame;
+      QVERIFY(reader.frame(uint64_t(i), &frame));
+      QCOMPARE(frame.frameNum, metaFor(i).frameNum);
+      QCOMPARE(reinterpret_cast<uintptr_t>(frame.data) % 64, uintptr_t(0));
+    }
+    WvrReader::Frame frame;
+    QVERIFY(!reader.frame(uint64_t(frames), &frame));
+    std::vector<uint8_t> copy(reader.frameBytes());
+    QVERIFY(reader.readFrame(3, copy.data()));
+    QVERIFY(copy == makeFrame(reader.frameBytes(), 3));
+  }
+
+  void round_trips_lossless_frames_data() {
+    QTest::addColumn<uint>("pixelType");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::newRow("Mono8") << uint(PixelFormats::kMono8) << 320 << 200;
+    QTest::newRow("BayerRG12") << uint(0x01100011) << 130 << 70;
+  }
+
+  void round_trips_lossless_frames() {
+    QFETCH(uint, pixelType);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QTemporaryDir dir;
+    const QString path = dir.filePath("c.wvr");
+    LosslessCodec::Layout layout;
+    QVERIFY(LosslessCodec::layoutFor(pixelType, width, height, &layout));
+
+    WvrWriter::Options o;
+    o.width = width;
+    o.height = height;
+    o.pixelType = pixelType;
+    o.fps = 60.0;
+    o.checkpointFrames = 3;
+    o.codec = kCodecLossless;
+    o.encodeThreads = 2;
+    WvrWriter writer;
+    QVERIFY(writer.open(path.toStdString(), o));
+    QCOMPARE(writer.codec(), uint32_t(kCodecLossless));
+    // 第 4 帧是噪声，压不动、原样存
+    const int frames = 8;
+    std::vector<std::vector<uint8_t>> expect;
+    for (int i = 0; i < frames; ++i) {
+      expect.push_back(makeTextureFrame(layout, i, i == 4));
+      QVERIFY(writer.writeFrame(expect.back().data(), expect.back().size(),
+                                metaFor(i)));
+    }
+    QVERIFY2(writer.sync(), writer.error().c_str());
+    const QString crashed = snapshot(path, dir.filePath("crashed.wvr"));
+    QVERIFY2(writer.close(), writer.error().c_str());
+
+    const WvrWriter::Stats st = writer.stats();
+    QCOMPARE(st.frames, uint64_t(frames));
+    QCOMPARE(st.rawFrames, uint64_t(1));
+    QCOMPARE(st.inputBytes, uint64_t(frames) * layout.frameBytes());
+    QVERIFY(st.compressionRatio() > 2.0);
+    QVERIFY(st.fileBytes < st.inputBytes);
+    QVERIFY(writer.summary().find("无损压缩") != std::string::npos);
+
+    TilePool pool(2);
+    auto verify = [&](const QString &file, bool complete) {
+      WvrReader reader;
+      if (!reader.open(file.toStdString()))
+        return false;
+      std::vector<uint8_t> decoded(reader.frameBytes());
+      bool ok = reader.complete() == complete &&
+                reader.header().version == kVersion &&
+                reader.codec() == kCodecLossless &&
+                reader.frameCount() == uint64_t(frames);
+      for (int i = frames - 1; ok && i >= 0; --i) {
+        WvrReader::Frame frame;
+        ok = reader.frame(uint64_t(i), &frame) &&
+             frame.encoding == (i == 4 ? kCodecNone : kCodecLossless) &&
+             frame.frameNum == metaFor(i).frameNum &&
+             reader.readFrame(uint64_t(i), decoded.data(),
+                              i % 2 ? &pool : nullptr) &&
+             decoded == expect[std::size_t(i)];
+      }
+      return ok;
+    };
+    QVERIFY(verify(path, true));
+
+    // 崩溃：检查点之后的帧块大小各不相同，扫描按块头的 chunkBytes 前进
+    QVERIFY(!crashed.isEmpty());
+    QVERIFY(verify(crashed, false));
+    {
+      QFile f(crashed);
+      QVERIFY(f.open(QIODevice::ReadWrite));
+      FileHeader h;
+      QCOMPARE(f.read(reinterpret_cast<char *>(&h), sizeof(h)),
+               qint64(sizeof(h)));
+      h.lastCheckpoint = 0;
+      QVERIFY(f.seek(0));
+      f.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    }
+    QVERIFY(verify(crashed, false));
+
+    // 回放后端：原生像素格式，解码后的帧直接进池缓冲
+    ReplayCameraBackend::Options replay;
+    replay.path = path;
+    replay.fps = 0.0;
+    replay.loop = false;
+    ReplayCameraBackend backend(replay);
+    QCOMPARE(backend.open(0), ICameraBackend::kOk);
+    QCOMPARE(backend.frameCount(), frames);
+    uint32_t replayType = 0;
+    QCOMPARE(backend.getEnum("PixelFormat", replayType), ICameraBackend::kOk);
+    QCOMPARE(replayType, uint32_t(pixelType));
+    FramePool framePool;
+    QVERIFY(framePool.configure(2, layout.frameBytes()));
+    QCOMPARE(backend.startGrabbing(), ICameraBackend::kOk);
+    for (int i = 0; i < frames; ++i) {
+      FrameRef f;
+      QCOMPARE(backend.grabFrame(framePool, f, 100),
+               ICameraBackend::GrabResult::Ok);
+      QCOMPARE(f.info().frameLen, uint64_t(layout.frameBytes()));
+      QVERIFY(std::memcmp(f.data(), expect[std::size_t(i)].data(),
+                          layout.frameBytes()) == 0);
+    }
+    FrameRef end;
+    QCOMPARE(backend.grabFrame(framePool, end, 100),
+             ICameraBackend::GrabResult::EndOfStream);
+  }
+
+  void recovers_unclosed_file_from_checkpoints() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("live.wvr");
+    // 一帧 64 KB = 最小写缓冲：每帧都跨两块缓冲
+    WvrWriter::Options o;
+    o.width = 256;
+    o.height = 256;
+    o.pixelType = PixelFormats::kMono8;
+    o.fps = 60.0;
+    o.checkpointFrames = 4;
+    o.file.bufferBytes = 0;
+    WvrWriter writer;
+    QVERIFY(writer.open(path.toStdString(), o));
+    QVERIFY(writeFrames(writer, 0, 10));
+    QVERIFY2(writer.sync(), writer.error().c_str());
+
+    // 10 帧都已写出但没有尾索引：顺着检查点链拿到前 8 帧，再扫出后 2 帧
+    const QString crashed = snapshot(path, dir.filePath("crashed.wvr"));
+    QVERIFY(!crashed.isEmpty());
+    WvrReader reader;
+    QVERIFY2(reader.open(crashed.toStdString()), reader.error().c_str());
+    QVERIFY(!reader.complete());
+    QCOMPARE(reader.header().frameCount, uint64_t(8));
+    QVERIFY(reader.header().lastCheckpoint != 0);
+    QCOMPARE(reader.frameCount(), uint64_t(10));
+    QVERIFY(framesMatch(reader, 10));
+    reader.close();
+
+    // 文件头没来得及回填检查点：从头逐块扫描，结果一样
+    {
+      QFile f(crashed);
+      QVERIFY(f.open(QIODevice::ReadWrite));
+      FileHeader h;
+      QCOMPARE(f.read(reinterpret_cast<char *>(&h), sizeof(h)),
+               qint64(sizeof(h)));
+      h.lastCheckpoint = 0;
+      h.frameCount = 0;
+      QVERIFY(f.seek(0));
+      f.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    }
+    QVERIFY(reader.open(crashed.toStdString()));
+    QCOMPARE(reader.frameCount(), uint64_t(10));
+    QVERIFY(framesMatch(reader, 10));
+    reader.close();
+
+    // 截断在第 7 帧中间（前面隔着第一个检查点）：文件头的检查点指到文件
+    // 外，退回扫描，只要完整的 6 帧
+    const QString truncated = snapshot(path, dir.filePath("truncated.wvr"));
+    QVERIFY(!truncated.isEmpty());
+    const qint64 cut = kHeaderBytes + 6 * frameChunkBytes(256 * 256) +
+                       indexChunkBytes(4) + 1000;
+    QVERIFY(QFile::resize(truncated, cut));
+    QVERIFY(reader.open(truncated.toStdString()));
+    QCOMPARE(reader.frameCount(), uint64_t(6));
+    QVERIFY(framesMatch(reader, 6));
+    reader.close();
+
+    // 写完正常关闭的同一个文件：尾索引覆盖全部帧
+    QVERIFY(writer.close());
+    QVERIFY(reader.open(path.toStdString()));
+    QVERIFY(reader.complete());
+    QCOMPARE(reader.frameCount(), uint64_t(10));
+    QVERIFY(framesMatch(reader, 10));
+  }
+
+  void rejects_bad_input() {
+    QTemporaryDir dir;
+    WvrWriter writer;
+    WvrWriter::Options o;
+    o.width = 16;
+    o.height = 4;
+    o.pixelType = 0x12345678;
+    QVERIFY(!writer.open(dir.filePath("a.wvr").toStdString(), o));
+    QVERIFY(!writer.error().empty());
+    QVERIFY(WvrWriter::supports(PixelFormats::kMono12));
+    QVERIFY(!WvrWriter::supports(0x12345678));
+
+    o.pixelType = PixelFormats::kMono8;
+    QVERIFY(!writer.open(dir.filePath("missing/a.wvr").toStdString(), o));
+    QVERIFY(!writer.error().empty());
+
+    // 尺寸不符只丢这一帧
+    const QString path = dir.filePath("b.wvr");
+    QVERIFY(writer.open(path.toStdString(), o));
+    const std::vector<uint8_t> small(10);
+    QVERIFY(!writer.writeFrame(small.data(), small.size()));
+    QVERIFY(!writer.error().empty());
+    const std::vector<uint8_t> good(16 * 4);
+    QVERIFY(writer.writeFrame(good.data(), good.size()));
+    QVERIFY(writer.close());
+    QCOMPARE(writer.frameCount(), uint64_t(1));
+    QVERIFY(writer.close());
+
+    // 格式排不出压缩布局时退回原样，不算错误
+    o.pixelType = PixelFormats::kMono12Packed;
+    o.width = 5;
+    o.codec = kCodecLossless;
+    QVERIFY(writer.open(dir.filePath("c.wvr").toStdString(), o));
+    QCOMPARE(writer.codec(), uint32_t(kCodecNone));
+    QVERIFY(writer.close());
+
+    // 读端：不存在 / 不是 .wvr / 只有文件头没有帧
+    WvrReader reader;
+    QVERIFY(!reader.open(dir.filePath("none.wvr").toStdString()));
+    QVERIFY(!reader.error().empty());
+    QFile junk(dir.filePath("junk.wvr"));
+    QVERIFY(junk.open(QIODevice::WriteOnly));
+    junk.write(QByteArray(8192, 'x'));
+    junk.close();
+    QVERIFY(!reader.open(junk.fileName().toStdString()));
+    QVERIFY(reader.open(path.toStdString()));
+    reader.close();
+    QVERIFY(QFile::resize(path, kHeaderBytes));
+    QVERIFY(!reader.open(path.toStdString()));
+    QVERIFY(!reader.isOpen());
+  }
+};
+
+QTEST_GUILESS_MAIN(TestWvrContainer)
+#include "test_wvr_container.moc"